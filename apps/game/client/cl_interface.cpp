@@ -132,6 +132,10 @@ void Game_UpdateProjection()
 }
 
 
+TELEMETRY_REGISTER( RenderBuild, 1.f );
+TELEMETRY_REGISTER( RenderSubmit, 6.f );
+
+
 class ClientSystem final : public IClientSystem
 {
 public:
@@ -143,6 +147,7 @@ public:
 		CH_GET_SYSTEM( render, IRender, IRENDER_NAME, IRENDER_VER );
 		CH_GET_SYSTEM( audio, IAudioSystem, IADUIO_NAME, IADUIO_VER );
 		CH_GET_SYSTEM( ch_physics, Ch_IPhysics, IPHYSICS_NAME, IPHYSICS_VER );
+		CH_GET_SYSTEM( animation, IAnimationSystem, IANIMATION_NAME, IANIMATION_VER );
 		CH_GET_SYSTEM( graphics, IGraphics, IGRAPHICS_NAME, IGRAPHICS_VER );
 		CH_GET_SYSTEM( renderOld, IRenderSystemOld, IRENDERSYSTEMOLD_NAME, IRENDERSYSTEMOLD_VER );
 		CH_GET_SYSTEM( gui, IGuiSystem, IGUI_NAME, IGUI_HASH );
@@ -210,33 +215,42 @@ public:
 			// update render lists
 			// for now, we only have one primary render list, no cameras or anything yet
 			static ChVector< ch_handle_t > renderList;
-			renderList.clear();
-			renderList.resize( graphics->GetRenderableCount() );
-
-			for ( u32 i = 0; i < graphics->GetRenderableCount(); i++ )
-			{
-				renderList[ i ] = graphics->GetRenderableByIndex( i );
-			}
 
 			// TODO: Make this less stupid with allocating memory each frame
-			u32* viewportList = ch_malloc< u32 >( graphics->GetViewportCount() );
-			viewportList[ 0 ] = gMainViewportIndex;
-			u32 viewportCount = 1;
+			u32* viewportList  = ch_malloc< u32 >( graphics->GetViewportCount() );
+			u32  viewportCount = 1;
 
-			// Add Shadowmaps to this list
-			for ( u32 i = 0; i < graphics->GetLightCount(); i++ )
 			{
-				Light_t* light = graphics->GetLightByIndex( i );
-				if ( !light->apShadowMap )
-					continue;
+				TELEMETRY_SCOPE( RenderBuild );
 
-				viewportList[ viewportCount++ ] = light->apShadowMap->aViewportHandle;
-			}
+				renderList.clear();
+				renderList.resize( graphics->GetRenderableCount() );
+
+				for ( u32 i = 0; i < graphics->GetRenderableCount(); i++ )
+				{
+					renderList[ i ] = graphics->GetRenderableByIndex( i );
+				}
+
+				viewportList[ 0 ] = gMainViewportIndex;
 
-			graphics->SetViewportRenderList( gMainViewportIndex, renderList.data(), renderList.size() );
+				// Add Shadowmaps to this list
+				for ( u32 i = 0; i < graphics->GetLightCount(); i++ )
+				{
+					Light_t* light = graphics->GetLightByIndex( i );
+					if ( !light->apShadowMap )
+						continue;
+
+					viewportList[ viewportCount++ ] = light->apShadowMap->aViewportHandle;
+				}
 
-			renderOld->PrePresent();
-			renderOld->Present( gGraphicsWindow, viewportList, viewportCount );
+				graphics->SetViewportRenderList( gMainViewportIndex, renderList.data(), renderList.size() );
+			}
+
+			{
+				TELEMETRY_SCOPE( RenderSubmit );
+				renderOld->PrePresent();
+				renderOld->Present( gGraphicsWindow, viewportList, viewportCount );
+			}
 
 			free( viewportList );
 		}
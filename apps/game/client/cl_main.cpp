@@ -575,12 +575,12 @@ void CL_UpdateUserCmd()
 	PROF_SCOPE();
 
 	// Get the transform component from the camera entity on the local player, and get the angles from it
-	auto playerInfo = Ent_GetComponent< CPlayerInfo >( gLocalPlayer, "playerInfo" );
+	auto playerInfo = Ent_GetComponent< CPlayerInfo >( gLocalPlayer, CH_HASH( "playerInfo" ) );
 
 	if ( !playerInfo )
 		return;
 
-	auto camTransform = Ent_GetComponent< CTransform >( playerInfo->aCamera, "transform" );
+	auto camTransform = Ent_GetComponent< CTransform >( playerInfo->aCamera, CH_HASH( "transform" ) );
 
 	CH_ASSERT( camTransform );
 
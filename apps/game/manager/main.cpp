@@ -4,6 +4,7 @@
 #include "iinput.h"
 #include "igui.h"
 #include "iaudio.h"
+#include "ianimation.h"
 #include "physics/iphysics.h"
 #include "render/irender.h"
 #include "igraphics.h"
@@ -47,6 +48,7 @@ IGuiSystem*                gui              = nullptr;
 IRender*                   render           = nullptr;
 IInputSystem*              input            = nullptr;
 IAudioSystem*              audio            = nullptr;
+IAnimationSystem*          animation        = nullptr;
 IGraphics*                 graphics         = nullptr;
 IRenderSystemOld*          renderOld        = nullptr;
 Ch_IPhysics*               physics          = nullptr;
@@ -56,6 +58,11 @@ IClientSystem*             client           = nullptr;
 IServerSystem*             server           = nullptr;
 
 
+TELEMETRY_REGISTER( Input, 1.f );
+TELEMETRY_REGISTER( Client, 8.f );
+TELEMETRY_REGISTER( Server, 4.f );
+
+
 std::vector< ch_string >   gMapList;
 static bool                gRebuildMapList  = true;
 static float               gRebuildMapTimer = 0.f;
@@ -126,6 +133,7 @@ static AppModule_t gAppModulesClient[] =
 	{ (ISystem**)&render,    "ch_graphics_api_vk", IRENDER_NAME, IRENDER_VER },
 	{ (ISystem**)&audio,     "ch_aduio",     IADUIO_NAME, IADUIO_VER },
 	{ (ISystem**)&physics,   "ch_physics",   IPHYSICS_NAME, IPHYSICS_VER },
+	{ (ISystem**)&animation, "ch_animation", IANIMATION_NAME, IANIMATION_VER },
     { (ISystem**)&graphics,  "ch_render",  IGRAPHICS_NAME, IGRAPHICS_VER },
     { (ISystem**)&renderOld, "ch_render",  IRENDERSYSTEMOLD_NAME, IRENDERSYSTEMOLD_VER },
 	{ (ISystem**)&gui,       "ch_gui",       IGUI_NAME, IGUI_HASH },
@@ -136,6 +144,7 @@ static AppModule_t gAppModulesServer[] = {
 	{ (ISystem**)&input,     "ch_input", IINPUTSYSTEM_NAME, IINPUTSYSTEM_VER },
 	{ (ISystem**)&render,    "ch_graphics_api_vk", IRENDER_NAME, IRENDER_VER },
 	{ (ISystem**)&physics,   "ch_physics", IPHYSICS_NAME, IPHYSICS_VER },
+	{ (ISystem**)&animation, "ch_animation", IANIMATION_NAME, IANIMATION_VER },
 	{ (ISystem**)&graphics,  "ch_render", IGRAPHICS_NAME, IGRAPHICS_VER },
 	{ (ISystem**)&renderOld, "ch_render", IRENDERSYSTEMOLD_NAME, IRENDERSYSTEMOLD_VER },
 	{ (ISystem**)&gui,       "ch_gui", IGUI_NAME, IGUI_HASH },
@@ -444,29 +453,45 @@ void MainLoop()
 
 		// ftl::TaskCounter taskCounter( &gTaskScheduler );
 
-		input->Update( time );
+		{
+			TELEMETRY_SCOPE( Input );
+			input->Update( time );
 
-		if ( HandleEvents() )
-			return;
+			if ( HandleEvents() )
+				return;
+		}
 
 		Map_UpdateTimer( time );
 
 		gCurrentModule = ECurrentModule_Client;
 
-		client->PreUpdate( time );
+		{
+			TELEMETRY_SCOPE( Client );
+			client->PreUpdate( time );
+		}
 
 		float frameTimeScaled = time * host_timescale;
 		gCurrentModule        = ECurrentModule_Server;
 
 		// Update Game Logic
-		server->Update( frameTimeScaled );
+		{
+			TELEMETRY_SCOPE( Server );
+			server->Update( frameTimeScaled );
+		}
 
 		gCurrentModule = ECurrentModule_Client;
 
-		client->Update( frameTimeScaled );
+		{
+			TELEMETRY_SCOPE( Client );
+			client->Update( frameTimeScaled );
+		}
 
 		gCurrentModule = ECurrentModule_None;
 
+		// frees sounds the audio mixer is done with
+		if ( audio )
+			audio->Update( time );
+
 		Con_Update();
 
 		// Wait and help to execute unfinished tasks
@@ -474,9 +499,8 @@ void MainLoop()
 
 		startTime = currentTime;
 
-#ifdef TRACY_ENABLE
-		FrameMark;
-#endif
+		profile_end_frame();
+		Telemetry_EndFrame( time );
 	}
 }
 
@@ -498,10 +522,13 @@ void MainLoopDedicated()
 
 		// ftl::TaskCounter taskCounter( &gTaskScheduler );
 
-		input->Update( time );
+		{
+			TELEMETRY_SCOPE( Input );
+			input->Update( time );
 
-		if ( HandleEvents() )
-			return;
+			if ( HandleEvents() )
+				return;
+		}
 
 		Map_UpdateTimer( time );
 
@@ -509,7 +536,10 @@ void MainLoopDedicated()
 		gCurrentModule        = ECurrentModule_Server;
 
 		// Update Game Logic
-		server->Update( frameTimeScaled );
+		{
+			TELEMETRY_SCOPE( Server );
+			server->Update( frameTimeScaled );
+		}
 
 		gCurrentModule = ECurrentModule_None;
 
@@ -542,9 +572,8 @@ void MainLoopDedicated()
 
 		startTime = currentTime;
 
-#ifdef TRACY_ENABLE
-		FrameMark;
-#endif
+		profile_end_frame();
+		Telemetry_EndFrame( time );
 	}
 }
 
@@ -17,6 +17,7 @@ class ServerSystem final : public IServerSystem
 		//CH_GET_SYSTEM( render, IRender, IRENDER_NAME, IRENDER_VER );
 		//CH_GET_SYSTEM( audio, IAudioSystem, IADUIO_NAME, IADUIO_VER );
 		CH_GET_SYSTEM( ch_physics, Ch_IPhysics, IPHYSICS_NAME, IPHYSICS_VER );
+		CH_GET_SYSTEM( animation, IAnimationSystem, IANIMATION_NAME, IANIMATION_VER );
 		CH_GET_SYSTEM( graphics, IGraphics, IGRAPHICS_NAME, IGRAPHICS_VER );
 		//CH_GET_SYSTEM( gui, IGuiSystem, IGUI_NAME, IGUI_HASH );
 
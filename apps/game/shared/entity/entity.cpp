@@ -342,6 +342,7 @@ bool Entity_Init()
 	EntSysData().aActive = true;
 	EntSysData().aEntityPool.clear();
 	EntSysData().aComponentPools.clear();
+	EntSysData().aComponentPoolIDs.clear();
 	EntSysData().aEntityIDConvert.clear();
 
 	// Initialize the queue with all possible entity IDs
@@ -396,13 +397,18 @@ void Entity_Shutdown()
 
 	EntSysData().aEntityPool.clear();
 	EntSysData().aComponentPools.clear();
+	EntSysData().aComponentPoolIDs.clear();
 	EntSysData().aEntityIDConvert.clear();
 }
 
 
+TELEMETRY_REGISTER( Entities, 2.f );
+
+
 void Entity_UpdateSystems()
 {
 	PROF_SCOPE();
+	TELEMETRY_SCOPE( Entities );
 
 	for ( auto& [ name, pool ] : EntSysData().aComponentPools )
 	{
@@ -415,6 +421,7 @@ void Entity_UpdateSystems()
 void Entity_UpdateStates()
 {
 	PROF_SCOPE();
+	TELEMETRY_SCOPE( Entities );
 
 	// Remove Components Queued for Deletion
 	for ( auto& [ name, pool ] : EntSysData().aComponentPools )
@@ -472,6 +479,13 @@ void Entity_CreateComponentPool( const char* spName )
 		
 	EntSysData().aComponentPools[ spName ] = pool;
 
+	ch_str_id nameID = ch_str_intern( spName );
+
+	if ( nameID == CH_STR_ID_INVALID )
+		Log_ErrorF( gLC_Entity, "Failed to intern component name, it can't be found with CH_HASH: \"%s\"\n", spName );
+	else
+		EntSysData().aComponentPoolIDs[ nameID ] = pool;
+
 	// Create component system if it has one registered for it
 	if ( !pool->apData->apSystem )
 		return;
@@ -806,6 +820,22 @@ void* Entity_AddComponent( Entity entity, std::string_view sName )
 }
 
 
+void* Entity_AddComponent( Entity entity, ch_str_id sName )
+{
+	PROF_SCOPE();
+
+	auto pool = Entity_GetComponentPool( sName );
+
+	if ( pool == nullptr )
+	{
+		Log_ErrorF( gLC_Entity, "Failed to create component - no component pool found: \"%s\"\n", ch_str_intern_get( sName ).data );
+		return nullptr;
+	}
+
+	return pool->Create( entity );
+}
+
+
 // Does this entity have this component?
 bool Entity_HasComponent( Entity entity, std::string_view sName )
 {
@@ -823,6 +853,22 @@ bool Entity_HasComponent( Entity entity, std::string_view sName )
 }
 
 
+bool Entity_HasComponent( Entity entity, ch_str_id sName )
+{
+	PROF_SCOPE();
+
+	auto pool = Entity_GetComponentPool( sName );
+
+	if ( pool == nullptr )
+	{
+		Log_ErrorF( gLC_Entity, "Failed to get component - no component pool found: \"%s\"\n", ch_str_intern_get( sName ).data );
+		return false;
+	}
+
+	return pool->Contains( entity );
+}
+
+
 // Get a component from an entity
 void* Entity_GetComponent( Entity entity, std::string_view sName )
 {
@@ -840,6 +886,22 @@ void* Entity_GetComponent( Entity entity, std::string_view sName )
 }
 
 
+void* Entity_GetComponent( Entity entity, ch_str_id sName )
+{
+	PROF_SCOPE();
+
+	auto pool = Entity_GetComponentPool( sName );
+
+	if ( pool == nullptr )
+	{
+		Log_ErrorF( gLC_Entity, "Failed to get component - no component pool found: \"%s\"\n", ch_str_intern_get( sName ).data );
+		return nullptr;
+	}
+
+	return pool->GetData( entity );
+}
+
+
 // Remove a component from an entity
 void Entity_RemoveComponent( Entity entity, std::string_view sName )
 {
@@ -971,6 +1033,23 @@ EntityComponentPool* Entity_GetComponentPool( std::string_view spName )
 }
 
 
+EntityComponentPool* Entity_GetComponentPool( ch_str_id sName )
+{
+	PROF_SCOPE();
+
+	auto it = EntSysData().aComponentPoolIDs.find( sName );
+
+	if ( it == EntSysData().aComponentPoolIDs.end() )
+	{
+		ch_string name = ch_str_intern_get( sName );
+		Log_FatalF( gLC_Entity, "Component not registered before use: \"%s\" (id %u)\n", name.data ? name.data : "", (u32)sName );
+		return nullptr;
+	}
+
+	return it->second;
+}
+
+
 // Used for converting a sent entity ID to what it actually is on the recieving end, so no conflicts occur
 // This is needed for client/server networking, the entity id on each end will be different, so we convert the id
 Entity Entity_TranslateEntityID( Entity sEntity, bool sCreate )
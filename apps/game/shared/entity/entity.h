@@ -21,6 +21,7 @@ using Entity = size_t;
 #include "game_shared.h"
 #include "flatbuffers/sidury_generated.h"
 #include "igraphics.h"
+#include "ianimation.h"
 
 #include "iaudio.h"
 
@@ -687,6 +688,9 @@ struct EntitySystemData
 	// Component Pools - Pool of all of this type of component in existence
 	std::unordered_map< std::string_view, EntityComponentPool* > aComponentPools;
 
+	// Same as above, but the key is the interned component name, so CH_HASH( "transform" ) can find it without hashing a string
+	std::unordered_map< ch_str_id, EntityComponentPool* >        aComponentPoolIDs;
+
 	// All Component Systems, key is the type_hash() of the system
 	// NOTE: it's a bit strange to have them be stored here and one in each component pool
 	std::unordered_map< size_t, IEntityComponentSystem* >        aComponentSystems;
@@ -740,6 +744,9 @@ void                    Entity_GetChildrenRecurse( Entity sEntity, ChVector< Ent
 // Returns a Model Matrix with parents applied in world space IF we have a transform component
 bool                    Entity_GetWorldMatrix( glm::mat4& srMat, Entity sEntity );
 
+// World space transform of a bone on an entity with an animator component
+bool                    Entity_GetBoneWorldMatrix( glm::mat4& srMat, Entity sEntity, u32 sBone );
+
 // Same as GetWorldMatrix, but returns in a Transform struct
 Transform               Entity_GetWorldTransform( Entity sEntity );
 
@@ -766,6 +773,11 @@ bool                    Entity_HasComponent( Entity entity, std::string_view sNa
 // Get a component from an entity
 void*                   Entity_GetComponent( Entity entity, std::string_view sName );
 
+// Versions of these that take the component name id from CH_HASH, use these in code that runs every frame
+void*                   Entity_AddComponent( Entity entity, ch_str_id sName );
+bool                    Entity_HasComponent( Entity entity, ch_str_id sName );
+void*                   Entity_GetComponent( Entity entity, ch_str_id sName );
+
 // Remove a component from an entity
 void                    Entity_RemoveComponent( Entity entity, std::string_view sName );
 
@@ -788,6 +800,7 @@ bool                    Entity_IsNetworked( Entity sEntity, EEntityFlag sFlags )
 
 // Get the Component Pool for this Component
 EntityComponentPool*    Entity_GetComponentPool( std::string_view sName );
+EntityComponentPool*    Entity_GetComponentPool( ch_str_id sName );
 
 // Used for converting a sent entity ID to what it actually is on the recieving end, so no conflicts occur
 // This is needed for client/server networking, the entity id on each end will be different, so we convert the id
@@ -835,12 +848,23 @@ inline T* Ent_AddComponent( Entity sEnt, const char* spName )
 	return ch_pointer_cast< T >( Entity_AddComponent( sEnt, spName ) );
 }
 
+template< typename T >
+inline T* Ent_AddComponent( Entity sEnt, ch_str_id sName )
+{
+	return ch_pointer_cast< T >( Entity_AddComponent( sEnt, sName ) );
+}
+
 
 inline void* Ent_GetComponent( Entity sEnt, const char* spName )
 {
 	return Entity_GetComponent( sEnt, spName );
 }
 
+inline void* Ent_GetComponent( Entity sEnt, ch_str_id sName )
+{
+	return Entity_GetComponent( sEnt, sName );
+}
+
 // Gets a component and static cast's it to the desired type
 template< typename T >
 inline T* Ent_GetComponent( Entity sEnt, const char* spName )
@@ -848,6 +872,13 @@ inline T* Ent_GetComponent( Entity sEnt, const char* spName )
 	return ch_pointer_cast< T >( Entity_GetComponent( sEnt, spName ) );
 }
 
+// Same as above, but with the component name id from CH_HASH, which skips hashing the name every call
+template< typename T >
+inline T* Ent_GetComponent( Entity sEnt, ch_str_id sName )
+{
+	return ch_pointer_cast< T >( Entity_GetComponent( sEnt, sName ) );
+}
+
 
 bool Entity_Init();
 void Entity_Shutdown();
@@ -1267,6 +1298,34 @@ struct CRenderable
 };
 
 
+// Plays clips on a skeleton, on the server for hitboxes and on the client to pose the renderable
+struct CAnimator
+{
+	// glTF file with the skeleton and clips, usually the same file as the renderable
+	ComponentNetVar< std::string > aPath;
+
+	ComponentNetVar< std::string > aClip;
+	ComponentNetVar< float >       aTime      = 0.f;
+	ComponentNetVar< float >       aRate      = 1.f;
+	ComponentNetVar< bool >        aLoop      = true;
+
+	// blended over aClip by aBlend, 0 only plays aClip and 1 only plays this
+	ComponentNetVar< std::string > aBlendClip;
+	ComponentNetVar< float >       aBlendTime = 0.f;
+	ComponentNetVar< float >       aBlend     = 0.f;
+
+	// vars not registered
+	std::string                    aLoadedPath;
+	std::string                    aLoadedClip;
+	std::string                    aLoadedBlendClip;
+	u32                            aClipIndex      = CH_ANIM_INVALID;
+	u32                            aBlendClipIndex = CH_ANIM_INVALID;
+
+	ch_handle_t                    aAnimSet        = CH_INVALID_HANDLE;
+	ch_handle_t                    aPose           = CH_INVALID_HANDLE;
+};
+
+
 // wrapper for lights
 struct CLight
 {
@@ -1434,7 +1493,7 @@ Renderable_t* Ent_CreateRenderable( Entity sEntity );
 // This version has an option to enter a model handle
 inline Renderable_t* Ent_CreateRenderable( Entity sEntity, ch_handle_t sModel )
 {
-	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, "renderable" );
+	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, CH_HASH( "renderable" ) );
 
 	if ( !renderComp )
 	{
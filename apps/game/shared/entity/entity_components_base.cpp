@@ -61,6 +61,21 @@ CH_STRUCT_REGISTER_COMPONENT( CRenderable, renderable, EEntComponentNetType_Both
 }
 
 
+CH_STRUCT_REGISTER_COMPONENT( CAnimator, animator, EEntComponentNetType_Both, ECompRegFlag_None )
+{
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_StdString, std::string, aPath, path, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_StdString, std::string, aClip, clip, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_Float, float, aTime, time, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_Float, float, aRate, rate, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_Bool, bool, aLoop, loop, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_StdString, std::string, aBlendClip, blendClip, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_Float, float, aBlendTime, blendTime, ECompRegFlag_None );
+	CH_REGISTER_COMPONENT_VAR2( EEntNetField_Float, float, aBlend, blend, ECompRegFlag_None );
+
+	CH_REGISTER_COMPONENT_SYS2( EntSys_Animator, gEntSys_Animator );
+}
+
+
 // Probably should be in graphics?
 CH_STRUCT_REGISTER_COMPONENT( CLight, light, EEntComponentNetType_Both, ECompRegFlag_None )
 {
@@ -163,7 +178,7 @@ void Ent_RegisterBaseComponents()
 // Helper Functions
 ch_handle_t Ent_GetRenderableHandle( Entity sEntity )
 {
-	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, "renderable" );
+	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, CH_HASH( "renderable" ) );
 
 	if ( !renderComp )
 	{
@@ -177,7 +192,7 @@ ch_handle_t Ent_GetRenderableHandle( Entity sEntity )
 
 Renderable_t* Ent_GetRenderable( Entity sEntity )
 {
-	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, "renderable" );
+	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, CH_HASH( "renderable" ) );
 
 	if ( !renderComp )
 	{
@@ -192,7 +207,7 @@ Renderable_t* Ent_GetRenderable( Entity sEntity )
 // Requires the entity to have renderable component with a model path set
 Renderable_t* Ent_CreateRenderable( Entity sEntity )
 {
-	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, "renderable" );
+	auto renderComp = Ent_GetComponent< CRenderable >( sEntity, CH_HASH( "renderable" ) );
 
 	if ( !renderComp )
 	{
@@ -115,7 +115,7 @@ void LightSystem::Update()
 #if CH_CLIENT
 	for ( Entity entity : aEntities )
 	{
-		auto light = Ent_GetComponent< CLight >( entity, "light" );
+		auto light = Ent_GetComponent< CLight >( entity, CH_HASH( "light" ) );
 
 		if ( !light )
 			continue;
@@ -176,7 +176,7 @@ void EntSys_ModelInfo::Update()
 {
 	for ( Entity entity : aEntities )
 	{
-		auto modelInfo = Ent_GetComponent< CModelInfo >( entity, "modelInfo" );
+		auto modelInfo = Ent_GetComponent< CModelInfo >( entity, CH_HASH( "modelInfo" ) );
 
 		CH_ASSERT( modelInfo );
 
@@ -188,7 +188,7 @@ void EntSys_ModelInfo::Update()
 		if ( handleUpdated )
 		{
 			// HACK: PASS THROUGH TO AUTO RENDERABLE
-			void* autoRenderable = Ent_GetComponent( entity, "autoRenderable" );
+			void* autoRenderable = Ent_GetComponent( entity, CH_HASH( "autoRenderable" ) );
 
 			if ( autoRenderable )
 				GetAutoRenderableSys()->ComponentUpdated( entity, autoRenderable );
@@ -312,7 +312,7 @@ void EntSys_Renderable::Update()
 		if ( !Entity_GetWorldMatrix( matrix, entity ) )
 			continue;
 
-		auto renderComp = Ent_GetComponent< CRenderable >( entity, "renderable" );
+		auto renderComp = Ent_GetComponent< CRenderable >( entity, CH_HASH( "renderable" ) );
 
 		if ( !renderComp )
 		{
@@ -343,3 +343,177 @@ EntSys_Renderable& GetRenderableEntSys()
 	return gEntSys_Renderable;
 }
 
+
+
+// ------------------------------------------------------------
+
+
+// Loads the anim set and finds the clips when their names change, returns false if there's nothing to animate
+static bool UpdateAnimatorHandles( CAnimator* spAnimator )
+{
+	PROF_SCOPE();
+
+	if ( spAnimator->aLoadedPath != spAnimator->aPath.Get() )
+	{
+		if ( spAnimator->aPose != CH_INVALID_HANDLE )
+			animation->FreePose( spAnimator->aPose );
+
+		if ( spAnimator->aAnimSet != CH_INVALID_HANDLE )
+			animation->FreeAnimSet( spAnimator->aAnimSet );
+
+		spAnimator->aPose       = CH_INVALID_HANDLE;
+		spAnimator->aAnimSet    = CH_INVALID_HANDLE;
+		spAnimator->aLoadedPath = spAnimator->aPath.Get();
+
+		// find the clips again in the new set
+		spAnimator->aLoadedClip.clear();
+		spAnimator->aLoadedBlendClip.clear();
+		spAnimator->aClipIndex      = CH_ANIM_INVALID;
+		spAnimator->aBlendClipIndex = CH_ANIM_INVALID;
+
+		if ( spAnimator->aLoadedPath.size() )
+			spAnimator->aAnimSet = animation->LoadAnimSet( spAnimator->aLoadedPath );
+
+		if ( spAnimator->aAnimSet != CH_INVALID_HANDLE )
+			spAnimator->aPose = animation->CreatePose( spAnimator->aAnimSet );
+	}
+
+	if ( spAnimator->aPose == CH_INVALID_HANDLE )
+		return false;
+
+	if ( spAnimator->aLoadedClip != spAnimator->aClip.Get() )
+	{
+		spAnimator->aLoadedClip = spAnimator->aClip.Get();
+		spAnimator->aClipIndex  = animation->FindClip( spAnimator->aAnimSet, spAnimator->aLoadedClip );
+	}
+
+	if ( spAnimator->aLoadedBlendClip != spAnimator->aBlendClip.Get() )
+	{
+		spAnimator->aLoadedBlendClip = spAnimator->aBlendClip.Get();
+		spAnimator->aBlendClipIndex  = animation->FindClip( spAnimator->aAnimSet, spAnimator->aLoadedBlendClip );
+	}
+
+	return true;
+}
+
+
+// looping clips wrap here so the networked time doesn't grow forever
+static float AdvanceAnimTime( ch_handle_t sAnimSet, u32 sClip, float sTime, float sStep, bool sLoop )
+{
+	float length = animation->GetClipLength( sAnimSet, sClip );
+	float time   = sTime + sStep;
+
+	if ( length <= 0.f )
+		return 0.f;
+
+	if ( !sLoop )
+		return std::clamp( time, 0.f, length );
+
+	time = fmodf( time, length );
+	return time < 0.f ? time + length : time;
+}
+
+
+void EntSys_Animator::ComponentRemoved( Entity sEntity, void* spData )
+{
+	auto animator = static_cast< CAnimator* >( spData );
+
+	if ( animator->aPose != CH_INVALID_HANDLE )
+		animation->FreePose( animator->aPose );
+
+	if ( animator->aAnimSet != CH_INVALID_HANDLE )
+		animation->FreeAnimSet( animator->aAnimSet );
+}
+
+
+void EntSys_Animator::Update()
+{
+	PROF_SCOPE();
+
+	// the server runs this too, so bones are available for hitboxes
+	for ( Entity entity : aEntities )
+	{
+		auto animator = Ent_GetComponent< CAnimator >( entity, CH_HASH( "animator" ) );
+
+		if ( !animator || !UpdateAnimatorHandles( animator ) )
+			continue;
+
+		float       step       = gFrameTime * animator->aRate;
+		float       blend      = std::clamp( animator->aBlend.Get(), 0.f, 1.f );
+		AnimLayer_t layers[ 2 ] = {};
+		u32         layerCount = 0;
+
+		if ( animator->aClipIndex != CH_ANIM_INVALID )
+		{
+			animator->aTime.Set( AdvanceAnimTime( animator->aAnimSet, animator->aClipIndex, animator->aTime, step, animator->aLoop ) );
+
+			layers[ layerCount ].aClip   = animator->aClipIndex;
+			layers[ layerCount ].aTime   = animator->aTime;
+			layers[ layerCount ].aWeight = 1.f - blend;
+			layers[ layerCount ].aLoop   = animator->aLoop;
+			layerCount++;
+		}
+
+		if ( animator->aBlendClipIndex != CH_ANIM_INVALID )
+		{
+			animator->aBlendTime.Set( AdvanceAnimTime( animator->aAnimSet, animator->aBlendClipIndex, animator->aBlendTime, step, animator->aLoop ) );
+
+			layers[ layerCount ].aClip   = animator->aBlendClipIndex;
+			layers[ layerCount ].aTime   = animator->aBlendTime;
+			layers[ layerCount ].aWeight = blend;
+			layers[ layerCount ].aLoop   = animator->aLoop;
+			layerCount++;
+		}
+
+		animation->SetPoseLayers( animator->aPose, layers, layerCount );
+	}
+
+	// every pose is evaluated at once across the animation worker threads
+	animation->EvaluatePoses();
+
+#if CH_CLIENT
+	for ( Entity entity : aEntities )
+	{
+		auto animator = Ent_GetComponent< CAnimator >( entity, CH_HASH( "animator" ) );
+
+		if ( !animator || animator->aPose == CH_INVALID_HANDLE )
+			continue;
+
+		auto renderComp = Ent_GetComponent< CRenderable >( entity, CH_HASH( "renderable" ) );
+
+		if ( !renderComp || renderComp->aRenderable == CH_INVALID_HANDLE )
+			continue;
+
+		u32              boneCount = 0;
+		const glm::mat4* bones     = animation->GetPoseSkinMatrices( animator->aPose, boneCount );
+
+		if ( bones )
+			graphics->SetRenderableBones( renderComp->aRenderable, bones, boneCount );
+	}
+#endif
+}
+
+
+EntSys_Animator gEntSys_Animator;
+
+
+bool Entity_GetBoneWorldMatrix( glm::mat4& srMat, Entity sEntity, u32 sBone )
+{
+	auto animator = Ent_GetComponent< CAnimator >( sEntity, CH_HASH( "animator" ) );
+
+	if ( !animator || animator->aPose == CH_INVALID_HANDLE )
+		return false;
+
+	u32              boneCount = 0;
+	const glm::mat4* bones     = animation->GetPoseBones( animator->aPose, boneCount );
+
+	if ( sBone >= boneCount )
+		return false;
+
+	// no transform just leaves this in model space
+	glm::mat4 world( 1.f );
+	Entity_GetWorldMatrix( world, sEntity );
+
+	srMat = world * bones[ sBone ];
+	return true;
+}
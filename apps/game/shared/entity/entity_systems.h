@@ -54,3 +54,19 @@ extern EntSys_Renderable gEntSys_Renderable;
 EntSys_Renderable&       GetRenderableEntSys();
 
 
+
+
+// ------------------------------------------------------------
+
+
+class EntSys_Animator : public IEntityComponentSystem
+{
+  public:
+	EntSys_Animator() {}
+	~EntSys_Animator() {}
+
+	void ComponentRemoved( Entity sEntity, void* spData ) override;
+	void Update() override;
+};
+
+extern EntSys_Animator gEntSys_Animator;
@@ -228,7 +228,7 @@ bool Phys_CreatePhysShapeComponent( CPhysShape* compPhysShape )
 
 static void OnCreatePhysShape( Entity sEntity, CPhysShape* compPhysShape )
 {
-	auto physObject = Ent_GetComponent< CPhysObject >( sEntity, "physObject" );
+	auto physObject = Ent_GetComponent< CPhysObject >( sEntity, CH_HASH( "physObject" ) );
 
 	if ( !physObject || !physObject->apObj )
 		return;
@@ -279,7 +279,7 @@ void EntSys_PhysShape::Update()
 {
 	for ( Entity entity : aEntities )
 	{
-		auto physShape  = Ent_GetComponent< CPhysShape >( entity, "physShape" );
+		auto physShape  = Ent_GetComponent< CPhysShape >( entity, CH_HASH( "physShape" ) );
 
 		CH_ASSERT( physShape );
 
@@ -321,7 +321,7 @@ static void CreatePhysObjectComponent( Entity sEntity, CPhysShape* srCompShape,
 	physObjectInfo.aCustomMass         = srCompObject->aCustomMass;
 	physObjectInfo.aMass               = srCompObject->aMass;
 
-	auto transform                     = Ent_GetComponent< CTransform >( sEntity, "transform" );
+	auto transform                     = Ent_GetComponent< CTransform >( sEntity, CH_HASH( "transform" ) );
 
 	if ( transform )
 	{
@@ -378,8 +378,8 @@ void EntSys_PhysObject::Update()
 
 	for ( Entity entity : aEntities )
 	{
-		auto physShape = Ent_GetComponent< CPhysShape >( entity, "physShape" );
-		auto physObject = Ent_GetComponent< CPhysObject >( entity, "physObject" );
+		auto physShape = Ent_GetComponent< CPhysShape >( entity, CH_HASH( "physShape" ) );
+		auto physObject = Ent_GetComponent< CPhysObject >( entity, CH_HASH( "physObject" ) );
 
 		CH_ASSERT( physShape );
 		CH_ASSERT( physObject );
@@ -405,7 +405,7 @@ void EntSys_PhysObject::Update()
 		if ( physObject->aIsSensor.aIsDirty )
 			physObject->apObj->SetSensor( physObject->aIsSensor );
 
-		auto transform = Ent_GetComponent< CTransform >( entity, "transform" );
+		auto transform = Ent_GetComponent< CTransform >( entity, CH_HASH( "transform" ) );
 
 		if ( !transform )
 			continue;
@@ -901,9 +901,14 @@ void Phys_DestroyEnv()
 }
 
 
+TELEMETRY_REGISTER( Physics, 2.f );
+
+
 void Phys_Simulate( IPhysicsEnvironment* spPhysEnv, float sFrameTime )
 {
 	PROF_SCOPE();
+	TELEMETRY_SCOPE( Physics );
+
 	if ( !spPhysEnv )
 		return;
 
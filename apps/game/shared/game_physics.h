@@ -137,8 +137,8 @@ bool                      Phys_CreatePhysShapeComponent( CPhysShape* compPhysSha
 extern Ch_IPhysics*       ch_physics;
 
 // Helper functions for getting the wrapper physics components
-inline auto GetComp_PhysShape( Entity ent )  { return Ent_GetComponent< CPhysShape >( ent, "physShape" ); }
-inline auto GetComp_PhysObject( Entity ent ) { return Ent_GetComponent< CPhysObject >( ent, "physObject" ); }
+inline auto GetComp_PhysShape( Entity ent )  { return Ent_GetComponent< CPhysShape >( ent, CH_HASH( "physShape" ) ); }
+inline auto GetComp_PhysObject( Entity ent ) { return Ent_GetComponent< CPhysObject >( ent, CH_HASH( "physObject" ) ); }
 
 inline IPhysicsShape* GetComp_PhysShapePtr( Entity ent )
 {
@@ -27,6 +27,7 @@ IInputSystem*     input     = nullptr;
 IGraphics*        graphics  = nullptr;
 IRenderSystemOld* renderOld = nullptr;
 ISteamSystem*     steam     = nullptr;
+IAnimationSystem* animation = nullptr;
 
 #if CH_CLIENT
 IGuiSystem*   gui    = nullptr;
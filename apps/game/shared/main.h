@@ -7,6 +7,7 @@
 #include "iinput.h"
 #include "igui.h"
 #include "iaudio.h"
+#include "ianimation.h"
 #include "physics/iphysics.h"
 #include "render/irender.h"
 #include "igraphics.h"
@@ -36,11 +37,13 @@ class IAudioSystem;
 class IGraphics;
 class IRenderSystemOld;
 class ISteamSystem;
+class IAnimationSystem;
 
 extern IInputSystem*     input;
 extern IGraphics*        graphics;
 extern IRenderSystemOld* renderOld;
 extern ISteamSystem*     steam;
+extern IAnimationSystem* animation;
 extern bool              gSteamLoaded;
 
 #if CH_CLIENT
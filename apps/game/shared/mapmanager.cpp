@@ -95,13 +95,170 @@ bool MapManager_MapExists( const std::string& path )
 }
 
 
-static bool MapManager_LoadScene( chmap::Scene& scene )
+static EntityComponentPool* MapManager_GetPool( const char* spName, u32 sCount )
 {
-	std::unordered_map< u32, ch_handle_t > entityHandles;
+	EntityComponentPool* pool = Entity_GetComponentPool( spName );
 
-	for ( chmap::Entity& mapEntity : scene.entites )
+	if ( pool == nullptr )
 	{
-		Entity ent = Entity_CreateEntity();
+		Log_ErrorF( gLC_Map, "Failed to create component - no component pool found: \"%s\"\n", spName );
+		return nullptr;
+	}
+
+	pool->aMapComponentToEntity.reserve( pool->aMapComponentToEntity.size() + sCount );
+	pool->aMapEntityToComponent.reserve( pool->aMapEntityToComponent.size() + sCount );
+	pool->aComponentIDs.reserve( pool->aComponentIDs.size() + sCount );
+	return pool;
+}
+
+
+static void MapManager_LoadRenderable( Entity ent, chmap::Component& comp, EntityComponentPool* pool )
+{
+	auto it = comp.values.find( "path" );
+	if ( it == comp.values.end() )
+	{
+		Log_Error( gLC_Map, "Failed to find renderable model path in component\n" );
+		return;
+	}
+
+	if ( it->second.type != chmap::EComponentType_String )
+		return;
+
+	auto renderable   = ch_pointer_cast< CRenderable >( pool->Create( ent ) );
+	renderable->aPath = it->second.aString.data;
+
+	// Load other renderable data
+	// for ( const auto& [ name, compValue ] : comp.values )
+	// {
+	// }
+}
+
+
+static void MapManager_LoadLight( Entity ent, chmap::Component& comp, EntityComponentPool* pool )
+{
+	auto it = comp.values.find( "type" );
+	if ( it == comp.values.end() )
+	{
+		Log_Error( gLC_Map, "Failed to find light type in component\n" );
+		return;
+	}
+
+	if ( it->second.type != chmap::EComponentType_String )
+		return;
+
+	ELightType type;
+
+	if ( ch_str_equals( it->second.aString, "world", 5 ) )
+	{
+		type = ELightType_World;
+	}
+	else if ( ch_str_equals( it->second.aString, "point", 5 ) )
+	{
+		type = ELightType_Point;
+	}
+	else if ( ch_str_equals( it->second.aString, "spot", 4 ) )
+	{
+		type = ELightType_Spot;
+	}
+	// else if ( ch_str_equals( it->second.aString, "capsule" ))
+	// {
+	// 	type = ELightType_Capsule;
+	// }
+	else
+	{
+		Log_ErrorF( gLC_Map, "Unknown Light Type: %s\n", it->second.aString.data );
+		return;
+	}
+
+	auto light   = ch_pointer_cast< CLight >( pool->Create( ent ) );
+	light->aType = type;
+
+	// Read the rest of the light data
+	for ( const auto& [ name, compValue ] : comp.values )
+	{
+		if ( ch_str_equals( name.data(), name.size(), "color", 5 ) )
+		{
+			if ( compValue.type != chmap::EComponentType_Vec4 )
+				continue;
+
+			light->color = compValue.aVec4;
+		}
+		else if ( ch_str_equals( name.data(), name.size(), "radius", 6 ) )
+		{
+			if ( compValue.type == chmap::EComponentType_Int )
+				light->aRadius = compValue.aInteger;
+
+			else if ( compValue.type == chmap::EComponentType_Double )
+				light->aRadius = compValue.aDouble;
+		}
+	}
+}
+
+
+static void MapManager_LoadPhysObject( Entity ent, chmap::Component& comp, EntityComponentPool* shapePool, EntityComponentPool* objectPool )
+{
+	auto it = comp.values.find( "path" );
+	if ( it == comp.values.end() )
+	{
+		Log_Error( gLC_Map, "Failed to find physics object path in component\n" );
+		return;
+	}
+
+	auto itType = comp.values.find( "type" );
+	if ( itType == comp.values.end() )
+	{
+		Log_Error( gLC_Map, "Failed to find physics object type in component\n" );
+		return;
+	}
+
+	// why did you keep it split up like this?
+	auto physShape   = ch_pointer_cast< CPhysShape >( shapePool->Create( ent ) );
+	auto physObject  = ch_pointer_cast< CPhysObject >( objectPool->Create( ent ) );
+
+	physShape->aPath = it->second.aString.data;
+
+	if ( ch_str_equals( itType->second.aString, "convex", 6 ) )
+	{
+		physObject->aStartActive   = true;
+		physObject->aMass          = 10.f;
+		physObject->aTransformMode = EPhysTransformMode_Update;
+		physShape->aShapeType      = PhysShapeType::Convex;
+	}
+	else if ( ch_str_equals( itType->second.aString, "static_compound", 15 ) )
+	{
+		physObject->aStartActive   = true;
+		physObject->aMass          = 10.f;
+		physObject->aCustomMass    = true;
+		physObject->aTransformMode = EPhysTransformMode_Update;
+		physObject->aMotionType    = PhysMotionType::Dynamic;
+		physObject->aAllowSleeping = false;
+		physShape->aShapeType      = PhysShapeType::StaticCompound;
+	}
+	else if ( ch_str_equals( itType->second.aString, "mesh", 4 ) )
+		physShape->aShapeType = PhysShapeType::Mesh;
+	else
+		physShape->aShapeType = PhysShapeType::Convex;
+}
+
+
+// Components are created a whole column at a time, so each component pool is only looked up once per scene
+static bool MapManager_LoadScene( chmap::Map& map, chmap::Scene& scene )
+{
+	u32                          count = scene.entites.size();
+	std::vector< Entity >        entities( count );
+	std::unordered_map< u64, u32 > idToIndex;
+
+	idToIndex.reserve( count );
+
+	EntityComponentPool* transformPool = MapManager_GetPool( "transform", count );
+
+	if ( !transformPool )
+		return false;
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		chmap::Entity& mapEntity = scene.entites[ i ];
+		Entity         ent       = Entity_CreateEntity();
 
 		if ( ent == CH_ENT_INVALID )
 		{
@@ -109,164 +266,70 @@ static bool MapManager_LoadScene( chmap::Scene& scene )
 		}
 
 		// Entity_SetName( ent, mapEntity.name );
-		entityHandles[ mapEntity.id ] = ent;
+		entities[ i ]               = ent;
+		idToIndex[ mapEntity.id ]   = i;
+
+		auto transform              = ch_pointer_cast< CTransform >( transformPool->Create( ent ) );
 
-		auto transform                = Ent_AddComponent< CTransform >( ent, "transform" );
+		transform->aPos             = mapEntity.pos;
+		transform->aAng             = mapEntity.ang;
+		transform->aScale           = mapEntity.scale;
+	}
 
-		transform->aPos               = mapEntity.pos;
-		transform->aAng               = mapEntity.ang;
-		transform->aScale             = mapEntity.scale;
+	// Check Built in components (TODO: IMPROVE THIS)
+	for ( chmap::ComponentColumn& column : scene.columns )
+	{
+		std::string_view type      = map.componentTypes[ column.type ];
+		u32              compCount = column.entities.size();
 
-		// Check Built in components (TODO: IMPROVE THIS)
-		for ( chmap::Component& comp : mapEntity.components )
+		if ( type == "renderable" )
 		{
-			// Load a renderable
-			if ( ch_str_equals( comp.name, "renderable", 10 ) )
-			{
-				auto it = comp.values.find( "path" );
-				if ( it == comp.values.end() )
-				{
-					Log_Error( gLC_Map, "Failed to find renderable model path in component\n" );
-					continue;
-				}
-
-				if ( it->second.type != chmap::EComponentType_String )
-					continue;
-
-				auto renderable   = Ent_AddComponent< CRenderable >( ent, "renderable" );
-				renderable->aPath = it->second.aString.data;
-
-				// Load other renderable data
-				// for ( const auto& [ name, compValue ] : comp.values )
-				// {
-				// }
-			}
-			else if ( ch_str_equals( comp.name, "light", 5 ) )
-			{
-				auto it = comp.values.find( "type" );
-				if ( it == comp.values.end() )
-				{
-					Log_Error( gLC_Map, "Failed to find light type in component\n" );
-					continue;
-				}
-
-				if ( it->second.type != chmap::EComponentType_String )
-					continue;
-
-				auto light = Ent_AddComponent< CLight >( ent, "light" );
-
-				if ( ch_str_equals( it->second.aString, "world", 5 ) )
-				{
-					light->aType = ELightType_World;
-				}
-				else if ( ch_str_equals( it->second.aString, "point", 5 ) )
-				{
-					light->aType = ELightType_Point;
-				}
-				else if ( ch_str_equals( it->second.aString, "spot", 4 ) )
-				{
-					light->aType = ELightType_Spot;
-				}
-				// else if ( ch_str_equals( it->second.aString, "capsule" ))
-				// {
-				// 	light->aType = ELightType_Capsule;
-				// }
-				else
-				{
-					Log_ErrorF( gLC_Map, "Unknown Light Type: %s\n", it->second.aString.data );
-					continue;
-				}
-
-				// Read the rest of the light data
-				for ( const auto& [ name, compValue ] : comp.values )
-				{
-					if ( ch_str_equals( name.data(), name.size(), "color", 5 ) )
-					{
-						if ( compValue.type != chmap::EComponentType_Vec4 )
-							continue;
-
-						light->color = compValue.aVec4;
-					}
-					else if ( ch_str_equals( name.data(), name.size(), "radius", 6 ) )
-					{
-						if ( compValue.type == chmap::EComponentType_Int )
-							light->aRadius = compValue.aInteger;
-
-						else if ( compValue.type == chmap::EComponentType_Double )
-							light->aRadius = compValue.aDouble;
-					}
-				}
-			}
-			else if ( ch_str_equals( comp.name, "phys_object", 11 ) )
-			{
-				auto it = comp.values.find( "path" );
-				if ( it == comp.values.end() )
-				{
-					Log_Error( gLC_Map, "Failed to find physics object path in component\n" );
-					continue;
-				}
-
-				auto itType = comp.values.find( "type" );
-				if ( itType == comp.values.end() )
-				{
-					Log_Error( gLC_Map, "Failed to find physics object type in component\n" );
-					continue;
-				}
-
-				// why did you keep it split up like this?
-				auto physShape   = Ent_AddComponent< CPhysShape >( ent, "physShape" );
-				auto physObject  = Ent_AddComponent< CPhysObject >( ent, "physObject" );
-
-				physShape->aPath = it->second.aString.data;
-
-				if ( ch_str_equals( itType->second.aString, "convex", 6 ) )
-				{
-					physObject->aStartActive   = true;
-					physObject->aMass          = 10.f;
-					physObject->aTransformMode = EPhysTransformMode_Update;
-					physShape->aShapeType      = PhysShapeType::Convex;
-				}
-				else if ( ch_str_equals( itType->second.aString, "static_compound", 15 ) )
-				{
-					physObject->aStartActive   = true;
-					physObject->aMass          = 10.f;
-					physObject->aCustomMass    = true;
-					physObject->aTransformMode = EPhysTransformMode_Update;
-					physObject->aMotionType    = PhysMotionType::Dynamic;
-					physObject->aAllowSleeping = false;
-					physShape->aShapeType      = PhysShapeType::StaticCompound;
-				}
-				else if ( ch_str_equals( itType->second.aString, "mesh", 4 ) )
-					physShape->aShapeType = PhysShapeType::Mesh;
-				else
-					physShape->aShapeType = PhysShapeType::Convex;
-
-			}
-			else
-			{
-				// TODO: Try to search for this component
-
-			}
+			EntityComponentPool* pool = MapManager_GetPool( "renderable", compCount );
+
+			for ( u32 i = 0; pool && i < compCount; i++ )
+				MapManager_LoadRenderable( entities[ column.entities[ i ] ], scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ], pool );
+		}
+		else if ( type == "light" )
+		{
+			EntityComponentPool* pool = MapManager_GetPool( "light", compCount );
+
+			for ( u32 i = 0; pool && i < compCount; i++ )
+				MapManager_LoadLight( entities[ column.entities[ i ] ], scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ], pool );
+		}
+		else if ( type == "phys_object" )
+		{
+			EntityComponentPool* shapePool  = MapManager_GetPool( "physShape", compCount );
+			EntityComponentPool* objectPool = MapManager_GetPool( "physObject", compCount );
+
+			for ( u32 i = 0; shapePool && objectPool && i < compCount; i++ )
+				MapManager_LoadPhysObject( entities[ column.entities[ i ] ], scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ], shapePool, objectPool );
+		}
+		else
+		{
+			// TODO: Try to search for this component
 		}
 	}
 
-	// Check entity parents
-	for ( chmap::Entity& mapEntity : scene.entites )
+	// Check entity parents, parents come before their children here
+	for ( u32 index : scene.parentOrder )
 	{
+		chmap::Entity& mapEntity = scene.entites[ index ];
+
 		if ( mapEntity.parent == UINT32_MAX )
 			continue;
 
-		auto itID     = entityHandles.find( mapEntity.id );
-		auto itParent = entityHandles.find( mapEntity.parent );
+		auto itParent = idToIndex.find( mapEntity.parent );
 
-		if ( itID == entityHandles.end() || itParent == entityHandles.end() )
+		if ( itParent == idToIndex.end() )
 		{
 			Log_ErrorF( "Failed to parent entity %d", mapEntity.id );
 			continue;
 		}
 
-		Entity_ParentEntity( itID->second, itParent->second );
+		Entity_ParentEntity( entities[ index ], entities[ itParent->second ] );
 	}
+
+	return true;
 }
 
 
@@ -293,7 +356,7 @@ bool MapManager_LoadMap( const std::string& path )
 	// Only load the primary scene for now
 	// Each scene gets it's own editor context
 	// TODO: make an editor project system
-	if ( !MapManager_LoadScene( map->scenes[ map->primaryScene ] ) )
+	if ( !MapManager_LoadScene( *map, map->scenes[ map->primaryScene ] ) )
 	{
 		Log_ErrorF( gLC_Map, "Failed to Load Primary Scene: \"%s\" - Scene \"%s\"\n", path.c_str(), map->scenes[ map->primaryScene ].name );
 		return false;
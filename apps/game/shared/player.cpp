@@ -365,7 +365,7 @@ bool PlayerManager::SetCurrentPlayer( Entity player )
 	apMove->apCamDir       = GetComp_Direction( playerInfo->aCamera );
 	apMove->apCamera       = GetCamera( playerInfo->aCamera );
 
-	apMove->apDir          = Ent_GetComponent< CDirection >( player, "direction" );
+	apMove->apDir          = Ent_GetComponent< CDirection >( player, CH_HASH( "direction" ) );
 	apMove->apRigidBody    = GetRigidBody( player );
 	apMove->apTransform    = GetTransform( player );
 	apMove->apCharacter    = apMove->apCharacter;
@@ -391,7 +391,7 @@ void PlayerManager::Init()
 
 void PlayerManager::Create( Entity player )
 {
-	CPlayerInfo* playerInfo = Ent_GetComponent< CPlayerInfo >( player, "playerInfo" );
+	CPlayerInfo* playerInfo = Ent_GetComponent< CPlayerInfo >( player, CH_HASH( "playerInfo" ) );
 	CH_ASSERT( playerInfo );
 
 #if CH_CLIENT
@@ -613,10 +613,10 @@ void Player_UpdateFlashlight( Entity player, bool sToggle )
 	CH_ASSERT( playerInfo->aCamera );
 
 	CTransform* transform    = GetTransform( player );
-	CLight*     flashlight   = Ent_GetComponent< CLight >( player, "light" );
+	CLight*     flashlight   = Ent_GetComponent< CLight >( player, CH_HASH( "light" ) );
 
 	CTransform* camTransform = GetTransform( playerInfo->aCamera );
-	auto        camDir       = Ent_GetComponent< CDirection >( playerInfo->aCamera, "direction" );
+	auto        camDir       = Ent_GetComponent< CDirection >( playerInfo->aCamera, CH_HASH( "direction" ) );
 
 	CH_ASSERT( transform );
 	CH_ASSERT( camTransform );
@@ -758,7 +758,7 @@ void PlayerManager::UpdateLocalPlayer()
 
 		auto     playerMove = GetPlayerMoveData( player );
 		auto     transform  = GetTransform( player );
-		CLight*  flashlight = Ent_GetComponent< CLight >( player, "light" );
+		CLight*  flashlight = Ent_GetComponent< CLight >( player, CH_HASH( "light" ) );
 
 		auto     camTransform = GetTransform( playerInfo->aCamera );
 		// auto     camera     = GetCamera( playerInfo->aCamera );
@@ -800,7 +800,7 @@ void PlayerManager::UpdateLocalPlayer()
 		// if ( ( cl_thirdperson && cl_playermodel_enable ) || !playerInfo->aIsLocalPlayer )
 		if ( cl_playermodel_enable && ( cl_thirdperson || !playerInfo->aIsLocalPlayer ) )
 		{
-			auto renderComp = Ent_GetComponent< CRenderable >( player, "renderable" );
+			auto renderComp = Ent_GetComponent< CRenderable >( player, CH_HASH( "renderable" ) );
 
 			// I hate this so much
 			if ( renderComp->aRenderable == CH_INVALID_HANDLE )
@@ -878,7 +878,7 @@ void PlayerManager::UpdateLocalPlayer()
 		else
 		{
 			// Make sure this thing is hidden
-			auto renderComp = Ent_GetComponent< CRenderable >( player, "renderable" );
+			auto renderComp = Ent_GetComponent< CRenderable >( player, CH_HASH( "renderable" ) );
 			if ( renderComp->aRenderable == CH_INVALID_HANDLE )
 				continue;
 
@@ -1245,7 +1245,7 @@ void PlayerMovement::SetPlayer( Entity player )
 	apMove         = GetPlayerMoveData( player );
 	apRigidBody    = GetRigidBody( player );
 	apTransform    = GetTransform( player );
-	apDir          = Ent_GetComponent< CDirection >( player, "direction" );
+	apDir          = Ent_GetComponent< CDirection >( player, CH_HASH( "direction" ) );
 
 #if CH_SERVER
 	apCharacter = apMove->apCharacter;
@@ -1517,7 +1517,7 @@ void PlayerMovement::DisplayPlayerStats( Entity player ) const
 	CTransform* camTransform = GetTransform( playerInfo->aCamera );
 	CCamera*    camera       = GetCamera( playerInfo->aCamera );
 
-	auto        flashlight   = Ent_GetComponent< CLight >( player, "light" );
+	auto        flashlight   = Ent_GetComponent< CLight >( player, CH_HASH( "light" ) );
 
 	float speed        = glm::length( glm::vec2( rigidBody->aVel.Get().x, rigidBody->aVel.Get().y ) );
 
@@ -2209,7 +2209,7 @@ void PlayerMovement::DoSmoothLand( bool wasOnGround )
 			apMove->aLandTime  = 0.f;
 
 			// This is shoddy and is only here to be funny
-			auto health        = Ent_GetComponent< CHealth >( aPlayer, "health" );
+			auto health        = Ent_GetComponent< CHealth >( aPlayer, CH_HASH( "health" ) );
 			health->aHealth.Edit() -= ( landVel * 50 );
 		}
 
@@ -2459,7 +2459,7 @@ Transform PlayerSpawnManager::SelectSpawnTransform()
 	if ( aEntities.size() > 1 )
 		index = rand_u64( 0, aEntities.size() - 1 );
 	
-	auto transform = Ent_GetComponent< CTransform >( aEntities[ index ], "transform" );
+	auto transform = Ent_GetComponent< CTransform >( aEntities[ index ], CH_HASH( "transform" ) );
 
 	if ( !transform )
 	{
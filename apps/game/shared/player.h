@@ -274,11 +274,11 @@ class PlayerSpawnManager : public IEntityComponentSystem
 
 
 // convinence
-inline auto GetPlayerMoveData( Entity ent ) { return Ent_GetComponent< CPlayerMoveData >( ent, "playerMoveData" ); }
-inline auto GetPlayerZoom( Entity ent )     { return Ent_GetComponent< CPlayerZoom >(  ent, "playerZoom" ); }
-inline auto GetPlayerInfo( Entity ent )     { return Ent_GetComponent< CPlayerInfo >( ent, "playerInfo" ); }
-inline auto GetTransform( Entity ent )      { return Ent_GetComponent< CTransform >( ent, "transform" ); }
-inline auto GetCamera( Entity ent )         { return Ent_GetComponent< CCamera >( ent, "camera" ); }
-inline auto GetRigidBody( Entity ent )      { return Ent_GetComponent< CRigidBody >( ent, "rigidBody" ); }
-inline auto GetComp_Direction( Entity ent ) { return Ent_GetComponent< CDirection >( ent, "direction" ); }
+inline auto GetPlayerMoveData( Entity ent ) { return Ent_GetComponent< CPlayerMoveData >( ent, CH_HASH( "playerMoveData" ) ); }
+inline auto GetPlayerZoom( Entity ent )     { return Ent_GetComponent< CPlayerZoom >(  ent, CH_HASH( "playerZoom" ) ); }
+inline auto GetPlayerInfo( Entity ent )     { return Ent_GetComponent< CPlayerInfo >( ent, CH_HASH( "playerInfo" ) ); }
+inline auto GetTransform( Entity ent )      { return Ent_GetComponent< CTransform >( ent, CH_HASH( "transform" ) ); }
+inline auto GetCamera( Entity ent )         { return Ent_GetComponent< CCamera >( ent, CH_HASH( "camera" ) ); }
+inline auto GetRigidBody( Entity ent )      { return Ent_GetComponent< CRigidBody >( ent, CH_HASH( "rigidBody" ) ); }
+inline auto GetComp_Direction( Entity ent ) { return Ent_GetComponent< CDirection >( ent, CH_HASH( "direction" ) ); }
 
@@ -92,7 +92,7 @@ void EntSys_Sound::Update()
 
 	for ( Entity entity : aEntities )
 	{
-		auto sound = Ent_GetComponent< CSound >( entity, "sound" );
+		auto sound = Ent_GetComponent< CSound >( entity, CH_HASH( "sound" ) );
 
 		if ( !sound )
 			continue;
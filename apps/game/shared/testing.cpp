@@ -126,7 +126,7 @@ class ProtogenSystem : public IEntityComponentSystem
 	{
 #if CH_CLIENT
 		// Add a renderable component
-		auto renderable = Ent_GetComponent< CRenderable >( sEntity, "renderable" );
+		auto renderable = Ent_GetComponent< CRenderable >( sEntity, CH_HASH( "renderable" ) );
 
 		if ( !renderable )
 			return;
@@ -203,7 +203,7 @@ void CreateProtogen_f( const std::string& path )
 
 	CTransform* transform       = Ent_AddComponent< CTransform >( proto, "transform" );
 
-	auto        playerTransform = Ent_GetComponent< CTransform >( player, "transform" );
+	auto        playerTransform = Ent_GetComponent< CTransform >( player, CH_HASH( "transform" ) );
 
 	transform->aPos            = playerTransform->aPos;
 	transform->aScale.Set( { vrcmdl_scale, vrcmdl_scale, vrcmdl_scale } );
@@ -539,7 +539,7 @@ void TEST_CL_UpdateProtos( float frameTime )
 		// if ( !transformDirty )
 		// 	continue;
 
-		auto renderComp = Ent_GetComponent< CRenderable >( proto, "renderable" );
+		auto renderComp = Ent_GetComponent< CRenderable >( proto, CH_HASH( "renderable" ) );
 
 		CH_ASSERT( renderComp );
 
@@ -651,7 +651,7 @@ void TEST_SV_UpdateProtos( float frameTime )
 			targetChanged            = true;
 		}
 
-		auto playerTransform = Ent_GetComponent< CTransform >( protoLook.aLookTarget, "transform" );
+		auto playerTransform = Ent_GetComponent< CTransform >( protoLook.aLookTarget, CH_HASH( "transform" ) );
 
 		// CH_ASSERT( playerTransform );
 
@@ -662,7 +662,7 @@ void TEST_SV_UpdateProtos( float frameTime )
 			continue;
 		}
 
-		auto protoTransform = Ent_GetComponent< CTransform >( proto, "transform" );
+		auto protoTransform = Ent_GetComponent< CTransform >( proto, CH_HASH( "transform" ) );
 
 		// glm::length( renderable->aModelMatrix ) == 0.f
 
@@ -789,14 +789,14 @@ static void cmd_sound_test( const std::string& srPath, bool sServer )
 #endif
 
 #if CH_CLIENT
-	auto playerTransform = Ent_GetComponent< CTransform >( gLocalPlayer, "transform" );
+	auto playerTransform = Ent_GetComponent< CTransform >( gLocalPlayer, CH_HASH( "transform" ) );
 #else
 	Entity player = SV_GetCommandClientEntity();
 
 	if ( player == CH_ENT_INVALID )
 		return;
 
-	auto playerTransform = Ent_GetComponent< CTransform >( player, "transform" );
+	auto playerTransform = Ent_GetComponent< CTransform >( player, CH_HASH( "transform" ) );
 #endif
 
 	if ( !playerTransform )
@@ -858,7 +858,7 @@ CONCMD( snd_test_cl_clear )
 
 	for ( Entity entity : gAudioTestEntitiesCl )
 	{
-		CSound* sound = Ent_GetComponent< CSound >( entity, "sound" );
+		CSound* sound = Ent_GetComponent< CSound >( entity, CH_HASH( "sound" ) );
 
 		if ( sound )
 		{
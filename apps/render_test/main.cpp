@@ -209,9 +209,7 @@ void MainLoop()
 
 		startTime = currentTime;
 
-#ifdef TRACY_ENABLE
-		FrameMark;
-#endif
+		profile_end_frame();
 	}
 }
 
@@ -61,7 +61,7 @@ static VECTOR JsonToVector( JsonObject_t& object )
 }
 
 
-static void LoadComponent( Scene& scene, Entity& entity, JsonObject_t& cur )
+static void LoadComponent( Map* map, Entity& entity, JsonObject_t& cur )
 {
 	if ( CheckJsonType( cur, EJsonType_Object ) )
 	{
@@ -105,7 +105,9 @@ static void LoadComponent( Scene& scene, Entity& entity, JsonObject_t& cur )
 			continue;
 		}
 
-		ComponentValue& value = comp.values[ object.name.data ];
+		// the json is freed after loading, so the key has to be kept in the map
+		std::string_view key   = *map->names.emplace( object.name.data, object.name.size ).first;
+		ComponentValue&  value = comp.values[ key ];
 
 		switch ( object.aType )
 		{
@@ -154,7 +156,7 @@ static void LoadComponent( Scene& scene, Entity& entity, JsonObject_t& cur )
 }
 
 
-static void LoadEntity( Scene& scene, JsonObject_t& object )
+static void LoadEntity( Map* map, Scene& scene, JsonObject_t& object )
 {
 	if ( CheckJsonType( object, EJsonType_Object ) )
 	{
@@ -217,13 +219,103 @@ static void LoadEntity( Scene& scene, JsonObject_t& object )
 
 			for ( u64 compI = 0; compI < cur.aObjects.aCount; compI++ )
 			{
-				LoadComponent( scene, entity, cur.aObjects.apData[ compI ] );
+				LoadComponent( map, entity, cur.aObjects.apData[ compI ] );
 			}
 		}
 	}
 }
 
 
+// Group components by type, the compiled map stores them like this, so json maps are made to match
+static void BuildColumns( Map* map, Scene& scene )
+{
+	std::unordered_map< std::string_view, u32 > types;
+
+	for ( u32 i = 0; i < map->componentTypes.size(); i++ )
+		types[ map->componentTypes[ i ] ] = i;
+
+	scene.columns.clear();
+
+	for ( u32 entI = 0; entI < scene.entites.size(); entI++ )
+	{
+		Entity& entity = scene.entites[ entI ];
+
+		for ( u32 compI = 0; compI < entity.components.size(); compI++ )
+		{
+			std::string_view name( entity.components[ compI ].name.data, entity.components[ compI ].name.size );
+			auto             it = types.find( name );
+
+			if ( it == types.end() )
+			{
+				std::string_view type = *map->names.emplace( name ).first;
+				it                    = types.emplace( type, (u32)map->componentTypes.size() ).first;
+				map->componentTypes.push_back( type );
+			}
+
+			ComponentColumn* column = nullptr;
+
+			for ( ComponentColumn& sceneColumn : scene.columns )
+			{
+				if ( sceneColumn.type == it->second )
+				{
+					column = &sceneColumn;
+					break;
+				}
+			}
+
+			if ( !column )
+			{
+				column       = &scene.columns.emplace_back();
+				column->type = it->second;
+			}
+
+			column->entities.push_back( entI );
+			column->components.push_back( compI );
+		}
+	}
+}
+
+
+// Sort entities by how many parents they have, so a parent is always set up before it's children
+static void BuildParentOrder( Scene& scene )
+{
+	u32                            count = scene.entites.size();
+	std::unordered_map< u64, u32 > idToIndex;
+	std::vector< u32 >             depth( count, 0 );
+
+	idToIndex.reserve( count );
+
+	for ( u32 i = 0; i < count; i++ )
+		idToIndex[ scene.entites[ i ].id ] = i;
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		// limit it to the entity count in case of a loop
+		u32 cur = i;
+		while ( scene.entites[ cur ].parent != UINT32_MAX && depth[ i ] < count )
+		{
+			auto it = idToIndex.find( scene.entites[ cur ].parent );
+
+			if ( it == idToIndex.end() )
+				break;
+
+			cur = it->second;
+			depth[ i ]++;
+		}
+	}
+
+	scene.parentOrder.resize( count );
+
+	for ( u32 i = 0; i < count; i++ )
+		scene.parentOrder[ i ] = i;
+
+	std::stable_sort( scene.parentOrder.begin(), scene.parentOrder.end(), [ & ]( u32 a, u32 b )
+	{
+		return depth[ a ] < depth[ b ];
+	} );
+}
+
+
 static void FreeScene( Scene& scene )
 {
 	for ( Entity& entity : scene.entites )
@@ -238,7 +330,7 @@ static void FreeScene( Scene& scene )
 
 			for ( auto& [key, value] : component.values )
 			{
-				if ( value.aString.data )
+				if ( value.type == EComponentType_String && value.aString.data )
 					ch_str_free( value.aString.data );
 			}
 		}
@@ -321,21 +413,24 @@ static bool LoadScene( Map* map, const char* scenePath, s64 scenePathLen = -1 )
 
 			for ( u64 objI = 0; objI < cur.aObjects.aCount; objI++ )
 			{
-				LoadEntity( scene, cur.aObjects.apData[ objI ] );
+				LoadEntity( map, scene, cur.aObjects.apData[ objI ] );
 			}
 		}
 	}
 
+	// nothing points into the json anymore, value keys are in map->names
+	Json_Free( &root );
+
 	map->scenes.push_back( scene );
 	return true;
 }
 
 
-Map* chmap::Load( const char* path, u64 pathLen )
+static Map* LoadJson( const char* path, u64 pathLen )
 {
 	// Load mapInfo.json5 to kick things off
 	const char*    strings[]      = { path, PATH_SEP_STR "mapInfo.json5" };
-	const size_t   sizes[]        = { pathLen, 16 };
+	const size_t   sizes[]        = { pathLen, 14 };
 	ch_string_auto mapInfoPath    = ch_str_join( 2, strings, sizes );
 
 	ch_string_auto absMapInfoPath = FileSys_FindFile( mapInfoPath.data, mapInfoPath.size );
@@ -362,7 +457,7 @@ Map* chmap::Load( const char* path, u64 pathLen )
 
 	Map* map = new Map;
 
-	ch_string primaryScene;
+	std::string primaryScene;
 
 	for ( size_t i = 0; i < root.aObjects.aCount; i++ )
 	{
@@ -405,7 +500,7 @@ Map* chmap::Load( const char* path, u64 pathLen )
 			if ( CheckJsonType( cur, EJsonType_String ) )
 				continue;
 
-			primaryScene = cur.aString;
+			primaryScene.assign( cur.aString.data, cur.aString.size );
 		}
 		else if ( ch_str_equals( cur.name, "skybox", 6 ) )
 		{
@@ -438,7 +533,7 @@ Map* chmap::Load( const char* path, u64 pathLen )
 	// Load Scenes
 	const char*              scenesStr[]   = { path, PATH_SEP_STR "scenes" };
 	const size_t             scenesSizes[] = { pathLen, 7 };
-	ch_string                scenesDir     = ch_str_join( 2, scenesStr, scenesSizes );
+	ch_string_auto           scenesDir     = ch_str_join( 2, scenesStr, scenesSizes );
 
 	std::vector< ch_string > scenePaths    = FileSys_ScanDir( scenesDir.data, scenesDir.size, ReadDir_NoDirs | ReadDir_Recursive | ReadDir_AbsPaths );
 
@@ -470,7 +565,7 @@ Map* chmap::Load( const char* path, u64 pathLen )
 	u32 sceneIndex = 0;
 	for ( Scene& scene : map->scenes )
 	{
-		if ( primaryScene == scene.name )
+		if ( ch_str_equals( scene.name, primaryScene.data(), primaryScene.size() ) )
 		{
 			map->primaryScene = sceneIndex;
 			break;
@@ -485,6 +580,12 @@ Map* chmap::Load( const char* path, u64 pathLen )
 		map->primaryScene = 0;
 	}
 
+	for ( Scene& scene : map->scenes )
+	{
+		BuildColumns( map, scene );
+		BuildParentOrder( scene );
+	}
+
 	return map;
 }
 
@@ -505,3 +606,817 @@ void chmap::Free( Map* map )
 	delete map;
 }
 
+
+// ======================================================================================================
+// Compiled Maps
+//
+// Layout:
+//   CompiledHeader
+//   CompiledString[ stringCount ], then the string data, each string is null terminated
+//   CompiledSource[ sourceCount ], the json files this was compiled from
+//   u32[ componentTypeCount ] and u32[ valueNameCount ], string indexes
+//   for each scene:
+//     CompiledScene
+//     entity columns: u64 id, u64 parent, u32 name, vec3 pos, vec3 ang, vec3 scale, u32 parentOrder
+//     for each component type in the scene:
+//       CompiledColumn, u32 entities[ count ]
+//       for each value: CompiledValueColumn, u8 present[ count ], then the value for every entity
+// ======================================================================================================
+
+
+struct CompiledHeader
+{
+	u32 magic;
+	u32 version;
+	u32 mapVersion;
+	u32 primaryScene;
+	u32 name;                // string index, UINT32_MAX if it has none
+	u32 skybox;
+	u32 stringCount;
+	u32 stringDataSize;
+	u32 sourceCount;
+	u32 componentTypeCount;
+	u32 valueNameCount;
+	u32 sceneCount;
+};
+
+
+struct CompiledString
+{
+	u32 offset;
+	u32 len;
+};
+
+
+struct CompiledSource
+{
+	u32 path;                // relative to the map folder
+	u32 padding;
+	u64 size;
+	s64 modTime;
+};
+
+
+struct CompiledScene
+{
+	u32 name;
+	u32 formatVersion;
+	u64 dateCreated;
+	u64 dateModified;
+	u32 changeNumber;
+	u32 entityCount;
+	u32 columnCount;
+	u32 padding;
+};
+
+
+struct CompiledColumn
+{
+	u32 type;                // index into the component types
+	u32 count;
+	u32 valueCount;
+	u32 padding;
+};
+
+
+struct CompiledValueColumn
+{
+	u32 name;                // index into the value names
+	u32 type;                // EComponentType
+};
+
+
+struct MapSource
+{
+	std::string path;
+	u64         size;
+	s64         modTime;
+};
+
+
+static u32 GetValueSize( EComponentType type )
+{
+	switch ( type )
+	{
+		default:
+			return 0;
+
+		case EComponentType_String:
+			return sizeof( u32 );
+
+		case EComponentType_Int:
+			return sizeof( s64 );
+
+		case EComponentType_Double:
+			return sizeof( double );
+
+		case EComponentType_Vec2:
+			return sizeof( glm::vec2 );
+
+		case EComponentType_Vec3:
+			return sizeof( glm::vec3 );
+
+		case EComponentType_Vec4:
+			return sizeof( glm::vec4 );
+	}
+}
+
+
+static void AddMapSource( std::vector< MapSource >& sources, const ch_string& mapDir, const char* filePath, u64 filePathLen )
+{
+	std::error_code ec;
+	MapSource&      source = sources.emplace_back();
+
+	// store it relative to the map folder, so the map can be moved around
+	if ( filePathLen > mapDir.size && ch_str_starts_with( filePath, filePathLen, mapDir.data, mapDir.size ) )
+		source.path.assign( filePath + mapDir.size + 1, filePathLen - mapDir.size - 1 );
+	else
+		source.path.assign( filePath, filePathLen );
+
+	source.size            = fs::file_size( filePath, ec );
+	source.modTime         = ec ? 0 : fs::last_write_time( filePath, ec ).time_since_epoch().count();
+
+	if ( ec )
+	{
+		source.size    = 0;
+		source.modTime = 0;
+	}
+}
+
+
+// Get the json files of a map, sorted by path
+static bool GetMapSources( const char* path, u64 pathLen, std::vector< MapSource >& sources )
+{
+	ch_string_auto mapDir = FileSys_FindDir( path, pathLen );
+
+	if ( !mapDir.data )
+		return false;
+
+	const char*    strings[]   = { mapDir.data, PATH_SEP_STR "mapInfo.json5" };
+	const size_t   sizes[]     = { mapDir.size, 14 };
+	ch_string_auto mapInfoPath = ch_str_join( 2, strings, sizes );
+
+	if ( !FileSys_IsFile( mapInfoPath.data, mapInfoPath.size, true ) )
+		return false;
+
+	AddMapSource( sources, mapDir, mapInfoPath.data, mapInfoPath.size );
+
+	// same as LoadJson, so the scenes this finds are the same ones loaded
+	const char*              scenesStr[]   = { path, PATH_SEP_STR "scenes" };
+	const size_t             scenesSizes[] = { pathLen, 7 };
+	ch_string_auto           scenesDir     = ch_str_join( 2, scenesStr, scenesSizes );
+
+	std::vector< ch_string > scenePaths    = FileSys_ScanDir( scenesDir.data, scenesDir.size, ReadDir_NoDirs | ReadDir_Recursive | ReadDir_AbsPaths );
+
+	for ( const ch_string& scenePath : scenePaths )
+	{
+		if ( ch_str_ends_with( scenePath, ".json5", 6 ) )
+			AddMapSource( sources, mapDir, scenePath.data, scenePath.size );
+	}
+
+	ch_str_free( scenePaths.data(), scenePaths.size() );
+
+	std::sort( sources.begin(), sources.end(), []( const MapSource& a, const MapSource& b )
+	{
+		return a.path < b.path;
+	} );
+
+	return true;
+}
+
+
+static ch_string GetCompiledPath( const char* path, u64 pathLen )
+{
+	const char*  strings[] = { path, PATH_SEP_STR, CH_MAP_COMPILED_FILE };
+	const size_t sizes[]   = { pathLen, 1, strlen( CH_MAP_COMPILED_FILE ) };
+	return ch_str_join( 3, strings, sizes );
+}
+
+
+// --------------------------------------------------------------------------------------
+// Writing
+
+
+struct CompiledWriter
+{
+	std::vector< char >                    data;
+	std::vector< CompiledString >          strings;
+	std::string                            stringData;
+	std::unordered_map< std::string, u32 > stringIndex;
+
+	u32 AddString( const char* spString, size_t sLen )
+	{
+		if ( !spString )
+			return UINT32_MAX;
+
+		auto [ it, inserted ] = stringIndex.emplace( std::string( spString, sLen ), (u32)strings.size() );
+
+		if ( inserted )
+		{
+			strings.push_back( { (u32)stringData.size(), (u32)sLen } );
+			stringData.append( spString, sLen );
+			stringData.push_back( '\0' );
+		}
+
+		return it->second;
+	}
+
+	u32 AddString( const ch_string& srString )
+	{
+		return AddString( srString.data, srString.size );
+	}
+
+	template< typename T >
+	void Write( const T* spData, size_t sCount )
+	{
+		data.insert( data.end(), (const char*)spData, (const char*)( spData + sCount ) );
+	}
+
+	template< typename T >
+	void Write( const T& srData )
+	{
+		Write( &srData, 1 );
+	}
+};
+
+
+static void WriteValue( CompiledWriter& writer, const ComponentValue& value )
+{
+	switch ( value.type )
+	{
+		default:
+			break;
+
+		case EComponentType_String:
+			writer.Write( writer.AddString( value.aString ) );
+			break;
+
+		case EComponentType_Int:
+			writer.Write( (s64)value.aInteger );
+			break;
+
+		case EComponentType_Double:
+			writer.Write( value.aDouble );
+			break;
+
+		case EComponentType_Vec2:
+			writer.Write( value.aVec2 );
+			break;
+
+		case EComponentType_Vec3:
+			writer.Write( value.aVec3 );
+			break;
+
+		case EComponentType_Vec4:
+			writer.Write( value.aVec4 );
+			break;
+	}
+}
+
+
+static void WriteScene( CompiledWriter& writer, Map* map, Scene& scene, std::unordered_map< std::string_view, u32 >& valueNames )
+{
+	CompiledScene compiledScene{};
+	compiledScene.name          = writer.AddString( scene.name );
+	compiledScene.formatVersion = scene.sceneFormatVersion;
+	compiledScene.dateCreated   = scene.dateCreated;
+	compiledScene.dateModified  = scene.dateModified;
+	compiledScene.changeNumber  = scene.changeNumber;
+	compiledScene.entityCount   = scene.entites.size();
+	compiledScene.columnCount   = scene.columns.size();
+
+	writer.Write( compiledScene );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( (u64)entity.id );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( (u64)entity.parent );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( writer.AddString( entity.name ) );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( entity.pos );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( entity.ang );
+
+	for ( Entity& entity : scene.entites )
+		writer.Write( entity.scale );
+
+	writer.Write( scene.parentOrder.data(), scene.parentOrder.size() );
+
+	for ( ComponentColumn& column : scene.columns )
+	{
+		// every value name and type used by this component type gets it's own column
+		std::vector< std::pair< std::string_view, EComponentType > > values;
+
+		for ( u32 i = 0; i < column.entities.size(); i++ )
+		{
+			Component& component = scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ];
+
+			for ( auto& [ name, value ] : component.values )
+			{
+				if ( GetValueSize( value.type ) == 0 )
+					continue;
+
+				if ( std::find( values.begin(), values.end(), std::make_pair( name, value.type ) ) == values.end() )
+					values.emplace_back( name, value.type );
+			}
+		}
+
+		CompiledColumn compiledColumn{};
+		compiledColumn.type       = column.type;
+		compiledColumn.count      = column.entities.size();
+		compiledColumn.valueCount = values.size();
+
+		writer.Write( compiledColumn );
+		writer.Write( column.entities.data(), column.entities.size() );
+
+		for ( auto& [ name, type ] : values )
+		{
+			CompiledValueColumn valueColumn{};
+			valueColumn.name = valueNames[ name ];
+			valueColumn.type = type;
+
+			writer.Write( valueColumn );
+
+			std::vector< u8 > present( column.entities.size(), 0 );
+
+			for ( u32 i = 0; i < column.entities.size(); i++ )
+			{
+				Component& component = scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ];
+				auto       it        = component.values.find( name );
+				present[ i ]         = it != component.values.end() && it->second.type == type;
+			}
+
+			writer.Write( present.data(), present.size() );
+
+			// absent values are still written, so every value in the column is the same size
+			ComponentValue empty{};
+			empty.type   = type;
+			empty.aVec4  = {};
+
+			for ( u32 i = 0; i < column.entities.size(); i++ )
+			{
+				Component& component = scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ];
+				WriteValue( writer, present[ i ] ? component.values.find( name )->second : empty );
+			}
+		}
+	}
+}
+
+
+bool chmap::Compile( const char* path, u64 pathLen )
+{
+	std::vector< MapSource > sources;
+
+	if ( !GetMapSources( path, pathLen, sources ) )
+	{
+		Log_ErrorF( "No mapInfo.json5 file in map: \"%s\"\n", path );
+		return false;
+	}
+
+	Map* map = LoadJson( path, pathLen );
+
+	if ( !map )
+		return false;
+
+	CompiledWriter writer;
+
+	for ( MapSource& source : sources )
+	{
+		CompiledSource compiledSource{};
+		compiledSource.path    = writer.AddString( source.path.data(), source.path.size() );
+		compiledSource.size    = source.size;
+		compiledSource.modTime = source.modTime;
+		writer.Write( compiledSource );
+	}
+
+	for ( std::string_view type : map->componentTypes )
+		writer.Write( writer.AddString( type.data(), type.size() ) );
+
+	// value names used anywhere in the map
+	std::unordered_map< std::string_view, u32 > valueNames;
+	std::vector< u32 >                          valueNameStrings;
+
+	for ( Scene& scene : map->scenes )
+	{
+		for ( Entity& entity : scene.entites )
+		{
+			for ( Component& component : entity.components )
+			{
+				for ( auto& [ name, value ] : component.values )
+				{
+					if ( valueNames.emplace( name, (u32)valueNameStrings.size() ).second )
+						valueNameStrings.push_back( writer.AddString( name.data(), name.size() ) );
+				}
+			}
+		}
+	}
+
+	writer.Write( valueNameStrings.data(), valueNameStrings.size() );
+
+	for ( Scene& scene : map->scenes )
+		WriteScene( writer, map, scene, valueNames );
+
+	CompiledHeader header{};
+	header.magic              = CH_MAP_COMPILED_MAGIC;
+	header.version            = CH_MAP_COMPILED_VERSION;
+	header.mapVersion         = map->version;
+	header.primaryScene       = map->primaryScene;
+	header.name               = writer.AddString( map->name );
+	header.skybox             = map->skybox ? writer.AddString( map->skybox, strlen( map->skybox ) ) : UINT32_MAX;
+	header.stringCount        = writer.strings.size();
+	header.stringDataSize     = writer.stringData.size();
+	header.sourceCount        = sources.size();
+	header.componentTypeCount = map->componentTypes.size();
+	header.valueNameCount     = valueNameStrings.size();
+	header.sceneCount         = map->scenes.size();
+
+	Free( map );
+
+	// write it next to the json files, not just in the first search path
+	ch_string_auto mapDir  = FileSys_FindDir( path, pathLen );
+	ch_string_auto outPath = GetCompiledPath( mapDir.data, mapDir.size );
+	FILE*          file    = fopen( outPath.data, "wb" );
+
+	if ( !file )
+	{
+		Log_ErrorF( "Failed to open compiled map for writing: \"%s\"\n", outPath.data );
+		return false;
+	}
+
+	bool written = fwrite( &header, sizeof( header ), 1, file ) == 1;
+	written &= fwrite( writer.strings.data(), sizeof( CompiledString ), writer.strings.size(), file ) == writer.strings.size();
+	written &= fwrite( writer.stringData.data(), 1, writer.stringData.size(), file ) == writer.stringData.size();
+	written &= fwrite( writer.data.data(), 1, writer.data.size(), file ) == writer.data.size();
+
+	fclose( file );
+
+	if ( !written )
+	{
+		Log_ErrorF( "Failed to write compiled map: \"%s\"\n", outPath.data );
+		return false;
+	}
+
+	Log_MsgF( "Compiled map: \"%s\" - %.2f KB\n", outPath.data, ( sizeof( header ) + writer.strings.size() * sizeof( CompiledString ) + writer.stringData.size() + writer.data.size() ) / 1024.f );
+	return true;
+}
+
+
+// --------------------------------------------------------------------------------------
+// Reading
+
+
+struct CompiledReader
+{
+	const char*                   cur;
+	const char*                   end;
+
+	const CompiledString*         strings;
+	const char*                   stringData;
+	u32                           stringCount;
+	u32                           stringDataSize;
+
+	std::vector< std::string_view > valueNames;
+
+	// check counts with this before allocating anything with them
+	bool HasData( size_t sSize )
+	{
+		return (size_t)( end - cur ) >= sSize;
+	}
+
+	template< typename T >
+	bool Read( T* spData, size_t sCount )
+	{
+		size_t size = sizeof( T ) * sCount;
+
+		if ( !HasData( size ) )
+			return false;
+
+		if ( size )
+			memcpy( spData, cur, size );
+		cur += size;
+		return true;
+	}
+
+	template< typename T >
+	bool Read( T& srData )
+	{
+		return Read( &srData, 1 );
+	}
+
+	std::string_view GetString( u32 sIndex )
+	{
+		if ( sIndex >= stringCount || strings[ sIndex ].offset + strings[ sIndex ].len >= stringDataSize )
+			return {};
+
+		return { stringData + strings[ sIndex ].offset, strings[ sIndex ].len };
+	}
+
+	ch_string CopyString( u32 sIndex )
+	{
+		std::string_view string = GetString( sIndex );
+
+		if ( sIndex == UINT32_MAX || !string.data() )
+			return {};
+
+		return ch_str_copy( string.data(), string.size() );
+	}
+};
+
+
+// Reads the header, strings and sources, and checks the sources against the json files
+static bool ReadCompiledHeader( CompiledReader& reader, CompiledHeader& header, const char* path, u64 pathLen )
+{
+	if ( !reader.Read( header ) )
+		return false;
+
+	if ( header.magic != CH_MAP_COMPILED_MAGIC || header.version != CH_MAP_COMPILED_VERSION )
+		return false;
+
+	size_t stringTableSize = header.stringCount * sizeof( CompiledString );
+
+	if ( !reader.HasData( stringTableSize + header.stringDataSize ) )
+		return false;
+
+	reader.strings        = (const CompiledString*)reader.cur;
+	reader.stringCount    = header.stringCount;
+	reader.stringData     = reader.cur + stringTableSize;
+	reader.stringDataSize = header.stringDataSize;
+	reader.cur += stringTableSize + header.stringDataSize;
+
+	std::vector< MapSource > sources;
+	if ( !GetMapSources( path, pathLen, sources ) || sources.size() != header.sourceCount )
+		return false;
+
+	for ( MapSource& source : sources )
+	{
+		CompiledSource compiledSource;
+		if ( !reader.Read( compiledSource ) )
+			return false;
+
+		if ( reader.GetString( compiledSource.path ) != source.path || compiledSource.size != source.size || compiledSource.modTime != source.modTime )
+			return false;
+	}
+
+	return true;
+}
+
+
+static bool ReadValue( CompiledReader& reader, EComponentType type, ComponentValue& value )
+{
+	value.type = type;
+
+	switch ( type )
+	{
+		default:
+			return false;
+
+		case EComponentType_String:
+		{
+			u32 string;
+			if ( !reader.Read( string ) )
+				return false;
+
+			value.aString = reader.CopyString( string );
+			return true;
+		}
+
+		case EComponentType_Int:
+		{
+			s64 integer;
+			if ( !reader.Read( integer ) )
+				return false;
+
+			value.aInteger = integer;
+			return true;
+		}
+
+		case EComponentType_Double:
+			return reader.Read( value.aDouble );
+
+		case EComponentType_Vec2:
+			return reader.Read( value.aVec2 );
+
+		case EComponentType_Vec3:
+			return reader.Read( value.aVec3 );
+
+		case EComponentType_Vec4:
+			return reader.Read( value.aVec4 );
+	}
+}
+
+
+static bool ReadScene( CompiledReader& reader, Map* map, Scene& scene )
+{
+	CompiledScene compiledScene;
+	if ( !reader.Read( compiledScene ) )
+		return false;
+
+	scene.name               = reader.CopyString( compiledScene.name );
+	scene.sceneFormatVersion = compiledScene.formatVersion;
+	scene.dateCreated        = compiledScene.dateCreated;
+	scene.dateModified       = compiledScene.dateModified;
+	scene.changeNumber       = compiledScene.changeNumber;
+
+	u32 count                = compiledScene.entityCount;
+
+	if ( !reader.HasData( count * ( sizeof( u64 ) * 2 + sizeof( u32 ) * 2 + sizeof( glm::vec3 ) * 3 ) ) )
+		return false;
+
+	std::vector< u64 >       ids( count );
+	std::vector< u64 >       parents( count );
+	std::vector< u32 >       names( count );
+	std::vector< glm::vec3 > transforms( count * 3 );
+
+	scene.parentOrder.resize( count );
+
+	reader.Read( ids.data(), count );
+	reader.Read( parents.data(), count );
+	reader.Read( names.data(), count );
+	reader.Read( transforms.data(), count * 3 );
+	reader.Read( scene.parentOrder.data(), count );
+
+	scene.entites.resize( count );
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		Entity& entity = scene.entites[ i ];
+		entity.id      = ids[ i ];
+		entity.parent  = parents[ i ];
+		entity.name    = reader.CopyString( names[ i ] );
+		entity.pos     = transforms[ i ];
+		entity.ang     = transforms[ count + i ];
+		entity.scale   = transforms[ count * 2 + i ];
+	}
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		if ( scene.parentOrder[ i ] >= count )
+			return false;
+	}
+
+	if ( !reader.HasData( compiledScene.columnCount * sizeof( CompiledColumn ) ) )
+		return false;
+
+	scene.columns.resize( compiledScene.columnCount );
+
+	for ( ComponentColumn& column : scene.columns )
+	{
+		CompiledColumn compiledColumn;
+		if ( !reader.Read( compiledColumn ) || compiledColumn.type >= map->componentTypes.size() )
+			return false;
+
+		if ( !reader.HasData( compiledColumn.count * sizeof( u32 ) ) )
+			return false;
+
+		column.type = compiledColumn.type;
+		column.entities.resize( compiledColumn.count );
+		column.components.resize( compiledColumn.count );
+
+		if ( !reader.Read( column.entities.data(), compiledColumn.count ) )
+			return false;
+
+		std::string_view type = map->componentTypes[ column.type ];
+
+		for ( u32 i = 0; i < compiledColumn.count; i++ )
+		{
+			if ( column.entities[ i ] >= count )
+				return false;
+
+			Entity& entity         = scene.entites[ column.entities[ i ] ];
+			column.components[ i ] = entity.components.size();
+
+			Component& component   = entity.components.emplace_back();
+			component.name         = ch_str_copy( type.data(), type.size() );
+		}
+
+		std::vector< u8 > present( compiledColumn.count );
+
+		for ( u32 valueI = 0; valueI < compiledColumn.valueCount; valueI++ )
+		{
+			CompiledValueColumn valueColumn;
+			if ( !reader.Read( valueColumn ) || valueColumn.name >= reader.valueNames.size() )
+				return false;
+
+			if ( !reader.Read( present.data(), present.size() ) )
+				return false;
+
+			std::string_view name = reader.valueNames[ valueColumn.name ];
+
+			for ( u32 i = 0; i < compiledColumn.count; i++ )
+			{
+				ComponentValue value{};
+				if ( !ReadValue( reader, (EComponentType)valueColumn.type, value ) )
+					return false;
+
+				if ( present[ i ] )
+					scene.entites[ column.entities[ i ] ].components[ column.components[ i ] ].values[ name ] = value;
+
+				else if ( value.type == EComponentType_String && value.aString.data )
+					ch_str_free( value.aString.data );
+			}
+		}
+	}
+
+	return true;
+}
+
+
+static Map* LoadCompiled( const char* path, u64 pathLen )
+{
+	ch_string_auto compiledPath = GetCompiledPath( path, pathLen );
+
+	if ( !FileSys_IsFile( compiledPath.data, compiledPath.size ) )
+		return nullptr;
+
+	ch_string_auto data = FileSys_ReadFile( compiledPath.data, compiledPath.size );
+
+	if ( !data.data )
+		return nullptr;
+
+	CompiledReader reader{};
+	reader.cur = data.data;
+	reader.end = data.data + data.size;
+
+	CompiledHeader header;
+	if ( !ReadCompiledHeader( reader, header, path, pathLen ) )
+	{
+		Log_DevF( 1, "Compiled map is out of date, loading json files instead: \"%s\"\n", path );
+		return nullptr;
+	}
+
+	if ( header.mapVersion < CH_MAP_VERSION || header.sceneCount == 0 || header.primaryScene >= header.sceneCount )
+		return nullptr;
+
+	size_t namesSize = ( (size_t)header.componentTypeCount + header.valueNameCount ) * sizeof( u32 );
+
+	if ( !reader.HasData( namesSize + header.sceneCount * sizeof( CompiledScene ) ) )
+		return nullptr;
+
+	Map* map          = new Map;
+	map->version      = header.mapVersion;
+	map->primaryScene = header.primaryScene;
+	map->name         = reader.CopyString( header.name );
+	map->skybox       = reader.CopyString( header.skybox ).data;
+	map->compiled     = true;
+
+	std::vector< u32 > strings( std::max( header.componentTypeCount, header.valueNameCount ) );
+
+	bool valid = reader.Read( strings.data(), header.componentTypeCount );
+
+	for ( u32 i = 0; valid && i < header.componentTypeCount; i++ )
+		map->componentTypes.push_back( *map->names.emplace( reader.GetString( strings[ i ] ) ).first );
+
+	valid &= reader.Read( strings.data(), header.valueNameCount );
+
+	for ( u32 i = 0; valid && i < header.valueNameCount; i++ )
+		reader.valueNames.push_back( *map->names.emplace( reader.GetString( strings[ i ] ) ).first );
+
+	map->scenes.resize( header.sceneCount );
+
+	for ( u32 i = 0; valid && i < header.sceneCount; i++ )
+		valid = ReadScene( reader, map, map->scenes[ i ] );
+
+	if ( !valid )
+	{
+		Log_WarnF( "Compiled map is invalid, loading json files instead: \"%s\"\n", path );
+		Free( map );
+		return nullptr;
+	}
+
+	return map;
+}
+
+
+bool chmap::IsCompiledUpToDate( const char* path, u64 pathLen )
+{
+	ch_string_auto compiledPath = GetCompiledPath( path, pathLen );
+
+	if ( !FileSys_IsFile( compiledPath.data, compiledPath.size ) )
+		return false;
+
+	ch_string_auto data = FileSys_ReadFile( compiledPath.data, compiledPath.size );
+
+	if ( !data.data )
+		return false;
+
+	CompiledReader reader{};
+	reader.cur = data.data;
+	reader.end = data.data + data.size;
+
+	CompiledHeader header;
+	return ReadCompiledHeader( reader, header, path, pathLen );
+}
+
+
+Map* chmap::Load( const char* path, u64 pathLen )
+{
+	if ( Map* map = LoadCompiled( path, pathLen ) )
+		return map;
+
+	return LoadJson( path, pathLen );
+}
@@ -6,20 +6,28 @@
 // The map format is setup to be a folder that contains a main map info file
 // Each map contains multiple "scenes", and a primary scene is selected to be loaded into for the game
 // This file should stand on it's own and be shared for use between the game and the editor
+//
+// Maps can also be compiled into one binary file in the map folder, which is loaded instead of the json files
+// as long as none of them have changed since it was compiled
 // ======================================================================================================
 
 #include "core/core.h"
 
 // fucking hell
 #include <filesystem>
+#include <unordered_set>
 namespace fs = std::filesystem;
 
 
 namespace chmap
 {
 
-constexpr u32 CH_MAP_VERSION       = 1;
-constexpr u32 CH_MAP_SCENE_VERSION = 1;
+constexpr u32         CH_MAP_VERSION          = 1;
+constexpr u32         CH_MAP_SCENE_VERSION    = 1;
+
+constexpr u32         CH_MAP_COMPILED_MAGIC   = 'C' | ( 'H' << 8 ) | ( 'M' << 16 ) | ( 'B' << 24 );
+constexpr u32         CH_MAP_COMPILED_VERSION = 1;
+constexpr const char* CH_MAP_COMPILED_FILE    = "mapCompiled.chmb";
 
 
 // Component Data for an entity
@@ -98,6 +106,15 @@ struct Entity
 };
 
 
+// Every entity in a scene with the same type of component, so they can all be created together
+struct ComponentColumn
+{
+	u32                type = 0;      // index into Map::componentTypes
+	std::vector< u32 > entities{};    // index into Scene::entites
+	std::vector< u32 > components{};  // index into that entity's components
+};
+
+
 // Scene placed in another scene, sort of as a "prefab"
 struct NestedScene
 {
@@ -118,8 +135,11 @@ struct Scene
 	u64                        dateModified       = 0;
 	u32                        changeNumber       = 0;
 
-	std::vector< NestedScene > nestedScenes{};
-	std::vector< Entity >      entites{};
+	std::vector< NestedScene >     nestedScenes{};
+	std::vector< Entity >          entites{};
+
+	std::vector< ComponentColumn > columns{};
+	std::vector< u32 >             parentOrder{};  // entity indexes, parents are always before their children
 };
 
 
@@ -140,10 +160,26 @@ struct Map
 
 	u32                  primaryScene = UINT32_MAX;  // index of the default scene to load
 	std::vector< Scene > scenes{};
+
+	// names of every type of component in the map, component columns point to these
+	std::vector< std::string_view >   componentTypes{};
+
+	// component and value names, the component type names and the keys in Component::values point into these
+	std::unordered_set< std::string > names{};
+
+	bool                              compiled = false;  // loaded from the compiled map file
 };
 
 
+// Loads the compiled map if it's up to date, and the json files if not
 Map*    Load( const char* path, u64 pathLen );
+
+// Loads the map json files, and writes the compiled map file to the map folder
+bool    Compile( const char* path, u64 pathLen );
+
+// Is there a compiled map file that matches the json files
+bool    IsCompiledUpToDate( const char* path, u64 pathLen );
+
 void    Free( Map* map );
 Map*    Create();
 bool    Save( Map* map );
@@ -459,9 +459,7 @@ extern "C"
 
 			startTime = currentTime;
 
-#ifdef TRACY_ENABLE
-			FrameMark;
-#endif
+			profile_end_frame();
 		}
 
 		// ---------------------------------------------------------------------------------------------
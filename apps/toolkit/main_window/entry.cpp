@@ -20,8 +20,10 @@
   #include "mimalloc-new-delete.h"
 #endif
 
-static const char* gArgGamePath = args_register_names( nullptr, "Path to the game to create assets for", 2, "--game", "-g" );
-static bool        gRunning     = true;
+static const char* gArgGamePath     = args_register_names( nullptr, "Path to the game to create assets for", 2, "--game", "-g" );
+static bool        gArgCookTextures = args_register( "Cook the game's source textures and exit, without opening a window", "--cook-textures" );
+static bool        gArgCookForce    = args_register( "Cook every source texture, even ones that are already up to date", "--cook-force" );
+static bool        gRunning         = true;
 
 
 CONVAR_RANGE_FLOAT( host_fps_max, 300, 0, 5000, "Maximum FPS the App can run at" );
@@ -159,6 +161,12 @@ extern "C"
 
 		ch_str_free( appInfoPath.data );
 
+		// command line texture cooking only needs the search paths
+		if ( gArgCookTextures )
+		{
+			return TexCook_CookAll( gArgCookForce ) ? 0 : 1;
+		}
+
 		IMGUI_CHECKVERSION();
 
 #if CH_USE_MIMALLOC
@@ -245,9 +253,7 @@ extern "C"
 
 			startTime = currentTime;
 
-#ifdef TRACY_ENABLE
-			FrameMark;
-#endif
+			profile_end_frame();
 		}
 
 		return 0;
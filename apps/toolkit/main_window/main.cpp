@@ -595,6 +595,16 @@ void RenderMainWindow( float frameTime, bool sResize )
 
 					if ( r_msaa )
 						gui->DebugMessage( "MSAA %dX", r_msaa_samples );
+
+					const TextureStreamStats_t& stream = gRenderStats.aTextureStream;
+
+					if ( stream.aStreamedTextures )
+					{
+						gui->DebugMessage( "Streamed Textures: %u (%u Fully Resident, %u Loading)", stream.aStreamedTextures, stream.aFullyResident, stream.aPendingLoads );
+						gui->DebugMessage( "Texture Memory: %.1f / %.1f MB (%.1f MB Full)",
+						                   ch_bytes_to_mb( stream.aResidentBytes ), ch_bytes_to_mb( stream.aBudgetBytes ), ch_bytes_to_mb( stream.aFullBytes ) );
+						gui->DebugMessage( "Texture Evictions: %u (%u Total)", stream.aEvictedThisFrame, stream.aEvictedTotal );
+					}
 				}
 
 				gui->Update( frameTime );
@@ -96,3 +96,7 @@ void        AssetBrowser_Close();
 void        AssetBrowser_Draw();
 
 void        ResourceUsage_Draw();
+
+bool        TexCook_CookAll( bool sForce );
+bool        TexCook_CookFile( const char* spPath, bool sForce );
+bool        TexCook_Check( const char* spFilter );
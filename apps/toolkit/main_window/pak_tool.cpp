@@ -0,0 +1,223 @@
+#include "main.h"
+
+#include "core/pak.h"
+
+#include <chrono>
+#include <filesystem>
+
+
+LOG_CHANNEL_REGISTER( PakTool, ELogColor_DarkCyan );
+
+
+// Pack every file in a directory into a pak, with paths relative to that directory
+static bool PakTool_Build( const std::string& srInputDir, const std::string& srOutput, bool sCompress, u32 sAlignment )
+{
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	if ( !fs::is_directory( srInputDir, ec ) )
+	{
+		Log_ErrorF( gLC_PakTool, "Not a directory: \"%s\"\n", srInputDir.c_str() );
+		return false;
+	}
+
+	std::vector< std::string > names;
+	std::vector< std::string > paths;
+
+	for ( auto it = fs::recursive_directory_iterator( srInputDir, ec ); !ec && it != fs::recursive_directory_iterator(); it.increment( ec ) )
+	{
+		if ( !it->is_regular_file( ec ) )
+			continue;
+
+		names.push_back( fs::relative( it->path(), srInputDir, ec ).generic_string() );
+		paths.push_back( it->path().string() );
+	}
+
+	std::vector< ch_pak_file_t > files( names.size() );
+
+	for ( size_t i = 0; i < names.size(); i++ )
+	{
+		files[ i ].apName     = names[ i ].c_str();
+		files[ i ].apPath     = paths[ i ].c_str();
+		files[ i ].aAlignment = sAlignment;
+		files[ i ].aCompress  = sCompress;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	bool result    = Pak_Write( srOutput.c_str(), files.data(), (u32)files.size() );
+	auto endTime   = std::chrono::high_resolution_clock::now();
+
+	if ( result )
+		Log_MsgF( gLC_PakTool, "Built pak in %.3f seconds\n", std::chrono::duration< float >( endTime - startTime ).count() );
+
+	return result;
+}
+
+
+CONCMD_VA( pak_build, "Pack a directory into a pak file - pak_build <input dir> <output.chpak> [--compress] [--align N]" )
+{
+	if ( args.size() < 2 )
+	{
+		Log_Msg( gLC_PakTool, "pak_build <input dir> <output.chpak> [--compress] [--align N]\n" );
+		return;
+	}
+
+	bool compress  = false;
+	u32  alignment = 0;
+
+	for ( size_t i = 2; i < args.size(); i++ )
+	{
+		if ( args[ i ] == "--compress" )
+			compress = true;
+
+		else if ( args[ i ] == "--align" && i + 1 < args.size() )
+			alignment = atoi( args[ ++i ].c_str() );
+
+		else
+			Log_WarnF( gLC_PakTool, "Unknown pak_build option: \"%s\"\n", args[ i ].c_str() );
+	}
+
+	PakTool_Build( args[ 0 ], args[ 1 ], compress, alignment );
+}
+
+
+CONCMD_VA( pak_list, "List the files in a pak file - pak_list <file.chpak>" )
+{
+	if ( args.empty() )
+	{
+		Log_Msg( gLC_PakTool, "pak_list <file.chpak>\n" );
+		return;
+	}
+
+	ch_pak_t* pak = Pak_Open( args[ 0 ].c_str() );
+
+	if ( !pak )
+		return;
+
+	log_t group = Log_GroupBegin( gLC_PakTool );
+
+	u32   count = Pak_GetEntryCount( pak );
+	u64   size  = 0;
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		const ch_pak_entry_t* entry = Pak_GetEntry( pak, i );
+		ch_string             name  = Pak_GetEntryName( pak, i );
+
+		Log_GroupF( group, "%10llu %10llu %s %.*s\n", entry->size, entry->storedSize, entry->compression == EPakCompression_LZ4 ? "LZ4 " : "    ", (int)name.size, name.data );
+		size += entry->size;
+	}
+
+	Log_GroupF( group, "%u files, %.2f MB\n", count, size / ( 1024.f * 1024.f ) );
+	Log_GroupEnd( group );
+
+	Pak_Close( pak );
+}
+
+
+// Reads every file in a pak, and the same files loose on disk, which is the file loading part of loading a map
+// Run it on a pak built from a map's directory with pak_build, files will most likely be in the OS file cache for both
+CONCMD_VA( pak_bench, "Compare reading every file in a pak against reading the same files loose - pak_bench <file.chpak> <loose dir> [iterations]" )
+{
+	if ( args.size() < 2 )
+	{
+		Log_Msg( gLC_PakTool, "pak_bench <file.chpak> <loose dir> [iterations]\n" );
+		return;
+	}
+
+	u32 iterations = args.size() > 2 ? std::max( atoi( args[ 2 ].c_str() ), 1 ) : 10;
+
+	ch_pak_t* pak  = Pak_Open( args[ 0 ].c_str() );
+
+	if ( !pak )
+		return;
+
+	u32                        count = Pak_GetEntryCount( pak );
+	std::vector< std::string > loosePaths( count );
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		ch_string name  = Pak_GetEntryName( pak, i );
+		loosePaths[ i ] = args[ 1 ] + "/" + std::string( name.data, name.size );
+	}
+
+	double looseTime = 0.0;
+	double readTime  = 0.0;
+	double viewTime  = 0.0;
+	u64    totalSize = 0;
+	u32    failed    = 0;
+	u64    checksum  = 0;
+
+	for ( u32 iter = 0; iter < iterations; iter++ )
+	{
+		// loose files, the same way FileSys_ReadFile loads them
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		for ( u32 i = 0; i < count; i++ )
+		{
+			ch_string data = FileSys_ReadFile( loosePaths[ i ].c_str(), loosePaths[ i ].size() );
+
+			if ( !data.data )
+			{
+				failed++;
+				continue;
+			}
+
+			totalSize += data.size;
+			ch_str_free( data.data );
+		}
+
+		auto looseEnd = std::chrono::high_resolution_clock::now();
+
+		// copied or decompressed out of the pak, what FileSys_ReadFile does for files in a mounted pak
+		for ( u32 i = 0; i < count; i++ )
+		{
+			const ch_pak_entry_t* entry = Pak_GetEntry( pak, i );
+			s64                   index = Pak_Find( pak, loosePaths[ i ].c_str() + args[ 1 ].size() + 1 );
+			char*                 data  = ch_malloc< char >( entry->size + 1 );
+
+			Pak_Read( pak, index, data );
+			ch_free( data );
+		}
+
+		auto readEnd = std::chrono::high_resolution_clock::now();
+
+		// zero copy views, touch each page so the time isn't just handing out pointers
+		for ( u32 i = 0; i < count; i++ )
+		{
+			s64         index = Pak_Find( pak, loosePaths[ i ].c_str() + args[ 1 ].size() + 1 );
+			const char* data  = index == -1 ? nullptr : Pak_GetView( pak, index );
+
+			if ( !data )
+				continue;
+
+			u64 size = Pak_GetEntry( pak, index )->size;
+			for ( u64 offset = 0; offset < size; offset += 4096 )
+				checksum += (u8)data[ offset ];
+		}
+
+		auto viewEnd = std::chrono::high_resolution_clock::now();
+
+		looseTime += std::chrono::duration< double, std::milli >( looseEnd - startTime ).count();
+		readTime += std::chrono::duration< double, std::milli >( readEnd - looseEnd ).count();
+		viewTime += std::chrono::duration< double, std::milli >( viewEnd - readEnd ).count();
+	}
+
+	Pak_Close( pak );
+
+	log_t group = Log_GroupBegin( gLC_PakTool );
+
+	Log_GroupF( group, "Pak Benchmark - %u files, %.2f MB, %u iterations\n", count, totalSize / ( 1024.0 * 1024.0 ) / iterations, iterations );
+	Log_GroupF( group, "    Loose Files: %.3f ms\n", looseTime / iterations );
+	Log_GroupF( group, "    Pak Read:    %.3f ms\n", readTime / iterations );
+	Log_GroupF( group, "    Pak View:    %.3f ms (uncompressed files only)\n", viewTime / iterations );
+
+	if ( failed )
+		Log_GroupF( group, "    %u loose files failed to load\n", failed / iterations );
+
+	Log_GroupEnd( group );
+
+	// keep the page touching from being optimized out
+	Log_DevF( gLC_PakTool, 2, "pak_bench checksum %llu\n", checksum );
+}
+
@@ -0,0 +1,910 @@
+#include "main.h"
+
+#include "core/json5.h"
+
+#include "ktx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+
+
+// Offline texture cooker
+// Takes uncompressed source textures from the source asset paths, builds a full mip chain for them,
+// and writes them to the game path as UASTC KTX2 files, which the renderer transcodes to BC7 or BC4 on load
+//
+// Source textures are whatever toktx or another tool made from the original images,
+// they can be KTX1 or KTX2 as long as they are 8 bits per channel and not compressed
+
+LOG_CHANNEL_REGISTER( TextureCook, ELogColor_DarkCyan );
+
+CONVAR_RANGE_INT( tex_cook_zstd, 18, 0, 22, "Zstd supercompression level for cooked textures, 0 to disable" );
+CONVAR_BOOL( tex_cook_rdo, true, "Use rate distortion optimization on color textures, makes them smaller after supercompression" );
+CONVAR_RANGE_FLOAT( tex_cook_rdo_quality, 1.f, 0.001f, 10.f, "Rate distortion quality scalar, lower is higher quality" );
+CONVAR_BOOL( tex_cook_verify, true, "Decode every texture after cooking it and compare it against the source" );
+CONVAR_RANGE_FLOAT( tex_cook_min_psnr, 35.f, 0.f, 100.f, "Cooked textures below this PSNR against their source are reported" );
+
+
+// VkFormat and GL values for the source formats we can read, so we don't need the vulkan headers in here
+enum : u32
+{
+	ETexCookVkFormat_R8_UNORM       = 9,
+	ETexCookVkFormat_R8G8_UNORM     = 16,
+	ETexCookVkFormat_R8G8B8_UNORM   = 23,
+	ETexCookVkFormat_R8G8B8_SRGB    = 29,
+	ETexCookVkFormat_B8G8R8_UNORM   = 30,
+	ETexCookVkFormat_B8G8R8_SRGB    = 36,
+	ETexCookVkFormat_R8G8B8A8_UNORM = 37,
+	ETexCookVkFormat_R8G8B8A8_SRGB  = 43,
+	ETexCookVkFormat_B8G8R8A8_UNORM = 44,
+	ETexCookVkFormat_B8G8R8A8_SRGB  = 50,
+
+	ETexCookGL_UnsignedByte         = 0x1401,
+	ETexCookGL_R8                   = 0x8229,
+	ETexCookGL_RG8                  = 0x822B,
+	ETexCookGL_RGB8                 = 0x8051,
+	ETexCookGL_RGBA8                = 0x8058,
+	ETexCookGL_SRGB8                = 0x8C41,
+	ETexCookGL_SRGB8_Alpha8         = 0x8C43,
+	ETexCookGL_BGR                  = 0x80E0,
+	ETexCookGL_BGRA                 = 0x80E1,
+};
+
+
+enum ETexCookUsage
+{
+	ETexCookUsage_Color,   // albedo, emission, mips are filtered in linear space if it's sRGB
+	ETexCookUsage_Normal,  // mips are renormalized, encoded at a higher quality
+	ETexCookUsage_Mask,    // single channel data like ambient occlusion, transcoded to BC4
+
+	ETexCookUsage_Count,
+};
+
+
+static const char* gTexCookUsageStr[] = {
+	CH_TEXTURE_COOK_USAGE_COLOR,
+	CH_TEXTURE_COOK_USAGE_NORMAL,
+	CH_TEXTURE_COOK_USAGE_MASK,
+};
+
+
+static_assert( CH_ARR_SIZE( gTexCookUsageStr ) == ETexCookUsage_Count );
+
+
+// One RGBA8 image
+struct TexCookImage_t
+{
+	std::vector< u8 > aPixels;
+	u32               aWidth  = 0;
+	u32               aHeight = 0;
+};
+
+
+struct TexCookStats_t
+{
+	u32 aCooked  = 0;
+	u32 aSkipped = 0;
+	u32 aFailed  = 0;
+	u32 aLowPSNR = 0;
+	u64 aInSize  = 0;
+	u64 aOutSize = 0;
+};
+
+
+// ---------------------------------------------------------------------------------------------------
+// Usage Hints
+
+
+// Texture path without the extension -> what a material uses it for
+static std::unordered_map< std::string, ETexCookUsage > gTexCookHints;
+
+
+// Is the name exactly this, or does it end with "_" and this
+static bool TexCook_NameIs( const std::string& srName, std::string_view sTag )
+{
+	if ( !srName.ends_with( sTag ) )
+		return false;
+
+	return srName.size() == sTag.size() || srName[ srName.size() - sTag.size() - 1 ] == '_';
+}
+
+
+// Masks are compressed to a single channel, so only guess that for names we're sure about, like "rock_rough" or "ao",
+// anything else is Color, which never loses data, just space
+static ETexCookUsage TexCook_GetUsageFromName( std::string name )
+{
+	for ( char& c : name )
+		c = (char)tolower( c );
+
+	const char* normalNames[] = { "normal", "normals", "normalmap", "nrm", "n" };
+
+	for ( const char* normalName : normalNames )
+	{
+		if ( TexCook_NameIs( name, normalName ) )
+			return ETexCookUsage_Normal;
+	}
+
+	const char* maskNames[] = {
+		"ao", "occlusion", "ambientocclusion",
+		"rough", "roughness",
+		"metal", "metallic", "metalness",
+		"mask", "height", "spec", "specular",
+	};
+
+	for ( const char* maskName : maskNames )
+	{
+		if ( TexCook_NameIs( name, maskName ) )
+			return ETexCookUsage_Mask;
+	}
+
+	return ETexCookUsage_Color;
+}
+
+
+static std::string TexCook_GetHintKey( std::string path )
+{
+	for ( char& c : path )
+	{
+		if ( c == '\\' )
+			c = '/';
+	}
+
+	if ( path.ends_with( ".ktx" ) )
+		path.resize( path.size() - 4 );
+
+	return path;
+}
+
+
+// Read every material to find out what each texture is used for, with the same path lookups the material loader does
+static void TexCook_GatherMaterialHints( ch_string* spSearchPaths, u32 sCount, bool sClear )
+{
+	if ( sClear )
+		gTexCookHints.clear();
+
+	for ( u32 i = 0; i < sCount; i++ )
+	{
+		std::vector< ch_string > files = FileSys_ScanDir( spSearchPaths[ i ].data, spSearchPaths[ i ].size, ReadDir_AbsPaths | ReadDir_Recursive | ReadDir_NoDirs );
+
+		for ( ch_string& file : files )
+		{
+			if ( !ch_str_ends_with( file, ".cmt", 4 ) )
+				continue;
+
+			ch_string_auto data = FileSys_ReadFile( file.data, file.size );
+
+			if ( !data.data )
+				continue;
+
+			JsonObject_t root;
+			if ( Json_Parse( &root, data.data ) != EJsonError_None )
+				continue;
+
+			for ( size_t j = 0; j < root.aObjects.aCount; j++ )
+			{
+				JsonObject_t& cur = root.aObjects.apData[ j ];
+
+				if ( cur.aType != EJsonType_String || ch_str_equals( cur.name, "shader", 6 ) )
+					continue;
+
+				ETexCookUsage usage = TexCook_GetUsageFromName( std::string( cur.name.data, cur.name.size ) );
+				std::string   key   = TexCook_GetHintKey( std::string( cur.aString.data, cur.aString.size ) );
+
+				gTexCookHints.try_emplace( key, usage );
+				gTexCookHints.try_emplace( "models/" + key, usage );
+				gTexCookHints.try_emplace( "materials/" + key, usage );
+			}
+
+			Json_Free( &root );
+		}
+
+		ch_str_free( files );
+	}
+}
+
+
+static ETexCookUsage TexCook_GetUsage( const std::string& srRelPath )
+{
+	std::string key = TexCook_GetHintKey( srRelPath );
+	auto        it  = gTexCookHints.find( key );
+
+	if ( it != gTexCookHints.end() )
+		return it->second;
+
+	// not in any material, guess from the file name
+	return TexCook_GetUsageFromName( std::filesystem::path( key ).filename().string() );
+}
+
+
+// ---------------------------------------------------------------------------------------------------
+// Loading and Mip Generation
+
+
+static u64 TexCook_GetModifiedTime( const std::string& srPath )
+{
+	std::error_code ec;
+	auto            modified = std::filesystem::last_write_time( srPath, ec );
+
+	if ( ec )
+		return 0;
+
+	return std::chrono::duration_cast< std::chrono::seconds >( modified.time_since_epoch() ).count();
+}
+
+
+static std::string TexCook_GetKeyValue( ktxTexture* spKTexture, const char* spKey )
+{
+	char*        value    = nullptr;
+	unsigned int valueLen = 0;
+
+	if ( ktxHashList_FindValue( &spKTexture->kvDataHead, spKey, &valueLen, (void**)&value ) != KTX_SUCCESS )
+		return {};
+
+	return std::string( value, strnlen( value, valueLen ) );
+}
+
+
+// Find out how to read the source texture, returns false if it's compressed or not 8 bits per channel
+static bool TexCook_GetSourceLayout( ktxTexture* spKTexture, u32& srChannels, bool& srSRGB, bool& srBGR )
+{
+	srSRGB = false;
+	srBGR  = false;
+
+	if ( spKTexture->classId == class_id::ktxTexture2_c )
+	{
+		ktxTexture2* kTexture2 = (ktxTexture2*)spKTexture;
+
+		if ( kTexture2->supercompressionScheme != KTX_SS_NONE && kTexture2->supercompressionScheme != KTX_SS_ZSTD && kTexture2->supercompressionScheme != KTX_SS_ZLIB )
+			return false;
+
+		switch ( kTexture2->vkFormat )
+		{
+			default:
+				return false;
+
+			case ETexCookVkFormat_R8_UNORM:       srChannels = 1; return true;
+			case ETexCookVkFormat_R8G8_UNORM:     srChannels = 2; return true;
+			case ETexCookVkFormat_R8G8B8_UNORM:   srChannels = 3; return true;
+			case ETexCookVkFormat_R8G8B8_SRGB:    srChannels = 3; srSRGB = true; return true;
+			case ETexCookVkFormat_B8G8R8_UNORM:   srChannels = 3; srBGR = true; return true;
+			case ETexCookVkFormat_B8G8R8_SRGB:    srChannels = 3; srBGR = true; srSRGB = true; return true;
+			case ETexCookVkFormat_R8G8B8A8_UNORM: srChannels = 4; return true;
+			case ETexCookVkFormat_R8G8B8A8_SRGB:  srChannels = 4; srSRGB = true; return true;
+			case ETexCookVkFormat_B8G8R8A8_UNORM: srChannels = 4; srBGR = true; return true;
+			case ETexCookVkFormat_B8G8R8A8_SRGB:  srChannels = 4; srBGR = true; srSRGB = true; return true;
+		}
+	}
+
+	ktxTexture1* kTexture1 = (ktxTexture1*)spKTexture;
+
+	if ( kTexture1->glType != ETexCookGL_UnsignedByte )
+		return false;
+
+	srBGR = kTexture1->glFormat == ETexCookGL_BGR || kTexture1->glFormat == ETexCookGL_BGRA;
+
+	switch ( kTexture1->glInternalformat )
+	{
+		default:
+			return false;
+
+		case ETexCookGL_R8:           srChannels = 1; return true;
+		case ETexCookGL_RG8:          srChannels = 2; return true;
+		case ETexCookGL_RGB8:         srChannels = 3; return true;
+		case ETexCookGL_SRGB8:        srChannels = 3; srSRGB = true; return true;
+		case ETexCookGL_RGBA8:        srChannels = 4; return true;
+		case ETexCookGL_SRGB8_Alpha8: srChannels = 4; srSRGB = true; return true;
+	}
+}
+
+
+// Load the top mip of a source texture as RGBA8
+static bool TexCook_LoadSource( const char* spPath, TexCookImage_t& srImage, bool& srSRGB )
+{
+	ktxTexture*    kTexture = nullptr;
+	KTX_error_code result   = ktxTexture_CreateFromNamedFile( spPath, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &kTexture );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_TextureCook, "KTX Error %d: %s - Failed to open texture: \"%s\"\n", result, ktxErrorString( result ), spPath );
+		return false;
+	}
+
+	u32  channels = 0;
+	bool bgr      = false;
+
+	if ( kTexture->numDimensions != 2 || kTexture->numLayers != 1 || kTexture->numFaces != 1 || kTexture->isArray || kTexture->isCubemap )
+	{
+		Log_WarnF( gLC_TextureCook, "Only plain 2D textures can be cooked: \"%s\"\n", spPath );
+		ktxTexture_Destroy( kTexture );
+		return false;
+	}
+
+	if ( !TexCook_GetSourceLayout( kTexture, channels, srSRGB, bgr ) )
+	{
+		Log_WarnF( gLC_TextureCook, "Texture is already compressed or isn't 8 bits per channel: \"%s\"\n", spPath );
+		ktxTexture_Destroy( kTexture );
+		return false;
+	}
+
+	ktx_size_t offset = 0;
+	ktxTexture_GetImageOffset( kTexture, 0, 0, 0, &offset );
+
+	const u8* data     = ktxTexture_GetData( kTexture ) + offset;
+	u32       rowPitch = ktxTexture_GetRowPitch( kTexture, 0 );
+
+	srImage.aWidth     = kTexture->baseWidth;
+	srImage.aHeight    = kTexture->baseHeight;
+	srImage.aPixels.resize( (size_t)srImage.aWidth * srImage.aHeight * 4 );
+
+	for ( u32 y = 0; y < srImage.aHeight; y++ )
+	{
+		const u8* src = data + (size_t)y * rowPitch;
+		u8*       dst = srImage.aPixels.data() + (size_t)y * srImage.aWidth * 4;
+
+		for ( u32 x = 0; x < srImage.aWidth; x++, src += channels, dst += 4 )
+		{
+			dst[ 0 ] = src[ 0 ];
+			dst[ 1 ] = channels > 1 ? src[ 1 ] : src[ 0 ];
+			dst[ 2 ] = channels > 2 ? src[ 2 ] : ( channels > 1 ? 0 : src[ 0 ] );
+			dst[ 3 ] = channels > 3 ? src[ 3 ] : 255;
+
+			if ( bgr )
+				std::swap( dst[ 0 ], dst[ 2 ] );
+		}
+	}
+
+	ktxTexture_Destroy( kTexture );
+	return true;
+}
+
+
+static float TexCook_SRGBToLinear( float sValue )
+{
+	return sValue <= 0.04045f ? sValue / 12.92f : powf( ( sValue + 0.055f ) / 1.055f, 2.4f );
+}
+
+
+static float TexCook_LinearToSRGB( float sValue )
+{
+	return sValue <= 0.0031308f ? sValue * 12.92f : 1.055f * powf( sValue, 1.f / 2.4f ) - 0.055f;
+}
+
+
+static u8 TexCook_ToByte( float sValue )
+{
+	return (u8)std::clamp( sValue * 255.f + 0.5f, 0.f, 255.f );
+}
+
+
+// 2x2 box filter, odd sizes clamp to the last row or column
+static void TexCook_Downsample( const TexCookImage_t& srSrc, TexCookImage_t& srDst, ETexCookUsage sUsage, bool sSRGB )
+{
+	static float srgbToLinear[ 256 ];
+	static bool  srgbTableBuilt = false;
+
+	if ( !srgbTableBuilt )
+	{
+		for ( u32 i = 0; i < 256; i++ )
+			srgbToLinear[ i ] = TexCook_SRGBToLinear( i / 255.f );
+
+		srgbTableBuilt = true;
+	}
+
+	srDst.aWidth  = std::max( srSrc.aWidth / 2, 1u );
+	srDst.aHeight = std::max( srSrc.aHeight / 2, 1u );
+	srDst.aPixels.resize( (size_t)srDst.aWidth * srDst.aHeight * 4 );
+
+	for ( u32 y = 0; y < srDst.aHeight; y++ )
+	{
+		u32 y0 = std::min( y * 2, srSrc.aHeight - 1 );
+		u32 y1 = std::min( y * 2 + 1, srSrc.aHeight - 1 );
+
+		for ( u32 x = 0; x < srDst.aWidth; x++ )
+		{
+			u32       x0        = std::min( x * 2, srSrc.aWidth - 1 );
+			u32       x1        = std::min( x * 2 + 1, srSrc.aWidth - 1 );
+
+			const u8* texels[ 4 ] = {
+				&srSrc.aPixels[ ( (size_t)y0 * srSrc.aWidth + x0 ) * 4 ],
+				&srSrc.aPixels[ ( (size_t)y0 * srSrc.aWidth + x1 ) * 4 ],
+				&srSrc.aPixels[ ( (size_t)y1 * srSrc.aWidth + x0 ) * 4 ],
+				&srSrc.aPixels[ ( (size_t)y1 * srSrc.aWidth + x1 ) * 4 ],
+			};
+
+			u8*       dst       = &srDst.aPixels[ ( (size_t)y * srDst.aWidth + x ) * 4 ];
+			float     sum[ 4 ]  = {};
+
+			for ( const u8* texel : texels )
+			{
+				for ( u32 c = 0; c < 4; c++ )
+				{
+					if ( sUsage == ETexCookUsage_Normal && c < 3 )
+						sum[ c ] += texel[ c ] / 255.f * 2.f - 1.f;
+
+					else if ( sUsage == ETexCookUsage_Color && sSRGB && c < 3 )
+						sum[ c ] += srgbToLinear[ texel[ c ] ];
+
+					else
+						sum[ c ] += texel[ c ] / 255.f;
+				}
+			}
+
+			if ( sUsage == ETexCookUsage_Normal )
+			{
+				glm::vec3 normal( sum[ 0 ], sum[ 1 ], sum[ 2 ] );
+				float     length = glm::length( normal );
+				normal           = length > 0.0001f ? normal / length : glm::vec3( 0.f, 0.f, 1.f );
+
+				for ( u32 c = 0; c < 3; c++ )
+					dst[ c ] = TexCook_ToByte( normal[ c ] * 0.5f + 0.5f );
+			}
+			else if ( sUsage == ETexCookUsage_Color && sSRGB )
+			{
+				for ( u32 c = 0; c < 3; c++ )
+					dst[ c ] = TexCook_ToByte( TexCook_LinearToSRGB( sum[ c ] / 4.f ) );
+			}
+			else
+			{
+				for ( u32 c = 0; c < 3; c++ )
+					dst[ c ] = TexCook_ToByte( sum[ c ] / 4.f );
+			}
+
+			dst[ 3 ] = TexCook_ToByte( sum[ 3 ] / 4.f );
+		}
+	}
+}
+
+
+// ---------------------------------------------------------------------------------------------------
+// Encoding and Verifying
+
+
+// Peak signal to noise ratio of a decoded cooked texture against its source, only the channels the usage cares about
+static double TexCook_GetPSNR( const TexCookImage_t& srSource, const u8* spDecoded, ETexCookUsage sUsage )
+{
+	u32    channels = sUsage == ETexCookUsage_Mask ? 1 : ( sUsage == ETexCookUsage_Normal ? 3 : 4 );
+	size_t count    = (size_t)srSource.aWidth * srSource.aHeight;
+	double error    = 0.0;
+
+	for ( size_t i = 0; i < count; i++ )
+	{
+		for ( u32 c = 0; c < channels; c++ )
+		{
+			double diff = (double)srSource.aPixels[ i * 4 + c ] - (double)spDecoded[ i * 4 + c ];
+			error += diff * diff;
+		}
+	}
+
+	double mse = error / ( count * channels );
+
+	if ( mse <= 0.0 )
+		return 100.0;
+
+	return 10.0 * log10( ( 255.0 * 255.0 ) / mse );
+}
+
+
+// Decode the cooked file on the CPU and compare the top mip against the source, returns the PSNR, or -1 if it failed
+static double TexCook_Verify( const TexCookImage_t& srSource, const char* spCookedPath, ETexCookUsage sUsage )
+{
+	ktxTexture2*   kTexture = nullptr;
+	KTX_error_code result   = ktxTexture2_CreateFromNamedFile( spCookedPath, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &kTexture );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_TextureCook, "KTX Error %d: %s - Failed to open cooked texture: \"%s\"\n", result, ktxErrorString( result ), spCookedPath );
+		return -1.0;
+	}
+
+	if ( !ktxTexture2_NeedsTranscoding( kTexture ) )
+	{
+		Log_ErrorF( gLC_TextureCook, "Texture was not cooked, can't decode it: \"%s\"\n", spCookedPath );
+		ktxTexture_Destroy( ktxTexture( kTexture ) );
+		return -1.0;
+	}
+
+	result = ktxTexture2_TranscodeBasis( kTexture, KTX_TTF_RGBA32, 0 );
+
+	if ( result != KTX_SUCCESS || kTexture->baseWidth != srSource.aWidth || kTexture->baseHeight != srSource.aHeight )
+	{
+		Log_ErrorF( gLC_TextureCook, "Failed to decode cooked texture: \"%s\"\n", spCookedPath );
+		ktxTexture_Destroy( ktxTexture( kTexture ) );
+		return -1.0;
+	}
+
+	ktx_size_t offset = 0;
+	ktxTexture_GetImageOffset( ktxTexture( kTexture ), 0, 0, 0, &offset );
+
+	double psnr = TexCook_GetPSNR( srSource, ktxTexture_GetData( ktxTexture( kTexture ) ) + offset, sUsage );
+
+	ktxTexture_Destroy( ktxTexture( kTexture ) );
+	return psnr;
+}
+
+
+static bool TexCook_Encode( const std::vector< TexCookImage_t >& srMips, bool sSRGB, ETexCookUsage sUsage, u64 sSourceTime, const std::string& srOutPath )
+{
+	ktxTextureCreateInfo createInfo{};
+	createInfo.vkFormat        = sSRGB ? ETexCookVkFormat_R8G8B8A8_SRGB : ETexCookVkFormat_R8G8B8A8_UNORM;
+	createInfo.baseWidth       = srMips[ 0 ].aWidth;
+	createInfo.baseHeight      = srMips[ 0 ].aHeight;
+	createInfo.baseDepth       = 1;
+	createInfo.numDimensions   = 2;
+	createInfo.numLevels       = (u32)srMips.size();
+	createInfo.numLayers       = 1;
+	createInfo.numFaces        = 1;
+	createInfo.isArray         = KTX_FALSE;
+	createInfo.generateMipmaps = KTX_FALSE;
+
+	ktxTexture2*   kTexture    = nullptr;
+	KTX_error_code result      = ktxTexture2_Create( &createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &kTexture );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_TextureCook, "KTX Error %d: %s - Failed to create texture\n", result, ktxErrorString( result ) );
+		return false;
+	}
+
+	for ( u32 mip = 0; mip < srMips.size(); mip++ )
+	{
+		ktxTexture_SetImageFromMemory( ktxTexture( kTexture ), mip, 0, 0, srMips[ mip ].aPixels.data(), srMips[ mip ].aPixels.size() );
+	}
+
+	ktxBasisParams params{};
+	params.structSize            = sizeof( params );
+	params.uastc                 = KTX_TRUE;
+	params.threadCount           = std::max( std::thread::hardware_concurrency(), 1u );
+	params.uastcFlags            = sUsage == ETexCookUsage_Normal ? KTX_PACK_UASTC_LEVEL_SLOWER : KTX_PACK_UASTC_LEVEL_DEFAULT;
+
+	// RDO shifts error around, fine for color, but it shows up in lighting on normal maps
+	params.uastcRDO              = tex_cook_rdo && sUsage == ETexCookUsage_Color && tex_cook_zstd > 0;
+	params.uastcRDOQualityScalar = tex_cook_rdo_quality;
+
+	result                       = ktxTexture2_CompressBasisEx( kTexture, &params );
+
+	if ( result == KTX_SUCCESS && tex_cook_zstd > 0 )
+		result = ktxTexture2_DeflateZstd( kTexture, tex_cook_zstd );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_TextureCook, "KTX Error %d: %s - Failed to compress texture\n", result, ktxErrorString( result ) );
+		ktxTexture_Destroy( ktxTexture( kTexture ) );
+		return false;
+	}
+
+	std::string sourceTime = std::to_string( sSourceTime );
+	const char* usage      = gTexCookUsageStr[ sUsage ];
+
+	ktxHashList_AddKVPair( &kTexture->kvDataHead, CH_TEXTURE_COOK_KEY_SOURCE_TIME, (u32)sourceTime.size() + 1, sourceTime.c_str() );
+	ktxHashList_AddKVPair( &kTexture->kvDataHead, CH_TEXTURE_COOK_KEY_USAGE, (u32)strlen( usage ) + 1, usage );
+
+	std::error_code ec;
+	std::filesystem::create_directories( std::filesystem::path( srOutPath ).parent_path(), ec );
+
+	result = ktxTexture_WriteToNamedFile( ktxTexture( kTexture ), srOutPath.c_str() );
+	ktxTexture_Destroy( ktxTexture( kTexture ) );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_TextureCook, "KTX Error %d: %s - Failed to write texture: \"%s\"\n", result, ktxErrorString( result ), srOutPath.c_str() );
+		return false;
+	}
+
+	// ktx writes it directly, so the file index doesn't know about it yet
+	FileSys_NotifyWrite( srOutPath.c_str() );
+	return true;
+}
+
+
+// Check if the cooked texture was made from this version of the source texture
+static bool TexCook_IsUpToDate( const std::string& srOutPath, u64 sSourceTime )
+{
+	ktxTexture* kTexture = nullptr;
+
+	if ( ktxTexture_CreateFromNamedFile( srOutPath.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture ) != KTX_SUCCESS )
+		return false;
+
+	bool upToDate = TexCook_GetKeyValue( kTexture, CH_TEXTURE_COOK_KEY_SOURCE_TIME ) == std::to_string( sSourceTime );
+
+	ktxTexture_Destroy( kTexture );
+	return upToDate;
+}
+
+
+static bool TexCook_CookTexture( const std::string& srSourcePath, const std::string& srOutPath, ETexCookUsage sUsage, bool sForce, TexCookStats_t& srStats )
+{
+	u64 sourceTime = TexCook_GetModifiedTime( srSourcePath );
+
+	if ( !sForce && TexCook_IsUpToDate( srOutPath, sourceTime ) )
+	{
+		srStats.aSkipped++;
+		return true;
+	}
+
+	std::vector< TexCookImage_t > mips( 1 );
+	bool                          srgb = false;
+
+	if ( !TexCook_LoadSource( srSourcePath.c_str(), mips[ 0 ], srgb ) )
+	{
+		srStats.aFailed++;
+		return false;
+	}
+
+	// normal maps and masks are data, not color
+	if ( sUsage != ETexCookUsage_Color )
+		srgb = false;
+
+	while ( mips.back().aWidth > 1 || mips.back().aHeight > 1 )
+	{
+		TexCookImage_t& mip = mips.emplace_back();
+		TexCook_Downsample( mips[ mips.size() - 2 ], mip, sUsage, srgb );
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if ( !TexCook_Encode( mips, srgb, sUsage, sourceTime, srOutPath ) )
+	{
+		srStats.aFailed++;
+		return false;
+	}
+
+	auto            endTime = std::chrono::high_resolution_clock::now();
+
+	std::error_code ec;
+	u64             inSize  = std::filesystem::file_size( srSourcePath, ec );
+	u64             outSize = std::filesystem::file_size( srOutPath, ec );
+
+	srStats.aCooked++;
+	srStats.aInSize += inSize;
+	srStats.aOutSize += outSize;
+
+	Log_MsgF( gLC_TextureCook, "Cooked %s texture in %.2f seconds, %u mips, %.2f KB -> %.2f KB: \"%s\"\n",
+	          gTexCookUsageStr[ sUsage ], std::chrono::duration< float >( endTime - startTime ).count(), (u32)mips.size(), inSize / 1024.f, outSize / 1024.f, srOutPath.c_str() );
+
+	if ( !tex_cook_verify )
+		return true;
+
+	double psnr = TexCook_Verify( mips[ 0 ], srOutPath.c_str(), sUsage );
+
+	if ( psnr < tex_cook_min_psnr )
+	{
+		Log_WarnF( gLC_TextureCook, "Cooked texture PSNR is %.2f dB, below tex_cook_min_psnr: \"%s\"\n", psnr, srOutPath.c_str() );
+		srStats.aLowPSNR++;
+	}
+
+	return true;
+}
+
+
+// ---------------------------------------------------------------------------------------------------
+// Source Texture Lookup
+
+
+struct TexCookSource_t
+{
+	std::string aPath;
+	std::string aRelPath;  // relative to the source asset path, this is where it goes in the output
+};
+
+
+static std::vector< TexCookSource_t > TexCook_FindSources()
+{
+	std::vector< TexCookSource_t > sources;
+
+	ch_string*                     sourcePaths     = nullptr;
+	u32                            sourcePathCount = FileSys_GetSourcePaths( &sourcePaths );
+
+	for ( u32 i = 0; i < sourcePathCount; i++ )
+	{
+		std::vector< ch_string > files = FileSys_ScanDir( sourcePaths[ i ].data, sourcePaths[ i ].size, ReadDir_AbsPaths | ReadDir_Recursive | ReadDir_NoDirs );
+
+		for ( ch_string& file : files )
+		{
+			if ( !ch_str_ends_with( file, ".ktx", 4 ) )
+				continue;
+
+			std::error_code  ec;
+			TexCookSource_t& source = sources.emplace_back();
+			source.aPath            = std::string( file.data, file.size );
+			source.aRelPath         = std::filesystem::relative( source.aPath, std::string( sourcePaths[ i ].data, sourcePaths[ i ].size ), ec ).generic_string();
+		}
+
+		ch_str_free( files );
+	}
+
+	return sources;
+}
+
+
+static std::string TexCook_GetOutputDir( const std::string& srOutDir )
+{
+	if ( srOutDir.size() )
+		return srOutDir;
+
+	ch_string* searchPaths     = nullptr;
+	u32        searchPathCount = FileSys_GetSearchPaths( &searchPaths );
+
+	if ( searchPathCount == 0 )
+		return {};
+
+	return std::string( searchPaths[ 0 ].data, searchPaths[ 0 ].size );
+}
+
+
+static void TexCook_PrintStats( const TexCookStats_t& srStats, float sTime )
+{
+	Log_MsgF( gLC_TextureCook, "Cooked %u textures in %.2f seconds, %u up to date, %u failed, %u below tex_cook_min_psnr - %.2f MB -> %.2f MB\n",
+	          srStats.aCooked, sTime, srStats.aSkipped, srStats.aFailed, srStats.aLowPSNR, srStats.aInSize / ( 1024.f * 1024.f ), srStats.aOutSize / ( 1024.f * 1024.f ) );
+}
+
+
+// Cook every texture in the source asset paths, or only ones matching a filter
+static bool TexCook_Cook( const std::string& srFilter, const std::string& srOutDir, bool sForce )
+{
+	std::string outDir = TexCook_GetOutputDir( srOutDir );
+
+	if ( outDir.empty() )
+	{
+		Log_Error( gLC_TextureCook, "No output path for cooked textures\n" );
+		return false;
+	}
+
+	std::vector< TexCookSource_t > sources = TexCook_FindSources();
+
+	if ( sources.empty() )
+	{
+		Log_Warn( gLC_TextureCook, "No source textures found, add your source texture folders to \"sourceAssets\" in app_info.json5\n" );
+		return false;
+	}
+
+	ch_string* searchPaths     = nullptr;
+	u32        searchPathCount = FileSys_GetSearchPaths( &searchPaths );
+	TexCook_GatherMaterialHints( searchPaths, searchPathCount, true );
+
+	searchPathCount = FileSys_GetSourcePaths( &searchPaths );
+	TexCook_GatherMaterialHints( searchPaths, searchPathCount, false );
+
+	TexCookStats_t stats{};
+	auto           startTime = std::chrono::high_resolution_clock::now();
+
+	for ( const TexCookSource_t& source : sources )
+	{
+		if ( srFilter.size() && source.aRelPath != TexCook_GetHintKey( srFilter ) + ".ktx" && source.aPath != srFilter )
+			continue;
+
+		std::string outPath = outDir + "/" + source.aRelPath;
+
+		if ( std::filesystem::path( outPath ) == std::filesystem::path( source.aPath ) )
+		{
+			Log_WarnF( gLC_TextureCook, "Output path is the same as the source texture, skipping: \"%s\"\n", source.aPath.c_str() );
+			stats.aFailed++;
+			continue;
+		}
+
+		TexCook_CookTexture( source.aPath, outPath, TexCook_GetUsage( source.aRelPath ), sForce, stats );
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	if ( srFilter.size() && stats.aCooked + stats.aSkipped + stats.aFailed == 0 )
+	{
+		Log_WarnF( gLC_TextureCook, "No source texture found for \"%s\"\n", srFilter.c_str() );
+		return false;
+	}
+
+	TexCook_PrintStats( stats, std::chrono::duration< float >( endTime - startTime ).count() );
+	return stats.aFailed == 0;
+}
+
+
+bool TexCook_CookAll( bool sForce )
+{
+	return TexCook_Cook( {}, {}, sForce );
+}
+
+
+bool TexCook_CookFile( const char* spPath, bool sForce )
+{
+	return TexCook_Cook( spPath, {}, sForce );
+}
+
+
+// Compare every cooked texture in the game path against its source, without cooking anything
+bool TexCook_Check( const char* spFilter )
+{
+	std::string                    outDir  = TexCook_GetOutputDir( {} );
+	std::vector< TexCookSource_t > sources = TexCook_FindSources();
+
+	u32                            checked = 0;
+	u32                            low     = 0;
+	double                         total   = 0.0;
+
+	log_t                          group   = Log_GroupBegin( gLC_TextureCook );
+
+	for ( const TexCookSource_t& source : sources )
+	{
+		if ( spFilter && spFilter[ 0 ] && source.aRelPath != TexCook_GetHintKey( spFilter ) + ".ktx" && source.aPath != spFilter )
+			continue;
+
+		std::string outPath = outDir + "/" + source.aRelPath;
+
+		if ( !std::filesystem::exists( outPath ) )
+			continue;
+
+		TexCookImage_t image;
+		bool           srgb = false;
+
+		if ( !TexCook_LoadSource( source.aPath.c_str(), image, srgb ) )
+			continue;
+
+		ktxTexture* kTexture = nullptr;
+		if ( ktxTexture_CreateFromNamedFile( outPath.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture ) != KTX_SUCCESS )
+			continue;
+
+		std::string   usageStr = TexCook_GetKeyValue( kTexture, CH_TEXTURE_COOK_KEY_USAGE );
+		ETexCookUsage usage    = ETexCookUsage_Color;
+		ktxTexture_Destroy( kTexture );
+
+		for ( u32 i = 0; i < ETexCookUsage_Count; i++ )
+		{
+			if ( usageStr == gTexCookUsageStr[ i ] )
+				usage = (ETexCookUsage)i;
+		}
+
+		double psnr = TexCook_Verify( image, outPath.c_str(), usage );
+
+		if ( psnr < 0.0 )
+			continue;
+
+		bool lowPSNR = psnr < tex_cook_min_psnr;
+
+		Log_GroupF( group, "%s %6.2f dB  %-6s  %s\n", lowPSNR ? "LOW " : "    ", psnr, gTexCookUsageStr[ usage ], source.aRelPath.c_str() );
+
+		checked++;
+		low += lowPSNR;
+		total += psnr;
+	}
+
+	Log_GroupF( group, "%u textures checked, average %.2f dB, %u below %.2f dB\n", checked, checked ? total / checked : 0.0, low, tex_cook_min_psnr );
+	Log_GroupEnd( group );
+
+	return low == 0;
+}
+
+
+// ---------------------------------------------------------------------------------------------------
+// Commands
+
+
+CONCMD_VA( tex_cook, "Cook source textures into compressed KTX2 files with mips - tex_cook [texture path] [--force] [--out <dir>]" )
+{
+	std::string filter;
+	std::string outDir;
+	bool        force = false;
+
+	for ( size_t i = 0; i < args.size(); i++ )
+	{
+		if ( args[ i ] == "--force" )
+			force = true;
+
+		else if ( args[ i ] == "--out" && i + 1 < args.size() )
+			outDir = args[ ++i ];
+
+		else if ( filter.empty() )
+			filter = args[ i ];
+
+		else
+			Log_WarnF( gLC_TextureCook, "Unknown tex_cook option: \"%s\"\n", args[ i ].c_str() );
+	}
+
+	TexCook_Cook( filter, outDir, force );
+}
+
+
+CONCMD_VA( tex_cook_check, "Decode cooked textures on the CPU and print their PSNR against the source texture - tex_cook_check [texture path]" )
+{
+	TexCook_Check( args.size() ? args[ 0 ].c_str() : nullptr );
+}
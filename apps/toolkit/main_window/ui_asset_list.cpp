@@ -316,6 +316,14 @@ void AssetBrowser_Draw()
 		ImGui::EndCombo();
 	}
 
+	if ( gAssetBrowserData.searchType == ESearchPathType_SourceAssets )
+	{
+		ImGui::SameLine();
+
+		if ( ImGui::Button( "Cook Textures" ) )
+			TexCook_CookAll( false );
+	}
+
 	ImGui::SameLine();
 
 	ImGui::SetNextItemWidth( 100 );
@@ -497,6 +505,18 @@ void AssetBrowser_Draw()
 				ImGui::EndTooltip();
 			}
 
+			// source textures can be cooked from here
+			if ( asset.type == EAssetType_Texture && gAssetBrowserData.searchType == ESearchPathType_SourceAssets && ImGui::BeginPopupContextItem( asset.path.data ) )
+			{
+				if ( ImGui::MenuItem( "Cook Texture" ) )
+					TexCook_CookFile( asset.path.data, true );
+
+				if ( ImGui::MenuItem( "Check Cooked Texture Quality" ) )
+					TexCook_Check( asset.path.data );
+
+				ImGui::EndPopup();
+			}
+
 			if ( ImGui::IsItemClicked() && ImGui::IsMouseDoubleClicked( ImGuiMouseButton_Left ) )
 			{
 				// TODO: improve this
@@ -88,6 +88,44 @@ CONCMD( map_save )
 }
 
 
+// Compile the json files of a map into one binary file, which the game loads instead while it's up to date
+CONCMD_DROP_VA( map_compile, map_dropdown, 0, "Compile a map into a binary file for faster loading - map_compile <map>" )
+{
+	if ( args.size() == 0 )
+	{
+		Log_Warn( gLC_Map, "No Map Path/Name specified!\n" );
+		return;
+	}
+
+	ch_string_auto mapPath;
+
+	if ( FileSys_IsAbsolute( args[ 0 ].c_str() ) )
+	{
+		mapPath = ch_str_copy( args[ 0 ].data(), args[ 0 ].size() );
+	}
+	else
+	{
+		const char* strings[] = { "maps/", args[ 0 ].c_str() };
+		const u64   lengths[] = { 5, args[ 0 ].size() };
+		mapPath               = ch_str_join( 2, strings, lengths );
+	}
+
+	ch_string_auto absPath = FileSys_FindDir( mapPath.data, mapPath.size );
+
+	if ( !absPath.data )
+	{
+		Log_WarnF( gLC_Map, "Map does not exist: \"%s\"\n", args[ 0 ].c_str() );
+		return;
+	}
+
+	if ( chmap::IsCompiledUpToDate( absPath.data, absPath.size ) )
+		Log_MsgF( gLC_Map, "Compiled map is already up to date, compiling anyway: \"%s\"\n", args[ 0 ].c_str() );
+
+	if ( !chmap::Compile( absPath.data, absPath.size ) )
+		Log_ErrorF( gLC_Map, "Failed to Compile Map: \"%s\"\n", args[ 0 ].c_str() );
+}
+
+
 void MapManager_Update()
 {
 	if ( gRebuildMapTimer > 0.f )
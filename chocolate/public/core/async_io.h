@@ -0,0 +1,108 @@
+#pragma once
+
+// ======================================================================================================
+// Async File I/O
+//
+// Submit file reads and keep working, a completion callback is called on the I/O thread when each finishes,
+// or group requests with a fence and wait on that when the data is actually needed
+// This lets loaders read the next file while decoding the current one
+//
+// On linux this uses io_uring, if that's not available (old kernel, seccomp, etc.) it uses a pool of I/O threads
+// Files inside of pak files are always read on the I/O threads
+// ======================================================================================================
+
+#include "core/platform.h"
+#include "core/filesystem.h"
+
+#include <atomic>
+
+
+enum EAsyncIOPriority : u8
+{
+	EAsyncIOPriority_Low,     // prefetching, streaming ahead
+	EAsyncIOPriority_Normal,
+	EAsyncIOPriority_High,    // something is waiting on this right now
+
+	EAsyncIOPriority_Count,
+};
+
+
+enum EAsyncIOResult : u8
+{
+	EAsyncIOResult_Pending,
+	EAsyncIOResult_Success,
+	EAsyncIOResult_NotFound,
+	EAsyncIOResult_Failed,
+};
+
+
+// A group of requests that can be waited on, every request submitted with it adds to it
+struct ch_async_io_fence
+{
+	std::atomic< u32 > aPending = 0;
+};
+
+
+struct ch_async_io_request;
+
+// Called on an I/O thread when the request is finished, whether it succeeded or not
+// The request isn't touched after this, so it can be freed or reused in here,
+// which means requests with a callback can't be waited on with AsyncIO_Wait, use a fence for that
+typedef void ( *fn_async_io_complete_t )( ch_async_io_request* spRequest );
+
+
+// The request must stay valid until it completes
+struct ch_async_io_request
+{
+	// ----------------------------------------------------------------
+	// Input
+
+	const char*            apPath       = nullptr;  // searched for in the search paths, unless it's absolute
+	ESearchPathType        aPathType    = ESearchPathType_Path;
+
+	u64                    aOffset      = 0;
+	u64                    aSize        = 0;        // 0 to read to the end of the file
+
+	// Where to read the data to, must be at least aSize bytes
+	// If this is nullptr, a buffer the size of the read plus a null terminator is allocated with ch_malloc, and the caller frees it
+	char*                  apBuffer     = nullptr;
+
+	EAsyncIOPriority       aPriority    = EAsyncIOPriority_Normal;
+	fn_async_io_complete_t apCallback   = nullptr;
+	void*                  apUserData   = nullptr;
+	ch_async_io_fence*     apFence      = nullptr;
+
+	// ----------------------------------------------------------------
+	// Output, don't touch these until it's finished
+
+	std::atomic< EAsyncIOResult > aResult = EAsyncIOResult_Pending;
+	u64                    aBytesRead   = 0;
+
+	// ----------------------------------------------------------------
+	// Internal
+
+	ch_string              aFullPath;
+	u64                    aReadSize    = 0;
+	int                    aFile        = -1;
+	bool                   aAllocBuffer = false;
+	ch_async_io_request*   apNext       = nullptr;
+};
+
+
+CORE_API void AsyncIO_Shutdown();
+
+// Returns false if the request is invalid, the callback is not called in that case
+CORE_API bool AsyncIO_Submit( ch_async_io_request* spRequest );
+
+// Submit many requests at once, only wakes the I/O threads once, returns how many were submitted
+CORE_API u32  AsyncIO_SubmitBatch( ch_async_io_request** spRequests, u32 sCount );
+
+CORE_API bool AsyncIO_IsDone( const ch_async_io_request* spRequest );
+CORE_API void AsyncIO_Wait( const ch_async_io_request* spRequest );
+
+CORE_API bool AsyncIO_IsFenceDone( const ch_async_io_fence& srFence );
+CORE_API void AsyncIO_WaitFence( const ch_async_io_fence& srFence );
+
+// Is this backed by io_uring, or the thread pool
+CORE_API const char* AsyncIO_GetBackendName();
+
@@ -0,0 +1,21 @@
+#pragma once
+
+// ======================================================================================================
+// Block Compression
+//
+// Raw LZ4 block format (no frame header), compatible with LZ4_compress_default/LZ4_decompress_safe
+// Used for compressed files in .chpak files, favors fast decompression over compression ratio
+// ======================================================================================================
+
+
+// Max size the compressed data can be for this many bytes of input
+CORE_API u64  ch_lz4_compress_bound( u64 sSize );
+
+// Compress a block of data, spDst must be at least ch_lz4_compress_bound( sSrcSize ) bytes
+// Returns the compressed size, or 0 if it failed
+CORE_API u64  ch_lz4_compress( const char* spSrc, u64 sSrcSize, char* spDst, u64 sDstCapacity );
+
+// Decompress a block of data, sDstSize must be the exact size of the uncompressed data
+// Returns false if the data is corrupt
+CORE_API bool ch_lz4_decompress( const char* spSrc, u64 sSrcSize, char* spDst, u64 sDstSize );
+
@@ -278,6 +278,7 @@ class CORE_API ConCommandRegister
 // Internal List of ConVar Data
 CORE_API std::unordered_map< ch_string, u32 >& Con_GetConVarIndexMap();
 CORE_API u32                                   Con_GetConVarIndex( const char* name, size_t len = 0 );
+CORE_API u32                                   Con_GetConVarIndex( ch_str_id id );  // id from CH_HASH or ch_str_intern
 CORE_API u32                                   Con_GetConVarCount();  // Get the number of ConVars registered
 
 CORE_API ConVarData_t*                         Con_GetConVarData( u32 index );
@@ -286,6 +287,8 @@ CORE_API const ch_string                       Con_GetConVarDesc( u32 index );
 CORE_API ConVarData_t*                         Con_GetConVarData( const char* name, size_t len = 0 );
 CORE_API const ch_string                       Con_GetConVarDesc( const char* name, size_t len = 0 );
 
+CORE_API ConVarData_t*                         Con_GetConVarData( ch_str_id id );
+
 // ----------------------------------------------------------------------------------------------------------
 // ConVar Registering
 
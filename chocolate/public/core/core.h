@@ -14,6 +14,7 @@
 #include "threadpool.h"
 #include "asserts.h"
 #include "profiler.h"
+#include "telemetry.h"
 #include "vector.hpp"
 #include "string.h"
 #include "handles.hpp"
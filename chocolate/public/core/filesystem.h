@@ -25,6 +25,15 @@ enum ReadDirFlags_: unsigned char
 using ReadDirFlags = unsigned char;
 
 
+// Read only view of a file's data, either memory mapped or straight out of a pak file
+struct ch_file_view
+{
+	const char* data  = nullptr;
+	u64         size  = 0;
+	u8          aType = 0;  // internal, how to close it
+};
+
+
 // TODO: custom path types?
 enum ESearchPathType : u8
 {
@@ -68,6 +77,9 @@ CORE_API void      FileSys_DefaultSearchPaths();
 CORE_API void      FileSys_PrintSearchPaths();
 CORE_API void      FileSys_ReloadSearchPaths();
 
+// Search paths ending in ".chpak" are pak files, and files inside them are found like any other search path
+// Paths returned for files in a pak are the pak path followed by the file path, "$app_path$/base.chpak/materials/dev/grid.cmt"
+
 // Build Search Path replaces macros like $root_path$ and $app_path$ with their actual values
 CORE_API ch_string FileSys_BuildSearchPath( const char* path, s32 pathLen = -1 );
 
@@ -103,6 +115,18 @@ CORE_API ch_string FileSys_FindDir( const char* dir, s32 dirLen, ESearchPathType
 // Reads a file - Returns a nullptr for the data if it doesn't exist.
 CORE_API ch_string FileSys_ReadFile( const char* path, s32 pathLen = -1, ESearchPathType sType = ESearchPathType_Path );
 
+// Get a read only view of a file in the search paths without copying it - Returns a nullptr for the data if it doesn't exist.
+// Loose files are memory mapped, files in a pak point into the pak, compressed files in a pak are decompressed into a new buffer
+CORE_API ch_file_view FileSys_OpenView( const char* path, s32 pathLen = -1, ESearchPathType sType = ESearchPathType_Path );
+
+// Memory map a file on disk, does not use the search paths
+CORE_API ch_file_view FileSys_MapFile( const char* spPath );
+
+CORE_API void      FileSys_CloseView( ch_file_view& srView );
+
+// Is this path inside of a pak, like the paths FileSys_FindFile returns for files in paks
+CORE_API bool      FileSys_IsInPak( const char* path, s32 pathLen = -1 );
+
 // Saves a file - Returns true if it succeeded.
 CORE_API bool      FileSys_SaveFile( const char* path, std::vector< char >& srData, s32 pathLen = -1 );
 
@@ -162,6 +186,9 @@ CORE_API bool      FileSys_GetFileTimes( const char* spPath, s32 pathLen, float*
 // Create a Directory
 CORE_API bool      FileSys_CreateDirectory( const char* path );
 
+// Call after writing to a file without the functions here, so the file index sees it right away
+CORE_API void      FileSys_NotifyWrite( const char* spPath );
+
 // ================================================================================
 // Directory Reading
 
@@ -21,6 +21,8 @@ enum EJsonError
 	EJsonError_ExpectedColonCharacter,
 	EJsonError_ExpectedCommaCharacter,
 	EJsonError_NewLineInQuote,
+	EJsonError_ExpectedEndOfComment,
+	EJsonError_TooDeep,
 
 	EJsonError_Unknown,  // FALLBACK ERROR TYPE
 };
@@ -50,30 +52,6 @@ struct JsonArray_t
 };
 
 
-// TODO: maybe try this?
-// 
-// struct ch_json_root_t
-// {
-//     // contains many strings next to each other, separated by null terminators, not an array of arrays
-//     // the ch_json_object_t can store an offset to this string in the array
-//     const char*       strings;
-//     s64*              ints;
-//     double*           doubles;
-//     ch_json_object_t* objects;
-//     
-//     ch_json_object_t* object;
-//     u32               object_count;
-// };
-// 
-// struct ch_json_object_t
-// {
-//     u32         name;
-//     e_json_type type;
-//     u32         value_offset;
-// };
-// 
-
-
 struct JsonObject_t
 {
 	ch_string name;
@@ -102,8 +80,117 @@ struct JsonObject_t
 };
 
 
+// Builds a JsonObject_t tree with Json_Parse below, every object and string is in one allocation
+// Only call Json_Free on the root, nothing in the tree can be freed on it's own
 CORE_API EJsonError  Json_Parse( JsonObject_t* spRoot, const char* spSource );
 CORE_API void        Json_Free( JsonObject_t* spRoot );
 CORE_API const char* Json_ErrorToStr( EJsonError sErr );
 CORE_API const char* Json_TypeToStr( EJsonType sType );
 
+
+// ======================================================================================================
+// Flat JSON5
+//
+// Parses in a single pass into one allocation, the document is an array of nodes in the order they appear in the file,
+// the first child of an object or array is the node right after it, and each node's next index skips over it's children
+// Keys and strings are offsets into one string table, which can be the source text itself when parsed in situ
+// ======================================================================================================
+
+
+enum EJsonFlags : u32
+{
+	EJsonFlags_None        = 0,
+
+	// Numbers keep their text and are only parsed in Json_GetInt and Json_GetDouble
+	EJsonFlags_LazyNumbers = ( 1 << 0 ),
+};
+
+
+constexpr u32 CH_JSON_NO_NAME   = UINT32_MAX;
+constexpr u32 CH_JSON_MAX_DEPTH = 256;
+
+
+struct ch_json_node_t
+{
+	u32       name;      // offset into the string table, CH_JSON_NO_NAME for the root and array elements
+	u32       name_len;
+	u32       next;      // index of the node after this one and all of it's children
+	EJsonType type;
+	bool      lazy;      // a number that hasn't been parsed yet, val_string is the text of it
+
+	union
+	{
+		u32    count;    // children of an object or array
+
+		struct
+		{
+			u32 offset;
+			u32 len;
+		} val_string;
+
+		s64    val_int;
+		double val_double;
+	};
+};
+
+
+struct ch_json_t
+{
+	ch_json_node_t* nodes       = nullptr;  // nodes[ 0 ] is the root
+	u32             node_count  = 0;
+
+	const char*     strings     = nullptr;  // null terminated strings, or the source text if parsed in situ
+	u32             string_size = 0;
+
+	char*           arena       = nullptr;  // the string table and nodes are in here
+	u64             arena_size  = 0;
+
+	u32             error_line  = 0;        // line the parser stopped on if it failed
+};
+
+
+CORE_API EJsonError            Json_Parse( ch_json_t& srJson, const char* spSource, u64 sLen, u32 sFlags = EJsonFlags_None );
+
+// Strings are unescaped into the source text and pointed to instead of copied, the source must outlive srJson
+CORE_API EJsonError            Json_ParseInSitu( ch_json_t& srJson, char* spSource, u64 sLen, u32 sFlags = EJsonFlags_None );
+
+CORE_API void                  Json_Free( ch_json_t& srJson );
+
+// These parse lazy numbers, and convert between ints and doubles
+CORE_API s64                   Json_GetInt( const ch_json_t& srJson, const ch_json_node_t& srNode );
+CORE_API double                Json_GetDouble( const ch_json_t& srJson, const ch_json_node_t& srNode );
+
+// Find a key in an object, returns nullptr if it's not in it
+CORE_API const ch_json_node_t* Json_Find( const ch_json_t& srJson, const ch_json_node_t& srObject, const char* spKey, u32 sLen );
+
+
+inline ch_string Json_GetName( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	if ( srNode.name == CH_JSON_NO_NAME )
+		return {};
+
+	return { (char*)srJson.strings + srNode.name, srNode.name_len };
+}
+
+
+inline ch_string Json_GetString( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	if ( srNode.type != EJsonType_String )
+		return {};
+
+	return { (char*)srJson.strings + srNode.val_string.offset, srNode.val_string.len };
+}
+
+
+// Children are walked with Json_GetNext, for count children
+inline const ch_json_node_t* Json_GetChild( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	return &srNode + 1;
+}
+
+
+inline const ch_json_node_t* Json_GetNext( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	return &srJson.nodes[ srNode.next ];
+}
+
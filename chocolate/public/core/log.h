@@ -142,8 +142,18 @@ CORE_API unsigned char      Log_GetChannelCount();
 
 // log_t Information
 CORE_API ch_string          Log_BuildHistoryString( int sMaxSize = -1 );
-CORE_API const std::vector< log_t >& Log_GetLogHistory();
-CORE_API const log_t*                Log_GetLastLog();
+CORE_API log_channel_h               Log_GetLastChannel();
+
+// Logs are added to the history by the logging thread, and old ones are pushed out once it's full
+// Lock the history while reading it, valid indexes are from Log_GetHistoryStart() up to Log_GetHistoryCount()
+CORE_API void                        Log_LockHistory();
+CORE_API void                        Log_UnlockHistory();
+CORE_API u64                         Log_GetHistoryStart();
+CORE_API u64                         Log_GetHistoryCount();
+CORE_API const log_t*                Log_GetHistoryLog( u64 sIndex );
+
+// Wait for the logging thread to print everything submitted so far
+CORE_API void                        Log_Flush();
 CORE_API bool                        Log_IsVisible( const log_t& log );
 CORE_API int                         Log_GetDevLevel();
 
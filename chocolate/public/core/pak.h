@@ -0,0 +1,110 @@
+#pragma once
+
+// ======================================================================================================
+// Chocolate Engine Pak Files (.chpak)
+//
+// A pak holds many files in one, with a hashed table of contents so files are found without searching,
+// and file data aligned so it can be used directly out of a memory mapped view of the pak
+// Files can be stored compressed in LZ4 blocks, those are decompressed into a new buffer when read
+//
+// Paks are mounted by adding them as a search path, "$app_path$/base.chpak"
+//
+// Layout:
+//   ch_pak_header_t
+//   ch_pak_entry_t[ entryCount ]
+//   u32[ hashSize ] hash table, entry index + 1, 0 is an empty slot
+//   string table of entry names, lowercase with forward slashes
+//   file data, each file aligned to its entry's alignment
+//
+// Compressed files start with a u32 table of compressed block sizes, one for each CH_PAK_BLOCK_SIZE block,
+// a block that's the same size compressed as uncompressed is stored uncompressed
+// ======================================================================================================
+
+#include "core/platform.h"
+#include "core/string.h"
+
+
+constexpr u32 CH_PAK_MAGIC         = 'C' | ( 'P' << 8 ) | ( 'A' << 16 ) | ( 'K' << 24 );
+constexpr u32 CH_PAK_VERSION       = 1;
+constexpr u32 CH_PAK_BLOCK_SIZE    = 65536;
+constexpr u32 CH_PAK_DEFAULT_ALIGN = 16;
+constexpr u32 CH_PAK_MAX_ALIGN     = 65536;
+
+
+enum EPakCompression : u32
+{
+	EPakCompression_None,
+	EPakCompression_LZ4,
+
+	EPakCompression_Count,
+};
+
+
+struct ch_pak_header_t
+{
+	u32 magic;
+	u32 version;
+	u32 entryCount;
+	u32 hashSize;      // power of 2
+	u64 entryOffset;
+	u64 hashOffset;
+	u64 stringOffset;
+	u64 stringSize;
+};
+
+
+struct ch_pak_entry_t
+{
+	u64 hash;
+	u64 offset;
+	u64 size;          // uncompressed size
+	u64 storedSize;    // size in the pak, including the block table if compressed
+	u32 nameOffset;    // into the string table
+	u32 nameLen;
+	u32 compression;   // EPakCompression
+	u32 alignment;
+};
+
+
+// A file to put in a pak
+struct ch_pak_file_t
+{
+	const char* apName;       // path inside the pak, relative like a search path lookup, "materials/dev/grid.cmt"
+	const char* apPath;       // path of the file on disk
+	u32         aAlignment;   // 0 for CH_PAK_DEFAULT_ALIGN
+	bool        aCompress;    // stored uncompressed anyway if it doesn't save much
+};
+
+
+struct ch_pak_t;
+
+// ================================================================================
+// Reading
+
+CORE_API ch_pak_t*             Pak_Open( const char* spPath );
+CORE_API void                  Pak_Close( ch_pak_t* spPak );
+
+CORE_API u32                   Pak_GetEntryCount( ch_pak_t* spPak );
+CORE_API const ch_pak_entry_t* Pak_GetEntry( ch_pak_t* spPak, u32 sIndex );
+
+// Does not allocate, points into the pak
+CORE_API ch_string             Pak_GetEntryName( ch_pak_t* spPak, u32 sIndex );
+
+// Find a file in the pak, returns the entry index, or -1 if it's not in it
+CORE_API s64                   Pak_Find( ch_pak_t* spPak, const char* spPath, s64 sLen = -1 );
+
+// Get the file data straight from the mapped pak, no copies, valid until the pak is closed
+// Returns nullptr if the file is compressed, use Pak_Read for those
+CORE_API const char*           Pak_GetView( ch_pak_t* spPak, u32 sIndex );
+
+// Copy or decompress a file into spDst, which must be the entry's size
+CORE_API bool                  Pak_Read( ch_pak_t* spPak, u32 sIndex, char* spDst );
+
+// Hash of an entry name, case insensitive and treats both path separators the same
+CORE_API u64                   Pak_HashName( const char* spName, u64 sLen );
+
+// ================================================================================
+// Writing
+
+CORE_API bool                  Pak_Write( const char* spOutput, const ch_pak_file_t* spFiles, u32 sCount );
+
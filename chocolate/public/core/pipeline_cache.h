@@ -0,0 +1,31 @@
+#pragma once
+
+// ======================================================================================================
+// Pipeline Cache Files
+//
+// Saves and loads the driver's pipeline cache data between runs, for every renderer
+// The file has our own header in front of it, the driver is supposed to reject a cache from another device or driver version,
+// but some don't check very well and crash instead, so we check it ourselves first
+// ======================================================================================================
+
+#include <vector>
+
+
+// What the cache data is valid for, filled in from VkPhysicalDeviceProperties
+struct ch_pipeline_cache_key
+{
+	u32 aVendorID      = 0;
+	u32 aDeviceID      = 0;
+	u32 aDriverVersion = 0;
+	u8  aCacheUUID[ 16 ]{};  // VK_UUID_SIZE
+};
+
+
+// False with --vk-no-pipeline-cache, nothing is loaded or saved then
+CORE_API bool PipelineCache_IsEnabled();
+
+// Returns false and leaves srData empty if it's missing, corrupted, or for a different device
+CORE_API bool PipelineCache_Load( const char* spPath, const ch_pipeline_cache_key& srKey, std::vector< char >& srData );
+
+// Writes to a temp file first, so crashing while saving doesn't leave a broken cache behind
+CORE_API bool PipelineCache_Save( const char* spPath, const ch_pipeline_cache_key& srKey, const char* spData, u64 sSize );
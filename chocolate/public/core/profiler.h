@@ -1,26 +1,11 @@
 #pragma once
 
 // Macros for tracy because the constexpr ones dont want to work
+// Without tracy, CH_PROFILER uses the built in profiler below, which is always there to read data from, even if nothing writes to it
 
-#ifndef TRACY_ENABLE
+#include <vector>
 
-  #define PROF_SCOPE_BASE( varname, active )
-  #define PROF_SCOPE_NAMED_BASE( varname, name, active )
-
-  #define PROF_SCOPE_NAMED( name )
-  #define PROF_SCOPE()
-
-  #define CH_PROF_ZONE_TEXT( name, len )
-  #define CH_PROF_ZONE_NAME( name, len )
-
-  #define CH_PROF_ZONE_TEXT_STR( name )
-  #define CH_PROF_ZONE_NAME_STR( name )
-
-  #define TracyAlloc( ptr, size )
-  #define TracyFree( ptr )
-  #define TracyMessageC( txt, size, color )
-
-#else
+#if defined( TRACY_ENABLE )
 
 #include <Tracy.hpp>
 
@@ -41,7 +26,150 @@
   #define CH_PROF_ZONE_TEXT_STR( name )  CH_PROF_ZONE_TEXT( name.data(), name.size() )
   #define CH_PROF_ZONE_NAME_STR( name )  CH_PROF_ZONE_NAME( name.data(), name.size() )
 
+#elif CH_PROFILER
+
+  #define CH_PROF_CONCAT_BASE( a, b ) a##b
+  #define CH_PROF_CONCAT( a, b )      CH_PROF_CONCAT_BASE( a, b )
+
+  #define PROF_SCOPE_BASE( varname, active )                                                                                  \
+	static ch_prof_location_t CH_PROF_CONCAT( __ch_prof_location, __LINE__ ){ nullptr, __FUNCTION__, __FILE__, (u32)__LINE__ }; \
+	ch_prof_scope_t           varname( &CH_PROF_CONCAT( __ch_prof_location, __LINE__ ), active );
+
+  #define PROF_SCOPE_NAMED_BASE( varname, name, active )                                                                   \
+	static ch_prof_location_t CH_PROF_CONCAT( __ch_prof_location, __LINE__ ){ name, __FUNCTION__, __FILE__, (u32)__LINE__ }; \
+	ch_prof_scope_t           varname( &CH_PROF_CONCAT( __ch_prof_location, __LINE__ ), active );
+
+  #define PROF_SCOPE_NAMED( name )       PROF_SCOPE_NAMED_BASE( __ch_prof_scope, name, true )
+  #define PROF_SCOPE()                   PROF_SCOPE_BASE( __ch_prof_scope, true )
+
+  // only static names are recorded
+  #define CH_PROF_ZONE_TEXT( name, len )
+  #define CH_PROF_ZONE_NAME( name, len )
+
+  #define CH_PROF_ZONE_TEXT_STR( name )
+  #define CH_PROF_ZONE_NAME_STR( name )
+
+  #define TracyAlloc( ptr, size )
+  #define TracyFree( ptr )
+  #define TracyMessageC( txt, size, color )
+
+#else
+
+  #define PROF_SCOPE_BASE( varname, active )
+  #define PROF_SCOPE_NAMED_BASE( varname, name, active )
+
+  #define PROF_SCOPE_NAMED( name )
+  #define PROF_SCOPE()
+
+  #define CH_PROF_ZONE_TEXT( name, len )
+  #define CH_PROF_ZONE_NAME( name, len )
+
+  #define CH_PROF_ZONE_TEXT_STR( name )
+  #define CH_PROF_ZONE_NAME_STR( name )
+
+  #define TracyAlloc( ptr, size )
+  #define TracyFree( ptr )
+  #define TracyMessageC( txt, size, color )
+
 #endif
 
-void CORE_API profile_end_frame();
+
+// ======================================================================================================
+// Built In Profiler
+//
+// Each thread writes finished scopes to its own ring buffer, and profile_end_frame collects them on the main thread
+// into a history of recent frames, which is what the timeline draws and what gets exported
+// Every scope also keeps its time from the last few hundred frames it ran in, for min/avg/max/p99
+// Nothing is recorded until prof_start is run, and scopes are dropped if a thread's buffer fills up
+// ======================================================================================================
+
+
+// One of these per PROF_SCOPE, it's a static so it's made once
+struct ch_prof_location_t
+{
+	const char* apName;  // nullptr to use the function name
+	const char* apFunc;
+	const char* apFile;
+	u32         aLine;
+	u32         aId;     // set the first time the main thread sees this, 0 until then
+};
+
+
+struct ch_prof_event_t
+{
+	ch_prof_location_t* apLocation;
+	u64                 aStart;  // nanoseconds, see Prof_GetTime
+	u64                 aEnd;
+	u16                 aDepth;  // how many scopes this is inside of on its thread
+	u16                 aThread;
+};
+
+
+struct ch_prof_frame_t
+{
+	u64                            aStart;
+	u64                            aEnd;
+	std::vector< ch_prof_event_t > aEvents;
+};
+
+
+// Times are in milliseconds spent in the scope per frame, over the frames it ran in
+struct ch_prof_stats_t
+{
+	const ch_prof_location_t* apLocation;
+	u32                       aFrames;     // how many frames these stats are from
+	u32                       aCalls;      // calls in the most recent frame it ran in
+	float                     aLast;
+	float                     aMin;
+	float                     aAvg;
+	float                     aMax;
+	float                     aP99;
+};
+
+
+CORE_API u64                    Prof_GetTime();
+
+// Returns the start time, or 0 if the profiler isn't recording
+CORE_API u64                    Prof_ScopeBegin();
+CORE_API void                   Prof_ScopeEnd( ch_prof_location_t* spLocation, u64 sStart );
+
+CORE_API void                   Prof_Start();
+CORE_API void                   Prof_Stop();
+CORE_API bool                   Prof_IsRunning();
+
+// Shows up in the timeline and in exported traces
+CORE_API void                   Prof_SetThreadName( const char* spName );
+CORE_API u32                    Prof_GetThreadCount();
+CORE_API const char*            Prof_GetThreadName( u32 sThread );
+
+// 0 is the newest frame, nullptr if there's no frame at that index
+CORE_API u32                    Prof_GetFrameCount();
+CORE_API const ch_prof_frame_t* Prof_GetFrame( u32 sIndex );
+
+CORE_API const char*            Prof_GetLocationName( const ch_prof_location_t* spLocation );
+CORE_API void                   Prof_GetStats( std::vector< ch_prof_stats_t >& srStats );
+
+CORE_API bool                   Prof_ExportTrace( const char* spPath );  // Chrome trace json, open it in chrome://tracing or Perfetto
+CORE_API bool                   Prof_ExportCSV( const char* spPath );    // the stats of every scope
+
+// Call this once at the end of every frame on the main thread
+CORE_API void                   profile_end_frame();
+
+
+struct ch_prof_scope_t
+{
+	ch_prof_location_t* apLocation;
+	u64                 aStart;
+
+	ch_prof_scope_t( ch_prof_location_t* spLocation, bool sActive )
+		: apLocation( spLocation ), aStart( sActive ? Prof_ScopeBegin() : 0 )
+	{
+	}
+
+	~ch_prof_scope_t()
+	{
+		if ( aStart )
+			Prof_ScopeEnd( apLocation, aStart );
+	}
+};
 
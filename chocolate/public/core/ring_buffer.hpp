@@ -0,0 +1,205 @@
+#pragma once
+
+/*
+ *
+ * Fixed capacity lock-free queues
+ *
+ * ch_spsc_queue - one producer thread, one consumer thread, supports bulk reads and writes
+ * ch_mpsc_queue - any number of producer threads, one consumer thread
+ *
+ * Neither of these allocate memory after construction, so they are safe to use from real-time threads (audio callbacks, etc.)
+ *
+ */
+
+#include "util.h"
+
+#include <atomic>
+#include <string.h>
+
+
+// avoid false sharing between the producer and consumer indices
+#define CH_CACHE_LINE_SIZE 64
+
+
+template< typename T, u32 CAPACITY >
+struct ch_spsc_queue
+{
+	static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "ch_spsc_queue capacity must be a power of 2" );
+
+	alignas( CH_CACHE_LINE_SIZE ) std::atomic< u32 > head = 0;  // only written by the consumer
+	alignas( CH_CACHE_LINE_SIZE ) std::atomic< u32 > tail = 0;  // only written by the producer
+	alignas( CH_CACHE_LINE_SIZE ) T data[ CAPACITY ];
+
+	// Number of items in the queue, only an estimate if called from outside the producer or consumer thread
+	u32 size() const
+	{
+		return tail.load( std::memory_order_acquire ) - head.load( std::memory_order_acquire );
+	}
+
+	u32 available() const
+	{
+		return CAPACITY - size();
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// Producer only
+	bool push( const T& value )
+	{
+		u32 cur_tail = tail.load( std::memory_order_relaxed );
+
+		if ( cur_tail - head.load( std::memory_order_acquire ) == CAPACITY )
+			return false;
+
+		data[ cur_tail & ( CAPACITY - 1 ) ] = value;
+		tail.store( cur_tail + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Consumer only
+	bool pop( T& value )
+	{
+		u32 cur_head = head.load( std::memory_order_relaxed );
+
+		if ( cur_head == tail.load( std::memory_order_acquire ) )
+			return false;
+
+		value = data[ cur_head & ( CAPACITY - 1 ) ];
+		head.store( cur_head + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Producer only, writes as many items as will fit and returns the amount written
+	u32 write( const T* values, u32 count )
+	{
+		u32 cur_tail = tail.load( std::memory_order_relaxed );
+		u32 free     = CAPACITY - ( cur_tail - head.load( std::memory_order_acquire ) );
+
+		if ( count > free )
+			count = free;
+
+		u32 start = cur_tail & ( CAPACITY - 1 );
+		u32 first = std::min( count, CAPACITY - start );
+
+		memcpy( &data[ start ], values, first * sizeof( T ) );
+		memcpy( data, values + first, ( count - first ) * sizeof( T ) );
+
+		tail.store( cur_tail + count, std::memory_order_release );
+		return count;
+	}
+
+	// Consumer only, reads up to count items and returns the amount read
+	u32 read( T* values, u32 count )
+	{
+		u32 cur_head = head.load( std::memory_order_relaxed );
+		u32 used     = tail.load( std::memory_order_acquire ) - cur_head;
+
+		if ( count > used )
+			count = used;
+
+		u32 start = cur_head & ( CAPACITY - 1 );
+		u32 first = std::min( count, CAPACITY - start );
+
+		memcpy( values, &data[ start ], first * sizeof( T ) );
+		memcpy( values + first, data, ( count - first ) * sizeof( T ) );
+
+		head.store( cur_head + count, std::memory_order_release );
+		return count;
+	}
+
+	// Consumer only, throws out up to count items and returns the amount skipped
+	u32 skip( u32 count )
+	{
+		u32 cur_head = head.load( std::memory_order_relaxed );
+		u32 used     = tail.load( std::memory_order_acquire ) - cur_head;
+
+		if ( count > used )
+			count = used;
+
+		head.store( cur_head + count, std::memory_order_release );
+		return count;
+	}
+};
+
+
+// Bounded multi-producer queue, based on Dmitry Vyukov's bounded MPMC queue
+// each cell has a sequence number so producers can claim a slot with a single CAS
+template< typename T, u32 CAPACITY >
+struct ch_mpsc_queue
+{
+	static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "ch_mpsc_queue capacity must be a power of 2" );
+
+	struct cell_t
+	{
+		std::atomic< u32 > sequence;
+		T                  data;
+	};
+
+	alignas( CH_CACHE_LINE_SIZE ) cell_t cells[ CAPACITY ];
+	alignas( CH_CACHE_LINE_SIZE ) std::atomic< u32 > enqueue_pos = 0;
+	alignas( CH_CACHE_LINE_SIZE ) u32 dequeue_pos                = 0;  // only touched by the consumer
+
+	ch_mpsc_queue()
+	{
+		for ( u32 i = 0; i < CAPACITY; i++ )
+			cells[ i ].sequence.store( i, std::memory_order_relaxed );
+	}
+
+	// Any thread
+	bool push( const T& value )
+	{
+		u32     pos = enqueue_pos.load( std::memory_order_relaxed );
+		cell_t* cell;
+
+		while ( true )
+		{
+			cell     = &cells[ pos & ( CAPACITY - 1 ) ];
+			u32  seq = cell->sequence.load( std::memory_order_acquire );
+			s32 diff = (s32)seq - (s32)pos;
+
+			if ( diff == 0 )
+			{
+				if ( enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			else if ( diff < 0 )
+			{
+				// queue is full
+				return false;
+			}
+			else
+			{
+				pos = enqueue_pos.load( std::memory_order_relaxed );
+			}
+		}
+
+		cell->data = value;
+		cell->sequence.store( pos + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Consumer only
+	bool pop( T& value )
+	{
+		cell_t* cell = &cells[ dequeue_pos & ( CAPACITY - 1 ) ];
+		u32     seq  = cell->sequence.load( std::memory_order_acquire );
+
+		// nothing has been published to this cell yet
+		if ( (s32)seq - (s32)( dequeue_pos + 1 ) < 0 )
+			return false;
+
+		value = cell->data;
+		cell->sequence.store( dequeue_pos + CAPACITY, std::memory_order_release );
+		dequeue_pos++;
+		return true;
+	}
+
+	// Consumer only, and only an estimate since producers may be in the middle of pushing
+	bool empty() const
+	{
+		return enqueue_pos.load( std::memory_order_acquire ) == dequeue_pos;
+	}
+};
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <initializer_list>
+#include <cstdio>
 
 #include "core/util.h"
 
@@ -198,6 +199,212 @@ CORE_API size_t    ch_str_contains( const char* s, const char* find, size_t find
 
 CORE_API u64       ch_str_hash( const char* str, size_t len );
 
+// -----------------------------------------------------------------------------------------------------
+// String Interning
+//
+// Keeps one copy of a string for the lifetime of the program, and gives it a 32-bit id
+// The id is the hash of the string, so CH_HASH( "transform" ) is the id of "transform" without a lookup
+// Two different strings with the same hash can't both be interned, the second one gets CH_STR_ID_INVALID
+// These are thread safe
+
+CORE_API ch_str_id ch_str_intern( const char* str, size_t len );
+CORE_API ch_str_id ch_str_intern( const char* str );
+
+// Get the interned string for an id, this is null terminated and never freed
+// Returns an empty string if it was never interned
+CORE_API ch_string ch_str_intern_get( ch_str_id id );
+
+CORE_API u32       ch_str_intern_count();
+
+
+// -----------------------------------------------------------------------------------------------------
+// Stack Formatting
+//
+// snprintf into a buffer you already have, nothing is allocated or tracked
+// If it doesn't fit, it's cut off, the returned string always points into the buffer and is null terminated
+
+CORE_API ch_string ch_str_fmt_into( char* buffer, size_t bufferSize, const char* format, ... );
+CORE_API ch_string ch_str_fmt_into_v( char* buffer, size_t bufferSize, const char* format, va_list args );
+
+template< size_t N >
+inline ch_string ch_str_fmt_into( char ( &buffer )[ N ], const char* format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	ch_string out = ch_str_fmt_into_v( buffer, N, format, args );
+	va_end( args );
+	return out;
+}
+
+
+// -----------------------------------------------------------------------------------------------------
+// Small Strings
+//
+// A string with N bytes of inline storage, including the null terminator
+// It only allocates if it grows past that, so short lived strings like paths can be built on the stack
+// The memory is plain ch_malloc, it isn't in the string allocation tracker, and it's freed on destruction
+// Converting it to a ch_string gives you a view, which is only valid while this is alive and unchanged
+
+template< size_t N = 256 >
+struct ch_string_small
+{
+	static_assert( N > 0, "ch_string_small needs room for the null terminator" );
+
+	char*  data     = buffer;
+	size_t size     = 0;
+	size_t capacity = N;
+	char   buffer[ N ];
+
+	ch_string_small()
+	{
+		buffer[ 0 ] = '\0';
+	}
+
+	ch_string_small( const char* spString, size_t sLen )
+		: ch_string_small()
+	{
+		append( spString, sLen );
+	}
+
+	ch_string_small( const ch_string& srString )
+		: ch_string_small()
+	{
+		append( srString.data, srString.size );
+	}
+
+	ch_string_small( const ch_string_small& other )
+		: ch_string_small()
+	{
+		append( other.data, other.size );
+	}
+
+	~ch_string_small()
+	{
+		if ( data != buffer )
+			ch_free( data );
+	}
+
+	ch_string_small& operator=( const ch_string_small& other )
+	{
+		if ( this != &other )
+			assign( other.data, other.size );
+
+		return *this;
+	}
+
+	operator ch_string() const
+	{
+		return ch_string( data, size );
+	}
+
+	// did this have to allocate
+	bool is_small() const
+	{
+		return data == buffer;
+	}
+
+	// make room for a string of this length, keeps what's already in here
+	bool reserve( size_t sLen )
+	{
+		if ( sLen < capacity )
+			return true;
+
+		size_t newCapacity = std::max( capacity * 2, sLen + 1 );
+		char*  newData     = ch_malloc< char >( newCapacity );
+
+		if ( !newData )
+			return false;
+
+		memcpy( newData, data, size + 1 );
+
+		if ( data != buffer )
+			ch_free( data );
+
+		data     = newData;
+		capacity = newCapacity;
+		return true;
+	}
+
+	bool append( const char* spString, size_t sLen )
+	{
+		if ( !reserve( size + sLen ) )
+			return false;
+
+		if ( sLen )
+			memcpy( data + size, spString, sLen );
+
+		size += sLen;
+		data[ size ] = '\0';
+		return true;
+	}
+
+	bool append( const char* spString )
+	{
+		return spString ? append( spString, strlen( spString ) ) : true;
+	}
+
+	bool append( const ch_string& srString )
+	{
+		return append( srString.data, srString.size );
+	}
+
+	bool append( char sChar )
+	{
+		return append( &sChar, 1 );
+	}
+
+	bool assign( const char* spString, size_t sLen )
+	{
+		clear();
+		return append( spString, sLen );
+	}
+
+	// keeps any memory it allocated
+	void clear()
+	{
+		size      = 0;
+		data[ 0 ] = '\0';
+	}
+
+	// printf onto the end of the string
+	bool append_f( const char* format, ... )
+	{
+		va_list args;
+		va_start( args, format );
+		bool result = append_v( format, args );
+		va_end( args );
+		return result;
+	}
+
+	bool append_v( const char* format, va_list args )
+	{
+		va_list copy;
+		va_copy( copy, args );
+
+		int len = vsnprintf( data + size, capacity - size, format, args );
+
+		// didn't fit, grow it and print it again
+		if ( len >= 0 && size + len >= capacity )
+		{
+			if ( reserve( size + len ) )
+				vsnprintf( data + size, capacity - size, format, copy );
+			else
+				len = -1;
+		}
+
+		va_end( copy );
+
+		if ( len < 0 )
+		{
+			data[ size ] = '\0';
+			return false;
+		}
+
+		size += len;
+		return true;
+	}
+};
+
 
 // check if a string has characters in it
 inline bool   ch_str_check_empty( const char* s, size_t& length )
@@ -0,0 +1,59 @@
+#pragma once
+
+// ======================================================================================================
+// Frame Telemetry
+//
+// Always on timing of the big parts of a frame, cheap enough to leave running on dedicated servers
+// Each subsystem adds the time it spent to the current frame, and at the end of the frame that goes into a histogram
+// Subsystems have a budget in milliseconds with a convar, "telemetry.budget.<name>", frames going over it are counted
+// Every telemetry.summary.interval seconds the p50/p99 of each subsystem is written to a rotating log file
+// ======================================================================================================
+
+#include "core/platform.h"
+
+#include <chrono>
+
+
+using ch_telemetry_h                              = u8;
+constexpr ch_telemetry_h CH_INVALID_TELEMETRY     = UINT8_MAX;
+
+
+// Registering the same name again returns the same handle, so modules can share subsystems
+// A budget of 0 means it has no budget
+CORE_API ch_telemetry_h Telemetry_Register( const char* spName, float sBudget );
+
+// Add time to this frame for this subsystem, thread safe
+CORE_API void           Telemetry_Add( ch_telemetry_h sHandle, float sMilliseconds );
+
+// Call this once at the end of every frame on the main thread, with the frame time in seconds
+CORE_API void           Telemetry_EndFrame( float sFrameTime );
+
+// Write a summary now and start a new period, instead of waiting for the interval
+CORE_API void           Telemetry_WriteSummary();
+
+
+struct ch_telemetry_scope_t
+{
+	ch_telemetry_h                        aHandle;
+	std::chrono::steady_clock::time_point aStart;
+
+	ch_telemetry_scope_t( ch_telemetry_h sHandle )
+		: aHandle( sHandle ), aStart( std::chrono::steady_clock::now() )
+	{
+	}
+
+	~ch_telemetry_scope_t()
+	{
+		Telemetry_Add( aHandle, std::chrono::duration< float, std::milli >( std::chrono::steady_clock::now() - aStart ).count() );
+	}
+};
+
+
+// register a subsystem prefixed with gTM_, the budget is the default value of its convar
+#define TELEMETRY_REGISTER( name, budget ) ch_telemetry_h gTM_##name = Telemetry_Register( #name, budget );
+
+// extern subsystem
+#define TELEMETRY( name )                  extern ch_telemetry_h gTM_##name;
+
+// time the rest of this scope for a subsystem
+#define TELEMETRY_SCOPE( name )            ch_telemetry_scope_t __ch_telemetry_scope( gTM_##name )
@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <atomic>
 #include <unordered_map>
+#include <type_traits>
 
 #include <time.h>
 
@@ -444,6 +445,51 @@ struct ch_string_auto
 };
 
 
+// -----------------------------------------------------------------
+// String Hashing
+// FNV-1a, these are constexpr so string literals can be hashed at compile time with CH_HASH
+
+
+constexpr u32 ch_hash_fnv1a_32( const char* str, size_t len )
+{
+	u32 hash = 2166136261u;
+
+	for ( size_t i = 0; i < len; i++ )
+	{
+		hash ^= (u8)str[ i ];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+constexpr u64 ch_hash_fnv1a_64( const char* str, size_t len )
+{
+	u64 hash = 14695981039346656037ull;
+
+	for ( size_t i = 0; i < len; i++ )
+	{
+		hash ^= (u8)str[ i ];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+
+// ID of an interned string, which is the 32-bit hash of it, see ch_str_intern in string.h
+// This is an enum so it can't be mixed up with indexes in function overloads
+enum ch_str_id : u32
+{
+	CH_STR_ID_INVALID = 0,
+};
+
+
+// Hash a string literal at compile time, this is the same as the id ch_str_intern returns for that string
+#define CH_HASH( str ) ( std::integral_constant< ch_str_id, (ch_str_id)ch_hash_fnv1a_32( "" str, sizeof( str ) - 1 ) >::value )
+
+
 // Hashing Support for ch_string and ch_string_auto
 namespace std
 {
@@ -452,12 +498,7 @@ struct hash< ch_string >
 {
 	size_t operator()( ch_string const& string ) const
 	{
-		size_t value = ( hash< size_t >()( string.size ) );
-
-		for ( size_t i = 0; i < string.size; i++ )
-			value ^= ( hash< char >()( string.data[ i ] ) );
-
-		return value;
+		return ch_hash_fnv1a_64( string.data, string.size );
 	}
 };
 
@@ -466,12 +507,7 @@ struct hash< ch_string_auto >
 {
 	size_t operator()( ch_string_auto const& string ) const
 	{
-		size_t value = ( hash< size_t >()( string.size ) );
-
-		for ( size_t i = 0; i < string.size; i++ )
-			value ^= ( hash< char >()( string.data[ i ] ) );
-
-		return value;
+		return ch_hash_fnv1a_64( string.data, string.size );
 	}
 };
 }
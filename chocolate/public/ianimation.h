@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <glm/mat4x4.hpp>
+
+// ======================================================
+// Skeletal animation, clip playback and pose evaluation
+// ======================================================
+
+
+// max number of clips that can be blended together on one pose
+constexpr u32 CH_ANIM_MAX_LAYERS = 4;
+constexpr u32 CH_ANIM_INVALID    = UINT32_MAX;
+
+
+// One clip sampled into a pose, all layers on a pose are blended by their weights
+struct AnimLayer_t
+{
+	u32   aClip   = CH_ANIM_INVALID;
+	float aTime   = 0.f;  // in seconds
+	float aWeight = 1.f;
+	bool  aLoop   = true;
+};
+
+
+class IAnimationSystem : public ISystem
+{
+   public:
+	// Loads the skeleton from the first skin in a glTF file, and every animation in that file as a clip
+	// Sets are reference counted, loading the same path again returns the same handle
+	virtual ch_handle_t LoadAnimSet( const std::string& srPath )                                               = 0;
+	virtual void        FreeAnimSet( ch_handle_t sAnimSet )                                                    = 0;
+
+	virtual u32         GetBoneCount( ch_handle_t sAnimSet )                                                   = 0;
+	virtual u32         FindBone( ch_handle_t sAnimSet, std::string_view sName )                               = 0;
+
+	virtual u32         GetClipCount( ch_handle_t sAnimSet )                                                   = 0;
+	virtual u32         FindClip( ch_handle_t sAnimSet, std::string_view sName )                               = 0;
+	virtual const char* GetClipName( ch_handle_t sAnimSet, u32 sClip )                                         = 0;
+	virtual float       GetClipLength( ch_handle_t sAnimSet, u32 sClip )                                       = 0;
+
+	// A pose is one instance of a skeleton, like a character
+	virtual ch_handle_t CreatePose( ch_handle_t sAnimSet )                                                     = 0;
+	virtual void        FreePose( ch_handle_t sPose )                                                          = 0;
+
+	// Layers are copied, the pose is evaluated on the next EvaluatePoses()
+	virtual void        SetPoseLayers( ch_handle_t sPose, const AnimLayer_t* spLayers, u32 sCount )            = 0;
+
+	// Evaluates every pose with new layers, split into batches across worker threads
+	virtual void        EvaluatePoses()                                                                        = 0;
+
+	// Model space bone transforms, used for attachments and hitboxes
+	virtual const glm::mat4* GetPoseBones( ch_handle_t sPose, u32& srCount )                                  = 0;
+
+	// Model space bone transforms multiplied by the inverse bind matrices, ready for IGraphics::SetRenderableBones()
+	virtual const glm::mat4* GetPoseSkinMatrices( ch_handle_t sPose, u32& srCount )                           = 0;
+};
+
+
+#define IANIMATION_NAME "Animation"
+#define IANIMATION_VER  1
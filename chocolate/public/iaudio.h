@@ -190,6 +190,21 @@ class IAudioSystem : public ISystem
 	virtual bool               GetEffectData( ch_handle_t stream, EAudioEffectData sDataType, float& data )           = 0;
 	virtual bool               GetEffectData( ch_handle_t stream, EAudioEffectData sDataType, glm::vec3& data )       = 0;
 
+	// -------------------------------------------------------------------------------------
+	// Offline Rendering
+	// -------------------------------------------------------------------------------------
+
+	// Stop sending audio to the output device, and only mix audio when RenderOffline is called
+	// The mixer clock only moves forward when audio is rendered, so the output is deterministic
+	virtual bool               BeginOfflineRender()                                                                   = 0;
+	virtual void               EndOfflineRender()                                                                     = 0;
+
+	// Mix sFrames of interleaved stereo 32-bit float audio at 48khz into spOutput, faster than real time
+	virtual u32                RenderOffline( float* spOutput, u32 sFrames )                                          = 0;
+
+	// Seconds of audio the mixer has mixed since startup
+	virtual double             GetMixTime()                                                                           = 0;
+
 #if 0
 	// -------------------------
 	// World Effect
@@ -223,5 +238,5 @@ class IAudioSystem : public ISystem
 
 
 #define IADUIO_NAME "Aduio"
-#define IADUIO_VER  4
+#define IADUIO_VER  5
 
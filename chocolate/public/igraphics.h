@@ -311,15 +311,12 @@ struct Shader_VertexData_t
 };
 
 
-// Each Bone Transform is local to the parent bone
-// We don't store this as a calculated matrix
-// as we just calculate it on the gpu once per skeleton update
-struct BoneTransform_t
+// Bone indices and weights for one vertex, packed to 16 bytes
+// aJoints holds 4 u16 bone indices, aWeights holds 4 unorm16 weights, 2 per u32
+struct Shader_VertexSkin_t
 {
-	u32       aParent;
-	glm::vec3 aPos;
-	glm::vec3 aAng;
-	glm::vec3 aScale;
+	u32 aJoints[ 2 ];
+	u32 aWeights[ 2 ];
 };
 
 
@@ -373,6 +370,10 @@ struct VertexData_t
 	// ChVector< ChVector< VertAttribData_t > > aBlendShapeData;
 	u32                          aBlendShapeCount = 0;
 	Shader_VertexData_t*         apBlendShapeData;  // size of data is (blend shape count) * (vertex count)
+
+	// Skeleton data, nullptr if the model isn't skinned, size of data is (vertex count)
+	u32                          aBoneCount       = 0;
+	Shader_VertexSkin_t*         apSkinData       = nullptr;
 };
 
 
@@ -390,6 +391,7 @@ struct ModelBuffers_t
 	u32        aVertexHandle     = UINT32_MAX;
 	u32        aIndexHandle      = UINT32_MAX;
 	u32        aBlendShapeHandle = UINT32_MAX;
+	u32        aSkinHandle       = UINT32_MAX;
 };
 
 
@@ -448,7 +450,7 @@ struct Renderable_t
 
 	// used for blend shapes and skeleton data, i don't like this here because very few models will have blend shapes/skeletons
 	ChVector< float >           aBlendShapeWeights;
-	ChVector< BoneTransform_t > aBoneTransforms;
+	ChVector< glm::mat4 >       aBoneMatrices;  // model space skinning matrices, already multiplied by the inverse bind matrix
 
 	// -------------------------------------------------
 	// Internal Rendering Parts
@@ -460,13 +462,12 @@ struct Renderable_t
 	// I don't like this here as only very few models will use skinning
 	ch_handle_t                  aVertexBuffer;
 	ch_handle_t                  aBlendShapeWeightsBuffer;
-	ch_handle_t                  aBoneTransformBuffer;
+	bool                        aOwnsVertexBuffer       = false;  // true if aVertexBuffer holds skinning output instead of the model's vertices
 
 	u32                         aVertexIndex            = UINT32_MAX;
 	u32                         aIndexHandle            = UINT32_MAX;
 	// u32               aBlendShapeWeightsMagic = UINT32_MAX;
 	u32                         aBlendShapeWeightsIndex = UINT32_MAX;
-	u32                         aBoneTransformHandle    = UINT32_MAX;
 
 	u32                         aIndex                  = UINT32_MAX;
 
@@ -688,6 +689,11 @@ struct ShaderMaterialData
 	ch_handle_t                    material;
 	u32                           matIndex;
 	ChVector< ShaderMaterialVar > vars;
+
+	// index of each shader material var in the material's var list, UINT32_MAX if the material doesn't set it
+	// resolved by name once, and again only when the material gets new vars
+	ChVector< u32 >               varIndices;
+	u32                           varIndicesMatVarCount = 0;
 };
 
 
@@ -828,6 +834,7 @@ struct ShaderCreate_t
 	u32                                aMaterialSize          = 0;
 	bool                               aUseMaterialBuffer     = false;
 	u32                                aMaterialBufferBinding = 0;
+	u32                                aMaxMaterials          = 0;  // size of the material buffer, which is indexed by matIndex
 };
 
 
@@ -853,6 +860,7 @@ struct ShaderData_t
 	u32                        aMaterialSize          = 0;
 	bool                       aUseMaterialBuffer     = false;
 	u32                        aMaterialBufferBinding = 0;
+	u32                        aMaxMaterials          = 0;
 };
 
 
@@ -933,6 +941,8 @@ struct RenderStats_t
 	size_t aVerticesDrawn;
 	size_t aMaterialsDrawn;
 	size_t aRenderablesDrawn;
+
+	TextureStreamStats_t aTextureStream;
 };
 
 
@@ -1203,6 +1213,9 @@ class IGraphics : public ISystem
 
 	virtual void                   SetRenderableDebugName( ch_handle_t sRenderable, std::string_view sName )                                       = 0;
 
+	// Copies the bone palette for a skinned renderable, sCount is clamped to the bone count of the model
+	virtual void                   SetRenderableBones( ch_handle_t sRenderable, const glm::mat4* spBones, u32 sCount )                            = 0;
+
 	virtual void                   CreateFrustum( Frustum_t& srFrustum, const glm::mat4& srViewMat )                                              = 0;
 	virtual Frustum_t              CreateFrustum( const glm::mat4& srViewMat )                                                                    = 0;
 
@@ -1314,7 +1327,7 @@ class IRenderSystem : public ISystem
 
 
 #define IGRAPHICS_NAME "Graphics"
-#define IGRAPHICS_VER  9
+#define IGRAPHICS_VER  12
 
 #define IRENDERSYSTEMOLD_NAME "IRenderSystemOld"
 #define IRENDERSYSTEMOLD_VER  1
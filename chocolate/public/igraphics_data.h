@@ -511,7 +511,8 @@ struct material_var_t
 
 struct material_t
 {
-	ch_string*      name;
+	ch_string*      name;     // interned, see ch_str_intern
+	ch_str_id*      name_id;
 	// u16*            name;
 	material_var_t* var;
 	e_mat_var*      type;
@@ -590,6 +591,10 @@ class IGraphicsData : public ISystem
 	virtual ch_string     material_get_string( ch_material_h handle, const char* var_name, const char* fallback = nullptr ) = 0;
 	virtual float         material_get_float( ch_material_h handle, const char* var_name, float fallback = 0.f )            = 0;
 
+	// same as above, but with the var name id from CH_HASH, which skips comparing the name to every var
+	virtual ch_string     material_get_string( ch_material_h handle, ch_str_id var_name, const char* fallback = nullptr )   = 0;
+	virtual float         material_get_float( ch_material_h handle, ch_str_id var_name, float fallback = 0.f )              = 0;
+
 	// --------------------------------------------------------------------------------------------
 	// Models - TODO: Have models load async, or on a job
 	// --------------------------------------------------------------------------------------------
@@ -639,5 +644,5 @@ class IGraphicsData : public ISystem
 
 
 #define CH_GRAPHICS_DATA     "ch_graphics_data"
-#define CH_GRAPHICS_DATA_VER 3
+#define CH_GRAPHICS_DATA_VER 4
 
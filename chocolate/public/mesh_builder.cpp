@@ -618,6 +618,67 @@ static bool realloc_free_cast( T*& spData, size_t sCount )
 }
 
 
+// Packs bone indices and normalized weights into the 16 byte layout the skinning shader reads
+static void MeshBuild_PackSkin( MeshBuildData_t& srMeshBuildData, Model* spModel, VertexData_t* spVertData )
+{
+	if ( srMeshBuildData.aBoneCount == 0 )
+		return;
+
+	bool hasSkin = false;
+	for ( MeshBuildMaterial_t& material : srMeshBuildData.aMaterials )
+		hasSkin |= material.apSkin != nullptr;
+
+	if ( !hasSkin )
+		return;
+
+	// vertices without skin data keep a weight of 0, and are left in place by the skinning shader
+	spVertData->apSkinData = ch_calloc< Shader_VertexSkin_t >( spVertData->aCount );
+	spVertData->aBoneCount = srMeshBuildData.aBoneCount;
+
+	for ( size_t matI = 0; matI < srMeshBuildData.aMaterials.size(); matI++ )
+	{
+		MeshBuildMaterial_t& material = srMeshBuildData.aMaterials[ matI ];
+
+		if ( !material.apSkin )
+			continue;
+
+		Shader_VertexSkin_t* skinData = spVertData->apSkinData + spModel->aMeshes[ matI ].aVertexOffset;
+
+		for ( u32 v = 0; v < material.aVertexCount; v++ )
+		{
+			MeshBuildSkinElement_t& element = material.apSkin[ v ];
+			float                   total   = 0.f;
+
+			// drop influences from bones outside the skeleton
+			for ( u32 i = 0; i < 4; i++ )
+			{
+				if ( element.aJoints[ i ] >= srMeshBuildData.aBoneCount || element.aWeights[ i ] < 0.f )
+				{
+					element.aJoints[ i ]  = 0;
+					element.aWeights[ i ] = 0.f;
+				}
+
+				total += element.aWeights[ i ];
+			}
+
+			float scale = total > 0.f ? 1.f / total : 0.f;
+			u32   weights[ 4 ];
+
+			for ( u32 i = 0; i < 4; i++ )
+				weights[ i ] = (u32)( glm::min( element.aWeights[ i ] * scale, 1.f ) * 65535.f + 0.5f );
+
+			skinData[ v ].aJoints[ 0 ]  = (u32)element.aJoints[ 0 ] | ( (u32)element.aJoints[ 1 ] << 16 );
+			skinData[ v ].aJoints[ 1 ]  = (u32)element.aJoints[ 2 ] | ( (u32)element.aJoints[ 3 ] << 16 );
+			skinData[ v ].aWeights[ 0 ] = weights[ 0 ] | ( weights[ 1 ] << 16 );
+			skinData[ v ].aWeights[ 1 ] = weights[ 2 ] | ( weights[ 3 ] << 16 );
+		}
+
+		free( material.apSkin );
+		material.apSkin = nullptr;
+	}
+}
+
+
 void MeshBuild_FinishMesh( IGraphics* spGraphics, MeshBuildData_t& srMeshBuildData, Model* spModel, bool sCalculateIndices, bool sUploadMesh, const char* spDebugName )
 {
 	if ( spModel->aMeshes.size() )
@@ -758,6 +819,8 @@ void MeshBuild_FinishMesh( IGraphics* spGraphics, MeshBuildData_t& srMeshBuildDa
 		}
 
 		vertData->aCount = indexList.size();
+
+		MeshBuild_PackSkin( srMeshBuildData, spModel, vertData );
 	}
 
 	if ( !sUploadMesh )
@@ -792,6 +855,12 @@ void MeshBuild_AllocateVertices( MeshBuildData_t& srMeshBuildData, u32 sMaterial
 	memset( material.apNorm + startCount, 0, sCount );
 	memset( material.apUV + startCount, 0, sCount );
 
+	if ( material.apSkin )
+	{
+		material.apSkin = ch_realloc( material.apSkin, startCount + sCount );
+		memset( material.apSkin + startCount, 0, sCount * sizeof( MeshBuildSkinElement_t ) );
+	}
+
 	material.aVertexCount += sCount;
 }
 
@@ -816,6 +885,16 @@ void MeshBuild_AllocateBlendShapes( MeshBuildMaterial_t& srMeshBuildMaterial, u3
 }
 
 
+// Skin data is allocated on demand, as most models don't have a skeleton
+void MeshBuild_AllocateSkin( MeshBuildMaterial_t& srMeshBuildMaterial )
+{
+	if ( srMeshBuildMaterial.apSkin || srMeshBuildMaterial.aVertexCount == 0 )
+		return;
+
+	srMeshBuildMaterial.apSkin = ch_calloc< MeshBuildSkinElement_t >( srMeshBuildMaterial.aVertexCount );
+}
+
+
 void MeshBuild_SetVertexPos( MeshBuildMaterial_t& srMeshBuildMaterial, u32 sVertIndex, const glm::vec3& data )
 {
 	srMeshBuildMaterial.apPos[ sVertIndex ] = data;
@@ -208,11 +208,19 @@ struct MeshBuildBlendShape_t
 };
 
 
+struct MeshBuildSkinElement_t
+{
+	u16   aJoints[ 4 ];
+	float aWeights[ 4 ];
+};
+
+
 struct MeshBuildMaterial_t
 {
 	glm::vec3*                        apPos;
 	glm::vec3*                        apNorm;
 	glm::vec2*                        apUV;
+	MeshBuildSkinElement_t*           apSkin = nullptr;  // only allocated if the model has a skeleton
 
 	u32                               aVertexCount;
 	ch_handle_t                        aMaterial = CH_INVALID_HANDLE;
@@ -255,6 +263,8 @@ struct MeshBuildData_t
 	VertexFormat                    aVertexFormat;
 
 	ChVector< std::string >         aBlendShapeNames;
+
+	u32                             aBoneCount = 0;
 };
 
 
@@ -264,6 +274,7 @@ void MeshBuild_FinishMesh( IGraphics* spGraphics, MeshBuildData_t& srMeshBuildDa
 
 void MeshBuild_AllocateVertices( MeshBuildData_t& srMeshBuildData, u32 sMaterial, u32 sCount );
 void MeshBuild_AllocateBlendShapes( MeshBuildMaterial_t& srMeshBuildMaterial, u32 sBlendShapeCount );
+void MeshBuild_AllocateSkin( MeshBuildMaterial_t& srMeshBuildMaterial );
 
 // void MeshBuild_SetVertexPos( MeshBuildMaterial_t& srMeshBuildMaterial, u32 sVertIndex, const glm::vec3& data );
 // void MeshBuild_FillVertexPosData( MeshBuildData_t& srMeshBuildData, u32 sMaterial, glm::vec3* spData, u32 sCount, u32 sOffset );
@@ -451,6 +451,16 @@ struct TextureCreateInfo_t
 };
 
 
+// Key/Value data the toolkit's texture cooker writes into cooked KTX2 files
+// The source time is the modified time in seconds of the texture it was cooked from
+#define CH_TEXTURE_COOK_KEY_SOURCE_TIME "ChSourceModified"
+#define CH_TEXTURE_COOK_KEY_USAGE       "ChTextureUsage"
+
+#define CH_TEXTURE_COOK_USAGE_COLOR     "color"
+#define CH_TEXTURE_COOK_USAGE_NORMAL    "normal"
+#define CH_TEXTURE_COOK_USAGE_MASK      "mask"
+
+
 // Describes how to load the texture, what it's used for, filter method, etc.
 // used for both loading textures and creating textures
 struct TextureCreateData_t
@@ -478,6 +488,20 @@ struct TextureInfo_t
 };
 
 
+// Residency of textures loaded with their mips streamed in over time
+struct TextureStreamStats_t
+{
+	u32 aStreamedTextures;   // textures that can stream mips
+	u32 aFullyResident;      // streamed textures with every mip resident
+	u32 aPendingLoads;       // mip loads waiting on a worker or in an upload
+	u32 aEvictedThisFrame;
+	u32 aEvictedTotal;
+	u64 aResidentBytes;      // memory used by streamed textures
+	u64 aBudgetBytes;
+	u64 aFullBytes;          // memory streamed textures would use with every mip resident
+};
+
+
 struct Viewport_t
 {
 	float x;
@@ -615,6 +639,10 @@ struct RenderPassAttachment_t
 
 	// HACK
 	bool               aGeneralFinalLayout = false;
+
+	// Keep what was in the attachment from the last render pass that used it, instead of starting from an undefined layout
+	// The attachment must have been used in a render pass before, or written with CmdCopyTexture
+	bool               aKeepContents       = false;
 };
 
 
@@ -656,6 +684,10 @@ struct CreateDescBinding_t
 	ShaderStage     aStages  = ShaderStage_None;
 	u32             aBinding = 0;
 	u32             aCount   = 1;
+
+	// Descriptors in this binding can be written while the set is bound in a command buffer in flight,
+	// as long as the elements written are not used by it. Meant for bindless arrays with stable slots
+	bool            aUpdateAfterBind = false;
 };
 
 
@@ -673,6 +705,9 @@ struct WriteDescSetBinding_t
 
 	u32             aCount   = 0;
 	ch_handle_t*     apData   = nullptr;
+
+	// first array element written, so only part of an array binding can be updated
+	u32             aArrayElement = 0;
 };
 
 
@@ -769,8 +804,8 @@ struct ReadTexture
 // Function callback for game code for when renderer gets reset
 typedef void ( *Render_OnReset_t )( ch_handle_t window, ERenderResetFlags sFlags );
 
-// Callback Function for when Texture Indices in the descriptor is updated
-using Render_OnTextureIndexUpdate = void();
+// Callback Function for when a texture's index in the descriptor changes, or the texture was freed
+using Render_OnTextureIndexUpdate = void( ch_handle_t sTexture );
 
 
 // TODO: if we keep this, rename this to IGraphicsAPI, and rename Graphics in sidury to Render, the names are backwards lol
@@ -818,6 +853,9 @@ class IRender : public ISystem
 	// Read data from a buffer
 	virtual u32         BufferRead( ch_handle_t buffer, u32 sSize, void* spData )                                                           = 0;
 
+	// Maps a host buffer and keeps it mapped until the buffer is destroyed, writes to it don't need flushing
+	virtual void*       BufferMap( ch_handle_t buffer )                                                                                     = 0;
+
 	// Copy one buffer to another buffer, useful for copying between host and device memory
 	virtual bool        BufferCopy( ch_handle_t shSrc, ch_handle_t shDst, BufferRegionCopy_t* spRegions, u32 sRegionCount )                      = 0;
 
@@ -844,6 +882,10 @@ class IRender : public ISystem
 	virtual TextureInfo_t                    GetTextureInfo( ch_handle_t sTexture )                                                                          = 0;
 	virtual void                             FreeTextureInfo( TextureInfo_t& srInfo )                                                                       = 0;
 
+	// Tells texture streaming how big this texture is on screen this frame in pixels, so it knows which mips to keep resident
+	virtual void        TextureStreamRequest( ch_handle_t shTexture, u32 sScreenSize )                                                 = 0;
+	virtual void        GetTextureStreamStats( TextureStreamStats_t& srStats )                                                          = 0;
+
 	// TODO: very early rough functions, need to be improved greatly
 	virtual ReadTexture ReadTextureFromDevice( ch_handle_t textureHandle )                                            = 0;
 	virtual void        FreeReadTexture( ReadTexture* pData )                                                        = 0;
@@ -977,9 +1019,13 @@ class IRender : public ISystem
 	                                 u32        sGroupCountZ ) = 0;
 
 	virtual void        CmdPipelineBarrier( ch_handle_t sCmd, PipelineBarrier_t& srBarrier ) = 0;
+
+	// Copy a whole texture into another one with the same size and format, outside of a render pass
+	// Both need to be render targets that were last used in a render pass, and the old contents of the destination are discarded
+	virtual void        CmdCopyTexture( ch_handle_t sCmd, ch_handle_t sSrc, ch_handle_t sDst ) = 0;
 };
 
 
 #define IRENDER_NAME "GraphicsAPI"
-#define IRENDER_VER 22
+#define IRENDER_VER 26
 
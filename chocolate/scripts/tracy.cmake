@@ -19,3 +19,13 @@ if( USE_TRACY )
 	)
 endif()
 
+
+# The built in profiler, used when Tracy isn't, turn it off to compile out every PROF_SCOPE
+if( NOT DEFINED USE_CH_PROFILER )
+	set( USE_CH_PROFILER 1 )
+endif()
+
+if( USE_CH_PROFILER AND NOT USE_TRACY )
+	message( "Compiling With The Built In Profiler" )
+	add_compile_definitions( CH_PROFILER=1 )
+endif()
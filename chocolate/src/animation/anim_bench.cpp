@@ -0,0 +1,209 @@
+#include "animation.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+
+
+// Builds a skeleton of limbs hanging off a root bone, with a few looping clips made from sine waves
+// Every 4th bone isn't animated, so the bind pose path gets used too
+static AnimSet_t* Anim_CreateBenchSet( u32 sBoneCount, size_t& srRawSize )
+{
+	AnimSet_t* set  = new AnimSet_t;
+	set->aPath      = "";
+	set->aBoneCount = sBoneCount;
+
+	set->aBoneNames.resize( sBoneCount );
+	set->aParents.resize( sBoneCount );
+	set->aRootMatrices.resize( sBoneCount );
+	set->aInverseBind.resize( sBoneCount );
+	set->aBindPos.resize( sBoneCount );
+	set->aBindRot.resize( sBoneCount );
+	set->aBindScale.resize( sBoneCount );
+
+	for ( u32 bone = 0; bone < sBoneCount; bone++ )
+	{
+		set->aBoneNames[ bone ]    = vstring( "bone_%d", bone );
+		set->aParents[ bone ]      = bone == 0 ? -1 : ( bone % 8 == 1 ? 0 : bone - 1 );
+		set->aRootMatrices[ bone ] = glm::mat4( 1.f );
+		set->aBindPos[ bone ]      = bone == 0 ? glm::vec3( 0.f ) : glm::vec3( 0.f, 0.f, 0.1f );
+		set->aBindRot[ bone ]      = glm::quat( 1.f, 0.f, 0.f, 0.f );
+		set->aBindScale[ bone ]    = glm::vec3( 1.f );
+	}
+
+	Anim_BuildBoneOrder( set );
+
+	// the inverse bind matrices come from the model space bind pose
+	std::vector< glm::mat4 > bindMatrices( sBoneCount );
+
+	for ( u32 i = 0; i < sBoneCount; i++ )
+	{
+		u32       bone  = set->aOrder[ i ];
+		glm::mat4 local = glm::translate( glm::mat4( 1.f ), set->aBindPos[ bone ] );
+
+		bindMatrices[ bone ]      = set->aParents[ bone ] >= 0 ? bindMatrices[ set->aParents[ bone ] ] * local : local;
+		set->aInverseBind[ bone ] = glm::inverse( bindMatrices[ bone ] );
+	}
+
+	srRawSize = 0;
+
+	for ( u32 clipIndex = 0; clipIndex < 3; clipIndex++ )
+	{
+		AnimRawClip_t raw;
+		raw.aName       = vstring( "bench_%d", clipIndex );
+		raw.aLength     = 1.f + clipIndex;
+		raw.aFrameCount = (u32)( raw.aLength * CH_ANIM_SAMPLE_RATE ) + 1;
+		raw.aBones.resize( sBoneCount );
+
+		for ( u32 bone = 0; bone < sBoneCount; bone++ )
+		{
+			if ( bone % 4 == 3 )
+				continue;
+
+			AnimRawBone_t& rawBone = raw.aBones[ bone ];
+			rawBone.aRot.resize( raw.aFrameCount );
+
+			if ( bone == 0 )
+				rawBone.aPos.resize( raw.aFrameCount );
+
+			for ( u32 frame = 0; frame < raw.aFrameCount; frame++ )
+			{
+				float time              = frame / CH_ANIM_SAMPLE_RATE;
+				float phase             = time / raw.aLength * 2.f * M_PI;
+				float angle             = sinf( phase * ( 1 + bone % 3 ) + bone ) * 0.5f;
+
+				rawBone.aRot[ frame ]   = glm::angleAxis( angle, glm::normalize( glm::vec3( 1.f, bone % 2, clipIndex ) ) );
+
+				if ( bone == 0 )
+					rawBone.aPos[ frame ] = glm::vec3( 0.f, 0.f, sinf( phase * 2.f ) * 0.05f );
+			}
+
+			srRawSize += rawBone.aPos.size() * sizeof( glm::vec3 ) + rawBone.aRot.size() * sizeof( glm::quat );
+		}
+
+		Anim_CompressClip( set->aClips.emplace_back(), raw, set );
+	}
+
+	return set;
+}
+
+
+// Evaluates poses for a bunch of characters each frame with no renderer, and reports the CPU time per frame
+static void Anim_Bench( u32 sCharacterCount, u32 sFrameCount, u32 sBoneCount, const std::string& srPath )
+{
+	ch_handle_t setHandle = CH_INVALID_HANDLE;
+	size_t      rawSize   = 0;
+
+	if ( srPath.size() )
+	{
+		setHandle = animation->LoadAnimSet( srPath );
+	}
+	else
+	{
+		setHandle = animation->AddAnimSet( Anim_CreateBenchSet( sBoneCount, rawSize ) );
+	}
+
+	AnimSet_t* set = animation->GetAnimSet( setHandle );
+
+	if ( !set )
+		return;
+
+	if ( set->aClips.empty() )
+	{
+		Log_ErrorF( gLC_Animation, "Anim Set has no clips to benchmark: \"%s\"\n", srPath.c_str() );
+		animation->FreeAnimSet( setHandle );
+		return;
+	}
+
+	std::vector< ch_handle_t > poses( sCharacterCount );
+
+	for ( u32 i = 0; i < sCharacterCount; i++ )
+		poses[ i ] = animation->CreatePose( setHandle );
+
+	u32    clipCount = set->aClips.size();
+	float  time      = 0.f;
+
+	double minTime   = DBL_MAX;
+	double maxTime   = 0.0;
+	double totalTime = 0.0;
+
+	// the first frame isn't timed, it only evaluates the bind pose and warms up the workers
+	animation->EvaluatePoses();
+
+	for ( u32 frame = 0; frame < sFrameCount; frame++ )
+	{
+		time += 1.f / 60.f;
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		// every character blends two clips with its own offset, so no two poses are the same
+		for ( u32 i = 0; i < sCharacterCount; i++ )
+		{
+			float       blend       = sinf( time + i * 0.37f ) * 0.5f + 0.5f;
+			AnimLayer_t layers[ 2 ] = {};
+
+			layers[ 0 ].aClip       = i % clipCount;
+			layers[ 0 ].aTime       = time + i * 0.1f;
+			layers[ 0 ].aWeight     = 1.f - blend;
+
+			layers[ 1 ].aClip       = ( i + 1 ) % clipCount;
+			layers[ 1 ].aTime       = time * 1.3f + i * 0.1f;
+			layers[ 1 ].aWeight     = blend;
+
+			animation->SetPoseLayers( poses[ i ], layers, 2 );
+		}
+
+		animation->EvaluatePoses();
+
+		auto   endTime = std::chrono::high_resolution_clock::now();
+		double elapsed = std::chrono::duration< double, std::micro >( endTime - startTime ).count();
+
+		minTime        = std::min( minTime, elapsed );
+		maxTime        = std::max( maxTime, elapsed );
+		totalTime += elapsed;
+	}
+
+	double avgTime  = totalTime / std::max( sFrameCount, 1u );
+	size_t clipSize = 0;
+
+	for ( const AnimClip_t& clip : set->aClips )
+		clipSize += Anim_GetClipSize( clip );
+
+	Log_MsgF( gLC_Animation, "Animation Benchmark - %u characters, %u bones, %u clips, %u frames, %zd worker threads\n",
+	          sCharacterCount, set->aBoneCount, clipCount, sFrameCount, animation->aWorkers.size() );
+	Log_MsgF( gLC_Animation, "    avg %.2f ms, min %.2f ms, max %.2f ms per frame\n", avgTime / 1000.0, minTime / 1000.0, maxTime / 1000.0 );
+	Log_MsgF( gLC_Animation, "    %.3f us per character\n", avgTime / std::max( sCharacterCount, 1u ) );
+
+	if ( rawSize )
+		Log_MsgF( gLC_Animation, "    clips are %.1f KB compressed, %.1f KB resampled\n", clipSize / 1024.0, rawSize / 1024.0 );
+	else
+		Log_MsgF( gLC_Animation, "    clips are %.1f KB compressed\n", clipSize / 1024.0 );
+
+	for ( ch_handle_t pose : poses )
+		animation->FreePose( pose );
+
+	animation->FreeAnimSet( setHandle );
+}
+
+
+CONCMD_VA( anim_bench, "Evaluate poses for many characters without a renderer and report CPU time per frame - anim_bench [characters] [frames] [bones] [path]" )
+{
+	u32         characterCount = 1000;
+	u32         frameCount     = 300;
+	u32         boneCount      = 64;
+	std::string path;
+
+	if ( args.size() > 0 )
+		characterCount = std::max( atoi( args[ 0 ].c_str() ), 1 );
+
+	if ( args.size() > 1 )
+		frameCount = std::max( atoi( args[ 1 ].c_str() ), 1 );
+
+	if ( args.size() > 2 )
+		boneCount = std::clamp( atoi( args[ 2 ].c_str() ), 1, (int)CH_ANIM_MAX_BONES );
+
+	// bone count is ignored when loading a file
+	if ( args.size() > 3 )
+		path = args[ 3 ];
+
+	Anim_Bench( characterCount, frameCount, boneCount, path );
+}
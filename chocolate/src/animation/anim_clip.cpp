@@ -0,0 +1,424 @@
+#include "animation.h"
+
+
+CONVAR_FLOAT( anim_tolerance_rot, 0.1f, "Max rotation error in degrees when removing key frames from a clip on load" );
+CONVAR_FLOAT( anim_tolerance_pos, 0.0005f, "Max translation error when removing key frames from a clip on load" );
+CONVAR_FLOAT( anim_tolerance_scale, 0.0005f, "Max scale error when removing key frames from a clip on load" );
+
+
+// range of the 3 smallest components of a normalized quaternion
+constexpr float CH_ANIM_QUAT_RANGE = 0.70710678f;
+constexpr float CH_ANIM_QUAT_SCALE = 32767.f;
+
+
+void AnimPoseSoA_t::Resize( u32 sBoneCount )
+{
+	for ( u32 i = 0; i < 3; i++ )
+	{
+		aPos[ i ].resize( sBoneCount );
+		aScale[ i ].resize( sBoneCount );
+	}
+
+	for ( u32 i = 0; i < 4; i++ )
+		aRot[ i ].resize( sBoneCount );
+}
+
+
+// -----------------------------------------------------------------------------------
+// Quantization
+
+
+static AnimQuat_t Anim_PackQuat( glm::quat sQuat )
+{
+	float comp[ 4 ] = { sQuat.x, sQuat.y, sQuat.z, sQuat.w };
+	u32   largest   = 0;
+
+	for ( u32 i = 1; i < 4; i++ )
+	{
+		if ( fabsf( comp[ i ] ) > fabsf( comp[ largest ] ) )
+			largest = i;
+	}
+
+	// q and -q are the same rotation, flip it so the dropped component is positive
+	float      sign = comp[ largest ] < 0.f ? -1.f : 1.f;
+
+	AnimQuat_t packed;
+	u32        out  = 0;
+
+	for ( u32 i = 0; i < 4; i++ )
+	{
+		if ( i == largest )
+			continue;
+
+		float value          = std::clamp( comp[ i ] * sign / CH_ANIM_QUAT_RANGE, -1.f, 1.f );
+		u16   quant          = (u16)roundf( ( value * 0.5f + 0.5f ) * CH_ANIM_QUAT_SCALE );
+		packed.aData[ out++ ] = quant << 1;
+	}
+
+	packed.aData[ 0 ] |= largest & 1;
+	packed.aData[ 1 ] |= ( largest >> 1 ) & 1;
+
+	return packed;
+}
+
+
+static glm::quat Anim_UnpackQuat( const AnimQuat_t& srPacked )
+{
+	u32   largest   = ( srPacked.aData[ 0 ] & 1 ) | ( ( srPacked.aData[ 1 ] & 1 ) << 1 );
+	float comp[ 4 ];
+	float sum       = 0.f;
+	u32   in        = 0;
+
+	for ( u32 i = 0; i < 4; i++ )
+	{
+		if ( i == largest )
+			continue;
+
+		float value = ( ( srPacked.aData[ in++ ] >> 1 ) / CH_ANIM_QUAT_SCALE * 2.f - 1.f ) * CH_ANIM_QUAT_RANGE;
+		comp[ i ]   = value;
+		sum += value * value;
+	}
+
+	comp[ largest ] = sqrtf( std::max( 1.f - sum, 0.f ) );
+
+	return glm::quat( comp[ 3 ], comp[ 0 ], comp[ 1 ], comp[ 2 ] );
+}
+
+
+static AnimVec3_t Anim_PackVec3( const glm::vec3& srValue, const AnimTrack_t& srTrack )
+{
+	AnimVec3_t packed;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		float value        = srTrack.aExtent[ i ] > 0.f ? ( srValue[ i ] - srTrack.aMin[ i ] ) / srTrack.aExtent[ i ] : 0.f;
+		packed.aData[ i ] = (u16)roundf( std::clamp( value, 0.f, 1.f ) * 65535.f );
+	}
+
+	return packed;
+}
+
+
+inline glm::vec3 Anim_UnpackVec3( const AnimVec3_t& srPacked, const AnimTrack_t& srTrack )
+{
+	return srTrack.aMin + srTrack.aExtent * glm::vec3( srPacked.aData[ 0 ], srPacked.aData[ 1 ], srPacked.aData[ 2 ] ) * ( 1.f / 65535.f );
+}
+
+
+// -----------------------------------------------------------------------------------
+// Key Frame Reduction
+
+
+inline float Anim_GetError( const glm::vec3& srA, const glm::vec3& srB )
+{
+	return glm::length( srA - srB );
+}
+
+
+// angle between the two rotations in degrees
+inline float Anim_GetError( const glm::quat& srA, const glm::quat& srB )
+{
+	float dot = std::min( fabsf( glm::dot( srA, srB ) ), 1.f );
+	return glm::degrees( 2.f * acosf( dot ) );
+}
+
+
+inline glm::vec3 Anim_Interp( const glm::vec3& srA, const glm::vec3& srB, float sFactor )
+{
+	return glm::mix( srA, srB, sFactor );
+}
+
+
+// nlerp, keys are close enough together that slerp isn't worth it
+inline glm::quat Anim_Interp( const glm::quat& srA, const glm::quat& srB, float sFactor )
+{
+	float     sign = glm::dot( srA, srB ) < 0.f ? -1.f : 1.f;
+	glm::quat out  = srA * ( 1.f - sFactor ) + srB * ( sign * sFactor );
+	return glm::normalize( out );
+}
+
+
+// Greedily drops every frame that can be rebuilt by interpolating the frames around it within the tolerance
+// The first and last frames are always kept, and a track that never changes is reduced to one key
+template< typename T >
+static void Anim_ReduceKeys( const std::vector< T >& srFrames, float sTolerance, std::vector< u32 >& srKeys )
+{
+	srKeys.clear();
+
+	if ( srFrames.empty() )
+		return;
+
+	srKeys.push_back( 0 );
+
+	u32 last = 0;
+
+	for ( u32 i = 1; i + 1 < srFrames.size(); i++ )
+	{
+		// can we skip this frame and go straight from the last key to the next frame?
+		u32  next = i + 1;
+		bool keep = false;
+
+		for ( u32 j = last + 1; j < next; j++ )
+		{
+			float factor = float( j - last ) / float( next - last );
+
+			if ( Anim_GetError( Anim_Interp( srFrames[ last ], srFrames[ next ], factor ), srFrames[ j ] ) > sTolerance )
+			{
+				keep = true;
+				break;
+			}
+		}
+
+		if ( !keep )
+			continue;
+
+		srKeys.push_back( i );
+		last = i;
+	}
+
+	if ( srFrames.size() > 1 )
+		srKeys.push_back( srFrames.size() - 1 );
+
+	// constant track
+	if ( srKeys.size() == 2 && Anim_GetError( srFrames[ srKeys[ 0 ] ], srFrames[ srKeys[ 1 ] ] ) <= sTolerance )
+		srKeys.pop_back();
+}
+
+
+static void Anim_CompressVec3Track( AnimClip_t& srClip, EAnimChannel sChannel, u32 sBone, const std::vector< glm::vec3 >& srFrames,
+                                    const glm::vec3& srBind, float sTolerance, std::vector< u32 >& srKeys )
+{
+	AnimTrack_t& track = srClip.aTracks[ sChannel * ( srClip.aTracks.size() / EAnimChannel_Count ) + sBone ];
+
+	Anim_ReduceKeys( srFrames, sTolerance, srKeys );
+
+	// no need to store a track that is just the bind pose
+	if ( srKeys.empty() || ( srKeys.size() == 1 && Anim_GetError( srFrames[ srKeys[ 0 ] ], srBind ) <= sTolerance ) )
+		return;
+
+	glm::vec3 min = srFrames[ srKeys[ 0 ] ];
+	glm::vec3 max = min;
+
+	for ( u32 key : srKeys )
+	{
+		min = glm::min( min, srFrames[ key ] );
+		max = glm::max( max, srFrames[ key ] );
+	}
+
+	track.aMin      = min;
+	track.aExtent   = max - min;
+	track.aFirstKey = srClip.aKeyFrames[ sChannel ].size();
+	track.aKeyCount = srKeys.size();
+
+	ChVector< AnimVec3_t >& values = sChannel == EAnimChannel_Translation ? srClip.aPosKeys : srClip.aScaleKeys;
+
+	for ( u32 key : srKeys )
+	{
+		srClip.aKeyFrames[ sChannel ].push_back( key );
+		values.push_back( Anim_PackVec3( srFrames[ key ], track ) );
+	}
+}
+
+
+static void Anim_CompressRotTrack( AnimClip_t& srClip, u32 sBone, const std::vector< glm::quat >& srFrames, const glm::quat& srBind,
+                                   std::vector< u32 >& srKeys )
+{
+	AnimTrack_t& track = srClip.aTracks[ EAnimChannel_Rotation * ( srClip.aTracks.size() / EAnimChannel_Count ) + sBone ];
+
+	Anim_ReduceKeys( srFrames, anim_tolerance_rot, srKeys );
+
+	if ( srKeys.empty() || ( srKeys.size() == 1 && Anim_GetError( srFrames[ srKeys[ 0 ] ], srBind ) <= anim_tolerance_rot ) )
+		return;
+
+	track.aFirstKey = srClip.aKeyFrames[ EAnimChannel_Rotation ].size();
+	track.aKeyCount = srKeys.size();
+
+	for ( u32 key : srKeys )
+	{
+		srClip.aKeyFrames[ EAnimChannel_Rotation ].push_back( key );
+		srClip.aRotKeys.push_back( Anim_PackQuat( srFrames[ key ] ) );
+	}
+}
+
+
+void Anim_CompressClip( AnimClip_t& srClip, const AnimRawClip_t& srRaw, const AnimSet_t* spSet )
+{
+	PROF_SCOPE();
+
+	srClip.aName       = srRaw.aName;
+	srClip.aLength     = srRaw.aLength;
+	srClip.aFrameCount = std::clamp< u32 >( srRaw.aFrameCount, 1, UINT16_MAX );
+
+	srClip.aTracks.resize( spSet->aBoneCount * EAnimChannel_Count );
+
+	std::vector< u32 > keys;
+
+	for ( u32 bone = 0; bone < spSet->aBoneCount && bone < srRaw.aBones.size(); bone++ )
+	{
+		const AnimRawBone_t& raw = srRaw.aBones[ bone ];
+
+		Anim_CompressVec3Track( srClip, EAnimChannel_Translation, bone, raw.aPos, spSet->aBindPos[ bone ], anim_tolerance_pos, keys );
+		Anim_CompressRotTrack( srClip, bone, raw.aRot, spSet->aBindRot[ bone ], keys );
+		Anim_CompressVec3Track( srClip, EAnimChannel_Scale, bone, raw.aScale, spSet->aBindScale[ bone ], anim_tolerance_scale, keys );
+	}
+}
+
+
+size_t Anim_GetClipSize( const AnimClip_t& srClip )
+{
+	size_t size = srClip.aTracks.size_bytes() + srClip.aPosKeys.size_bytes() + srClip.aRotKeys.size_bytes() + srClip.aScaleKeys.size_bytes();
+
+	for ( u32 i = 0; i < EAnimChannel_Count; i++ )
+		size += srClip.aKeyFrames[ i ].size_bytes();
+
+	return size;
+}
+
+
+// -----------------------------------------------------------------------------------
+// Sampling
+
+
+// finds the key at or before this frame in the track, and the interpolation factor to the key after it
+inline u32 Anim_FindKey( const u16* spFrames, const AnimTrack_t& srTrack, float sFrame, float& srFactor )
+{
+	const u16* first = spFrames + srTrack.aFirstKey;
+	u32        low   = 0;
+	u32        high  = srTrack.aKeyCount - 1;
+
+	while ( low < high )
+	{
+		u32 mid = ( low + high + 1 ) / 2;
+
+		if ( first[ mid ] <= sFrame )
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	if ( low + 1 >= srTrack.aKeyCount )
+	{
+		srFactor = 0.f;
+		return low;
+	}
+
+	srFactor = std::clamp( ( sFrame - first[ low ] ) / float( first[ low + 1 ] - first[ low ] ), 0.f, 1.f );
+	return low;
+}
+
+
+void Anim_SetBindPose( const AnimSet_t* spSet, AnimPoseSoA_t& srOut )
+{
+	for ( u32 bone = 0; bone < spSet->aBoneCount; bone++ )
+	{
+		for ( int i = 0; i < 3; i++ )
+		{
+			srOut.aPos[ i ][ bone ]   = spSet->aBindPos[ bone ][ i ];
+			srOut.aScale[ i ][ bone ] = spSet->aBindScale[ bone ][ i ];
+		}
+
+		srOut.aRot[ 0 ][ bone ] = spSet->aBindRot[ bone ].x;
+		srOut.aRot[ 1 ][ bone ] = spSet->aBindRot[ bone ].y;
+		srOut.aRot[ 2 ][ bone ] = spSet->aBindRot[ bone ].z;
+		srOut.aRot[ 3 ][ bone ] = spSet->aBindRot[ bone ].w;
+	}
+}
+
+
+static void Anim_SampleVec3Channel( const AnimSet_t* spSet, const AnimClip_t& srClip, EAnimChannel sChannel, float sFrame, ChVector< float >* spOut )
+{
+	const AnimTrack_t*      tracks = &srClip.aTracks[ sChannel * spSet->aBoneCount ];
+	const u16*              frames = srClip.aKeyFrames[ sChannel ].apData;
+	const ChVector< AnimVec3_t >& values = sChannel == EAnimChannel_Translation ? srClip.aPosKeys : srClip.aScaleKeys;
+
+	for ( u32 bone = 0; bone < spSet->aBoneCount; bone++ )
+	{
+		const AnimTrack_t& track = tracks[ bone ];
+
+		if ( track.aKeyCount == 0 )
+			continue;
+
+		float     factor = 0.f;
+		u32       key    = Anim_FindKey( frames, track, sFrame, factor );
+		glm::vec3 value  = Anim_UnpackVec3( values[ track.aFirstKey + key ], track );
+
+		if ( factor > 0.f )
+			value = glm::mix( value, Anim_UnpackVec3( values[ track.aFirstKey + key + 1 ], track ), factor );
+
+		spOut[ 0 ][ bone ] = value.x;
+		spOut[ 1 ][ bone ] = value.y;
+		spOut[ 2 ][ bone ] = value.z;
+	}
+}
+
+
+void Anim_SampleClip( const AnimSet_t* spSet, const AnimClip_t& srClip, float sTime, bool sLoop, AnimPoseSoA_t& srOut )
+{
+	// start from the bind pose, only animated tracks are written over it
+	Anim_SetBindPose( spSet, srOut );
+
+	if ( sLoop && srClip.aLength > 0.f )
+	{
+		sTime = fmodf( sTime, srClip.aLength );
+
+		if ( sTime < 0.f )
+			sTime += srClip.aLength;
+	}
+
+	float frame = std::clamp( sTime * CH_ANIM_SAMPLE_RATE, 0.f, float( srClip.aFrameCount - 1 ) );
+
+	Anim_SampleVec3Channel( spSet, srClip, EAnimChannel_Translation, frame, srOut.aPos );
+	Anim_SampleVec3Channel( spSet, srClip, EAnimChannel_Scale, frame, srOut.aScale );
+
+	const AnimTrack_t* tracks = &srClip.aTracks[ EAnimChannel_Rotation * spSet->aBoneCount ];
+	const u16*         frames = srClip.aKeyFrames[ EAnimChannel_Rotation ].apData;
+
+	for ( u32 bone = 0; bone < spSet->aBoneCount; bone++ )
+	{
+		const AnimTrack_t& track = tracks[ bone ];
+
+		if ( track.aKeyCount == 0 )
+			continue;
+
+		float     factor = 0.f;
+		u32       key    = Anim_FindKey( frames, track, frame, factor );
+		glm::quat value  = Anim_UnpackQuat( srClip.aRotKeys[ track.aFirstKey + key ] );
+
+		if ( factor > 0.f )
+			value = Anim_Interp( value, Anim_UnpackQuat( srClip.aRotKeys[ track.aFirstKey + key + 1 ] ), factor );
+
+		srOut.aRot[ 0 ][ bone ] = value.x;
+		srOut.aRot[ 1 ][ bone ] = value.y;
+		srOut.aRot[ 2 ][ bone ] = value.z;
+		srOut.aRot[ 3 ][ bone ] = value.w;
+	}
+}
+
+
+// -----------------------------------------------------------------------------------
+
+
+void Anim_BuildBoneOrder( AnimSet_t* spSet )
+{
+	spSet->aOrder.clear();
+	spSet->aOrder.reserve( spSet->aBoneCount );
+
+	// depth of each bone, then sort by it so every parent comes before its children
+	std::vector< u32 > depth( spSet->aBoneCount, 0 );
+
+	for ( u32 bone = 0; bone < spSet->aBoneCount; bone++ )
+	{
+		s32 parent = spSet->aParents[ bone ];
+
+		for ( u32 i = 0; parent >= 0 && i < spSet->aBoneCount; i++ )
+		{
+			depth[ bone ]++;
+			parent = spSet->aParents[ parent ];
+		}
+
+		spSet->aOrder.push_back( bone );
+	}
+
+	std::stable_sort( spSet->aOrder.apData, spSet->aOrder.apData + spSet->aOrder.size(), [ &depth ]( u32 a, u32 b )
+	                  { return depth[ a ] < depth[ b ]; } );
+}
@@ -0,0 +1,289 @@
+#include "animation.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf/cgltf.h"
+
+
+static void Anim_DecomposeNode( const cgltf_node* spNode, glm::vec3& srPos, glm::quat& srRot, glm::vec3& srScale )
+{
+	srPos   = glm::vec3( 0.f );
+	srRot   = glm::quat( 1.f, 0.f, 0.f, 0.f );
+	srScale = glm::vec3( 1.f );
+
+	if ( spNode->has_matrix )
+	{
+		glm::mat4 matrix = glm::make_mat4( spNode->matrix );
+
+		srPos            = glm::vec3( matrix[ 3 ] );
+		srScale          = glm::vec3( glm::length( glm::vec3( matrix[ 0 ] ) ), glm::length( glm::vec3( matrix[ 1 ] ) ), glm::length( glm::vec3( matrix[ 2 ] ) ) );
+
+		glm::mat3 rot( glm::vec3( matrix[ 0 ] ) / srScale.x, glm::vec3( matrix[ 1 ] ) / srScale.y, glm::vec3( matrix[ 2 ] ) / srScale.z );
+		srRot = glm::normalize( glm::quat_cast( rot ) );
+		return;
+	}
+
+	if ( spNode->has_translation )
+		srPos = glm::make_vec3( spNode->translation );
+
+	// glTF stores quaternions as x, y, z, w
+	if ( spNode->has_rotation )
+		srRot = glm::normalize( glm::quat( spNode->rotation[ 3 ], spNode->rotation[ 0 ], spNode->rotation[ 1 ], spNode->rotation[ 2 ] ) );
+
+	if ( spNode->has_scale )
+		srScale = glm::make_vec3( spNode->scale );
+}
+
+
+static bool Anim_LoadSkeleton( AnimSet_t* spSet, const cgltf_skin* spSkin, std::unordered_map< const cgltf_node*, u32 >& srJointMap )
+{
+	if ( spSkin->joints_count == 0 || spSkin->joints_count > CH_ANIM_MAX_BONES )
+	{
+		Log_ErrorF( gLC_Animation, "Skeleton has %zd bones, must be between 1 and %d: \"%s\"\n", spSkin->joints_count, CH_ANIM_MAX_BONES, spSet->aPath.c_str() );
+		return false;
+	}
+
+	u32 boneCount     = spSkin->joints_count;
+	spSet->aBoneCount = boneCount;
+
+	spSet->aBoneNames.resize( boneCount );
+	spSet->aParents.resize( boneCount );
+	spSet->aRootMatrices.resize( boneCount );
+	spSet->aInverseBind.resize( boneCount );
+	spSet->aBindPos.resize( boneCount );
+	spSet->aBindRot.resize( boneCount );
+	spSet->aBindScale.resize( boneCount );
+
+	for ( u32 bone = 0; bone < boneCount; bone++ )
+		srJointMap[ spSkin->joints[ bone ] ] = bone;
+
+	for ( u32 bone = 0; bone < boneCount; bone++ )
+	{
+		const cgltf_node* node     = spSkin->joints[ bone ];
+
+		spSet->aBoneNames[ bone ]    = node->name ? node->name : "";
+		spSet->aParents[ bone ]      = -1;
+		spSet->aRootMatrices[ bone ] = glm::mat4( 1.f );
+
+		auto it                      = node->parent ? srJointMap.find( node->parent ) : srJointMap.end();
+
+		if ( it != srJointMap.end() )
+		{
+			spSet->aParents[ bone ] = it->second;
+		}
+		else if ( node->parent )
+		{
+			// the armature node, or anything else above the skeleton
+			cgltf_node_transform_world( node->parent, glm::value_ptr( spSet->aRootMatrices[ bone ] ) );
+		}
+
+		Anim_DecomposeNode( node, spSet->aBindPos[ bone ], spSet->aBindRot[ bone ], spSet->aBindScale[ bone ] );
+
+		if ( !spSkin->inverse_bind_matrices || !cgltf_accessor_read_float( spSkin->inverse_bind_matrices, bone, glm::value_ptr( spSet->aInverseBind[ bone ] ), 16 ) )
+			spSet->aInverseBind[ bone ] = glm::mat4( 1.f );
+	}
+
+	Anim_BuildBoneOrder( spSet );
+	return true;
+}
+
+
+// Resamples one channel at every frame of the clip, srOut gets sFrameCount * sComps floats
+static bool Anim_SampleChannel( const cgltf_animation_sampler* spSampler, u32 sComps, u32 sFrameCount, std::vector< float >& srOut )
+{
+	const cgltf_accessor* input  = spSampler->input;
+	const cgltf_accessor* output = spSampler->output;
+
+	if ( !input || !output || input->count == 0 )
+		return false;
+
+	// cubic spline stores an in tangent, the value, and an out tangent for each key
+	// we only use the values and interpolate linearly, the clip is already resampled at a high enough rate
+	bool                  cubic  = spSampler->interpolation == cgltf_interpolation_type_cubic_spline;
+	bool                  step   = spSampler->interpolation == cgltf_interpolation_type_step;
+	u32                   stride = cubic ? 3 : 1;
+
+	if ( output->count < input->count * stride )
+		return false;
+
+	std::vector< float > times( input->count );
+	std::vector< float > values( input->count * sComps );
+
+	for ( cgltf_size i = 0; i < input->count; i++ )
+	{
+		cgltf_accessor_read_float( input, i, &times[ i ], 1 );
+		cgltf_accessor_read_float( output, i * stride + ( cubic ? 1 : 0 ), &values[ i * sComps ], sComps );
+	}
+
+	srOut.resize( sFrameCount * sComps );
+
+	for ( u32 frame = 0; frame < sFrameCount; frame++ )
+	{
+		float  time   = frame / CH_ANIM_SAMPLE_RATE;
+		size_t next   = std::upper_bound( times.begin(), times.end(), time ) - times.begin();
+		size_t prev   = next > 0 ? next - 1 : 0;
+		next          = std::min( next, times.size() - 1 );
+
+		float  factor = 0.f;
+
+		if ( !step && next != prev && times[ next ] > times[ prev ] )
+			factor = std::clamp( ( time - times[ prev ] ) / ( times[ next ] - times[ prev ] ), 0.f, 1.f );
+
+		float* out    = &srOut[ frame * sComps ];
+		float* a      = &values[ prev * sComps ];
+		float* b      = &values[ next * sComps ];
+
+		// rotations are renormalized afterwards, and flipped to the same hemisphere first
+		float  sign   = 1.f;
+
+		if ( sComps == 4 )
+		{
+			float dot = a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ] + a[ 3 ] * b[ 3 ];
+			sign      = dot < 0.f ? -1.f : 1.f;
+		}
+
+		for ( u32 i = 0; i < sComps; i++ )
+			out[ i ] = a[ i ] * ( 1.f - factor ) + b[ i ] * sign * factor;
+	}
+
+	return true;
+}
+
+
+static void Anim_LoadClip( AnimSet_t* spSet, const cgltf_animation* spAnim, u32 sIndex, const std::unordered_map< const cgltf_node*, u32 >& srJointMap )
+{
+	AnimRawClip_t raw;
+
+	if ( spAnim->name && spAnim->name[ 0 ] )
+		raw.aName = spAnim->name;
+	else
+		raw.aName = vstring( "clip_%d", sIndex );
+
+	for ( cgltf_size i = 0; i < spAnim->samplers_count; i++ )
+	{
+		const cgltf_accessor* input = spAnim->samplers[ i ].input;
+
+		if ( input && input->has_max )
+			raw.aLength = std::max( raw.aLength, input->max[ 0 ] );
+	}
+
+	raw.aFrameCount = std::clamp< u32 >( (u32)ceilf( raw.aLength * CH_ANIM_SAMPLE_RATE ) + 1, 1, UINT16_MAX );
+	raw.aLength     = ( raw.aFrameCount - 1 ) / CH_ANIM_SAMPLE_RATE;
+	raw.aBones.resize( spSet->aBoneCount );
+
+	std::vector< float > samples;
+
+	for ( cgltf_size i = 0; i < spAnim->channels_count; i++ )
+	{
+		const cgltf_animation_channel& channel = spAnim->channels[ i ];
+
+		auto                           it      = srJointMap.find( channel.target_node );
+
+		// morph target weights are handled by the renderer, and we don't care about nodes outside the skeleton
+		if ( it == srJointMap.end() || !channel.sampler )
+			continue;
+
+		AnimRawBone_t& bone = raw.aBones[ it->second ];
+
+		switch ( channel.target_path )
+		{
+			case cgltf_animation_path_type_translation:
+			case cgltf_animation_path_type_scale:
+			{
+				if ( !Anim_SampleChannel( channel.sampler, 3, raw.aFrameCount, samples ) )
+					break;
+
+				std::vector< glm::vec3 >& frames = channel.target_path == cgltf_animation_path_type_translation ? bone.aPos : bone.aScale;
+				frames.resize( raw.aFrameCount );
+
+				for ( u32 frame = 0; frame < raw.aFrameCount; frame++ )
+					frames[ frame ] = glm::make_vec3( &samples[ frame * 3 ] );
+
+				break;
+			}
+
+			case cgltf_animation_path_type_rotation:
+			{
+				if ( !Anim_SampleChannel( channel.sampler, 4, raw.aFrameCount, samples ) )
+					break;
+
+				bone.aRot.resize( raw.aFrameCount );
+
+				for ( u32 frame = 0; frame < raw.aFrameCount; frame++ )
+				{
+					float* value       = &samples[ frame * 4 ];
+					bone.aRot[ frame ] = glm::normalize( glm::quat( value[ 3 ], value[ 0 ], value[ 1 ], value[ 2 ] ) );
+				}
+
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	AnimClip_t& clip = spSet->aClips.emplace_back();
+	Anim_CompressClip( clip, raw, spSet );
+
+	size_t rawSize = 0;
+
+	for ( const AnimRawBone_t& bone : raw.aBones )
+		rawSize += bone.aPos.size() * sizeof( glm::vec3 ) + bone.aRot.size() * sizeof( glm::quat ) + bone.aScale.size() * sizeof( glm::vec3 );
+
+	Log_DevF( gLC_Animation, 1, "Loaded Clip \"%s\" - %.2f sec, %zd KB resampled, %zd KB compressed\n",
+	          clip.aName.c_str(), clip.aLength, rawSize / 1024, Anim_GetClipSize( clip ) / 1024 );
+}
+
+
+bool Anim_LoadGltf( AnimSet_t* spSet, const std::string& srPath )
+{
+	PROF_SCOPE();
+
+	cgltf_options options{};
+	cgltf_data*   gltf   = NULL;
+	cgltf_result  result = cgltf_parse_file( &options, srPath.c_str(), &gltf );
+
+	if ( result != cgltf_result_success )
+	{
+		Log_ErrorF( gLC_Animation, "Failed Loading GLTF File: \"%d\" - \"%s\"\n", result, srPath.c_str() );
+		return false;
+	}
+
+	result = cgltf_load_buffers( &options, gltf, srPath.c_str() );
+
+	if ( result != cgltf_result_success )
+	{
+		Log_ErrorF( gLC_Animation, "Failed Loading GLTF Buffers: \"%d\" - \"%s\"\n", result, srPath.c_str() );
+		cgltf_free( gltf );
+		return false;
+	}
+
+	if ( gltf->skins_count == 0 )
+	{
+		Log_ErrorF( gLC_Animation, "GLTF File has no skeleton: \"%s\"\n", srPath.c_str() );
+		cgltf_free( gltf );
+		return false;
+	}
+
+	// KEEP IN SYNC WITH LoadSkin() in model_gltf.cpp, the joint order has to match the skin data the renderer loads
+	if ( gltf->skins_count > 1 )
+		Log_WarnF( gLC_Animation, "GLTF File has %zd skins, only the first one is animated: \"%s\"\n", gltf->skins_count, srPath.c_str() );
+
+	std::unordered_map< const cgltf_node*, u32 > jointMap;
+
+	if ( !Anim_LoadSkeleton( spSet, &gltf->skins[ 0 ], jointMap ) )
+	{
+		cgltf_free( gltf );
+		return false;
+	}
+
+	spSet->aClips.reserve( gltf->animations_count );
+
+	for ( cgltf_size i = 0; i < gltf->animations_count; i++ )
+		Anim_LoadClip( spSet, &gltf->animations[ i ], i, jointMap );
+
+	cgltf_free( gltf );
+	return true;
+}
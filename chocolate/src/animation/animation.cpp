@@ -0,0 +1,614 @@
+#include "animation.h"
+
+#if CH_USE_MIMALLOC
+  #include "mimalloc-new-delete.h"
+#endif
+
+
+LOG_CHANNEL_REGISTER( Animation, ELogColor_Cyan );
+
+CONVAR_INT( anim_threads, -1, "Worker threads used to evaluate poses, -1 picks from the core count, 0 evaluates on the calling thread" );
+
+
+AnimationSystem* animation = new AnimationSystem;
+
+
+static ModuleInterface_t gInterfaces[] = {
+	{ animation, IANIMATION_NAME, IANIMATION_VER }
+};
+
+
+extern "C"
+{
+	DLL_EXPORT ModuleInterface_t* ch_get_interfaces( u8& srCount )
+	{
+		srCount = 1;
+		return gInterfaces;
+	}
+}
+
+
+// -----------------------------------------------------------------------------------
+// Pose Evaluation
+
+
+inline glm::mat4 Anim_ComposeMatrix( const AnimPoseSoA_t& srPose, u32 sBone )
+{
+	glm::quat rot( srPose.aRot[ 3 ][ sBone ], srPose.aRot[ 0 ][ sBone ], srPose.aRot[ 1 ][ sBone ], srPose.aRot[ 2 ][ sBone ] );
+	glm::mat4 matrix = glm::mat4_cast( rot );
+
+	matrix[ 0 ] *= srPose.aScale[ 0 ][ sBone ];
+	matrix[ 1 ] *= srPose.aScale[ 1 ][ sBone ];
+	matrix[ 2 ] *= srPose.aScale[ 2 ][ sBone ];
+	matrix[ 3 ] = glm::vec4( srPose.aPos[ 0 ][ sBone ], srPose.aPos[ 1 ][ sBone ], srPose.aPos[ 2 ][ sBone ], 1.f );
+
+	return matrix;
+}
+
+
+// adds srLayer * sWeight onto srBlend, rotations are flipped onto the same hemisphere as what's already blended
+static void Anim_BlendLayer( AnimPoseSoA_t& srBlend, const AnimPoseSoA_t& srLayer, u32 sBoneCount, float sWeight )
+{
+	for ( u32 i = 0; i < 3; i++ )
+	{
+		float*       blendPos   = srBlend.aPos[ i ].apData;
+		float*       blendScale = srBlend.aScale[ i ].apData;
+		const float* layerPos   = srLayer.aPos[ i ].apData;
+		const float* layerScale = srLayer.aScale[ i ].apData;
+
+		for ( u32 bone = 0; bone < sBoneCount; bone++ )
+		{
+			blendPos[ bone ] += layerPos[ bone ] * sWeight;
+			blendScale[ bone ] += layerScale[ bone ] * sWeight;
+		}
+	}
+
+	float* blendRot[ 4 ] = { srBlend.aRot[ 0 ].apData, srBlend.aRot[ 1 ].apData, srBlend.aRot[ 2 ].apData, srBlend.aRot[ 3 ].apData };
+	float* layerRot[ 4 ] = { srLayer.aRot[ 0 ].apData, srLayer.aRot[ 1 ].apData, srLayer.aRot[ 2 ].apData, srLayer.aRot[ 3 ].apData };
+
+	for ( u32 bone = 0; bone < sBoneCount; bone++ )
+	{
+		float dot = blendRot[ 0 ][ bone ] * layerRot[ 0 ][ bone ] + blendRot[ 1 ][ bone ] * layerRot[ 1 ][ bone ] +
+		            blendRot[ 2 ][ bone ] * layerRot[ 2 ][ bone ] + blendRot[ 3 ][ bone ] * layerRot[ 3 ][ bone ];
+
+		float weight = dot < 0.f ? -sWeight : sWeight;
+
+		blendRot[ 0 ][ bone ] += layerRot[ 0 ][ bone ] * weight;
+		blendRot[ 1 ][ bone ] += layerRot[ 1 ][ bone ] * weight;
+		blendRot[ 2 ][ bone ] += layerRot[ 2 ][ bone ] * weight;
+		blendRot[ 3 ][ bone ] += layerRot[ 3 ][ bone ] * weight;
+	}
+}
+
+
+static void Anim_ClearPose( AnimPoseSoA_t& srPose, u32 sBoneCount )
+{
+	for ( u32 i = 0; i < 3; i++ )
+	{
+		memset( srPose.aPos[ i ].apData, 0, sBoneCount * sizeof( float ) );
+		memset( srPose.aScale[ i ].apData, 0, sBoneCount * sizeof( float ) );
+	}
+
+	for ( u32 i = 0; i < 4; i++ )
+		memset( srPose.aRot[ i ].apData, 0, sBoneCount * sizeof( float ) );
+}
+
+
+static void Anim_NormalizeRotations( AnimPoseSoA_t& srPose, u32 sBoneCount )
+{
+	float* rot[ 4 ] = { srPose.aRot[ 0 ].apData, srPose.aRot[ 1 ].apData, srPose.aRot[ 2 ].apData, srPose.aRot[ 3 ].apData };
+
+	for ( u32 bone = 0; bone < sBoneCount; bone++ )
+	{
+		float length = rot[ 0 ][ bone ] * rot[ 0 ][ bone ] + rot[ 1 ][ bone ] * rot[ 1 ][ bone ] + rot[ 2 ][ bone ] * rot[ 2 ][ bone ] + rot[ 3 ][ bone ] * rot[ 3 ][ bone ];
+		float scale  = length > 0.f ? 1.f / sqrtf( length ) : 0.f;
+
+		rot[ 0 ][ bone ] *= scale;
+		rot[ 1 ][ bone ] *= scale;
+		rot[ 2 ][ bone ] *= scale;
+
+		// a rotation that canceled itself out, use identity
+		rot[ 3 ][ bone ] = length > 0.f ? rot[ 3 ][ bone ] * scale : 1.f;
+	}
+}
+
+
+void Anim_EvaluatePose( AnimPose_t* spPose, AnimScratch_t& srScratch )
+{
+	const AnimSet_t* set       = spPose->apSet;
+	u32              boneCount = set->aBoneCount;
+
+	srScratch.aLayer.Resize( boneCount );
+	srScratch.aBlend.Resize( boneCount );
+
+	float totalWeight = 0.f;
+	u32   layerCount  = 0;
+
+	for ( u32 i = 0; i < spPose->aLayerCount; i++ )
+	{
+		const AnimLayer_t& layer = spPose->aLayers[ i ];
+
+		if ( layer.aClip < set->aClips.size() && layer.aWeight > 0.f )
+		{
+			totalWeight += layer.aWeight;
+			layerCount++;
+		}
+	}
+
+	if ( layerCount == 0 )
+	{
+		Anim_SetBindPose( set, srScratch.aBlend );
+	}
+	else if ( layerCount == 1 )
+	{
+		// nothing to blend, sample straight into the output
+		for ( u32 i = 0; i < spPose->aLayerCount; i++ )
+		{
+			const AnimLayer_t& layer = spPose->aLayers[ i ];
+
+			if ( layer.aClip < set->aClips.size() && layer.aWeight > 0.f )
+				Anim_SampleClip( set, set->aClips[ layer.aClip ], layer.aTime, layer.aLoop, srScratch.aBlend );
+		}
+	}
+	else
+	{
+		Anim_ClearPose( srScratch.aBlend, boneCount );
+
+		for ( u32 i = 0; i < spPose->aLayerCount; i++ )
+		{
+			const AnimLayer_t& layer = spPose->aLayers[ i ];
+
+			if ( layer.aClip >= set->aClips.size() || layer.aWeight <= 0.f )
+				continue;
+
+			Anim_SampleClip( set, set->aClips[ layer.aClip ], layer.aTime, layer.aLoop, srScratch.aLayer );
+			Anim_BlendLayer( srScratch.aBlend, srScratch.aLayer, boneCount, layer.aWeight / totalWeight );
+		}
+
+		Anim_NormalizeRotations( srScratch.aBlend, boneCount );
+	}
+
+	// local space to model space, parents are always evaluated before their children
+	for ( u32 i = 0; i < boneCount; i++ )
+	{
+		u32       bone   = set->aOrder[ i ];
+		s32       parent = set->aParents[ bone ];
+		glm::mat4 local  = Anim_ComposeMatrix( srScratch.aBlend, bone );
+
+		if ( parent >= 0 )
+			spPose->aBones[ bone ] = spPose->aBones[ parent ] * local;
+		else
+			spPose->aBones[ bone ] = set->aRootMatrices[ bone ] * local;
+	}
+
+	for ( u32 bone = 0; bone < boneCount; bone++ )
+		spPose->aSkinMatrices[ bone ] = spPose->aBones[ bone ] * set->aInverseBind[ bone ];
+}
+
+
+// -----------------------------------------------------------------------------------
+// Worker Threads
+
+
+void AnimationSystem::StartWorkers( u32 sCount )
+{
+	aScratch.resize( sCount + 1 );
+	aWorkQuit = false;
+
+	// workers start from the current generation, so ones made after work already ran don't think there's new work
+	for ( u32 i = 0; i < sCount; i++ )
+		aWorkers.emplace_back( &AnimationSystem::WorkerThread, this, i + 1, aWorkGeneration );
+
+	Log_DevF( gLC_Animation, 1, "Started %d Animation Worker Threads\n", sCount );
+}
+
+
+void AnimationSystem::StopWorkers()
+{
+	{
+		std::lock_guard< std::mutex > lock( aWorkMutex );
+		aWorkQuit = true;
+	}
+
+	aWorkStart.notify_all();
+
+	for ( std::thread& worker : aWorkers )
+		worker.join();
+
+	aWorkers.clear();
+}
+
+
+void AnimationSystem::WorkerThread( u32 sIndex, u32 sGeneration )
+{
+	u32 generation = sGeneration;
+
+	while ( true )
+	{
+		{
+			std::unique_lock< std::mutex > lock( aWorkMutex );
+			aWorkStart.wait( lock, [ & ]() { return aWorkQuit || aWorkGeneration != generation; } );
+
+			if ( aWorkQuit )
+				return;
+
+			generation = aWorkGeneration;
+		}
+
+		for ( u32 batch = aWorkNextBatch++; batch < aWorkBatchCount; batch = aWorkNextBatch++ )
+			( *apWorkFunc )( batch, aScratch[ sIndex ] );
+
+		{
+			std::lock_guard< std::mutex > lock( aWorkMutex );
+			aWorkersBusy--;
+		}
+
+		aWorkDone.notify_one();
+	}
+}
+
+
+void AnimationSystem::RunBatches( u32 sBatchCount, const std::function< void( u32, AnimScratch_t& ) >& srFunc )
+{
+	PROF_SCOPE();
+
+	// restart the workers if the thread count changed
+	u32 threadCount = anim_threads < 0 ? std::max( std::thread::hardware_concurrency(), 2u ) - 1 : (u32)anim_threads;
+
+	if ( threadCount != aWorkers.size() )
+	{
+		StopWorkers();
+		StartWorkers( threadCount );
+	}
+
+	if ( aWorkers.empty() || sBatchCount == 1 )
+	{
+		for ( u32 batch = 0; batch < sBatchCount; batch++ )
+			srFunc( batch, aScratch[ 0 ] );
+
+		return;
+	}
+
+	{
+		std::lock_guard< std::mutex > lock( aWorkMutex );
+		apWorkFunc      = &srFunc;
+		aWorkBatchCount = sBatchCount;
+		aWorkNextBatch  = 0;
+		aWorkersBusy    = aWorkers.size();
+		aWorkGeneration++;
+	}
+
+	aWorkStart.notify_all();
+
+	// the calling thread helps out instead of just waiting
+	for ( u32 batch = aWorkNextBatch++; batch < sBatchCount; batch = aWorkNextBatch++ )
+		srFunc( batch, aScratch[ 0 ] );
+
+	std::unique_lock< std::mutex > lock( aWorkMutex );
+	aWorkDone.wait( lock, [ & ]() { return aWorkersBusy == 0; } );
+
+	apWorkFunc = nullptr;
+}
+
+
+// -----------------------------------------------------------------------------------
+// Animation System
+
+
+bool AnimationSystem::Init()
+{
+	aScratch.resize( 1 );
+	return true;
+}
+
+
+void AnimationSystem::Shutdown()
+{
+	StopWorkers();
+
+	for ( ch_handle_t handle : aPoses.aHandles )
+	{
+		if ( AnimPose_t** pose = aPoses.Get( handle ) )
+			delete *pose;
+	}
+
+	for ( ch_handle_t handle : aSets.aHandles )
+	{
+		if ( AnimSet_t** set = aSets.Get( handle ) )
+			delete *set;
+	}
+
+	aPoses.aHandles.clear();
+	aSets.aHandles.clear();
+	aSetPaths.clear();
+	aDirtyPoses.clear();
+}
+
+
+AnimSet_t* AnimationSystem::GetAnimSet( ch_handle_t sAnimSet )
+{
+	AnimSet_t** set = aSets.Get( sAnimSet );
+
+	if ( !set )
+	{
+		Log_ErrorF( gLC_Animation, "Invalid Anim Set Handle: %zd\n", sAnimSet );
+		return nullptr;
+	}
+
+	return *set;
+}
+
+
+ch_handle_t AnimationSystem::AddAnimSet( AnimSet_t* spSet )
+{
+	spSet->aRefCount = 1;
+	return aSets.Add( spSet );
+}
+
+
+ch_handle_t AnimationSystem::LoadAnimSet( const std::string& srPath )
+{
+	PROF_SCOPE();
+
+	auto it = aSetPaths.find( srPath );
+
+	if ( it != aSetPaths.end() )
+	{
+		if ( AnimSet_t* set = GetAnimSet( it->second ) )
+			set->aRefCount++;
+
+		return it->second;
+	}
+
+	ch_string_auto fullPath = FileSys_FindFile( srPath.data(), srPath.size() );
+
+	if ( !fullPath.data && FileSys_IsRelative( srPath.data() ) )
+	{
+		ch_string_auto newPath = ch_str_join( "models" CH_PATH_SEP_STR, 7, (char*)srPath.data(), (s64)srPath.size() );
+		fullPath               = FileSys_FindFile( newPath.data, newPath.size );
+	}
+
+	if ( !fullPath.data )
+	{
+		Log_ErrorF( gLC_Animation, "Failed to Find Anim Set: %s\n", srPath.c_str() );
+		return CH_INVALID_HANDLE;
+	}
+
+	AnimSet_t* set = new AnimSet_t;
+	set->aPath     = srPath;
+
+	if ( !Anim_LoadGltf( set, std::string( fullPath.data, fullPath.size ) ) )
+	{
+		delete set;
+		return CH_INVALID_HANDLE;
+	}
+
+	ch_handle_t handle  = AddAnimSet( set );
+	aSetPaths[ srPath ] = handle;
+
+	Log_DevF( gLC_Animation, 1, "Loaded Anim Set \"%s\" - %d bones, %zd clips\n", srPath.c_str(), set->aBoneCount, set->aClips.size() );
+	return handle;
+}
+
+
+void AnimationSystem::FreeAnimSet( ch_handle_t sAnimSet )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set )
+		return;
+
+	if ( set->aRefCount > 1 )
+	{
+		set->aRefCount--;
+		return;
+	}
+
+	if ( set->aPath.size() )
+		aSetPaths.erase( set->aPath );
+
+	delete set;
+	aSets.Remove( sAnimSet );
+}
+
+
+u32 AnimationSystem::GetBoneCount( ch_handle_t sAnimSet )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+	return set ? set->aBoneCount : 0;
+}
+
+
+u32 AnimationSystem::FindBone( ch_handle_t sAnimSet, std::string_view sName )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set )
+		return CH_ANIM_INVALID;
+
+	for ( u32 i = 0; i < set->aBoneNames.size(); i++ )
+	{
+		if ( set->aBoneNames[ i ] == sName )
+			return i;
+	}
+
+	return CH_ANIM_INVALID;
+}
+
+
+u32 AnimationSystem::GetClipCount( ch_handle_t sAnimSet )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+	return set ? set->aClips.size() : 0;
+}
+
+
+u32 AnimationSystem::FindClip( ch_handle_t sAnimSet, std::string_view sName )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set )
+		return CH_ANIM_INVALID;
+
+	for ( u32 i = 0; i < set->aClips.size(); i++ )
+	{
+		if ( set->aClips[ i ].aName == sName )
+			return i;
+	}
+
+	return CH_ANIM_INVALID;
+}
+
+
+const char* AnimationSystem::GetClipName( ch_handle_t sAnimSet, u32 sClip )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set || sClip >= set->aClips.size() )
+		return nullptr;
+
+	return set->aClips[ sClip ].aName.c_str();
+}
+
+
+float AnimationSystem::GetClipLength( ch_handle_t sAnimSet, u32 sClip )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set || sClip >= set->aClips.size() )
+		return 0.f;
+
+	return set->aClips[ sClip ].aLength;
+}
+
+
+ch_handle_t AnimationSystem::CreatePose( ch_handle_t sAnimSet )
+{
+	AnimSet_t* set = GetAnimSet( sAnimSet );
+
+	if ( !set )
+		return CH_INVALID_HANDLE;
+
+	set->aRefCount++;
+
+	AnimPose_t* pose = new AnimPose_t;
+	pose->apSet      = set;
+	pose->aSetHandle = sAnimSet;
+	pose->aBones.resize( set->aBoneCount );
+	pose->aSkinMatrices.resize( set->aBoneCount );
+
+	// no layers, so this starts in the bind pose
+	pose->aDirty     = true;
+	aDirtyPoses.push_back( pose );
+
+	return aPoses.Add( pose );
+}
+
+
+void AnimationSystem::FreePose( ch_handle_t sPose )
+{
+	AnimPose_t** posePtr = aPoses.Get( sPose );
+
+	if ( !posePtr )
+		return;
+
+	AnimPose_t* pose = *posePtr;
+
+	if ( pose->aDirty )
+		vec_remove( aDirtyPoses, pose );
+
+	FreeAnimSet( pose->aSetHandle );
+
+	delete pose;
+	aPoses.Remove( sPose );
+}
+
+
+void AnimationSystem::SetPoseLayers( ch_handle_t sPose, const AnimLayer_t* spLayers, u32 sCount )
+{
+	AnimPose_t** posePtr = aPoses.Get( sPose );
+
+	if ( !posePtr )
+		return;
+
+	AnimPose_t* pose = *posePtr;
+
+	if ( sCount > CH_ANIM_MAX_LAYERS )
+	{
+		Log_WarnF( gLC_Animation, "Too many animation layers on pose (%d), max is %d\n", sCount, CH_ANIM_MAX_LAYERS );
+		sCount = CH_ANIM_MAX_LAYERS;
+	}
+
+	std::copy( spLayers, spLayers + sCount, pose->aLayers );
+	pose->aLayerCount = sCount;
+
+	if ( !pose->aDirty )
+	{
+		pose->aDirty = true;
+		aDirtyPoses.push_back( pose );
+	}
+}
+
+
+void AnimationSystem::EvaluatePoses()
+{
+	PROF_SCOPE();
+
+	if ( aDirtyPoses.empty() )
+		return;
+
+	// group poses by skeleton, so each batch only walks the clip data of one set
+	std::sort( aDirtyPoses.begin(), aDirtyPoses.end(), []( AnimPose_t* a, AnimPose_t* b ) { return a->apSet < b->apSet; } );
+
+	std::vector< u32 > batchStarts;
+	batchStarts.reserve( aDirtyPoses.size() / CH_ANIM_BATCH_SIZE + 2 );
+
+	for ( u32 i = 0; i < aDirtyPoses.size(); i++ )
+	{
+		if ( batchStarts.empty() || i - batchStarts.back() >= CH_ANIM_BATCH_SIZE || aDirtyPoses[ i ]->apSet != aDirtyPoses[ batchStarts.back() ]->apSet )
+			batchStarts.push_back( i );
+	}
+
+	u32 batchCount = batchStarts.size();
+	batchStarts.push_back( aDirtyPoses.size() );
+
+	RunBatches( batchCount, [ & ]( u32 sBatch, AnimScratch_t& srScratch )
+	            {
+		for ( u32 i = batchStarts[ sBatch ]; i < batchStarts[ sBatch + 1 ]; i++ )
+		{
+			Anim_EvaluatePose( aDirtyPoses[ i ], srScratch );
+			aDirtyPoses[ i ]->aDirty = false;
+		} } );
+
+	aDirtyPoses.clear();
+}
+
+
+const glm::mat4* AnimationSystem::GetPoseBones( ch_handle_t sPose, u32& srCount )
+{
+	AnimPose_t** pose = aPoses.Get( sPose );
+
+	if ( !pose )
+	{
+		srCount = 0;
+		return nullptr;
+	}
+
+	srCount = ( *pose )->aBones.size();
+	return ( *pose )->aBones.apData;
+}
+
+
+const glm::mat4* AnimationSystem::GetPoseSkinMatrices( ch_handle_t sPose, u32& srCount )
+{
+	AnimPose_t** pose = aPoses.Get( sPose );
+
+	if ( !pose )
+	{
+		srCount = 0;
+		return nullptr;
+	}
+
+	srCount = ( *pose )->aSkinMatrices.size();
+	return ( *pose )->aSkinMatrices.apData;
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "ianimation.h"
+#include "core/resource.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+LOG_CHANNEL( Animation );
+
+// clips are resampled to this many frames per second on load, keys are stored as frame numbers
+constexpr float CH_ANIM_SAMPLE_RATE = 30.f;
+
+// poses evaluated together by one worker, every pose in a batch uses the same skeleton
+constexpr u32   CH_ANIM_BATCH_SIZE  = 32;
+
+// max bones in a skeleton, the renderer packs joint indices into 16 bits
+constexpr u32   CH_ANIM_MAX_BONES   = 1024;
+
+
+enum EAnimChannel : u8
+{
+	EAnimChannel_Translation,
+	EAnimChannel_Rotation,
+	EAnimChannel_Scale,
+
+	EAnimChannel_Count,
+};
+
+
+// smallest three quaternion, the largest component is dropped and rebuilt from the other three
+// 15 bits per component, the index of the dropped component is in the low bit of the first two
+struct AnimQuat_t
+{
+	u16 aData[ 3 ];
+};
+
+
+// each component is normalized between the min and extent of the track
+struct AnimVec3_t
+{
+	u16 aData[ 3 ];
+};
+
+
+struct AnimTrack_t
+{
+	u32       aFirstKey = 0;  // into the key frames and values of this channel
+	u32       aKeyCount = 0;  // 0 means this bone uses the bind pose for this channel
+	glm::vec3 aMin{};         // only used by translation and scale
+	glm::vec3 aExtent{};
+};
+
+
+struct AnimClip_t
+{
+	std::string            aName;
+	float                  aLength     = 0.f;
+	u32                    aFrameCount = 0;
+
+	// bone count tracks for each channel, indexed by channel * bone count + bone
+	ChVector< AnimTrack_t > aTracks;
+
+	// frame number of each key, sorted within each track
+	ChVector< u16 >        aKeyFrames[ EAnimChannel_Count ];
+
+	ChVector< AnimVec3_t > aPosKeys;
+	ChVector< AnimQuat_t > aRotKeys;
+	ChVector< AnimVec3_t > aScaleKeys;
+};
+
+
+// uncompressed clip, every animated channel is sampled at every frame, empty channels are not animated
+struct AnimRawBone_t
+{
+	std::vector< glm::vec3 > aPos;
+	std::vector< glm::quat > aRot;
+	std::vector< glm::vec3 > aScale;
+};
+
+
+struct AnimRawClip_t
+{
+	std::string                  aName;
+	float                        aLength     = 0.f;
+	u32                          aFrameCount = 0;
+	std::vector< AnimRawBone_t > aBones;
+};
+
+
+struct AnimSet_t
+{
+	std::string                aPath;
+	u32                        aRefCount  = 0;
+	u32                        aBoneCount = 0;
+
+	std::vector< std::string > aBoneNames;
+	ChVector< s32 >            aParents;       // -1 for root bones
+	ChVector< u32 >            aOrder;         // bone indices with parents always before their children
+	ChVector< glm::mat4 >      aRootMatrices;  // transform of the nodes above a root bone, only used by roots
+	ChVector< glm::mat4 >      aInverseBind;
+
+	ChVector< glm::vec3 >      aBindPos;
+	ChVector< glm::quat >      aBindRot;
+	ChVector< glm::vec3 >      aBindScale;
+
+	std::vector< AnimClip_t >  aClips;
+};
+
+
+struct AnimPose_t
+{
+	AnimSet_t*            apSet;
+	ch_handle_t           aSetHandle;
+
+	AnimLayer_t           aLayers[ CH_ANIM_MAX_LAYERS ];
+	u32                   aLayerCount = 0;
+	bool                  aDirty      = false;
+
+	ChVector< glm::mat4 > aBones;
+	ChVector< glm::mat4 > aSkinMatrices;
+};
+
+
+// local space pose with each component in its own array, so sampling and blending are straight loops over the bones
+struct AnimPoseSoA_t
+{
+	ChVector< float > aPos[ 3 ];
+	ChVector< float > aRot[ 4 ];
+	ChVector< float > aScale[ 3 ];
+
+	void              Resize( u32 sBoneCount );
+};
+
+
+// per worker memory for evaluating poses
+struct AnimScratch_t
+{
+	AnimPoseSoA_t aLayer;
+	AnimPoseSoA_t aBlend;
+};
+
+
+class AnimationSystem : public IAnimationSystem
+{
+   public:
+	bool                       Init() override;
+	void                       Shutdown() override;
+
+	ch_handle_t                LoadAnimSet( const std::string& srPath ) override;
+	void                       FreeAnimSet( ch_handle_t sAnimSet ) override;
+
+	u32                        GetBoneCount( ch_handle_t sAnimSet ) override;
+	u32                        FindBone( ch_handle_t sAnimSet, std::string_view sName ) override;
+
+	u32                        GetClipCount( ch_handle_t sAnimSet ) override;
+	u32                        FindClip( ch_handle_t sAnimSet, std::string_view sName ) override;
+	const char*                GetClipName( ch_handle_t sAnimSet, u32 sClip ) override;
+	float                      GetClipLength( ch_handle_t sAnimSet, u32 sClip ) override;
+
+	ch_handle_t                CreatePose( ch_handle_t sAnimSet ) override;
+	void                       FreePose( ch_handle_t sPose ) override;
+	void                       SetPoseLayers( ch_handle_t sPose, const AnimLayer_t* spLayers, u32 sCount ) override;
+
+	void                       EvaluatePoses() override;
+
+	const glm::mat4*           GetPoseBones( ch_handle_t sPose, u32& srCount ) override;
+	const glm::mat4*           GetPoseSkinMatrices( ch_handle_t sPose, u32& srCount ) override;
+
+	// -------------------------------------------------------------------
+	// Internal
+
+	AnimSet_t*                 GetAnimSet( ch_handle_t sAnimSet );
+
+	// adds a set that wasn't loaded from a file, used by the benchmark
+	ch_handle_t                AddAnimSet( AnimSet_t* spSet );
+
+	// runs sFunc( batch, scratch ) for every batch across the worker threads and waits for them all
+	void                       RunBatches( u32 sBatchCount, const std::function< void( u32, AnimScratch_t& ) >& srFunc );
+	void                       StartWorkers( u32 sCount );
+	void                       StopWorkers();
+	void                       WorkerThread( u32 sIndex, u32 sGeneration );
+
+	ResourceList< AnimSet_t* >                      aSets;
+	std::unordered_map< std::string, ch_handle_t > aSetPaths;
+
+	ResourceList< AnimPose_t* >                     aPoses;
+	std::vector< AnimPose_t* >                      aDirtyPoses;
+
+	// index 0 is the calling thread
+	std::vector< AnimScratch_t >                    aScratch;
+	std::vector< std::thread >                      aWorkers;
+
+	std::mutex                                      aWorkMutex;
+	std::condition_variable                         aWorkStart;
+	std::condition_variable                         aWorkDone;
+	const std::function< void( u32, AnimScratch_t& ) >* apWorkFunc = nullptr;
+	u32                                             aWorkGeneration = 0;
+	u32                                             aWorkBatchCount = 0;
+	std::atomic< u32 >                              aWorkNextBatch  = 0;
+	u32                                             aWorkersBusy    = 0;
+	bool                                            aWorkQuit       = false;
+};
+
+
+extern AnimationSystem* animation;
+
+
+// anim_gltf.cpp
+bool  Anim_LoadGltf( AnimSet_t* spSet, const std::string& srPath );
+
+// anim_clip.cpp
+void  Anim_CompressClip( AnimClip_t& srClip, const AnimRawClip_t& srRaw, const AnimSet_t* spSet );
+void  Anim_SampleClip( const AnimSet_t* spSet, const AnimClip_t& srClip, float sTime, bool sLoop, AnimPoseSoA_t& srOut );
+void  Anim_SetBindPose( const AnimSet_t* spSet, AnimPoseSoA_t& srOut );
+void  Anim_BuildBoneOrder( AnimSet_t* spSet );
+size_t Anim_GetClipSize( const AnimClip_t& srClip );
+
+// animation.cpp
+void  Anim_EvaluatePose( AnimPose_t* spPose, AnimScratch_t& srScratch );
@@ -1,4 +1,5 @@
 #include "audio.h"
+#include "audio_dsp.h"
 
 #include "codec_libav.h"
 #include "codec_vorbis.h"
@@ -17,16 +18,17 @@
 
 LOG_CHANNEL_REGISTER( Aduio, ELogColor_Green );
 
+static bool gArgNullDevice = args_register( "Don't open an audio output device, sounds are still mixed in real time", "--snd-null" );
+
 AudioSystem* audio = new AudioSystem;
 
 CONVAR_FLOAT( snd_volume, 0.5, CVARF_ARCHIVE, "Global Volume" );
 CONVAR_FLOAT( snd_volume_3d, 1, CVARF_ARCHIVE, "Volume for 3D Audio" );
 CONVAR_FLOAT( snd_volume_2d, 1, CVARF_ARCHIVE, "Volume for 2D Audio (No Spatial Audio Effects)" );
 
-CONVAR_INT( snd_buffer_size, 4096, "" );
+CONVAR_RANGE_INT( snd_mix_ahead, 2, 1, CH_MIX_RING_SIZE / CH_MIX_BLOCK_SIZE, CVARF_ARCHIVE, "Blocks of audio the mixer keeps ready for the output device, higher is safer but adds latency" );
 CONVAR_FLOAT( snd_read_mult, 4, "" );  // 4
 CONVAR_INT( snd_read_chunk_size, 1024, "" );
-CONVAR_INT( snd_audio_stream_available, FRAME_SIZE * 2, "" );
 
 CONVAR_FLOAT( snd_phonon_spatial_blend, 1.f, "" );
 CONVAR_INT( snd_phonon_lerp_type, 0, "" );
@@ -152,129 +154,95 @@ AudioSystem::~AudioSystem()
 {
 }
 
-#define AUDIO_THREAD 1
+bool AudioSystem::Init()
+{
+	Audio_InitDSP();
+
+	InitSteamAudio();
 
-#if AUDIO_THREAD
+	// Load built-in codecs
+	// these other 2 codecs don't work properly for some reason
+#if ENABLE_VORBIS
+	RegisterCodec( new CodecVorbis );
+#endif
 
-std::mutex g_audioMutex;
+#if ENABLE_WAV
+	RegisterCodec( new CodecWav );
+#endif
 
+	// experimental fallback, yet it works the best when actually playing sounds, smh
+#if ENABLE_LIBAV
+	RegisterCodec( new CodecLibAV );
 #endif
 
-bool AudioSystem::Init()
-{
+	// streamed sounds are decoded on here, even without an output device
+	StartDecodeThread();
+
 	SDL_AudioSpec wantedSpec;
 
-	wantedSpec.callback = NULL;
-	wantedSpec.userdata = NULL;
+	// the device pulls mixed audio from aOutputRing, see DeviceCallback
+	wantedSpec.callback = DeviceCallback;
+	wantedSpec.userdata = this;
 	wantedSpec.channels = 2;
 	wantedSpec.freq     = SOUND_RATE;
 	wantedSpec.samples  = FRAME_SIZE;
-	// aAudioSpec.samples = FRAME_SIZE / 2;
 	wantedSpec.silence  = 0;
 	wantedSpec.size     = 0;
 
 	wantedSpec.format   = AUDIO_F32;
-	// aAudioSpec.format = AUDIO_S16;
+
+	aAudioSpec          = wantedSpec;
+	aOutputDeviceID     = 0;
 
 	// TODO: be able to switch this on the fly
-	// aOutputDeviceID = SDL_OpenAudioDevice( NULL, 0, &aAudioSpec, NULL, 0 );
-	// aOutputDeviceID = SDL_OpenAudioDevice( NULL, 0, &aAudioSpec, NULL, SDL_AUDIO_ALLOW_ANY_CHANGE );
-	aOutputDeviceID     = SDL_OpenAudioDevice( NULL, 0, &wantedSpec, &aAudioSpec, SDL_AUDIO_ALLOW_ANY_CHANGE );
-	if ( aOutputDeviceID == 0 )
+	// only allow the buffer size to change, the mixer always outputs 48khz stereo float, so let SDL convert it if needed
+	if ( gArgNullDevice )
 	{
+		Log_Msg( gLC_Aduio, "Using null audio device\n" );
+	}
+	else
+	{
+		aOutputDeviceID = SDL_OpenAudioDevice( NULL, 0, &wantedSpec, &aAudioSpec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE );
+
 		// NOTE: technically this isn't a fatal error, and should be moved elsewhere so you can pick the output audio device while running
-		Log_MsgF( gLC_Aduio, "SDL_OpenAudioDevice failed: %s\n", SDL_GetError() );
-		return true;
+		if ( aOutputDeviceID == 0 )
+			Log_MsgF( gLC_Aduio, "SDL_OpenAudioDevice failed, using null audio device: %s\n", SDL_GetError() );
 	}
 
-	InitSteamAudio();
+	apMixerWake = SDL_CreateSemaphore( 0 );
+	StartMixerThread();
 
-	apMixBufferAudio.resize( CH_OUT_BUFFER_SIZE );
+	if ( aOutputDeviceID )
+		SDL_PauseAudioDevice( aOutputDeviceID, 0 );
+	else
+		StartNullDevice();
 
-	// Load built-in codecs
-	// these other 2 codecs don't work properly for some reason
-#if ENABLE_VORBIS
-	RegisterCodec( new CodecVorbis );
-#endif
+	return true;
+}
 
-#if ENABLE_WAV
-	RegisterCodec( new CodecWav );
-#endif
 
-	// experimental fallback, yet it works the best when actually playing sounds, smh
-#if ENABLE_LIBAV
-	RegisterCodec( new CodecLibAV );
-#endif
+void AudioSystem::Shutdown()
+{
+	if ( aOutputDeviceID )
+		SDL_PauseAudioDevice( aOutputDeviceID, 1 );
 
-	SDL_PauseAudioDevice( aOutputDeviceID, 0 );
-
-#if AUDIO_THREAD
-
-	std::thread* update = new std::thread(
-	  [ & ]()
-	  {
-		  while ( true )
-		  {
-			  PROF_SCOPE_NAMED( "Audio Update Thread" );
-
-			  if ( aPaused || aStreamsPlaying.size() == 0 )
-			  {
-				  SDL_Delay( 5 );
-				  continue;
-			  }
-			  else
-			  {
-				  sys_sleep( 0.5 );
-			  }
-
-			  // TODO: use this for functions to modify how the stream is played during playback
-			  // std::unique_lock<std::mutex> lock(g_audioMutex);
-
-			  int        remainingAudio = SDL_GetQueuedAudioSize( aOutputDeviceID );
-			  static int read           = remainingAudio;
-
-			  if ( remainingAudio < snd_buffer_size )
-			  {
-				  // this might work well for multithreading
-				  for ( int i = 0; i < aStreamsPlaying.size(); i++ )
-				  {
-					  AudioStream* stream = nullptr;
-					  if ( !aStreams.Get( aStreamsPlaying[ i ], &stream ) )
-					  {
-						  Log_Error( "Failed to get stream that's currently playing\n" );
-						  FreeSound( aStreamsPlaying[ i ] );
-						  vec_remove_index( aStreamsPlaying, i );
-						  i--;
-						  continue;
-					  }
-
-					  if ( stream->paused )
-						  continue;
-
-					  if ( !UpdateStream( stream ) )
-					  {
-						  FreeSound( aStreamsPlaying[ i ] );
-						  i--;
-						  continue;
-					  }
-				  }
-			  }
-
-			  if ( aStreamsPlaying.size() )
-			  {
-				  MixAudio();
-				  QueueAudio();
-
-				  aUnmixedBuffers.clear();
-			  }
-
-			  // g_cv.notify_one();
-		  }
-	  } );
+	StopNullDevice();
+	StopMixerThread();
+	StopDecodeThread();
 
-#endif
+	if ( aOutputDeviceID )
+	{
+		SDL_CloseAudioDevice( aOutputDeviceID );
+		aOutputDeviceID = 0;
+	}
 
-	return true;
+	if ( apMixerWake )
+	{
+		SDL_DestroySemaphore( apMixerWake );
+		apMixerWake = nullptr;
+	}
+
+	ClearSoundCache();
 }
 
 
@@ -326,8 +294,8 @@ bool AudioSystem::InitSteamAudio()
 	if ( !HandleIPLErr( ret, "Error creating HTRF" ) )
 		return false;
 
-	ret = iplAudioBufferAllocate( aCtx, 2, CH_OUT_BUFFER_SIZE, &aMixBuffer );
-	if ( !HandleIPLErr( ret, "Error creating steam audio context" ) )
+	ret = iplAudioBufferAllocate( aCtx, 2, FRAME_SIZE, &aMixBuffer );
+	if ( !HandleIPLErr( ret, "Error creating mix buffer" ) )
 		return false;
 
 	IPLDirectEffectSettings directSettings{};
@@ -356,6 +324,8 @@ ch_handle_t AudioSystem::OpenSound( std::string_view sSoundPath )
 		return nullptr;
 	}*/
 
+	ProcessMixerEvents();
+
 	ch_string_auto soundPathAbs = FileSys_FindFile( sSoundPath.data(), sSoundPath.size() );
 
 	if ( !soundPathAbs.data )
@@ -375,15 +345,14 @@ ch_handle_t AudioSystem::OpenSound( std::string_view sSoundPath )
 		if ( !codec->CheckExt( ext.data ) )
 			continue;
 
-		if ( !codec->Open( soundPathAbs.data, stream ) )
+		// short sounds are shared from the sound cache, long ones are streamed
+		if ( !OpenStreamData( stream, codec, soundPathAbs.data ) )
 			continue;
 
-		stream->codec = codec;
-
 		if ( !( stream->valid = LoadSoundInternal( stream ) ) )
 		{
 			Log_ErrorF( gLC_Aduio, "Could not load sound: \"%s\"\n", sSoundPath.data() );
-			delete stream;
+			DestroyStream( stream );
 			return CH_INVALID_HANDLE;
 		}
 		else
@@ -404,6 +373,12 @@ void AudioSystem::SetListenerTransform( const glm::vec3& pos, const glm::vec3& a
 	aListenerPos = pos;
 	aListenerRot = glm::radians( ang );
 	aListenerAng = ang;
+
+	AudioCmd cmd{};
+	cmd.type        = EAudioCmd_SetListener;
+	cmd.listenerPos = aListenerPos;
+	cmd.listenerRot = aListenerRot;
+	PushCommand( cmd );
 }
 
 
@@ -415,7 +390,15 @@ void AudioSystem::SetListenerVelocity( const glm::vec3& vel )
 
 void AudioSystem::SetPaused( bool paused )
 {
+	if ( aPaused == paused )
+		return;
+
 	aPaused = paused;
+
+	AudioCmd cmd{};
+	cmd.type   = EAudioCmd_SetPaused;
+	cmd.paused = paused;
+	PushCommand( cmd );
 }
 
 
@@ -438,111 +421,8 @@ IAudioOccluder* AudioSystem::GetOccluder()
 
 void AudioSystem::Update( float frameTime )
 {
-}
-
-
-bool AudioSystem::ApplyEffects( AudioStream* stream )
-{
-	// this is in bytes, not samples!
-	ChVector< float > outAudio;
-	outAudio.resize( CH_OUT_BUFFER_SIZE );
-
-	// wtf is this doing
-	int read = SDL_AudioStreamGet( stream->audioStream, outAudio.data(), outAudio.size() );
-
-	if ( read == -1 )
-	{
-		Log_ErrorF( gLC_Aduio, "SDL_AudioStreamGet - Failed to get converted data: %s\n", SDL_GetError() );
-		return false;
-	}
-
-	// no audio data available
-	if ( read == 0 )
-		return false;
-
-	if ( read < outAudio.size() )
-	{
-		// add 0's to it so steam audio is happy
-		for ( size_t i = read; i < outAudio.size(); i++ )
-		{
-			outAudio[ i ] = 0.f;
-		}
-	}
-
-	// apply stream volume
-	for ( int i = 0; i < read; i++ )
-		outAudio[ i ] *= stream->vol;
-
-	SDL_memset( stream->outBuffer.data[ 0 ], 0, outAudio.size() / 2 );
-	SDL_memset( stream->outBuffer.data[ 1 ], 0, outAudio.size() / 2 );
-
-	// TODO: split these effects up
-	if ( stream->aEffects & AudioEffect_World )
-	{
-		ApplySpatialEffects( stream, outAudio.data(), outAudio.size() );
-	}
-	else
-	{
-		for ( uint32_t i = 0, j = 0; i < outAudio.size() / 2; i++ )
-		{
-			for ( uint32_t ch = 0; ch < 2; ch++ )
-			{
-				stream->outBuffer.data[ ch ][ i ] = outAudio[ j++ ] * snd_volume_2d;
-			}
-		}
-	}
-
-	aUnmixedBuffers.push_back( stream->outBuffer );
-
-	stream->frame += read;
-
-	return true;
-}
-
-
-bool AudioSystem::MixAudio()
-{
-	if ( !aUnmixedBuffers.size() )
-		return true;
-
-	// clear the mix buffer of previous audio data first
-	SDL_memset( aMixBuffer.data[ 0 ], 0, CH_OUT_BUFFER_SIZE / 2 );
-	SDL_memset( aMixBuffer.data[ 1 ], 0, CH_OUT_BUFFER_SIZE / 2 );
-
-	for ( IPLAudioBuffer& buffer : aUnmixedBuffers )
-		iplAudioBufferMix( aCtx, &buffer, &aMixBuffer );
-
-	return true;
-}
-
-
-bool AudioSystem::QueueAudio()
-{
-	if ( !aUnmixedBuffers.size() )
-		return true;
-
-	// iplAudioBufferInterleave( aCtx, &aMixBuffer, apMixBufferAudio );
-
-	apMixBufferAudio.resize( aMixBuffer.numSamples );
-
-	// interleave manually so we can control global audio volume
-	// unless we can set volume on the output device without changing it on the system
-	for ( uint32_t i = 0, j = 0; i < apMixBufferAudio.size() / 2; i++ )
-	{
-		for ( uint32_t ch = 0; ch < 2; ch++ )
-		{
-			// apMixBufferAudio[j++] = unmixedBuffers[0].data[ch][i] * snd_volume;
-			apMixBufferAudio[ j++ ] = aMixBuffer.data[ ch ][ i ] * snd_volume;
-		}
-	}
-
-	if ( SDL_QueueAudio( aOutputDeviceID, apMixBufferAudio.data(), apMixBufferAudio.size() ) == -1 )
-	{
-		Log_ErrorF( gLC_Aduio, "SDL_QueueAudio Error: %s\n", SDL_GetError() );
-		return false;
-	}
-
-	return true;
+	// free any streams the mixer is done with
+	ProcessMixerEvents();
 }
 
 
@@ -565,77 +445,69 @@ static float CalculateDistanceAttenutation( const glm::vec3& listener, const glm
 }
 
 
-int AudioSystem::ApplySpatialEffects( AudioStream* stream, float* data, size_t frameCount )
+bool AudioSystem::ApplyEffects( AudioVoice& srVoice, u32 sRead )
 {
-	glm::vec3      worldPos      = stream->GetVec3( EAudio_World_Pos );
-	float          worldDistance = stream->GetFloat( EAudio_World_Radius );
-	float          worldFalloff  = stream->GetFloat( EAudio_World_Falloff );
+	AudioStream* stream   = srVoice.stream;
+	float*       outAudio = stream->mixInput.data();
 
-	IPLVector3     direction     = ToPhonon( aListenerRot * glm::normalize( worldPos - aListenerPos ) );
-	IPLfloat32     distanceAtten = CalculateDistanceAttenutation( aListenerPos, worldPos, worldDistance, worldFalloff );
+	// nothing to mix this block, ReadAudio decides when the voice is finished
+	if ( sRead == 0 )
+		return true;
 
-	if ( distanceAtten == 0.f )
-		return 0;
+	// mixInput is always interleaved stereo, sRead is in samples
+	stream->frame += sRead / 2;
 
-	IPLerror       err = IPL_STATUS_SUCCESS;
+	float distanceAtten = 1.f;
+	if ( srVoice.params.effects & AudioEffect_World )
+		distanceAtten = CalculateDistanceAttenutation( aMixListenerPos, srVoice.params.worldPos, srVoice.params.worldRadius, srVoice.params.worldFalloff );
 
-	// TODO ONCE WORKING: don't allocate and free multiple times an audio update
-	// probably move this to an effect class or some job class thing, idk
-	// and then just store it in a memory pool, and then just use memset on it to clear it if needed
-	IPLAudioBuffer tempInBuffer{};
-	IPLAudioBuffer tempMidBuffer{};
-	IPLAudioBuffer tempOutBuffer{};
+	// voice virtualization: we already pulled this block from the stream so it stays in sync,
+	// but there's no point in running any DSP on something you can't hear
+	srVoice.virtualized = distanceAtten <= 0.f || srVoice.params.vol <= 0.f;
+	if ( srVoice.virtualized )
+		return true;
 
-	err = iplAudioBufferAllocate( aCtx, 2, frameCount, &tempInBuffer );
+	// add 0's to it so steam audio is happy
+	if ( sRead < CH_MIX_BLOCK_SIZE )
+		memset( &outAudio[ sRead ], 0, ( CH_MIX_BLOCK_SIZE - sRead ) * sizeof( float ) );
 
-	if ( CH_IF_ASSERT( err == IPL_STATUS_SUCCESS ) )
+	// TODO: split these effects up
+	if ( srVoice.params.effects & AudioEffect_World )
 	{
-		Log_Error( gLC_Aduio, "Failed to allocate input phonon buffer\n" );
-		return 0;
-	}
+		ApplySpatialEffects( srVoice, outAudio, distanceAtten );
 
-	err = iplAudioBufferAllocate( aCtx, 2, frameCount, &tempMidBuffer );
-
-	if ( CH_IF_ASSERT( err == IPL_STATUS_SUCCESS ) )
+		Audio_MixGain( aMixBuffer.data[ 0 ], stream->outBuffer.data[ 0 ], FRAME_SIZE, snd_volume_3d );
+		Audio_MixGain( aMixBuffer.data[ 1 ], stream->outBuffer.data[ 1 ], FRAME_SIZE, snd_volume_3d );
+	}
+	else
 	{
-		iplAudioBufferFree( aCtx, &tempInBuffer );
-		Log_Error( gLC_Aduio, "Failed to allocate mid phonon buffer\n" );
-		return 0;
+		// 2D audio goes straight into the mix buffer
+		Audio_DeinterleaveMix( outAudio, aMixBuffer.data[ 0 ], aMixBuffer.data[ 1 ], FRAME_SIZE, srVoice.params.vol * snd_volume_2d );
 	}
 
-	err = iplAudioBufferAllocate( aCtx, 2, frameCount, &tempOutBuffer );
+	return true;
+}
 
-	if ( CH_IF_ASSERT( err == IPL_STATUS_SUCCESS ) )
-	{
-		iplAudioBufferFree( aCtx, &tempInBuffer );
-		iplAudioBufferFree( aCtx, &tempMidBuffer );
-		Log_Error( gLC_Aduio, "Failed to allocate output phonon buffer\n" );
-		return 0;
-	}
 
-	// copy over samples
-	for ( uint32_t i = 0, j = 0; i < frameCount / 2; i++ )
-	{
-		for ( uint32_t ch = 0; ch < 2; ch++ )
-		{
-			tempInBuffer.data[ ch ][ i ] = data[ j++ ];
+void AudioSystem::ApplySpatialEffects( AudioVoice& srVoice, float* data, float sDistanceAtten )
+{
+	AudioStream* stream   = srVoice.stream;
+	glm::vec3    worldPos = srVoice.params.worldPos;
 
-			CH_ASSERT( tempInBuffer.data[ ch ][ i ] < 1 );
-			CH_ASSERT( tempInBuffer.data[ ch ][ i ] > -1 );
-		}
-	}
+	IPLVector3   direction = ToPhonon( aMixListenerRot * glm::normalize( worldPos - aMixListenerPos ) );
+
+	// stream volume is applied here so the effects get it for free
+	Audio_Deinterleave( data, stream->spatialIn.data[ 0 ], stream->spatialIn.data[ 1 ], FRAME_SIZE, srVoice.params.vol );
 
 	IPLDirectEffectParams directParams{};
 
 	// one day we can add IPL_DIRECTEFFECTFLAGS_APPLYOCCLUSION
-	directParams.flags = (IPLDirectEffectFlags)( IPL_DIRECTEFFECTFLAGS_APPLYDISTANCEATTENUATION | IPL_DIRECTEFFECTFLAGS_APPLYDIRECTIVITY );
-	
-	directParams.distanceAttenuation = distanceAtten;
-	directParams.directivity         = snd_phonon_directivity;
+	directParams.flags               = (IPLDirectEffectFlags)( IPL_DIRECTEFFECTFLAGS_APPLYDISTANCEATTENUATION | IPL_DIRECTEFFECTFLAGS_APPLYDIRECTIVITY );
 
-	CH_ASSERT( _heapchk() == _HEAPOK );
+	directParams.distanceAttenuation = sDistanceAtten;
+	directParams.directivity         = snd_phonon_directivity;
 
-	iplDirectEffectApply( apDirectEffect, &directParams, &tempInBuffer, &tempMidBuffer );
+	iplDirectEffectApply( apDirectEffect, &directParams, &stream->spatialIn, &stream->spatialMid );
 
 	IPLBinauralEffectParams binauralParams{};
 	binauralParams.direction     = direction;
@@ -643,33 +515,7 @@ int AudioSystem::ApplySpatialEffects( AudioStream* stream, float* data, size_t f
 	binauralParams.spatialBlend  = snd_phonon_spatial_blend;
 	binauralParams.hrtf          = gpHrtf;
 
-	iplBinauralEffectApply( apBinauralEffect, &binauralParams, &tempMidBuffer, &tempOutBuffer );
-
-	CH_ASSERT( _heapchk() == _HEAPOK );
-
-	for ( uint32_t i = 0; i < frameCount / 2; i++ )
-	{
-		for ( uint32_t ch = 0; ch < 2; ch++ )
-		{
-			stream->outBuffer.data[ ch ][ i ] = tempOutBuffer.data[ ch ][ i ] * snd_volume_3d;
-		}
-	}
-
-	CH_ASSERT( _heapchk() == _HEAPOK );
-
-	iplAudioBufferFree( aCtx, &tempInBuffer );
-
-	CH_ASSERT( _heapchk() == _HEAPOK );
-
-	iplAudioBufferFree( aCtx, &tempMidBuffer );
-
-	CH_ASSERT( _heapchk() == _HEAPOK );
-
-	iplAudioBufferFree( aCtx, &tempOutBuffer );
-
-	CH_ASSERT( _heapchk() == _HEAPOK );
-
-	return 0;
+	iplBinauralEffectApply( apBinauralEffect, &binauralParams, &stream->spatialMid, &stream->outBuffer );
 }
 
 // -------------------------------------------------------------------------------------
@@ -738,6 +584,14 @@ void AudioSystem::SetChannelVolume( ch_handle_t handle, float vol )
 		return;
 
 	channel->aVol = vol;
+
+	// the mixer gets the channel volume baked into the voice volume
+	for ( ch_handle_t streamHandle : aStreamsPlaying )
+	{
+		AudioStream* stream = GetStream( streamHandle );
+		if ( stream && stream->channel == handle )
+			SyncVoiceParams( streamHandle, stream );
+	}
 }
 
 
@@ -758,6 +612,13 @@ void AudioSystem::SetChannelPaused( ch_handle_t handle, bool sPaused )
 		return;
 
 	channel->aPaused = sPaused;
+
+	for ( ch_handle_t streamHandle : aStreamsPlaying )
+	{
+		AudioStream* stream = GetStream( streamHandle );
+		if ( stream && stream->channel == handle )
+			SyncVoiceParams( streamHandle, stream );
+	}
 }
 
 
@@ -809,6 +670,8 @@ void AudioSystem::AddEffects( ch_handle_t sHandle, AudioEffect sEffects )
 		stream->CreateVar( EAudio_Loop_StartTime, 0.f );
 		stream->CreateVar( EAudio_Loop_EndTime, -1.f );
 	}
+
+	SyncVoiceParams( sHandle, stream );
 }
 
 
@@ -840,6 +703,8 @@ void AudioSystem::RemoveEffects( ch_handle_t sHandle, AudioEffect sEffects )
 		stream->RemoveVar( EAudio_Loop_StartTime );
 		stream->RemoveVar( EAudio_Loop_EndTime );
 	}
+
+	SyncVoiceParams( sHandle, stream );
 }
 
 
@@ -866,6 +731,7 @@ bool AudioSystem::SetEffectData( ch_handle_t handle, EAudioEffectData sDataType,
 		return false;
 
 	stream->SetVar( sDataType, data );
+	SyncVoiceParams( handle, stream );
 	return true;
 }
 
@@ -877,6 +743,7 @@ bool AudioSystem::SetEffectData( ch_handle_t handle, EAudioEffectData sDataType,
 		return false;
 
 	stream->SetVar( sDataType, data );
+	SyncVoiceParams( handle, stream );
 	return true;
 }
 
@@ -888,6 +755,7 @@ bool AudioSystem::SetEffectData( ch_handle_t handle, EAudioEffectData sDataType,
 		return false;
 
 	stream->SetVar( sDataType, data );
+	SyncVoiceParams( handle, stream );
 	return true;
 }
 
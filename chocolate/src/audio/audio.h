@@ -1,9 +1,14 @@
 #pragma once
 
 #include "iaudio.h"
+#include "core/ring_buffer.hpp"
 
 #include <SDL2/SDL.h>
 #include <phonon.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 LOG_CHANNEL( Aduio );
 
@@ -12,11 +17,27 @@ constexpr size_t SOUND_RATE         = 48000;
 constexpr size_t MAX_STREAMS        = 32;
 constexpr size_t CH_OUT_BUFFER_SIZE = 2048;
 
+// interleaved stereo samples in one block of mixed audio
+constexpr u32    CH_MIX_BLOCK_SIZE  = FRAME_SIZE * 2;
+
+// max amount of voices the mixer can play at once
+constexpr u32    CH_MAX_VOICES      = 256;
+
+// samples between the mixer thread and the output device
+constexpr u32    CH_MIX_RING_SIZE   = 8192;
+
+constexpr u32    CH_AUDIO_CMD_COUNT = 1024;
+
+// samples of converted audio the decode worker keeps ready for each streamed sound, ~340ms
+constexpr u32    CH_STREAM_RING_SIZE = 32768;
+
 extern ch_handle_t    gDefaultChannel;
 
 bool             HandleIPLErr( IPLerror ret, const char* msg );
 
 class IAudioCodec;
+struct AudioCachedSound;
+struct AudioStreamRing;
 
 
 // ===========================================================================
@@ -118,6 +139,7 @@ struct AudioStream
 	SDL_AudioFormat      format = AUDIO_F32;
 	unsigned int         size;
 	unsigned int         samples;
+	size_t               totalFrames = 0;  // length of the file in frames at it's own rate, 0 if the codec doesn't know
 	unsigned int         bits;
 	unsigned char        width;  // ???
 
@@ -126,21 +148,39 @@ struct AudioStream
 
 	bool                 paused      = false;
 	bool                 valid       = false;
-	bool                 preloaded   = false;  // hmm
 	float                vol         = 1.f;
 
 	// Audio Playback Channel
 	ch_handle_t               channel    = gDefaultChannel;
 
-	// audio stream to store audio from the codec and covert it
+	// A sound is either fully decoded in the sound cache, or streamed from the codec by the decode worker
+
+	// decoded sound shared with every other stream of this file, and where the mixer is reading it from
+	AudioCachedSound*    cache       = nullptr;
+	u32                  cachePos    = 0;
+
+	// converted audio decoded ahead of time by the decode worker
+	AudioStreamRing*     ring        = nullptr;
+
+	// audio stream to store audio from the codec and covert it, only used for streamed sounds
 	SDL_AudioStream*     audioStream = nullptr;
 
-	// stored audio data
-	std::vector< float > preloadedAudio;
+	// codec read buffer, only touched by the decode worker while the sound is playing
+	ChVector< float >    readBuffer;
+
+	// scratch buffer used by the mixer, allocated once when the sound is loaded
+	ChVector< float >    mixInput;
+
+	// spatial effect input and intermediate buffers, allocated with the stream so the mixer never has to
+	IPLAudioBuffer       spatialIn{};
+	IPLAudioBuffer       spatialMid{};
 
 	// Final output audio
 	IPLAudioBuffer       outBuffer{};
 
+	// set by the game thread while the mixer owns this stream, cleared when the mixer releases it
+	bool                 playing     = false;
+
 	// ============================================================
 	// Audio Effects - must be set before playing a sound
 
@@ -201,6 +241,110 @@ class IAudioCodec
 };
 
 
+// ===========================================================================
+// Sound Cache and Streaming - audio_cache.cpp
+
+
+// A fully decoded sound, already converted to what the mixer wants (interleaved stereo float at SOUND_RATE)
+// Shared between every stream of the same file, only touched by the game thread besides reading data
+struct AudioCachedSound
+{
+	std::string       name;
+	ChVector< float > data;
+	u32               frames   = 0;
+	u32               refCount = 0;  // streams using this, it can only be evicted at 0
+	u64               lastUsed = 0;
+};
+
+
+// Converted audio for a streamed sound, the decode worker is the producer and the mixer is the consumer
+struct AudioStreamRing
+{
+	ch_spsc_queue< float, CH_STREAM_RING_SIZE > ring;
+
+	// the worker has put everything from the codec into the ring
+	std::atomic< bool >   eof           = false;
+
+	// copied from the voice params by the mixer
+	std::atomic< bool >   loop          = false;
+	std::atomic< float >  loopStart     = 0.f;
+
+	// the mixer bumps seekRequest, then once the worker sets seekDone to match,
+	// it throws out everything that was written to the ring before seekTail
+	std::atomic< double > seekPos       = 0.0;
+	std::atomic< u32 >    seekRequest   = 0;
+	std::atomic< u32 >    seekDone      = 0;
+	std::atomic< u32 >    seekTail      = 0;
+
+	// only touched by the worker
+	u32                   seekHandled   = 0;
+	bool                  codecEOF      = false;
+};
+
+
+// ===========================================================================
+// Mixer
+
+
+// Snapshot of everything the mixer needs from an AudioStream
+// The game thread owns the AudioStream vars, and sends a copy of this whenever they change
+struct AudioVoiceParams
+{
+	glm::vec3   worldPos;
+	float       worldRadius;
+	float       worldFalloff;
+	float       vol;
+	float       loopStart;
+	AudioEffect effects;
+	bool        loop;
+	bool        paused;
+};
+
+
+// A stream that is currently being mixed, only touched by the mixer thread
+struct AudioVoice
+{
+	ch_handle_t      handle;
+	AudioStream*     stream;
+	AudioVoiceParams params;
+	bool             seeking;      // waiting on the decode worker to seek a streamed sound
+	bool             virtualized;  // inaudible, still consumes audio to stay in sync, but skips all DSP
+};
+
+
+enum EAudioCmd : u8
+{
+	EAudioCmd_Play,         // start mixing a stream
+	EAudioCmd_Stop,         // stop mixing a stream, the mixer hands it back with an AudioMixerEvent
+	EAudioCmd_SetParams,
+	EAudioCmd_Seek,
+	EAudioCmd_SetListener,
+	EAudioCmd_SetPaused,
+};
+
+
+// Game thread -> Mixer
+struct AudioCmd
+{
+	EAudioCmd        type;
+	bool             paused;
+	ch_handle_t      handle;
+	AudioStream*     stream;
+	AudioVoiceParams params;
+	glm::vec3        listenerPos;
+	glm::quat        listenerRot;
+	double           seekPos;
+};
+
+
+// Mixer -> Game thread, the mixer is finished with this stream and it can be freed
+struct AudioMixerEvent
+{
+	ch_handle_t  handle;
+	AudioStream* stream;
+};
+
+
 // ===========================================================================
 // Audio System
 
@@ -330,6 +474,23 @@ class AudioSystem : public IAudioSystem
 	bool                          GetEffectData( ch_handle_t stream, EAudioEffectData sDataType, float& data ) override;
 	bool                          GetEffectData( ch_handle_t stream, EAudioEffectData sDataType, glm::vec3& data ) override;
 
+	// -------------------------------------------------------------------------------------
+	// Offline Rendering - audio_offline.cpp
+	// -------------------------------------------------------------------------------------
+
+	bool                          BeginOfflineRender() override;
+	void                          EndOfflineRender() override;
+	u32                           RenderOffline( float* spOutput, u32 sFrames ) override;
+	double                        GetMixTime() override;
+
+	// Open a sound that plays a sine wave instead of a file, see CodecTone
+	ch_handle_t                   OpenTone( float sFreq );
+
+	// Put playing voices aside so only sounds started after this are mixed, must be rendering offline
+	// Restoring them stops anything that was started in between
+	void                          IsolateVoices();
+	void                          RestoreVoices();
+
 	// -------------------------------------------------------------------------------------
 	// Internal Functions
 	// -------------------------------------------------------------------------------------
@@ -341,16 +502,73 @@ class AudioSystem : public IAudioSystem
 
 	bool                          RegisterCodec( IAudioCodec* codec );
 
-	bool                          UpdateStream( AudioStream* stream );
-	bool                          ReadAudio( AudioStream* stream );
-	bool                          ApplyEffects( AudioStream* stream );
-	bool                          MixAudio();
-	bool                          QueueAudio();
+	bool                          ReadAudio( AudioVoice& srVoice, u32& srRead );
+	bool                          ApplyEffects( AudioVoice& srVoice, u32 sRead );
 
 	bool                          InitSteamAudio();
-	int                           ApplySpatialEffects( AudioStream* stream, float* data, size_t frameSize );
+	void                          ApplySpatialEffects( AudioVoice& srVoice, float* data, float sDistanceAtten );
+
+	// -------------------------------------------------------------------------------------
+	// Sound Cache and Streaming - audio_cache.cpp
+	// -------------------------------------------------------------------------------------
+
+	// Use a cached copy of this sound if we have one, otherwise open it with this codec and decide whether to cache or stream it
+	bool                          OpenStreamData( AudioStream* stream, IAudioCodec* codec, const char* spPath );
+
+	AudioCachedSound*             FindCachedSound( const std::string& srName );
+	void                          AcquireCachedSound( AudioStream* stream, AudioCachedSound* spCached );
+	void                          ReleaseCachedSound( AudioStream* stream );
+
+	// Decode an entire sound into the cache and stop streaming it
+	bool                          CacheSound( AudioStream* stream );
+
+	// Evict unused sounds until the cache is under snd_cache_budget
+	void                          TrimSoundCache();
+	void                          ClearSoundCache();
+
+	// Decode a streamed sound until it's ring has sTarget samples in it, or the codec runs out
+	void                          FillStreamRing( AudioStream* stream, u32 sTarget );
+
+	// Prefill a streamed sound and hand it to the decode worker
+	void                          StartStreaming( AudioStream* stream );
+	void                          StopStreaming( AudioStream* stream );
+
+	void                          StartDecodeThread();
+	void                          StopDecodeThread();
+	void                          DecodeThread();
+
+	// -------------------------------------------------------------------------------------
+	// Mixer Functions - audio_mixer.cpp
+	// -------------------------------------------------------------------------------------
+
+	// Game Thread
+	bool                          PushCommand( const AudioCmd& srCmd );
+	void                          ProcessMixerEvents();
+	void                          BuildVoiceParams( AudioStream* stream, AudioVoiceParams& srParams );
+	void                          SyncVoiceParams( ch_handle_t sHandle, AudioStream* stream );
+	void                          DestroyStream( AudioStream* stream );
+
+	void                          StartMixerThread();
+	void                          StopMixerThread();
+
+	// Mixer Thread
+	void                          MixerThread();
+	void                          ProcessCommands();
+	void                          MixBlock( float* spOutput );
+	bool                          MixVoice( AudioVoice& srVoice );
+	void                          StopVoice( u32 sIndex );
+	AudioVoice*                   FindVoice( ch_handle_t sHandle );
+
+	// Device Thread
+	static void SDLCALL           DeviceCallback( void* spUserData, Uint8* spStream, int sLen );
+
+	// Null Device, pulls audio in real time and throws it away, used when there's no output device
+	void                          StartNullDevice();
+	void                          StopNullDevice();
+	void                          NullDeviceThread();
 
 	virtual bool                  Init() override;
+	virtual void                  Shutdown() override;
 	virtual void                  Update( float frameTime ) override;
 
 	// -------------------------------------------------------------------------------------
@@ -371,19 +589,17 @@ class AudioSystem : public IAudioSystem
 	//IPLhandle                       envRenderer = {};
 	//IPLhandle                       renderer = {};
 
-	// memory buffer for phonon rendering final mix
-	ChVector< float >             apMixBufferAudio;
-	// IPLAudioBuffer                  mixBufferContext;
+	// phonon buffer for the final mix of one block
 	IPLAudioBuffer                aMixBuffer;
-	std::vector< IPLAudioBuffer > aUnmixedBuffers;
 
 	// -------------------------------------------------------------------------------------
 
 	std::vector< IAudioCodec* >   aCodecs;
 	IAudioOccluder*               apOccluder = nullptr;
 
+	// only touched by the game thread
 	ResourceList< AudioStream* >  aStreams;         // all streams loaded into memory
-	std::vector< ch_handle_t >         aStreamsPlaying;  // streams currently playing audio for
+	std::vector< ch_handle_t >         aStreamsPlaying;  // streams handed to the mixer
 
 	ResourceList< AudioChannel* > aChannels;
 
@@ -397,4 +613,75 @@ class AudioSystem : public IAudioSystem
 
 	bool                          aPaused      = false;
 	float                         aSpeed       = 1.f;
+
+	// -------------------------------------------------------------------------------------
+	// Mixer State - only touched by the mixer thread
+
+	AudioVoice                    aVoices[ CH_MAX_VOICES ];
+	u32                           aVoiceCount      = 0;
+
+	glm::vec3                     aMixListenerPos  = {};
+	glm::quat                     aMixListenerRot  = {};
+	bool                          aMixPaused       = false;
+
+	// -------------------------------------------------------------------------------------
+	// Offline Rendering - the mixer thread is stopped, and the game thread mixes instead
+
+	bool                          aOfflineRender   = false;
+	float                         aOfflineBlock[ CH_MIX_BLOCK_SIZE ];
+	u32                           aOfflineBlockPos = CH_MIX_BLOCK_SIZE;  // samples already copied out of aOfflineBlock
+
+	std::vector< AudioVoice >     aIsolatedVoices;
+	bool                          aIsolatedPaused  = false;
+
+	// -------------------------------------------------------------------------------------
+	// Sound Cache - only touched by the game thread
+
+	std::unordered_map< std::string, AudioCachedSound* > aSoundCache;
+	size_t                        aSoundCacheSize  = 0;  // bytes
+	u64                           aSoundCacheTick  = 0;
+
+	// -------------------------------------------------------------------------------------
+	// Decode Worker
+
+	std::thread*                  apDecodeThread   = nullptr;
+	SDL_sem*                      apDecodeWake     = nullptr;
+	std::atomic< bool >           aDecodeRunning   = false;
+
+	// streamed sounds that are playing, the worker decodes a copy of this list without the lock held
+	std::mutex                    aDecodeMutex;
+	std::condition_variable       aDecodeDone;  // signaled when the worker finishes decoding a stream
+	std::vector< AudioStream* >   aDecodeStreams;
+	AudioStream*                  apDecoding       = nullptr;  // the stream being decoded right now, guarded by aDecodeMutex
+
+	// times the mixer ran out of audio from a streamed sound
+	std::atomic< u32 >            aStreamStarves   = 0;
+
+	// -------------------------------------------------------------------------------------
+	// Thread Communication
+
+	ch_mpsc_queue< AudioCmd, CH_AUDIO_CMD_COUNT >        aCommands;
+	ch_spsc_queue< AudioMixerEvent, CH_AUDIO_CMD_COUNT > aMixerEvents;
+	ch_spsc_queue< float, CH_MIX_RING_SIZE >             aOutputRing;
+
+	std::thread*                  apMixerThread    = nullptr;
+	SDL_sem*                      apMixerWake      = nullptr;
+	std::atomic< bool >           aMixerRunning    = false;
+	std::atomic< u32 >            aUnderruns       = 0;
+	std::atomic< u32 >            aVirtualVoices   = 0;
+
+	// the mixer can't log, so it counts these and the game thread reports them in ProcessMixerEvents
+	std::atomic< u32 >            aDroppedVoices   = 0;  // sounds not played because every voice was in use
+	std::atomic< u32 >            aLeakedStreams   = 0;  // streams the mixer couldn't hand back, this shouldn't happen
+	u32                           aReportedDropped = 0;
+	u32                           aReportedLeaked  = 0;
+
+	// frames mixed since startup, this is the mixer clock
+	std::atomic< u64 >            aMixFrames       = 0;
+
+	std::thread*                  apNullDevice     = nullptr;
+	std::atomic< bool >           aNullDeviceRunning = false;
 };
+
+
+extern AudioSystem* audio;
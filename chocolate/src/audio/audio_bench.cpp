@@ -0,0 +1,118 @@
+#include "audio.h"
+#include "audio_dsp.h"
+#include "codec_tone.h"
+
+#include <chrono>
+
+
+// Mixes a bunch of tone generator voices on the calling thread with no output device, and reports the CPU time per block
+// This renders offline, any sounds already playing are put back afterwards
+static void Audio_BenchMix( u32 sVoiceCount, u32 sBlockCount )
+{
+	if ( !audio->BeginOfflineRender() )
+		return;
+
+	audio->IsolateVoices();
+
+	CodecTone* codec   = Audio_GetToneCodec();
+	u32        seed    = 1234;
+
+	auto       randf   = [ &seed ]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return ( seed >> 8 ) / float( 1 << 24 );
+	};
+
+	for ( u32 i = 0; i < sVoiceCount; i++ )
+	{
+		char freq[ 16 ];
+		snprintf( freq, sizeof( freq ), "%d", 220 + ( i % 32 ) * 20 );
+
+		// voices with the same frequency share the same cached sound
+		AudioStream* stream = new AudioStream;
+		stream->name        = std::string( "bench_tone_" ) + freq;
+
+		if ( !audio->OpenStreamData( stream, codec, freq ) || !( stream->valid = audio->LoadSoundInternal( stream ) ) )
+		{
+			audio->DestroyStream( stream );
+			continue;
+		}
+
+		AudioVoice& voice         = audio->aVoices[ audio->aVoiceCount++ ];
+		voice                     = {};
+		voice.handle              = CH_INVALID_HANDLE;
+		voice.stream              = stream;
+		voice.params.vol          = 1.f;
+		voice.params.effects      = AudioEffect_Loop;
+		voice.params.loop         = true;
+
+		// most voices are in the world, and some are placed out of range to test voice virtualization
+		if ( i % 4 != 0 )
+		{
+			float radius              = 1000.f;
+			float dist                = randf() * radius * 1.25f;
+			float angle               = randf() * 2.f * M_PI;
+
+			voice.params.effects      = AudioEffect_World | AudioEffect_Loop;
+			voice.params.worldRadius  = radius;
+			voice.params.worldFalloff = 1.f;
+			voice.params.worldPos     = audio->aMixListenerPos + glm::vec3( cosf( angle ) * dist, sinf( angle ) * dist, 0.f );
+		}
+	}
+
+	float block[ CH_MIX_BLOCK_SIZE ];
+
+	// warm up so we don't measure the first few blocks touching the cached sounds
+	for ( u32 i = 0; i < 8; i++ )
+		audio->MixBlock( block );
+
+	double minTime   = DBL_MAX;
+	double maxTime   = 0.0;
+	double totalTime = 0.0;
+
+	for ( u32 i = 0; i < sBlockCount; i++ )
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		audio->MixBlock( block );
+
+		auto   endTime = std::chrono::high_resolution_clock::now();
+		double time    = std::chrono::duration< double, std::micro >( endTime - startTime ).count();
+
+		minTime        = std::min( minTime, time );
+		maxTime        = std::max( maxTime, time );
+		totalTime += time;
+	}
+
+	double avgTime     = totalTime / std::max( sBlockCount, 1u );
+	double blockLength = FRAME_SIZE * 1000000.0 / SOUND_RATE;
+
+	Log_MsgF( gLC_Aduio, "Mixer Benchmark - %u voices (%u virtual), %u blocks of %zd frames, %s kernels\n",
+	          audio->aVoiceCount, audio->aVirtualVoices.load(), sBlockCount, FRAME_SIZE, Audio_GetDSPName() );
+	Log_MsgF( gLC_Aduio, "    avg %.2f us, min %.2f us, max %.2f us per block\n", avgTime, minTime, maxTime );
+	Log_MsgF( gLC_Aduio, "    %.2f%% of the %.2f us block length\n", avgTime / blockLength * 100.0, blockLength );
+
+	// these never went through the game thread, so free them here instead of handing them back
+	for ( u32 i = 0; i < audio->aVoiceCount; i++ )
+		audio->DestroyStream( audio->aVoices[ i ].stream );
+
+	audio->aVoiceCount = 0;
+
+	audio->RestoreVoices();
+	audio->EndOfflineRender();
+}
+
+
+CONCMD_VA( snd_bench_mix, "Mix voices without an output device and report CPU time per audio block - snd_bench_mix [voices] [blocks]" )
+{
+	u32 voiceCount = 256;
+	u32 blockCount = 2000;
+
+	if ( args.size() > 0 )
+		voiceCount = std::clamp( atoi( args[ 0 ].c_str() ), 1, (int)CH_MAX_VOICES );
+
+	if ( args.size() > 1 )
+		blockCount = std::max( atoi( args[ 1 ].c_str() ), 1 );
+
+	Audio_BenchMix( voiceCount, blockCount );
+}
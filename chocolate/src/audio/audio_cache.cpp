@@ -0,0 +1,452 @@
+#include "audio.h"
+
+
+CONVAR_INT_EXT( snd_read_chunk_size );
+CONVAR_FLOAT_EXT( snd_read_mult );
+
+CONVAR_FLOAT( snd_cache_max_length, 8.f, CVARF_ARCHIVE, "Sounds this many seconds or shorter are decoded once and kept in memory, longer ones are streamed" );
+CONVAR_INT( snd_cache_budget, 64, CVARF_ARCHIVE, "Memory budget for decoded sounds in megabytes, unused sounds are evicted when over it" );
+
+
+// ===========================================================================
+// Sound Cache - Game Thread
+
+
+bool AudioSystem::OpenStreamData( AudioStream* stream, IAudioCodec* codec, const char* spPath )
+{
+	// this sound was already decoded, no need to touch the file at all
+	if ( AudioCachedSound* cached = FindCachedSound( stream->name ) )
+	{
+		AcquireCachedSound( stream, cached );
+		return true;
+	}
+
+	if ( !codec->Open( spPath, stream ) )
+		return false;
+
+	stream->codec = codec;
+
+	// short sounds are decoded once and shared, long sounds are streamed
+	if ( stream->totalFrames == 0 || stream->rate == 0 )
+		return true;
+
+	if ( stream->totalFrames > snd_cache_max_length * stream->rate )
+		return true;
+
+	// if this fails, we can still stream it
+	if ( !CacheSound( stream ) )
+		Log_WarnF( gLC_Aduio, "Failed to cache sound, streaming it instead: \"%s\"\n", stream->name.c_str() );
+
+	return true;
+}
+
+
+AudioCachedSound* AudioSystem::FindCachedSound( const std::string& srName )
+{
+	auto it = aSoundCache.find( srName );
+	if ( it == aSoundCache.end() )
+		return nullptr;
+
+	return it->second;
+}
+
+
+void AudioSystem::AcquireCachedSound( AudioStream* stream, AudioCachedSound* spCached )
+{
+	spCached->refCount++;
+	spCached->lastUsed  = ++aSoundCacheTick;
+
+	stream->cache       = spCached;
+	stream->cachePos    = 0;
+
+	// cached audio is already converted for the mixer
+	stream->channels    = 2;
+	stream->rate        = SOUND_RATE;
+	stream->format      = AUDIO_F32;
+	stream->totalFrames = spCached->frames;
+}
+
+
+void AudioSystem::ReleaseCachedSound( AudioStream* stream )
+{
+	if ( !stream->cache )
+		return;
+
+	stream->cache->refCount--;
+	stream->cache = nullptr;
+
+	TrimSoundCache();
+}
+
+
+// Move all converted audio out of an SDL_AudioStream
+static bool Audio_DrainConverter( SDL_AudioStream* spConvert, ChVector< float >& srOutput )
+{
+	int available = SDL_AudioStreamAvailable( spConvert );
+	if ( available <= 0 )
+		return true;
+
+	u32 start = srOutput.size();
+	srOutput.resize( start + available / sizeof( float ), false );
+
+	// this is in bytes, not samples!
+	int read = SDL_AudioStreamGet( spConvert, srOutput.data() + start, available );
+	if ( read < 0 )
+	{
+		Log_ErrorF( gLC_Aduio, "SDL_AudioStreamGet - Failed to get converted data: %s\n", SDL_GetError() );
+		return false;
+	}
+
+	srOutput.resize( start + read / sizeof( float ), false );
+	return true;
+}
+
+
+bool AudioSystem::CacheSound( AudioStream* stream )
+{
+	PROF_SCOPE();
+
+	if ( stream->cache )
+		return true;
+
+	AudioCachedSound* cached = FindCachedSound( stream->name );
+
+	if ( !cached )
+	{
+		// always cache the entire sound, even if it was seeked
+		if ( stream->codec->Seek( stream, 0.0 ) == -1 )
+			return false;
+
+		SDL_AudioStream* convert = SDL_NewAudioStream( stream->format, stream->channels, stream->rate, AUDIO_F32, 2, SOUND_RATE );
+		if ( convert == nullptr )
+		{
+			Log_ErrorF( gLC_Aduio, "SDL_NewAudioStream failed: %s\n", SDL_GetError() );
+			return false;
+		}
+
+		ChVector< float > pcm;
+		ChVector< float > rawAudio;
+
+		if ( stream->totalFrames && stream->rate )
+			pcm.reserve( ( stream->totalFrames * SOUND_RATE / stream->rate + FRAME_SIZE ) * 2 );
+
+		rawAudio.reserve( snd_read_chunk_size * std::max< u32 >( stream->channels, 1 ) );
+
+		bool failed = false;
+
+		while ( true )
+		{
+			rawAudio.clear();
+			long read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
+
+			if ( read < 0 )
+			{
+				failed = true;
+				break;
+			}
+
+			// End of File
+			if ( read == 0 )
+				break;
+
+			// NOTE: "read" NEEDS TO BE 4 TIMES THE AMOUNT FOR SOME REASON, no clue why
+			if ( SDL_AudioStreamPut( convert, rawAudio.data(), read * snd_read_mult ) == -1 )
+			{
+				Log_ErrorF( gLC_Aduio, "SDL_AudioStreamPut - Failed to put samples in stream: %s\n", SDL_GetError() );
+				failed = true;
+				break;
+			}
+
+			if ( !Audio_DrainConverter( convert, pcm ) )
+			{
+				failed = true;
+				break;
+			}
+		}
+
+		if ( !failed )
+		{
+			SDL_AudioStreamFlush( convert );
+			failed = !Audio_DrainConverter( convert, pcm );
+		}
+
+		SDL_FreeAudioStream( convert );
+
+		if ( failed || pcm.size() == 0 )
+		{
+			stream->codec->Seek( stream, 0.0 );
+			return false;
+		}
+
+		pcm.consolidate();
+
+		cached         = new AudioCachedSound;
+		cached->name   = stream->name;
+		cached->frames = pcm.size() / 2;
+		cached->data   = std::move( pcm );
+
+		aSoundCache[ cached->name ] = cached;
+		aSoundCacheSize += cached->data.size_bytes();
+	}
+
+	// the codec and streaming data aren't needed anymore
+	if ( stream->codec )
+	{
+		stream->codec->Close( stream );
+		stream->codec = nullptr;
+	}
+
+	if ( stream->audioStream )
+	{
+		SDL_FreeAudioStream( stream->audioStream );
+		stream->audioStream = nullptr;
+	}
+
+	delete stream->ring;
+	stream->ring = nullptr;
+	stream->readBuffer.free_data();
+
+	AcquireCachedSound( stream, cached );
+	TrimSoundCache();
+	return true;
+}
+
+
+void AudioSystem::TrimSoundCache()
+{
+	size_t budget = (size_t)std::max( snd_cache_budget, 0 ) * 1024 * 1024;
+
+	while ( aSoundCacheSize > budget )
+	{
+		// evict the least recently used sound nothing is playing
+		auto oldest = aSoundCache.end();
+		for ( auto it = aSoundCache.begin(); it != aSoundCache.end(); it++ )
+		{
+			if ( it->second->refCount )
+				continue;
+
+			if ( oldest == aSoundCache.end() || it->second->lastUsed < oldest->second->lastUsed )
+				oldest = it;
+		}
+
+		// everything left is in use
+		if ( oldest == aSoundCache.end() )
+			return;
+
+		AudioCachedSound* cached = oldest->second;
+		aSoundCacheSize -= cached->data.size_bytes();
+		aSoundCache.erase( oldest );
+
+		Log_DevF( gLC_Aduio, 2, "Evicted sound from cache: \"%s\"\n", cached->name.c_str() );
+		delete cached;
+	}
+}
+
+
+void AudioSystem::ClearSoundCache()
+{
+	for ( auto& [ name, cached ] : aSoundCache )
+	{
+		if ( cached->refCount )
+			Log_WarnF( gLC_Aduio, "Freeing cached sound that is still in use: \"%s\"\n", name.c_str() );
+
+		delete cached;
+	}
+
+	aSoundCache.clear();
+	aSoundCacheSize = 0;
+}
+
+
+// ===========================================================================
+// Streaming
+
+
+// Called on the decode worker, or the game thread before the worker has the stream
+void AudioSystem::FillStreamRing( AudioStream* stream, u32 sTarget )
+{
+	AudioStreamRing* ring = stream->ring;
+	float            converted[ 2048 ];
+
+	// the mixer wants us to seek
+	u32 seekRequest = ring->seekRequest.load( std::memory_order_acquire );
+	if ( seekRequest != ring->seekHandled )
+	{
+		if ( stream->codec->Seek( stream, ring->seekPos.load( std::memory_order_relaxed ) ) == 0 )
+		{
+			SDL_AudioStreamClear( stream->audioStream );
+			ring->codecEOF = false;
+			ring->eof.store( false, std::memory_order_relaxed );
+		}
+
+		// everything in the ring up to here is from before the seek
+		ring->seekHandled = seekRequest;
+		ring->seekTail.store( ring->ring.tail.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+		ring->seekDone.store( seekRequest, std::memory_order_release );
+	}
+
+	while ( !ring->eof.load( std::memory_order_relaxed ) && ring->ring.size() < sTarget )
+	{
+		// move any converted audio into the ring first
+		int available = SDL_AudioStreamAvailable( stream->audioStream ) / sizeof( float );
+		if ( available > 0 )
+		{
+			u32 count = std::min< u32 >( { (u32)available, ring->ring.available(), CH_ARR_SIZE( converted ) } );
+
+			// this is in bytes, not samples!
+			int read  = SDL_AudioStreamGet( stream->audioStream, converted, count * sizeof( float ) );
+			if ( read <= 0 )
+				break;
+
+			ring->ring.write( converted, read / sizeof( float ) );
+			continue;
+		}
+
+		// the mixer finishes the sound once the ring is empty
+		if ( ring->codecEOF )
+		{
+			ring->eof.store( true, std::memory_order_release );
+			break;
+		}
+
+		ChVector< float >& rawAudio = stream->readBuffer;
+		rawAudio.clear();
+
+		long read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
+
+		// try again later, the mixer will play silence if this keeps up
+		if ( read < 0 )
+			break;
+
+		// End of File
+		if ( read == 0 )
+		{
+			if ( ring->loop.load( std::memory_order_relaxed ) && stream->codec->Seek( stream, ring->loopStart.load( std::memory_order_relaxed ) ) == 0 )
+				read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
+
+			// let the rest of the converted audio play out
+			if ( read <= 0 )
+			{
+				SDL_AudioStreamFlush( stream->audioStream );
+				ring->codecEOF = true;
+				continue;
+			}
+		}
+
+		// NOTE: "read" NEEDS TO BE 4 TIMES THE AMOUNT FOR SOME REASON, no clue why
+		if ( SDL_AudioStreamPut( stream->audioStream, rawAudio.data(), read * snd_read_mult ) == -1 )
+		{
+			Log_WarnF( gLC_Aduio, "SDL_AudioStreamPut - Failed to put samples in stream: %s\n", SDL_GetError() );
+			ring->codecEOF = true;
+		}
+	}
+}
+
+
+void AudioSystem::StartStreaming( AudioStream* stream )
+{
+	// decode a bit right away so the mixer doesn't start with silence
+	FillStreamRing( stream, CH_STREAM_RING_SIZE / 4 );
+
+	{
+		std::lock_guard< std::mutex > lock( aDecodeMutex );
+		aDecodeStreams.push_back( stream );
+	}
+
+	if ( apDecodeWake )
+		SDL_SemPost( apDecodeWake );
+}
+
+
+void AudioSystem::StopStreaming( AudioStream* stream )
+{
+	std::unique_lock< std::mutex > lock( aDecodeMutex );
+	vec_remove_if( aDecodeStreams, stream );
+
+	// only waits if the worker is in the middle of decoding this stream
+	aDecodeDone.wait( lock, [ & ]() { return apDecoding != stream; } );
+}
+
+
+void AudioSystem::StartDecodeThread()
+{
+	if ( apDecodeThread )
+		return;
+
+	apDecodeWake   = SDL_CreateSemaphore( 0 );
+	aDecodeRunning = true;
+	apDecodeThread = new std::thread( &AudioSystem::DecodeThread, this );
+}
+
+
+void AudioSystem::StopDecodeThread()
+{
+	if ( !apDecodeThread )
+		return;
+
+	aDecodeRunning = false;
+	SDL_SemPost( apDecodeWake );
+
+	apDecodeThread->join();
+	delete apDecodeThread;
+	apDecodeThread = nullptr;
+
+	SDL_DestroySemaphore( apDecodeWake );
+	apDecodeWake = nullptr;
+}
+
+
+void AudioSystem::DecodeThread()
+{
+	std::vector< AudioStream* > streams;
+
+	while ( aDecodeRunning )
+	{
+		// the mixer wakes us up when a ring is half empty, the timeout keeps new streams topped up
+		SDL_SemWaitTimeout( apDecodeWake, 10 );
+
+		PROF_SCOPE_NAMED( "Audio Decode" );
+
+		std::unique_lock< std::mutex > lock( aDecodeMutex );
+		streams.assign( aDecodeStreams.begin(), aDecodeStreams.end() );
+
+		// decode without the lock, so stopping a stream doesn't wait for every other stream to decode
+		for ( AudioStream* stream : streams )
+		{
+			// it was stopped since the copy was made
+			if ( std::find( aDecodeStreams.begin(), aDecodeStreams.end(), stream ) == aDecodeStreams.end() )
+				continue;
+
+			apDecoding = stream;
+			lock.unlock();
+
+			FillStreamRing( stream, CH_STREAM_RING_SIZE );
+
+			lock.lock();
+			apDecoding = nullptr;
+			aDecodeDone.notify_all();
+		}
+	}
+}
+
+
+// ===========================================================================
+
+
+CONCMD_VA( snd_cache_stats, "Print decoded sound cache stats" )
+{
+	u32 inUse = 0;
+	for ( auto& [ name, cached ] : audio->aSoundCache )
+		inUse += cached->refCount ? 1 : 0;
+
+	Log_MsgF( gLC_Aduio, "Cached Sounds:    %zd (%u in use)\n", audio->aSoundCache.size(), inUse );
+	Log_MsgF( gLC_Aduio, "Cache Memory:     %.2f / %d MB\n", audio->aSoundCacheSize / ( 1024.f * 1024.f ), snd_cache_budget );
+	Log_MsgF( gLC_Aduio, "Streamed Sounds:  %zd\n", audio->aDecodeStreams.size() );
+	Log_MsgF( gLC_Aduio, "Stream Starves:   %u\n", audio->aStreamStarves.load() );
+
+	if ( args.size() && args[ 0 ] == "list" )
+	{
+		for ( auto& [ name, cached ] : audio->aSoundCache )
+			Log_MsgF( gLC_Aduio, "    %6.2f MB - %u refs - %s\n", cached->data.size_bytes() / ( 1024.f * 1024.f ), cached->refCount, name.c_str() );
+	}
+}
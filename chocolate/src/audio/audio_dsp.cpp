@@ -0,0 +1,267 @@
+#include "audio.h"
+#include "audio_dsp.h"
+
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( __i386__ )
+  #define CH_AUDIO_X86 1
+  #include <immintrin.h>
+#else
+  #define CH_AUDIO_X86 0
+#endif
+
+// gcc and clang need to be told a function can use avx, msvc lets you use any intrinsic
+#if defined( __GNUC__ ) || defined( __clang__ )
+  #define CH_TARGET_AVX __attribute__( ( target( "avx" ) ) )
+#else
+  #define CH_TARGET_AVX
+#endif
+
+
+CONVAR_BOOL( snd_dsp_simd, true, "Use SSE/AVX audio mixing kernels, requires restart" );
+
+
+// ===========================================================================
+// Scalar
+
+
+static void Audio_Deinterleave_Scalar( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	for ( u32 i = 0; i < sFrames; i++ )
+	{
+		spLeft[ i ]  = spInput[ i * 2 ] * sGain;
+		spRight[ i ] = spInput[ i * 2 + 1 ] * sGain;
+	}
+}
+
+
+static void Audio_DeinterleaveMix_Scalar( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	for ( u32 i = 0; i < sFrames; i++ )
+	{
+		spLeft[ i ] += spInput[ i * 2 ] * sGain;
+		spRight[ i ] += spInput[ i * 2 + 1 ] * sGain;
+	}
+}
+
+
+static void Audio_Interleave_Scalar( const float* spLeft, const float* spRight, float* spOutput, u32 sFrames, float sGain )
+{
+	for ( u32 i = 0; i < sFrames; i++ )
+	{
+		spOutput[ i * 2 ]     = spLeft[ i ] * sGain;
+		spOutput[ i * 2 + 1 ] = spRight[ i ] * sGain;
+	}
+}
+
+
+static void Audio_MixGain_Scalar( float* spDst, const float* spSrc, u32 sCount, float sGain )
+{
+	for ( u32 i = 0; i < sCount; i++ )
+		spDst[ i ] += spSrc[ i ] * sGain;
+}
+
+
+#if CH_AUDIO_X86
+
+// ===========================================================================
+// SSE - 4 frames at a time
+
+
+static void Audio_Deinterleave_SSE( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	__m128 gain = _mm_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 4 <= sFrames; i += 4 )
+	{
+		__m128 a = _mm_loadu_ps( &spInput[ i * 2 ] );      // L0 R0 L1 R1
+		__m128 b = _mm_loadu_ps( &spInput[ i * 2 + 4 ] );  // L2 R2 L3 R3
+
+		_mm_storeu_ps( &spLeft[ i ], _mm_mul_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ), gain ) );
+		_mm_storeu_ps( &spRight[ i ], _mm_mul_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ), gain ) );
+	}
+
+	Audio_Deinterleave_Scalar( &spInput[ i * 2 ], &spLeft[ i ], &spRight[ i ], sFrames - i, sGain );
+}
+
+
+static void Audio_DeinterleaveMix_SSE( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	__m128 gain = _mm_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 4 <= sFrames; i += 4 )
+	{
+		__m128 a = _mm_loadu_ps( &spInput[ i * 2 ] );
+		__m128 b = _mm_loadu_ps( &spInput[ i * 2 + 4 ] );
+
+		__m128 l = _mm_mul_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ), gain );
+		__m128 r = _mm_mul_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ), gain );
+
+		_mm_storeu_ps( &spLeft[ i ], _mm_add_ps( _mm_loadu_ps( &spLeft[ i ] ), l ) );
+		_mm_storeu_ps( &spRight[ i ], _mm_add_ps( _mm_loadu_ps( &spRight[ i ] ), r ) );
+	}
+
+	Audio_DeinterleaveMix_Scalar( &spInput[ i * 2 ], &spLeft[ i ], &spRight[ i ], sFrames - i, sGain );
+}
+
+
+static void Audio_Interleave_SSE( const float* spLeft, const float* spRight, float* spOutput, u32 sFrames, float sGain )
+{
+	__m128 gain = _mm_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 4 <= sFrames; i += 4 )
+	{
+		__m128 l = _mm_mul_ps( _mm_loadu_ps( &spLeft[ i ] ), gain );
+		__m128 r = _mm_mul_ps( _mm_loadu_ps( &spRight[ i ] ), gain );
+
+		_mm_storeu_ps( &spOutput[ i * 2 ], _mm_unpacklo_ps( l, r ) );      // L0 R0 L1 R1
+		_mm_storeu_ps( &spOutput[ i * 2 + 4 ], _mm_unpackhi_ps( l, r ) );  // L2 R2 L3 R3
+	}
+
+	Audio_Interleave_Scalar( &spLeft[ i ], &spRight[ i ], &spOutput[ i * 2 ], sFrames - i, sGain );
+}
+
+
+static void Audio_MixGain_SSE( float* spDst, const float* spSrc, u32 sCount, float sGain )
+{
+	__m128 gain = _mm_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 4 <= sCount; i += 4 )
+		_mm_storeu_ps( &spDst[ i ], _mm_add_ps( _mm_loadu_ps( &spDst[ i ] ), _mm_mul_ps( _mm_loadu_ps( &spSrc[ i ] ), gain ) ) );
+
+	Audio_MixGain_Scalar( &spDst[ i ], &spSrc[ i ], sCount - i, sGain );
+}
+
+
+// ===========================================================================
+// AVX - 8 frames at a time
+
+
+CH_TARGET_AVX static void Audio_Deinterleave_AVX( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	__m256 gain = _mm256_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 8 <= sFrames; i += 8 )
+	{
+		__m256 a  = _mm256_loadu_ps( &spInput[ i * 2 ] );      // L0 R0 L1 R1 | L2 R2 L3 R3
+		__m256 b  = _mm256_loadu_ps( &spInput[ i * 2 + 8 ] );  // L4 R4 L5 R5 | L6 R6 L7 R7
+
+		// shuffles only work within 128-bit lanes, so swap the middle halves first
+		__m256 lo = _mm256_permute2f128_ps( a, b, 0x20 );  // L0 R0 L1 R1 | L4 R4 L5 R5
+		__m256 hi = _mm256_permute2f128_ps( a, b, 0x31 );  // L2 R2 L3 R3 | L6 R6 L7 R7
+
+		_mm256_storeu_ps( &spLeft[ i ], _mm256_mul_ps( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ), gain ) );
+		_mm256_storeu_ps( &spRight[ i ], _mm256_mul_ps( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ), gain ) );
+	}
+
+	Audio_Deinterleave_SSE( &spInput[ i * 2 ], &spLeft[ i ], &spRight[ i ], sFrames - i, sGain );
+}
+
+
+CH_TARGET_AVX static void Audio_DeinterleaveMix_AVX( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain )
+{
+	__m256 gain = _mm256_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 8 <= sFrames; i += 8 )
+	{
+		__m256 a  = _mm256_loadu_ps( &spInput[ i * 2 ] );
+		__m256 b  = _mm256_loadu_ps( &spInput[ i * 2 + 8 ] );
+
+		__m256 lo = _mm256_permute2f128_ps( a, b, 0x20 );
+		__m256 hi = _mm256_permute2f128_ps( a, b, 0x31 );
+
+		__m256 l  = _mm256_mul_ps( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ), gain );
+		__m256 r  = _mm256_mul_ps( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ), gain );
+
+		_mm256_storeu_ps( &spLeft[ i ], _mm256_add_ps( _mm256_loadu_ps( &spLeft[ i ] ), l ) );
+		_mm256_storeu_ps( &spRight[ i ], _mm256_add_ps( _mm256_loadu_ps( &spRight[ i ] ), r ) );
+	}
+
+	Audio_DeinterleaveMix_SSE( &spInput[ i * 2 ], &spLeft[ i ], &spRight[ i ], sFrames - i, sGain );
+}
+
+
+CH_TARGET_AVX static void Audio_Interleave_AVX( const float* spLeft, const float* spRight, float* spOutput, u32 sFrames, float sGain )
+{
+	__m256 gain = _mm256_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 8 <= sFrames; i += 8 )
+	{
+		__m256 l  = _mm256_mul_ps( _mm256_loadu_ps( &spLeft[ i ] ), gain );
+		__m256 r  = _mm256_mul_ps( _mm256_loadu_ps( &spRight[ i ] ), gain );
+
+		__m256 lo = _mm256_unpacklo_ps( l, r );  // L0 R0 L1 R1 | L4 R4 L5 R5
+		__m256 hi = _mm256_unpackhi_ps( l, r );  // L2 R2 L3 R3 | L6 R6 L7 R7
+
+		_mm256_storeu_ps( &spOutput[ i * 2 ], _mm256_permute2f128_ps( lo, hi, 0x20 ) );
+		_mm256_storeu_ps( &spOutput[ i * 2 + 8 ], _mm256_permute2f128_ps( lo, hi, 0x31 ) );
+	}
+
+	Audio_Interleave_SSE( &spLeft[ i ], &spRight[ i ], &spOutput[ i * 2 ], sFrames - i, sGain );
+}
+
+
+CH_TARGET_AVX static void Audio_MixGain_AVX( float* spDst, const float* spSrc, u32 sCount, float sGain )
+{
+	__m256 gain = _mm256_set1_ps( sGain );
+	u32    i    = 0;
+
+	for ( ; i + 8 <= sCount; i += 8 )
+		_mm256_storeu_ps( &spDst[ i ], _mm256_add_ps( _mm256_loadu_ps( &spDst[ i ] ), _mm256_mul_ps( _mm256_loadu_ps( &spSrc[ i ] ), gain ) ) );
+
+	Audio_MixGain_SSE( &spDst[ i ], &spSrc[ i ], sCount - i, sGain );
+}
+
+#endif  // CH_AUDIO_X86
+
+
+// ===========================================================================
+
+
+FAudio_Deinterleave*    Audio_Deinterleave    = Audio_Deinterleave_Scalar;
+FAudio_DeinterleaveMix* Audio_DeinterleaveMix = Audio_DeinterleaveMix_Scalar;
+FAudio_Interleave*      Audio_Interleave      = Audio_Interleave_Scalar;
+FAudio_MixGain*         Audio_MixGain         = Audio_MixGain_Scalar;
+
+static const char*      gAudioDSPName         = "Scalar";
+
+
+void Audio_InitDSP()
+{
+#if CH_AUDIO_X86
+	if ( !snd_dsp_simd )
+		return;
+
+	cpu_info_t cpu_info = sys_get_cpu_info();
+
+	if ( cpu_info.features & ECPU_Feature_AVX )
+	{
+		Audio_Deinterleave    = Audio_Deinterleave_AVX;
+		Audio_DeinterleaveMix = Audio_DeinterleaveMix_AVX;
+		Audio_Interleave      = Audio_Interleave_AVX;
+		Audio_MixGain         = Audio_MixGain_AVX;
+		gAudioDSPName         = "AVX";
+	}
+	else if ( cpu_info.features & ECPU_Feature_SSE )
+	{
+		Audio_Deinterleave    = Audio_Deinterleave_SSE;
+		Audio_DeinterleaveMix = Audio_DeinterleaveMix_SSE;
+		Audio_Interleave      = Audio_Interleave_SSE;
+		Audio_MixGain         = Audio_MixGain_SSE;
+		gAudioDSPName         = "SSE";
+	}
+#endif
+
+	Log_DevF( gLC_Aduio, 1, "Audio DSP Kernels: %s\n", gAudioDSPName );
+}
+
+
+const char* Audio_GetDSPName()
+{
+	return gAudioDSPName;
+}
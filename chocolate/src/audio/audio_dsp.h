@@ -0,0 +1,26 @@
+#pragma once
+
+// Audio DSP kernels, with SSE and AVX versions picked at startup by Audio_InitDSP()
+
+
+// spLeft/spRight = deinterleaved spInput * sGain
+using FAudio_Deinterleave    = void( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain );
+
+// spLeft/spRight += deinterleaved spInput * sGain
+using FAudio_DeinterleaveMix = void( const float* spInput, float* spLeft, float* spRight, u32 sFrames, float sGain );
+
+// spOutput = interleaved spLeft/spRight * sGain
+using FAudio_Interleave      = void( const float* spLeft, const float* spRight, float* spOutput, u32 sFrames, float sGain );
+
+// spDst += spSrc * sGain
+using FAudio_MixGain         = void( float* spDst, const float* spSrc, u32 sCount, float sGain );
+
+
+extern FAudio_Deinterleave*    Audio_Deinterleave;
+extern FAudio_DeinterleaveMix* Audio_DeinterleaveMix;
+extern FAudio_Interleave*      Audio_Interleave;
+extern FAudio_MixGain*         Audio_MixGain;
+
+
+void                           Audio_InitDSP();
+const char*                    Audio_GetDSPName();
@@ -0,0 +1,451 @@
+#include "audio.h"
+#include "audio_dsp.h"
+
+#include <chrono>
+
+
+CONVAR_FLOAT_EXT( snd_volume );
+CONVAR_RANGE_INT_EXT( snd_mix_ahead );
+
+
+// ===========================================================================
+// Game Thread
+
+
+bool AudioSystem::PushCommand( const AudioCmd& srCmd )
+{
+	if ( aCommands.push( srCmd ) )
+		return true;
+
+	Log_Error( gLC_Aduio, "Audio command queue is full, dropping command\n" );
+	return false;
+}
+
+
+void AudioSystem::BuildVoiceParams( AudioStream* stream, AudioVoiceParams& srParams )
+{
+	AudioChannel* channel = GetChannelData( stream->channel );
+
+	srParams.vol          = stream->vol * ( channel ? channel->aVol : 1.f );
+	srParams.paused       = stream->paused || ( channel && channel->aPaused );
+	srParams.effects      = stream->aEffects;
+
+	if ( stream->aEffects & AudioEffect_World )
+	{
+		srParams.worldPos     = stream->GetVec3( EAudio_World_Pos );
+		srParams.worldRadius  = stream->GetFloat( EAudio_World_Radius );
+		srParams.worldFalloff = stream->GetFloat( EAudio_World_Falloff );
+	}
+
+	if ( stream->aEffects & AudioEffect_Loop )
+	{
+		srParams.loop      = stream->GetInt( EAudio_Loop_Enabled );
+		srParams.loopStart = stream->GetFloat( EAudio_Loop_StartTime );
+	}
+}
+
+
+// Send the mixer a new copy of the stream's params if it's playing it
+void AudioSystem::SyncVoiceParams( ch_handle_t sHandle, AudioStream* stream )
+{
+	if ( !stream->playing )
+		return;
+
+	AudioCmd cmd{};
+	cmd.type   = EAudioCmd_SetParams;
+	cmd.handle = sHandle;
+	BuildVoiceParams( stream, cmd.params );
+	PushCommand( cmd );
+}
+
+
+// Free streams the mixer has handed back to us, either because they finished playing or FreeSound was called
+void AudioSystem::ProcessMixerEvents()
+{
+	AudioMixerEvent event;
+	while ( aMixerEvents.pop( event ) )
+	{
+		event.stream->playing = false;
+		vec_remove_if( aStreamsPlaying, event.handle );
+
+		// if FreeSound was called, this handle was already removed
+		AudioStream* stream = nullptr;
+		if ( aStreams.Get( event.handle, &stream ) && stream == event.stream )
+			aStreams.Remove( event.handle );
+
+		DestroyStream( event.stream );
+	}
+
+	u32 dropped = aDroppedVoices.load( std::memory_order_relaxed );
+	if ( dropped != aReportedDropped )
+	{
+		Log_WarnF( gLC_Aduio, "Max Voices Playing (%d), dropped %u sounds\n", CH_MAX_VOICES, dropped - aReportedDropped );
+		aReportedDropped = dropped;
+	}
+
+	u32 leaked = aLeakedStreams.load( std::memory_order_relaxed );
+	if ( leaked != aReportedLeaked )
+	{
+		Log_ErrorF( gLC_Aduio, "Audio mixer event queue was full, leaked %u sounds\n", leaked - aReportedLeaked );
+		aReportedLeaked = leaked;
+	}
+}
+
+
+void AudioSystem::DestroyStream( AudioStream* stream )
+{
+	iplAudioBufferFree( aCtx, &stream->spatialIn );
+	iplAudioBufferFree( aCtx, &stream->spatialMid );
+	iplAudioBufferFree( aCtx, &stream->outBuffer );
+
+	// make sure the decode worker is done with it first
+	if ( stream->ring )
+	{
+		StopStreaming( stream );
+		delete stream->ring;
+	}
+
+	if ( stream->audioStream )
+		SDL_FreeAudioStream( stream->audioStream );
+
+	if ( stream->codec )
+		stream->codec->Close( stream );
+
+	ReleaseCachedSound( stream );
+
+	for ( AudioEffectVar* var : stream->aVars )
+		delete var;
+
+	stream->readBuffer.free_data();
+	stream->mixInput.free_data();
+
+	delete stream;
+}
+
+
+// ===========================================================================
+// Mixer Thread
+
+
+// The decode worker handles looping for streamed sounds, so give it the loop settings
+static void Audio_SyncStreamLoop( AudioVoice& srVoice )
+{
+	AudioStreamRing* ring = srVoice.stream->ring;
+	if ( !ring )
+		return;
+
+	ring->loop.store( ( srVoice.params.effects & AudioEffect_Loop ) && srVoice.params.loop, std::memory_order_relaxed );
+	ring->loopStart.store( srVoice.params.loopStart, std::memory_order_relaxed );
+}
+
+
+AudioVoice* AudioSystem::FindVoice( ch_handle_t sHandle )
+{
+	for ( u32 i = 0; i < aVoiceCount; i++ )
+	{
+		if ( aVoices[ i ].handle == sHandle )
+			return &aVoices[ i ];
+	}
+
+	return nullptr;
+}
+
+
+// Remove a voice and hand the stream back to the game thread
+void AudioSystem::StopVoice( u32 sIndex )
+{
+	AudioVoice& voice = aVoices[ sIndex ];
+
+	// PlaySound never hands us more streams than fit in the queue, so this can't fail
+	if ( !aMixerEvents.push( { voice.handle, voice.stream } ) )
+		aLeakedStreams.fetch_add( 1, std::memory_order_relaxed );
+
+	// swap with the last voice, order doesn't matter here
+	aVoices[ sIndex ] = aVoices[ --aVoiceCount ];
+}
+
+
+void AudioSystem::ProcessCommands()
+{
+	PROF_SCOPE();
+
+	AudioCmd cmd;
+	while ( aCommands.pop( cmd ) )
+	{
+		switch ( cmd.type )
+		{
+			case EAudioCmd_Play:
+			{
+				if ( aVoiceCount == CH_MAX_VOICES )
+				{
+					aDroppedVoices.fetch_add( 1, std::memory_order_relaxed );
+
+					if ( !aMixerEvents.push( { cmd.handle, cmd.stream } ) )
+						aLeakedStreams.fetch_add( 1, std::memory_order_relaxed );
+
+					break;
+				}
+
+				AudioVoice& voice = aVoices[ aVoiceCount++ ];
+				voice.handle      = cmd.handle;
+				voice.stream      = cmd.stream;
+				voice.params      = cmd.params;
+				voice.seeking     = false;
+				voice.virtualized = false;
+
+				Audio_SyncStreamLoop( voice );
+				break;
+			}
+
+			case EAudioCmd_Stop:
+			{
+				for ( u32 i = 0; i < aVoiceCount; i++ )
+				{
+					if ( aVoices[ i ].handle != cmd.handle )
+						continue;
+
+					StopVoice( i );
+					break;
+				}
+
+				break;
+			}
+
+			case EAudioCmd_SetParams:
+			{
+				if ( AudioVoice* voice = FindVoice( cmd.handle ) )
+				{
+					voice->params = cmd.params;
+					Audio_SyncStreamLoop( *voice );
+				}
+
+				break;
+			}
+
+			case EAudioCmd_Seek:
+			{
+				AudioVoice* voice = FindVoice( cmd.handle );
+				if ( !voice )
+					break;
+
+				AudioStream* stream = voice->stream;
+
+				if ( stream->cache )
+				{
+					stream->cachePos = std::min< u32 >( std::max( cmd.seekPos, 0.0 ) * SOUND_RATE, stream->cache->frames );
+					break;
+				}
+
+				// the decode worker owns the codec, so it has to do the seek, see ReadAudio
+				stream->ring->seekPos.store( cmd.seekPos, std::memory_order_relaxed );
+				stream->ring->seekRequest.fetch_add( 1, std::memory_order_release );
+				voice->seeking = true;
+
+				SDL_SemPost( apDecodeWake );
+				break;
+			}
+
+			case EAudioCmd_SetListener:
+			{
+				aMixListenerPos = cmd.listenerPos;
+				aMixListenerRot = cmd.listenerRot;
+				break;
+			}
+
+			case EAudioCmd_SetPaused:
+			{
+				aMixPaused = cmd.paused;
+				break;
+			}
+		}
+	}
+}
+
+
+bool AudioSystem::MixVoice( AudioVoice& srVoice )
+{
+	u32 read = 0;
+	if ( !ReadAudio( srVoice, read ) )
+		return false;
+
+	return ApplyEffects( srVoice, read );
+}
+
+
+// Mix one block of FRAME_SIZE stereo frames into spOutput
+// This does no allocations and never waits on the game thread
+void AudioSystem::MixBlock( float* spOutput )
+{
+	PROF_SCOPE();
+
+	ProcessCommands();
+
+	memset( aMixBuffer.data[ 0 ], 0, FRAME_SIZE * sizeof( float ) );
+	memset( aMixBuffer.data[ 1 ], 0, FRAME_SIZE * sizeof( float ) );
+
+	u32 virtualVoices = 0;
+
+	if ( !aMixPaused )
+	{
+		for ( u32 i = 0; i < aVoiceCount; )
+		{
+			if ( aVoices[ i ].params.paused )
+			{
+				i++;
+				continue;
+			}
+
+			// StopVoice moves the last voice into this slot, so don't advance
+			if ( !MixVoice( aVoices[ i ] ) )
+			{
+				StopVoice( i );
+				continue;
+			}
+
+			virtualVoices += aVoices[ i ].virtualized;
+			i++;
+		}
+	}
+
+	aVirtualVoices.store( virtualVoices, std::memory_order_relaxed );
+
+	// interleave manually so we can control global audio volume
+	// unless we can set volume on the output device without changing it on the system
+	Audio_Interleave( aMixBuffer.data[ 0 ], aMixBuffer.data[ 1 ], spOutput, FRAME_SIZE, snd_volume );
+
+	aMixFrames.fetch_add( FRAME_SIZE, std::memory_order_relaxed );
+}
+
+
+void AudioSystem::StartMixerThread()
+{
+	if ( apMixerThread || !apMixerWake )
+		return;
+
+	aMixerRunning = true;
+	apMixerThread = new std::thread( &AudioSystem::MixerThread, this );
+}
+
+
+void AudioSystem::StopMixerThread()
+{
+	if ( !apMixerThread )
+		return;
+
+	aMixerRunning = false;
+	SDL_SemPost( apMixerWake );
+
+	apMixerThread->join();
+	delete apMixerThread;
+	apMixerThread = nullptr;
+}
+
+
+void AudioSystem::MixerThread()
+{
+	float block[ CH_MIX_BLOCK_SIZE ];
+
+	while ( aMixerRunning )
+	{
+		// the device callback wakes us up every time it takes audio from the ring buffer
+		// the timeout is only so we still process commands if the device stops calling back
+		SDL_SemWaitTimeout( apMixerWake, 100 );
+
+		PROF_SCOPE_NAMED( "Audio Mixer" );
+
+		u32 target = snd_mix_ahead * CH_MIX_BLOCK_SIZE;
+
+		while ( aOutputRing.size() + CH_MIX_BLOCK_SIZE <= target )
+		{
+			MixBlock( block );
+			aOutputRing.write( block, CH_MIX_BLOCK_SIZE );
+		}
+	}
+}
+
+
+// ===========================================================================
+// Device Thread
+
+
+// Called by SDL on it's audio thread, only copies already mixed audio so this can't stall
+void SDLCALL AudioSystem::DeviceCallback( void* spUserData, Uint8* spStream, int sLen )
+{
+	AudioSystem* system = static_cast< AudioSystem* >( spUserData );
+
+	u32          count  = sLen / sizeof( float );
+	u32          read   = system->aOutputRing.read( (float*)spStream, count );
+
+	if ( read < count )
+	{
+		memset( (float*)spStream + read, 0, ( count - read ) * sizeof( float ) );
+		system->aUnderruns.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	SDL_SemPost( system->apMixerWake );
+}
+
+
+void AudioSystem::StartNullDevice()
+{
+	if ( apNullDevice )
+		return;
+
+	aNullDeviceRunning = true;
+	apNullDevice       = new std::thread( &AudioSystem::NullDeviceThread, this );
+}
+
+
+void AudioSystem::StopNullDevice()
+{
+	if ( !apNullDevice )
+		return;
+
+	aNullDeviceRunning = false;
+
+	apNullDevice->join();
+	delete apNullDevice;
+	apNullDevice = nullptr;
+}
+
+
+// Stands in for the output device when we don't have one, so sounds still play out in real time and get freed
+void AudioSystem::NullDeviceThread()
+{
+	using Clock = std::chrono::steady_clock;
+
+	float             buffer[ CH_MIX_BLOCK_SIZE ];
+	Clock::duration   period   = std::chrono::duration_cast< Clock::duration >( std::chrono::duration< double >( (double)FRAME_SIZE / SOUND_RATE ) );
+	Clock::time_point nextTime = Clock::now();
+
+	while ( aNullDeviceRunning )
+	{
+		nextTime += period;
+
+		// don't try to catch up if we were stalled for a while, like from a debugger
+		if ( Clock::now() - nextTime > std::chrono::milliseconds( 100 ) )
+			nextTime = Clock::now();
+
+		std::this_thread::sleep_until( nextTime );
+
+		DeviceCallback( this, (Uint8*)buffer, sizeof( buffer ) );
+	}
+}
+
+
+// ===========================================================================
+
+
+CONCMD_VA( snd_mixer_stats, "Print audio mixer stats" )
+{
+	Log_MsgF( gLC_Aduio, "Output Device:  %s\n", audio->aOfflineRender ? "Offline" : audio->aOutputDeviceID ? "SDL" : "Null" );
+	Log_MsgF( gLC_Aduio, "Mix Time:       %.3f s\n", audio->GetMixTime() );
+	Log_MsgF( gLC_Aduio, "Voices Playing: %zd\n", audio->aStreamsPlaying.size() );
+	Log_MsgF( gLC_Aduio, "Virtual Voices: %u\n", audio->aVirtualVoices.load() );
+	Log_MsgF( gLC_Aduio, "DSP Kernels:    %s\n", Audio_GetDSPName() );
+	Log_MsgF( gLC_Aduio, "Output Buffer:  %u / %u samples\n", audio->aOutputRing.size(), snd_mix_ahead * CH_MIX_BLOCK_SIZE );
+	Log_MsgF( gLC_Aduio, "Underruns:      %u\n", audio->aUnderruns.load() );
+	Log_MsgF( gLC_Aduio, "Stream Starves: %u\n", audio->aStreamStarves.load() );
+	Log_MsgF( gLC_Aduio, "Dropped Sounds: %u\n", audio->aDroppedVoices.load() );
+	Log_MsgF( gLC_Aduio, "Latency:        %.2f ms\n", ( snd_mix_ahead * FRAME_SIZE + audio->aAudioSpec.samples ) * 1000.f / SOUND_RATE );
+}
@@ -0,0 +1,407 @@
+#include "audio.h"
+#include "codec_tone.h"
+
+#include <chrono>
+
+
+CONVAR_FLOAT( snd_render_tolerance, 0.0001f, "Max difference per sample allowed when comparing an offline render against a golden file" );
+
+
+// ===========================================================================
+// Offline Rendering
+
+
+bool AudioSystem::BeginOfflineRender()
+{
+	if ( aOfflineRender )
+		return true;
+
+	if ( !aMixBuffer.data )
+	{
+		Log_Error( gLC_Aduio, "Steam Audio failed to initialize, can't render audio offline\n" );
+		return false;
+	}
+
+	// stop the output device first, it's the only one reading from the output ring
+	if ( aOutputDeviceID )
+		SDL_PauseAudioDevice( aOutputDeviceID, 1 );
+
+	StopNullDevice();
+	StopMixerThread();
+
+	// throw out anything mixed in real time
+	aOutputRing.skip( aOutputRing.size() );
+
+	aOfflineBlockPos = CH_MIX_BLOCK_SIZE;
+	aOfflineRender   = true;
+	return true;
+}
+
+
+void AudioSystem::EndOfflineRender()
+{
+	if ( !aOfflineRender )
+		return;
+
+	aOfflineRender = false;
+
+	StartMixerThread();
+
+	if ( aOutputDeviceID )
+		SDL_PauseAudioDevice( aOutputDeviceID, 0 );
+	else
+		StartNullDevice();
+}
+
+
+u32 AudioSystem::RenderOffline( float* spOutput, u32 sFrames )
+{
+	PROF_SCOPE();
+
+	if ( !aOfflineRender )
+	{
+		Log_Error( gLC_Aduio, "RenderOffline called without BeginOfflineRender\n" );
+		return 0;
+	}
+
+	u32 samples = sFrames * 2;
+	u32 written = 0;
+
+	while ( written < samples )
+	{
+		if ( aOfflineBlockPos == CH_MIX_BLOCK_SIZE )
+		{
+			// top up every streamed sound first, so the output doesn't depend on how fast the decode worker is
+			{
+				std::lock_guard< std::mutex > lock( aDecodeMutex );
+
+				for ( AudioStream* stream : aDecodeStreams )
+					FillStreamRing( stream, CH_STREAM_RING_SIZE );
+			}
+
+			MixBlock( aOfflineBlock );
+			aOfflineBlockPos = 0;
+		}
+
+		u32 count = std::min( samples - written, CH_MIX_BLOCK_SIZE - aOfflineBlockPos );
+		memcpy( &spOutput[ written ], &aOfflineBlock[ aOfflineBlockPos ], count * sizeof( float ) );
+
+		written += count;
+		aOfflineBlockPos += count;
+	}
+
+	return sFrames;
+}
+
+
+double AudioSystem::GetMixTime()
+{
+	return aMixFrames.load( std::memory_order_relaxed ) / (double)SOUND_RATE;
+}
+
+
+ch_handle_t AudioSystem::OpenTone( float sFreq )
+{
+	char freq[ 32 ];
+	snprintf( freq, sizeof( freq ), "%g", sFreq );
+
+	// tones with the same frequency share the same cached sound
+	AudioStream* stream = new AudioStream;
+	stream->name        = std::string( "tone_" ) + freq;
+
+	if ( !OpenStreamData( stream, Audio_GetToneCodec(), freq ) || !( stream->valid = LoadSoundInternal( stream ) ) )
+	{
+		Log_ErrorF( gLC_Aduio, "Could not open tone: %s hz\n", freq );
+		DestroyStream( stream );
+		return CH_INVALID_HANDLE;
+	}
+
+	return aStreams.Add( stream );
+}
+
+
+void AudioSystem::IsolateVoices()
+{
+	if ( !aOfflineRender )
+		return;
+
+	// apply anything the game sent before the mixer was stopped
+	ProcessCommands();
+
+	aIsolatedVoices.assign( aVoices, aVoices + aVoiceCount );
+	aIsolatedPaused = aMixPaused;
+
+	aVoiceCount     = 0;
+	aMixPaused      = false;
+}
+
+
+void AudioSystem::RestoreVoices()
+{
+	if ( !aOfflineRender )
+		return;
+
+	// anything started while isolated is stopped and handed back to the game thread
+	ProcessCommands();
+
+	while ( aVoiceCount )
+		StopVoice( aVoiceCount - 1 );
+
+	aVoiceCount = aIsolatedVoices.size();
+	aMixPaused  = aIsolatedPaused;
+
+	for ( u32 i = 0; i < aVoiceCount; i++ )
+		aVoices[ i ] = aIsolatedVoices[ i ];
+
+	aIsolatedVoices.clear();
+}
+
+
+// ===========================================================================
+// Wav Files
+
+
+// 32-bit float stereo at SOUND_RATE, what the mixer outputs
+static bool Audio_WriteWav( const char* spPath, const float* spData, u32 sFrames )
+{
+	u32                dataSize = sFrames * 2 * sizeof( float );
+	std::vector< char > file( 44 + dataSize );
+	char*              out = file.data();
+
+	auto               write = [ &out ]( const void* data, size_t size )
+	{
+		memcpy( out, data, size );
+		out += size;
+	};
+
+	u32 riffSize   = 36 + dataSize;
+	u32 fmtSize    = 16;
+	u16 format     = 3;  // WAVE_FORMAT_IEEE_FLOAT
+	u16 channels   = 2;
+	u32 rate       = SOUND_RATE;
+	u32 byteRate   = SOUND_RATE * 2 * sizeof( float );
+	u16 blockAlign = 2 * sizeof( float );
+	u16 bits       = 32;
+
+	write( "RIFF", 4 );
+	write( &riffSize, 4 );
+	write( "WAVE", 4 );
+
+	write( "fmt ", 4 );
+	write( &fmtSize, 4 );
+	write( &format, 2 );
+	write( &channels, 2 );
+	write( &rate, 4 );
+	write( &byteRate, 4 );
+	write( &blockAlign, 2 );
+	write( &bits, 2 );
+
+	write( "data", 4 );
+	write( &dataSize, 4 );
+	write( spData, dataSize );
+
+	return FileSys_SaveFile( spPath, file );
+}
+
+
+// Only reads what Audio_WriteWav writes
+static bool Audio_ReadWav( const char* spPath, ChVector< float >& srData )
+{
+	ch_string_auto file = FileSys_ReadFile( spPath );
+
+	if ( !file.data )
+	{
+		Log_ErrorF( gLC_Aduio, "Failed to read wav file: \"%s\"\n", spPath );
+		return false;
+	}
+
+	if ( file.size < 12 || memcmp( file.data, "RIFF", 4 ) != 0 || memcmp( file.data + 8, "WAVE", 4 ) != 0 )
+	{
+		Log_ErrorF( gLC_Aduio, "Not a wav file: \"%s\"\n", spPath );
+		return false;
+	}
+
+	bool   validFormat = false;
+	size_t pos         = 12;
+
+	while ( pos + 8 <= file.size )
+	{
+		const char* chunk     = file.data + pos;
+		u32         chunkSize = 0;
+		memcpy( &chunkSize, chunk + 4, 4 );
+
+		if ( pos + 8 + chunkSize > file.size )
+			break;
+
+		if ( memcmp( chunk, "fmt ", 4 ) == 0 && chunkSize >= 16 )
+		{
+			u16 format, channels, bits;
+			u32 rate;
+			memcpy( &format, chunk + 8, 2 );
+			memcpy( &channels, chunk + 10, 2 );
+			memcpy( &rate, chunk + 12, 4 );
+			memcpy( &bits, chunk + 22, 2 );
+
+			validFormat = format == 3 && channels == 2 && rate == SOUND_RATE && bits == 32;
+		}
+		else if ( memcmp( chunk, "data", 4 ) == 0 )
+		{
+			if ( !validFormat )
+			{
+				Log_ErrorF( gLC_Aduio, "Wav file must be 32-bit float stereo at %zd hz: \"%s\"\n", SOUND_RATE, spPath );
+				return false;
+			}
+
+			srData.resize( chunkSize / sizeof( float ), false );
+			memcpy( srData.data(), chunk + 8, srData.size_bytes() );
+			return true;
+		}
+
+		// chunks are padded to an even size
+		pos += 8 + chunkSize + ( chunkSize & 1 );
+	}
+
+	Log_ErrorF( gLC_Aduio, "No audio data found in wav file: \"%s\"\n", spPath );
+	return false;
+}
+
+
+// ===========================================================================
+// Scripted Scene
+
+
+// Sources orbit the listener at different distances, speeds, and heights
+// Everything is driven by the offline clock, so the same arguments always render the same audio
+static void Audio_RenderScene( u32 sSources, float sSeconds, const char* spOutput, const char* spGolden )
+{
+	if ( !audio->BeginOfflineRender() )
+		return;
+
+	audio->IsolateVoices();
+
+	// start from a clean state, the spatial effects keep some history between blocks
+	iplDirectEffectReset( audio->apDirectEffect );
+	iplBinauralEffectReset( audio->apBinauralEffect );
+
+	glm::vec3 listenerPos = audio->aListenerPos;
+	glm::vec3 listenerAng = audio->aListenerAng;
+	audio->SetListenerTransform( {}, {} );
+
+	std::vector< ch_handle_t > sources;
+
+	for ( u32 i = 0; i < sSources; i++ )
+	{
+		ch_handle_t sound = audio->OpenTone( 220.f + ( i % 16 ) * 55.f );
+		if ( sound == CH_INVALID_HANDLE )
+			continue;
+
+		audio->AddEffects( sound, AudioEffect_World | AudioEffect_Loop );
+		audio->SetEffectData( sound, EAudio_World_Radius, 50.f );
+		audio->SetVolume( sound, i % 4 == 0 ? 0.5f : 1.f );
+		audio->PlaySound( sound );
+
+		sources.push_back( sound );
+	}
+
+	u32               frames = sSeconds * SOUND_RATE;
+	u32               blocks = ( frames + FRAME_SIZE - 1 ) / FRAME_SIZE;
+	ChVector< float > output;
+	output.resize( blocks * CH_MIX_BLOCK_SIZE );
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	for ( u32 block = 0; block < blocks; block++ )
+	{
+		float time = block * FRAME_SIZE / (float)SOUND_RATE;
+
+		for ( u32 i = 0; i < sources.size(); i++ )
+		{
+			float     orbit  = 2.f + ( i % 5 ) * 3.f;
+			float     speed  = 0.5f + ( i % 4 ) * 0.25f;
+			float     angle  = i * 2.f * M_PI / sources.size() + speed * time;
+
+			glm::vec3 pos    = { cosf( angle ) * orbit, sinf( angle ) * orbit, ( (int)( i % 3 ) - 1 ) * 1.f };
+			audio->SetEffectData( sources[ i ], EAudio_World_Pos, pos );
+		}
+
+		audio->RenderOffline( &output[ block * CH_MIX_BLOCK_SIZE ], FRAME_SIZE );
+	}
+
+	auto   endTime    = std::chrono::high_resolution_clock::now();
+	double renderTime = std::chrono::duration< double >( endTime - startTime ).count();
+	double audioTime  = blocks * FRAME_SIZE / (double)SOUND_RATE;
+
+	for ( ch_handle_t sound : sources )
+		audio->FreeSound( sound );
+
+	audio->SetListenerTransform( listenerPos, listenerAng );
+	audio->RestoreVoices();
+	audio->EndOfflineRender();
+
+	// free the stopped sources
+	audio->ProcessMixerEvents();
+
+	Log_MsgF( gLC_Aduio, "Rendered %.2f seconds of audio with %zd sources in %.3f seconds (%.1fx real time)\n",
+	          audioTime, sources.size(), renderTime, audioTime / std::max( renderTime, 0.000001 ) );
+
+	if ( spOutput && *spOutput )
+	{
+		if ( Audio_WriteWav( spOutput, output.data(), blocks * FRAME_SIZE ) )
+			Log_MsgF( gLC_Aduio, "Saved render to \"%s\"\n", spOutput );
+		else
+			Log_ErrorF( gLC_Aduio, "Failed to save render to \"%s\"\n", spOutput );
+	}
+
+	if ( !spGolden || !*spGolden )
+		return;
+
+	ChVector< float > golden;
+	if ( !Audio_ReadWav( spGolden, golden ) )
+		return;
+
+	if ( golden.size() != output.size() )
+	{
+		Log_ErrorF( gLC_Aduio, "FAILED - Golden file has %u frames, render has %u\n", golden.size() / 2, output.size() / 2 );
+		return;
+	}
+
+	double maxDiff = 0.0;
+	double sumDiff = 0.0;
+
+	for ( u32 i = 0; i < output.size(); i++ )
+	{
+		double diff = fabs( (double)output[ i ] - golden[ i ] );
+		maxDiff     = std::max( maxDiff, diff );
+		sumDiff += diff * diff;
+	}
+
+	double rms = sqrt( sumDiff / std::max( output.size(), 1u ) );
+
+	if ( maxDiff <= snd_render_tolerance )
+		Log_MsgF( gLC_Aduio, "PASSED - Matches golden file, max diff %g, rms diff %g\n", maxDiff, rms );
+	else
+		Log_ErrorF( gLC_Aduio, "FAILED - Differs from golden file, max diff %g, rms diff %g (tolerance %g)\n", maxDiff, rms, snd_render_tolerance );
+}
+
+
+CONCMD_VA( snd_render_scene, "Render a scripted scene of sources moving around the listener offline - snd_render_scene [sources] [seconds] [output.wav] [golden.wav]" )
+{
+	u32         sources = 16;
+	float       seconds = 10.f;
+	const char* outPath = nullptr;
+	const char* golden  = nullptr;
+
+	if ( args.size() > 0 )
+		sources = std::clamp( atoi( args[ 0 ].c_str() ), 1, (int)CH_MAX_VOICES );
+
+	if ( args.size() > 1 )
+		seconds = std::max( (float)atof( args[ 1 ].c_str() ), 0.1f );
+
+	if ( args.size() > 2 )
+		outPath = args[ 2 ].c_str();
+
+	if ( args.size() > 3 )
+		golden = args[ 3 ].c_str();
+
+	Audio_RenderScene( sources, seconds, outPath, golden );
+}
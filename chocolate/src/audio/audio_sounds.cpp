@@ -1,9 +1,7 @@
 #include "audio.h"
 
 
-CONVAR_INT_EXT( snd_audio_stream_available );
 CONVAR_INT_EXT( snd_read_chunk_size );
-CONVAR_FLOAT_EXT( snd_read_mult );
 
 
 bool AudioSystem::LoadSoundInternal( AudioStream* stream )
@@ -18,21 +16,36 @@ bool AudioSystem::LoadSoundInternal( AudioStream* stream )
 	// ret = iplCreatePanningEffect(renderer, g_formatStereo, g_formatStereo, &stream->effect);
 	// ret = iplCreateVirtualSurroundEffect(renderer, g_formatStereo, g_formatStereo, &stream->effect);
 
-	// if ( (!stream->inWorld && stream->channels != 2) || stream->rate != aAudioSpec.freq || stream->format != aAudioSpec.format )
+	// streamed sounds are converted to what the mixer outputs by the decode worker, cached sounds already are
+	if ( stream->codec && !stream->cache )
 	{
-		stream->audioStream = SDL_NewAudioStream( stream->format, stream->channels, stream->rate, aAudioSpec.format, 2, aAudioSpec.freq );
+		stream->audioStream = SDL_NewAudioStream( stream->format, stream->channels, stream->rate, AUDIO_F32, 2, SOUND_RATE );
 		if ( stream->audioStream == nullptr )
 		{
 			Log_ErrorF( gLC_Aduio, "SDL_NewAudioStream failed: %s\n", SDL_GetError() );
 			return false;
 		}
+
+		stream->ring = new AudioStreamRing;
+		stream->readBuffer.reserve( snd_read_chunk_size * std::max< u32 >( stream->channels, 1 ) );
 	}
 
 	// final output audio buffer
-	ret = iplAudioBufferAllocate( aCtx, 2, CH_OUT_BUFFER_SIZE, &stream->outBuffer );
+	ret = iplAudioBufferAllocate( aCtx, 2, FRAME_SIZE, &stream->outBuffer );
 	if ( !HandleIPLErr( ret, "Error creating outBuffer" ) )
 		return false;
 
+	ret = iplAudioBufferAllocate( aCtx, 2, FRAME_SIZE, &stream->spatialIn );
+	if ( !HandleIPLErr( ret, "Error creating spatial input buffer" ) )
+		return false;
+
+	ret = iplAudioBufferAllocate( aCtx, 2, FRAME_SIZE, &stream->spatialMid );
+	if ( !HandleIPLErr( ret, "Error creating spatial mid buffer" ) )
+		return false;
+
+	// allocate the mixer scratch buffer up front, so mixing this stream never allocates
+	stream->mixInput.resize( CH_MIX_BLOCK_SIZE );
+
 	return true;
 }
 
@@ -52,14 +65,8 @@ AudioStream* AudioSystem::GetStream( ch_handle_t streamHandle )
 }
 
 
-// TODO: this preloading does work, but it's only valid for playing it once
-// only because we remove data from it's SDL_AudioStream during playback
-// we'll need to store the audio converted from SDL_AudioStream in a separate location
-// and then store a long for the index in the audio data array for reading audio
-
-// probably have ReadAudio check if we're preloaded or not, if it is,
-// then it returns data from the preload cache instead of reading from the file
-
+// Decode the entire sound into the sound cache, instead of streaming it
+// Sounds shorter than snd_cache_max_length are already cached when opened
 bool AudioSystem::PreloadSound( ch_handle_t sSound )
 {
 	AudioStream* stream = GetStream( sSound );
@@ -67,47 +74,16 @@ bool AudioSystem::PreloadSound( ch_handle_t sSound )
 	if ( !stream )
 		return false;
 
-	while ( true )
-	{
-		ChVector< float > rawAudio;
-		rawAudio.reserve( snd_read_chunk_size );
-
-		long read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
-
-		// should just put silence in the stream if this is true
-		if ( read < 0 )
-			break;
-
-		// End of File
-		if ( read == 0 )
-		{
-			if ( !(stream->aEffects & AudioEffect_Loop) )
-				break;
-
-			if ( !stream->GetInt( EAudio_Loop_Enabled ) )
-				break;
-
-			// go back to the starting point
-			if ( stream->codec->Seek( stream, stream->GetFloat( EAudio_Loop_StartTime ) ) == -1 )
-				return false;  // failed to seek back, stop the sound
-
-			read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
-
-			// should just put silence in the stream if this is true
-			if ( read < 0 )
-				break;
-		}
+	if ( stream->cache )
+		return true;
 
-		// NOTE: "read" NEEDS TO BE 4 TIMES THE AMOUNT FOR SOME REASON, no clue why
-		if ( SDL_AudioStreamPut( stream->audioStream, rawAudio.data(), read * snd_read_mult ) == -1 )
-		{
-			Log_MsgF( gLC_Aduio, "SDL_AudioStreamPut - Failed to put samples in stream: %s\n", SDL_GetError() );
-			return false;
-		}
+	if ( stream->playing )
+	{
+		Log_WarnF( gLC_Aduio, "Can't preload a sound while it's playing: \"%s\"\n", stream->name.c_str() );
+		return false;
 	}
 
-	stream->preloaded = true;
-	return true;
+	return CacheSound( stream );
 }
 
 
@@ -116,17 +92,44 @@ bool AudioSystem::PlaySound( ch_handle_t sStream )
 	if ( sStream == CH_INVALID_HANDLE )
 		return false;
 
-	AudioStream* stream = *aStreams.Get( sStream );
+	ProcessMixerEvents();
 
-	if ( stream == nullptr )
+	AudioStream* stream = nullptr;
+	if ( !aStreams.Get( sStream, &stream ) )
 		return false;
 
-	if ( vec_contains( aStreamsPlaying, sStream ) )
+	if ( stream->playing )
 	{
 		Log_ErrorF( gLC_Aduio, "Sound is already playing: \"%s\"\n", stream->name.c_str() );
 		return true;
 	}
 
+	// every stream handed to the mixer comes back through aMixerEvents, so it can't hold more than that
+	if ( aStreamsPlaying.size() >= CH_AUDIO_CMD_COUNT )
+	{
+		Log_ErrorF( gLC_Aduio, "Too many sounds playing (%u), not playing \"%s\"\n", CH_AUDIO_CMD_COUNT, stream->name.c_str() );
+		return false;
+	}
+
+	AudioCmd cmd{};
+	cmd.type   = EAudioCmd_Play;
+	cmd.handle = sStream;
+	cmd.stream = stream;
+	BuildVoiceParams( stream, cmd.params );
+
+	if ( stream->ring )
+		StartStreaming( stream );
+
+	if ( !PushCommand( cmd ) )
+	{
+		if ( stream->ring )
+			StopStreaming( stream );
+
+		return false;
+	}
+
+	// the mixer and decode worker own the codec and SDL_AudioStream from here until the stream is sent back
+	stream->playing = true;
 	aStreamsPlaying.push_back( sStream );
 	return true;
 }
@@ -137,82 +140,98 @@ void AudioSystem::FreeSound( ch_handle_t sStream )
 	if ( sStream == CH_INVALID_HANDLE )
 		return;
 
-	AudioStream* stream = *aStreams.Get( sStream );
-
-	if ( stream == nullptr )
+	AudioStream* stream = nullptr;
+	if ( !aStreams.Get( sStream, &stream ) )
 		return;
 
-	vec_remove_if( aStreamsPlaying, sStream );
-
-	// TODO: use the memory pool again (though i think i can set it in steam audio?)
-	iplAudioBufferFree( aCtx, &stream->outBuffer );
-
-	//aStreamPool.Free( stream->inBufferAudio );
-	//aStreamPool.Free( stream->midBufferAudio );
-	//aStreamPool.Free( stream->outBufferAudio );
-
-	stream->codec->Close( stream );
+	// the handle is invalid right away, but a playing stream is only destroyed once the mixer is done with it
 	aStreams.Remove( sStream );
-}
-
 
-bool AudioSystem::UpdateStream( AudioStream* stream )
-{
-	if ( !stream->preloaded )
+	if ( !stream->playing )
 	{
-		if ( !ReadAudio( stream ) )
-			return false;
+		DestroyStream( stream );
+		return;
 	}
 
-	if ( !ApplyEffects( stream ) )
-		return false;
+	AudioCmd cmd{};
+	cmd.type   = EAudioCmd_Stop;
+	cmd.handle = sStream;
+	cmd.stream = stream;
 
-	return true;
+	if ( !PushCommand( cmd ) )
+		Log_ErrorF( gLC_Aduio, "Failed to stop sound, leaking it: \"%s\"\n", stream->name.c_str() );
 }
 
 
-bool AudioSystem::ReadAudio( AudioStream* stream )
+// Get the next block of audio for this voice into the stream's mixInput buffer
+// Returns false once the voice has nothing left to play
+bool AudioSystem::ReadAudio( AudioVoice& srVoice, u32& srRead )
 {
-	int read = SDL_AudioStreamAvailable( stream->audioStream );
-	if ( read >= snd_audio_stream_available )
-		return true;
+	AudioStream* stream = srVoice.stream;
+	float*       output = stream->mixInput.data();
 
-	ChVector< float > rawAudio;
-	rawAudio.reserve( snd_read_chunk_size );
+	srRead              = 0;
 
-	read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
+	if ( AudioCachedSound* cached = stream->cache )
+	{
+		bool loop = ( srVoice.params.effects & AudioEffect_Loop ) && srVoice.params.loop;
 
-	// should just put silence in the stream if this is true
-	if ( read < 0 )
-		return true;
+		while ( srRead < CH_MIX_BLOCK_SIZE )
+		{
+			if ( stream->cachePos >= cached->frames )
+			{
+				if ( !loop )
+					break;
 
-	// End of File
-	if ( read == 0 )
-	{
-		if ( !( stream->aEffects & AudioEffect_Loop ) )
-			return false;
+				// go back to the starting point, and don't get stuck on a loop point past the end of the sound
+				u32 loopFrame = std::max( srVoice.params.loopStart, 0.f ) * SOUND_RATE;
+				if ( loopFrame >= cached->frames )
+					break;
 
-		if ( !stream->GetInt( EAudio_Loop_Enabled ) )
-			return false;
+				stream->cachePos = loopFrame;
+			}
+
+			u32 frames = std::min( ( CH_MIX_BLOCK_SIZE - srRead ) / 2, cached->frames - stream->cachePos );
+			memcpy( &output[ srRead ], &cached->data[ stream->cachePos * 2 ], frames * 2 * sizeof( float ) );
 
-		// go back to the starting point
-		if ( stream->codec->Seek( stream, stream->GetFloat( EAudio_Loop_StartTime ) ) == -1 )
-			return false;  // failed to seek back, stop the sound
+			srRead += frames * 2;
+			stream->cachePos += frames;
+		}
+
+		return srRead > 0;
+	}
 
-		read = stream->codec->Read( stream, snd_read_chunk_size, rawAudio );
+	AudioStreamRing* ring = stream->ring;
 
-		// should just put silence in the stream if this is true
-		if ( read < 0 )
+	if ( srVoice.seeking )
+	{
+		// play silence until the decode worker has seeked
+		if ( ring->seekDone.load( std::memory_order_acquire ) != ring->seekRequest.load( std::memory_order_relaxed ) )
 			return true;
+
+		// then throw out everything it decoded before the seek
+		ring->ring.skip( ring->seekTail.load( std::memory_order_relaxed ) - ring->ring.head.load( std::memory_order_relaxed ) );
+		srVoice.seeking = false;
 	}
 
-	// NOTE: "read" NEEDS TO BE 4 TIMES THE AMOUNT FOR SOME REASON, no clue why
-	if ( SDL_AudioStreamPut( stream->audioStream, rawAudio.data(), read * snd_read_mult ) == -1 )
+	u32 available = ring->ring.size();
+	srRead        = ring->ring.read( output, CH_MIX_BLOCK_SIZE );
+
+	if ( srRead < CH_MIX_BLOCK_SIZE )
 	{
-		Log_WarnF( gLC_Aduio, "SDL_AudioStreamPut - Failed to put samples in stream: %s\n", SDL_GetError() );
-		return false;
+		// the worker sets eof after it's last write, so if the ring is empty now, we played everything
+		if ( ring->eof.load( std::memory_order_acquire ) )
+			return srRead > 0 || !ring->ring.empty();
+
+		aStreamStarves.fetch_add( 1, std::memory_order_relaxed );
+		SDL_SemPost( apDecodeWake );
+		return true;
 	}
 
+	// wake up the decode worker when the ring goes under half full
+	if ( available >= CH_STREAM_RING_SIZE / 2 && available - srRead < CH_STREAM_RING_SIZE / 2 )
+		SDL_SemPost( apDecodeWake );
+
 	return true;
 }
 
@@ -228,6 +247,9 @@ bool AudioSystem::IsValid( ch_handle_t stream )
 	if ( stream == CH_INVALID_HANDLE )
 		return false;
 
+	// sounds that finished playing are freed here
+	ProcessMixerEvents();
+
 	return aStreams.Get( stream );
 }
 
@@ -240,6 +262,7 @@ void AudioSystem::SetVolume( ch_handle_t handle, float vol )
 		return;
 
 	stream->vol = vol;
+	SyncVoiceParams( handle, stream );
 }
 
 
@@ -260,7 +283,23 @@ bool AudioSystem::Seek( ch_handle_t streamHandle, double pos )
 	if ( !stream )
 		return false;
 
-	return ( stream->codec->Seek( stream, pos ) == 0 );
+	if ( !stream->playing )
+	{
+		if ( stream->cache )
+		{
+			stream->cachePos = std::min< u32 >( std::max( pos, 0.0 ) * SOUND_RATE, stream->cache->frames );
+			return true;
+		}
+
+		return ( stream->codec->Seek( stream, pos ) == 0 );
+	}
+
+	// the mixer is reading from this stream, so it has to do the seek
+	AudioCmd cmd{};
+	cmd.type    = EAudioCmd_Seek;
+	cmd.handle  = streamHandle;
+	cmd.seekPos = pos;
+	return PushCommand( cmd );
 }
 
 
@@ -272,6 +311,7 @@ void AudioSystem::SetChannel( ch_handle_t handle, ch_handle_t channel )
 		return;
 
 	stream->channel = channel;
+	SyncVoiceParams( handle, stream );
 }
 
 
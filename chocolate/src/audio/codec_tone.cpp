@@ -0,0 +1,95 @@
+#include "codec_tone.h"
+
+#include <math.h>
+
+
+struct CodecToneData
+{
+	float freq;
+	u64   sample;
+};
+
+
+bool CodecTone::Init()
+{
+	return true;
+}
+
+
+bool CodecTone::CheckExt( std::string_view sExt )
+{
+	return false;
+}
+
+
+bool CodecTone::Open( const char* soundPath, AudioStream* stream )
+{
+	CodecToneData* toneData = ch_malloc< CodecToneData >( 1 );
+	toneData->freq          = soundPath ? atof( soundPath ) : 440.f;
+	toneData->sample        = 0;
+
+	if ( toneData->freq <= 0.f )
+		toneData->freq = 440.f;
+
+	stream->data     = toneData;
+	stream->rate     = SOUND_RATE;
+	stream->channels = 1;
+	stream->format   = AUDIO_F32;
+	stream->bits     = 32;
+	stream->width    = 4;
+
+	// one second long, so it can be cached and looped
+	stream->totalFrames = SOUND_RATE;
+
+	return true;
+}
+
+
+long CodecTone::Read( AudioStream* stream, size_t size, ChVector< float >& data )
+{
+	CodecToneData* toneData = (CodecToneData*)stream->data;
+
+	if ( toneData->sample >= stream->totalFrames )
+		return 0;
+
+	size           = std::min< size_t >( size, stream->totalFrames - toneData->sample );
+	u32 start      = data.size();
+	data.resize( start + size );
+
+	// keep it under 1.0 so a few of these mixed together don't clip too much
+	double step = 2.0 * M_PI * toneData->freq / SOUND_RATE;
+	for ( size_t i = 0; i < size; i++ )
+		data[ start + i ] = 0.25f * (float)sin( fmod( step * toneData->sample++, 2.0 * M_PI ) );
+
+	return size;
+}
+
+
+int CodecTone::Seek( AudioStream* stream, double pos )
+{
+	CodecToneData* toneData = (CodecToneData*)stream->data;
+	toneData->sample        = pos * SOUND_RATE;
+	return 0;
+}
+
+
+void CodecTone::Close( AudioStream* stream )
+{
+	free( stream->data );
+	stream->data = nullptr;
+}
+
+
+CodecTone* Audio_GetToneCodec()
+{
+	static CodecTone* codec = nullptr;
+
+	if ( !codec )
+	{
+		codec          = new CodecTone;
+		codec->apAudio = audio;
+		codec->Init();
+	}
+
+	return codec;
+}
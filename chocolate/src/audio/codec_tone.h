@@ -0,0 +1,25 @@
+#pragma once
+
+#include "audio.h"
+
+// Generates a sine wave instead of reading a file, used for benchmarks and offline rendering
+// Never picked for files, you have to open streams with it yourself
+class CodecTone : public IAudioCodec
+{
+  protected:
+	virtual ~CodecTone() = default;
+
+  public:
+	virtual bool        Init() override;
+	virtual const char* GetName() override { return "Tone Generator"; }
+	virtual bool        CheckExt( std::string_view sExt ) override;
+
+	// soundPath is the frequency of the tone in hz, ex. "440", the tone is one second long
+	virtual bool        Open( const char* soundPath, AudioStream* stream ) override;
+	virtual long        Read( AudioStream* stream, size_t size, ChVector< float >& data ) override;
+	virtual int         Seek( AudioStream* stream, double pos ) override;
+	virtual void        Close( AudioStream* stream ) override;
+};
+
+
+CodecTone* Audio_GetToneCodec();
@@ -1,8 +1,10 @@
 #include "codec_vorbis.h"
 
 #include "core/util.h"
+#include "core/async_io.h"
 
 #include <SDL2/SDL.h>
+#include <cerrno>
 #include <filesystem>
 
 #if ENABLE_VORBIS
@@ -13,15 +15,199 @@
 
 LOG_CHANNEL_REGISTER( Vorbis, ELogColor_Green );
 
+// Files bigger than this are read in three parts, the start and end of the file, which is all opening it needs,
+// and the rest in the background, which isn't waited on until it's decoded
+constexpr u64 CH_VORBIS_EDGE_SIZE = 64 * 1024;
+
+enum EVorbisRead
+{
+	EVorbisRead_Head,
+	EVorbisRead_Tail,
+	EVorbisRead_Body,
+
+	EVorbisRead_Count,
+};
+
 struct CodecVorbisData
 {
-	OggVorbis_File* oggFile = nullptr;
-	FILE*           file    = nullptr;
-	float**         buffer  = nullptr;
-	long            result  = 0;
+	OggVorbis_File*     oggFile  = nullptr;
+	char*               file     = nullptr;  // the whole encoded file, read through async io
+	u64                 size     = 0;
+	u64                 pos      = 0;
+	float**             buffer   = nullptr;
+	long                result   = 0;
+
+	ch_async_io_request reads[ EVorbisRead_Count ];
+	u32                 readCount = 0;
+	ch_async_io_fence   readFence;
 };
 
 
+// Wait for the reads covering this part of the file, a size of 0 waits for all of it
+// Returns false if any of them failed
+static bool vorbis_wait_range( CodecVorbisData* spData, u64 sOffset, u64 sSize )
+{
+	for ( u32 i = 0; i < spData->readCount; i++ )
+	{
+		ch_async_io_request& read = spData->reads[ i ];
+
+		// skip reads that don't overlap, a read with a size of 0 is the whole file
+		bool wholeFile = read.aSize == 0 || sSize == 0;
+
+		if ( !wholeFile && ( sOffset >= read.aOffset + read.aSize || sOffset + sSize <= read.aOffset ) )
+			continue;
+
+		AsyncIO_Wait( &read );
+
+		if ( read.aResult != EAsyncIOResult_Success )
+			return false;
+	}
+
+	// we didn't know the size of it until the read finished
+	if ( spData->readCount == 1 )
+	{
+		spData->file = spData->reads[ 0 ].apBuffer;
+		spData->size = spData->reads[ 0 ].aBytesRead;
+	}
+
+	return true;
+}
+
+
+// ov callbacks for decoding from the file in memory
+static size_t vorbis_mem_read( void* spDst, size_t sSize, size_t sCount, void* spData )
+{
+	CodecVorbisData* vorbisData = (CodecVorbisData*)spData;
+
+	if ( sSize == 0 )
+		return 0;
+
+	if ( !vorbis_wait_range( vorbisData, vorbisData->pos, sSize * sCount ) )
+	{
+		// vorbisfile treats a read of 0 with errno set as a read error, instead of the end of the file
+		errno = EIO;
+		return 0;
+	}
+
+	size_t count = std::min< u64 >( sCount, ( vorbisData->size - vorbisData->pos ) / sSize );
+	memcpy( spDst, vorbisData->file + vorbisData->pos, count * sSize );
+	vorbisData->pos += count * sSize;
+
+	return count;
+}
+
+
+static int vorbis_mem_seek( void* spData, ogg_int64_t sOffset, int sWhence )
+{
+	CodecVorbisData* vorbisData = (CodecVorbisData*)spData;
+	ogg_int64_t      pos        = sOffset;
+
+	// need the size of the file for this, which we only know up front if the read was split up
+	if ( sWhence == SEEK_END && !vorbisData->file && !vorbis_wait_range( vorbisData, 0, 0 ) )
+		return -1;
+
+	if ( sWhence == SEEK_CUR )
+		pos += vorbisData->pos;
+
+	else if ( sWhence == SEEK_END )
+		pos += vorbisData->size;
+
+	if ( pos < 0 || pos > (ogg_int64_t)vorbisData->size )
+		return -1;
+
+	vorbisData->pos = pos;
+	return 0;
+}
+
+
+static long vorbis_mem_tell( void* spData )
+{
+	return (long)( (CodecVorbisData*)spData )->pos;
+}
+
+
+static ov_callbacks g_vorbis_mem_callbacks = { vorbis_mem_read, vorbis_mem_seek, nullptr, vorbis_mem_tell };
+
+
+static void vorbis_free( CodecVorbisData* spData )
+{
+	if ( spData->oggFile )
+	{
+		ov_clear( spData->oggFile );
+		ch_free( spData->oggFile );
+	}
+
+	// the reads are still writing to the buffer
+	AsyncIO_WaitFence( spData->readFence );
+
+	if ( spData->readCount == 1 )
+		ch_free( spData->reads[ 0 ].apBuffer );
+	else
+		ch_free( spData->file );
+
+	delete spData;
+}
+
+
+// Start reading the file, opening it only waits on the parts it needs
+static bool vorbis_read_file( CodecVorbisData* spData, const char* spPath )
+{
+	// this is only used to split up the read, paks or anything else we can't get the size of here are read in one go
+	std::error_code ec;
+	u64             fileSize = std::filesystem::file_size( spPath, ec );
+
+	if ( ec || fileSize <= CH_VORBIS_EDGE_SIZE * 2 )
+		fileSize = 0;
+
+	// someone is waiting on this sound, so get the parts needed to open it in front of any prefetching
+	if ( fileSize == 0 )
+	{
+		spData->readCount = 1;
+		spData->reads[ 0 ].aPriority = EAsyncIOPriority_High;
+	}
+	else
+	{
+		spData->file      = ch_malloc< char >( fileSize );
+		spData->size      = fileSize;
+		spData->readCount = EVorbisRead_Count;
+
+		spData->reads[ EVorbisRead_Head ].aOffset   = 0;
+		spData->reads[ EVorbisRead_Head ].aSize     = CH_VORBIS_EDGE_SIZE;
+		spData->reads[ EVorbisRead_Head ].aPriority = EAsyncIOPriority_High;
+
+		spData->reads[ EVorbisRead_Tail ].aOffset   = fileSize - CH_VORBIS_EDGE_SIZE;
+		spData->reads[ EVorbisRead_Tail ].aSize     = CH_VORBIS_EDGE_SIZE;
+		spData->reads[ EVorbisRead_Tail ].aPriority = EAsyncIOPriority_High;
+
+		spData->reads[ EVorbisRead_Body ].aOffset   = CH_VORBIS_EDGE_SIZE;
+		spData->reads[ EVorbisRead_Body ].aSize     = fileSize - CH_VORBIS_EDGE_SIZE * 2;
+		spData->reads[ EVorbisRead_Body ].aPriority = EAsyncIOPriority_Normal;
+	}
+
+	ch_async_io_request* reads[ EVorbisRead_Count ];
+
+	for ( u32 i = 0; i < spData->readCount; i++ )
+	{
+		ch_async_io_request& read = spData->reads[ i ];
+		read.apPath               = spPath;
+		read.aPathType            = ESearchPathType_Path;
+		read.apFence              = &spData->readFence;
+
+		if ( spData->file )
+			read.apBuffer = spData->file + read.aOffset;
+
+		reads[ i ] = &read;
+	}
+
+	if ( AsyncIO_SubmitBatch( reads, spData->readCount ) == spData->readCount )
+		return true;
+
+	// don't use any of it, but vorbis_free waits on whatever did get submitted
+	spData->readCount = 0;
+	return false;
+}
+
+
 bool CodecVorbis::Init()
 {
 	return true;
@@ -36,28 +222,38 @@ bool CodecVorbis::CheckExt( std::string_view sExt )
 
 bool CodecVorbis::Open( const char* soundPath, AudioStream* stream )
 {
-	FILE* soundFileHandle = fopen( soundPath, "rb" );
-	if ( !soundFileHandle )
+	CodecVorbisData* vorbisData = new CodecVorbisData;
+	vorbisData->oggFile         = ch_calloc< OggVorbis_File >( 1 );
+
+	if ( !vorbis_read_file( vorbisData, soundPath ) )
 	{
-		Log_MsgF( gLC_Vorbis, "File does not exist: \"%s\"\n", soundPath );
+		ch_free( vorbisData->oggFile );
+		vorbisData->oggFile = nullptr;
+		vorbis_free( vorbisData );
 		return false;
 	}
 
-	OggVorbis_File* oggFile = ch_malloc< OggVorbis_File >( 1 );
+	OggVorbis_File* oggFile     = vorbisData->oggFile;
 	vorbis_info*    ovfInfo;
 
 	// check if valid
-	if ( ov_open_callbacks( soundFileHandle, oggFile, NULL, 0, OV_CALLBACKS_NOCLOSE ) < 0 )
+	if ( ov_open_callbacks( vorbisData, oggFile, NULL, 0, g_vorbis_mem_callbacks ) < 0 )
 	{
-		Log_MsgF( gLC_Vorbis, "Not a valid ogg file: \"%s\"\n", soundPath );
-		ov_clear( oggFile );
+		if ( vorbis_wait_range( vorbisData, 0, 0 ) )
+			Log_MsgF( gLC_Vorbis, "Not a valid ogg file: \"%s\"\n", soundPath );
+		else
+			Log_MsgF( gLC_Vorbis, "Failed to read file: \"%s\"\n", soundPath );
+
+		ch_free( vorbisData->oggFile );
+		vorbisData->oggFile = nullptr;
+		vorbis_free( vorbisData );
 		return false;
 	}
 
 	if ( !ov_seekable( oggFile ) )
 	{
 		Log_MsgF( gLC_Vorbis, "Stream not seekable: \"%s\"\n", soundPath );
-		ov_clear( oggFile );
+		vorbis_free( vorbisData );
 		return false;
 	}
 
@@ -65,7 +261,7 @@ bool CodecVorbis::Open( const char* soundPath, AudioStream* stream )
 	if ( !ovfInfo )
 	{
 		Log_MsgF( gLC_Vorbis, "Unable to get stream info: \"%s\".\n", soundPath );
-		ov_clear( oggFile );
+		vorbis_free( vorbisData );
 		return false;
 	}
 
@@ -73,21 +269,18 @@ bool CodecVorbis::Open( const char* soundPath, AudioStream* stream )
 	if ( numStreams != 1 )
 	{
 		Log_MsgF( gLC_Vorbis, "More than one (%s) stream in \"%s\".\n", numStreams, stream->name.c_str() );
-		ov_clear( oggFile );
+		vorbis_free( vorbisData );
 		return false;
 	}
 
-	CodecVorbisData* vorbisData = ch_malloc< CodecVorbisData >( 1 );
-	vorbisData->file            = soundFileHandle;
-	vorbisData->oggFile         = oggFile;
-	vorbisData->buffer          = nullptr;
-	vorbisData->result          = 0;
-
 	stream->data                = (void*)vorbisData;
 	stream->rate                = ovfInfo->rate;
 	stream->channels            = ovfInfo->channels;
 	stream->bits                = 16;
 	stream->width               = 2;
+
+	ogg_int64_t totalFrames     = ov_pcm_total( oggFile, -1 );
+	stream->totalFrames         = totalFrames > 0 ? totalFrames : 0;
 	//stream->frameSize = stream->channels * 32;  // Float 32
 	//stream->format = AUDIO_S16;
 
@@ -205,8 +398,7 @@ int CodecVorbis::Seek( AudioStream* stream, double pos )
 void CodecVorbis::Close( AudioStream* stream )
 {
 	CodecVorbisData* vorbisData = (CodecVorbisData*)stream->data;
-	ov_clear( vorbisData->oggFile );
-	fclose( vorbisData->file );
+	vorbis_free( vorbisData );
 }
 
 #endif
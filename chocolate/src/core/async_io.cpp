@@ -0,0 +1,979 @@
+#include "core/async_io.h"
+#include "core/console.h"
+#include "core/profiler.h"
+#include "core/log.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+	#include <io.h>
+
+	#define close _close
+	#define fstat _fstat64
+	#define stat  _stat64
+#else
+	#include <unistd.h>
+	#include <string.h>
+#endif
+
+#if defined( __linux__ ) && __has_include( <linux/io_uring.h> )
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+
+	#define CH_IO_URING 1
+#else
+	#define CH_IO_URING 0
+#endif
+
+
+LOG_CHANNEL( FileSystem );
+
+CONVAR_RANGE_INT( io_threads, 2, 1, 16, "Number of threads for async file I/O, takes effect on restart" );
+CONVAR_BOOL( io_uring, true, "Use io_uring for async file I/O on linux if it's available, takes effect on restart" );
+CONVAR_RANGE_INT( io_uring_depth, 128, 8, 4096, "Max number of io_uring reads in flight at once, takes effect on restart" );
+
+// max size of a single read call, larger reads are split up
+constexpr u64 IO_MAX_READ_SIZE = 1 << 30;
+
+// max requests an I/O thread prepares before submitting them to io_uring together
+constexpr u32 IO_MAX_BATCH     = 32;
+
+
+// ----------------------------------------------------------------
+// Requests are queued by priority, and picked up by the I/O threads, which find the file, open it, and allocate the buffer
+// Without io_uring, the I/O thread reads the file too, with io_uring, it submits the reads to the ring in batches,
+// and the ring thread waits on completions and finishes the requests
+
+struct io_queue_t
+{
+	ch_async_io_request* apHead = nullptr;
+	ch_async_io_request* apTail = nullptr;
+};
+
+static io_queue_t                  g_io_queue[ EAsyncIOPriority_Count ];
+static std::mutex                  g_io_mutex;
+static std::condition_variable     g_io_cond;
+static std::mutex                  g_io_done_mutex;
+static std::condition_variable     g_io_done_cond;  // signaled when any request or fence finishes
+static std::vector< std::thread* > g_io_threads;
+static bool                        g_io_running = false;
+
+static std::atomic< u64 >          g_io_stat_completed = 0;
+static std::atomic< u64 >          g_io_stat_failed    = 0;
+static std::atomic< u64 >          g_io_stat_bytes     = 0;
+static std::atomic< u32 >          g_io_stat_pending   = 0;
+
+#if CH_IO_URING
+struct io_ring_t
+{
+	int                     aFd       = -1;
+	u32                     aEntries  = 0;
+	u32                     aInFlight = 0;  // guarded by g_io_ring_mutex
+
+	u32*                    apSqHead  = nullptr;
+	u32*                    apSqTail  = nullptr;
+	u32*                    apSqMask  = nullptr;
+	u32*                    apSqArray = nullptr;
+	io_uring_sqe*           apSqes    = nullptr;
+
+	u32*                    apCqHead  = nullptr;
+	u32*                    apCqTail  = nullptr;
+	u32*                    apCqMask  = nullptr;
+	io_uring_cqe*           apCqes    = nullptr;
+
+	void*                   apSqPtr   = nullptr;
+	size_t                  aSqSize   = 0;
+	void*                   apCqPtr   = nullptr;
+	size_t                  aCqSize   = 0;
+	size_t                  aSqesSize = 0;
+};
+
+static io_ring_t               g_io_ring;
+static std::mutex              g_io_ring_mutex;
+static std::condition_variable g_io_ring_cond;  // signaled when reads finish, for threads waiting on a full ring
+static std::thread*            g_io_ring_thread = nullptr;
+static bool                    g_io_ring_stop   = false;
+
+// reads submitted to the ring, so they can be failed if the ring stops working, guarded by g_io_ring_mutex
+static std::unordered_set< ch_async_io_request* > g_io_ring_requests;
+
+// io_uring_enter failed while waiting for completions, everything goes through the I/O threads after this
+static std::atomic< bool >     g_io_ring_dead   = false;
+#endif
+
+
+// Are reads submitted to io_uring, or read on the I/O threads
+static bool asyncio_ring_active()
+{
+#if CH_IO_URING
+	return g_io_ring.aFd != -1 && !g_io_ring_dead.load( std::memory_order_acquire );
+#else
+	return false;
+#endif
+}
+
+
+static void asyncio_start();
+
+
+// ----------------------------------------------------------------
+// Finishing Requests
+
+
+static void asyncio_finish( ch_async_io_request* spRequest, EAsyncIOResult sResult )
+{
+	if ( spRequest->aFile != -1 )
+	{
+		close( spRequest->aFile );
+		spRequest->aFile = -1;
+	}
+
+	ch_str_free( spRequest->aFullPath );
+	spRequest->aFullPath = {};
+
+	if ( sResult == EAsyncIOResult_Success )
+	{
+		g_io_stat_completed++;
+		g_io_stat_bytes += spRequest->aBytesRead;
+
+		// null terminate buffers we allocated, so text files can be used directly
+		if ( spRequest->aAllocBuffer )
+			spRequest->apBuffer[ spRequest->aBytesRead ] = '\0';
+	}
+	else
+	{
+		g_io_stat_failed++;
+
+		if ( spRequest->aAllocBuffer )
+		{
+			ch_free( spRequest->apBuffer );
+			spRequest->apBuffer = nullptr;
+		}
+	}
+
+	g_io_stat_pending--;
+
+	// grab these first, the callback can free the request
+	ch_async_io_fence*     fence    = spRequest->apFence;
+	fn_async_io_complete_t callback = spRequest->apCallback;
+
+	if ( callback )
+	{
+		spRequest->aResult.store( sResult, std::memory_order_release );
+		callback( spRequest );
+	}
+
+	// a waiter can free the request or fence as soon as it sees it finished, so publish it under the lock
+	// and wake them with our own condition variable, never touching either of them after this
+	{
+		std::lock_guard< std::mutex > lock( g_io_done_mutex );
+
+		if ( !callback )
+			spRequest->aResult.store( sResult, std::memory_order_release );
+
+		if ( fence )
+			fence->aPending.fetch_sub( 1, std::memory_order_acq_rel );
+	}
+
+	g_io_done_cond.notify_all();
+}
+
+
+// ----------------------------------------------------------------
+// Preparing Requests - I/O Threads
+
+
+static bool asyncio_check_range( ch_async_io_request* spRequest, u64 sFileSize )
+{
+	if ( spRequest->aOffset > sFileSize || ( spRequest->aSize && spRequest->aSize > sFileSize - spRequest->aOffset ) )
+	{
+		Log_ErrorF( gLC_FileSystem, "Async read of %llu bytes at offset %llu is past the end of the file (%llu bytes): %s\n",
+		            spRequest->aSize, spRequest->aOffset, sFileSize, spRequest->aFullPath.data );
+		return false;
+	}
+
+	spRequest->aReadSize = spRequest->aSize ? spRequest->aSize : sFileSize - spRequest->aOffset;
+
+	if ( !spRequest->apBuffer )
+	{
+		spRequest->apBuffer     = ch_malloc< char >( spRequest->aReadSize + 1 );
+		spRequest->aAllocBuffer = true;
+	}
+
+	return true;
+}
+
+
+// Files in paks are already mapped, so they're copied out of the pak right here
+static void asyncio_read_pak( ch_async_io_request* spRequest )
+{
+	ch_file_view view = FileSys_OpenView( spRequest->aFullPath.data, spRequest->aFullPath.size );
+
+	if ( !view.data || !asyncio_check_range( spRequest, view.size ) )
+	{
+		FileSys_CloseView( view );
+		asyncio_finish( spRequest, EAsyncIOResult_Failed );
+		return;
+	}
+
+	memcpy( spRequest->apBuffer, view.data + spRequest->aOffset, spRequest->aReadSize );
+	spRequest->aBytesRead = spRequest->aReadSize;
+
+	FileSys_CloseView( view );
+	asyncio_finish( spRequest, EAsyncIOResult_Success );
+}
+
+
+// Find and open the file and allocate the buffer, returns false if the request is already finished
+static bool asyncio_prepare( ch_async_io_request* spRequest )
+{
+	PROF_SCOPE();
+
+	spRequest->aFullPath = FileSys_FindFileEx( spRequest->apPath, -1, spRequest->aPathType );
+
+	if ( !spRequest->aFullPath.data )
+	{
+		asyncio_finish( spRequest, EAsyncIOResult_NotFound );
+		return false;
+	}
+
+	if ( FileSys_IsInPak( spRequest->aFullPath.data, spRequest->aFullPath.size ) )
+	{
+		asyncio_read_pak( spRequest );
+		return false;
+	}
+
+#ifdef _WIN32
+	spRequest->aFile = _open( spRequest->aFullPath.data, _O_RDONLY | _O_BINARY );
+#else
+	spRequest->aFile = open( spRequest->aFullPath.data, O_RDONLY | O_CLOEXEC );
+#endif
+
+	struct stat s;
+	if ( spRequest->aFile == -1 || fstat( spRequest->aFile, &s ) != 0 )
+	{
+		Log_ErrorF( gLC_FileSystem, "Failed to open file for async read: %s\n", spRequest->aFullPath.data );
+		asyncio_finish( spRequest, EAsyncIOResult_Failed );
+		return false;
+	}
+
+	if ( !asyncio_check_range( spRequest, s.st_size ) )
+	{
+		asyncio_finish( spRequest, EAsyncIOResult_Failed );
+		return false;
+	}
+
+	return true;
+}
+
+
+// Read the whole request on this thread
+static void asyncio_read_blocking( ch_async_io_request* spRequest )
+{
+	PROF_SCOPE();
+
+#ifdef _WIN32
+	if ( _lseeki64( spRequest->aFile, spRequest->aOffset, SEEK_SET ) == -1 )
+	{
+		asyncio_finish( spRequest, EAsyncIOResult_Failed );
+		return;
+	}
+#endif
+
+	while ( spRequest->aBytesRead < spRequest->aReadSize )
+	{
+		u64 amount = std::min( spRequest->aReadSize - spRequest->aBytesRead, IO_MAX_READ_SIZE );
+
+#ifdef _WIN32
+		s64 result = _read( spRequest->aFile, spRequest->apBuffer + spRequest->aBytesRead, (unsigned int)amount );
+#else
+		s64 result = pread( spRequest->aFile, spRequest->apBuffer + spRequest->aBytesRead, amount, spRequest->aOffset + spRequest->aBytesRead );
+
+		if ( result < 0 && errno == EINTR )
+			continue;
+#endif
+
+		// the file got smaller, or the read failed
+		if ( result <= 0 )
+		{
+			Log_ErrorF( gLC_FileSystem, "Failed to read file: %s\n", spRequest->aFullPath.data );
+			asyncio_finish( spRequest, EAsyncIOResult_Failed );
+			return;
+		}
+
+		spRequest->aBytesRead += result;
+	}
+
+	asyncio_finish( spRequest, EAsyncIOResult_Success );
+}
+
+
+// ----------------------------------------------------------------
+// io_uring
+// liburing isn't available everywhere, and we only need reads, so this uses the syscalls directly
+
+
+#if CH_IO_URING
+static bool asyncio_ring_init( u32 sDepth )
+{
+	io_ring_t&      ring = g_io_ring;
+	io_uring_params params{};
+
+	ring.aFd = (int)syscall( __NR_io_uring_setup, sDepth, &params );
+
+	if ( ring.aFd < 0 )
+	{
+		Log_DevF( gLC_FileSystem, 1, "io_uring not available, using I/O threads for async file I/O - %s\n", strerror( errno ) );
+		ring.aFd = -1;
+		return false;
+	}
+
+	// IORING_OP_READ came in the same kernel version as this
+	if ( !( params.features & IORING_FEAT_RW_CUR_POS ) )
+	{
+		Log_DevF( gLC_FileSystem, 1, "io_uring is too old, using I/O threads for async file I/O\n" );
+		close( ring.aFd );
+		ring.aFd = -1;
+		return false;
+	}
+
+	ring.aSqSize   = params.sq_off.array + params.sq_entries * sizeof( u32 );
+	ring.aCqSize   = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+	ring.aSqesSize = params.sq_entries * sizeof( io_uring_sqe );
+
+	bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+	if ( singleMap )
+		ring.aSqSize = ring.aCqSize = std::max( ring.aSqSize, ring.aCqSize );
+
+	ring.apSqPtr = mmap( nullptr, ring.aSqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.aFd, IORING_OFF_SQ_RING );
+	ring.apCqPtr = singleMap ? ring.apSqPtr : mmap( nullptr, ring.aCqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.aFd, IORING_OFF_CQ_RING );
+	void* sqes   = mmap( nullptr, ring.aSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.aFd, IORING_OFF_SQES );
+
+	if ( ring.apSqPtr == MAP_FAILED || ring.apCqPtr == MAP_FAILED || sqes == MAP_FAILED )
+	{
+		Log_WarnF( gLC_FileSystem, "Failed to map io_uring, using I/O threads for async file I/O\n" );
+
+		if ( ring.apSqPtr != MAP_FAILED )
+			munmap( ring.apSqPtr, ring.aSqSize );
+
+		if ( !singleMap && ring.apCqPtr != MAP_FAILED )
+			munmap( ring.apCqPtr, ring.aCqSize );
+
+		if ( sqes != MAP_FAILED )
+			munmap( sqes, ring.aSqesSize );
+
+		close( ring.aFd );
+		ring = {};
+		return false;
+	}
+
+	char* sq       = (char*)ring.apSqPtr;
+	char* cq       = (char*)ring.apCqPtr;
+
+	ring.apSqHead  = (u32*)( sq + params.sq_off.head );
+	ring.apSqTail  = (u32*)( sq + params.sq_off.tail );
+	ring.apSqMask  = (u32*)( sq + params.sq_off.ring_mask );
+	ring.apSqArray = (u32*)( sq + params.sq_off.array );
+	ring.apSqes    = (io_uring_sqe*)sqes;
+
+	ring.apCqHead  = (u32*)( cq + params.cq_off.head );
+	ring.apCqTail  = (u32*)( cq + params.cq_off.tail );
+	ring.apCqMask  = (u32*)( cq + params.cq_off.ring_mask );
+	ring.apCqes    = (io_uring_cqe*)( cq + params.cq_off.cqes );
+
+	// don't let more reads be in flight than the completion queue can hold
+	ring.aEntries  = std::min( params.sq_entries, params.cq_entries );
+
+	return true;
+}
+
+
+static void asyncio_ring_free()
+{
+	io_ring_t& ring = g_io_ring;
+
+	if ( ring.aFd == -1 )
+		return;
+
+	munmap( ring.apSqes, ring.aSqesSize );
+	munmap( ring.apSqPtr, ring.aSqSize );
+
+	if ( ring.apCqPtr != ring.apSqPtr )
+		munmap( ring.apCqPtr, ring.aCqSize );
+
+	close( ring.aFd );
+	ring = {};
+}
+
+
+// g_io_ring_mutex must be locked, and there must be room in the ring
+static void asyncio_ring_queue_read( ch_async_io_request* spRequest )
+{
+	io_ring_t&    ring = g_io_ring;
+	u32           tail = *ring.apSqTail;
+	u32           idx  = tail & *ring.apSqMask;
+	io_uring_sqe* sqe  = &ring.apSqes[ idx ];
+
+	memset( sqe, 0, sizeof( io_uring_sqe ) );
+	sqe->opcode    = IORING_OP_READ;
+	sqe->fd        = spRequest->aFile;
+	sqe->addr      = (u64)( spRequest->apBuffer + spRequest->aBytesRead );
+	sqe->len       = (u32)std::min( spRequest->aReadSize - spRequest->aBytesRead, IO_MAX_READ_SIZE );
+	sqe->off       = spRequest->aOffset + spRequest->aBytesRead;
+	sqe->user_data = (u64)spRequest;
+
+	ring.apSqArray[ idx ] = idx;
+	__atomic_store_n( ring.apSqTail, tail + 1, __ATOMIC_RELEASE );
+	ring.aInFlight++;
+
+	g_io_ring_requests.insert( spRequest );
+}
+
+
+// g_io_ring_mutex must be locked, wakes up the ring thread with a request of nullptr
+static void asyncio_ring_queue_nop()
+{
+	io_ring_t&    ring = g_io_ring;
+	u32           tail = *ring.apSqTail;
+	u32           idx  = tail & *ring.apSqMask;
+	io_uring_sqe* sqe  = &ring.apSqes[ idx ];
+
+	memset( sqe, 0, sizeof( io_uring_sqe ) );
+	sqe->opcode           = IORING_OP_NOP;
+	sqe->user_data        = 0;
+
+	ring.apSqArray[ idx ] = idx;
+	__atomic_store_n( ring.apSqTail, tail + 1, __ATOMIC_RELEASE );
+	ring.aInFlight++;
+}
+
+
+// g_io_ring_mutex must be locked
+// Takes back everything queued that the kernel hasn't picked up yet, and adds the requests to srFailed
+static void asyncio_ring_unqueue( std::vector< ch_async_io_request* >& srFailed )
+{
+	io_ring_t& ring = g_io_ring;
+	u32        head = __atomic_load_n( ring.apSqHead, __ATOMIC_ACQUIRE );
+	u32        tail = *ring.apSqTail;
+
+	for ( u32 i = head; i != tail; i++ )
+	{
+		io_uring_sqe*        sqe     = &ring.apSqes[ ring.apSqArray[ i & *ring.apSqMask ] ];
+		ch_async_io_request* request = (ch_async_io_request*)sqe->user_data;
+
+		ring.aInFlight--;
+
+		if ( !request )
+			continue;
+
+		g_io_ring_requests.erase( request );
+		srFailed.push_back( request );
+	}
+
+	// without SQPOLL the kernel only reads the queue in io_uring_enter, so it's safe to move the tail back
+	__atomic_store_n( ring.apSqTail, head, __ATOMIC_RELEASE );
+}
+
+
+// g_io_ring_mutex must be locked
+// Returns false if the kernel wouldn't take them, the requests that weren't submitted are added to srFailed,
+// the caller finishes them after unlocking
+static bool asyncio_ring_submit( u32 sCount, std::vector< ch_async_io_request* >& srFailed )
+{
+	while ( sCount > 0 )
+	{
+		int result = (int)syscall( __NR_io_uring_enter, g_io_ring.aFd, sCount, 0, 0, nullptr, 0 );
+
+		if ( result < 0 )
+		{
+			if ( errno == EINTR || errno == EAGAIN || errno == EBUSY )
+				continue;
+
+			Log_ErrorF( gLC_FileSystem, "io_uring_enter failed - %s\n", strerror( errno ) );
+			asyncio_ring_unqueue( srFailed );
+			g_io_ring_cond.notify_all();
+			return false;
+		}
+
+		sCount -= result;
+	}
+
+	return true;
+}
+
+
+// The ring can't wait for completions anymore, fail everything in it and use the I/O threads from now on
+static void asyncio_ring_kill()
+{
+	std::vector< ch_async_io_request* > failed;
+
+	{
+		std::unique_lock< std::mutex > lock( g_io_ring_mutex );
+
+		g_io_ring_dead.store( true, std::memory_order_release );
+		failed.assign( g_io_ring_requests.begin(), g_io_ring_requests.end() );
+
+		g_io_ring_requests.clear();
+		g_io_ring.aInFlight = 0;
+	}
+
+	g_io_ring_cond.notify_all();
+
+	for ( ch_async_io_request* request : failed )
+		asyncio_finish( request, EAsyncIOResult_Failed );
+}
+
+
+// Submit all the prepared requests in one call, waiting for room in the ring if needed
+// If the ring stops working while waiting, the rest are read on this thread
+static void asyncio_ring_submit_batch( ch_async_io_request** spRequests, u32 sCount )
+{
+	PROF_SCOPE();
+
+	std::vector< ch_async_io_request* > failed;
+	u32                                 fallback = sCount;
+
+	{
+		std::unique_lock< std::mutex > lock( g_io_ring_mutex );
+
+		u32 queued = 0;
+
+		for ( u32 i = 0; i < sCount; i++ )
+		{
+			if ( !g_io_ring_dead && g_io_ring.aInFlight >= g_io_ring.aEntries )
+			{
+				asyncio_ring_submit( queued, failed );
+				queued = 0;
+
+				g_io_ring_cond.wait( lock, []() { return g_io_ring_dead || g_io_ring.aInFlight < g_io_ring.aEntries; } );
+			}
+
+			if ( g_io_ring_dead )
+			{
+				fallback = i;
+				break;
+			}
+
+			asyncio_ring_queue_read( spRequests[ i ] );
+			queued++;
+		}
+
+		asyncio_ring_submit( queued, failed );
+	}
+
+	for ( ch_async_io_request* request : failed )
+		asyncio_finish( request, EAsyncIOResult_Failed );
+
+	for ( u32 i = fallback; i < sCount; i++ )
+		asyncio_read_blocking( spRequests[ i ] );
+}
+
+
+static void asyncio_ring_thread()
+{
+	io_ring_t& ring = g_io_ring;
+
+	while ( true )
+	{
+		int result = (int)syscall( __NR_io_uring_enter, ring.aFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0 );
+
+		if ( result < 0 && errno != EINTR && errno != EAGAIN )
+		{
+			Log_ErrorF( gLC_FileSystem, "io_uring_enter failed while waiting, using I/O threads from now on - %s\n", strerror( errno ) );
+			asyncio_ring_kill();
+			break;
+		}
+
+		std::unique_lock< std::mutex > lock( g_io_ring_mutex );
+
+		// everything in flight was already failed
+		if ( g_io_ring_dead )
+			break;
+
+		u32  head     = *ring.apCqHead;
+		u32  tail     = __atomic_load_n( ring.apCqTail, __ATOMIC_ACQUIRE );
+		u32  resubmit = 0;
+
+		std::vector< std::pair< ch_async_io_request*, EAsyncIOResult > > finished;
+
+		for ( ; head != tail; head++ )
+		{
+			io_uring_cqe*        cqe     = &ring.apCqes[ head & *ring.apCqMask ];
+			ch_async_io_request* request = (ch_async_io_request*)cqe->user_data;
+
+			ring.aInFlight--;
+
+			// woken up to shut down
+			if ( !request )
+				continue;
+
+			if ( cqe->res == -EINTR || cqe->res == -EAGAIN )
+			{
+				asyncio_ring_queue_read( request );
+				resubmit++;
+				continue;
+			}
+
+			if ( cqe->res <= 0 )
+			{
+				Log_ErrorF( gLC_FileSystem, "Failed to read file: %s - %s\n", request->aFullPath.data, cqe->res ? strerror( -cqe->res ) : "Unexpected end of file" );
+				g_io_ring_requests.erase( request );
+				finished.emplace_back( request, EAsyncIOResult_Failed );
+				continue;
+			}
+
+			request->aBytesRead += cqe->res;
+
+			// short read, read the rest
+			if ( request->aBytesRead < request->aReadSize )
+			{
+				asyncio_ring_queue_read( request );
+				resubmit++;
+				continue;
+			}
+
+			g_io_ring_requests.erase( request );
+			finished.emplace_back( request, EAsyncIOResult_Success );
+		}
+
+		__atomic_store_n( ring.apCqHead, head, __ATOMIC_RELEASE );
+
+		std::vector< ch_async_io_request* > failed;
+		asyncio_ring_submit( resubmit, failed );
+
+		for ( ch_async_io_request* request : failed )
+			finished.emplace_back( request, EAsyncIOResult_Failed );
+
+		// completions can come in any order, so the nop to wake us up could finish before the other reads
+		bool stop = g_io_ring_stop && ring.aInFlight == 0;
+
+		lock.unlock();
+		g_io_ring_cond.notify_all();
+
+		// callbacks run without the lock held, they may submit more requests
+		for ( auto& [ request, requestResult ] : finished )
+			asyncio_finish( request, requestResult );
+
+		if ( stop )
+			break;
+	}
+}
+#endif
+
+
+// ----------------------------------------------------------------
+// I/O Threads
+
+
+// g_io_mutex must be locked
+static ch_async_io_request* asyncio_pop()
+{
+	for ( int priority = EAsyncIOPriority_Count - 1; priority >= 0; priority-- )
+	{
+		io_queue_t& queue = g_io_queue[ priority ];
+
+		if ( !queue.apHead )
+			continue;
+
+		ch_async_io_request* request = queue.apHead;
+		queue.apHead                 = request->apNext;
+
+		if ( !queue.apHead )
+			queue.apTail = nullptr;
+
+		request->apNext = nullptr;
+		return request;
+	}
+
+	return nullptr;
+}
+
+
+static void asyncio_thread()
+{
+	ch_async_io_request* batch[ IO_MAX_BATCH ];
+
+	while ( true )
+	{
+		u32 count = 0;
+
+		{
+			std::unique_lock< std::mutex > lock( g_io_mutex );
+			g_io_cond.wait( lock, []() { return !g_io_running || g_io_queue[ EAsyncIOPriority_Low ].apHead || g_io_queue[ EAsyncIOPriority_Normal ].apHead || g_io_queue[ EAsyncIOPriority_High ].apHead; } );
+
+			// finish everything that's queued before stopping
+			while ( count < IO_MAX_BATCH )
+			{
+				ch_async_io_request* request = asyncio_pop();
+
+				if ( !request )
+					break;
+
+				batch[ count++ ] = request;
+
+				// without io_uring, each thread reads one at a time, so other threads can take the rest
+				if ( !asyncio_ring_active() )
+					break;
+			}
+
+			if ( count == 0 && !g_io_running )
+				break;
+		}
+
+		u32 ringCount = 0;
+
+		for ( u32 i = 0; i < count; i++ )
+		{
+			if ( !asyncio_prepare( batch[ i ] ) )
+				continue;
+
+#if CH_IO_URING
+			// empty reads have nothing to submit
+			if ( asyncio_ring_active() && batch[ i ]->aReadSize > 0 )
+			{
+				batch[ ringCount++ ] = batch[ i ];
+				continue;
+			}
+#endif
+
+			asyncio_read_blocking( batch[ i ] );
+		}
+
+#if CH_IO_URING
+		if ( ringCount )
+			asyncio_ring_submit_batch( batch, ringCount );
+#endif
+	}
+}
+
+
+static void asyncio_start()
+{
+	// g_io_mutex is locked
+	if ( g_io_running )
+		return;
+
+	g_io_running = true;
+
+#if CH_IO_URING
+	if ( io_uring && asyncio_ring_init( io_uring_depth ) )
+		g_io_ring_thread = new std::thread( asyncio_ring_thread );
+#endif
+
+	for ( int i = 0; i < io_threads; i++ )
+		g_io_threads.push_back( new std::thread( asyncio_thread ) );
+
+	Log_DevF( gLC_FileSystem, 1, "Started async file I/O with %d threads, using %s\n", io_threads, AsyncIO_GetBackendName() );
+}
+
+
+void AsyncIO_Shutdown()
+{
+	{
+		std::unique_lock< std::mutex > lock( g_io_mutex );
+
+		if ( !g_io_running )
+			return;
+
+		g_io_running = false;
+	}
+
+	g_io_cond.notify_all();
+
+	// the I/O threads finish what's queued before stopping
+	for ( std::thread* thread : g_io_threads )
+	{
+		thread->join();
+		delete thread;
+	}
+
+	g_io_threads.clear();
+
+#if CH_IO_URING
+	if ( g_io_ring_thread )
+	{
+		// wake up the ring thread, it stops after the reads in flight finish, or it already stopped if the ring died
+		bool woken = true;
+
+		{
+			std::unique_lock< std::mutex > lock( g_io_ring_mutex );
+			g_io_ring_cond.wait( lock, []() { return g_io_ring_dead || g_io_ring.aInFlight < g_io_ring.aEntries; } );
+
+			if ( !g_io_ring_dead )
+			{
+				std::vector< ch_async_io_request* > failed;
+
+				g_io_ring_stop = true;
+				asyncio_ring_queue_nop();
+				woken = asyncio_ring_submit( 1, failed );
+			}
+		}
+
+		if ( woken )
+		{
+			g_io_ring_thread->join();
+			delete g_io_ring_thread;
+			g_io_ring_thread = nullptr;
+		}
+		else
+		{
+			// nothing can wake it up anymore, fail what it's waiting on and leave it and the ring behind,
+			// the thread is still blocked on the ring, so it can't be unmapped
+			Log_Error( gLC_FileSystem, "Failed to stop the io_uring thread, leaking it\n" );
+			asyncio_ring_kill();
+			g_io_ring_thread->detach();
+			g_io_ring_thread = nullptr;
+			return;
+		}
+	}
+
+	asyncio_ring_free();
+	g_io_ring_stop = false;
+	g_io_ring_dead = false;
+#endif
+}
+
+
+// g_io_mutex must be locked
+static bool asyncio_push( ch_async_io_request* spRequest )
+{
+	if ( !spRequest || !spRequest->apPath || spRequest->aPriority >= EAsyncIOPriority_Count )
+	{
+		Log_ErrorF( gLC_FileSystem, "Invalid async read request\n" );
+		return false;
+	}
+
+	// we don't know how big the caller's buffer is, so we can't read to the end of the file into it
+	if ( spRequest->apBuffer && spRequest->aSize == 0 )
+	{
+		Log_ErrorF( gLC_FileSystem, "Async read into a buffer needs a size: %s\n", spRequest->apPath );
+		return false;
+	}
+
+	spRequest->aResult.store( EAsyncIOResult_Pending, std::memory_order_relaxed );
+	spRequest->aBytesRead   = 0;
+	spRequest->aReadSize    = 0;
+	spRequest->aFullPath    = {};
+	spRequest->aFile        = -1;
+	spRequest->aAllocBuffer = false;
+	spRequest->apNext       = nullptr;
+
+	if ( spRequest->apFence )
+		spRequest->apFence->aPending.fetch_add( 1, std::memory_order_relaxed );
+
+	asyncio_start();
+
+	io_queue_t& queue = g_io_queue[ spRequest->aPriority ];
+
+	if ( queue.apTail )
+		queue.apTail->apNext = spRequest;
+	else
+		queue.apHead = spRequest;
+
+	queue.apTail = spRequest;
+	g_io_stat_pending++;
+
+	return true;
+}
+
+
+bool AsyncIO_Submit( ch_async_io_request* spRequest )
+{
+	{
+		std::unique_lock< std::mutex > lock( g_io_mutex );
+
+		if ( !asyncio_push( spRequest ) )
+			return false;
+	}
+
+	g_io_cond.notify_one();
+	return true;
+}
+
+
+u32 AsyncIO_SubmitBatch( ch_async_io_request** spRequests, u32 sCount )
+{
+	PROF_SCOPE();
+
+	u32 submitted = 0;
+
+	{
+		std::unique_lock< std::mutex > lock( g_io_mutex );
+
+		for ( u32 i = 0; i < sCount; i++ )
+			submitted += asyncio_push( spRequests[ i ] );
+	}
+
+	g_io_cond.notify_all();
+	return submitted;
+}
+
+
+bool AsyncIO_IsDone( const ch_async_io_request* spRequest )
+{
+	return spRequest->aResult.load( std::memory_order_acquire ) != EAsyncIOResult_Pending;
+}
+
+
+void AsyncIO_Wait( const ch_async_io_request* spRequest )
+{
+	PROF_SCOPE();
+
+	if ( AsyncIO_IsDone( spRequest ) )
+		return;
+
+	std::unique_lock< std::mutex > lock( g_io_done_mutex );
+	g_io_done_cond.wait( lock, [ spRequest ]() { return AsyncIO_IsDone( spRequest ); } );
+}
+
+
+bool AsyncIO_IsFenceDone( const ch_async_io_fence& srFence )
+{
+	return srFence.aPending.load( std::memory_order_acquire ) == 0;
+}
+
+
+void AsyncIO_WaitFence( const ch_async_io_fence& srFence )
+{
+	PROF_SCOPE();
+
+	if ( AsyncIO_IsFenceDone( srFence ) )
+		return;
+
+	std::unique_lock< std::mutex > lock( g_io_done_mutex );
+	g_io_done_cond.wait( lock, [ &srFence ]() { return AsyncIO_IsFenceDone( srFence ); } );
+}
+
+
+const char* AsyncIO_GetBackendName()
+{
+	if ( asyncio_ring_active() )
+		return "io_uring";
+
+	return "I/O Threads";
+}
+
+
+CONCMD_VA( io_stats, "Print async file I/O stats" )
+{
+	log_t group = Log_GroupBegin( gLC_FileSystem );
+
+	Log_GroupF( group, "Async File I/O: %s%s\n", AsyncIO_GetBackendName(), g_io_running ? "" : " (Not Started)" );
+	Log_GroupF( group, "    Threads:   %zu\n", g_io_threads.size() );
+	Log_GroupF( group, "    Pending:   %u\n", g_io_stat_pending.load() );
+	Log_GroupF( group, "    Completed: %llu\n", g_io_stat_completed.load() );
+	Log_GroupF( group, "    Failed:    %llu\n", g_io_stat_failed.load() );
+	Log_GroupF( group, "    Read:      %.2f MB\n", g_io_stat_bytes.load() / ( 1024.0 * 1024.0 ) );
+
+	Log_GroupEnd( group );
+}
+
@@ -1,6 +1,7 @@
 #include "core/commandline.h"
 
 #include "core/console.h"
+#include "core/async_io.h"
 #include "core/filesystem.h"
 #include "core/log.h"
 #include "core/app_info.h"
@@ -96,6 +97,7 @@ extern "C"
 		core_app_info_free();
 		//Thread_Shutdown();
 
+		AsyncIO_Shutdown();
 		FileSys_Shutdown();
 
 		// shutdown sdl
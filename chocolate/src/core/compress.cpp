@@ -0,0 +1,210 @@
+#include "core/compress.h"
+#include "core/profiler.h"
+
+#include <vector>
+
+
+// LZ4 block format limits
+constexpr u32 LZ4_MIN_MATCH     = 4;
+constexpr u32 LZ4_LAST_LITERALS = 5;   // the last 5 bytes are always literals
+constexpr u32 LZ4_MF_LIMIT      = 12;  // the last match must start at least 12 bytes before the end
+constexpr u32 LZ4_MAX_OFFSET    = 65535;
+constexpr u32 LZ4_HASH_BITS     = 16;
+
+
+static inline u32 lz4_read32( const u8* spData )
+{
+	u32 value;
+	memcpy( &value, spData, sizeof( u32 ) );
+	return value;
+}
+
+
+static inline u32 lz4_hash( u32 sSequence )
+{
+	return ( sSequence * 2654435761U ) >> ( 32 - LZ4_HASH_BITS );
+}
+
+
+// lengths of 15 or more spill into extra bytes of 255 until the remainder
+static inline u8* lz4_write_length( u8* spOut, u64 sLength )
+{
+	while ( sLength >= 255 )
+	{
+		*spOut++ = 255;
+		sLength -= 255;
+	}
+
+	*spOut++ = (u8)sLength;
+	return spOut;
+}
+
+
+static inline bool lz4_read_length( const u8*& srIn, const u8* spEnd, u64& srLength )
+{
+	u8 value;
+
+	do
+	{
+		if ( srIn >= spEnd )
+			return false;
+
+		value = *srIn++;
+		srLength += value;
+	}
+	while ( value == 255 );
+
+	return true;
+}
+
+
+u64 ch_lz4_compress_bound( u64 sSize )
+{
+	return sSize + ( sSize / 255 ) + 16;
+}
+
+
+u64 ch_lz4_compress( const char* spSrc, u64 sSrcSize, char* spDst, u64 sDstCapacity )
+{
+	PROF_SCOPE();
+
+	if ( ( !spSrc && sSrcSize ) || !spDst || sDstCapacity < ch_lz4_compress_bound( sSrcSize ) || sSrcSize > UINT32_MAX )
+		return 0;
+
+	const u8* in     = (const u8*)spSrc;
+	u8*       out    = (u8*)spDst;
+	u64       anchor = 0;
+	u64       pos    = 0;
+
+	// greedy matching against the last position each 4 byte sequence was seen at
+	std::vector< u32 > table( 1 << LZ4_HASH_BITS, UINT32_MAX );
+
+	if ( sSrcSize > LZ4_MF_LIMIT )
+	{
+		u64 matchLimit = sSrcSize - LZ4_LAST_LITERALS;
+
+		while ( pos + LZ4_MF_LIMIT <= sSrcSize )
+		{
+			u32  sequence  = lz4_read32( in + pos );
+			u32& slot      = table[ lz4_hash( sequence ) ];
+			u32  candidate = slot;
+			slot           = (u32)pos;
+
+			if ( candidate == UINT32_MAX || pos - candidate > LZ4_MAX_OFFSET || lz4_read32( in + candidate ) != sequence )
+			{
+				pos++;
+				continue;
+			}
+
+			u64 matchLen = LZ4_MIN_MATCH;
+			while ( pos + matchLen < matchLimit && in[ candidate + matchLen ] == in[ pos + matchLen ] )
+				matchLen++;
+
+			// token, literals, offset, then the match length
+			u64 literalLen = pos - anchor;
+			u64 extraMatch = matchLen - LZ4_MIN_MATCH;
+			u8* token      = out++;
+
+			*token         = (u8)( ( std::min< u64 >( literalLen, 15 ) << 4 ) | std::min< u64 >( extraMatch, 15 ) );
+
+			if ( literalLen >= 15 )
+				out = lz4_write_length( out, literalLen - 15 );
+
+			memcpy( out, in + anchor, literalLen );
+			out += literalLen;
+
+			u64 offset = pos - candidate;
+			*out++     = (u8)( offset & 0xFF );
+			*out++     = (u8)( offset >> 8 );
+
+			if ( extraMatch >= 15 )
+				out = lz4_write_length( out, extraMatch - 15 );
+
+			pos += matchLen;
+			anchor = pos;
+		}
+	}
+
+	// the rest is literals
+	u64 literalLen = sSrcSize - anchor;
+	*out++         = (u8)( std::min< u64 >( literalLen, 15 ) << 4 );
+
+	if ( literalLen >= 15 )
+		out = lz4_write_length( out, literalLen - 15 );
+
+	memcpy( out, in + anchor, literalLen );
+	out += literalLen;
+
+	return out - (u8*)spDst;
+}
+
+
+bool ch_lz4_decompress( const char* spSrc, u64 sSrcSize, char* spDst, u64 sDstSize )
+{
+	PROF_SCOPE();
+
+	if ( !spSrc || ( !spDst && sDstSize ) )
+		return false;
+
+	const u8* in     = (const u8*)spSrc;
+	const u8* inEnd  = in + sSrcSize;
+	u8*       out    = (u8*)spDst;
+	u8*       outEnd = out + sDstSize;
+
+	while ( in < inEnd )
+	{
+		u8  token      = *in++;
+		u64 literalLen = token >> 4;
+
+		if ( literalLen == 15 && !lz4_read_length( in, inEnd, literalLen ) )
+			return false;
+
+		if ( literalLen > (u64)( inEnd - in ) || literalLen > (u64)( outEnd - out ) )
+			return false;
+
+		memcpy( out, in, literalLen );
+		in += literalLen;
+		out += literalLen;
+
+		// the last sequence is only literals
+		if ( in == inEnd )
+			break;
+
+		if ( inEnd - in < 2 )
+			return false;
+
+		u64 offset = in[ 0 ] | ( in[ 1 ] << 8 );
+		in += 2;
+
+		if ( offset == 0 || offset > (u64)( out - (u8*)spDst ) )
+			return false;
+
+		u64 matchLen = token & 15;
+
+		if ( matchLen == 15 && !lz4_read_length( in, inEnd, matchLen ) )
+			return false;
+
+		matchLen += LZ4_MIN_MATCH;
+
+		if ( matchLen > (u64)( outEnd - out ) )
+			return false;
+
+		const u8* match = out - offset;
+
+		// matches can overlap what they're writing, which repeats the data
+		if ( offset >= matchLen )
+		{
+			memcpy( out, match, matchLen );
+		}
+		else
+		{
+			for ( u64 i = 0; i < matchLen; i++ )
+				out[ i ] = match[ i ];
+		}
+
+		out += matchLen;
+	}
+
+	return out == outEnd;
+}
+
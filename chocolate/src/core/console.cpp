@@ -39,7 +39,7 @@ extern ch_string*               g_cvar_desc;
 
 
 CONVAR_BOOL( con_remove_dup_input_history, true, "Remove duplicate user inputs from the history" );
-CONVAR_INT( con_search_behavior, 1, "0 - must start with this string, 1 - must contain this string" );
+CONVAR_INT( con_search_behavior, 2, "0 - must start with this string, 1 - must contain this string, 2 - contains the string or the characters in order" );
 
 // std::unordered_map< ConVarBase*, std::string > gConVarLowercaseNames;
 
@@ -75,44 +75,287 @@ bool ConVarNameCheck( const char* name, const char* search, size_t size, bool* s
 }
 
 
-void Con_SearchConVars( ChVector< ConVarSearchResult_t >& results, const char* search, size_t size )
+// ConVar names are indexed as they're registered, so searching doesn't have to look at every one of them
+// Names are kept lowercase in one buffer, with a list of them in sorted order for prefix searches,
+// and every 2 and 3 character sequence in them points to the names that contain it, for substring searches
+
+struct con_search_name_t
 {
-	ChVector< ConVarSearchResult_t > resultsStartWith;  // results that the convar name starts with the search
-	ChVector< ConVarSearchResult_t > resultsContain;    // results that contain the string somewhere in in a convar name
+	u32       aOffset;  // offset into the lowercase name buffer
+	u32       aLength;
+	u32       aIndex;   // convar index
+	u64       aChars;   // a bit for each character in the name, to skip names that can't match quickly
+	ch_string aName;    // the name in the convar index map
+};
 
-	for ( auto& [ cvarName, cvarIndex ] : Con_GetConVarIndexMap() )
+
+struct con_search_index_t
+{
+	std::vector< char >                             aNames;
+	std::vector< con_search_name_t >                aEntries;
+	std::vector< u32 >                              aSorted;
+	bool                                            aSortDirty = false;
+	std::unordered_map< u32, std::vector< u32 > >   aGrams;
+};
+
+
+static con_search_index_t& Con_GetSearchIndex()
+{
+	static con_search_index_t index;
+	return index;
+}
+
+
+// pack 2 or 3 characters into a key, 2 character keys always have 0 in the low byte, which a name can't have
+static u32 Con_SearchGram( const char* spStr, u32 sLength )
+{
+	u32 key = ( (u8)spStr[ 0 ] << 16 ) | ( (u8)spStr[ 1 ] << 8 );
+
+	if ( sLength == 3 )
+		key |= (u8)spStr[ 2 ];
+
+	return key;
+}
+
+
+static const char* Con_SearchName( const con_search_index_t& srIndex, const con_search_name_t& srEntry )
+{
+	return srIndex.aNames.data() + srEntry.aOffset;
+}
+
+
+static u64 Con_SearchCharMask( const char* spStr, u32 sLength )
+{
+	u64 mask = 0;
+
+	for ( u32 i = 0; i < sLength; i++ )
+		mask |= 1ull << ( spStr[ i ] & 63 );
+
+	return mask;
+}
+
+
+// returns the position of find in str, or -1
+static s32 Con_SearchFind( const char* spStr, u32 sLength, const char* spFind, u32 sFindLength )
+{
+	if ( sFindLength > sLength )
+		return -1;
+
+	for ( u32 i = 0; i + sFindLength <= sLength; i++ )
 	{
-		bool startsWith = false;
-		if ( !ConVarNameCheck( cvarName.data, search, size, &startsWith ) )
+		if ( spStr[ i ] == spFind[ 0 ] && memcmp( spStr + i, spFind, sFindLength ) == 0 )
+			return i;
+	}
+
+	return -1;
+}
+
+
+// Do the characters in find appear in order in str, returns a score where lower is a better match, or -1
+// The score is how many characters are skipped over between the first and last matching character
+static s32 Con_SearchFuzzy( const char* spStr, u32 sLength, const char* spFind, u32 sFindLength )
+{
+	s32 first = -1;
+	u32 find  = 0;
+
+	for ( u32 i = 0; i < sLength && find < sFindLength; i++ )
+	{
+		if ( spStr[ i ] != spFind[ find ] )
 			continue;
 
-		if ( startsWith )
+		if ( first == -1 )
+			first = i;
+
+		if ( ++find == sFindLength )
+			return ( i - first + 1 ) - sFindLength;
+	}
+
+	return -1;
+}
+
+
+void Con_AddSearchName( const ch_string& srName, u32 sIndex )
+{
+	con_search_index_t& index = Con_GetSearchIndex();
+
+	con_search_name_t   entry;
+	entry.aOffset = index.aNames.size();
+	entry.aLength = srName.size;
+	entry.aIndex  = sIndex;
+	entry.aChars  = 0;
+	entry.aName   = srName;
+
+	for ( size_t i = 0; i < srName.size; i++ )
+		index.aNames.push_back( tolower( (u8)srName.data[ i ] ) );
+
+	index.aNames.push_back( '\0' );
+
+	u32         entryIndex = index.aEntries.size();
+	const char* name       = index.aNames.data() + entry.aOffset;
+	entry.aChars           = Con_SearchCharMask( name, entry.aLength );
+
+	index.aEntries.push_back( entry );
+	index.aSorted.push_back( entryIndex );
+	index.aSortDirty = true;
+
+	for ( u32 gramLength = 2; gramLength <= 3; gramLength++ )
+	{
+		for ( u32 i = 0; i + gramLength <= entry.aLength; i++ )
 		{
-			ConVarSearchResult_t& cvar_result = resultsStartWith.emplace_back();
-			cvar_result.name                  = cvarName;
-			cvar_result.index                 = cvarIndex;
+			std::vector< u32 >& list = index.aGrams[ Con_SearchGram( name + i, gramLength ) ];
+
+			// names are added in order, so this only has to check the last one to skip repeats
+			if ( list.empty() || list.back() != entryIndex )
+				list.push_back( entryIndex );
 		}
-		else
+	}
+}
+
+
+struct con_search_match_t
+{
+	u32 aEntry;
+	s32 aScore;
+};
+
+
+void Con_SearchConVars( ChVector< ConVarSearchResult_t >& results, const char* search, size_t size )
+{
+	PROF_SCOPE();
+
+	con_search_index_t& index = Con_GetSearchIndex();
+
+	if ( index.aSortDirty )
+	{
+		std::sort( index.aSorted.begin(), index.aSorted.end(), [ & ]( u32 left, u32 right ) {
+			return strcmp( Con_SearchName( index, index.aEntries[ left ] ), Con_SearchName( index, index.aEntries[ right ] ) ) < 0;
+		} );
+
+		index.aSortDirty = false;
+	}
+
+	ch_string_small<> find;
+	for ( size_t i = 0; i < size; i++ )
+		find.append( (char)tolower( (u8)search[ i ] ) );
+
+	auto addResult = [ & ]( u32 entryIndex ) {
+		const con_search_name_t& entry       = index.aEntries[ entryIndex ];
+		ConVarSearchResult_t&    cvar_result = results.emplace_back();
+		cvar_result.name                     = entry.aName;
+		cvar_result.index                    = entry.aIndex;
+	};
+
+	// results that the convar name starts with the search, these are already in alphabetical order
+	auto prefixIt = std::lower_bound( index.aSorted.begin(), index.aSorted.end(), find.data, [ & ]( u32 entryIndex, const char* value ) {
+		return strcmp( Con_SearchName( index, index.aEntries[ entryIndex ] ), value ) < 0;
+	} );
+
+	for ( ; prefixIt != index.aSorted.end(); prefixIt++ )
+	{
+		const con_search_name_t& entry = index.aEntries[ *prefixIt ];
+
+		if ( entry.aLength < find.size || memcmp( Con_SearchName( index, entry ), find.data, find.size ) != 0 )
+			break;
+
+		addResult( *prefixIt );
+	}
+
+	if ( con_search_behavior == 0 || find.size == 0 )
+		return;
+
+	// results that contain the string somewhere in a convar name, earlier matches first, then shorter names
+	// only names with the least common 2 or 3 characters of the search in them need to be checked
+	const std::vector< u32 >* candidates = nullptr;
+
+	if ( find.size >= 2 )
+	{
+		u32 gramLength = find.size >= 3 ? 3 : 2;
+
+		for ( u32 i = 0; i + gramLength <= find.size; i++ )
 		{
-			ConVarSearchResult_t& cvar_result = resultsContain.emplace_back();
-			cvar_result.name  = cvarName;
-			cvar_result.index = cvarIndex;
+			auto it = index.aGrams.find( Con_SearchGram( find.data + i, gramLength ) );
+
+			if ( it == index.aGrams.end() )
+			{
+				static const std::vector< u32 > empty;
+				candidates = &empty;
+				break;
+			}
+
+			if ( !candidates || it->second.size() < candidates->size() )
+				candidates = &it->second;
 		}
 	}
 
-	if ( resultsStartWith.size() )
+	std::vector< con_search_match_t > matches;
+	u64                               findChars = Con_SearchCharMask( find.data, find.size );
+
+	auto checkContains = [ & ]( u32 entryIndex ) {
+		const con_search_name_t& entry = index.aEntries[ entryIndex ];
+
+		if ( ( entry.aChars & findChars ) != findChars )
+			return;
+
+		s32                      pos   = Con_SearchFind( Con_SearchName( index, entry ), entry.aLength, find.data, find.size );
+
+		// position 0 is a prefix match, that's already in the results
+		if ( pos > 0 )
+			matches.push_back( { entryIndex, pos } );
+	};
+
+	if ( candidates )
 	{
-		u32 offset = results.size();
-		results.resize( results.size() + resultsStartWith.size() );
-		memcpy( results.apData + offset, resultsStartWith.apData, resultsStartWith.size_bytes() );
+		for ( u32 entryIndex : *candidates )
+			checkContains( entryIndex );
+	}
+	else
+	{
+		for ( u32 entryIndex = 0; entryIndex < index.aEntries.size(); entryIndex++ )
+			checkContains( entryIndex );
 	}
 
-	if ( resultsContain.size() )
+	auto sortMatches = [ & ]() {
+		std::sort( matches.begin(), matches.end(), [ & ]( const con_search_match_t& left, const con_search_match_t& right ) {
+			if ( left.aScore != right.aScore )
+				return left.aScore < right.aScore;
+
+			const con_search_name_t& leftEntry  = index.aEntries[ left.aEntry ];
+			const con_search_name_t& rightEntry = index.aEntries[ right.aEntry ];
+
+			if ( leftEntry.aLength != rightEntry.aLength )
+				return leftEntry.aLength < rightEntry.aLength;
+
+			return strcmp( Con_SearchName( index, leftEntry ), Con_SearchName( index, rightEntry ) ) < 0;
+		} );
+
+		for ( const con_search_match_t& match : matches )
+			addResult( match.aEntry );
+	};
+
+	sortMatches();
+
+	if ( con_search_behavior == 1 || find.size < 2 )
+		return;
+
+	// fuzzy results, names with the characters of the search in order, closest together first
+	matches.clear();
+
+	for ( u32 entryIndex = 0; entryIndex < index.aEntries.size(); entryIndex++ )
 	{
-		u32 offset = results.size();
-		results.resize( results.size() + resultsContain.size() );
-		memcpy( results.apData + offset, resultsContain.apData, resultsContain.size_bytes() );
+		const con_search_name_t& entry = index.aEntries[ entryIndex ];
+
+		if ( ( entry.aChars & findChars ) != findChars )
+			continue;
+
+		const char*              name  = Con_SearchName( index, entry );
+		s32                      score = Con_SearchFuzzy( name, entry.aLength, find.data, find.size );
+
+		// skip names with the search in them as is, those are already in the results
+		if ( score > 0 && Con_SearchFind( name, entry.aLength, find.data, find.size ) == -1 )
+			matches.push_back( { entryIndex, score } );
 	}
+
+	sortMatches();
 }
 
 
@@ -188,21 +188,20 @@ void help_dropdown(
   std::vector< std::string >&       results )           // results to populate the dropdown list with
 {
 	std::string                name = args.empty() ? "" : str_lower2( args[ 0 ] );
-	// Con_SearchConVars( results, name.data(), name.size() );
 
 	std::vector< std::string > resultsStartWith;  // results that the convar name starts with the search
 	std::vector< std::string > resultsContain;    // results that contain the string somewhere in in a convar name
 
-	for ( const auto& [ cvarName, cvarIndex ] : Con_GetConVarIndexMap() )
-	{
-		bool startsWith = false;
-		if ( !ConVarNameCheck( cvarName.data, name.data(), name.size(), &startsWith ) )
-			continue;
+	ChVector< ConVarSearchResult_t > searchResults;
+	Con_SearchConVars( searchResults, name.data(), name.size() );
 
-		if ( startsWith )
-			resultsStartWith.push_back( cvarName.data );
+	// these are already ranked, prefix matches first
+	for ( ConVarSearchResult_t& cvar : searchResults )
+	{
+		if ( ch_strncasecmp( cvar.name.data, name.data(), name.size() ) == 0 )
+			resultsStartWith.push_back( cvar.name.data );
 		else
-			resultsContain.push_back( cvarName.data );
+			resultsContain.push_back( cvar.name.data );
 	}
 
 	// Also Search Registered Arguments
@@ -7,6 +7,8 @@ extern ConVarFlag_t                    gConVarRegisterFlags;
 extern ConVarFlagData_t*               gConVarFlags;
 extern u8                              gConVarFlagCount;
 
+extern void                            Con_AddSearchName( const ch_string& srName, u32 sIndex );
+
 static std::string                     gStrEmpty;
 static ch_string                       gChStrEmpty;
 
@@ -31,6 +33,25 @@ std::unordered_map< ch_string, u32 >&  Con_GetConVarIndexMap()
 }
 
 
+// Interned name to index, for looking up convars in hot code with CH_HASH
+static std::unordered_map< ch_str_id, u32 >& Con_GetConVarIDMap()
+{
+	static std::unordered_map< ch_str_id, u32 > cvar_map;
+	return cvar_map;
+}
+
+
+u32 Con_GetConVarIndex( ch_str_id id )
+{
+	auto it = Con_GetConVarIDMap().find( id );
+
+	if ( it == Con_GetConVarIDMap().end() )
+		return UINT32_MAX;
+
+	return it->second;
+}
+
+
 u32 Con_GetConVarIndex( const char* name, size_t len )
 {
 	if ( !name )
@@ -73,6 +94,12 @@ ConVarData_t* Con_GetConVarData( const char* name, size_t len )
 }
 
 
+ConVarData_t* Con_GetConVarData( ch_str_id id )
+{
+	return Con_GetConVarData( Con_GetConVarIndex( id ) );
+}
+
+
 const ch_string Con_GetConVarDesc( const char* name, size_t len )
 {
 	return Con_GetConVarDesc( Con_GetConVarIndex( name, len ) );
@@ -154,7 +181,13 @@ bool Con_Register_Base( ConVarData_t** conVarDataIn, const char* spName, const c
 	conVarData.aType                                 = sType;
 	conVarData.aFlags                                = sFlags | gConVarRegisterFlags;
 
-	Con_GetConVarIndexMap()[ ch_str_copy( spName ) ] = g_cvar_count;
+	ch_string name                                   = ch_str_copy( spName );
+	Con_GetConVarIndexMap()[ name ]                  = g_cvar_count;
+	Con_AddSearchName( name, g_cvar_count );
+
+	ch_str_id name_id                                = ch_str_intern( spName );
+	if ( name_id != CH_STR_ID_INVALID )
+		Con_GetConVarIDMap()[ name_id ] = g_cvar_count;
 
 	g_cvar_desc[ g_cvar_count ] = spDesc ? ch_str_copy( spDesc ) : ch_string();
 
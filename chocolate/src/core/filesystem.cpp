@@ -6,10 +6,17 @@
 #include "core/json5.h"
 #include "core/app_info.h"
 #include "core/util.h"
+#include "core/pak.h"
 
 #include <array>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <sys/stat.h>
 
@@ -23,6 +30,7 @@
     #include <stdio.h>
     #include <strsafe.h>
 	#include <io.h>
+	#include <memoryapi.h>
 
 	// get rid of the dumb windows posix depreciation warnings
 	#define mkdir _mkdir
@@ -39,6 +47,16 @@
 	#include <unistd.h>
     #include <dirent.h>
     #include <string.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+
+	#ifdef __linux__
+		#include <sys/inotify.h>
+		#include <poll.h>
+
+		// keep the file index up to date with inotify
+		#define CH_FS_WATCH 1
+	#endif
 
 	#define ch_umkdir  mkdir
 	#define chdir  chdir
@@ -50,6 +68,11 @@
 #endif
 
 
+#ifndef CH_FS_WATCH
+	#define CH_FS_WATCH 0
+#endif
+
+
 #undef FileSys_FindBinFile
 #undef FileSys_FindSourceFile
 #undef FileSys_FindFile
@@ -58,6 +81,8 @@
 
 LOG_CHANNEL_REGISTER( FileSystem, ELogColor_DarkGray );
 
+CONVAR_BOOL( fs_index, true, "Find files in the search paths with the file index, instead of checking each search path on disk" );
+
 static ch_string                g_working_dir;
 static ch_string                g_exe_path;
 static ch_string                g_app_path_macro;
@@ -65,6 +90,88 @@ static ch_string                g_app_path_macro;
 static ch_string*               g_paths[ ESearchPathType_Count ];
 static u32                      g_paths_count[ ESearchPathType_Count ];
 
+// ----------------------------------------------------------------
+// File Index
+// Every file and directory in the search paths is stored by its relative path,
+// so finding a file is a hash lookup instead of a string join and a stat call for each search path
+// It's rebuilt when the search paths change, and kept up to date with inotify on linux
+// Without inotify, files not in the index are still checked for on disk, since they could of been added by something else
+
+// don't follow symlinked directories forever
+constexpr int                   FS_INDEX_MAX_DEPTH = 24;
+
+struct fs_index_entry_t
+{
+	std::string aFullPath;    // what FileSys_FindFile returns for it
+	u32         aSearchPath;  // index of the search path it was found in, lower is higher priority
+	bool        aIsDir;
+};
+
+struct fs_index_root_t
+{
+	std::string aPath;      // the search path as it was added
+	std::string aNormPath;  // normalized with filesys_index_normalize() for comparing with other paths
+	ch_pak_t*   apPak;      // if this search path is a pak file
+};
+
+struct fs_index_hash_t
+{
+	using is_transparent = void;
+
+	size_t operator()( std::string_view sStr ) const
+	{
+		return std::hash< std::string_view >{}( sStr );
+	}
+};
+
+struct fs_index_t
+{
+	std::unordered_map< std::string, fs_index_entry_t, fs_index_hash_t, std::equal_to<> > aFiles;
+	std::vector< fs_index_root_t >                                                         aRoots;
+	bool                                                                                   aHasPaks;
+};
+
+static fs_index_t               g_index[ ESearchPathType_Count ];
+static std::shared_mutex        g_index_mutex;
+static std::atomic< bool >      g_index_dirty = true;
+
+#if CH_FS_WATCH
+static int                                    g_index_inotify       = -1;
+static bool                                   g_index_watch_failed  = false;
+static std::unordered_map< int, std::string > g_index_watches;  // watch descriptor -> directory path
+static std::thread*                           g_index_watch_thread  = nullptr;
+static std::atomic< bool >                    g_index_watch_running = false;
+#endif
+
+static void                     filesys_index_rebuild();
+static void                     filesys_index_add_root( u32 sType );
+static void                     filesys_index_shutdown();
+static void                     filesys_index_update( const char* spPath );
+
+// ----------------------------------------------------------------
+// Pak Files
+// Search paths that are pak files are opened the first time they're used, and stay open until shutdown,
+// so views of files in them stay valid
+
+struct fs_pak_mount_t
+{
+	std::string aPath;  // the search path
+	ch_pak_t*   apPak;  // nullptr if it failed to open
+};
+
+static std::vector< fs_pak_mount_t > g_paks;
+static std::mutex                    g_pak_mutex;
+
+static void                          filesys_pak_shutdown();
+
+
+enum EFileViewType : u8
+{
+	EFileViewType_None,    // points into something else, like a pak, nothing to free
+	EFileViewType_Mapped,
+	EFileViewType_Heap,
+};
+
 
 CONCMD( fs_print_paths )
 {
@@ -152,6 +259,8 @@ bool FileSys_Init( const char* desiredWorkingDir )
 
 void FileSys_Shutdown()
 {
+	filesys_index_shutdown();
+	filesys_pak_shutdown();
 	FileSys_ClearAllPathTypes();
 
 	ch_str_free( g_working_dir.data );
@@ -290,6 +399,7 @@ void FileSys_ClearPaths( ESearchPathType type )
 	// dont actually realloc it right now, would be better to just set the count to 0
 	memset( g_paths[ type ], 0, sizeof( ch_string ) * g_paths_count[ type ] );
 	g_paths_count[ type ] = 0;
+	g_index_dirty         = true;
 }
 
 
@@ -425,153 +535,1039 @@ ch_string FileSys_BuildSearchPath( const char* path, s32 pathLen )
 		if ( !find )
 			break;
 
-		last = ++find;
-		find = strchr( last, '$' );
+		last = ++find;
+		find = strchr( last, '$' );
+	}
+
+	ch_string cleanedPath = FileSys_CleanPath( output.data, output.size );
+	ch_str_free( output.data );
+
+	return cleanedPath;
+}
+
+
+static bool filesys_is_invalid_path_type( ESearchPathType type )
+{
+	if ( type >= ESearchPathType_Count )
+	{
+		Log_Error( "Invalid Search Path Type\n" );
+		return true;
+	}
+
+	return false;
+}
+
+
+void FileSys_AddSearchPath( const char* path, s32 pathLen, ESearchPathType type )
+{
+	if ( filesys_is_invalid_path_type( type ) )
+		return;
+
+	ch_string fullPath = FileSys_BuildSearchPath( path, pathLen );
+
+	if ( !fullPath.data )
+		return;
+
+	// realloc paths
+	ch_string* new_data = ch_realloc( g_paths[ type ], g_paths_count[ type ] + 1 );
+
+	if ( !new_data )
+	{
+		Log_Error( "Failed to allocate memory for search path array\n" );
+		return;
+	}
+
+	g_paths[ type ] = new_data;
+	g_paths[ type ][ g_paths_count[ type ]++ ] = fullPath;
+
+	// it's the lowest priority path, so only it needs to be indexed
+	filesys_index_add_root( type );
+}
+
+
+// this one is weird, it has to build the path to remove it, why not just pass an index to remove?
+void FileSys_RemoveSearchPath( const char* path, s32 pathLen, ESearchPathType type )
+{
+	if ( filesys_is_invalid_path_type( type ) )
+		return;
+
+	ch_string fullPath = FileSys_BuildSearchPath( path );
+
+    if ( !fullPath.data )
+        return;
+
+	for ( u32 i = 0; i < g_paths_count[ type ]; i++ )
+	{
+		if ( ch_str_equals( fullPath, g_paths[ type ][ i ] ) )
+		{
+			ch_str_free( g_paths[ type ][ i ].data );
+
+			// shift all the paths down
+			for ( u32 j = i; j < g_paths_count[ type ] - 1; j++ )
+				g_paths[ type ][ j ] = g_paths[ type ][ j + 1 ];
+
+			g_paths_count[ type ]--;
+			g_index_dirty = true;
+			break;
+		}
+	}
+
+    ch_str_free( fullPath.data );
+}
+
+
+void FileSys_InsertSearchPath( u32 index, const char* path, s32 pathLen, ESearchPathType type )
+{
+	if ( filesys_is_invalid_path_type( type ) )
+		return;
+
+	if ( !ch_str_check_empty( path, pathLen ) )
+	{
+		Log_Error( "Failed to insert search path, path or path length is empty\n" );
+		return;
+	}
+
+	ch_string fullPath = FileSys_BuildSearchPath( path );
+
+	if ( !fullPath.data )
+	{
+		Log_Error( "Failed to build search path\n" );
+		return;
+	}
+
+	index = std::clamp( index, 0U, g_paths_count[ type ] );
+
+	// realloc paths
+	ch_string* new_data = ch_realloc( g_paths[ type ], g_paths_count[ type ] + 1 );
+
+	if ( !new_data )
+	{
+		Log_Error( "Failed to allocate memory for search path array\n" );
+		return;
+	}
+
+	g_paths[ type ] = new_data;
+	g_paths_count[ type ]++;
+
+	// move all the paths up
+	// memcpy( &g_paths[ type ][ index + 1 ], &g_paths[ type ][ index ], sizeof( ch_string ) * ( g_paths_count[ type ] - index ) );
+
+	for ( u32 i = g_paths_count[ type ] - 1; i > index; i-- )
+	{
+		g_paths[ type ][ i ] = g_paths[ type ][ i - 1 ];
+	}
+
+	// now we have an empty slot
+	g_paths[ type ][ index ] = fullPath;
+	g_index_dirty = true;
+}
+
+
+void FileSys_ReloadSearchPaths()
+{
+	core_search_paths_reload();
+
+	std::unique_lock< std::shared_mutex > lock( g_index_mutex );
+	filesys_index_rebuild();
+}
+
+
+// maybe faster calls? probably not
+inline bool exists( const char* path )
+{
+    return ( access( path, 0 ) != -1 );
+}
+
+
+inline bool is_dir( const char* path )
+{
+    struct stat s;
+    if ( stat( path, &s ) == 0 )
+        return (s.st_mode & S_IFDIR);
+
+    return false;
+}
+
+
+// ----------------------------------------------------------------
+// Pak Files
+
+
+static bool filesys_is_pak_path( const char* spPath, size_t sLen )
+{
+	constexpr size_t extLen = sizeof( ".chpak" ) - 1;
+	return sLen > extLen && ch_strncasecmp( spPath + sLen - extLen, ".chpak", extLen ) == 0;
+}
+
+
+// Get the pak file for a search path, opening it if it hasn't been yet, returns nullptr if it's not a pak
+static ch_pak_t* filesys_get_pak( const ch_string& srSearchPath )
+{
+	if ( !filesys_is_pak_path( srSearchPath.data, srSearchPath.size ) )
+		return nullptr;
+
+	std::lock_guard< std::mutex > lock( g_pak_mutex );
+
+	for ( const fs_pak_mount_t& mount : g_paks )
+	{
+		if ( mount.aPath.size() == srSearchPath.size && memcmp( mount.aPath.data(), srSearchPath.data, srSearchPath.size ) == 0 )
+			return mount.apPak;
+	}
+
+	// remember it even if it failed to open, so we don't try again on every lookup
+	fs_pak_mount_t& mount = g_paks.emplace_back();
+	mount.aPath.assign( srSearchPath.data, srSearchPath.size );
+	mount.apPak = Pak_Open( mount.aPath.c_str() );
+
+	return mount.apPak;
+}
+
+
+// Find the pak a path is in, like the ones FileSys_FindFile returns for files in paks, and get the path inside of it
+static ch_pak_t* filesys_resolve_pak( const char* spPath, size_t sLen, const char*& srInner, size_t& srInnerLen )
+{
+	if ( !spPath )
+		return nullptr;
+
+	std::lock_guard< std::mutex > lock( g_pak_mutex );
+
+	for ( const fs_pak_mount_t& mount : g_paks )
+	{
+		size_t mountLen = mount.aPath.size();
+
+		if ( !mount.apPak || sLen <= mountLen + 1 || ( spPath[ mountLen ] != '/' && spPath[ mountLen ] != '\\' ) )
+			continue;
+
+		if ( memcmp( spPath, mount.aPath.data(), mountLen ) != 0 )
+			continue;
+
+		srInner    = spPath + mountLen + 1;
+		srInnerLen = sLen - mountLen - 1;
+		return mount.apPak;
+	}
+
+	return nullptr;
+}
+
+
+// Turns a path into the form pak entry names are in, returns false if it's not a valid path
+static bool filesys_pak_normalize( const char* spPath, size_t sLen, std::string& srOut );
+
+
+// Paks only store files, so a directory is in a pak if any files are in it
+static bool filesys_pak_has_dir( ch_pak_t* spPak, const char* spDir, size_t sLen )
+{
+	std::string dir;
+	if ( !filesys_pak_normalize( spDir, sLen, dir ) )
+		return false;
+
+	if ( dir.empty() )
+		return true;
+
+	u32 count = Pak_GetEntryCount( spPak );
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		ch_string name = Pak_GetEntryName( spPak, i );
+
+		if ( name.size > dir.size() && name.data[ dir.size() ] == '/' && memcmp( name.data, dir.data(), dir.size() ) == 0 )
+			return true;
+	}
+
+	return false;
+}
+
+
+// If a path is inside of a pak, get whether it's a file or directory in it, srMode is 0 if it doesn't exist
+static bool filesys_pak_stat( const char* spPath, size_t sLen, int& srMode )
+{
+	const char* inner    = nullptr;
+	size_t      innerLen = 0;
+	ch_pak_t*   pak      = filesys_resolve_pak( spPath, sLen, inner, innerLen );
+
+	if ( !pak )
+		return false;
+
+	srMode = 0;
+
+	std::string name;
+	if ( filesys_pak_normalize( inner, innerLen, name ) && Pak_Find( pak, name.data(), name.size() ) != -1 )
+		srMode = S_IFREG;
+
+	else if ( filesys_pak_has_dir( pak, inner, innerLen ) )
+		srMode = S_IFDIR;
+
+	return true;
+}
+
+
+// List the files in a directory inside a pak
+static bool filesys_pak_scandir( const std::string& srPakPath, ch_pak_t* spPak, const char* spDir, size_t sLen, std::vector< ch_string >& srFiles, ReadDirFlags sFlags )
+{
+	std::string dir;
+	if ( !filesys_pak_normalize( spDir, sLen, dir ) )
+		return false;
+
+	if ( !dir.empty() && !filesys_pak_has_dir( spPak, dir.data(), dir.size() ) )
+		return false;
+
+	size_t                          prefixLen = dir.empty() ? 0 : dir.size() + 1;
+	std::unordered_set< std::string > dirs;
+	u32                             count     = Pak_GetEntryCount( spPak );
+
+	auto addPath = [ & ]( const char* spName, size_t sNameLen )
+	{
+		if ( sFlags & ReadDir_AbsPaths )
+		{
+			const char*  strings[] = { srPakPath.data(), "/", spName };
+			const size_t lengths[] = { srPakPath.size(), 1, sNameLen };
+			srFiles.push_back( ch_str_join( 3, strings, lengths ) );
+		}
+		else
+		{
+			srFiles.push_back( ch_str_copy( spName + prefixLen, sNameLen - prefixLen ) );
+		}
+	};
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		ch_string name = Pak_GetEntryName( spPak, i );
+
+		if ( prefixLen && ( name.size <= prefixLen || name.data[ dir.size() ] != '/' || memcmp( name.data, dir.data(), dir.size() ) != 0 ) )
+			continue;
+
+		// add each directory between the one we're scanning and this file
+		size_t slash = prefixLen;
+		bool   inDir = false;
+
+		while ( true )
+		{
+			const char* next = (const char*)memchr( name.data + slash, '/', name.size - slash );
+
+			if ( !next )
+				break;
+
+			inDir = true;
+			slash = next - name.data;
+
+			if ( !( sFlags & ReadDir_NoDirs ) && dirs.emplace( name.data, slash ).second )
+				addPath( name.data, slash );
+
+			if ( !( sFlags & ReadDir_Recursive ) )
+				break;
+
+			slash++;
+		}
+
+		if ( inDir && !( sFlags & ReadDir_Recursive ) )
+			continue;
+
+		if ( !( sFlags & ReadDir_NoFiles ) )
+			addPath( name.data, name.size );
+	}
+
+	return true;
+}
+
+
+static void filesys_pak_shutdown()
+{
+	std::lock_guard< std::mutex > lock( g_pak_mutex );
+
+	for ( fs_pak_mount_t& mount : g_paks )
+		Pak_Close( mount.apPak );
+
+	g_paks.clear();
+}
+
+
+// ----------------------------------------------------------------
+// File Index
+
+
+// Turns a path into the form used for comparing paths in the index: forward slashes, and no empty, "." or ".." segments
+// Returns false if ".." goes above the start of the path
+static bool filesys_index_normalize( const char* spPath, size_t sLen, std::string& srOut )
+{
+	srOut.clear();
+	srOut.reserve( sLen );
+
+	// keep the root of absolute unix paths
+	if ( sLen && ( spPath[ 0 ] == '/' || spPath[ 0 ] == '\\' ) )
+		srOut.push_back( '/' );
+
+	size_t rootLen = srOut.size();
+	size_t i       = 0;
+
+	while ( i < sLen )
+	{
+		size_t start = i;
+
+		while ( i < sLen && spPath[ i ] != '/' && spPath[ i ] != '\\' )
+			i++;
+
+		size_t segmentLen = i - start;
+		i++;
+
+		if ( segmentLen == 0 || ( segmentLen == 1 && spPath[ start ] == '.' ) )
+			continue;
+
+		if ( segmentLen == 2 && spPath[ start ] == '.' && spPath[ start + 1 ] == '.' )
+		{
+			if ( srOut.size() == rootLen )
+				return false;
+
+			size_t slash = srOut.find_last_of( '/' );
+			srOut.resize( ( slash == std::string::npos || slash < rootLen ) ? rootLen : slash );
+			continue;
+		}
+
+		if ( srOut.size() > rootLen )
+			srOut.push_back( '/' );
+
+		srOut.append( spPath + start, segmentLen );
+	}
+
+	return true;
+}
+
+
+// Turn a normalized relative path into an index key, paths aren't case sensitive on windows
+static void filesys_index_make_key( std::string& srPath )
+{
+#ifdef _WIN32
+	for ( char& c : srPath )
+		c = (char)tolower( (unsigned char)c );
+#endif
+}
+
+
+static bool filesys_pak_normalize( const char* spPath, size_t sLen, std::string& srOut )
+{
+	if ( !filesys_index_normalize( spPath, sLen, srOut ) )
+		return false;
+
+	for ( char& c : srOut )
+		c = (char)tolower( (unsigned char)c );
+
+	return true;
+}
+
+
+// If a normalized path is inside this search path, get the path relative to it
+static bool filesys_index_get_relative( const fs_index_root_t& srRoot, const std::string& srPath, std::string_view& srRelative )
+{
+	const std::string& root = srRoot.aNormPath;
+
+	if ( srPath.size() <= root.size() + 1 || srPath[ root.size() ] != '/' )
+		return false;
+
+#ifdef _WIN32
+	if ( ch_strncasecmp( srPath.data(), root.data(), root.size() ) != 0 )
+		return false;
+#else
+	if ( srPath.compare( 0, root.size(), root ) != 0 )
+		return false;
+#endif
+
+	srRelative = std::string_view( srPath ).substr( root.size() + 1 );
+	return true;
+}
+
+
+static void filesys_index_insert( u32 sType, u32 sRoot, std::string_view sRelative, bool sIsDir )
+{
+	fs_index_t& index = g_index[ sType ];
+
+	std::string key( sRelative );
+	filesys_index_make_key( key );
+
+	auto it = index.aFiles.find( key );
+
+	// it's already in a search path with a higher priority
+	if ( it != index.aFiles.end() && it->second.aSearchPath < sRoot )
+		return;
+
+	fs_index_entry_t& entry = index.aFiles[ key ];
+	entry.aSearchPath       = sRoot;
+	entry.aIsDir            = sIsDir;
+	entry.aFullPath         = index.aRoots[ sRoot ].aPath;
+	entry.aFullPath += CH_PATH_SEP_STR;
+	entry.aFullPath += sRelative;
+
+#ifdef _WIN32
+	std::replace( entry.aFullPath.begin() + index.aRoots[ sRoot ].aPath.size(), entry.aFullPath.end(), '/', '\\' );
+#endif
+}
+
+
+// Add a file or directory to the index for every search path it's in
+static void filesys_index_add_path( const std::string& srPath, bool sIsDir )
+{
+	std::string norm;
+	if ( !filesys_index_normalize( srPath.data(), srPath.size(), norm ) )
+		return;
+
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
+	{
+		fs_index_t& index = g_index[ type ];
+
+		for ( u32 root = 0; root < index.aRoots.size(); root++ )
+		{
+			std::string_view relative;
+			if ( filesys_index_get_relative( index.aRoots[ root ], norm, relative ) )
+				filesys_index_insert( type, root, relative, sIsDir );
+		}
+	}
+}
+
+
+// Remove a file or directory from the index, if another search path has it, that one takes its place
+static void filesys_index_remove_path( const std::string& srPath )
+{
+	std::string norm;
+	if ( !filesys_index_normalize( srPath.data(), srPath.size(), norm ) )
+		return;
+
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
+	{
+		fs_index_t& index = g_index[ type ];
+
+		for ( u32 root = 0; root < index.aRoots.size(); root++ )
+		{
+			std::string_view relative;
+			if ( !filesys_index_get_relative( index.aRoots[ root ], norm, relative ) )
+				continue;
+
+			std::string key( relative );
+			filesys_index_make_key( key );
+
+			auto it = index.aFiles.find( key );
+
+			if ( it == index.aFiles.end() || it->second.aSearchPath != root )
+				continue;
+
+			index.aFiles.erase( it );
+
+			// this is rare enough that checking the disk is fine
+			for ( u32 next = root + 1; next < index.aRoots.size(); next++ )
+			{
+				if ( ch_pak_t* pak = index.aRoots[ next ].apPak )
+				{
+					if ( Pak_Find( pak, relative.data(), relative.size() ) == -1 )
+						continue;
+
+					filesys_index_insert( type, next, relative, false );
+					break;
+				}
+
+				std::string fallback = index.aRoots[ next ].aPath + CH_PATH_SEP_STR + std::string( relative );
+
+				struct stat s;
+				if ( stat( fallback.c_str(), &s ) != 0 )
+					continue;
+
+				filesys_index_insert( type, next, relative, s.st_mode & S_IFDIR );
+				break;
+			}
+		}
+	}
+}
+
+
+// Is this path inside any search path, not including the search path itself
+static bool filesys_index_in_root( const std::string& srPath )
+{
+	std::string norm;
+	if ( !filesys_index_normalize( srPath.data(), srPath.size(), norm ) )
+		return false;
+
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
+	{
+		for ( const fs_index_root_t& root : g_index[ type ].aRoots )
+		{
+			std::string_view relative;
+			if ( !root.apPak && filesys_index_get_relative( root, norm, relative ) )
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
+static void filesys_index_watch( const std::string& srDir )
+{
+#if CH_FS_WATCH
+	if ( g_index_inotify == -1 )
+		return;
+
+	int wd = inotify_add_watch( g_index_inotify, srDir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR );
+
+	if ( wd < 0 )
+	{
+		// most likely hit fs.inotify.max_user_watches, so missing files have to be checked for on disk again
+		if ( !g_index_watch_failed )
+			Log_WarnF( gLC_FileSystem, "Failed to watch directory for file index, falling back to checking the disk for missing files: \"%s\" - %s\n", srDir.c_str(), strerror( errno ) );
+
+		g_index_watch_failed = true;
+		return;
+	}
+
+	g_index_watches[ wd ] = srDir;
+#endif
+}
+
+
+// Add everything in this directory to the index
+static void filesys_index_scan( const std::string& srDir )
+{
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	auto            it = fs::recursive_directory_iterator( srDir, fs::directory_options::follow_directory_symlink | fs::directory_options::skip_permission_denied, ec );
+
+	if ( ec )
+		return;
+
+	filesys_index_watch( srDir );
+
+	for ( ; it != fs::recursive_directory_iterator(); it.increment( ec ) )
+	{
+		if ( ec )
+			break;
+
+		bool        isDir = it->is_directory( ec );
+		std::string path  = it->path().string();
+
+		filesys_index_add_path( path, isDir );
+
+		if ( !isDir )
+			continue;
+
+		if ( it.depth() >= FS_INDEX_MAX_DEPTH )
+			it.disable_recursion_pending();
+		else
+			filesys_index_watch( path );
+	}
+}
+
+
+#if CH_FS_WATCH
+static void filesys_index_handle_event( const inotify_event* spEvent )
+{
+	// events were dropped, we don't know what changed
+	if ( spEvent->mask & IN_Q_OVERFLOW )
+	{
+		g_index_dirty = true;
+		return;
+	}
+
+	auto it = g_index_watches.find( spEvent->wd );
+
+	if ( it == g_index_watches.end() )
+		return;
+
+	if ( spEvent->mask & IN_IGNORED )
+	{
+		g_index_watches.erase( it );
+		return;
+	}
+
+	if ( spEvent->len == 0 )
+		return;
+
+	std::string path  = it->second + CH_PATH_SEP_STR + spEvent->name;
+	bool        isDir = spEvent->mask & IN_ISDIR;
+
+	if ( spEvent->mask & ( IN_CREATE | IN_MOVED_TO ) )
+	{
+		filesys_index_add_path( path, isDir );
+
+		// anything could of been added to it before we started watching it
+		if ( isDir )
+			filesys_index_scan( path );
+	}
+	else if ( spEvent->mask & ( IN_DELETE | IN_MOVED_FROM ) )
+	{
+		filesys_index_remove_path( path );
+
+		// everything inside of it is gone too, rebuilding is simpler than finding all of it
+		if ( isDir )
+			g_index_dirty = true;
+	}
+}
+
+
+static void filesys_index_watch_thread()
+{
+	alignas( inotify_event ) char buffer[ 4096 ];
+
+	while ( g_index_watch_running )
+	{
+		pollfd pfd{ g_index_inotify, POLLIN, 0 };
+
+		if ( poll( &pfd, 1, 250 ) <= 0 )
+			continue;
+
+		ssize_t len = read( g_index_inotify, buffer, sizeof( buffer ) );
+
+		if ( len <= 0 )
+			continue;
+
+		std::unique_lock< std::shared_mutex > lock( g_index_mutex );
+
+		for ( char* ptr = buffer; ptr < buffer + len; )
+		{
+			const inotify_event* event = (const inotify_event*)ptr;
+			ptr += sizeof( inotify_event ) + event->len;
+
+			filesys_index_handle_event( event );
+		}
+	}
+}
+#endif
+
+
+// Add every file in a pak to the index, and the directories they're in
+static void filesys_index_add_pak( u32 sType, u32 sRoot, ch_pak_t* spPak )
+{
+	std::unordered_set< std::string_view > dirs;
+	u32                                    count = Pak_GetEntryCount( spPak );
+
+	for ( u32 i = 0; i < count; i++ )
+	{
+		ch_string        name = Pak_GetEntryName( spPak, i );
+		std::string_view path( name.data, name.size );
+
+		filesys_index_insert( sType, sRoot, path, false );
+
+		for ( size_t slash = path.find( '/' ); slash != std::string_view::npos; slash = path.find( '/', slash + 1 ) )
+		{
+			if ( dirs.insert( path.substr( 0, slash ) ).second )
+				filesys_index_insert( sType, sRoot, path.substr( 0, slash ), true );
+		}
+	}
+}
+
+
+// The index can only be trusted for files that don't exist if something tells us when files are added
+static bool filesys_index_is_complete()
+{
+#if CH_FS_WATCH
+	return g_index_inotify != -1 && !g_index_watch_failed;
+#else
+	return false;
+#endif
+}
+
+
+// g_index_mutex must be locked for writing
+static void filesys_index_rebuild()
+{
+	PROF_SCOPE();
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+#if CH_FS_WATCH
+	if ( g_index_inotify == -1 )
+	{
+		g_index_inotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+
+		if ( g_index_inotify == -1 )
+		{
+			Log_WarnF( gLC_FileSystem, "Failed to init inotify, file index will not be updated on changes - %s\n", strerror( errno ) );
+		}
+		else
+		{
+			g_index_watch_running = true;
+			g_index_watch_thread  = new std::thread( filesys_index_watch_thread );
+		}
+	}
+
+	for ( auto& [ wd, dir ] : g_index_watches )
+		inotify_rm_watch( g_index_inotify, wd );
+
+	g_index_watches.clear();
+	g_index_watch_failed = false;
+#endif
+
+	std::vector< const std::string* > roots;
+
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
+	{
+		fs_index_t& index = g_index[ type ];
+		index.aFiles.clear();
+		index.aRoots.resize( g_paths_count[ type ] );
+		index.aHasPaks = false;
+
+		for ( u32 i = 0; i < g_paths_count[ type ]; i++ )
+		{
+			fs_index_root_t& root = index.aRoots[ i ];
+			root.aPath.assign( g_paths[ type ][ i ].data, g_paths[ type ][ i ].size );
+			filesys_index_normalize( root.aPath.data(), root.aPath.size(), root.aNormPath );
+			root.apPak = filesys_get_pak( g_paths[ type ][ i ] );
+
+			// paks are added right away, they can't change
+			if ( root.apPak )
+			{
+				filesys_index_add_pak( type, i, root.apPak );
+				index.aHasPaks = true;
+				continue;
+			}
+
+			roots.push_back( &root.aNormPath );
+		}
+	}
+
+	// search paths are commonly inside of other search paths, the root path has the game path in it,
+	// so scan the outer most ones first, and skip search paths that have already been scanned
+	std::sort( roots.begin(), roots.end(), []( const std::string* a, const std::string* b ) { return a->size() < b->size(); } );
+
+	std::vector< const std::string* > scanned;
+
+	for ( const std::string* root : roots )
+	{
+		bool skip = false;
+
+		for ( const std::string* other : scanned )
+		{
+			fs_index_root_t  otherRoot{ "", *other };
+			std::string_view relative;
+
+			if ( *other == *root || filesys_index_get_relative( otherRoot, *root, relative ) )
+			{
+				skip = true;
+				break;
+			}
+		}
+
+		if ( skip )
+			continue;
+
+		scanned.push_back( root );
+		filesys_index_scan( *root );
 	}
 
-	ch_string cleanedPath = FileSys_CleanPath( output.data, output.size );
-	ch_str_free( output.data );
+	g_index_dirty = false;
 
-	return cleanedPath;
+	auto   endTime = std::chrono::high_resolution_clock::now();
+	float  time    = std::chrono::duration< float, std::chrono::milliseconds::period >( endTime - startTime ).count();
+	size_t count   = 0;
+
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
+		count += g_index[ type ].aFiles.size();
+
+	Log_DevF( gLC_FileSystem, 1, "Built file index in %.3f ms, %zu entries\n", time, count );
 }
 
 
-static bool filesys_is_invalid_path_type( ESearchPathType type )
+// Index a search path that was just added to the end of the list, instead of rebuilding everything
+static void filesys_index_add_root( u32 sType )
 {
-	if ( type >= ESearchPathType_Count )
+	// not built yet, or it's already being rebuilt on the next lookup
+	if ( g_index_dirty )
+		return;
+
+	if ( !fs_index )
 	{
-		Log_Error( "Invalid Search Path Type\n" );
-		return true;
+		g_index_dirty = true;
+		return;
 	}
 
-	return false;
-}
+	PROF_SCOPE();
 
+	std::unique_lock< std::shared_mutex > lock( g_index_mutex );
 
-void FileSys_AddSearchPath( const char* path, s32 pathLen, ESearchPathType type )
-{
-	if ( filesys_is_invalid_path_type( type ) )
+	if ( g_index_dirty )
 		return;
 
-	ch_string fullPath = FileSys_BuildSearchPath( path, pathLen );
+	fs_index_t& index     = g_index[ sType ];
+	u32         rootIndex = g_paths_count[ sType ] - 1;
 
-	if ( !fullPath.data )
+	// something changed the paths without going through here
+	if ( index.aRoots.size() != rootIndex )
+	{
+		g_index_dirty = true;
 		return;
+	}
 
-	// realloc paths
-	ch_string* new_data = ch_realloc( g_paths[ type ], g_paths_count[ type ] + 1 );
+	fs_index_root_t& root = index.aRoots.emplace_back();
+	root.aPath.assign( g_paths[ sType ][ rootIndex ].data, g_paths[ sType ][ rootIndex ].size );
+	filesys_index_normalize( root.aPath.data(), root.aPath.size(), root.aNormPath );
+	root.apPak = filesys_get_pak( g_paths[ sType ][ rootIndex ] );
 
-	if ( !new_data )
+	if ( root.apPak )
 	{
-		Log_Error( "Failed to allocate memory for search path array\n" );
+		filesys_index_add_pak( sType, rootIndex, root.apPak );
+		index.aHasPaks = true;
 		return;
 	}
 
-	g_paths[ type ] = new_data;
-	g_paths[ type ][ g_paths_count[ type ]++ ] = fullPath;
+	// this adds the files for every search path they're in, so it works even if other paths are inside of this one
+	filesys_index_scan( root.aNormPath );
 }
 
 
-// this one is weird, it has to build the path to remove it, why not just pass an index to remove?
-void FileSys_RemoveSearchPath( const char* path, s32 pathLen, ESearchPathType type )
+static void filesys_index_shutdown()
 {
-	if ( filesys_is_invalid_path_type( type ) )
-		return;
+#if CH_FS_WATCH
+	if ( g_index_watch_thread )
+	{
+		g_index_watch_running = false;
+		g_index_watch_thread->join();
+		delete g_index_watch_thread;
+		g_index_watch_thread = nullptr;
+	}
 
-	ch_string fullPath = FileSys_BuildSearchPath( path );
+	if ( g_index_inotify != -1 )
+		close( g_index_inotify );
 
-    if ( !fullPath.data )
-        return;
+	g_index_inotify = -1;
+	g_index_watches.clear();
+#endif
 
-	for ( u32 i = 0; i < g_paths_count[ type ]; i++ )
+	for ( u32 type = 0; type < ESearchPathType_Count; type++ )
 	{
-		if ( ch_str_equals( fullPath, g_paths[ type ][ i ] ) )
-		{
-			ch_str_free( g_paths[ type ][ i ].data );
-
-			// shift all the paths down
-			for ( u32 j = i; j < g_paths_count[ type ] - 1; j++ )
-				g_paths[ type ][ j ] = g_paths[ type ][ j + 1 ];
-
-			g_paths_count[ type ]--;
-			break;
-		}
+		g_index[ type ].aFiles.clear();
+		g_index[ type ].aRoots.clear();
 	}
 
-    ch_str_free( fullPath.data );
+	g_index_dirty = true;
 }
 
 
-void FileSys_InsertSearchPath( u32 index, const char* path, s32 pathLen, ESearchPathType type )
+// Update the index for a file we just wrote, moved or created,
+// so it can be found right away instead of after the inotify event, or at all without inotify
+static void filesys_index_update( const char* spPath )
 {
-	if ( filesys_is_invalid_path_type( type ) )
+	if ( g_index_dirty )
 		return;
 
-	if ( !ch_str_check_empty( path, pathLen ) )
+	std::error_code ec;
+	std::string     fullPath = std::filesystem::absolute( spPath, ec ).string();
+
+	if ( ec )
+		return;
+
+	std::unique_lock< std::shared_mutex > lock( g_index_mutex );
+
+	struct stat s;
+	if ( stat( fullPath.c_str(), &s ) != 0 )
 	{
-		Log_Error( "Failed to insert search path, path or path length is empty\n" );
+		filesys_index_remove_path( fullPath );
 		return;
 	}
 
-	ch_string fullPath = FileSys_BuildSearchPath( path );
+	filesys_index_add_path( fullPath, s.st_mode & S_IFDIR );
 
-	if ( !fullPath.data )
+	if ( s.st_mode & S_IFDIR )
+		filesys_index_watch( fullPath );
+
+	// the parent directories could of just been made with create_directories, before anything was watching them
+	std::string parent = std::filesystem::path( fullPath ).parent_path().string();
+
+	while ( filesys_index_in_root( parent ) )
 	{
-		Log_Error( "Failed to build search path\n" );
-		return;
+		filesys_index_add_path( parent, true );
+		filesys_index_watch( parent );
+
+		parent = std::filesystem::path( parent ).parent_path().string();
 	}
+}
 
-	index = std::clamp( index, 0U, g_paths_count[ type ] );
 
-	// realloc paths
-	ch_string* new_data = ch_realloc( g_paths[ type ], g_paths_count[ type ] + 1 );
+enum EFileIndexResult
+{
+	EFileIndexResult_Found,
+	EFileIndexResult_NotFound,
+	EFileIndexResult_Unknown,  // check the disk
+};
 
-	if ( !new_data )
+
+#undef ch_str_copy
+
+static EFileIndexResult filesys_index_find( STR_FILE_LINE_DEF ESearchPathType sType, const char* spPath, s32 sLen, bool sDirOnly, ch_string& srOutput )
+{
+	PROF_SCOPE();
+
+	if ( !fs_index )
+		return EFileIndexResult_Unknown;
+
+	if ( g_index_dirty )
 	{
-		Log_Error( "Failed to allocate memory for search path array\n" );
-		return;
+		std::unique_lock< std::shared_mutex > lock( g_index_mutex );
+
+		if ( g_index_dirty )
+			filesys_index_rebuild();
 	}
 
-	g_paths[ type ] = new_data;
-	g_paths_count[ type ]++;
+	// reused to avoid an allocation for every lookup
+	static thread_local std::string key;
 
-	// move all the paths up
-	// memcpy( &g_paths[ type ][ index + 1 ], &g_paths[ type ][ index ], sizeof( ch_string ) * ( g_paths_count[ type ] - index ) );
+	if ( !filesys_index_normalize( spPath, sLen, key ) || key.empty() )
+		return EFileIndexResult_Unknown;
 
-	for ( u32 i = g_paths_count[ type ] - 1; i > index; i-- )
+	filesys_index_make_key( key );
+
+	std::shared_lock< std::shared_mutex > lock( g_index_mutex );
+
+	const fs_index_t& index = g_index[ sType ];
+	auto              it    = index.aFiles.find( key );
+
+#ifndef _WIN32
+	// files in paks aren't case sensitive
+	if ( it == index.aFiles.end() && index.aHasPaks )
 	{
-		g_paths[ type ][ i ] = g_paths[ type ][ i - 1 ];
+		for ( char& c : key )
+			c = (char)tolower( (unsigned char)c );
+
+		it = index.aFiles.find( key );
+
+		if ( it != index.aFiles.end() && !index.aRoots[ it->second.aSearchPath ].apPak )
+			it = index.aFiles.end();
 	}
+#endif
 
-	// now we have an empty slot
-	g_paths[ type ][ index ] = fullPath;
-}
+	if ( it == index.aFiles.end() )
+		return filesys_index_is_complete() ? EFileIndexResult_NotFound : EFileIndexResult_Unknown;
 
+	// a file is in a higher priority search path, but there could be a directory in a lower priority one
+	if ( sDirOnly && !it->second.aIsDir )
+		return EFileIndexResult_Unknown;
 
-void FileSys_ReloadSearchPaths()
-{
-	core_search_paths_reload();
+	srOutput = ch_str_copy( STR_FILE_LINE_INT it->second.aFullPath.data(), it->second.aFullPath.size() );
+	return EFileIndexResult_Found;
 }
 
 
-// maybe faster calls? probably not
-inline bool exists( const char* path )
+CONCMD( fs_index_rebuild )
 {
-    return ( access( path, 0 ) != -1 );
+	std::unique_lock< std::shared_mutex > lock( g_index_mutex );
+	filesys_index_rebuild();
 }
 
 
-inline bool is_dir( const char* path )
+CONCMD( fs_index_stats )
 {
-    struct stat s;
-    if ( stat( path, &s ) == 0 )
-        return (s.st_mode & S_IFDIR);
+	std::shared_lock< std::shared_mutex > lock( g_index_mutex );
 
-    return false;
-}
+	log_t group = Log_GroupBegin( gLC_FileSystem );
 
+	Log_GroupF( group, "File Index: %s%s\n", fs_index ? "Enabled" : "Disabled", g_index_dirty ? " (Needs Rebuild)" : "" );
+	Log_GroupF( group, "    Search Paths:       %zu entries\n", g_index[ ESearchPathType_Path ].aFiles.size() );
+	Log_GroupF( group, "    Binary Paths:       %zu entries\n", g_index[ ESearchPathType_Binary ].aFiles.size() );
+	Log_GroupF( group, "    Source Asset Paths: %zu entries\n", g_index[ ESearchPathType_SourceAssets ].aFiles.size() );
+
+#if CH_FS_WATCH
+	Log_GroupF( group, "    Watched Directories: %zu%s\n", g_index_watches.size(), g_index_watch_failed ? " (Some Failed)" : "" );
+#endif
+
+	Log_GroupF( group, "    Missing Files: %s\n", filesys_index_is_complete() ? "Trusted" : "Checked on Disk" );
+
+	Log_GroupEnd( group );
+}
 
-#undef ch_str_copy
 
 inline ch_string FileSys_FindFileAbs( STR_FILE_LINE_DEF const char* file, s32 fileLen )
 {
@@ -579,7 +1575,10 @@ inline ch_string FileSys_FindFileAbs( STR_FILE_LINE_DEF const char* file, s32 fi
 	out.data = nullptr;
 	out.size = 0;
 
-	if ( exists( file ) )
+	size_t len  = fileLen == -1 ? strlen( file ) : fileLen;
+	int    mode = 0;
+
+	if ( filesys_pak_stat( file, len, mode ) ? mode == S_IFREG : exists( file ) )
 		out = ch_str_copy( STR_FILE_LINE_INT file, fileLen );
 
 	return out;
@@ -599,15 +1598,32 @@ ch_string FileSys_FindFileBase( STR_FILE_LINE_DEF ESearchPathType type, const ch
 	if ( FileSys_IsAbsolute( filePath, fileLen ) )
 		return FileSys_FindFileAbs( STR_FILE_LINE_INT filePath, fileLen );
 
+	ch_string        indexPath;
+	EFileIndexResult indexResult = filesys_index_find( STR_FILE_LINE_INT type, filePath, fileLen, false, indexPath );
+
+	if ( indexResult != EFileIndexResult_Unknown )
+		return indexPath;
+
 	for ( u32 i = 0; i < g_paths_count[ type ]; i++ )
 	{
 		const ch_string& searchPath    = g_paths[ type ][ i ];
 
-		const char*      pathParts[]   = { searchPath.data, CH_PATH_SEP_STR, filePath };
-		const size_t     lengthParts[] = { searchPath.size, 1, fileLen };
-		ch_string_auto   concat        = ch_str_join( 3, pathParts, lengthParts );
+		if ( ch_pak_t* pak = filesys_get_pak( searchPath ) )
+		{
+			std::string name;
+			if ( !filesys_pak_normalize( filePath, fileLen == -1 ? strlen( filePath ) : fileLen, name ) || Pak_Find( pak, name.data(), name.size() ) == -1 )
+				continue;
+
+			const char*  pakParts[]   = { searchPath.data, CH_PATH_SEP_STR, name.data() };
+			const size_t pakLengths[] = { searchPath.size, 1, name.size() };
+			return ch_str_join( 3, pakParts, pakLengths );
+		}
+
+		// most of these won't exist, so build them on the stack
+		ch_string_small<> concat( searchPath );
+		concat.append( CH_PATH_SEP_STR, 1 );
 
-		if ( !concat.data )
+		if ( !concat.append( filePath, fileLen ) )
 		{
 			Log_Error( "Failed to allocate memory for search path\n" );
 			return {};
@@ -682,24 +1698,38 @@ ch_string FileSys_FindDir( const char* path, s32 pathLen, ESearchPathType sType
 	{
 		ch_string out;
 
-		if ( is_dir( path ) )
+		int mode = 0;
+
+		if ( filesys_pak_stat( path, pathLen == -1 ? strlen( path ) : pathLen, mode ) ? mode == S_IFDIR : is_dir( path ) )
 			out = ch_str_copy( path );
 
 		return out;
 	}
 
+	ch_string        indexPath;
+	EFileIndexResult indexResult = filesys_index_find( STR_FILE_LINE sType, path, pathLen, true, indexPath );
+
+	if ( indexResult != EFileIndexResult_Unknown )
+		return indexPath;
+
+	size_t len = pathLen == -1 ? strlen( path ) : pathLen;
+
     for ( u32 i = 0; i < g_paths_count[ sType ]; i++ )
     {
 		const ch_string& searchPath = g_paths[ sType ][ i ];
-		
-		const char*  paths[]   = { searchPath.data, CH_PATH_SEP_STR, path };
-		const size_t lengths[] = { searchPath.size, 1, pathLen };
-		ch_string    fullPath  = ch_str_join( 3, paths, lengths );
+		ch_pak_t*        pak        = filesys_get_pak( searchPath );
+
+		if ( pak && !filesys_pak_has_dir( pak, path, len ) )
+			continue;
+
+		ch_string_small<> fullPath( searchPath );
+		fullPath.append( CH_PATH_SEP_STR, 1 );
+		fullPath.append( path, len );
 
         // does item exist?
-        if ( is_dir( fullPath.data ) )
+        if ( pak || is_dir( fullPath.data ) )
         {
-            return fullPath;
+            return ch_str_copy( fullPath.data, fullPath.size );
         }
     }
 
@@ -721,6 +1751,36 @@ ch_string FileSys_ReadFile( const char* path, s32 pathLen, ESearchPathType sType
 		return {};
 	}
 
+	ch_string buffer;
+
+	const char* pakPath    = nullptr;
+	size_t      pakPathLen = 0;
+
+	if ( ch_pak_t* pak = filesys_resolve_pak( fullPath.data, fullPath.size, pakPath, pakPathLen ) )
+	{
+		s64                   index = Pak_Find( pak, pakPath, pakPathLen );
+		const ch_pak_entry_t* entry = index == -1 ? nullptr : Pak_GetEntry( pak, index );
+
+		if ( entry )
+		{
+			buffer.data = ch_malloc< char >( entry->size + 1 );
+			buffer.size = entry->size;
+		}
+
+		if ( !entry || !Pak_Read( pak, index, buffer.data ) )
+		{
+			Log_ErrorF( gLC_FileSystem, "Failed to read file from pak: %s\n", path );
+			ch_free( buffer.data );
+			ch_str_free( fullPath.data );
+			return {};
+		}
+
+		buffer.data[ buffer.size ] = '\0';
+		ch_str_add( buffer );
+		ch_str_free( fullPath.data );
+		return buffer;
+	}
+
     /* Open file.  */
     std::ifstream file( fullPath.data, std::ios::ate | std::ios::binary );
     if ( !file.is_open() )
@@ -730,9 +1790,8 @@ ch_string FileSys_ReadFile( const char* path, s32 pathLen, ESearchPathType sType
 		return {};
     }
 
-    int fileSize = ( int )file.tellg(  );
+    u64 fileSize = ( u64 )file.tellg(  );
 
-	ch_string buffer;
 	buffer.data = ch_malloc< char >( fileSize + 1 );
 	buffer.size = fileSize;
 
@@ -754,6 +1813,168 @@ ch_string FileSys_ReadFile( const char* path, s32 pathLen, ESearchPathType sType
 }
 
 
+ch_file_view FileSys_MapFile( const char* spPath )
+{
+	PROF_SCOPE();
+
+	ch_file_view view;
+
+	if ( !spPath )
+		return view;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA( spPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+	if ( file == INVALID_HANDLE_VALUE )
+		return view;
+
+	LARGE_INTEGER size{};
+	GetFileSizeEx( file, &size );
+
+	// can't map an empty file
+	if ( size.QuadPart == 0 )
+	{
+		CloseHandle( file );
+		view.data = "";
+		return view;
+	}
+
+	// the view keeps the file open, so the handles can be closed right away
+	HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	void*  data    = mapping ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+
+	if ( mapping )
+		CloseHandle( mapping );
+
+	CloseHandle( file );
+
+	if ( !data )
+		return view;
+
+	view.size = size.QuadPart;
+#else
+	int fd = open( spPath, O_RDONLY | O_CLOEXEC );
+
+	if ( fd == -1 )
+		return view;
+
+	struct stat s;
+	if ( fstat( fd, &s ) != 0 || !S_ISREG( s.st_mode ) )
+	{
+		close( fd );
+		return view;
+	}
+
+	// can't map an empty file
+	if ( s.st_size == 0 )
+	{
+		close( fd );
+		view.data = "";
+		return view;
+	}
+
+	// the mapping keeps the file open, so it can be closed right away
+	void* data = mmap( nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+
+	if ( data == MAP_FAILED )
+		return view;
+
+	view.size = s.st_size;
+#endif
+
+	view.data  = (const char*)data;
+	view.aType = EFileViewType_Mapped;
+	return view;
+}
+
+
+ch_file_view FileSys_OpenView( const char* path, s32 pathLen, ESearchPathType sType )
+{
+	PROF_SCOPE();
+
+	ch_file_view view;
+	ch_string    fullPath = FileSys_FindFileEx( path, pathLen, sType );
+
+	if ( !fullPath.data )
+	{
+		Log_ErrorF( gLC_FileSystem, "Failed to find file: %s\n", path );
+		return view;
+	}
+
+	const char* pakPath    = nullptr;
+	size_t      pakPathLen = 0;
+
+	if ( ch_pak_t* pak = filesys_resolve_pak( fullPath.data, fullPath.size, pakPath, pakPathLen ) )
+	{
+		s64                   index = Pak_Find( pak, pakPath, pakPathLen );
+		const ch_pak_entry_t* entry = index == -1 ? nullptr : Pak_GetEntry( pak, index );
+
+		if ( !entry )
+		{
+			Log_ErrorF( gLC_FileSystem, "Failed to find file in pak: %s\n", path );
+		}
+		else if ( entry->compression == EPakCompression_None )
+		{
+			view.data = Pak_GetView( pak, index );
+			view.size = entry->size;
+		}
+		else
+		{
+			char* data = ch_malloc< char >( entry->size );
+
+			if ( Pak_Read( pak, index, data ) )
+			{
+				view.data  = data;
+				view.size  = entry->size;
+				view.aType = EFileViewType_Heap;
+			}
+			else
+			{
+				Log_ErrorF( gLC_FileSystem, "Failed to read file from pak: %s\n", path );
+				ch_free( data );
+			}
+		}
+	}
+	else
+	{
+		view = FileSys_MapFile( fullPath.data );
+
+		if ( !view.data )
+			Log_ErrorF( gLC_FileSystem, "Failed to map file: %s\n", path );
+	}
+
+	ch_str_free( fullPath.data );
+	return view;
+}
+
+
+bool FileSys_IsInPak( const char* path, s32 pathLen )
+{
+	int mode = 0;
+	return path && filesys_pak_stat( path, pathLen == -1 ? strlen( path ) : pathLen, mode );
+}
+
+
+void FileSys_CloseView( ch_file_view& srView )
+{
+	if ( srView.aType == EFileViewType_Mapped )
+	{
+#ifdef _WIN32
+		UnmapViewOfFile( srView.data );
+#else
+		munmap( (void*)srView.data, srView.size );
+#endif
+	}
+	else if ( srView.aType == EFileViewType_Heap )
+	{
+		ch_free( (void*)srView.data );
+	}
+
+	srView = {};
+}
+
+
 // Saves a file - Returns true if it succeeded.
 // TODO: maybe change this to not rename the old file until the new file is fully written
 bool FileSys_SaveFile( const char* path, std::vector< char >& srData, s32 pathLen )
@@ -796,6 +2017,8 @@ bool FileSys_SaveFile( const char* path, std::vector< char >& srData, s32 pathLe
 	size_t amountWritten = fwrite( srData.data(), srData.size(), 1, fp );
 	fclose( fp );
 
+	filesys_index_update( path );
+
     // Did we have to rename an old file?
     if ( oldFile.size )
 	{
@@ -844,9 +2067,13 @@ static bool FileSys_CheckStatFlags( const char* path, s32 pathLen, bool noPaths,
     PROF_SCOPE();
 
     struct stat s;
+	int         pakMode = 0;
 
     if ( noPaths || FileSys_IsAbsolute( path, pathLen ) )
     {
+		if ( filesys_pak_stat( path, pathLen == -1 ? strlen( path ) : pathLen, pakMode ) )
+			return ( pakMode & flags );
+
 		if ( stat( path, &s ) == 0 )
 			return ( s.st_mode & flags );
     }
@@ -857,6 +2084,12 @@ static bool FileSys_CheckStatFlags( const char* path, s32 pathLen, bool noPaths,
 		if ( !fullPath.data )
 			return false;
 
+		if ( filesys_pak_stat( fullPath.data, fullPath.size, pakMode ) )
+		{
+			ch_str_free( fullPath.data );
+			return ( pakMode & flags );
+		}
+
 		if ( stat( fullPath.data, &s ) == 0 )
 		{
 			bool hasFlag = ( s.st_mode & flags );
@@ -885,8 +2118,13 @@ bool FileSys_Exists( const char* path, s32 pathLen, bool noPaths )
 {
     PROF_SCOPE();
 
+	int pakMode = 0;
+
     if ( noPaths || FileSys_IsAbsolute( path, pathLen ) )
 	{
+		if ( filesys_pak_stat( path, pathLen == -1 ? strlen( path ) : pathLen, pakMode ) )
+			return pakMode != 0;
+
 		return ( access( path, 0 ) != -1 );
 	}
 	else
@@ -896,7 +2134,7 @@ bool FileSys_Exists( const char* path, s32 pathLen, bool noPaths )
 		if ( !fullPath.data )
 			return false;
 
-		if ( access( fullPath.data, 0 ) != -1 )
+		if ( filesys_pak_stat( fullPath.data, fullPath.size, pakMode ) ? pakMode != 0 : access( fullPath.data, 0 ) != -1 )
 		{
 			ch_str_free( fullPath.data );
 			return true;
@@ -1177,7 +2415,12 @@ ch_string FileSys_CleanPath( STR_FILE_LINE_DEF const char* path, s32 pathLen, ch
 // Rename a File or Directory
 bool FileSys_Rename( const char* spOld, const char* spNew )
 {
-	return ( rename( spOld, spNew ) == 0 );
+	if ( rename( spOld, spNew ) != 0 )
+		return false;
+
+	filesys_index_update( spOld );
+	filesys_index_update( spNew );
+	return true;
 }
 
 
@@ -1232,11 +2475,21 @@ bool FileSys_SetFileTimes( std::string_view srPath, float* spCreated, float* spM
 }
 
 
+void FileSys_NotifyWrite( const char* spPath )
+{
+	if ( spPath )
+		filesys_index_update( spPath );
+}
+
+
 // Create a Directory
 bool FileSys_CreateDirectory( const char* path )
 {
-	int ret = mkdir( path );
-	return ret == 0;
+	if ( mkdir( path ) != 0 )
+		return false;
+
+	filesys_index_update( path );
+	return true;
 }
 
 
@@ -1487,8 +2740,17 @@ std::vector< ch_string > FileSys_ScanDir( const char* path, size_t pathLen, Read
     {
         for ( u32 i = 0; i < g_paths_count[ ESearchPathType_Path ]; i++ )
         {
-			if ( !sys_scandir( g_paths[ ESearchPathType_Path ][ i ].data, g_paths[ ESearchPathType_Path ][ i ].size, path, pathLen, files, flags ) )
+			const ch_string& searchPath = g_paths[ ESearchPathType_Path ][ i ];
+
+			if ( ch_pak_t* pak = filesys_get_pak( searchPath ) )
+			{
+				if ( !filesys_pak_scandir( std::string( searchPath.data, searchPath.size ), pak, path, pathLen, files, flags ) )
+					continue;
+			}
+			else if ( !sys_scandir( searchPath.data, searchPath.size, path, pathLen, files, flags ) )
+			{
                 continue;
+			}
 
             if ( !( flags & ReadDir_AllPaths ) )
                 break;
@@ -1,644 +1,864 @@
 #include <string.h>
-#include <vector>
-#include <forward_list>
 #include <stdlib.h>
+#include <bit>
+#include <chrono>
 
 #include "core/json5.h"
+#include "core/console.h"
+#include "core/filesystem.h"
+#include "core/log.h"
+
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( __i386__ )
+  #define CH_JSON_SSE2 1
+  #include <emmintrin.h>
+#else
+  #define CH_JSON_SSE2 0
+#endif
 
 
 // TODO: be able to have verbose json error printing with this
 // CONVAR( json_verbose, 0 );
 
 
-constexpr int STRING_MALLOC_SIZE = 256;
-
-
-struct JsonParseState_t
+struct json_parser_t
 {
+	const char* str;
+	const char* end;
+
+	ch_json_t*  json;
+	u32         flags;
+	bool        in_situ;
+
+	// the string table is at the start of the arena, and is sized to fit every string in the source,
+	// so only the nodes after it ever need to grow
+	char*       strings;
+	u64         string_capacity;
+	u32         node_capacity;
 };
 
 
-static bool Json_IsWhitespace( char c )
+static bool json_is_number( char c )
 {
-	return c < '!' || c > '~';
+	return c >= '0' && c <= '9';
 }
 
 
-// Ends on the first character after whitespace
-static EJsonError Json_SkipWhitespace( const char*& str )
+static bool json_is_key_start( char c )
 {
-StartOfSkip:
-	while ( *str == ' ' || *str == '\t' || *str == '\n' || *str == '\r' )
-	{
-		str++;
+	return ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || c == '_' || c == '$';
+}
 
-		if ( *str == '\0' )
-			return EJsonError_None;
-	}
 
-	// check for comment character
-	if ( *str == '/' )
-	{
-		str++;
+static bool json_is_key_char( char c )
+{
+	return json_is_key_start( c ) || json_is_number( c );
+}
 
-		// is this a multiline comment?
-		if ( *str == '*' )
-		{
-			// read until */ character (probably slow)
-			while ( strncmp( str, "*/", 2 ) != 0 )
-				str++;
 
-			if ( *str == '\0' )
-				return EJsonError_None;
+static bool json_is_space( char c )
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
 
-			// advance past */ character
-			str++;
 
-			if ( *str == '\0' )
-				return EJsonError_None;
+// --------------------------------------------------------------------------------------
+// Structural scanning, 16 bytes at a time where we can
 
-			str++;
 
-			if ( *str == '\0' )
-				return EJsonError_None;
+// Returns the first character that isn't whitespace
+static const char* json_scan_space( const char* str, const char* end )
+{
+#if CH_JSON_SSE2
+	const __m128i space = _mm_set1_epi8( ' ' );
+	const __m128i tab   = _mm_set1_epi8( '\t' );
+	const __m128i line  = _mm_set1_epi8( '\n' );
+	const __m128i ret   = _mm_set1_epi8( '\r' );
 
-			// continue checking whitespace
-			goto StartOfSkip;
-		}
-		// is this a line comment?
-		else if ( *str == '/' )
-		{
-			// read until end of line
-			while ( *str != '\n' && *str != '\r' )
-				str++;
+	while ( str + 16 <= end )
+	{
+		__m128i chunk = _mm_loadu_si128( (const __m128i*)str );
+		__m128i ws    = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, space ), _mm_cmpeq_epi8( chunk, tab ) ),
+		                              _mm_or_si128( _mm_cmpeq_epi8( chunk, line ), _mm_cmpeq_epi8( chunk, ret ) ) );
 
-			if ( *str == '\0' )
-				return EJsonError_None;
+		u32     mask  = ~(u32)_mm_movemask_epi8( ws ) & 0xFFFF;
 
-			// continue checking whitespace
-			goto StartOfSkip;
-		}
+		if ( mask )
+			return str + std::countr_zero( mask );
 
-		// must be some invalid character
-		return EJsonError_InvalidCharacter;
+		str += 16;
 	}
+#endif
 
-	return EJsonError_None;
+	while ( str < end && json_is_space( *str ) )
+		str++;
+
+	return str;
 }
 
 
-static bool Json_IsControlCharacter( char c )
+// Returns the first end quote, escape or new line in a string
+static const char* json_scan_quote( const char* str, const char* end, char quote )
 {
-	// return c == '"' || c == '\'' || c == '[' || c == ']' || c == '{' || c == '}' || c == ':' || c == ',';
-	return c == ':' || c == ',';
-}
+#if CH_JSON_SSE2
+	const __m128i quoteChar = _mm_set1_epi8( quote );
+	const __m128i escape    = _mm_set1_epi8( '\\' );
+	const __m128i line      = _mm_set1_epi8( '\n' );
+	const __m128i ret       = _mm_set1_epi8( '\r' );
 
+	while ( str + 16 <= end )
+	{
+		__m128i chunk = _mm_loadu_si128( (const __m128i*)str );
+		__m128i stop  = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, quoteChar ), _mm_cmpeq_epi8( chunk, escape ) ),
+		                              _mm_or_si128( _mm_cmpeq_epi8( chunk, line ), _mm_cmpeq_epi8( chunk, ret ) ) );
 
-static bool Json_IsNumber( char c )
-{
-	return c >= '0' && c <= '9';
-}
+		u32     mask  = (u32)_mm_movemask_epi8( stop );
 
+		if ( mask )
+			return str + std::countr_zero( mask );
 
-static bool Json_ValidQuotelessKey( char c )
-{
-	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == '$';
+		str += 16;
+	}
+#endif
+
+	while ( str < end && *str != quote && *str != '\\' && *str != '\n' && *str != '\r' )
+		str++;
+
+	return str;
 }
 
 
-static EJsonError Json_ParseQuote( const char*& str, char endChar, ch_string& output )
+// Returns the end of an unquoted value, these are short, so no point in using simd here
+static const char* json_scan_token( const char* str, const char* end )
 {
-	str++;
-	output.data = (char*)malloc( STRING_MALLOC_SIZE ); // preallocate chars
-	output.size = 0;
+	while ( str < end && !json_is_space( *str ) && *str != ',' && *str != ':' && *str != ']' && *str != '}' && *str != '/' )
+		str++;
 
-	if ( output.data == nullptr )
-		return EJsonError_OutOfMemory;
+	return str;
+}
 
-	memset( output.data, 0, STRING_MALLOC_SIZE );
 
-	// const char* base = str;
-	int i = 0;
-	for ( int j = 1 ; *str != endChar; i++, str++ )
+// Ends on the first character after whitespace and comments
+static EJsonError json_skip_space( json_parser_t& p )
+{
+	while ( true )
 	{
-		// can't have new line in it
-		if ( *str == '\n' || *str == '\r' )
-			return EJsonError_NewLineInQuote;
+		p.str = json_scan_space( p.str, p.end );
 
-		if ( i % STRING_MALLOC_SIZE == 0 )
-		{
-			auto* tmp = (char*)realloc( output.data, STRING_MALLOC_SIZE * ( j + 1 ) );
-			if ( tmp == nullptr )
-			{
-				free( output.data );
-				return EJsonError_OutOfMemory;
-			}
+		if ( p.str >= p.end || *p.str != '/' )
+			return EJsonError_None;
 
-			memset( tmp, 0, ( STRING_MALLOC_SIZE * ( j + 1 ) ) - ( STRING_MALLOC_SIZE * j ) );
+		if ( p.str + 1 >= p.end )
+			return EJsonError_InvalidCharacter;
 
-			j++;
-			output.data = tmp;
+		// line comment
+		if ( p.str[ 1 ] == '/' )
+		{
+			const char* lineEnd = (const char*)memchr( p.str, '\n', p.end - p.str );
+			p.str               = lineEnd ? lineEnd : p.end;
+			continue;
 		}
 
-		if ( *str == '\\' )
-		{
-			str++;
+		if ( p.str[ 1 ] != '*' )
+			return EJsonError_InvalidCharacter;
 
-			if ( *str == 'n' )
-				output.data[ i ] = '\n';
-			else if ( *str == 't' )
-				output.data[ i ] = '\t';
-			else
-				output.data[ i ] = *str;
-		}
-		else
+		// multiline comment
+		p.str += 2;
+
+		while ( true )
 		{
-			output.data[ i ] = *str;
+			const char* star = (const char*)memchr( p.str, '*', p.end - p.str );
+
+			if ( !star || star + 1 >= p.end )
+				return EJsonError_ExpectedEndOfComment;
+
+			p.str = star + 1;
+
+			if ( *p.str == '/' )
+			{
+				p.str++;
+				break;
+			}
 		}
 	}
+}
+
+
+// --------------------------------------------------------------------------------------
+// Values
 
-	str++;
-	auto* tmp = (char*)realloc( output.data, i + 1 );
 
-	if ( tmp == nullptr )
+static u32 json_add_node( json_parser_t& p )
+{
+	ch_json_t& json = *p.json;
+
+	if ( json.node_count == p.node_capacity )
 	{
-		free( output.data );
-		return EJsonError_OutOfMemory;
+		u32   capacity = p.node_capacity * 2;
+		u64   size     = p.string_capacity + capacity * sizeof( ch_json_node_t );
+		char* arena    = (char*)realloc( json.arena, size );
+
+		if ( !arena )
+			return UINT32_MAX;
+
+		json.arena      = arena;
+		json.arena_size = size;
+		json.nodes      = (ch_json_node_t*)( arena + p.string_capacity );
+		p.node_capacity = capacity;
+
+		if ( !p.in_situ )
+		{
+			p.strings    = arena;
+			json.strings = arena;
+		}
 	}
 
-	output.data = tmp;
-	output.size = i;
-	output.data[ i ] = '\0';
+	return json.node_count++;
+}
 
-	// add this string to the string list
-	ch_str_add( output );
 
-	return EJsonError_None;
+static u32 json_write_pos( json_parser_t& p, char* spPos )
+{
+	return (u32)( spPos - p.strings );
 }
 
 
-static EJsonError Json_ParseString( const char*& str, ch_string& output )
+// Starts on the opening quote, ends after the closing quote
+static EJsonError json_parse_quote( json_parser_t& p, u32& srOffset, u32& srLen )
 {
-	const char* base = str;
+	char quote = *p.str++;
+
+	// in situ, the unescaped string is written over the source, escapes only ever make it shorter
+	char* out   = p.in_situ ? (char*)p.str : p.strings + p.json->string_size;
+	char* start = out;
 
-	int i = 0;
-	for ( ; !Json_IsWhitespace( *str ) && *str != ':'; i++, str++ )
+	while ( true )
 	{
-		if ( !Json_ValidQuotelessKey( *str ) )
-			return EJsonError_InvalidQuotelessKeyCharacter;
-	}
+		const char* stop = json_scan_quote( p.str, p.end, quote );
+		size_t      run  = stop - p.str;
 
-	output.data = (char*)malloc( i + 1 );
+		if ( out != p.str )
+			memmove( out, p.str, run );
 
-	if ( output.data == nullptr )
-		return EJsonError_OutOfMemory;
+		out += run;
+		p.str = stop;
+
+		if ( p.str >= p.end )
+			return EJsonError_ExpectedEndOfQuote;
+
+		if ( *p.str == quote )
+			break;
+
+		if ( *p.str != '\\' )
+			return EJsonError_NewLineInQuote;
+
+		if ( ++p.str >= p.end )
+			return EJsonError_ExpectedEndOfQuote;
+
+		char c = *p.str++;
+
+		switch ( c )
+		{
+			case 'n': *out++ = '\n'; break;
+			case 't': *out++ = '\t'; break;
+			case 'r': *out++ = '\r'; break;
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case '0': *out++ = '\0'; break;
+
+			// line continuation
+			case '\r':
+				if ( p.str < p.end && *p.str == '\n' )
+					p.str++;
+				break;
+
+			case '\n':
+				break;
+
+			case 'u':
+			{
+				if ( p.str + 4 > p.end )
+					return EJsonError_ExpectedEndOfQuote;
+
+				char  hex[ 5 ]{ p.str[ 0 ], p.str[ 1 ], p.str[ 2 ], p.str[ 3 ], '\0' };
+				char* hexEnd    = nullptr;
+				u32   codepoint = strtoul( hex, &hexEnd, 16 );
+
+				if ( hexEnd != hex + 4 )
+					return EJsonError_InvalidCharacter;
+
+				p.str += 4;
+
+				if ( codepoint < 0x80 )
+				{
+					*out++ = (char)codepoint;
+				}
+				else if ( codepoint < 0x800 )
+				{
+					*out++ = (char)( 0xC0 | ( codepoint >> 6 ) );
+					*out++ = (char)( 0x80 | ( codepoint & 0x3F ) );
+				}
+				else
+				{
+					*out++ = (char)( 0xE0 | ( codepoint >> 12 ) );
+					*out++ = (char)( 0x80 | ( ( codepoint >> 6 ) & 0x3F ) );
+					*out++ = (char)( 0x80 | ( codepoint & 0x3F ) );
+				}
 
-	memset( output.data, 0, i + 1 );
+				break;
+			}
 
-	// output = const_cast< char* >( base );
-	strncpy( output.data, base, i );
-	output.data[ i ] = '\0';
-	output.size      = i;
+			default:
+				*out++ = c;
+				break;
+		}
+	}
+
+	p.str++;
+	*out     = '\0';
 
-	// add this string to the string list
-	ch_str_add( output );
+	srOffset = json_write_pos( p, start );
+	srLen    = (u32)( out - start );
+
+	if ( !p.in_situ )
+		p.json->string_size += srLen + 1;
 
 	return EJsonError_None;
 }
 
 
-static EJsonError Json_ParseStringNoCheck( const char*& str, ch_string& output )
+// An unquoted key, in situ this can't be null terminated until after the ':' is checked
+static EJsonError json_parse_key( json_parser_t& p, u32& srOffset, u32& srLen, char*& srTerminator )
 {
-	const char* base = str;
-
-	int i = 0;
-	for ( ; !Json_IsWhitespace( *str ) && *str != ':' && *str != ',' && *str != ']' && *str != '}'; i++, str++ );
+	const char* start = p.str;
 
-	output.data = (char*)malloc( i + 1 );
+	while ( p.str < p.end && json_is_key_char( *p.str ) )
+		p.str++;
 
-	if ( output.data == nullptr )
-		return EJsonError_OutOfMemory;
+	srLen = (u32)( p.str - start );
 
-	memset( output.data, 0, i + 1 );
+	if ( p.in_situ )
+	{
+		srOffset     = json_write_pos( p, (char*)start );
+		srTerminator = (char*)p.str;
+		return EJsonError_None;
+	}
 
-	// output = const_cast< char* >( base );
-	strncpy( output.data, base, i );
-	output.data[ i ] = '\0';
-	output.size      = i;
+	char* out = p.strings + p.json->string_size;
+	memcpy( out, start, srLen );
+	out[ srLen ]        = '\0';
 
-	// add this string to the string list
-	ch_str_add( output );
+	srOffset            = json_write_pos( p, out );
+	p.json->string_size += srLen + 1;
 
 	return EJsonError_None;
 }
 
 
-// TODO: add hex support, and other types
-static EJsonError Json_ParseNumber( const char*& str, JsonObject_t& srObj )
+static EJsonType json_number_type( const char* spText, u32 sLen )
 {
-	const char* base = str;
+	const char* text = spText;
 
-	srObj.aType = EJsonType_Int;
+	if ( sLen > 0 && ( *text == '-' || *text == '+' ) )
+		text++;
 
-	int i = 0;
-	for ( ; !Json_IsWhitespace( *str ) && *str != ':' && *str != ',' && *str != ']'; i++ )
-	{
-		if ( *str == '.' )
-			srObj.aType = EJsonType_Double;
+	if ( text + 1 < spText + sLen && text[ 0 ] == '0' && ( text[ 1 ] == 'x' || text[ 1 ] == 'X' ) )
+		return EJsonType_Int;
 
-		if ( *str == '+' )
-			base = ++str;
-		else
-			str++;
+	for ( ; text < spText + sLen; text++ )
+	{
+		if ( *text == '.' || *text == 'e' || *text == 'E' || *text == 'I' || *text == 'N' )
+			return EJsonType_Double;
 	}
 
-	char* output = (char*)malloc( i + 1 );
+	return EJsonType_Int;
+}
 
-	if ( output == nullptr )
-		return EJsonError_OutOfMemory;
 
-	memset( output, 0, i + 1 );
+static EJsonError json_parse_number( const char* spText, u32 sLen, EJsonType sType, ch_json_node_t& srNode )
+{
+	// copy it to null terminate it, numbers are short
+	char text[ 64 ];
+
+	if ( sLen >= sizeof( text ) )
+		return sType == EJsonType_Double ? EJsonError_InvalidDouble : EJsonError_InvalidInt;
+
+	memcpy( text, spText, sLen );
+	text[ sLen ] = '\0';
 
-	// output = const_cast< char* >( base );
-	strncpy( output, base, i );
-	output[ i ] = '\0';
+	char* end    = nullptr;
 
-	if ( srObj.aType == EJsonType_Double )
+	if ( sType == EJsonType_Double )
 	{
-		char *end;
-		srObj.aDouble = strtod( output, &end );
+		srNode.val_double = strtod( text, &end );
 
-		if ( end == output )
-		{
-			free( output );
+		if ( end != text + sLen )
 			return EJsonError_InvalidDouble;
-		}
 	}
-	else  // int
+	else
 	{
-		char *end;
-		srObj.aInt = strtoll( output, &end, 0 );
+		const char* digits = text[ 0 ] == '-' || text[ 0 ] == '+' ? text + 1 : text;
+		bool        hex    = digits[ 0 ] == '0' && ( digits[ 1 ] == 'x' || digits[ 1 ] == 'X' );
 
-		if ( end == output )
-		{
-			free( output );
+		srNode.val_int     = strtoll( text, &end, hex ? 16 : 10 );
+
+		if ( end != text + sLen )
 			return EJsonError_InvalidInt;
-		}
 	}
 
-	free( output );
 	return EJsonError_None;
 }
 
 
-static JsonObject_t* Json_IncrementObjectList( JsonArray_t& data )
+// Numbers, true, false and null
+static EJsonError json_parse_token( json_parser_t& p, ch_json_node_t& srNode )
 {
-	JsonObject_t* tmp = (JsonObject_t*)realloc( data.apData, sizeof( JsonObject_t ) * ( data.aCount + 1 ) );
+	const char* start = p.str;
+	p.str             = json_scan_token( p.str, p.end );
+	u32         len   = (u32)( p.str - start );
+
+	if ( len == 0 )
+		return EJsonError_InvalidCharacter;
 
-	if ( tmp == nullptr )
+	if ( json_is_number( *start ) || *start == '.' || *start == '+' || *start == '-' ||
+	     ch_str_equals( start, len, "Infinity", 8 ) || ch_str_equals( start, len, "NaN", 3 ) )
 	{
-		free( data.apData );
-		return nullptr;
+		srNode.type = json_number_type( start, len );
+
+		if ( !( p.flags & EJsonFlags_LazyNumbers ) )
+			return json_parse_number( start, len, srNode.type, srNode );
+
+		srNode.lazy           = true;
+		srNode.val_string.len = len;
+
+		if ( p.in_situ )
+		{
+			srNode.val_string.offset = json_write_pos( p, (char*)start );
+			return EJsonError_None;
+		}
+
+		char* out = p.strings + p.json->string_size;
+		memcpy( out, start, len );
+		out[ len ]               = '\0';
+
+		srNode.val_string.offset = json_write_pos( p, out );
+		p.json->string_size += len + 1;
+		return EJsonError_None;
 	}
 
-	memset( tmp + data.aCount, 0, sizeof( JsonObject_t ) * 1 );
+	if ( ch_str_equals( start, len, "true", 4 ) )
+		srNode.type = EJsonType_True;
+
+	else if ( ch_str_equals( start, len, "false", 5 ) )
+		srNode.type = EJsonType_False;
 
-	u64 index = data.aCount;
+	else if ( ch_str_equals( start, len, "null", 4 ) )
+		srNode.type = EJsonType_Null;
 
-	data.apData = tmp;
-	data.aCount++;
+	else
+		return EJsonError_InvalidCharacter;
 
-	return &data.apData[ index ];
+	return EJsonError_None;
 }
 
 
 // --------------------------------------------------------------------------------------
-// Public Functions
+// Parser
 
 
-// TODO: try using a stack allocator so this can be all just one big allocation?
-EJsonError Json_Parse( JsonObject_t* spRoot, const char* spStr )
+static EJsonError json_parse( json_parser_t& p )
 {
-	if ( spRoot == nullptr )
-		return EJsonError_RootIsNullptr;
-
-	if ( spStr == nullptr )
-		return EJsonError_DataIsNullptr;
+	ch_json_t& json = *p.json;
+	u32        stack[ CH_JSON_MAX_DEPTH ];
+	u32        depth = 0;
 
-	// stack for types
-	// EJsonType typeStack[128] = {};
-	// int typeIndex = 0;
+	if ( EJsonError err = json_skip_space( p ) )
+		return err;
 
-	// std::vector< JsonObject_t* > objStack;
-	// objStack.push_back( spRoot );
+	if ( p.str >= p.end || ( *p.str != '{' && *p.str != '[' ) )
+		return EJsonError_UnexpectedRootType;
 
-	std::forward_list< JsonObject_t* > objStack;
-	objStack.push_front( spRoot );
+	u32 root = json_add_node( p );
 
-	memset( spRoot, 0, sizeof( JsonObject_t ) );
+	if ( root == UINT32_MAX )
+		return EJsonError_OutOfMemory;
 
-	// int stackCount = 1;
-	// JsonObject_t* objStack = (JsonObject_t*)malloc( sizeof( JsonObject_t ) );
-	// objStack[0] = *spRoot;
-	// JsonObject_t* objStack = spRoot;
-	// JsonObject_t* cur = nullptr;
+	json.nodes[ root ]          = {};
+	json.nodes[ root ].name     = CH_JSON_NO_NAME;
+	json.nodes[ root ].type     = *p.str == '{' ? EJsonType_Object : EJsonType_Array;
+	stack[ depth++ ]            = root;
+	p.str++;
 
-	char c;
-	for (; *spStr;)
+	while ( depth > 0 )
 	{
-		if ( EJsonError err = Json_SkipWhitespace( spStr ) )
+		if ( EJsonError err = json_skip_space( p ) )
 			return err;
 
-		c = *spStr;
+		u32  parent   = stack[ depth - 1 ];
+		bool inObject = json.nodes[ parent ].type == EJsonType_Object;
 
-		// ------------------------------------------------------
-		// Find Root if needed
-		if ( spRoot->aType == EJsonType_Invalid )
-		{
-			switch ( c )
-			{
-				case '{':
-				{
-					spStr++;
-					spRoot->aType = EJsonType_Object;
+		if ( p.str >= p.end )
+			return inObject ? EJsonError_ExpectedEndOfBlock : EJsonError_ExpectedEndOfArray;
 
-					break;
-				}
-				case '[':
-				{
-					spStr++;
-					spRoot->aType = EJsonType_Array;
+		// ------------------------------------------------------
+		// End of the current object or array
 
-					break;
-				}
-				default:
-				{
-					return EJsonError_UnexpectedRootType;
-				}
-			}
+		if ( *p.str == ( inObject ? '}' : ']' ) )
+		{
+			p.str++;
+			json.nodes[ parent ].next = json.node_count;
+			depth--;
 
-			if ( EJsonError err = Json_SkipWhitespace( spStr ) )
+			if ( EJsonError err = json_skip_space( p ) )
 				return err;
 
-			c = *spStr;
-		}
-		else if ( objStack.empty() )
-		{
-			break;
+			// commas are optional
+			if ( p.str < p.end && *p.str == ',' )
+				p.str++;
+
+			continue;
 		}
 
 		// ------------------------------------------------------
-		// First, check the key if in an object
-
-		// also add a new JsonObject_t
-		// JsonObject_t* next = (JsonObject_t*)malloc( cur->apObjects);
-		// cur->apObjects = 
+		// Key, if in an object
 
-		// parent->apObjects = ( JsonObject_t* )malloc( sizeof( JsonObject_t ) );
-		// 
-		// if ( parent->apObjects == nullptr )
-		// 	return EJsonError_OutOfMemory;
+		u32 name    = CH_JSON_NO_NAME;
+		u32 nameLen = 0;
 
-		// JsonObject_t cur{};
-
-		// if ( objStack[ objStack.front() - 1 ]->aType == EJsonType_Object )
-		if ( objStack.front()->aType == EJsonType_Object )
+		if ( inObject )
 		{
-			if ( c == '}' )
+			char* terminator = nullptr;
+
+			if ( *p.str == '"' || *p.str == '\'' )
 			{
-				spStr++;
-				
-				if ( EJsonError err = Json_SkipWhitespace( spStr ) )
+				if ( EJsonError err = json_parse_quote( p, name, nameLen ) )
 					return err;
-
-				// ------------------------------------------------------
-				// Check for the ',' character
-
-				// TODO: this doesn't require a comma
-				if ( *spStr == ',' )
-					spStr++;
-
-				objStack.pop_front();
-
-				continue;
 			}
-		}
-		else if ( objStack.front()->aType == EJsonType_Array )
-		{
-			if ( c == ']' )
+			else if ( json_is_key_start( *p.str ) )
 			{
-				spStr++;
-
-				if ( EJsonError err = Json_SkipWhitespace( spStr ) )
+				if ( EJsonError err = json_parse_key( p, name, nameLen, terminator ) )
 					return err;
-
-				// ------------------------------------------------------
-				// Check for the ',' character
-
-				// TODO: this doesn't require a comma
-				if ( *spStr == ',' )
-					spStr++;
-
-				objStack.pop_front();
-
-				continue;
 			}
-		}
+			else
+			{
+				return json_is_number( *p.str ) ? EJsonError_KeyStartsWithNumber : EJsonError_InvalidQuotelessKeyCharacter;
+			}
 
+			if ( EJsonError err = json_skip_space( p ) )
+				return err;
 
-		JsonObject_t* cur = Json_IncrementObjectList( objStack.front()->aObjects );
+			if ( p.str >= p.end || *p.str != ':' )
+				return EJsonError_ExpectedColonCharacter;
 
-		if ( objStack.front()->aType == EJsonType_Object )
-		{
-			switch ( c )
-			{
-				case '"':
-				case '\'':
-				{
-					if ( EJsonError err = Json_ParseQuote( spStr, c, cur->name ) )
-						return err;
-					break;
-				}
-				// Has to be a quoteless string
-				default:
-				{
-					if ( !Json_ValidQuotelessKey( c ) )
-					{
-						// if it's a number, warn about that
-						if ( Json_IsNumber( c ) )
-							return EJsonError_KeyStartsWithNumber;
+			p.str++;
 
-						return EJsonError_InvalidQuotelessKeyCharacter;
-					}
+			if ( terminator )
+				*terminator = '\0';
 
-					if ( EJsonError err = Json_ParseString( spStr, cur->name ) )
-						return err;
+			if ( EJsonError err = json_skip_space( p ) )
+				return err;
 
-					break;
-				}
-			}
+			if ( p.str >= p.end )
+				return EJsonError_ExpectedEndOfBlock;
 		}
 
 		// ------------------------------------------------------
-		// Verify we are at the ':' character
-
-		if ( EJsonError err = Json_SkipWhitespace( spStr ) )
-			return err;
+		// Value
 
-		// only if we're not in an array
+		u32 index = json_add_node( p );
 
-		if ( objStack.front()->aType != EJsonType_Array )
-		{
-			if ( *spStr != ':' )
-				return EJsonError_ExpectedColonCharacter;
+		if ( index == UINT32_MAX )
+			return EJsonError_OutOfMemory;
 
-			spStr++;
+		json.nodes[ parent ].count++;
 
-			if ( EJsonError err = Json_SkipWhitespace( spStr ) )
-				return err;
-		}
-
-		// ------------------------------------------------------
-		// Now, check the value
+		ch_json_node_t& node = json.nodes[ index ];
+		node                 = {};
+		node.name            = name;
+		node.name_len        = nameLen;
+		node.next            = index + 1;
 
-		c = *spStr;
-
-		switch ( c )
+		switch ( *p.str )
 		{
 			case '{':
-			{
-				spStr++;
-				cur->aType = EJsonType_Object;
-
-				objStack.push_front( cur );
-
-				break;
-			}
 			case '[':
 			{
-				spStr++;
-				cur->aType = EJsonType_Array;
-
-				objStack.push_front( cur );
+				if ( depth == CH_JSON_MAX_DEPTH )
+					return EJsonError_TooDeep;
 
-				break;
+				node.type        = *p.str == '{' ? EJsonType_Object : EJsonType_Array;
+				stack[ depth++ ] = index;
+				p.str++;
+				continue;
 			}
+
 			case '"':
 			case '\'':
 			{
-				if ( EJsonError err = Json_ParseQuote( spStr, c, cur->aString ) )
+				node.type = EJsonType_String;
+
+				if ( EJsonError err = json_parse_quote( p, node.val_string.offset, node.val_string.len ) )
 					return err;
 
-				cur->aType = EJsonType_String;
 				break;
 			}
+
 			default:
 			{
-				if ( Json_IsNumber( c ) || c == '.' || c == '+' || c == '-' )
-				{
-					if ( EJsonError err = Json_ParseNumber( spStr, *cur ) )  // ---------------------------------------------------------- why is this a pointer?
-						return err;
-				}
-				
-				else
-				{
-					ch_string string;
-					if ( EJsonError err = Json_ParseStringNoCheck( spStr, string ) )
-						return err;
-
-					if ( ch_str_equals( string, "true", 4 ) )
-					{
-						cur->aType = EJsonType_True;
-					}
-					else if ( ch_str_equals( string, "false", 5 ) )
-					{
-						cur->aType = EJsonType_False;
-					}
-					else if ( ch_str_equals( string, "null", 4 ) )
-					{
-						cur->aType = EJsonType_Null;
-					}
-					else
-					{
-						return EJsonError_InvalidCharacter;
-					}
-				}
+				if ( EJsonError err = json_parse_token( p, node ) )
+					return err;
+
+				break;
 			}
 		}
 
-		if ( EJsonError err = Json_SkipWhitespace( spStr ) )
+		if ( EJsonError err = json_skip_space( p ) )
 			return err;
 
-		c = *spStr;
-
-		// ------------------------------------------------------
-		// Check for the ',' character
-
-		// TODO: this doesn't require a comma
-		if ( c == ',' )
-			spStr++;
-
-		// if ( c != ':' )
-		// 	return EJsonError_ExpectedColonCharacter;
+		if ( p.str < p.end && *p.str == ',' )
+			p.str++;
 	}
 
 	return EJsonError_None;
 }
 
 
-void Json_Free( JsonObject_t* spRoot )
+static EJsonError json_parse_begin( ch_json_t& srJson, const char* spSource, u64 sLen, u32 sFlags, bool sInSitu )
 {
-	std::vector< JsonObject_t* > objList;
-	objList.push_back( spRoot );
+	srJson = {};
+
+	if ( spSource == nullptr )
+		return EJsonError_DataIsNullptr;
+
+	if ( sLen >= UINT32_MAX )
+		return EJsonError_OutOfMemory;
 
-	// First, get all objects into one huge list
-	for ( size_t objIndex = 0; objIndex < objList.size(); objIndex++ )
+	json_parser_t p{};
+	p.str     = spSource;
+	p.end     = spSource + sLen;
+	p.json    = &srJson;
+	p.flags   = sFlags;
+	p.in_situ = sInSitu;
+
+	// every string is at least as long in the source as it is unescaped with a null terminator,
+	// so the source length is enough for the whole string table
+	if ( !sInSitu )
+		p.string_capacity = CH_ALIGN_VALUE( sLen + 1, alignof( ch_json_node_t ) );
+
+	// guess a node every 16 bytes, it grows if there's more than that
+	p.node_capacity   = (u32)( sLen / 16 ) + 16;
+	srJson.arena_size = p.string_capacity + p.node_capacity * sizeof( ch_json_node_t );
+	srJson.arena      = (char*)malloc( srJson.arena_size );
+
+	if ( !srJson.arena )
+		return EJsonError_OutOfMemory;
+
+	srJson.nodes   = (ch_json_node_t*)( srJson.arena + p.string_capacity );
+	p.strings      = sInSitu ? (char*)spSource : srJson.arena;
+	srJson.strings = p.strings;
+
+	if ( EJsonError err = json_parse( p ) )
 	{
-		// Does the current object have children?
-		if ( !( objList[ objIndex ]->aType == EJsonType_Object || objList[ objIndex ]->aType == EJsonType_Array ) )
-			continue;
+		for ( const char* str = spSource; str < p.str && str < p.end; str++ )
+			srJson.error_line += *str == '\n';
 
-		if ( objList[ objIndex ]->aObjects.aCount == 0 )
-			continue;
+		u32 line = srJson.error_line + 1;
+		Json_Free( srJson );
+		srJson.error_line = line;
+		return err;
+	}
+
+	if ( sInSitu )
+		srJson.string_size = (u32)sLen;
+
+	// move the nodes down to the end of the strings that were actually used, and give back the rest
+	u64 stringSize = CH_ALIGN_VALUE( (u64)srJson.string_size, alignof( ch_json_node_t ) );
+	u64 size       = sInSitu ? 0 : stringSize;
+	size += srJson.node_count * sizeof( ch_json_node_t );
+
+	if ( !sInSitu && stringSize < p.string_capacity )
+		memmove( srJson.arena + stringSize, srJson.nodes, srJson.node_count * sizeof( ch_json_node_t ) );
 
-		// put all children in the list and reserve memory for it
-		size_t j = objIndex;
-		objList.reserve( objList.size() + objList[j]->aObjects.aCount );
-		for ( size_t i = 0; i < objList[j]->aObjects.aCount; i++ )
+	if ( size < srJson.arena_size )
+	{
+		if ( char* arena = (char*)realloc( srJson.arena, size ) )
 		{
-			objList.push_back( &objList[j]->aObjects.apData[ i ] );
+			srJson.arena      = arena;
+			srJson.arena_size = size;
 		}
 	}
 
-	// Now free all the objects
-	while ( !objList.empty() )
+	srJson.nodes = (ch_json_node_t*)( srJson.arena + ( sInSitu ? 0 : stringSize ) );
+
+	if ( !sInSitu )
+		srJson.strings = srJson.arena;
+
+	return EJsonError_None;
+}
+
+
+// --------------------------------------------------------------------------------------
+// JsonObject_t Compatibility
+
+
+static void json_to_object( const ch_json_t& srJson, char* spStrings, u32 sIndex, JsonObject_t& srObj, JsonObject_t* spObjects, u32& srSlot )
+{
+	const ch_json_node_t& node = srJson.nodes[ sIndex ];
+
+	if ( node.name != CH_JSON_NO_NAME )
+		srObj.name = { spStrings + node.name, node.name_len };
+
+	srObj.aType = node.type;
+
+	switch ( node.type )
 	{
-		// If this is a string type, free it
-		if ( objList[objList.size() - 1]->aType == EJsonType_String )
-		{
-			ch_str_free( objList[objList.size() - 1]->aString.data );
-			objList[ objList.size() - 1 ]->aString.data = nullptr;
-			objList[ objList.size() - 1 ]->aString.size = 0;
-		}
-		else if ( objList[objList.size() - 1]->aType == EJsonType_Object || objList[objList.size() - 1]->aType == EJsonType_Array )
-		{
-			// Free the object list
-			free( objList[objList.size() - 1]->aObjects.apData );
-			objList[ objList.size() - 1 ]->aObjects.apData = nullptr;
-			objList[ objList.size() - 1 ]->aObjects.aCount = 0;
-		}
+		default:
+			break;
 
-		// Free the name if it exists
-		if ( objList[objList.size() - 1]->name.data )
+		case EJsonType_Object:
+		case EJsonType_Array:
 		{
-			ch_str_free( objList[ objList.size() - 1 ]->name.data );
-			objList[ objList.size() - 1 ]->name.data = nullptr;
-			objList[ objList.size() - 1 ]->name.size = 0;
+			srObj.aObjects.apData = spObjects + srSlot;
+			srObj.aObjects.aCount = node.count;
+			srSlot += node.count;
+
+			u32 child = sIndex + 1;
+			for ( u32 i = 0; i < node.count; i++ )
+			{
+				json_to_object( srJson, spStrings, child, srObj.aObjects.apData[ i ], spObjects, srSlot );
+				child = srJson.nodes[ child ].next;
+			}
+
+			break;
 		}
 
-		// pop the object off the stack
-		objList.pop_back();
+		case EJsonType_String:
+			srObj.aString = { spStrings + node.val_string.offset, node.val_string.len };
+			break;
+
+		case EJsonType_Int:
+			srObj.aInt = node.val_int;
+			break;
+
+		case EJsonType_Double:
+			srObj.aDouble = node.val_double;
+			break;
+	}
+}
+
+
+// --------------------------------------------------------------------------------------
+// Public Functions
+
+
+EJsonError Json_Parse( JsonObject_t* spRoot, const char* spStr )
+{
+	if ( spRoot == nullptr )
+		return EJsonError_RootIsNullptr;
+
+	if ( spStr == nullptr )
+		return EJsonError_DataIsNullptr;
+
+	memset( spRoot, 0, sizeof( JsonObject_t ) );
+
+	ch_json_t json;
+	if ( EJsonError err = Json_Parse( json, spStr, strlen( spStr ) ) )
+		return err;
+
+	// one allocation for every object under the root, with the string table after it
+	u64   objectSize = ( json.node_count - 1 ) * sizeof( JsonObject_t );
+	char* block      = ch_malloc< char >( std::max< u64 >( objectSize + json.string_size, 1 ) );
+
+	if ( block == nullptr )
+	{
+		Json_Free( json );
+		return EJsonError_OutOfMemory;
+	}
+
+	memset( block, 0, objectSize );
+	memcpy( block + objectSize, json.strings, json.string_size );
+
+	u32 slot = 0;
+	json_to_object( json, block + objectSize, 0, *spRoot, (JsonObject_t*)block, slot );
+
+	Json_Free( json );
+	return EJsonError_None;
+}
+
+
+void Json_Free( JsonObject_t* spRoot )
+{
+	if ( !spRoot )
+		return;
+
+	// the root's children are at the start of the one allocation
+	if ( spRoot->aType == EJsonType_Object || spRoot->aType == EJsonType_Array )
+		free( spRoot->aObjects.apData );
+
+	memset( spRoot, 0, sizeof( JsonObject_t ) );
+}
+
+
+EJsonError Json_Parse( ch_json_t& srJson, const char* spSource, u64 sLen, u32 sFlags )
+{
+	return json_parse_begin( srJson, spSource, sLen, sFlags, false );
+}
+
+
+EJsonError Json_ParseInSitu( ch_json_t& srJson, char* spSource, u64 sLen, u32 sFlags )
+{
+	return json_parse_begin( srJson, spSource, sLen, sFlags, true );
+}
+
+
+void Json_Free( ch_json_t& srJson )
+{
+	free( srJson.arena );
+	srJson = {};
+}
+
+
+s64 Json_GetInt( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	ch_json_node_t node = srNode;
+
+	if ( node.lazy && json_parse_number( srJson.strings + node.val_string.offset, node.val_string.len, node.type, node ) )
+		return 0;
+
+	if ( node.type == EJsonType_Double )
+		return (s64)node.val_double;
+
+	return node.type == EJsonType_Int ? node.val_int : 0;
+}
+
+
+double Json_GetDouble( const ch_json_t& srJson, const ch_json_node_t& srNode )
+{
+	ch_json_node_t node = srNode;
+
+	if ( node.lazy && json_parse_number( srJson.strings + node.val_string.offset, node.val_string.len, node.type, node ) )
+		return 0.0;
+
+	if ( node.type == EJsonType_Int )
+		return (double)node.val_int;
+
+	return node.type == EJsonType_Double ? node.val_double : 0.0;
+}
+
+
+const ch_json_node_t* Json_Find( const ch_json_t& srJson, const ch_json_node_t& srObject, const char* spKey, u32 sLen )
+{
+	if ( srObject.type != EJsonType_Object )
+		return nullptr;
+
+	const ch_json_node_t* child = Json_GetChild( srJson, srObject );
+
+	for ( u32 i = 0; i < srObject.count; i++, child = Json_GetNext( srJson, *child ) )
+	{
+		if ( ch_str_equals( srJson.strings + child->name, child->name_len, spKey, sLen ) )
+			return child;
 	}
+
+	return nullptr;
 }
 
 
@@ -699,6 +919,12 @@ const char* Json_ErrorToStr( EJsonError sErr )
 
 		case EJsonError_NewLineInQuote:
 			return "New Line In Quote";
+
+		case EJsonError_ExpectedEndOfComment:
+			return "Expected end of comment";
+
+		case EJsonError_TooDeep:
+			return "Nested too deep";
 	}
 }
 
@@ -740,3 +966,98 @@ const char* Json_TypeToStr( EJsonType sType )
 }
 
 
+// --------------------------------------------------------------------------------------
+// Benchmark
+
+
+CONCMD_VA( json_bench, "Time parsing a json5 file with each parser mode - json_bench <path> [iterations]" )
+{
+	if ( args.empty() )
+	{
+		Log_Msg( "json_bench <path> [iterations]\n" );
+		return;
+	}
+
+	ch_string_auto data = FileSys_ReadFile( args[ 0 ].data(), args[ 0 ].size() );
+
+	if ( !data.data )
+	{
+		Log_ErrorF( "Failed to read file: \"%s\"\n", args[ 0 ].c_str() );
+		return;
+	}
+
+	u32       iterations = args.size() > 1 ? std::max( atoi( args[ 1 ].c_str() ), 1 ) : 100;
+	ch_json_t json;
+
+	if ( EJsonError err = Json_Parse( json, data.data, data.size ) )
+	{
+		Log_ErrorF( "Error parsing \"%s\" on line %u: %s\n", args[ 0 ].c_str(), json.error_line, Json_ErrorToStr( err ) );
+		return;
+	}
+
+	u32 nodeCount = json.node_count;
+	u64 arenaSize = json.arena_size;
+	Json_Free( json );
+
+	// in situ parsing writes over the source, so each iteration parses a fresh copy of it
+	char*  source    = ch_malloc< char >( data.size + 1 );
+
+	double times[ 4 ]{};
+
+	for ( u32 iter = 0; iter < iterations; iter++ )
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		Json_Parse( json, data.data, data.size );
+		Json_Free( json );
+
+		auto copyEnd = std::chrono::high_resolution_clock::now();
+
+		Json_Parse( json, data.data, data.size, EJsonFlags_LazyNumbers );
+		Json_Free( json );
+
+		auto lazyEnd = std::chrono::high_resolution_clock::now();
+
+		memcpy( source, data.data, data.size + 1 );
+
+		auto inSituStart = std::chrono::high_resolution_clock::now();
+
+		Json_ParseInSitu( json, source, data.size, EJsonFlags_LazyNumbers );
+		Json_Free( json );
+
+		auto inSituEnd = std::chrono::high_resolution_clock::now();
+
+		JsonObject_t root;
+		Json_Parse( &root, data.data );
+		Json_Free( &root );
+
+		auto objectEnd = std::chrono::high_resolution_clock::now();
+
+		times[ 0 ] += std::chrono::duration< double, std::milli >( copyEnd - startTime ).count();
+		times[ 1 ] += std::chrono::duration< double, std::milli >( lazyEnd - copyEnd ).count();
+		times[ 2 ] += std::chrono::duration< double, std::milli >( inSituEnd - inSituStart ).count();
+		times[ 3 ] += std::chrono::duration< double, std::milli >( objectEnd - inSituEnd ).count();
+	}
+
+	ch_free( source );
+
+	const char* names[] = {
+		"Flat:             ",
+		"Flat, Lazy:       ",
+		"In Situ, Lazy:    ",
+		"JsonObject_t:     ",
+	};
+
+	double sizeMB = data.size / ( 1024.0 * 1024.0 );
+	log_t  group  = Log_GroupBegin();
+
+	Log_GroupF( group, "JSON Benchmark - %.2f KB, %u nodes, %.2f KB arena, %u iterations\n", data.size / 1024.0, nodeCount, arenaSize / 1024.0, iterations );
+
+	for ( u32 i = 0; i < 4; i++ )
+	{
+		double ms = times[ i ] / iterations;
+		Log_GroupF( group, "    %s %.4f ms - %.1f MB/s\n", names[ i ], ms, sizeMB / ( ms / 1000.0 ) );
+	}
+
+	Log_GroupEnd( group );
+}
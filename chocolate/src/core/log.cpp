@@ -1,21 +1,112 @@
 #include "core/log.h"
 #include "core/console.h"
 #include "core/profiler.h"
+#include "core/ring_buffer.hpp"
 
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
 #include <regex>
 #include <stack>
+#include <thread>
 
 #include <SDL.h>
 
+#define LOG_SPILL_FILENAME "log_spill.txt"
+
+// max amount of logs kept in memory, older logs are freed, or written to LOG_SPILL_FILENAME with ch.log.history.spill
+constexpr u32 LOG_HISTORY_SIZE = 16384;
+
 CONVAR_INT_NAME( log_verbose_global, "ch.log.verbosity.base", 1, "Base Developer Logging Level for all Log Channels", 0 );
+CONVAR_BOOL_NAME( log_history_spill, "ch.log.history.spill", false, "Write logs pushed out of the log history to " LOG_SPILL_FILENAME );
 
 ELogColor                  gCurrentColor = ELogColor_Default;
 log_channel_h            gLC_General   = INVALID_LOG_CHANNEL;
 log_channel_h            gLC_Logging   = INVALID_LOG_CHANNEL;
 static ch_string           gDefaultChannelName( "General", 7 );
-static std::mutex          gLogMutex;
+
+// ----------------------------------------------------------------
+// Logs are submitted to a lock-free queue by any thread, with only the message text formatted at the call site
+// The logging thread does the rest, formatting, printing, Tracy, the log file, and adding it to the history
+
+// Messages that fit here don't need an allocation on the calling thread
+constexpr u32                  LOG_INLINE_MSG_SIZE = 240;
+constexpr u32                  LOG_QUEUE_SIZE      = 4096;
+
+struct log_queue_entry_t
+{
+	log_channel_h channel;
+	ELogType      aType;
+	u32           aLen;
+	char*         apHeapMsg;  // allocated with ch_str if the message didn't fit in aMsg, the logging thread takes ownership
+	char          aMsg[ LOG_INLINE_MSG_SIZE ];
+};
+
+static std::atomic< log_channel_h > gLogLastChannel = INVALID_LOG_CHANNEL;
+static std::atomic< u64 >           gLogPushed      = 0;
+static std::atomic< u64 >           gLogProcessed   = 0;
+static std::atomic< u64 >           gLogQueueStalls = 0;
+
+static std::atomic< bool >          gLogThreadRunning  = false;
+static std::atomic< bool >          gLogThreadSleeping = false;
+static std::thread*                 gpLogThread        = nullptr;
+
+static FILE*                        gpLogFile      = nullptr;
+static FILE*                        gpLogSpillFile = nullptr;
+
+// History ring, indexes are the total number of logs added, so they stay valid while the ring wraps around
+static u64                          gLogHistoryStart = 0;  // oldest log still in the history
+static u64                          gLogHistoryCount = 0;  // total number of logs added to the history
+
+// these are function statics for the same reason as GetLogChannels(), logs can be submitted during static initialization
+static ch_mpsc_queue< log_queue_entry_t, LOG_QUEUE_SIZE >& Log_GetQueue()
+{
+	static auto* queue = new ch_mpsc_queue< log_queue_entry_t, LOG_QUEUE_SIZE >;
+	return *queue;
+}
+
+// guards the consumer side of the queue, the history, and the log files
+static std::recursive_mutex& Log_GetMutex()
+{
+	static std::recursive_mutex mutex;
+	return mutex;
+}
+
+// how many times this thread has Log_GetMutex() locked, it can't wait on the logging thread while it's above 0
+static thread_local u32 gLogLockDepth = 0;
+
+struct log_lock_guard_t
+{
+	log_lock_guard_t()
+	{
+		Log_GetMutex().lock();
+		gLogLockDepth++;
+	}
+
+	~log_lock_guard_t()
+	{
+		gLogLockDepth--;
+		Log_GetMutex().unlock();
+	}
+};
+
+static log_t* Log_GetHistory()
+{
+	static log_t* history = ch_calloc< log_t >( LOG_HISTORY_SIZE );
+	return history;
+}
+
+static std::mutex& Log_GetWakeMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::condition_variable& Log_GetWake()
+{
+	static std::condition_variable wake;
+	return wake;
+}
 
 // apparently you could of added stuff to this before static initialization got to this, and then you lose some log channels as a result
 // TODO: this can just be a simple c array + u8 size, only allocates at start up and that's it
@@ -25,9 +116,6 @@ ChVector< log_channel_t >& GetLogChannels()
 	return gChannels;
 }
 
-// static std::vector< log_channel_t >             gChannels;
-static std::vector< log_t >                    gLogHistory;
-
 static std::vector< LogChannelShownCallbackF > gCallbacksChannelShown;
 
 constexpr glm::vec4                            gVecTo255( 255, 255, 255, 255 );
@@ -333,6 +421,12 @@ u32 GetColorU32( log_channel_t* channel, const log_t& log )
 }
 
 
+static void Log_StartThread();
+static void Log_StopThread();
+static void Log_FreeLog( log_t& srLog );
+static void Log_WriteFile( FILE* spFile, const log_t& srLog );
+
+
 void Log_Init()
 {
 	gLC_General = Log_RegisterChannel( "General", ELogColor_Default );
@@ -344,22 +438,53 @@ void Log_Init()
 	int verbose_level = std::clamp( args_register( 1, "Set logging system verbosity, Ranges from 0 to 4", "--verbosity" ), 0, 4 );
 
 	Con_SetConVarValue( "ch.log.verbosity.base", verbose_level );
+
+	const char* logFilePath = args_register( "", "Write all logs to this file", "--log-file" );
+
+	if ( logFilePath && *logFilePath )
+	{
+		log_lock_guard_t lock;
+
+		gpLogFile = fopen( logFilePath, "wb" );
+
+		// write everything logged before we got here
+		if ( gpLogFile )
+		{
+			for ( u64 i = gLogHistoryStart; i < gLogHistoryCount; i++ )
+				Log_WriteFile( gpLogFile, Log_GetHistory()[ i % LOG_HISTORY_SIZE ] );
+		}
+	}
+
+	if ( logFilePath && *logFilePath && !gpLogFile )
+		Log_ErrorF( gLC_Logging, "Failed to open log file: \"%s\"\n", logFilePath );
+
+	Log_StartThread();
 }
 
 
 void Log_Shutdown()
 {
-	// TODO: FREE ALL STRING MEMORY
-	// except logging channel names, those are static
+	// print anything still in the queue, logs after this are handled on the thread that submits them
+	Log_StopThread();
 
-	for ( auto& log : gLogHistory )
-	{
-		if ( log.aMessage.data )
-			ch_str_free( log.aMessage.data );
+	log_lock_guard_t lock;
 
-		if ( log.aFormatted.data )
-			ch_str_free( log.aFormatted.data );
-	}
+	// logging channel names are static, only the history needs freeing
+	log_t* history = Log_GetHistory();
+
+	for ( u64 i = gLogHistoryStart; i < gLogHistoryCount; i++ )
+		Log_FreeLog( history[ i % LOG_HISTORY_SIZE ] );
+
+	gLogHistoryStart = gLogHistoryCount;
+
+	if ( gpLogFile )
+		fclose( gpLogFile );
+
+	if ( gpLogSpillFile )
+		fclose( gpLogSpillFile );
+
+	gpLogFile      = nullptr;
+	gpLogSpillFile = nullptr;
 }
 
 
@@ -868,12 +993,12 @@ void Log_AddChannelShownCallback( LogChannelShownCallbackF callback )
 }
 
 
-// TODO: make this async and probably store elsewhere
 ch_string Log_BuildHistoryString( int sMaxSize )
 {
 	PROF_SCOPE();
 
-	gLogMutex.lock();
+	log_lock_guard_t lock;
+	log_t*                                  history = Log_GetHistory();
 
 	ch_string output;
 	output.data = nullptr;
@@ -882,19 +1007,11 @@ ch_string Log_BuildHistoryString( int sMaxSize )
 	// No limit
 	if ( sMaxSize == -1 )
 	{
-		// // Preallocate String for all logs
-		// size_t stringLen = 0;
-		// for ( auto& log : gLogHistory )
-		// {
-		// 	if ( Log_IsVisible( log ) )
-		// 		stringLen += log.aFormatted.size();
-		// }
-		// 
-		// srOutput.reserve( stringLen );
-
 		// Add formatted logs to the strings
-		for ( auto& log : gLogHistory )
+		for ( u64 i = gLogHistoryStart; i < gLogHistoryCount; i++ )
 		{
+			log_t& log = history[ i % LOG_HISTORY_SIZE ];
+
 			if ( !Log_IsVisible( log ) )
 				continue;
 
@@ -909,15 +1026,13 @@ ch_string Log_BuildHistoryString( int sMaxSize )
 				break;
 		}
 
-		gLogMutex.unlock();
-
 		return output;
 	}
 
 	// go from latest to oldest
-	for ( size_t i = gLogHistory.size() - 1; i > 0; i-- )
+	for ( u64 i = gLogHistoryCount; i-- > gLogHistoryStart; )
 	{
-		auto& log = gLogHistory[ i ];
+		log_t& log = history[ i % LOG_HISTORY_SIZE ];
 
 		if ( !Log_IsVisible( log ) )
 			continue;
@@ -942,7 +1057,6 @@ ch_string Log_BuildHistoryString( int sMaxSize )
 			break;
 	}
 
-	gLogMutex.unlock();
 	return output;
 }
 
@@ -1020,7 +1134,7 @@ void Log_SplitStringColors( ELogColor sMainColor, const ch_string& sBuffer, ChVe
 }
 
 
-// print to system console and tracy
+// print to system console and tracy, streams are flushed once per batch of logs by Log_ProcessQueue()
 void Log_SysPrint( ELogColor sMainColor, const log_t& srLog, FILE* spStream )
 {
 #ifdef _WIN32
@@ -1036,7 +1150,6 @@ void Log_SysPrint( ELogColor sMainColor, const log_t& srLog, FILE* spStream )
 	}
 
 	Log_SetColor( ELogColor_Default );
-	fflush( spStream );
 
   #if !TRACY_ENABLE
 	if ( !IsDebuggerPresent() )
@@ -1052,7 +1165,6 @@ void Log_SysPrint( ELogColor sMainColor, const log_t& srLog, FILE* spStream )
 	Log_SetColor( sMainColor );
 	fputs( srLog.aFormatted.data, spStream );
 	Log_SetColor( ELogColor_Default );
-	fflush( spStream );
 
 	if ( Log_TracyEnabled() )
 	{
@@ -1069,6 +1181,7 @@ CONCMD_NAME( log_test_colors, "ch.log.test_colors" )
 }
 
 
+// Runs on the logging thread, or on the thread that submitted it if the logging thread isn't running
 void Log_AddLogInternal( log_t& log )
 {
     PROF_SCOPE();
@@ -1082,6 +1195,10 @@ void Log_AddLogInternal( log_t& log )
 
     log.aFormatted = FormatLog( channel, log.aType, CH_STR_UR( log.aMessage ) );
 
+	// the log file gets everything that was saved, even if the channel is hidden
+	if ( gpLogFile && Log_DevLevelVisible( log ) )
+		Log_WriteFile( gpLogFile, log );
+
     if ( channel->shown )
 	{
         switch ( log.aType )
@@ -1111,30 +1228,319 @@ void Log_AddLogInternal( log_t& log )
                 break;
 
             case ELogType_Fatal:
+				// the thread that submitted this shows the message box and exits, see Log_Submit()
 				Log_SysPrint( LOG_COLOR_ERROR, log, stderr );
-
-				const char*    strings[]       = { "[", channel->name.data, "] Fatal Error" };
-				const u64      lengths[]       = { 1, channel->name.size, 13 };
-				ch_string_auto messageBoxTitle = ch_str_join( 3, strings, lengths );
-
-                if ( ch_str_ends_with( log.aMessage, "\n", 1 ) )
-				{
-					ch_string_auto substr = ch_str_copy( log.aMessage.data, log.aMessage.size - 1 );
-					SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR, messageBoxTitle.data, substr.data, NULL );
-				}
-				else
-				{
-					SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR, messageBoxTitle.data, log.aMessage.data, NULL );
-				}
-
-                sys_debug_break();
-				exit( -1 );
                 break;
         }
     }
 }
 
 
+// ----------------------------------------------------------------
+// Logging Thread
+
+
+static thread_local bool gLogIsLogThread = false;
+
+
+static void Log_FreeLog( log_t& srLog )
+{
+	if ( srLog.aMessage.data )
+		ch_str_free( srLog.aMessage.data );
+
+	if ( srLog.aFormatted.data )
+		ch_str_free( srLog.aFormatted.data );
+
+	srLog.aMessage.data   = nullptr;
+	srLog.aMessage.size   = 0;
+	srLog.aFormatted.data = nullptr;
+	srLog.aFormatted.size = 0;
+}
+
+
+static void Log_WriteFile( FILE* spFile, const log_t& srLog )
+{
+	ch_string_auto text = FormatLogNoColors( srLog );
+
+	if ( text.data )
+		fwrite( text.data, sizeof( char ), text.size, spFile );
+}
+
+
+// Get a slot in the history for a new log, pushing out the oldest log if it's full
+static log_t& Log_HistoryAdd()
+{
+	u64    index = gLogHistoryCount++;
+	log_t& log   = Log_GetHistory()[ index % LOG_HISTORY_SIZE ];
+
+	if ( index < gLogHistoryStart + LOG_HISTORY_SIZE )
+		return log;
+
+	if ( log_history_spill )
+	{
+		if ( !gpLogSpillFile )
+			gpLogSpillFile = fopen( LOG_SPILL_FILENAME, "ab" );
+
+		if ( gpLogSpillFile )
+			Log_WriteFile( gpLogSpillFile, log );
+	}
+
+	Log_FreeLog( log );
+	gLogHistoryStart = index - LOG_HISTORY_SIZE + 1;
+	return log;
+}
+
+
+// Hand everything in the queue to the sinks and the history
+static void Log_ProcessQueue()
+{
+	log_lock_guard_t lock;
+
+	auto&             queue = Log_GetQueue();
+	log_queue_entry_t entry;
+	u64               count = 0;
+
+	// if a sink logs something here, it's pushed to the queue and picked up by this loop
+	while ( queue.pop( entry ) )
+	{
+		log_t& log  = Log_HistoryAdd();
+		log.channel = entry.channel;
+		log.aType   = entry.aType;
+
+		if ( entry.apHeapMsg )
+		{
+			log.aMessage.data = entry.apHeapMsg;
+			log.aMessage.size = entry.aLen;
+		}
+		else
+		{
+			log.aMessage = ch_str_copy( entry.aMsg, entry.aLen );
+		}
+
+		Log_AddLogInternal( log );
+		count++;
+	}
+
+	if ( count == 0 )
+		return;
+
+	fflush( stdout );
+	fflush( stderr );
+
+	if ( gpLogFile )
+		fflush( gpLogFile );
+
+	gLogProcessed.fetch_add( count, std::memory_order_release );
+}
+
+
+static void Log_WakeThread()
+{
+	Log_GetWake().notify_one();
+}
+
+
+static void Log_ThreadMain()
+{
+	gLogIsLogThread = true;
+
+	while ( gLogThreadRunning )
+	{
+		{
+			std::unique_lock< std::mutex > lock( Log_GetWakeMutex() );
+			gLogThreadSleeping = true;
+
+			// the timeout covers a producer checking gLogThreadSleeping right before we set it
+			Log_GetWake().wait_for( lock, std::chrono::milliseconds( 50 ), []()
+			{
+				return !gLogThreadRunning || !Log_GetQueue().empty();
+			} );
+
+			gLogThreadSleeping = false;
+		}
+
+		Log_ProcessQueue();
+	}
+
+	Log_ProcessQueue();
+}
+
+
+static void Log_StartThread()
+{
+	if ( gpLogThread )
+		return;
+
+	gLogThreadRunning = true;
+	gpLogThread       = new std::thread( Log_ThreadMain );
+}
+
+
+static void Log_StopThread()
+{
+	if ( !gpLogThread )
+		return;
+
+	{
+		std::lock_guard< std::mutex > lock( Log_GetWakeMutex() );
+		gLogThreadRunning = false;
+	}
+
+	Log_WakeThread();
+	gpLogThread->join();
+
+	delete gpLogThread;
+	gpLogThread = nullptr;
+
+	// anything pushed while the thread was exiting
+	Log_ProcessQueue();
+}
+
+
+// The logging thread needs the log mutex for every log, so a thread holding it would wait forever,
+// it writes the logs out itself instead
+static bool Log_CanWaitForThread()
+{
+	return gLogThreadRunning && !gLogIsLogThread && gLogLockDepth == 0;
+}
+
+
+void Log_Flush()
+{
+	PROF_SCOPE();
+
+	if ( !Log_CanWaitForThread() )
+	{
+		Log_ProcessQueue();
+		return;
+	}
+
+	u64 target = gLogPushed.load( std::memory_order_acquire );
+
+	while ( gLogThreadRunning && gLogProcessed.load( std::memory_order_acquire ) < target )
+	{
+		Log_WakeThread();
+		std::this_thread::yield();
+	}
+
+	// the thread may have been stopped while we were waiting
+	if ( !gLogThreadRunning )
+		Log_ProcessQueue();
+}
+
+
+[[noreturn]] static void Log_FatalExit( log_channel_h sChannel, const ch_string& srMessage )
+{
+	ch_string      channelName     = Log_GetChannelName( sChannel );
+	const char*    strings[]       = { "[", channelName.data, "] Fatal Error" };
+	const u64      lengths[]       = { 1, channelName.size, 13 };
+	ch_string_auto messageBoxTitle = ch_str_join( 3, strings, lengths );
+
+	if ( ch_str_ends_with( srMessage, "\n", 1 ) )
+	{
+		ch_string_auto substr = ch_str_copy( srMessage.data, srMessage.size - 1 );
+		SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR, messageBoxTitle.data, substr.data, NULL );
+	}
+	else
+	{
+		SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR, messageBoxTitle.data, srMessage.data, NULL );
+	}
+
+	sys_debug_break();
+
+	// don't leave the logging thread waiting on a condition variable that's about to be destroyed
+	if ( !gLogIsLogThread )
+		Log_StopThread();
+
+	exit( -1 );
+}
+
+
+static void Log_Submit( log_queue_entry_t& srEntry )
+{
+	// the logging thread may free the message before we get to show it
+	ch_string fatalMessage;
+	if ( srEntry.aType == ELogType_Fatal )
+		fatalMessage = ch_str_copy( srEntry.apHeapMsg ? srEntry.apHeapMsg : srEntry.aMsg, srEntry.aLen );
+
+	gLogLastChannel.store( srEntry.channel, std::memory_order_relaxed );
+
+	auto& queue = Log_GetQueue();
+
+	while ( !queue.push( srEntry ) )
+	{
+		// the queue is full, wait for the logging thread to catch up instead of dropping logs
+		gLogQueueStalls.fetch_add( 1, std::memory_order_relaxed );
+
+		if ( Log_CanWaitForThread() )
+		{
+			Log_WakeThread();
+			std::this_thread::yield();
+		}
+		else
+		{
+			Log_ProcessQueue();
+		}
+	}
+
+	gLogPushed.fetch_add( 1, std::memory_order_release );
+
+	// before Log_Init() or after Log_Shutdown(), the thread submitting it handles it
+	if ( !gLogThreadRunning )
+		Log_ProcessQueue();
+
+	else if ( gLogThreadSleeping )
+		Log_WakeThread();
+
+	if ( srEntry.aType != ELogType_Fatal )
+		return;
+
+	Log_Flush();
+	Log_FatalExit( srEntry.channel, fatalMessage );
+}
+
+
+void Log_LockHistory()
+{
+	Log_GetMutex().lock();
+	gLogLockDepth++;
+}
+
+
+void Log_UnlockHistory()
+{
+	gLogLockDepth--;
+	Log_GetMutex().unlock();
+}
+
+
+u64 Log_GetHistoryStart()
+{
+	return gLogHistoryStart;
+}
+
+
+u64 Log_GetHistoryCount()
+{
+	return gLogHistoryCount;
+}
+
+
+const log_t* Log_GetHistoryLog( u64 sIndex )
+{
+	if ( sIndex < gLogHistoryStart || sIndex >= gLogHistoryCount )
+		return nullptr;
+
+	return &Log_GetHistory()[ sIndex % LOG_HISTORY_SIZE ];
+}
+
+
+log_channel_h Log_GetLastChannel()
+{
+	return gLogLastChannel.load( std::memory_order_relaxed );
+}
+
+
 void Log_SetColor( ELogColor color )
 {
     gCurrentColor = color;
@@ -1200,12 +1606,6 @@ unsigned char Log_GetChannelCount()
 }
 
 
-const std::vector< log_t >& Log_GetLogHistory()
-{
-    return gLogHistory;
-}
-
-
 bool Log_ChannelIsShown( log_channel_h handle )
 {
 	log_channel_t* channel = Log_GetChannelData( handle );
@@ -1229,15 +1629,6 @@ int Log_GetDevLevel()
 }
 
 
-const log_t* Log_GetLastLog()
-{
-    if ( gLogHistory.size() == 0 )
-        return nullptr;
-
-    return &gLogHistory[ gLogHistory.size() - 1 ];
-}
-
-
 bool Log_IsVisible( const log_t& log )
 {
 	if ( !Log_DevLevelVisible( log ) )
@@ -1280,13 +1671,20 @@ log_t Log_GroupBegin()
 
 void Log_GroupEnd( log_t& sGroup )
 {
-	gLogMutex.lock();
+	if ( !sGroup.aMessage.data )
+		return;
 
-	// Submit the built log
-	gLogHistory.push_back( sGroup );
-	Log_AddLogInternal( gLogHistory.back() );
+	// Submit the built log, the logging thread owns the message now
+	log_queue_entry_t entry;
+	entry.channel   = sGroup.channel;
+	entry.aType     = sGroup.aType;
+	entry.aLen      = sGroup.aMessage.size;
+	entry.apHeapMsg = sGroup.aMessage.data;
 
-	gLogMutex.unlock();
+	sGroup.aMessage.data = nullptr;
+	sGroup.aMessage.size = 0;
+
+	Log_Submit( entry );
 }
 
 
@@ -1320,9 +1718,9 @@ void Log_GroupV( log_t& sGroup, const char* spFmt, va_list args )
 	if ( !ch_str_check_empty( spFmt, bufLen ) )
 		return;
 
-	ch_string formatted = ch_str_copy_v( spFmt, args );
+	ch_string_small<> formatted;
 
-	if ( !formatted.data )
+	if ( !formatted.append_v( spFmt, args ) )
 		return;
 
 	// concat it
@@ -1378,23 +1776,32 @@ void Log_Ex( log_channel_h sChannel, ELogType sLevel, const char* spBuf )
 {
 	PROF_SCOPE();
 
-	gLogMutex.lock();
-
 	// Is this a developer level?
-	if ( !Log_ShouldAddLog( sChannel, sLevel ) )
-	{
-		gLogMutex.unlock();
+	if ( !spBuf || !Log_ShouldAddLog( sChannel, sLevel ) )
 		return;
-	}
 
-	ch_string message = ch_str_copy( spBuf );
+	log_queue_entry_t entry;
+	entry.channel   = sChannel;
+	entry.aType     = sLevel;
+	entry.aLen      = strlen( spBuf );
+	entry.apHeapMsg = nullptr;
 
-	gLogHistory.emplace_back( sChannel, sLevel, message );
-	log_t& log = gLogHistory[ gLogHistory.size() - 1 ];
+	if ( entry.aLen < LOG_INLINE_MSG_SIZE )
+	{
+		memcpy( entry.aMsg, spBuf, entry.aLen + 1 );
+	}
+	else
+	{
+		entry.apHeapMsg = ch_str_copy( spBuf, entry.aLen ).data;
 
-	Log_AddLogInternal( log );
+		if ( !entry.apHeapMsg )
+		{
+			print( "\n *** LogSystem: Failed to Allocate Memory for Log Message!\n\n" );
+			return;
+		}
+	}
 
-	gLogMutex.unlock();
+	Log_Submit( entry );
 }
 
 
@@ -1408,42 +1815,42 @@ void Log_ExV( log_channel_h sChannel, ELogType sLevel, const char* spFmt, va_lis
 {
 	PROF_SCOPE();
 
-	gLogMutex.lock();
-
 	// Is this a developer level?
 	if ( !Log_ShouldAddLog( sChannel, sLevel ) )
-	{
-		gLogMutex.unlock();
 		return;
-	}
 
-	gLogHistory.emplace_back( sChannel, sLevel );
-	log_t&    log = gLogHistory[ gLogHistory.size() - 1 ];
+	log_queue_entry_t entry;
+	entry.channel   = sChannel;
+	entry.aType     = sLevel;
+	entry.apHeapMsg = nullptr;
 
+	// the arguments don't outlive this call, so the message has to be formatted here,
+	// everything else is left for the logging thread
 	va_list copy;
 	va_copy( copy, args );
-	int len = std::vsnprintf( nullptr, 0, spFmt, copy );
+	int len = std::vsnprintf( entry.aMsg, LOG_INLINE_MSG_SIZE, spFmt, copy );
 	va_end( copy );
 
 	if ( len < 0 )
 	{
 		print( "\n *** LogSystem: vsnprintf failed?\n\n" );
-		gLogMutex.unlock();
 		return;
 	}
 
-	log.aMessage = ch_str_copy_v( spFmt, args );
+	entry.aLen = len;
 
-	if ( !log.aMessage.data )
+	if ( entry.aLen >= LOG_INLINE_MSG_SIZE )
 	{
-		print( "\n *** LogSystem: Failed to Allocate Memory for Log Message!\n\n" );
-		gLogMutex.unlock();
-		return;
-	}
+		entry.apHeapMsg = ch_str_copy_v( spFmt, args ).data;
 
-	Log_AddLogInternal( log );
+		if ( !entry.apHeapMsg )
+		{
+			print( "\n *** LogSystem: Failed to Allocate Memory for Log Message!\n\n" );
+			return;
+		}
+	}
 
-	gLogMutex.unlock();
+	Log_Submit( entry );
 }
 
 
@@ -1702,14 +2109,29 @@ CONCMD_NAME( log_color_dump, "ch.log.dump.colors" )
 
 CONCMD_VA( clear, "Clear Logging System History" )
 {
-	gLogMutex.lock();
-	
-	gLogHistory.clear();
-	gLogHistory.shrink_to_fit();
+	log_lock_guard_t lock;
+
+	log_t* history = Log_GetHistory();
+
+	for ( u64 i = gLogHistoryStart; i < gLogHistoryCount; i++ )
+		Log_FreeLog( history[ i % LOG_HISTORY_SIZE ] );
+
+	gLogHistoryStart = gLogHistoryCount;
 
 	Log_RunCallbacksChannelShown();
+}
+
+
+CONCMD_NAME_VA( log_stats, "ch.log.stats", "Show logging thread and history stats" )
+{
+	u64 pushed    = gLogPushed.load( std::memory_order_acquire );
+	u64 processed = gLogProcessed.load( std::memory_order_acquire );
 
-	gLogMutex.unlock();
+	Log_MsgF( gLC_Logging, "Logging Thread: %s\n", gLogThreadRunning ? "Running" : "Stopped" );
+	Log_MsgF( gLC_Logging, "Logs Submitted: %llu - %llu waiting in queue\n", pushed, pushed > processed ? pushed - processed : 0 );
+	Log_MsgF( gLC_Logging, "Queue Stalls:   %llu\n", gLogQueueStalls.load( std::memory_order_relaxed ) );
+	Log_MsgF( gLC_Logging, "History:        %llu / %u logs, %llu total\n", gLogHistoryCount - gLogHistoryStart, LOG_HISTORY_SIZE, gLogHistoryCount );
+	Log_MsgF( gLC_Logging, "Log File:       %s\n", gpLogFile ? "Open" : "None" );
 }
 
 #define LOG_DUMP_FILENAME "log_dump"
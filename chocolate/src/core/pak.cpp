@@ -0,0 +1,528 @@
+#include "core/pak.h"
+#include "core/compress.h"
+#include "core/filesystem.h"
+#include "core/profiler.h"
+#include "core/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+LOG_CHANNEL( FileSystem );
+
+
+// only compress a file if it saves at least this much
+constexpr float PAK_MIN_COMPRESS_RATIO = 0.9f;
+
+
+struct ch_pak_t
+{
+	ch_file_view           aView;
+	const ch_pak_header_t* apHeader;
+	const ch_pak_entry_t*  apEntries;
+	const u32*             apHash;
+	const char*            apStrings;
+};
+
+
+static inline char pak_name_char( char c )
+{
+	if ( c == '\\' )
+		return '/';
+
+	return (char)tolower( (unsigned char)c );
+}
+
+
+static inline u64 pak_align( u64 sValue, u64 sAlign )
+{
+	return ( sValue + sAlign - 1 ) & ~( sAlign - 1 );
+}
+
+
+static inline u32 pak_block_count( u64 sSize )
+{
+	return (u32)( ( sSize + CH_PAK_BLOCK_SIZE - 1 ) / CH_PAK_BLOCK_SIZE );
+}
+
+
+// FNV-1a
+u64 Pak_HashName( const char* spName, u64 sLen )
+{
+	u64 hash = 14695981039346656037ULL;
+
+	for ( u64 i = 0; i < sLen; i++ )
+	{
+		hash ^= (u8)pak_name_char( spName[ i ] );
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+
+// ================================================================================
+// Reading
+
+
+static bool pak_validate( ch_pak_t* spPak, const char* spPath )
+{
+	const ch_pak_header_t* header = spPak->apHeader;
+	u64                    size   = spPak->aView.size;
+
+	if ( size < sizeof( ch_pak_header_t ) || header->magic != CH_PAK_MAGIC )
+	{
+		Log_ErrorF( gLC_FileSystem, "Not a pak file: \"%s\"\n", spPath );
+		return false;
+	}
+
+	if ( header->version != CH_PAK_VERSION )
+	{
+		Log_ErrorF( gLC_FileSystem, "Pak file is version %u, expected version %u: \"%s\"\n", header->version, CH_PAK_VERSION, spPath );
+		return false;
+	}
+
+	bool valid = true;
+
+	valid &= header->hashSize >= header->entryCount && ( header->hashSize & ( header->hashSize - 1 ) ) == 0;
+	valid &= header->entryOffset % alignof( ch_pak_entry_t ) == 0 && header->hashOffset % alignof( u32 ) == 0;
+	valid &= header->entryOffset <= size && (u64)header->entryCount * sizeof( ch_pak_entry_t ) <= size - header->entryOffset;
+	valid &= header->hashOffset <= size && (u64)header->hashSize * sizeof( u32 ) <= size - header->hashOffset;
+	valid &= header->stringOffset <= size && header->stringSize <= size - header->stringOffset;
+
+	for ( u32 i = 0; valid && i < header->entryCount; i++ )
+	{
+		const ch_pak_entry_t& entry = spPak->apEntries[ i ];
+
+		valid &= entry.offset <= size && entry.storedSize <= size - entry.offset;
+		valid &= (u64)entry.nameOffset + entry.nameLen <= header->stringSize;
+		valid &= entry.compression < EPakCompression_Count;
+		valid &= entry.compression != EPakCompression_None || entry.storedSize == entry.size;
+	}
+
+	for ( u32 i = 0; valid && i < header->hashSize; i++ )
+		valid &= spPak->apHash[ i ] <= header->entryCount;
+
+	if ( !valid )
+		Log_ErrorF( gLC_FileSystem, "Pak file is corrupt: \"%s\"\n", spPath );
+
+	return valid;
+}
+
+
+ch_pak_t* Pak_Open( const char* spPath )
+{
+	PROF_SCOPE();
+
+	ch_file_view view = FileSys_MapFile( spPath );
+
+	if ( !view.data )
+	{
+		Log_ErrorF( gLC_FileSystem, "Failed to open pak file: \"%s\"\n", spPath );
+		return nullptr;
+	}
+
+	ch_pak_t* pak  = ch_calloc< ch_pak_t >( 1 );
+	pak->aView     = view;
+	pak->apHeader  = (const ch_pak_header_t*)view.data;
+
+	if ( view.size >= sizeof( ch_pak_header_t ) )
+	{
+		pak->apEntries = (const ch_pak_entry_t*)( view.data + pak->apHeader->entryOffset );
+		pak->apHash    = (const u32*)( view.data + pak->apHeader->hashOffset );
+		pak->apStrings = view.data + pak->apHeader->stringOffset;
+	}
+
+	if ( !pak_validate( pak, spPath ) )
+	{
+		Pak_Close( pak );
+		return nullptr;
+	}
+
+	Log_DevF( gLC_FileSystem, 1, "Opened pak file with %u files: \"%s\"\n", pak->apHeader->entryCount, spPath );
+	return pak;
+}
+
+
+void Pak_Close( ch_pak_t* spPak )
+{
+	if ( !spPak )
+		return;
+
+	FileSys_CloseView( spPak->aView );
+	ch_free( spPak );
+}
+
+
+u32 Pak_GetEntryCount( ch_pak_t* spPak )
+{
+	if ( !spPak )
+		return 0;
+
+	return spPak->apHeader->entryCount;
+}
+
+
+const ch_pak_entry_t* Pak_GetEntry( ch_pak_t* spPak, u32 sIndex )
+{
+	if ( !spPak || sIndex >= spPak->apHeader->entryCount )
+		return nullptr;
+
+	return &spPak->apEntries[ sIndex ];
+}
+
+
+ch_string Pak_GetEntryName( ch_pak_t* spPak, u32 sIndex )
+{
+	ch_string name;
+
+	if ( !spPak || sIndex >= spPak->apHeader->entryCount )
+		return name;
+
+	const ch_pak_entry_t& entry = spPak->apEntries[ sIndex ];
+	name.data                   = (char*)spPak->apStrings + entry.nameOffset;
+	name.size                   = entry.nameLen;
+	return name;
+}
+
+
+s64 Pak_Find( ch_pak_t* spPak, const char* spPath, s64 sLen )
+{
+	PROF_SCOPE();
+
+	if ( !spPak || !spPath || spPak->apHeader->hashSize == 0 )
+		return -1;
+
+	if ( sLen == -1 )
+		sLen = strlen( spPath );
+
+	u64 hash = Pak_HashName( spPath, sLen );
+	u32 mask = spPak->apHeader->hashSize - 1;
+
+	for ( u32 probe = 0; probe <= mask; probe++ )
+	{
+		u32 slot = spPak->apHash[ ( hash + probe ) & mask ];
+
+		if ( slot == 0 )
+			return -1;
+
+		const ch_pak_entry_t& entry = spPak->apEntries[ slot - 1 ];
+
+		if ( entry.hash != hash || entry.nameLen != sLen )
+			continue;
+
+		const char* name  = spPak->apStrings + entry.nameOffset;
+		bool        match = true;
+
+		for ( s64 i = 0; match && i < sLen; i++ )
+			match = name[ i ] == pak_name_char( spPath[ i ] );
+
+		if ( match )
+			return slot - 1;
+	}
+
+	return -1;
+}
+
+
+const char* Pak_GetView( ch_pak_t* spPak, u32 sIndex )
+{
+	const ch_pak_entry_t* entry = Pak_GetEntry( spPak, sIndex );
+
+	if ( !entry || entry->compression != EPakCompression_None )
+		return nullptr;
+
+	return spPak->aView.data + entry->offset;
+}
+
+
+bool Pak_Read( ch_pak_t* spPak, u32 sIndex, char* spDst )
+{
+	PROF_SCOPE();
+
+	const ch_pak_entry_t* entry = Pak_GetEntry( spPak, sIndex );
+
+	if ( !entry || ( !spDst && entry->size ) )
+		return false;
+
+	const char* data = spPak->aView.data + entry->offset;
+
+	if ( entry->compression == EPakCompression_None )
+	{
+		memcpy( spDst, data, entry->size );
+		return true;
+	}
+
+	u32 blockCount = pak_block_count( entry->size );
+	u64 tableSize  = blockCount * sizeof( u32 );
+
+	if ( entry->storedSize < tableSize )
+		return false;
+
+	const char* block     = data + tableSize;
+	u64         remaining = entry->storedSize - tableSize;
+
+	for ( u32 i = 0; i < blockCount; i++ )
+	{
+		u32 storedSize;
+		memcpy( &storedSize, data + i * sizeof( u32 ), sizeof( u32 ) );
+
+		u64 offset  = (u64)i * CH_PAK_BLOCK_SIZE;
+		u64 rawSize = std::min< u64 >( CH_PAK_BLOCK_SIZE, entry->size - offset );
+
+		if ( storedSize > remaining )
+			return false;
+
+		if ( storedSize == rawSize )
+		{
+			memcpy( spDst + offset, block, rawSize );
+		}
+		else if ( !ch_lz4_decompress( block, storedSize, spDst + offset, rawSize ) )
+		{
+			Log_ErrorF( gLC_FileSystem, "Failed to decompress pak file entry %u\n", sIndex );
+			return false;
+		}
+
+		block += storedSize;
+		remaining -= storedSize;
+	}
+
+	return true;
+}
+
+
+// ================================================================================
+// Writing
+
+
+struct pak_write_file_t
+{
+	const ch_pak_file_t* apFile;
+	std::string          aName;
+	u64                  aHash;
+	u32                  aAlignment;
+};
+
+
+// Lowercase with forward slashes, and without "./" or a leading slash
+static std::string pak_write_name( const char* spName )
+{
+	std::string name;
+
+	for ( const char* c = spName; *c; c++ )
+		name.push_back( pak_name_char( *c ) );
+
+	while ( name.size() >= 2 && name[ 0 ] == '.' && name[ 1 ] == '/' )
+		name.erase( 0, 2 );
+
+	while ( name.size() && name[ 0 ] == '/' )
+		name.erase( 0, 1 );
+
+	return name;
+}
+
+
+// Compress a file into LZ4 blocks, returns false if it's not worth storing compressed
+static bool pak_compress( const std::vector< char >& srData, std::vector< char >& srOutput )
+{
+	u32 blockCount = pak_block_count( srData.size() );
+	u64 tableSize  = blockCount * sizeof( u32 );
+
+	srOutput.resize( tableSize );
+
+	std::vector< char > block( ch_lz4_compress_bound( CH_PAK_BLOCK_SIZE ) );
+
+	for ( u32 i = 0; i < blockCount; i++ )
+	{
+		u64 offset     = (u64)i * CH_PAK_BLOCK_SIZE;
+		u64 rawSize    = std::min< u64 >( CH_PAK_BLOCK_SIZE, srData.size() - offset );
+		u64 storedSize = ch_lz4_compress( srData.data() + offset, rawSize, block.data(), block.size() );
+
+		// store it uncompressed if it didn't get any smaller
+		const char* src = block.data();
+		if ( storedSize == 0 || storedSize >= rawSize )
+		{
+			storedSize = rawSize;
+			src        = srData.data() + offset;
+		}
+
+		u32 storedSize32 = (u32)storedSize;
+		memcpy( srOutput.data() + i * sizeof( u32 ), &storedSize32, sizeof( u32 ) );
+		srOutput.insert( srOutput.end(), src, src + storedSize );
+	}
+
+	return srOutput.size() <= srData.size() * PAK_MIN_COMPRESS_RATIO;
+}
+
+
+static void pak_write_padding( std::ofstream& srStream, u64 sTarget )
+{
+	static const char zeros[ 4096 ]{};
+
+	u64 pos = srStream.tellp();
+
+	while ( pos < sTarget )
+	{
+		u64 amount = std::min< u64 >( sizeof( zeros ), sTarget - pos );
+		srStream.write( zeros, amount );
+		pos += amount;
+	}
+}
+
+
+bool Pak_Write( const char* spOutput, const ch_pak_file_t* spFiles, u32 sCount )
+{
+	PROF_SCOPE();
+
+	if ( !spOutput || ( !spFiles && sCount ) )
+		return false;
+
+	// ----------------------------------------------------------------
+	// Sort out the names first, since the table of contents goes before the data
+
+	std::vector< pak_write_file_t > files;
+	files.reserve( sCount );
+
+	for ( u32 i = 0; i < sCount; i++ )
+	{
+		pak_write_file_t file;
+		file.apFile     = &spFiles[ i ];
+		file.aName      = pak_write_name( spFiles[ i ].apName );
+		file.aHash      = Pak_HashName( file.aName.data(), file.aName.size() );
+		file.aAlignment = spFiles[ i ].aAlignment ? spFiles[ i ].aAlignment : CH_PAK_DEFAULT_ALIGN;
+
+		if ( file.aName.empty() )
+		{
+			Log_WarnF( gLC_FileSystem, "Skipping pak file with an empty name: \"%s\"\n", spFiles[ i ].apPath );
+			continue;
+		}
+
+		if ( file.aAlignment > CH_PAK_MAX_ALIGN || ( file.aAlignment & ( file.aAlignment - 1 ) ) != 0 )
+		{
+			Log_WarnF( gLC_FileSystem, "Invalid pak file alignment of %u, using %u: \"%s\"\n", file.aAlignment, CH_PAK_DEFAULT_ALIGN, file.aName.c_str() );
+			file.aAlignment = CH_PAK_DEFAULT_ALIGN;
+		}
+
+		files.push_back( std::move( file ) );
+	}
+
+	std::stable_sort( files.begin(), files.end(), []( const pak_write_file_t& a, const pak_write_file_t& b ) { return a.aName < b.aName; } );
+
+	auto duplicate = std::unique( files.begin(), files.end(), []( const pak_write_file_t& a, const pak_write_file_t& b ) { return a.aName == b.aName; } );
+
+	for ( auto it = duplicate; it != files.end(); it++ )
+		Log_WarnF( gLC_FileSystem, "Skipping duplicate pak file: \"%s\"\n", it->aName.c_str() );
+
+	files.erase( duplicate, files.end() );
+
+	ch_pak_header_t header{};
+	header.magic      = CH_PAK_MAGIC;
+	header.version    = CH_PAK_VERSION;
+	header.entryCount = (u32)files.size();
+	header.hashSize   = 1;
+
+	while ( header.hashSize < header.entryCount * 2 )
+		header.hashSize <<= 1;
+
+	std::vector< ch_pak_entry_t > entries( files.size() );
+	std::vector< u32 >            hashTable( header.hashSize, 0 );
+	std::string                   strings;
+
+	for ( u32 i = 0; i < files.size(); i++ )
+	{
+		entries[ i ].hash       = files[ i ].aHash;
+		entries[ i ].nameOffset = (u32)strings.size();
+		entries[ i ].nameLen    = (u32)files[ i ].aName.size();
+		entries[ i ].alignment  = files[ i ].aAlignment;
+		strings += files[ i ].aName;
+
+		u32 slot = files[ i ].aHash & ( header.hashSize - 1 );
+		while ( hashTable[ slot ] != 0 )
+			slot = ( slot + 1 ) & ( header.hashSize - 1 );
+
+		hashTable[ slot ] = i + 1;
+	}
+
+	header.entryOffset  = sizeof( ch_pak_header_t );
+	header.hashOffset   = pak_align( header.entryOffset + entries.size() * sizeof( ch_pak_entry_t ), alignof( u64 ) );
+	header.stringOffset = header.hashOffset + hashTable.size() * sizeof( u32 );
+	header.stringSize   = strings.size();
+
+	// ----------------------------------------------------------------
+	// Write the file data, then go back and write the table of contents
+
+	std::ofstream stream( spOutput, std::ios::binary | std::ios::trunc );
+
+	if ( !stream.is_open() )
+	{
+		Log_ErrorF( gLC_FileSystem, "Failed to open pak file for writing: \"%s\"\n", spOutput );
+		return false;
+	}
+
+	pak_write_padding( stream, header.stringOffset + header.stringSize );
+
+	std::vector< char > data;
+	std::vector< char > compressed;
+	u64                 totalSize  = 0;
+	u64                 storedSize = 0;
+
+	for ( u32 i = 0; i < files.size(); i++ )
+	{
+		ch_pak_entry_t& entry = entries[ i ];
+
+		std::ifstream   input( files[ i ].apFile->apPath, std::ios::binary | std::ios::ate );
+
+		if ( !input.is_open() )
+		{
+			Log_ErrorF( gLC_FileSystem, "Failed to open file for pak: \"%s\"\n", files[ i ].apFile->apPath );
+			return false;
+		}
+
+		data.resize( input.tellg() );
+		input.seekg( 0 );
+		input.read( data.data(), data.size() );
+
+		entry.size        = data.size();
+		entry.compression = EPakCompression_None;
+
+		const std::vector< char >* stored = &data;
+
+		if ( files[ i ].apFile->aCompress && data.size() && pak_compress( data, compressed ) )
+		{
+			entry.compression = EPakCompression_LZ4;
+			stored            = &compressed;
+		}
+
+		entry.storedSize = stored->size();
+		entry.offset     = pak_align( stream.tellp(), entry.alignment );
+
+		pak_write_padding( stream, entry.offset );
+		stream.write( stored->data(), stored->size() );
+
+		totalSize += entry.size;
+		storedSize += entry.storedSize;
+	}
+
+	stream.seekp( 0 );
+	stream.write( (const char*)&header, sizeof( header ) );
+	stream.write( (const char*)entries.data(), entries.size() * sizeof( ch_pak_entry_t ) );
+	pak_write_padding( stream, header.hashOffset );
+	stream.write( (const char*)hashTable.data(), hashTable.size() * sizeof( u32 ) );
+	stream.write( strings.data(), strings.size() );
+
+	if ( !stream.good() )
+	{
+		Log_ErrorF( gLC_FileSystem, "Failed to write pak file: \"%s\"\n", spOutput );
+		return false;
+	}
+
+	FileSys_NotifyWrite( spOutput );
+
+	Log_MsgF( gLC_FileSystem, "Wrote pak file with %u files, %.2f MB stored as %.2f MB: \"%s\"\n",
+	          header.entryCount, totalSize / ( 1024.f * 1024.f ), storedSize / ( 1024.f * 1024.f ), spOutput );
+
+	return true;
+}
+
@@ -0,0 +1,162 @@
+#include "core/pipeline_cache.h"
+#include "core/commandline.h"
+#include "core/filesystem.h"
+#include "core/log.h"
+#include "core/util.h"
+
+
+LOG_CHANNEL_REGISTER( PipelineCache, ELogColor_DarkGray );
+
+
+constexpr u32 CH_PIPELINE_CACHE_MAGIC   = ( 'C' | ( 'H' << 8 ) | ( 'P' << 16 ) | ( 'C' << 24 ) );
+constexpr u32 CH_PIPELINE_CACHE_VERSION = 1;
+
+
+struct PipelineCacheHeader_t
+{
+	u32 aMagic;
+	u32 aVersion;
+
+	u32 aVendorID;
+	u32 aDeviceID;
+	u32 aDriverVersion;
+	u8  aCacheUUID[ 16 ];
+
+	u64 aDataSize;
+	u64 aDataHash;
+};
+
+
+static void PipelineCache_FillHeader( PipelineCacheHeader_t& srHeader, const ch_pipeline_cache_key& srKey )
+{
+	srHeader.aMagic         = CH_PIPELINE_CACHE_MAGIC;
+	srHeader.aVersion       = CH_PIPELINE_CACHE_VERSION;
+	srHeader.aVendorID      = srKey.aVendorID;
+	srHeader.aDeviceID      = srKey.aDeviceID;
+	srHeader.aDriverVersion = srKey.aDriverVersion;
+	memcpy( srHeader.aCacheUUID, srKey.aCacheUUID, sizeof( srHeader.aCacheUUID ) );
+}
+
+
+bool PipelineCache_IsEnabled()
+{
+	// core is loaded before the command line is parsed, so this can't be registered during static init
+	static bool noPipelineCache = args_register( false, "Don't load or save the Vulkan pipeline cache", "--vk-no-pipeline-cache" );
+	return !noPipelineCache;
+}
+
+
+bool PipelineCache_Load( const char* spPath, const ch_pipeline_cache_key& srKey, std::vector< char >& srData )
+{
+	srData.clear();
+
+	if ( !PipelineCache_IsEnabled() )
+		return false;
+
+	FILE* fp = fopen( spPath, "rb" );
+
+	if ( !fp )
+	{
+		Log_DevF( gLC_PipelineCache, 1, "No pipeline cache found, pipelines will be compiled from scratch: \"%s\"\n", spPath );
+		return false;
+	}
+
+	fseek( fp, 0, SEEK_END );
+	long fileSize = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+
+	PipelineCacheHeader_t header{};
+	PipelineCacheHeader_t expected{};
+	PipelineCache_FillHeader( expected, srKey );
+
+	if ( fileSize < (long)sizeof( header ) || fread( &header, sizeof( header ), 1, fp ) != 1 )
+	{
+		Log_WarnF( gLC_PipelineCache, "Pipeline cache is too small, ignoring it: \"%s\"\n", spPath );
+		fclose( fp );
+		return false;
+	}
+
+	if ( header.aMagic != expected.aMagic || header.aVersion != expected.aVersion )
+	{
+		Log_WarnF( gLC_PipelineCache, "Pipeline cache is from an older version of the engine, ignoring it: \"%s\"\n", spPath );
+		fclose( fp );
+		return false;
+	}
+
+	if ( header.aVendorID != expected.aVendorID || header.aDeviceID != expected.aDeviceID ||
+	     header.aDriverVersion != expected.aDriverVersion || memcmp( header.aCacheUUID, expected.aCacheUUID, sizeof( header.aCacheUUID ) ) != 0 )
+	{
+		Log_Msg( gLC_PipelineCache, "Pipeline cache is from a different GPU or driver, pipelines will be compiled from scratch\n" );
+		fclose( fp );
+		return false;
+	}
+
+	// check the size before allocating anything, a broken header could ask for any amount of memory
+	if ( header.aDataSize > (u64)fileSize - sizeof( header ) )
+	{
+		Log_WarnF( gLC_PipelineCache, "Pipeline cache is corrupted, ignoring it: \"%s\"\n", spPath );
+		fclose( fp );
+		return false;
+	}
+
+	srData.resize( header.aDataSize );
+
+	if ( fread( srData.data(), 1, srData.size(), fp ) != header.aDataSize || ch_hash_fnv1a_64( srData.data(), srData.size() ) != header.aDataHash )
+	{
+		Log_WarnF( gLC_PipelineCache, "Pipeline cache is corrupted, ignoring it: \"%s\"\n", spPath );
+		srData.clear();
+	}
+
+	fclose( fp );
+	return srData.size();
+}
+
+
+bool PipelineCache_Save( const char* spPath, const ch_pipeline_cache_key& srKey, const char* spData, u64 sSize )
+{
+	if ( !PipelineCache_IsEnabled() || sSize == 0 )
+		return false;
+
+	PipelineCacheHeader_t header{};
+	PipelineCache_FillHeader( header, srKey );
+	header.aDataSize = sSize;
+	header.aDataHash = ch_hash_fnv1a_64( spData, sSize );
+
+	ch_string_auto dir = FileSys_GetDirName( spPath );
+
+	if ( dir.data && !FileSys_Exists( dir.data, dir.size ) && !FileSys_CreateDirectory( dir.data ) )
+	{
+		Log_ErrorF( gLC_PipelineCache, "Failed to create directory for pipeline cache: \"%s\"\n", dir.data );
+		return false;
+	}
+
+	ch_string_auto tempPath = ch_str_join( spPath, ".tmp" );
+	FILE*          fp       = fopen( tempPath.data, "wb" );
+
+	if ( !fp )
+	{
+		Log_ErrorF( gLC_PipelineCache, "Failed to open pipeline cache for writing: \"%s\"\n", spPath );
+		return false;
+	}
+
+	bool written = fwrite( &header, sizeof( header ), 1, fp ) == 1 && fwrite( spData, 1, sSize, fp ) == sSize;
+	fclose( fp );
+
+	if ( !written )
+	{
+		Log_ErrorF( gLC_PipelineCache, "Failed to write pipeline cache: \"%s\"\n", spPath );
+		remove( tempPath.data );
+		return false;
+	}
+
+	remove( spPath );
+
+	if ( rename( tempPath.data, spPath ) != 0 )
+	{
+		Log_ErrorF( gLC_PipelineCache, "Failed to save pipeline cache: \"%s\"\n", spPath );
+		return false;
+	}
+
+	Log_DevF( gLC_PipelineCache, 1, "Saved pipeline cache - %llu KB\n", sSize / 1024 );
+	return true;
+}
@@ -0,0 +1,570 @@
+#include "core/profiler.h"
+#include "core/console.h"
+#include "core/log.h"
+#include "core/platform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+
+LOG_CHANNEL_REGISTER( Profiler, ELogColor_DarkCyan );
+
+
+// must be a power of 2
+constexpr u32 CH_PROF_RING_SIZE    = 32768;
+constexpr u32 CH_PROF_RING_MASK    = CH_PROF_RING_SIZE - 1;
+
+// how many frames each scope keeps its time for, for the stats
+constexpr u32 CH_PROF_STAT_FRAMES  = 256;
+
+constexpr u32 CH_PROF_THREAD_NAME  = 32;
+
+
+// Only the owning thread writes to this, and only the main thread reads from it
+struct ch_prof_thread_t
+{
+	ch_prof_event_t     aEvents[ CH_PROF_RING_SIZE ];
+	std::atomic< u32 >  aWrite   = 0;
+	std::atomic< u32 >  aRead    = 0;
+	std::atomic< u32 >  aDropped = 0;
+	std::atomic< bool > aExited  = false;  // the thread exited, it's freed once the main thread reads what's left
+	bool                aFree    = false;  // in g_prof_free_threads, guarded by g_prof_thread_mutex
+	u16                 aDepth   = 0;
+	u16                 aIndex   = 0;
+	char                aName[ CH_PROF_THREAD_NAME ]{};
+};
+
+
+// Gives the thread's ring back when the thread exits
+struct ch_prof_thread_owner_t
+{
+	ch_prof_thread_t* apThread = nullptr;
+
+	~ch_prof_thread_owner_t()
+	{
+		if ( apThread )
+			apThread->aExited.store( true, std::memory_order_release );
+	}
+};
+
+
+struct ch_prof_location_stats_t
+{
+	ch_prof_location_t* apLocation = nullptr;
+	float               aTimes[ CH_PROF_STAT_FRAMES ]{};
+	u32                 aCount     = 0;  // how many times are valid
+	u32                 aNext      = 0;
+	u32                 aCalls     = 0;
+
+	// this frame
+	u64                 aFrameTime  = 0;
+	u32                 aFrameCalls = 0;
+};
+
+
+static std::atomic< bool >                     g_prof_running = false;
+
+// rings of exited threads are reused by new threads, keeping the same index, so short lived threads don't add more
+static std::mutex                              g_prof_thread_mutex;
+static std::vector< ch_prof_thread_t* >        g_prof_threads;
+static std::vector< ch_prof_thread_t* >        g_prof_free_threads;
+static thread_local ch_prof_thread_t*          g_prof_thread = nullptr;
+static thread_local ch_prof_thread_owner_t     g_prof_thread_owner;
+
+// only touched on the main thread, in profile_end_frame, or by things reading the results
+static std::vector< ch_prof_frame_t >          g_prof_frames;
+static u32                                     g_prof_frame_next   = 0;
+static u32                                     g_prof_frame_count  = 0;
+static u64                                     g_prof_frame_start  = 0;
+
+// index 0 is unused, so an id of 0 means it hasn't been seen yet
+static std::vector< ch_prof_location_stats_t > g_prof_locations( 1 );
+static std::vector< u32 >                      g_prof_frame_locations;
+
+
+CONVAR_RANGE_INT( prof_history, 120, 1, 2000, "How many frames the profiler keeps every scope for, for the timeline and exported traces" );
+
+
+u64 Prof_GetTime()
+{
+	return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+static ch_prof_thread_t* Prof_GetThread()
+{
+	if ( g_prof_thread )
+		return g_prof_thread;
+
+	std::lock_guard< std::mutex > lock( g_prof_thread_mutex );
+
+	if ( g_prof_free_threads.size() )
+	{
+		// already drained by profile_end_frame, so nothing is reading it
+		g_prof_thread = g_prof_free_threads.back();
+		g_prof_free_threads.pop_back();
+
+		g_prof_thread->aWrite.store( 0, std::memory_order_relaxed );
+		g_prof_thread->aRead.store( 0, std::memory_order_relaxed );
+		g_prof_thread->aDropped.store( 0, std::memory_order_relaxed );
+		g_prof_thread->aExited.store( false, std::memory_order_relaxed );
+		g_prof_thread->aFree  = false;
+		g_prof_thread->aDepth = 0;
+	}
+	else
+	{
+		g_prof_thread         = new ch_prof_thread_t;
+		g_prof_thread->aIndex = g_prof_threads.size();
+		g_prof_threads.push_back( g_prof_thread );
+	}
+
+	snprintf( g_prof_thread->aName, CH_PROF_THREAD_NAME, "Thread %u", (u32)g_prof_thread->aIndex );
+
+	g_prof_thread_owner.apThread = g_prof_thread;
+	return g_prof_thread;
+}
+
+
+u64 Prof_ScopeBegin()
+{
+	if ( !g_prof_running.load( std::memory_order_relaxed ) )
+		return 0;
+
+	Prof_GetThread()->aDepth++;
+	return Prof_GetTime();
+}
+
+
+void Prof_ScopeEnd( ch_prof_location_t* spLocation, u64 sStart )
+{
+	u64               end    = Prof_GetTime();
+	ch_prof_thread_t* thread = Prof_GetThread();
+
+	thread->aDepth--;
+
+	u32 write = thread->aWrite.load( std::memory_order_relaxed );
+
+	if ( write - thread->aRead.load( std::memory_order_acquire ) >= CH_PROF_RING_SIZE )
+	{
+		thread->aDropped.fetch_add( 1, std::memory_order_relaxed );
+		return;
+	}
+
+	ch_prof_event_t& event = thread->aEvents[ write & CH_PROF_RING_MASK ];
+	event.apLocation       = spLocation;
+	event.aStart           = sStart;
+	event.aEnd             = end;
+	event.aDepth           = thread->aDepth;
+	event.aThread          = thread->aIndex;
+
+	thread->aWrite.store( write + 1, std::memory_order_release );
+}
+
+
+void Prof_Start()
+{
+	g_prof_running = true;
+}
+
+
+void Prof_Stop()
+{
+	g_prof_running = false;
+}
+
+
+bool Prof_IsRunning()
+{
+	return g_prof_running;
+}
+
+
+void Prof_SetThreadName( const char* spName )
+{
+	if ( spName )
+		snprintf( Prof_GetThread()->aName, CH_PROF_THREAD_NAME, "%s", spName );
+}
+
+
+u32 Prof_GetThreadCount()
+{
+	std::lock_guard< std::mutex > lock( g_prof_thread_mutex );
+	return g_prof_threads.size();
+}
+
+
+const char* Prof_GetThreadName( u32 sThread )
+{
+	std::lock_guard< std::mutex > lock( g_prof_thread_mutex );
+
+	if ( sThread >= g_prof_threads.size() )
+		return "";
+
+	return g_prof_threads[ sThread ]->aName;
+}
+
+
+u32 Prof_GetFrameCount()
+{
+	return g_prof_frame_count;
+}
+
+
+const ch_prof_frame_t* Prof_GetFrame( u32 sIndex )
+{
+	if ( sIndex >= g_prof_frame_count )
+		return nullptr;
+
+	u32 size = g_prof_frames.size();
+	return &g_prof_frames[ ( g_prof_frame_next + size - 1 - sIndex ) % size ];
+}
+
+
+const char* Prof_GetLocationName( const ch_prof_location_t* spLocation )
+{
+	if ( !spLocation )
+		return "";
+
+	return spLocation->apName ? spLocation->apName : spLocation->apFunc;
+}
+
+
+// ----------------------------------------------------------------------------------------
+// Frame Collection
+
+
+static void Prof_AddEventStats( ch_prof_event_t& srEvent )
+{
+	ch_prof_location_t* location = srEvent.apLocation;
+
+	if ( location->aId == 0 )
+	{
+		location->aId = g_prof_locations.size();
+		g_prof_locations.emplace_back().apLocation = location;
+	}
+
+	ch_prof_location_stats_t& stats = g_prof_locations[ location->aId ];
+
+	if ( stats.aFrameCalls == 0 )
+		g_prof_frame_locations.push_back( location->aId );
+
+	stats.aFrameTime += srEvent.aEnd - srEvent.aStart;
+	stats.aFrameCalls++;
+}
+
+
+void profile_end_frame()
+{
+#if defined( TRACY_ENABLE )
+	FrameMark;
+#endif
+
+	u64 now = Prof_GetTime();
+
+	// the thread ending frames is the main thread, name it if nothing else did
+	if ( g_prof_running )
+	{
+		ch_prof_thread_t* thread = Prof_GetThread();
+		if ( strncmp( thread->aName, "Thread ", 7 ) == 0 )
+			Prof_SetThreadName( "Main" );
+	}
+
+	if ( !g_prof_running && g_prof_frame_start == 0 )
+		return;
+
+	if ( g_prof_frames.size() != (u32)prof_history )
+	{
+		g_prof_frames.clear();
+		g_prof_frames.resize( prof_history );
+		g_prof_frame_next  = 0;
+		g_prof_frame_count = 0;
+	}
+
+	// collect into a spare list first, the next frame in the history is the oldest one, which is kept if nothing was recorded
+	static std::vector< ch_prof_event_t > events;
+	events.clear();
+
+	u64 frameStart     = g_prof_frame_start ? g_prof_frame_start : now;
+	g_prof_frame_start = g_prof_running ? now : 0;
+
+	u32 dropped = 0;
+
+	{
+		std::lock_guard< std::mutex > lock( g_prof_thread_mutex );
+
+		for ( ch_prof_thread_t* thread : g_prof_threads )
+		{
+			if ( thread->aFree )
+				continue;
+
+			// check before reading, so anything it wrote before exiting is read now
+			bool exited = thread->aExited.load( std::memory_order_acquire );
+			u32  read   = thread->aRead.load( std::memory_order_relaxed );
+			u32  write  = thread->aWrite.load( std::memory_order_acquire );
+
+			for ( ; read != write; read++ )
+				events.push_back( thread->aEvents[ read & CH_PROF_RING_MASK ] );
+
+			thread->aRead.store( read, std::memory_order_release );
+
+			dropped += thread->aDropped.exchange( 0, std::memory_order_relaxed );
+
+			if ( exited )
+			{
+				thread->aFree = true;
+				g_prof_free_threads.push_back( thread );
+			}
+		}
+	}
+
+	if ( dropped )
+		Log_DevF( gLC_Profiler, 1, "Dropped %u scopes this frame, a thread filled up its ring buffer\n", dropped );
+
+	// nothing was recorded, don't fill the history with empty frames
+	if ( events.empty() && !g_prof_running )
+		return;
+
+	ch_prof_frame_t& frame = g_prof_frames[ g_prof_frame_next ];
+	frame.aStart           = frameStart;
+	frame.aEnd             = now;
+	std::swap( frame.aEvents, events );
+
+	g_prof_frame_next  = ( g_prof_frame_next + 1 ) % g_prof_frames.size();
+	g_prof_frame_count = std::min< u32 >( g_prof_frame_count + 1, g_prof_frames.size() );
+
+	for ( ch_prof_event_t& event : frame.aEvents )
+		Prof_AddEventStats( event );
+
+	for ( u32 id : g_prof_frame_locations )
+	{
+		ch_prof_location_stats_t& stats = g_prof_locations[ id ];
+
+		stats.aTimes[ stats.aNext ] = stats.aFrameTime / 1000000.0;
+		stats.aNext                 = ( stats.aNext + 1 ) % CH_PROF_STAT_FRAMES;
+		stats.aCount                = std::min( stats.aCount + 1, CH_PROF_STAT_FRAMES );
+		stats.aCalls                = stats.aFrameCalls;
+
+		stats.aFrameTime            = 0;
+		stats.aFrameCalls           = 0;
+	}
+
+	g_prof_frame_locations.clear();
+}
+
+
+void Prof_GetStats( std::vector< ch_prof_stats_t >& srStats )
+{
+	float sorted[ CH_PROF_STAT_FRAMES ];
+
+	for ( size_t i = 1; i < g_prof_locations.size(); i++ )
+	{
+		ch_prof_location_stats_t& location = g_prof_locations[ i ];
+
+		if ( location.aCount == 0 )
+			continue;
+
+		ch_prof_stats_t& stats = srStats.emplace_back();
+		stats.apLocation       = location.apLocation;
+		stats.aFrames          = location.aCount;
+		stats.aCalls           = location.aCalls;
+		stats.aLast            = location.aTimes[ ( location.aNext + CH_PROF_STAT_FRAMES - 1 ) % CH_PROF_STAT_FRAMES ];
+
+		memcpy( sorted, location.aTimes, location.aCount * sizeof( float ) );
+		std::sort( sorted, sorted + location.aCount );
+
+		float total = 0.f;
+		for ( u32 frame = 0; frame < location.aCount; frame++ )
+			total += sorted[ frame ];
+
+		stats.aMin = sorted[ 0 ];
+		stats.aMax = sorted[ location.aCount - 1 ];
+		stats.aAvg = total / location.aCount;
+		stats.aP99 = sorted[ std::min( location.aCount - 1, ( location.aCount * 99 ) / 100 ) ];
+	}
+}
+
+
+// ----------------------------------------------------------------------------------------
+// Exporting
+
+
+static void Prof_WriteJsonString( FILE* spFile, const char* spString )
+{
+	fputc( '"', spFile );
+
+	for ( const char* c = spString; *c; c++ )
+	{
+		if ( *c == '"' || *c == '\\' )
+			fputc( '\\', spFile );
+
+		fputc( *c, spFile );
+	}
+
+	fputc( '"', spFile );
+}
+
+
+// quotes are doubled in csv
+static void Prof_WriteCSVString( FILE* spFile, const char* spString )
+{
+	fputc( '"', spFile );
+
+	for ( const char* c = spString; *c; c++ )
+	{
+		if ( *c == '"' )
+			fputc( '"', spFile );
+
+		fputc( *c, spFile );
+	}
+
+	fputs( "\",", spFile );
+}
+
+
+bool Prof_ExportTrace( const char* spPath )
+{
+	FILE* fp = fopen( spPath, "wb" );
+
+	if ( !fp )
+	{
+		Log_ErrorF( gLC_Profiler, "Failed to open \"%s\" to write a trace to\n", spPath );
+		return false;
+	}
+
+	const ch_prof_frame_t* oldest = Prof_GetFrame( g_prof_frame_count ? g_prof_frame_count - 1 : 0 );
+	u64                    base   = oldest ? oldest->aStart : 0;
+	bool                   first  = true;
+
+	fputs( "{\"traceEvents\":[\n", fp );
+
+	for ( u32 thread = 0; thread < Prof_GetThreadCount(); thread++ )
+	{
+		fprintf( fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread );
+		Prof_WriteJsonString( fp, Prof_GetThreadName( thread ) );
+		fputs( "}}", fp );
+		first = false;
+	}
+
+	// oldest first
+	for ( u32 i = g_prof_frame_count; i-- > 0; )
+	{
+		const ch_prof_frame_t* frame = Prof_GetFrame( i );
+
+		for ( const ch_prof_event_t& event : frame->aEvents )
+		{
+			fprintf( fp, "%s{\"name\":", first ? "" : ",\n" );
+			Prof_WriteJsonString( fp, Prof_GetLocationName( event.apLocation ) );
+			fprintf( fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"file\":",
+			         event.aThread, ( event.aStart - base ) / 1000.0, ( event.aEnd - event.aStart ) / 1000.0 );
+			Prof_WriteJsonString( fp, event.apLocation->apFile );
+			fprintf( fp, ",\"line\":%u}}", event.apLocation->aLine );
+			first = false;
+		}
+	}
+
+	fputs( "\n]}\n", fp );
+	fclose( fp );
+
+	return true;
+}
+
+
+bool Prof_ExportCSV( const char* spPath )
+{
+	FILE* fp = fopen( spPath, "wb" );
+
+	if ( !fp )
+	{
+		Log_ErrorF( gLC_Profiler, "Failed to open \"%s\" to write profiler stats to\n", spPath );
+		return false;
+	}
+
+	std::vector< ch_prof_stats_t > stats;
+	Prof_GetStats( stats );
+
+	fputs( "name,function,file,line,frames,calls,last_ms,min_ms,avg_ms,max_ms,p99_ms\n", fp );
+
+	for ( const ch_prof_stats_t& scope : stats )
+	{
+		Prof_WriteCSVString( fp, Prof_GetLocationName( scope.apLocation ) );
+		Prof_WriteCSVString( fp, scope.apLocation->apFunc );
+		Prof_WriteCSVString( fp, scope.apLocation->apFile );
+
+		fprintf( fp, "%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", scope.apLocation->aLine, scope.aFrames, scope.aCalls, scope.aLast, scope.aMin, scope.aAvg, scope.aMax, scope.aP99 );
+	}
+
+	fclose( fp );
+	return true;
+}
+
+
+// ----------------------------------------------------------------------------------------
+// ConCommands
+
+
+CONCMD_VA( prof_start, "Start recording with the built in profiler" )
+{
+#if !CH_PROFILER
+	Log_Warn( gLC_Profiler, "The built in profiler isn't compiled in, nothing will be recorded\n" );
+#endif
+
+	Prof_Start();
+}
+
+
+CONCMD_VA( prof_stop, "Stop recording with the built in profiler, the recorded frames are kept" )
+{
+	Prof_Stop();
+}
+
+
+CONCMD_VA( prof_export_trace, "Save the recorded frames as a Chrome trace - prof_export_trace <file.json>" )
+{
+	if ( args.empty() )
+	{
+		Log_Msg( gLC_Profiler, "prof_export_trace <file.json>\n" );
+		return;
+	}
+
+	if ( Prof_ExportTrace( args[ 0 ].c_str() ) )
+		Log_MsgF( gLC_Profiler, "Saved %u frames to \"%s\"\n", g_prof_frame_count, args[ 0 ].c_str() );
+}
+
+
+CONCMD_VA( prof_export_csv, "Save the min/avg/max/p99 of every scope - prof_export_csv <file.csv>" )
+{
+	if ( args.empty() )
+	{
+		Log_Msg( gLC_Profiler, "prof_export_csv <file.csv>\n" );
+		return;
+	}
+
+	if ( Prof_ExportCSV( args[ 0 ].c_str() ) )
+		Log_MsgF( gLC_Profiler, "Saved profiler stats to \"%s\"\n", args[ 0 ].c_str() );
+}
+
+
+CONCMD_VA( prof_stats, "Print the slowest scopes by average time - prof_stats [count]" )
+{
+	u32                            count = args.size() ? std::max( atoi( args[ 0 ].c_str() ), 1 ) : 20;
+
+	std::vector< ch_prof_stats_t > stats;
+	Prof_GetStats( stats );
+
+	std::sort( stats.begin(), stats.end(), []( const ch_prof_stats_t& left, const ch_prof_stats_t& right ) {
+		return left.aAvg > right.aAvg;
+	} );
+
+	log_t group = Log_GroupBegin( gLC_Profiler );
+
+	Log_GroupF( group, "%-40s %8s %8s %8s %8s %8s\n", "Scope", "Calls", "Min", "Avg", "Max", "P99" );
+
+	for ( u32 i = 0; i < count && i < stats.size(); i++ )
+	{
+		const ch_prof_stats_t& scope = stats[ i ];
+		Log_GroupF( group, "%-40.40s %8u %8.3f %8.3f %8.3f %8.3f\n", Prof_GetLocationName( scope.apLocation ), scope.aCalls, scope.aMin, scope.aAvg, scope.aMax, scope.aP99 );
+	}
+
+	Log_GroupEnd( group );
+}
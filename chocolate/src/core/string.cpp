@@ -3,6 +3,8 @@
 #include "core/util.h"
 
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 
 
 // these defines are used to add file, line, and function arguments to the string functions
@@ -44,15 +46,44 @@ struct ch_string_track_data
 using ch_string_track_map = std::map< char*, ch_string_track_data >;
 
 
+// Only record 1 in every N allocations, set with ch_str_track_sample
+// Every allocation and free is still counted, so the totals stay exact, only the per string info is sampled
+// Once this has been above 1, we can't tell a bad free apart from a string that wasn't sampled, so those stop warning
+static std::atomic< u32 >  g_str_track_sample_rate = 1;
+static std::atomic< bool > g_str_track_sampled     = false;
+static std::atomic< u64 >  g_str_track_counter     = 0;
+
+static std::atomic< u64 >  g_str_track_alloc_total = 0;
+static std::atomic< u64 >  g_str_track_free_total  = 0;
+
+
 ch_string_track_map& str_track_get()
 {
 	static ch_string_track_map trackedStrings;
 	return trackedStrings;
 }
 
-static void str_track_alloc( const char* file, u32 line, const char* func, const char* string, size_t len )
+// strings are allocated from multiple threads, like the logging thread
+std::recursive_mutex& str_track_mutex()
 {
-	PROF_SCOPE();
+	static std::recursive_mutex mutex;
+	return mutex;
+}
+
+static bool str_track_should_sample()
+{
+	u32 rate = g_str_track_sample_rate.load( std::memory_order_relaxed );
+
+	if ( rate <= 1 )
+		return true;
+
+	return g_str_track_counter.fetch_add( 1, std::memory_order_relaxed ) % rate == 0;
+}
+
+
+static void str_track_record( const char* file, u32 line, const char* func, const char* string, size_t len )
+{
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
 
 	ch_string_track_data& data = str_track_get()[ (char*)string ];
 	data.file                  = file;
@@ -62,25 +93,46 @@ static void str_track_alloc( const char* file, u32 line, const char* func, const
 }
 
 
+static void str_track_alloc( const char* file, u32 line, const char* func, const char* string, size_t len )
+{
+	PROF_SCOPE();
+
+	g_str_track_alloc_total.fetch_add( 1, std::memory_order_relaxed );
+
+	if ( str_track_should_sample() )
+		str_track_record( file, line, func, string, len );
+}
+
+
 static void str_track_realloc( const char* file, u32 line, const char* func, char* data, size_t len, char* oldPtr )
 {
 	PROF_SCOPE();
 
-	if ( oldPtr && oldPtr != data )
+	if ( !oldPtr )
 	{
-		auto it = str_track_get().find( oldPtr );
+		str_track_alloc( file, line, func, data, len );
+		return;
+	}
 
-		if ( it != str_track_get().end() )
-		{
-			str_track_get().erase( it );
-		}
-		else
-		{
-			print( "Failed to find old string pointer in tracking data!\n" );
-		}
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
+
+	// a resized string keeps whether it was sampled or not
+	auto it = str_track_get().find( oldPtr );
+
+	if ( it != str_track_get().end() )
+	{
+		str_track_get().erase( it );
+	}
+	else if ( g_str_track_sampled )
+	{
+		return;
+	}
+	else if ( oldPtr != data )
+	{
+		print( "Failed to find old string pointer in tracking data!\n" );
 	}
 
-	str_track_alloc( file, line, func, data, len );
+	str_track_record( file, line, func, data, len );
 }
 
 
@@ -94,22 +146,27 @@ static void str_track_free( const char* string )
 		return;
 	}
 
-	if ( str_track_get().empty() )
+	g_str_track_free_total.fetch_add( 1, std::memory_order_relaxed );
+
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
+
+	auto it = str_track_get().find( (char*)string );
+
+	if ( it != str_track_get().end() )
+	{
+		str_track_get().erase( it );
+	}
+	else if ( g_str_track_sampled )
+	{
+		// most likely a string that wasn't sampled
+	}
+	else if ( str_track_get().empty() )
 	{
 		print( "No strings tracked to free!\n" );
 	}
 	else
 	{
-		auto it = str_track_get().find( (char*)string );
-
-		if ( it != str_track_get().end() )
-		{
-			str_track_get().erase( it );
-		}
-		else
-		{
-			print( "Failed to find string pointer in tracking data to erase!\n" );
-		}
+		print( "Failed to find string pointer in tracking data to erase!\n" );
 	}
 }
 
@@ -442,6 +499,33 @@ ch_string ch_str_copy_v( STR_FILE_LINE_DEF const char* format, va_list args )
 }
 
 
+ch_string ch_str_fmt_into_v( char* buffer, size_t bufferSize, const char* format, va_list args )
+{
+	if ( !buffer || bufferSize == 0 )
+		return {};
+
+	int len = std::vsnprintf( buffer, bufferSize, format, args );
+
+	if ( len < 0 )
+	{
+		buffer[ 0 ] = '\0';
+		return ch_string( buffer, 0 );
+	}
+
+	return ch_string( buffer, std::min( (size_t)len, bufferSize - 1 ) );
+}
+
+
+ch_string ch_str_fmt_into( char* buffer, size_t bufferSize, const char* format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	ch_string out = ch_str_fmt_into_v( buffer, bufferSize, format, args );
+	va_end( args );
+	return out;
+}
+
+
 // --------------------------------------------------------------------------
 // String Concatenation
 // TODO: there's a lot of duplicated code here, need to refactor
@@ -1387,6 +1471,7 @@ void ch_str_remove( const char* string )
 size_t ch_str_get_alloc_count()
 {
 #if CH_STRING_MEM_TRACKING
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
 	return (size_t)str_track_get().size();
 #else
 	return 0;
@@ -1397,6 +1482,8 @@ size_t ch_str_get_alloc_count()
 size_t ch_str_get_alloc_size()
 {
 #if CH_STRING_MEM_TRACKING
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
+
 	size_t size = 0;
 
 	for ( auto& [ ptr, track_data ] : str_track_get() )
@@ -1414,6 +1501,8 @@ size_t ch_str_get_alloc_size()
 void ch_str_free_all()
 {
 #if CH_STRING_MEM_TRACKING
+	std::lock_guard< std::recursive_mutex > lock( str_track_mutex() );
+
 	ch_string_track_map& strings = str_track_get();
 	u32                  size    = strings.size();
 
@@ -2214,13 +2303,132 @@ size_t ch_str_contains( const char* s, const char* find, size_t findLen )
 // http://www.cse.yorku.ca/~oz/hash.html
 u64 ch_str_hash( const char* str, size_t len )
 {
-	u64 hash = 5381;
-	int           c;
+	return ch_hash_fnv1a_64( str, len );
+}
+
+
+// ----------------------------------------------------------------------------------------
+// String Interning
+// ----------------------------------------------------------------------------------------
+
 
-	while ( c = *str++ )
-		hash = ( ( hash << 5 ) + hash ) + c; /* hash * 33 + c */
+constexpr size_t CH_STR_INTERN_BLOCK_SIZE = 16384;
 
-	return hash;
+
+struct ch_str_intern_table_t
+{
+	std::shared_mutex                          mutex;
+	std::unordered_map< ch_str_id, ch_string > strings;
+
+	// strings are packed into blocks, so they never move and are never freed
+	std::vector< char* >                       blocks;
+	char*                                      block      = nullptr;
+	size_t                                     block_used = 0;
+};
+
+
+static ch_str_intern_table_t& str_intern_table()
+{
+	static ch_str_intern_table_t table;
+	return table;
+}
+
+
+static char* str_intern_alloc( ch_str_intern_table_t& table, size_t size )
+{
+	// big strings get their own block
+	if ( size > CH_STR_INTERN_BLOCK_SIZE / 4 )
+	{
+		char* data = ch_malloc< char >( size );
+		table.blocks.push_back( data );
+		return data;
+	}
+
+	if ( !table.block || table.block_used + size > CH_STR_INTERN_BLOCK_SIZE )
+	{
+		table.block      = ch_malloc< char >( CH_STR_INTERN_BLOCK_SIZE );
+		table.block_used = 0;
+		table.blocks.push_back( table.block );
+	}
+
+	char* data = table.block + table.block_used;
+	table.block_used += size;
+	return data;
+}
+
+
+ch_str_id ch_str_intern( const char* str, size_t len )
+{
+	if ( !str )
+		return CH_STR_ID_INVALID;
+
+	ch_str_id              id    = (ch_str_id)ch_hash_fnv1a_32( str, len );
+	ch_str_intern_table_t& table = str_intern_table();
+
+	{
+		std::shared_lock lock( table.mutex );
+
+		auto             it = table.strings.find( id );
+		if ( it != table.strings.end() )
+		{
+			if ( ch_str_equals( it->second, str, len ) )
+				return id;
+
+			Log_ErrorF( "String Intern Hash Collision: \"%.*s\" and \"%s\"\n", (int)len, str, it->second.data );
+			return CH_STR_ID_INVALID;
+		}
+	}
+
+	if ( id == CH_STR_ID_INVALID )
+	{
+		Log_ErrorF( "Can't intern string, it's hash is the invalid id: \"%.*s\"\n", (int)len, str );
+		return CH_STR_ID_INVALID;
+	}
+
+	std::unique_lock lock( table.mutex );
+
+	// another thread may have added it while we were unlocked
+	auto             it = table.strings.find( id );
+	if ( it != table.strings.end() )
+		return ch_str_equals( it->second, str, len ) ? id : CH_STR_ID_INVALID;
+
+	char* data = str_intern_alloc( table, len + 1 );
+	memcpy( data, str, len );
+	data[ len ]          = '\0';
+
+	table.strings[ id ] = ch_string( data, len );
+	return id;
+}
+
+
+ch_str_id ch_str_intern( const char* str )
+{
+	if ( !str )
+		return CH_STR_ID_INVALID;
+
+	return ch_str_intern( str, strlen( str ) );
+}
+
+
+ch_string ch_str_intern_get( ch_str_id id )
+{
+	ch_str_intern_table_t& table = str_intern_table();
+	std::shared_lock       lock( table.mutex );
+
+	auto                   it = table.strings.find( id );
+	if ( it == table.strings.end() )
+		return {};
+
+	return it->second;
+}
+
+
+u32 ch_str_intern_count()
+{
+	ch_str_intern_table_t& table = str_intern_table();
+	std::shared_lock       lock( table.mutex );
+
+	return table.strings.size();
 }
 
 
@@ -2232,7 +2440,19 @@ u64 ch_str_hash( const char* str, size_t len )
 CONCMD( ch_dump_string_allocations )
 {
 #if CH_STRING_MEM_TRACKING
-	u32 size = str_track_get().size();
+	// copy it, logging allocates strings on the logging thread
+	str_track_mutex().lock();
+	ch_string_track_map trackedStrings = str_track_get();
+	str_track_mutex().unlock();
+
+	u32 size = trackedStrings.size();
+
+	if ( g_str_track_sampled )
+	{
+		u64 allocs = g_str_track_alloc_total.load();
+		u64 frees  = g_str_track_free_total.load();
+		Log_MsgF( "Sampling 1 in %u allocations - %llu allocated, %llu freed, %lld alive\n", g_str_track_sample_rate.load(), allocs, frees, (s64)( allocs - frees ) );
+	}
 
 	if ( size == 0 )
 	{
@@ -2241,8 +2461,6 @@ CONCMD( ch_dump_string_allocations )
 		return;
 	}
 
-	ch_string_track_map& trackedStrings = str_track_get();
-
 	// hopefully this should never hit SIZE_MAX
 	// how would you even allocate that much memory?
 	size_t                  totalSize      = 0;
@@ -2263,7 +2481,12 @@ CONCMD( ch_dump_string_allocations )
 CONCMD( ch_dump_string_allocations_extended )
 {
 #if CH_STRING_MEM_TRACKING
-	u32 size = str_track_get().size();
+	// copy it, logging allocates strings on the logging thread
+	str_track_mutex().lock();
+	ch_string_track_map trackedStrings = str_track_get();
+	str_track_mutex().unlock();
+
+	u32 size = trackedStrings.size();
 
 	if ( size == 0 )
 	{
@@ -2274,8 +2497,6 @@ CONCMD( ch_dump_string_allocations_extended )
 
 	Log_MsgF( "Dumping %d string allocations:\n\n", size );
 
-	ch_string_track_map& trackedStrings = str_track_get();
-
 	// hopefully this should never hit SIZE_MAX
 	// how would you even allocate that much memory?
 	size_t                  totalSize      = 0;
@@ -2293,6 +2514,30 @@ CONCMD( ch_dump_string_allocations_extended )
 
 	Log_MsgF( "\nDumped %d string allocations\n", size );
 	Log_MsgF( "Total string memory: %.6f KB\n", ch_bytes_to_kb( totalSize ) );
+
+	if ( g_str_track_sampled )
+		Log_MsgF( "Only 1 in %u allocations were recorded\n", g_str_track_sample_rate.load() );
+#else
+	Log_Msg( "String allocation tracking is disabled!\n" );
+#endif
+}
+
+
+CONCMD_VA( ch_str_track_sample, "Only record 1 in every N string allocations, the tracker gets slow with a lot of strings - ch_str_track_sample <N>" )
+{
+#if CH_STRING_MEM_TRACKING
+	if ( args.empty() )
+	{
+		Log_MsgF( "Recording 1 in %u string allocations\n", g_str_track_sample_rate.load() );
+		return;
+	}
+
+	u32 rate = std::max( atoi( args[ 0 ].c_str() ), 1 );
+
+	if ( rate > 1 )
+		g_str_track_sampled = true;
+
+	g_str_track_sample_rate = rate;
 #else
 	Log_Msg( "String allocation tracking is disabled!\n" );
 #endif
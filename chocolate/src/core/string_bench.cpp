@@ -0,0 +1,134 @@
+#include "core/core.h"
+
+#include <chrono>
+
+
+// Microbenchmarks for core/string.h
+// Run this in a release build for real numbers, in debug every allocation goes through the string tracker
+// The strings used are around the size of the paths and log messages the engine makes the most of
+
+
+LOG_CHANNEL_REGISTER( StringBench, ELogColor_DarkCyan );
+
+
+struct str_bench_result_t
+{
+	const char* name;
+	double      time;
+};
+
+
+template< typename Func >
+static double str_bench_run( u32 sIterations, Func sFunc )
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	for ( u32 i = 0; i < sIterations; i++ )
+		sFunc( i );
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration< double, std::nano >( endTime - startTime ).count() / sIterations;
+}
+
+
+CONCMD_VA( ch_str_bench, "Benchmark the string functions - ch_str_bench [iterations]" )
+{
+	u32                               iterations = args.size() ? std::max( atoi( args[ 0 ].c_str() ), 1 ) : 100000;
+
+	const char                        dir[]      = "materials/models/props";
+	const char                        file[]     = "wooden_crate_01.cmt";
+	const char*                       parts[]    = { dir, CH_PATH_SEP_STR, file };
+	const size_t                      lengths[]  = { sizeof( dir ) - 1, 1, sizeof( file ) - 1 };
+
+	std::vector< str_bench_result_t > results;
+
+	// keeps the compiler from throwing out the work
+	u64                               checksum = 0;
+
+	// ----------------------------------------------------------------
+	// Allocating
+
+	results.push_back( { "ch_str_copy + free", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string str = ch_str_copy( file, lengths[ 2 ] );
+		checksum += str.size;
+		ch_str_free( str.data );
+	} ) } );
+
+	results.push_back( { "ch_str_join + free", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string str = ch_str_join( 3, parts, lengths );
+		checksum += str.size;
+		ch_str_free( str.data );
+	} ) } );
+
+	results.push_back( { "ch_str_concat + free", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string str = ch_str_copy( dir, lengths[ 0 ] );
+		str           = ch_str_concat( str.data, str.size, file, lengths[ 2 ] );
+		checksum += str.size;
+		ch_str_free( str.data );
+	} ) } );
+
+	results.push_back( { "ch_str_copy_f + free", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string str = ch_str_copy_f( "%s/%s %u", dir, file, i );
+		checksum += str.size;
+		ch_str_free( str.data );
+	} ) } );
+
+	// ----------------------------------------------------------------
+	// Not allocating
+
+	results.push_back( { "ch_str_fmt_into", str_bench_run( iterations, [ & ]( u32 i ) {
+		char      buf[ 256 ];
+		ch_string str = ch_str_fmt_into( buf, "%s/%s %u", dir, file, i );
+		checksum += str.size;
+	} ) } );
+
+	results.push_back( { "ch_string_small append", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string_small<> str;
+		for ( u32 part = 0; part < 3; part++ )
+			str.append( parts[ part ], lengths[ part ] );
+
+		checksum += str.size;
+	} ) } );
+
+	results.push_back( { "ch_string_small append_f", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string_small<> str;
+		str.append_f( "%s/%s %u", dir, file, i );
+		checksum += str.size;
+	} ) } );
+
+	// past the inline buffer, so this is the heap fallback
+	results.push_back( { "ch_string_small<16> append", str_bench_run( iterations, [ & ]( u32 i ) {
+		ch_string_small< 16 > str;
+		for ( u32 part = 0; part < 3; part++ )
+			str.append( parts[ part ], lengths[ part ] );
+
+		checksum += str.size;
+	} ) } );
+
+	// ----------------------------------------------------------------
+	// Comparing and hashing
+
+	results.push_back( { "ch_str_equals", str_bench_run( iterations, [ & ]( u32 i ) {
+		checksum += ch_str_equals( parts[ i % 3 ], lengths[ i % 3 ], file, lengths[ 2 ] );
+	} ) } );
+
+	results.push_back( { "ch_str_hash", str_bench_run( iterations, [ & ]( u32 i ) {
+		checksum += ch_str_hash( parts[ i % 3 ], lengths[ i % 3 ] );
+	} ) } );
+
+	results.push_back( { "ch_str_intern (existing)", str_bench_run( iterations, [ & ]( u32 i ) {
+		checksum += ch_str_intern( parts[ i % 3 ], lengths[ i % 3 ] );
+	} ) } );
+
+	log_t group = Log_GroupBegin( gLC_StringBench );
+
+	Log_GroupF( group, "String Benchmark - %u iterations%s\n", iterations, CH_STRING_MEM_TRACKING ? " (string tracking enabled)" : "" );
+
+	for ( const str_bench_result_t& result : results )
+		Log_GroupF( group, "    %-28s %8.1f ns\n", result.name, result.time );
+
+	Log_GroupEnd( group );
+
+	Log_DevF( gLC_StringBench, 2, "ch_str_bench checksum %llu\n", checksum );
+}
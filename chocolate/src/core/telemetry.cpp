@@ -0,0 +1,335 @@
+#include "core/telemetry.h"
+#include "core/console.h"
+#include "core/log.h"
+#include "core/string.h"
+#include "core/util.h"
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <time.h>
+
+
+LOG_CHANNEL_REGISTER( Telemetry, ELogColor_DarkCyan );
+
+
+constexpr u32   CH_TELEMETRY_MAX         = 32;
+constexpr u32   CH_TELEMETRY_NAME        = 32;
+
+// histogram buckets are spaced out logarithmically between these, in milliseconds, so each one is about 6% wider than the last
+// anything under the min goes in the first bucket, anything over the max goes in the last one
+constexpr u32   CH_TELEMETRY_BUCKETS     = 200;
+constexpr float CH_TELEMETRY_BUCKET_MIN  = 0.01f;
+constexpr float CH_TELEMETRY_BUCKET_MAX  = 1000.f;
+
+// don't warn about the same subsystem going over budget more often than this, in seconds
+constexpr float CH_TELEMETRY_WARN_RATE   = 5.f;
+
+#define TELEMETRY_LOG_FILENAME "telemetry.log"
+
+
+struct ch_telemetry_t
+{
+	char                aName[ CH_TELEMETRY_NAME ];
+	const float*        apBudget;
+
+	// this frame, added to from any thread
+	std::atomic< u64 >  aFrameTime;  // nanoseconds
+	std::atomic< u32 >  aFrameCalls;
+
+	// this summary period
+	u32                 aHistogram[ CH_TELEMETRY_BUCKETS ];
+	u32                 aFrames;
+	u32                 aOverruns;
+	double              aTotal;
+	float               aMin;
+	float               aMax;
+
+	double              aLastWarn;
+};
+
+
+// these are all zero initialized before any static constructors run, subsystems are registered during static initialization
+static std::mutex       g_telemetry_mutex;
+static ch_telemetry_t   g_telemetry[ CH_TELEMETRY_MAX ];
+static u32              g_telemetry_count = 0;
+
+static double           g_telemetry_time        = 0.0;  // total time, for rate limiting warnings
+static double           g_telemetry_period_time = 0.0;
+static u32              g_telemetry_period_frames = 0;
+
+
+CONVAR_FLOAT_NAME( telemetry_summary_interval, "telemetry.summary.interval", 60.f, "How often to write a summary of frame timings to " TELEMETRY_LOG_FILENAME " in seconds, 0 to never write one" );
+CONVAR_INT_NAME( telemetry_log_size, "telemetry.log.size", 1024, "Max size of " TELEMETRY_LOG_FILENAME " in KB before it's rotated" );
+CONVAR_INT_NAME( telemetry_log_count, "telemetry.log.count", 4, "How many old telemetry logs are kept when rotating, " TELEMETRY_LOG_FILENAME ".1 is the newest" );
+CONVAR_BOOL_NAME( telemetry_warn, "telemetry.warn", true, "Print a warning when a subsystem goes over its budget" );
+
+
+static float Telemetry_GetBucketRatio()
+{
+	static float ratio = std::log( CH_TELEMETRY_BUCKET_MAX / CH_TELEMETRY_BUCKET_MIN ) / ( CH_TELEMETRY_BUCKETS - 2 );
+	return ratio;
+}
+
+
+static u32 Telemetry_GetBucket( float sMilliseconds )
+{
+	if ( sMilliseconds <= CH_TELEMETRY_BUCKET_MIN )
+		return 0;
+
+	u32 bucket = 1 + (u32)( std::log( sMilliseconds / CH_TELEMETRY_BUCKET_MIN ) / Telemetry_GetBucketRatio() );
+	return std::min( bucket, CH_TELEMETRY_BUCKETS - 1 );
+}
+
+
+// the middle of a bucket, in milliseconds
+static float Telemetry_GetBucketValue( u32 sBucket )
+{
+	if ( sBucket == 0 )
+		return CH_TELEMETRY_BUCKET_MIN;
+
+	return CH_TELEMETRY_BUCKET_MIN * std::exp( ( sBucket - 0.5f ) * Telemetry_GetBucketRatio() );
+}
+
+
+static float Telemetry_GetPercentile( const ch_telemetry_t& srTelemetry, float sPercent )
+{
+	if ( srTelemetry.aFrames == 0 )
+		return 0.f;
+
+	u32 target = (u32)std::ceil( srTelemetry.aFrames * sPercent );
+	u32 count  = 0;
+
+	for ( u32 i = 0; i < CH_TELEMETRY_BUCKETS; i++ )
+	{
+		count += srTelemetry.aHistogram[ i ];
+
+		// the bucket is an estimate, but it can't be outside what was actually recorded
+		if ( count >= target )
+			return std::clamp( Telemetry_GetBucketValue( i ), srTelemetry.aMin, srTelemetry.aMax );
+	}
+
+	return srTelemetry.aMax;
+}
+
+
+ch_telemetry_h Telemetry_Register( const char* spName, float sBudget )
+{
+	if ( !spName || !*spName )
+		return CH_INVALID_TELEMETRY;
+
+	std::lock_guard< std::mutex > lock( g_telemetry_mutex );
+
+	for ( u32 i = 0; i < g_telemetry_count; i++ )
+	{
+		if ( ch_strcasecmp( g_telemetry[ i ].aName, spName ) == 0 )
+			return i;
+	}
+
+	if ( g_telemetry_count == CH_TELEMETRY_MAX )
+	{
+		Log_ErrorF( gLC_Telemetry, "Too many telemetry subsystems, can't add \"%s\"\n", spName );
+		return CH_INVALID_TELEMETRY;
+	}
+
+	ch_telemetry_t& telemetry = g_telemetry[ g_telemetry_count ];
+	snprintf( telemetry.aName, CH_TELEMETRY_NAME, "%s", spName );
+
+	char convarName[ 64 ];
+	snprintf( convarName, sizeof( convarName ), "telemetry.budget.%s", spName );
+
+	for ( char* c = convarName; *c; c++ )
+		*c = tolower( *c );
+
+	telemetry.apBudget  = &Con_Register_Float( convarName, sBudget, CVARF_ARCHIVE, "Budget for this subsystem in milliseconds, frames that go over it are counted, 0 for no budget" );
+	telemetry.aMin      = FLT_MAX;
+	telemetry.aLastWarn = -CH_TELEMETRY_WARN_RATE;
+
+	return g_telemetry_count++;
+}
+
+
+void Telemetry_Add( ch_telemetry_h sHandle, float sMilliseconds )
+{
+	if ( sHandle >= g_telemetry_count )
+		return;
+
+	g_telemetry[ sHandle ].aFrameTime.fetch_add( (u64)( sMilliseconds * 1000000.0 ), std::memory_order_relaxed );
+	g_telemetry[ sHandle ].aFrameCalls.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+static void Telemetry_Record( ch_telemetry_t& srTelemetry, float sMilliseconds )
+{
+	srTelemetry.aHistogram[ Telemetry_GetBucket( sMilliseconds ) ]++;
+	srTelemetry.aFrames++;
+	srTelemetry.aTotal += sMilliseconds;
+	srTelemetry.aMin = std::min( srTelemetry.aMin, sMilliseconds );
+	srTelemetry.aMax = std::max( srTelemetry.aMax, sMilliseconds );
+
+	float budget = srTelemetry.apBudget ? *srTelemetry.apBudget : 0.f;
+
+	if ( budget <= 0.f || sMilliseconds <= budget )
+		return;
+
+	srTelemetry.aOverruns++;
+
+	if ( !telemetry_warn || g_telemetry_time - srTelemetry.aLastWarn < CH_TELEMETRY_WARN_RATE )
+		return;
+
+	srTelemetry.aLastWarn = g_telemetry_time;
+	Log_WarnF( gLC_Telemetry, "%s went over its budget: %.2f ms / %.2f ms\n", srTelemetry.aName, sMilliseconds, budget );
+}
+
+
+void Telemetry_EndFrame( float sFrameTime )
+{
+	// registered here instead of with the macro, so the budget convar can be archived, CVARF_ARCHIVE might not be set up yet during static init in core
+	static ch_telemetry_h frameTelemetry = Telemetry_Register( "Frame", 0.f );
+
+	g_telemetry_time += sFrameTime;
+	g_telemetry_period_time += sFrameTime;
+	g_telemetry_period_frames++;
+
+	if ( frameTelemetry != CH_INVALID_TELEMETRY )
+		Telemetry_Add( frameTelemetry, sFrameTime * 1000.f );
+
+	for ( u32 i = 0; i < g_telemetry_count; i++ )
+	{
+		ch_telemetry_t& telemetry = g_telemetry[ i ];
+
+		// didn't run this frame, a subsystem that only runs sometimes shouldn't pull its p50 down to 0
+		if ( telemetry.aFrameCalls.exchange( 0, std::memory_order_relaxed ) == 0 )
+			continue;
+
+		Telemetry_Record( telemetry, telemetry.aFrameTime.exchange( 0, std::memory_order_relaxed ) / 1000000.f );
+	}
+
+	if ( telemetry_summary_interval > 0.f && g_telemetry_period_time >= telemetry_summary_interval )
+		Telemetry_WriteSummary();
+}
+
+
+// ----------------------------------------------------------------------------------------
+// Summaries
+
+
+static void Telemetry_BuildSummary( ch_string_small< 4096 >& srOutput )
+{
+	char       timeStr[ 64 ];
+	time_t     now = time( nullptr );
+	strftime( timeStr, sizeof( timeStr ), "%Y-%m-%d %H:%M:%S", localtime( &now ) );
+
+	srOutput.append_f( "[%s] %u frames over %.1f seconds\n", timeStr, g_telemetry_period_frames, g_telemetry_period_time );
+	srOutput.append_f( "    %-16s %8s %8s %8s %8s %8s %8s %8s\n", "Subsystem", "Frames", "Avg", "P50", "P99", "Max", "Budget", "Over" );
+
+	for ( u32 i = 0; i < g_telemetry_count; i++ )
+	{
+		const ch_telemetry_t& telemetry = g_telemetry[ i ];
+
+		if ( telemetry.aFrames == 0 )
+			continue;
+
+		srOutput.append_f( "    %-16s %8u %8.3f %8.3f %8.3f %8.3f %8.2f %8u\n",
+		                   telemetry.aName,
+		                   telemetry.aFrames,
+		                   telemetry.aTotal / telemetry.aFrames,
+		                   Telemetry_GetPercentile( telemetry, 0.5f ),
+		                   Telemetry_GetPercentile( telemetry, 0.99f ),
+		                   telemetry.aMax,
+		                   telemetry.apBudget ? *telemetry.apBudget : 0.f,
+		                   telemetry.aOverruns );
+	}
+}
+
+
+static void Telemetry_ResetPeriod()
+{
+	for ( u32 i = 0; i < g_telemetry_count; i++ )
+	{
+		ch_telemetry_t& telemetry = g_telemetry[ i ];
+		memset( telemetry.aHistogram, 0, sizeof( telemetry.aHistogram ) );
+		telemetry.aFrames   = 0;
+		telemetry.aOverruns = 0;
+		telemetry.aTotal    = 0.0;
+		telemetry.aMin      = FLT_MAX;
+		telemetry.aMax      = 0.f;
+	}
+
+	g_telemetry_period_time   = 0.0;
+	g_telemetry_period_frames = 0;
+}
+
+
+// telemetry.log -> telemetry.log.1 -> telemetry.log.2, and the oldest one is deleted
+static void Telemetry_RotateLogs()
+{
+	char oldName[ 64 ];
+	char newName[ 64 ];
+
+	for ( int i = telemetry_log_count; i > 0; i-- )
+	{
+		snprintf( newName, sizeof( newName ), TELEMETRY_LOG_FILENAME ".%d", i );
+
+		if ( i == 1 )
+			snprintf( oldName, sizeof( oldName ), TELEMETRY_LOG_FILENAME );
+		else
+			snprintf( oldName, sizeof( oldName ), TELEMETRY_LOG_FILENAME ".%d", i - 1 );
+
+		remove( newName );
+		rename( oldName, newName );
+	}
+
+	if ( telemetry_log_count <= 0 )
+		remove( TELEMETRY_LOG_FILENAME );
+}
+
+
+void Telemetry_WriteSummary()
+{
+	if ( g_telemetry_period_frames == 0 )
+		return;
+
+	ch_string_small< 4096 > summary;
+	Telemetry_BuildSummary( summary );
+	Telemetry_ResetPeriod();
+
+	FILE* fp = fopen( TELEMETRY_LOG_FILENAME, "ab" );
+
+	if ( fp )
+	{
+		fseek( fp, 0, SEEK_END );
+
+		if ( ftell( fp ) + (long)summary.size > telemetry_log_size * 1024l )
+		{
+			fclose( fp );
+			Telemetry_RotateLogs();
+			fp = fopen( TELEMETRY_LOG_FILENAME, "ab" );
+		}
+	}
+
+	if ( !fp )
+	{
+		Log_ErrorF( gLC_Telemetry, "Failed to open \"%s\" to write a summary to\n", TELEMETRY_LOG_FILENAME );
+		return;
+	}
+
+	fwrite( summary.data, 1, summary.size, fp );
+	fclose( fp );
+
+	Log_DevF( gLC_Telemetry, 1, "%s", summary.data );
+}
+
+
+CONCMD_VA( telemetry_print, "Print frame timings since the last summary" )
+{
+	ch_string_small< 4096 > summary;
+	Telemetry_BuildSummary( summary );
+	Log_Msg( gLC_Telemetry, summary.data );
+}
+
+
+CONCMD_VA( telemetry_write, "Write a summary to " TELEMETRY_LOG_FILENAME " now and start a new one" )
+{
+	Telemetry_WriteSummary();
+}
@@ -51,9 +51,30 @@ static ResourceList< VkDescriptorSet >                              gDescSets;
 extern ResourceList< TextureVK* >                                   gTextureHandles;
 extern ResourceList< BufferVK >                                     gBufferHandles;
 
+// bitmask of the bindings created with aUpdateAfterBind, bindings past 63 always wait on the graphics queue to update
+static std::unordered_map< VkDescriptorSetLayout, u64 >             gDescLayoutUpdateAfterBind;
+static std::unordered_map< VkDescriptorSet, u64 >                   gDescSetUpdateAfterBind;
+
 static std::vector< ch_handle_t >                                    gImageSets;
 static u32                                                          gImageBinding = 0;
 
+// frames a freed texture slot waits before it's handed out again, so no command buffer in flight still samples it
+constexpr u32                                                       CH_TEXTURE_SLOT_RETIRE_FRAMES = 4;
+
+struct RetiredTextureSlot_t
+{
+	u32 aSlot;
+	u32 aFrame;
+};
+
+// Bindless texture slots, the index into the image array stays the same for as long as the texture exists
+static ChVector< ch_handle_t >                                      gTextureSlots;  // CH_INVALID_HANDLE if the slot is free
+static ChVector< u32 >                                              gFreeTextureSlots;
+static ChVector< RetiredTextureSlot_t >                             gRetiredTextureSlots;
+static ChVector< u32 >                                              gDirtyTextureSlots;
+static u32                                                          gTextureSlotFrame = 0;
+static ChVector< ch_handle_t >                                      gMovedTextures;  // textures that lost their slot, materials using them need the new index
+
 extern Render_OnTextureIndexUpdate*                                 gpOnTextureIndexUpdateFunc;
 
 
@@ -149,80 +170,183 @@ void VK_CreateDescriptorPool()
 }
 
 
-void VK_CalcTextureIndices()
+// Gives a sampled texture a slot in the image array, reloaded textures keep the slot they already have
+void VK_AddTextureSlot( ch_handle_t sTexture, TextureVK* spTexture )
 {
-	size_t index = 0;
-	for ( uint32_t j = 0; j < gTextureHandles.size(); j++ )
+	if ( !( spTexture->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT ) )
+		return;
+
+	if ( spTexture->aIndex < 0 )
 	{
-		TextureVK* tex = VK_GetTexture( gTextureHandles.aHandles[ j ] );
+		u32 slot = 0;
 
-		if ( !tex )
-			continue;
+		if ( gFreeTextureSlots.size() )
+		{
+			slot = *gFreeTextureSlots.back();
+			gFreeTextureSlots.remove( gFreeTextureSlots.size() - 1 );
+		}
+		else
+		{
+			// hmm, this doesn't crash on Nvidia, though idk how AMD would react
+			if ( gTextureSlots.size() >= EDescriptorPoolSize_CombinedImageSamplers )
+			{
+				Log_FatalF( gLC_Render, "Over Max Sampled Textures allocated (at %u, max is %d)", gTextureSlots.size(), EDescriptorPoolSize_CombinedImageSamplers );
+				return;
+			}
 
-		// must be a sampled image
-		if ( !( tex->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT ) )
-			continue;
+			slot = gTextureSlots.size();
+			gTextureSlots.push_back( CH_INVALID_HANDLE );
+		}
 
-		tex->aIndex = index++;
+		gTextureSlots[ slot ] = sTexture;
+		spTexture->aIndex     = slot;
 	}
 
-	Log_DevF( gLC_Render, 2, "Texture Index Count: %d\n", index );
+	gDirtyTextureSlots.push_back( spTexture->aIndex );
+}
 
-	if ( gpOnTextureIndexUpdateFunc )
-		gpOnTextureIndexUpdateFunc();
+
+// The slot isn't reused until CH_TEXTURE_SLOT_RETIRE_FRAMES frames later, and the descriptor is left alone until then
+void VK_RemoveTextureSlot( TextureVK* spTexture )
+{
+	if ( spTexture->aIndex < 0 || spTexture->aIndex >= (int)gTextureSlots.size() )
+		return;
+
+	if ( gTextureSlots[ spTexture->aIndex ] != CH_INVALID_HANDLE )
+		gMovedTextures.push_back( gTextureSlots[ spTexture->aIndex ] );
+
+	gTextureSlots[ spTexture->aIndex ] = CH_INVALID_HANDLE;
+	gRetiredTextureSlots.push_back( { (u32)spTexture->aIndex, gTextureSlotFrame } );
+
+	spTexture->aIndex                  = -1;
 }
 
-#if 1
-void VK_UpdateImageSets()
+
+// Writes every texture slot again, used when the samplers are recreated
+void VK_DirtyAllTextureSlots()
+{
+	gDirtyTextureSlots.resize( gTextureSlots.size() );
+
+	for ( u32 slot = 0; slot < gTextureSlots.size(); slot++ )
+		gDirtyTextureSlots[ slot ] = slot;
+}
+
+
+// Gives a texture a new slot, used when texture streaming swaps in a new image view
+// The old slot can still be used by frames in flight, so it's retired instead of written over,
+// and retiring it makes the materials using this texture look up the new index
+void VK_MoveTextureSlot( TextureVK* spTexture )
+{
+	if ( spTexture->aIndex < 0 || spTexture->aIndex >= (int)gTextureSlots.size() )
+		return;
+
+	ch_handle_t handle = gTextureSlots[ spTexture->aIndex ];
+
+	VK_RemoveTextureSlot( spTexture );
+	VK_AddTextureSlot( handle, spTexture );
+}
+
+
+bool VK_HasDirtyTextureSlots()
 {
-	// hmm, this doesn't crash on Nvidia, though idk how AMD would react
-	if ( gGraphicsAPIData.aSampledTextures.size() >= EDescriptorPoolSize_CombinedImageSamplers )
+	return gDirtyTextureSlots.size();
+}
+
+
+// Called once a frame before recording
+void VK_UpdateTextureSlots()
+{
+	PROF_SCOPE();
+
+	gTextureSlotFrame++;
+
+	// return slots nothing in flight can be using anymore to the free list
+	u32 retired = 0;
+	for ( u32 i = 0; i < gRetiredTextureSlots.size(); i++ )
+	{
+		RetiredTextureSlot_t& slot = gRetiredTextureSlots[ i ];
+
+		if ( gTextureSlotFrame - slot.aFrame >= CH_TEXTURE_SLOT_RETIRE_FRAMES )
+			gFreeTextureSlots.push_back( slot.aSlot );
+		else
+			gRetiredTextureSlots[ retired++ ] = slot;
+	}
+
+	gRetiredTextureSlots.resize( retired );
+
+	// materials still pointing at a moved or freed texture have to switch to its new index before the old slot is handed out again
+	if ( gpOnTextureIndexUpdateFunc )
 	{
-		Log_FatalF( gLC_Render, "Over Max Sampled Textures allocated (at %zu, max is %d)", gGraphicsAPIData.aSampledTextures.size(), EDescriptorPoolSize_CombinedImageSamplers );
+		for ( ch_handle_t texture : gMovedTextures )
+			gpOnTextureIndexUpdateFunc( texture );
 	}
 
-	WriteDescSet_t write{};
-	write.aDescSetCount = gImageSets.size();
-	write.apDescSets    = gImageSets.data();
+	gMovedTextures.clear();
+
+	VK_UpdateImageSets();
+}
 
-	write.aBindingCount = 1;
-	write.apBindings    = ch_calloc< WriteDescSetBinding_t >( 1 );
 
-	ChVector< ch_handle_t > imageData;
-	imageData.reserve( gGraphicsAPIData.aSampledTextures.size() );
+// Only writes the slots that changed, grouped into contiguous ranges
+void VK_UpdateImageSets()
+{
+	// VK_SetImageSets() writes every slot when the sets are given to us
+	if ( gImageSets.empty() )
+		gDirtyTextureSlots.clear();
 
-	size_t index = 0;
-	// for ( uint32_t j = 0; j < gGraphicsAPIData.aSampledTextures.size(); j++ )
-	for ( ch_handle_t texHandle : gGraphicsAPIData.aSampledTextures )
+	if ( gDirtyTextureSlots.empty() )
+		return;
+
+	std::sort( gDirtyTextureSlots.apData, gDirtyTextureSlots.apData + gDirtyTextureSlots.size() );
+
+	ChVector< WriteDescSetBinding_t > ranges;
+	u32                               slotsWritten = 0;
+
+	for ( u32 i = 0; i < gDirtyTextureSlots.size(); i++ )
 	{
-		TextureVK* tex = VK_GetTexture( texHandle );
+		u32 slot = gDirtyTextureSlots[ i ];
 
-		if ( !tex )
+		// freed slots are left as they are, they might still be used by a command buffer in flight
+		if ( slot >= gTextureSlots.size() || gTextureSlots[ slot ] == CH_INVALID_HANDLE )
 			continue;
 
-		// must be a sampled image
-		if ( !( tex->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT ) )
+		WriteDescSetBinding_t* range = ranges.size() ? ranges.back() : nullptr;
+
+		if ( range && range->aArrayElement + range->aCount == slot )
+		{
+			range->aCount++;
+			slotsWritten++;
+			continue;
+		}
+
+		// same slot queued twice
+		if ( range && range->aArrayElement + range->aCount > slot )
 			continue;
 
-		tex->aIndex = index++;
-		imageData.push_back( texHandle );
+		WriteDescSetBinding_t& newRange = ranges.emplace_back();
+		newRange.aType                  = EDescriptorType_CombinedImageSampler;
+		newRange.aBinding               = gImageBinding;
+		newRange.aArrayElement          = slot;
+		newRange.aCount                 = 1;
+		newRange.apData                 = &gTextureSlots[ slot ];
+		slotsWritten++;
 	}
 
-	write.apBindings[ 0 ].aBinding = gImageBinding;
-	write.apBindings[ 0 ].aType    = EDescriptorType_CombinedImageSampler;
-	write.apBindings[ 0 ].aCount   = imageData.size();
-	write.apBindings[ 0 ].apData   = imageData.data();
+	gDirtyTextureSlots.clear();
 
-	VK_UpdateDescSets( &write, 1 );
+	if ( ranges.empty() )
+		return;
 
-	free( write.apBindings );
+	WriteDescSet_t write{};
+	write.aDescSetCount = gImageSets.size();
+	write.apDescSets    = gImageSets.data();
+	write.aBindingCount = ranges.size();
+	write.apBindings    = ranges.apData;
 
-	Log_Dev( gLC_Render, 1, "Updated Image Sets\n" );
+	VK_UpdateDescSets( &write, 1 );
 
-	if ( gpOnTextureIndexUpdateFunc )
-		gpOnTextureIndexUpdateFunc();
+	Log_DevF( gLC_Render, 2, "Updated %u Texture Slots in %u Ranges\n", slotsWritten, ranges.size() );
 }
-#endif
 
 
 void VK_SetImageSets( ch_handle_t* spDescSets, int sCount, u32 sBinding )
@@ -234,6 +358,9 @@ void VK_SetImageSets( ch_handle_t* spDescSets, int sCount, u32 sBinding )
 	{
 		gImageSets[ i ] = spDescSets[ i ];
 	}
+
+	// new sets need every texture written to them
+	VK_DirtyAllTextureSlots();
 }
 
 
@@ -261,6 +388,8 @@ ch_handle_t VK_CreateDescLayout( const CreateDescLayout_t& srCreate )
 	layoutBindingFlags.resize( srCreate.aBindings.size() );
 	layoutBindings.resize( srCreate.aBindings.size() );
 
+	u64 updateAfterBind = 0;
+
 	// Create the layout bindings
 	for ( size_t i = 0; i < srCreate.aBindings.size(); i++ )
 	{
@@ -277,6 +406,13 @@ ch_handle_t VK_CreateDescLayout( const CreateDescLayout_t& srCreate )
 		layoutBindings[ i ].stageFlags      = VK_ToVkShaderStage( createBinding.aStages );
 		layoutBindings[ i ].binding         = createBinding.aBinding;
 
+		// if the device can't do it, VK_UpdateDescSets() will wait on the graphics queue instead
+		if ( createBinding.aUpdateAfterBind && createBinding.aBinding < 64 && VK_SupportsUpdateAfterBind( layoutBindings[ i ].descriptorType ) )
+		{
+			layoutBindingFlags[ i ] |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+			updateAfterBind |= 1ull << createBinding.aBinding;
+		}
+
 		// Check Pool Stats for this Descriptor Type
 		DescriptorPoolTypeStats_t& typeStats = gDescriptorPoolStats.aTypes[ layoutBindings[ i ].descriptorType ];
 
@@ -301,10 +437,16 @@ ch_handle_t VK_CreateDescLayout( const CreateDescLayout_t& srCreate )
 	layoutInfo.bindingCount = static_cast< u32 >( layoutBindings.size() );
 	layoutInfo.pBindings    = layoutBindings.data();
 
+	if ( updateAfterBind )
+		layoutInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+
 	VkDescriptorSetLayout layout;
 
 	VK_CheckResult( vkCreateDescriptorSetLayout( VK_GetDevice(), &layoutInfo, NULL, &layout ), "Failed to create descriptor set layout!" );
 
+	if ( updateAfterBind )
+		gDescLayoutUpdateAfterBind[ layout ] = updateAfterBind;
+
 	VK_SetObjectName( VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (u64)layout, srCreate.apName );
 
 	return gDescLayouts.Add( layout );
@@ -345,10 +487,16 @@ bool VK_AllocateDescLayout( const AllocDescLayout_t& srCreate, ch_handle_t* hand
 
 	VK_CheckResultF( vkAllocateDescriptorSets( VK_GetDevice(), &a, descSets ), "Failed to Allocate Descriptor Sets for \"%s\"", name );
 
+	auto updateAfterBind = gDescLayoutUpdateAfterBind.find( layout );
+
 	gDescSets.EnsureSize( srCreate.aSetCount );
 	for ( u32 i = 0; i < srCreate.aSetCount; i++ )
 	{
 		handles[ i ] = gDescSets.Add( descSets[ i ] );
+
+		if ( updateAfterBind != gDescLayoutUpdateAfterBind.end() )
+			gDescSetUpdateAfterBind[ descSets[ i ] ] = updateAfterBind->second;
+
 		VK_SetObjectName( VK_OBJECT_TYPE_DESCRIPTOR_SET, (u64)descSets[ i ], srCreate.apName );
 	}
 
@@ -396,10 +544,16 @@ bool VK_AllocateVariableDescLayout( const AllocVariableDescLayout_t& srCreate, c
 
 	VK_CheckResult( vkAllocateDescriptorSets( VK_GetDevice(), &a, descSets ), "Failed to Allocate Variable Descriptor Sets!" );
 
+	auto updateAfterBind = gDescLayoutUpdateAfterBind.find( layout );
+
 	gDescSets.EnsureSize( srCreate.aSetCount );
 	for ( u32 i = 0; i < srCreate.aSetCount; i++ )
 	{
 		handles[ i ] = gDescSets.Add( descSets[ i ] );
+
+		if ( updateAfterBind != gDescLayoutUpdateAfterBind.end() )
+			gDescSetUpdateAfterBind[ descSets[ i ] ] = updateAfterBind->second;
+
 		VK_SetObjectNameEx( VK_OBJECT_TYPE_DESCRIPTOR_SET, (u64)descSets[ i ], srCreate.apName, "Variable Descriptor Set" );
 	}
 
@@ -433,6 +587,9 @@ void VK_UpdateDescSets( WriteDescSet_t* spUpdate, u32 sCount )
 
 	bool failed = false;
 
+	// we only need to wait if something writes to a binding that can't be updated while in use
+	bool wait   = false;
+
 	u32  writeI = 0;
 	for ( uint32_t updateI = 0; updateI < sCount; updateI++ )
 	{
@@ -449,7 +606,7 @@ void VK_UpdateDescSets( WriteDescSet_t* spUpdate, u32 sCount )
 				write.pNext                     = nullptr;
 				write.dstSet                    = VK_GetDescSet( update.apDescSets[ i ] );
 				write.dstBinding                = binding.aBinding;
-				write.dstArrayElement           = 0;
+				write.dstArrayElement           = binding.aArrayElement;
 				write.descriptorCount           = binding.aCount;
 				write.descriptorType            = VK_ToVKDescriptorType( binding.aType );
 				write.pImageInfo                = nullptr;
@@ -462,6 +619,11 @@ void VK_UpdateDescSets( WriteDescSet_t* spUpdate, u32 sCount )
 					failed = true;
 					break;
 				}
+
+				auto updateAfterBind = gDescSetUpdateAfterBind.find( write.dstSet );
+
+				if ( binding.aBinding >= 64 || updateAfterBind == gDescSetUpdateAfterBind.end() || !( updateAfterBind->second & ( 1ull << binding.aBinding ) ) )
+					wait = true;
 		
 				switch ( binding.aType )
 				{
@@ -528,7 +690,9 @@ void VK_UpdateDescSets( WriteDescSet_t* spUpdate, u32 sCount )
 
 	if ( !failed )
 	{
-		VK_WaitForGraphicsQueue();
+		if ( wait )
+			VK_WaitForGraphicsQueue();
+
 		vkUpdateDescriptorSets( VK_GetDevice(), writes.size(), writes.data(), 0, nullptr );
 	}
 
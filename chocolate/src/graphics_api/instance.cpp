@@ -82,6 +82,9 @@ static VkQueue                           gTransferQueue;
 
 static VkPhysicalDeviceProperties        gPhysicalDeviceProperties{};
 
+static bool                              gUpdateAfterBindImages  = false;
+static bool                              gUpdateAfterBindStorage = false;
+
 static VkSurfaceCapabilitiesKHR          gSurfaceCapabilities{};
 static std::vector< VkSurfaceFormatKHR > gSwapFormats;
 static std::vector< VkPresentModeKHR >   gSwapPresentModes;
@@ -102,10 +105,10 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VK_DebugCallback( VkDebugUtilsMessageSeverityFlag
 	if ( !gEnableValidationLayers || !vk_debug_messages )
 		return VK_FALSE;
 
-	const log_t* log = Log_GetLastLog();
+	log_channel_h lastChannel = Log_GetLastChannel();
 
 	// blech
-	if ( log && log->channel != gLC_Vulkan )
+	if ( lastChannel != INVALID_LOG_CHANNEL && lastChannel != gLC_Vulkan )
 		Log_Ex( gLC_Vulkan, ELogType_Raw, "\n" );
 
 	std::string formatted;
@@ -859,11 +862,27 @@ void VK_CreateDevice( VkSurfaceKHR surface )
 		queueCreateInfos.push_back( queueCreateInfo );
 	}
 
+	// check if we can write bindless descriptors while they are bound in command buffers still in flight
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
+	VkPhysicalDeviceFeatures2                     features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	features2.pNext = &supported;
+
+	vkGetPhysicalDeviceFeatures2( gPhysicalDevice, &features2 );
+
+	gUpdateAfterBindImages  = supported.descriptorBindingSampledImageUpdateAfterBind && supported.descriptorBindingUpdateUnusedWhilePending;
+	gUpdateAfterBindStorage = supported.descriptorBindingStorageBufferUpdateAfterBind && supported.descriptorBindingUpdateUnusedWhilePending;
+
+	if ( !gUpdateAfterBindImages )
+		Log_Warn( gLC_Render, "Device does not support updating sampled images after bind, texture descriptor updates will wait on the graphics queue\n" );
+
 	VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
-	indexing.pNext                                    = nullptr;
-	indexing.descriptorBindingPartiallyBound          = VK_TRUE;
-	indexing.runtimeDescriptorArray                   = VK_TRUE;
-	indexing.descriptorBindingVariableDescriptorCount = VK_TRUE;
+	indexing.pNext                                         = nullptr;
+	indexing.descriptorBindingPartiallyBound               = VK_TRUE;
+	indexing.runtimeDescriptorArray                        = VK_TRUE;
+	indexing.descriptorBindingVariableDescriptorCount      = VK_TRUE;
+	indexing.descriptorBindingSampledImageUpdateAfterBind  = gUpdateAfterBindImages;
+	indexing.descriptorBindingStorageBufferUpdateAfterBind = gUpdateAfterBindStorage;
+	indexing.descriptorBindingUpdateUnusedWhilePending     = gUpdateAfterBindImages || gUpdateAfterBindStorage;
 
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy        = VK_TRUE;
@@ -1000,6 +1019,24 @@ const VkPhysicalDeviceLimits& VK_GetPhysicalDeviceLimits()
 }
 
 
+// Can descriptors of this type be written while a command buffer using the set is pending
+bool VK_SupportsUpdateAfterBind( VkDescriptorType sType )
+{
+	switch ( sType )
+	{
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			return gUpdateAfterBindImages;
+
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			return gUpdateAfterBindStorage;
+
+		default:
+			return false;
+	}
+}
+
+
 CONCMD( vk_device_info )
 {
 	if ( !gDevice )
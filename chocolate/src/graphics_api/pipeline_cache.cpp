@@ -0,0 +1,105 @@
+#include "core/platform.h"
+#include "core/log.h"
+#include "core/util.h"
+#include "core/filesystem.h"
+#include "core/pipeline_cache.h"
+
+#include "render/irender.h"
+#include "render_vk.h"
+
+#include <vector>
+
+
+// Pipeline cache saved between runs, so pipelines only get compiled from scratch when the driver or shaders change
+// The driver keys the entries in the cache by the SPIR-V and pipeline state, so editing one shader only recompiles that one
+// Reading and writing the file is shared with render3 in core/pipeline_cache.cpp
+
+
+#define CH_PIPELINE_CACHE_PATH "cache" PATH_SEP_STR "pipeline_cache.bin"
+
+
+static VkPipelineCache gPipelineCache = VK_NULL_HANDLE;
+
+
+static ch_pipeline_cache_key VK_GetPipelineCacheKey()
+{
+	const VkPhysicalDeviceProperties& props = VK_GetPhysicalDeviceProperties();
+
+	ch_pipeline_cache_key key{};
+	key.aVendorID      = props.vendorID;
+	key.aDeviceID      = props.deviceID;
+	key.aDriverVersion = props.driverVersion;
+	memcpy( key.aCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE );
+
+	return key;
+}
+
+
+bool VK_CreatePipelineCache()
+{
+	std::vector< char > data;
+	PipelineCache_Load( CH_PIPELINE_CACHE_PATH, VK_GetPipelineCacheKey(), data );
+
+	VkPipelineCacheCreateInfo createInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData    = data.data();
+
+	VkResult result            = vkCreatePipelineCache( VK_GetDevice(), &createInfo, nullptr, &gPipelineCache );
+
+	// try again without the old data, the driver could still not like it
+	if ( result != VK_SUCCESS && data.size() )
+	{
+		Log_Warn( gLC_Render, "Driver rejected the pipeline cache, creating an empty one\n" );
+
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData    = nullptr;
+		result                     = vkCreatePipelineCache( VK_GetDevice(), &createInfo, nullptr, &gPipelineCache );
+	}
+
+	if ( !VK_CheckResultE( result, "Failed to create pipeline cache" ) )
+	{
+		gPipelineCache = VK_NULL_HANDLE;
+		return false;
+	}
+
+	if ( data.size() )
+		Log_DevF( gLC_Render, 1, "Loaded pipeline cache - %zu KB\n", data.size() / 1024 );
+
+	VK_SetObjectName( VK_OBJECT_TYPE_PIPELINE_CACHE, (u64)gPipelineCache, "Pipeline Cache" );
+	return true;
+}
+
+
+void VK_SavePipelineCache()
+{
+	if ( gPipelineCache == VK_NULL_HANDLE || !PipelineCache_IsEnabled() )
+		return;
+
+	size_t dataSize = 0;
+	if ( vkGetPipelineCacheData( VK_GetDevice(), gPipelineCache, &dataSize, nullptr ) != VK_SUCCESS || dataSize == 0 )
+		return;
+
+	std::vector< char > data( dataSize );
+	if ( !VK_CheckResultE( vkGetPipelineCacheData( VK_GetDevice(), gPipelineCache, &dataSize, data.data() ), "Failed to get pipeline cache data" ) )
+		return;
+
+	PipelineCache_Save( CH_PIPELINE_CACHE_PATH, VK_GetPipelineCacheKey(), data.data(), dataSize );
+}
+
+
+void VK_DestroyPipelineCache()
+{
+	if ( gPipelineCache == VK_NULL_HANDLE )
+		return;
+
+	VK_SavePipelineCache();
+
+	vkDestroyPipelineCache( VK_GetDevice(), gPipelineCache, nullptr );
+	gPipelineCache = VK_NULL_HANDLE;
+}
+
+
+VkPipelineCache VK_GetPipelineCache()
+{
+	return gPipelineCache;
+}
@@ -198,6 +198,9 @@ ch_handle_t VK_CreateRenderPass( const RenderPassCreate_t& srPass )
 		attachments[ i ].stencilStoreOp      = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		attachments[ i ].initialLayout       = VK_IMAGE_LAYOUT_UNDEFINED;
 
+		if ( attach.aKeepContents )
+			attachments[ i ].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+
 		if ( attach.aType == EAttachmentType_Depth )
 		{
 			if ( depthRef.layout != VK_IMAGE_LAYOUT_MAX_ENUM )
@@ -209,6 +212,9 @@ ch_handle_t VK_CreateRenderPass( const RenderPassCreate_t& srPass )
 			depthRef.attachment = i;
 			depthRef.layout              = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 			attachments[ i ].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+			if ( attach.aKeepContents )
+				attachments[ i ].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		}
 		else
 		{
@@ -218,6 +224,9 @@ ch_handle_t VK_CreateRenderPass( const RenderPassCreate_t& srPass )
 				attachments[ i ].finalLayout = VK_IMAGE_LAYOUT_GENERAL;
 			else
 				attachments[ i ].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+			if ( attach.aKeepContents )
+				attachments[ i ].initialLayout = attachments[ i ].finalLayout;
 		}
 	}
 
@@ -60,7 +60,6 @@ static u32                                               gMaxViewports
 
 Render_OnTextureIndexUpdate*                             gpOnTextureIndexUpdateFunc = nullptr;
 
-bool                                                     gNeedTextureUpdate         = false;
 
 GraphicsAPI_t                                            gGraphicsAPIData;
 
@@ -427,8 +426,13 @@ void VK_DestroyBuffer( BufferVK* spBuffer )
 		vkDestroyBuffer( VK_GetDevice(), spBuffer->aBuffer, nullptr );
 	}
 
+	if ( spBuffer->apMapped )
+		vkUnmapMemory( VK_GetDevice(), spBuffer->aMemory );
+
 	if ( spBuffer->aMemory )
 		vkFreeMemory( VK_GetDevice(), spBuffer->aMemory, nullptr );
+
+	spBuffer->apMapped = nullptr;
 }
 
 
@@ -498,6 +502,7 @@ bool Render_CreateDevice( VkSurfaceKHR surface )
 	}
 
 	VK_CreateDevice( surface );
+	VK_CreatePipelineCache();
 
 	VK_CreateCommandPool( VK_GetSingleTimeCommandPool(), gGraphicsAPIData.aQueueFamilyGraphics );
 	VK_CreateCommandPool( VK_GetPrimaryCommandPool(), gGraphicsAPIData.aQueueFamilyGraphics );
@@ -552,6 +557,8 @@ bool Render_Init()
 		return false;
 	}
 
+	VK_StreamInit();
+
 	Log_Msg( gLC_Render, "Loaded Vulkan Renderer\n" );
 	g_renderer_started = true;
 
@@ -564,9 +571,11 @@ void Render_Shutdown()
 	if ( gpViewports )
 		delete gpViewports;
 
+	VK_StreamShutdown();
 	KTX_Shutdown();
 
 	VK_DestroyShaders();
+	VK_DestroyPipelineCache();
 
 	VK_DestroyRenderTargets();
 	VK_DestroyRenderPasses();
@@ -780,6 +789,9 @@ public:
 
 		// VK_SetImageLayout( tex->aImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1 );
 
+		// imgui keeps the image view, so it can't be swapped out by streaming
+		VK_StreamPinTexture( tex );
+
 		auto desc = ImGui_ImplVulkan_AddTexture( VK_GetSampler( tex->aFilter, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_FALSE ), tex->aImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
 
 		if ( desc )
@@ -966,6 +978,7 @@ public:
 		buffer->aMemory  = VK_NULL_HANDLE;
 		buffer->aSize    = sSize;
 		buffer->apName   = spName;
+		buffer->apMapped = nullptr;
 
 		int flagBits     = 0;
 
@@ -1056,7 +1069,13 @@ public:
 		if ( sSize > bufVK->aSize )
 		{
 			Log_WarnF( gLC_Render, "BufferWrite: Trying to write more data than buffer size can store (data size: %zd > buffer size: %zd)\n", sSize, bufVK->aSize );
-			VK_memcpy( bufVK->aMemory, bufVK->aSize, spData );
+			sSize = bufVK->aSize;
+		}
+
+		// memory can't be mapped twice
+		if ( bufVK->apMapped )
+		{
+			memcpy( bufVK->apMapped, spData, sSize );
 			return bufVK->aSize;
 		}
 
@@ -1080,14 +1099,43 @@ public:
 		if ( sSize > bufVK->aSize )
 		{
 			Log_WarnF( gLC_Render, "BufferRead: Trying to write more data than buffer size can store (data size: %zd > buffer size: %zd)\n", sSize, bufVK->aSize );
-			VK_memread( bufVK->aMemory, bufVK->aSize, spData );
+
+			if ( bufVK->apMapped )
+				memcpy( spData, bufVK->apMapped, bufVK->aSize );
+			else
+				VK_memread( bufVK->aMemory, bufVK->aSize, spData );
+
 			return sSize;
 		}
 
+		if ( bufVK->apMapped )
+		{
+			memcpy( spData, bufVK->apMapped, sSize );
+			return bufVK->aSize;
+		}
+
 		VK_memread( bufVK->aMemory, sSize, spData );
 		return bufVK->aSize;
 	}
 
+	void* BufferMap( ch_handle_t buffer ) override
+	{
+		PROF_SCOPE();
+
+		BufferVK* bufVK = gBufferHandles.Get( buffer );
+
+		if ( !bufVK )
+		{
+			Log_ErrorF( gLC_Render, "BufferMap: Failed to find Buffer (Handle: %zd)\n", buffer );
+			return nullptr;
+		}
+
+		if ( !bufVK->apMapped )
+			VK_CheckResult( vkMapMemory( VK_GetDevice(), bufVK->aMemory, 0, VK_WHOLE_SIZE, 0, &bufVK->apMapped ), "Failed to map buffer memory" );
+
+		return bufVK->apMapped;
+	}
+
 	virtual bool BufferCopy( ch_handle_t shSrc, ch_handle_t shDst, BufferRegionCopy_t* spRegions, u32 sRegionCount ) override
 	{
 		PROF_SCOPE();
@@ -1246,20 +1294,41 @@ public:
 			}
 		}
 
-		ch_string fullPath;
+		ch_string_auto path;
 
 		// we only support ktx right now
 		if ( srTexturePath.ends_with( ".ktx" ) )
 		{
-			fullPath = FileSys_FindFile( srTexturePath.data(), srTexturePath.size() );
+			path = ch_str_copy( srTexturePath.data(), srTexturePath.size() );
 		}
 		else
 		{
-			const char*    strings[] = { srTexturePath.data(), ".ktx" };
-			const u64      lengths[] = { srTexturePath.size(), 4 };
-			ch_string_auto path      = ch_str_join( 2, strings, lengths );
+			const char* strings[] = { srTexturePath.data(), ".ktx" };
+			const u64   lengths[] = { srTexturePath.size(), 4 };
+			path                  = ch_str_join( 2, strings, lengths );
+		}
 
-			fullPath                 = FileSys_FindFile( path.data, path.size );
+		ch_string fullPath   = FileSys_FindFile( path.data, path.size );
+
+		// prefer the cooked texture, unless the source texture it was cooked from changed after that
+		ch_string sourcePath = FileSys_FindSourceFile( path.data, path.size );
+
+		if ( sourcePath.data )
+		{
+			if ( fullPath.data && ( ch_str_equals( fullPath, sourcePath ) || KTX_IsCookedCurrent( fullPath.data, sourcePath.data ) ) )
+			{
+				ch_str_free( sourcePath.data );
+			}
+			else
+			{
+				if ( fullPath.data )
+				{
+					Log_WarnF( gLC_Render, "Cooked texture is out of date, loading the source texture instead, run tex_cook to update it: \"%s\"\n", path.data );
+					ch_str_free( fullPath.data );
+				}
+
+				fullPath = sourcePath;
+			}
 		}
 
 		if ( !fullPath.data )
@@ -1285,6 +1354,8 @@ public:
 				return CH_INVALID_HANDLE;
 			}
 
+			VK_StreamRemoveTexture( tex );
+
 			if ( tex->aImageView )
 				vkDestroyImageView( VK_GetDevice(), tex->aImageView, nullptr );
 
@@ -1385,14 +1456,30 @@ public:
 			return 0;
 		}
 
-		if ( gNeedTextureUpdate )
+		// textures created after PreRenderPass() this frame would be sampled before their slot is written otherwise
+		if ( VK_HasDirtyTextureSlots() )
 			VK_UpdateImageSets();
 
-		gNeedTextureUpdate = false;
+		// not a sampled texture, use the missing texture
+		if ( tex->aIndex < 0 )
+			return 0;
 
 		return tex->aIndex;
 	}
 
+	void TextureStreamRequest( ch_handle_t shTexture, u32 sScreenSize ) override
+	{
+		TextureVK* tex = VK_GetTextureNoMissing( shTexture );
+
+		if ( tex )
+			VK_StreamRequest( tex, sScreenSize );
+	}
+
+	void GetTextureStreamStats( TextureStreamStats_t& srStats ) override
+	{
+		VK_GetTextureStreamStats( srStats );
+	}
+
 	GraphicsFmt GetTextureFormat( ch_handle_t shTexture ) override
 	{
 		PROF_SCOPE();
@@ -1444,11 +1531,6 @@ public:
 			return info;
 		}
 
-		if ( gNeedTextureUpdate )
-			VK_UpdateImageSets();
-
-		gNeedTextureUpdate = false;
-
 		info.aFormat   = VK_ToGraphicsFmt( tex->aFormat );
 
 		if ( tex->name.data )
@@ -1512,6 +1594,9 @@ public:
 
 		// probably an awful way of doing this
 
+		// the copy below reads mip 0
+		VK_StreamPinTexture( tex );
+
 		ReadTexture readTexture;
 		readTexture.size             = tex->aSize;
 		readTexture.dataSize         = tex->aSize.x * tex->aSize.y * sizeof( u32 );
@@ -1751,6 +1836,9 @@ public:
 
 	void PreRenderPass() override
 	{
+		// swap in streamed mips that finished uploading, then write the texture slots that changed since last frame, before any command buffers are recorded
+		VK_StreamUpdate();
+		VK_UpdateTextureSlots();
 	}
 
 	void CopyQueuedBuffers() override
@@ -2384,6 +2472,85 @@ public:
 
 		CH_STACK_FREE( bufferMem );
 	}
+
+	void CmdCopyTexture( ch_handle_t sCmd, ch_handle_t sSrc, ch_handle_t sDst ) override
+	{
+		PROF_SCOPE();
+
+		VkCommandBuffer c = VK_GetCommandBuffer( sCmd );
+
+		if ( c == nullptr )
+		{
+			Log_Error( gLC_Render, "CmdCopyTexture: Invalid Command Buffer\n" );
+			return;
+		}
+
+		TextureVK* src = VK_GetTexture( sSrc );
+		TextureVK* dst = VK_GetTexture( sDst );
+
+		if ( !src || !dst )
+		{
+			Log_Error( gLC_Render, "CmdCopyTexture: Invalid Texture\n" );
+			return;
+		}
+
+		if ( src->aSize != dst->aSize || src->aFormat != dst->aFormat )
+		{
+			Log_Error( gLC_Render, "CmdCopyTexture: Textures have a different size or format\n" );
+			return;
+		}
+
+		bool               depth  = src->aUsage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		VkImageAspectFlags aspect = depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+		VkImageLayout      layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		VkAccessFlags      access = depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		VkPipelineStageFlags stage = depth ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+		// both textures are expected to be in the layout a render pass leaves them in,
+		// the old contents of the destination are thrown away
+		VkImageMemoryBarrier barriers[ 2 ]{};
+		for ( VkImageMemoryBarrier& barrier : barriers )
+		{
+			barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.subresourceRange    = { aspect, 0, 1, 0, 1 };
+		}
+
+		barriers[ 0 ].image         = src->aImage;
+		barriers[ 0 ].oldLayout     = layout;
+		barriers[ 0 ].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[ 0 ].srcAccessMask = access;
+		barriers[ 0 ].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		barriers[ 1 ].image         = dst->aImage;
+		barriers[ 1 ].oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[ 1 ].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[ 1 ].srcAccessMask = 0;
+		barriers[ 1 ].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier( c, stage | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers );
+
+		VkImageCopy region{};
+		region.srcSubresource = { aspect, 0, 0, 1 };
+		region.dstSubresource = { aspect, 0, 0, 1 };
+		region.extent         = { src->aSize.x, src->aSize.y, 1 };
+
+		vkCmdCopyImage( c, src->aImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst->aImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+
+		// and back to the attachment layout
+		barriers[ 0 ].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[ 0 ].newLayout     = layout;
+		barriers[ 0 ].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[ 0 ].dstAccessMask = access;
+
+		barriers[ 1 ].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[ 1 ].newLayout     = layout;
+		barriers[ 1 ].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[ 1 ].dstAccessMask = access | ( depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT );
+
+		vkCmdPipelineBarrier( c, VK_PIPELINE_STAGE_TRANSFER_BIT, stage, 0, 0, nullptr, 0, nullptr, 2, barriers );
+	}
 };
 
 
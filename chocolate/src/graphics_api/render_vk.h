@@ -76,9 +76,12 @@ struct BufferVK
 	VkDeviceMemory aMemory;
 	size_t         aSize;
 	const char*    apName;
+	void*          apMapped = nullptr;  // set by BufferMap(), stays mapped until the buffer is destroyed
 };
 
 
+struct TextureStream_t;
+
 // TODO: split this up, most of the time we don't like half of the info here, only just filling up the cpu cache more !!
 struct TextureVK
 {
@@ -98,7 +101,7 @@ struct TextureVK
 	u32                  aDataSize       = 0;
 
 	// Texture Information
-	int                  aIndex          = 0;  // texture sampler index (MOVE ELSEWHERE!!)
+	int                  aIndex          = -1;  // slot in the bindless image array, -1 if it doesn't have one (MOVE ELSEWHERE!!)
 
 	glm::uvec2           aSize{};
 
@@ -109,6 +112,25 @@ struct TextureVK
 	u8                   aMipLevels    = 0;
 	bool                 aRenderTarget = false;
 	bool                 aSwapChain    = false;  // swapchain managed texture (wtf)
+
+	// set if this texture streams its mips, aSize is still the size of mip 0, aMipLevels is only the resident mips
+	TextureStream_t*     apStream      = nullptr;
+};
+
+
+constexpr u32 CH_TEXTURE_MAX_MIPS = 16;
+
+// Mips read from a texture file, mips aFirstMip to the end of the chain are packed together in apData
+struct TextureMipData_t
+{
+	char*      apData    = nullptr;
+	u32        aDataSize = 0;
+	u32        aOffsets[ CH_TEXTURE_MAX_MIPS ]{};  // offset of each mip in apData
+	u32        aSizes[ CH_TEXTURE_MAX_MIPS ]{};    // size of every mip in the chain, including the ones not in apData
+	glm::uvec2 aBaseSize{};
+	VkFormat   aFormat   = VK_FORMAT_UNDEFINED;
+	u8         aMipCount = 0;  // mips in the full chain
+	u8         aFirstMip = 0;
 };
 
 
@@ -264,8 +286,6 @@ struct GraphicsAPI_t
 
 	CommandBufferGroup_t                  aCommandGroups[ ECommandBufferType_Count ];
 
-	ChVector< ch_handle_t >                aSampledTextures;
-
 	ChVector< QueuedBufferCopy_t >        aBufferCopies;
 
 	std::unordered_map< ch_handle_t, u32 > aTextureRefs;
@@ -361,6 +381,7 @@ VkExtent2D                            VK_ChooseSwapExtent( WindowVK* window );
 
 const VkPhysicalDeviceProperties&     VK_GetPhysicalDeviceProperties();
 const VkPhysicalDeviceLimits&         VK_GetPhysicalDeviceLimits();
+bool                                  VK_SupportsUpdateAfterBind( VkDescriptorType sType );
 
 // --------------------------------------------------------------------------------------
 // Swapchain
@@ -391,8 +412,13 @@ const std::vector< ch_handle_t >&          VK_GetSamplerSetsHandles();
 // const std::vector< VkDescriptorSet >& VK_GetImageSets();
 // const std::vector< VkDescriptorSet >& VK_GetImageStorage();
 // VkDescriptorSet                       VK_GetImageSet( size_t sIndex );
+void                                  VK_UpdateTextureSlots();
 void                                  VK_UpdateImageSets();
-void                                  VK_CalcTextureIndices();
+bool                                  VK_HasDirtyTextureSlots();
+void                                  VK_AddTextureSlot( ch_handle_t sTexture, TextureVK* spTexture );
+void                                  VK_RemoveTextureSlot( TextureVK* spTexture );
+void                                  VK_DirtyAllTextureSlots();
+void                                  VK_MoveTextureSlot( TextureVK* spTexture );
 void                                  VK_SetImageSets( ch_handle_t* spDescSets, int sCount, u32 sBinding );
 
 ch_handle_t                                VK_CreateDescLayout( const CreateDescLayout_t& srCreate );
@@ -465,6 +491,11 @@ void                                  VK_CheckFenceStatus( WindowVK* window );
 // --------------------------------------------------------------------------------------
 // Shader System
 
+bool                                  VK_CreatePipelineCache();
+void                                  VK_SavePipelineCache();
+void                                  VK_DestroyPipelineCache();
+VkPipelineCache                       VK_GetPipelineCache();
+
 bool                                  VK_CreatePipelineLayout( ch_handle_t& sHandle, PipelineLayoutCreate_t& srPipelineCreate );
 bool                                  VK_CreateGraphicsPipeline( ch_handle_t& sHandle, GraphicsPipelineCreate_t& srGraphicsCreate );
 bool                                  VK_CreateComputePipeline( ch_handle_t& srHandle, ComputePipelineCreate_t& srPipelineCreate );
@@ -512,6 +543,7 @@ void                                  VK_DestroyRenderTargets();
 
 void                                  VK_CreateBackBuffer( WindowVK* window );
 
+void                                  VK_SetImageLayout( VkCommandBuffer c, VkImage sImage, VkImageLayout sOldLayout, VkImageLayout sNewLayout, VkImageSubresourceRange& sSubresourceRange );
 void                                  VK_SetImageLayout( VkImage sImage, VkImageLayout sOldLayout, VkImageLayout sNewLayout, VkImageSubresourceRange& sSubresourceRange );
 void                                  VK_SetImageLayout( VkImage sImage, VkImageLayout sOldLayout, VkImageLayout sNewLayout, u32 sMipLevels );
 
@@ -519,6 +551,24 @@ void                                  VK_CreateMissingTexture();
 
 // void                                  VK_AllocateAndBindTexture( TextureVK* spTexture );
 void                                  VK_CreateImage( VkImageCreateInfo& srCreateInfo, TextureVK* spTexture );
+bool                                  VK_IsCompressedFormat( VkFormat sFormat );
+
+// --------------------------------------------------------------------------------------
+// Texture Streaming
+
+void                                  VK_StreamInit();
+void                                  VK_StreamShutdown();
+void                                  VK_StreamUpdate();
+
+// First mip to load for a texture that streams, 0 if the texture is loaded fully
+u8                                    VK_StreamGetLoadMip( glm::uvec2 sSize, u8 sMipCount, VkFormat sFormat );
+
+// Creates the image from the smallest mips, and keeps them around to evict back down to, takes ownership of srMips.apData if it succeeds
+bool                                  VK_StreamCreateTexture( TextureVK* spTexture, const char* spPath, TextureMipData_t& srMips );
+void                                  VK_StreamRemoveTexture( TextureVK* spTexture );
+void                                  VK_StreamRequest( TextureVK* spTexture, u32 sScreenSize );
+void                                  VK_StreamPinTexture( TextureVK* spTexture );
+void                                  VK_GetTextureStreamStats( TextureStreamStats_t& srStats );
 
 // --------------------------------------------------------------------------------------
 // KTX Texture Support
@@ -526,5 +576,7 @@ void                                  VK_CreateImage( VkImageCreateInfo& srCreat
 bool                                  KTX_Init();
 void                                  KTX_Shutdown();
 bool                                  KTX_LoadTexture( TextureVK* spTexture, const char* spPath );
+bool                                  KTX_LoadMips( const char* spPath, u8 sFirstMip, TextureMipData_t& srMips );
+bool                                  KTX_IsCookedCurrent( const char* spCookedPath, const char* spSourcePath );
 
 
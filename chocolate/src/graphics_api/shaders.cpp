@@ -5,6 +5,8 @@
 #include "render/irender.h"
 #include "render_vk.h"
 
+#include <mutex>
+
 
 struct ShaderVK
 {
@@ -21,6 +23,9 @@ struct ShaderVK
 static ResourceList< ShaderVK >         gShaders;
 static ResourceList< VkPipelineLayout > gPipelineLayouts;
 
+// pipelines can be created from multiple threads at once, this only guards gShaders, compiling them doesn't need a lock
+static std::mutex                       gShadersMutex;
+
 
 CONVAR_BOOL_CMD( r_msaa_textures, 0, CVARF_ARCHIVE, "Enable/Disable MSAA on Textures, this is VERY EXPENSIVE! It enables VkPipelineMultisampleStateCreateInfo::sampleShadingEnable" )
 {
@@ -189,7 +194,16 @@ bool VK_CreateComputePipeline( ch_handle_t& srHandle, ComputePipelineCreate_t& s
 	pipelineInfo.basePipelineHandle  = VK_NULL_HANDLE;  // Optional, very important for later when making new pipelines. It is less expensive to reference an existing similar pipeline
 	pipelineInfo.basePipelineIndex   = -1;              // Optional
 
-	ShaderVK* shader                 = nullptr;
+	VkPipeline pipeline              = VK_NULL_HANDLE;
+
+	VK_CheckResultF(
+	  vkCreateComputePipelines( VK_GetDevice(), VK_GetPipelineCache(), 1, &pipelineInfo, NULL, &pipeline ),
+	  "Failed to create graphics pipeline for shader: \"%s\"", srPipelineCreate.apName );
+
+	VK_SetObjectNameEx( VK_OBJECT_TYPE_PIPELINE, (u64)pipeline, srPipelineCreate.apName, "Compute Pipeline" );
+
+	std::lock_guard< std::mutex > lock( gShadersMutex );
+	ShaderVK*                     shader = nullptr;
 
 	if ( srHandle != CH_INVALID_HANDLE )
 	{
@@ -197,6 +211,7 @@ bool VK_CreateComputePipeline( ch_handle_t& srHandle, ComputePipelineCreate_t& s
 		if ( !shader )
 		{
 			Log_ErrorF( gLC_Render, "VK_CreateGraphicsPipeline(): Shader not found for recreation: \"%s\"\n", srPipelineCreate.apName );
+			vkDestroyPipeline( VK_GetDevice(), pipeline, nullptr );
 			return false;
 		}
 
@@ -216,17 +231,11 @@ bool VK_CreateComputePipeline( ch_handle_t& srHandle, ComputePipelineCreate_t& s
 		srHandle = gShaders.Create( &shader );
 	}
 
+	shader->aPipeline          = pipeline;
 	shader->aBindPoint         = VK_PIPELINE_BIND_POINT_COMPUTE;
 	shader->apShaderModules    = shaderModules;
 	shader->aShaderModuleCount = 1;
 
-	// TODO: look into trying to make multiple pipelines at once
-	VK_CheckResultF(
-	  vkCreateComputePipelines( VK_GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &shader->aPipeline ),
-	  "Failed to create graphics pipeline for shader: \"%s\"", srPipelineCreate.apName );
-
-	VK_SetObjectNameEx( VK_OBJECT_TYPE_PIPELINE, (u64)shader->aPipeline, srPipelineCreate.apName, "Compute Pipeline" );
-
 	return true;
 }
 
@@ -466,7 +475,16 @@ bool VK_CreateGraphicsPipeline( ch_handle_t& srHandle, GraphicsPipelineCreate_t&
 	pipelineInfo.basePipelineHandle  = VK_NULL_HANDLE;  // Optional, very important for later when making new pipelines. It is less expensive to reference an existing similar pipeline
 	pipelineInfo.basePipelineIndex   = -1;              // Optional
 
-	ShaderVK* shader                 = nullptr;
+	VkPipeline pipeline              = VK_NULL_HANDLE;
+
+	VK_CheckResultF(
+	  vkCreateGraphicsPipelines( VK_GetDevice(), VK_GetPipelineCache(), 1, &pipelineInfo, NULL, &pipeline ),
+	  "Failed to create graphics pipeline for shader: \"%s\"", srGraphicsCreate.apName );
+
+	VK_SetObjectNameEx( VK_OBJECT_TYPE_PIPELINE, (u64)pipeline, srGraphicsCreate.apName, "Graphics Pipeline" );
+
+	std::lock_guard< std::mutex > lock( gShadersMutex );
+	ShaderVK*                     shader = nullptr;
 
 	if ( srHandle != CH_INVALID_HANDLE )
 	{
@@ -474,6 +492,7 @@ bool VK_CreateGraphicsPipeline( ch_handle_t& srHandle, GraphicsPipelineCreate_t&
 		if ( !shader )
 		{
 			Log_ErrorF( gLC_Render, "VK_CreateGraphicsPipeline(): Shader not found for recreation: \"%s\"\n", srGraphicsCreate.apName );
+			vkDestroyPipeline( VK_GetDevice(), pipeline, nullptr );
 			return false;
 		}
 
@@ -493,17 +512,11 @@ bool VK_CreateGraphicsPipeline( ch_handle_t& srHandle, GraphicsPipelineCreate_t&
 		srHandle = gShaders.Create( &shader );
 	}
 
+	shader->aPipeline          = pipeline;
 	shader->aBindPoint         = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	shader->apShaderModules    = vkShaderModules;
 	shader->aShaderModuleCount = srGraphicsCreate.aShaderModules.size();
 
-	// TODO: look into trying to make multiple pipelines at once
-	VK_CheckResultF(
-	  vkCreateGraphicsPipelines( VK_GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &shader->aPipeline ),
-	  "Failed to create graphics pipeline for shader: \"%s\"", srGraphicsCreate.apName );
-
-	VK_SetObjectNameEx( VK_OBJECT_TYPE_PIPELINE, (u64)shader->aPipeline, srGraphicsCreate.apName, "Graphics Pipeline" );
-
 	return true;
 }
 
@@ -27,7 +27,6 @@ static std::unordered_map< VkFramebuffer, ch_handle_t > gFramebufferHandles;
 // the true handle of the missing texture, but handle of 0 will also give the missing texture
 ch_handle_t                                         gMissingTexHandle = CH_INVALID_HANDLE;
 
-extern bool                                        gNeedTextureUpdate;
 
 static u32                                         gTextureSamplers = 0;
 
@@ -388,7 +387,7 @@ void VK_RecreateTextureSamplers()
 	VK_DestroyTextureSamplers();
 	VK_CreateTextureSamplers();
 
-	gNeedTextureUpdate = true;
+	VK_DirtyAllTextureSlots();
 }
 
 
@@ -512,16 +511,10 @@ bool VK_LoadTexture( ch_handle_t& srHandle, TextureVK* tex, const ch_string& srP
 	tex->name           = ch_str_copy( srPath.data, srPath.size );
 
 	// textures loaded through KTX are always sampled currently
-	if ( tex->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT )
-	{
-		gGraphicsAPIData.aSampledTextures.push_back( srHandle );
-	}
+	VK_AddTextureSlot( srHandle, tex );
 
 	VK_SetObjectName( VK_OBJECT_TYPE_IMAGE, (u64)tex->aImage, srPath.data );
 
-	VK_CalcTextureIndices();
-	gNeedTextureUpdate = true;
-
 	// VK_CalcTextureMemoryUsage( tex );
 
 	return true;
@@ -537,7 +530,6 @@ TextureVK* VK_CreateTexture( ch_handle_t& srHandle, const TextureCreateInfo_t& s
 	}
 
 	TextureVK* tex       = VK_NewTexture( srHandle );
-	tex->aIndex          = gTextureHandles.size() - 1;
 	tex->aSize           = srCreate.aSize;
 	tex->aFormat         = VK_ToVkFormat( srCreate.aFormat );
 	tex->aUsage          = VK_ToVkImageUsage( srCreateData.aUsage );
@@ -547,11 +539,6 @@ TextureVK* VK_CreateTexture( ch_handle_t& srHandle, const TextureCreateInfo_t& s
 	tex->aDepthCompare   = srCreateData.aDepthCompare;
 	tex->aDataSize       = srCreate.aDataSize;
 
-	if ( tex->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT )
-	{
-		gGraphicsAPIData.aSampledTextures.push_back( srHandle );
-	}
-
 	VkImageCreateInfo createInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
 	createInfo.imageType     = VK_IMAGE_TYPE_2D;
 	createInfo.extent.width  = srCreate.aSize.x;
@@ -717,9 +704,7 @@ TextureVK* VK_CreateTexture( ch_handle_t& srHandle, const TextureCreateInfo_t& s
 
 	VK_SetObjectName( VK_OBJECT_TYPE_IMAGE, (u64)tex->aImage, tex->name.data ? tex->name.data : "MANUALLY CREATED TEXTURE" );
 
-	VK_CalcTextureIndices();
-
-	gNeedTextureUpdate = true;
+	VK_AddTextureSlot( srHandle, tex );
 
 	VK_CalcTextureMemoryUsage( tex );
 
@@ -743,6 +728,8 @@ void VK_DestroyTexture( ch_handle_t sTexture )
 	// big hack, blech
 	if ( !texture->aSwapChain )
 	{
+		VK_StreamRemoveTexture( texture );
+
 		if ( texture->aImageView )
 			vkDestroyImageView( VK_GetDevice(), texture->aImageView, nullptr );
 
@@ -754,10 +741,7 @@ void VK_DestroyTexture( ch_handle_t sTexture )
 			vkFreeMemory( VK_GetDevice(), texture->aMemory, nullptr );
 		}
 
-		if ( texture->aUsage & VK_IMAGE_USAGE_SAMPLED_BIT )
-		{
-			gGraphicsAPIData.aSampledTextures.erase( sTexture );
-		}
+		VK_RemoveTextureSlot( texture );
 	}
 
 	gTextureHandles.Remove( sTexture );
@@ -1506,7 +1490,5 @@ void VK_CreateMissingTexture()
 		Log_Fatal( gLC_Render, "Failed to create missing texture!\n" );
 		return;
 	}
-
-	gNeedTextureUpdate = true;
 }
 
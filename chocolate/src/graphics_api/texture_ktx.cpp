@@ -3,6 +3,8 @@
 #include "ktx.h"
 #include "ktxvulkan.h"
 
+#include <filesystem>
+
 
 static ktxVulkanFunctions gKtxFuncs = {
 	vkGetInstanceProcAddr,
@@ -72,6 +74,22 @@ void KTX_Shutdown()
 }
 
 
+// Cooked textures say what they're used for, masks only need one channel
+static ktx_transcode_fmt_e KTX_GetTranscodeFormat( ktxTexture2* spKTexture2 )
+{
+	char*        usage    = nullptr;
+	unsigned int usageLen = 0;
+
+	if ( ktxHashList_FindValue( &spKTexture2->kvDataHead, CH_TEXTURE_COOK_KEY_USAGE, &usageLen, (void**)&usage ) != KTX_SUCCESS )
+		return gKtxFallbackFmt;
+
+	if ( usageLen > 0 && strncmp( usage, CH_TEXTURE_COOK_USAGE_MASK, usageLen ) == 0 )
+		return KTX_TTF_BC4_R;
+
+	return gKtxFallbackFmt;
+}
+
+
 static bool LoadKTX2( ktxTexture2* spKTexture2 )
 {
 	// ktxTexture2_CreateFromNamedFile
@@ -89,11 +107,12 @@ static bool LoadKTX2( ktxTexture2* spKTexture2 )
 
 	if ( ktxTexture2_NeedsTranscoding( spKTexture2 ) )
 	{
-		result = ktxTexture2_TranscodeBasis( spKTexture2, gKtxFallbackFmt, 0 );
+		ktx_transcode_fmt_e format = KTX_GetTranscodeFormat( spKTexture2 );
+		result                     = ktxTexture2_TranscodeBasis( spKTexture2, format, 0 );
 
 		if ( KTX_SUCCESS != result )
 		{
-			Log_ErrorF( gLC_Render, "Transcoding of ktxTexture2 to %s failed: %s\n", ktxTranscodeFormatString( gKtxFallbackFmt ), ktxErrorString( result ) );
+			Log_ErrorF( gLC_Render, "Transcoding of ktxTexture2 to %s failed: %s\n", ktxTranscodeFormatString( format ), ktxErrorString( result ) );
 			return false;
 		}
 	}
@@ -102,6 +121,125 @@ static bool LoadKTX2( ktxTexture2* spKTexture2 )
 }
 
 
+// Copies mips sFirstMip to the end of the chain out of a texture, the texture data is loaded if it isn't already
+static bool KTX_CopyMips( ktxTexture* spKTexture, u8 sFirstMip, TextureMipData_t& srMips )
+{
+	if ( !spKTexture->pData )
+	{
+		KTX_error_code result = ktxTexture_LoadImageData( spKTexture, nullptr, 0 );
+
+		if ( result != KTX_SUCCESS )
+		{
+			Log_ErrorF( gLC_Render, "KTX Error %d: %s - Failed to load texture data\n", result, ktxErrorString( result ) );
+			return false;
+		}
+	}
+
+	if ( spKTexture->numLevels > CH_TEXTURE_MAX_MIPS || sFirstMip >= spKTexture->numLevels )
+		return false;
+
+	srMips.aBaseSize = { spKTexture->baseWidth, spKTexture->baseHeight };
+	srMips.aFormat   = ktxTexture_GetVkFormat( spKTexture );
+	srMips.aMipCount = spKTexture->numLevels;
+	srMips.aFirstMip = sFirstMip;
+	srMips.aDataSize = 0;
+
+	for ( u8 mip = 0; mip < srMips.aMipCount; mip++ )
+	{
+		srMips.aSizes[ mip ]   = ktxTexture_GetImageSize( spKTexture, mip );
+		srMips.aOffsets[ mip ] = 0;
+
+		if ( mip < sFirstMip )
+			continue;
+
+		// copy offsets have to be a multiple of the block size
+		srMips.aOffsets[ mip ] = srMips.aDataSize;
+		srMips.aDataSize += ( srMips.aSizes[ mip ] + 15 ) & ~15;
+	}
+
+	srMips.apData     = ch_malloc< char >( srMips.aDataSize );
+	ktx_uint8_t* data = ktxTexture_GetData( spKTexture );
+
+	for ( u8 mip = sFirstMip; mip < srMips.aMipCount; mip++ )
+	{
+		ktx_size_t offset = 0;
+		ktxTexture_GetImageOffset( spKTexture, mip, 0, 0, &offset );
+		memcpy( srMips.apData + srMips.aOffsets[ mip ], data + offset, srMips.aSizes[ mip ] );
+	}
+
+	return true;
+}
+
+
+// Only plain 2D textures stream, and the first mip that's loaded depends on the size
+static u8 KTX_GetStreamMip( ktxTexture* spKTexture )
+{
+	if ( spKTexture->numDimensions != 2 || spKTexture->numLayers != 1 || spKTexture->numFaces != 1 || spKTexture->isArray || spKTexture->isCubemap )
+		return 0;
+
+	if ( spKTexture->numLevels < 2 || spKTexture->numLevels > CH_TEXTURE_MAX_MIPS )
+		return 0;
+
+	return VK_StreamGetLoadMip( { spKTexture->baseWidth, spKTexture->baseHeight }, spKTexture->numLevels, ktxTexture_GetVkFormat( spKTexture ) );
+}
+
+
+// Called on the texture streaming threads
+bool KTX_LoadMips( const char* spPath, u8 sFirstMip, TextureMipData_t& srMips )
+{
+	ktxTexture*    kTexture = nullptr;
+	KTX_error_code result   = ktxTexture_CreateFromNamedFile( spPath, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &kTexture );
+
+	if ( result != KTX_SUCCESS )
+	{
+		Log_ErrorF( gLC_Render, "KTX Error %d: %s - Failed to open texture: %s\n", result, ktxErrorString( result ), spPath );
+		return false;
+	}
+
+	if ( kTexture->classId == class_id::ktxTexture2_c && !LoadKTX2( (ktxTexture2*)kTexture ) )
+	{
+		ktxTexture_Destroy( kTexture );
+		return false;
+	}
+
+	bool copied = KTX_CopyMips( kTexture, sFirstMip, srMips );
+
+	ktxTexture_Destroy( kTexture );
+	return copied;
+}
+
+
+// A cooked texture is out of date when the source texture was modified after it was cooked
+// Textures that weren't made by the cooker have no source time, and are always current
+bool KTX_IsCookedCurrent( const char* spCookedPath, const char* spSourcePath )
+{
+	ktxTexture*    kTexture = nullptr;
+	KTX_error_code result   = ktxTexture_CreateFromNamedFile( spCookedPath, KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture );
+
+	if ( result != KTX_SUCCESS )
+		return false;
+
+	char*        value    = nullptr;
+	unsigned int valueLen = 0;
+	bool         current  = true;
+
+	if ( ktxHashList_FindValue( &kTexture->kvDataHead, CH_TEXTURE_COOK_KEY_SOURCE_TIME, &valueLen, (void**)&value ) == KTX_SUCCESS )
+	{
+		std::error_code ec;
+		auto            modified = std::filesystem::last_write_time( spSourcePath, ec );
+
+		if ( !ec )
+		{
+			u64 seconds = std::chrono::duration_cast< std::chrono::seconds >( modified.time_since_epoch() ).count();
+			current     = std::string( value, strnlen( value, valueLen ) ) == std::to_string( seconds );
+		}
+	}
+
+	ktxTexture_Destroy( kTexture );
+	return current;
+}
+
+
 bool KTX_LoadTexture( TextureVK* spTexture, const char* spPath )
 {
 	ktxTexture* kTexture = nullptr;
@@ -130,6 +268,27 @@ bool KTX_LoadTexture( TextureVK* spTexture, const char* spPath )
 		}
 	}
 
+	// only upload the smallest mips if this streams, the rest are streamed in when they're needed
+	if ( u8 streamMip = KTX_GetStreamMip( kTexture ) )
+	{
+		TextureMipData_t mips;
+
+		if ( KTX_CopyMips( kTexture, streamMip, mips ) && VK_StreamCreateTexture( spTexture, spPath, mips ) )
+		{
+			Log_DevF( gLC_Render, 2, "Loaded Streamed Image: %s - %u of %u mips resident\n", spPath, kTexture->numLevels - streamMip, kTexture->numLevels );
+
+			VK_SetObjectName( VK_OBJECT_TYPE_DEVICE_MEMORY, (u64)spTexture->aMemory, spPath );
+			VK_SetObjectName( VK_OBJECT_TYPE_IMAGE_VIEW, (u64)spTexture->aImageView, spPath );
+
+			ktxTexture_Destroy( kTexture );
+			return true;
+		}
+
+		// load it the normal way
+		if ( mips.apData )
+			ch_free( mips.apData );
+	}
+
 	ktxVulkanTexture kVkTexture;
 
 	result = ktxTexture_VkUploadEx(
@@ -0,0 +1,798 @@
+#include "core/platform.h"
+#include "core/log.h"
+#include "core/util.h"
+#include "core/console.h"
+#include "core/profiler.h"
+
+#include "render_vk.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+// ----------------------------------------------------------------
+// Texture Streaming
+//
+// Streamed textures are loaded with only their smallest mips, and the graphics system tells us how big they are on screen each frame
+// Worker threads read the mips that are wanted from the file, those are uploaded into a new image with a fence,
+// and once that's done the texture moves to a new bindless slot with the new image view, materials pick up the new index
+// The old slot and image are retired for a few frames, so nothing waits on or writes over what frames in flight are using
+//
+// Going over the memory budget drops the least recently seen textures back down to their smallest mips,
+// those are kept in memory so evicting doesn't need to read the file again
+// ----------------------------------------------------------------
+
+
+CONVAR_BOOL( r_texture_stream, 1, CVARF_ARCHIVE, "Stream texture mips in based on how big they are on screen, takes effect on texture load" );
+CONVAR_RANGE_INT( r_texture_stream_min_size, 64, 1, 4096, CVARF_ARCHIVE, "Largest mip size that's always resident for streamed textures, takes effect on texture load" );
+CONVAR_RANGE_INT( r_texture_stream_budget, 1024, 16, 65536, CVARF_ARCHIVE, "Memory budget for streamed textures in MB" );
+CONVAR_RANGE_FLOAT( r_texture_stream_bias, 0.f, -4.f, 4.f, CVARF_ARCHIVE, "Mip bias for picking streamed mips, higher values stream in less detail" );
+CONVAR_RANGE_INT( r_texture_stream_idle_frames, 30, 1, 100000, "Frames a streamed texture has to go unseen for before it can be evicted" );
+CONVAR_RANGE_INT( r_texture_stream_uploads, 4, 1, 64, "Max streamed textures to start uploading each frame" );
+CONVAR_RANGE_INT( r_texture_stream_max_loads, 32, 1, 1024, "Max streamed textures being loaded by the workers at once" );
+CONVAR_RANGE_INT( r_texture_stream_threads, 2, 1, 16, "Number of texture streaming threads, takes effect on restart" );
+
+
+extern std::mutex gGraphicsMutex;
+
+
+// the old image of a texture is destroyed this many frames after a new one is swapped in, so command buffers in flight can still use it
+constexpr u32     CH_STREAM_RETIRE_FRAMES = 4;
+constexpr u8      CH_STREAM_NO_MIP        = 0xFF;
+
+
+struct TextureStream_t
+{
+	TextureVK*       apTexture;
+	std::string      aPath;
+
+	// the smallest mips, the texture never drops below these
+	TextureMipData_t aLowMips;
+
+	u8               aMipCount;
+	u8               aLowestMip;                        // first mip in aLowMips
+	u8               aResidentMip;                      // first mip in the image right now
+	u8               aWantedMip;                        // most detailed mip asked for this frame
+	u8               aLoadingMip     = CH_STREAM_NO_MIP;  // first mip of the image being loaded or uploaded
+	u32              aLastUsedFrame  = 0;
+	bool             aPinned         = false;           // always fully resident, the image view is used outside of the bindless array
+	bool             aFailed         = false;           // failed to load mips from the file, don't try again
+	bool             aDestroyed      = false;           // the texture was freed while a load was in flight, the load frees this
+};
+
+
+struct TextureStreamJob_t
+{
+	TextureStream_t* apStream;
+	u8               aFirstMip;
+	bool             aSuccess = false;
+	TextureMipData_t aMips;
+};
+
+
+struct TextureStreamUpload_t
+{
+	TextureStream_t* apStream;
+	u8               aFirstMip;
+	VkCommandBuffer  aCmd;
+	VkFence          aFence;
+	BufferVK         aStaging;
+	VkImage          aImage;
+	VkDeviceMemory   aMemory;
+	u32              aMemorySize;
+};
+
+
+struct RetiredStreamImage_t
+{
+	VkImage          aImage;
+	VkImageView      aImageView;
+	VkDeviceMemory   aMemory;
+	u32              aFrame;
+};
+
+
+static std::vector< TextureStream_t* >      gStreams;
+static std::vector< TextureStreamUpload_t > gStreamUploads;
+static std::vector< RetiredStreamImage_t >  gStreamRetired;
+static std::vector< TextureStreamJob_t* >   gStreamLoaded;        // loaded by the workers, waiting to be uploaded
+
+static VkCommandPool                        gStreamCmdPool       = VK_NULL_HANDLE;
+static u32                                  gStreamFrame         = 0;
+static u32                                  gStreamPendingJobs   = 0;
+static u64                                  gStreamResidentBytes = 0;
+static u32                                  gStreamEvictedFrame  = 0;
+static u32                                  gStreamEvictedTotal  = 0;
+
+// worker threads
+static std::mutex                           gStreamMutex;
+static std::condition_variable              gStreamWake;
+static std::vector< TextureStreamJob_t* >   gStreamQueue;
+static std::vector< TextureStreamJob_t* >   gStreamDone;
+static std::vector< std::thread >           gStreamThreads;
+static bool                                 gStreamRunning       = false;
+
+
+static glm::uvec2 VK_StreamGetMipSize( glm::uvec2 sBaseSize, u8 sMip )
+{
+	return { std::max( sBaseSize.x >> sMip, 1u ), std::max( sBaseSize.y >> sMip, 1u ) };
+}
+
+
+// Memory used with mips sFirstMip to the end of the chain resident, going by the size of the mip data
+static u64 VK_StreamGetBytes( TextureStream_t* spStream, u8 sFirstMip )
+{
+	u64 bytes = 0;
+	for ( u8 mip = sFirstMip; mip < spStream->aMipCount; mip++ )
+		bytes += spStream->aLowMips.aSizes[ mip ];
+
+	return bytes;
+}
+
+
+static void VK_StreamFree( TextureStream_t* spStream )
+{
+	if ( spStream->aLowMips.apData )
+		ch_free( spStream->aLowMips.apData );
+
+	delete spStream;
+}
+
+
+static void VK_StreamFreeJob( TextureStreamJob_t* spJob )
+{
+	if ( spJob->aMips.apData )
+		ch_free( spJob->aMips.apData );
+
+	delete spJob;
+}
+
+
+static void VK_StreamWorker()
+{
+	while ( true )
+	{
+		TextureStreamJob_t* job = nullptr;
+
+		{
+			std::unique_lock< std::mutex > lock( gStreamMutex );
+			gStreamWake.wait( lock, []() { return !gStreamRunning || gStreamQueue.size(); } );
+
+			if ( !gStreamRunning )
+				return;
+
+			// the main thread queues them most important first
+			job = gStreamQueue.front();
+			gStreamQueue.erase( gStreamQueue.begin() );
+		}
+
+		PROF_SCOPE_NAMED( "Texture Stream Load" );
+
+		// nothing else touches the path while a job is in flight
+		job->aSuccess = KTX_LoadMips( job->apStream->aPath.c_str(), job->aFirstMip, job->aMips );
+
+		std::lock_guard< std::mutex > lock( gStreamMutex );
+		gStreamDone.push_back( job );
+	}
+}
+
+
+// Creates an image for mips srMips.aFirstMip to the end of the chain, and a staging buffer with the mip data
+static void VK_StreamCreateImage( TextureStream_t* spStream, const TextureMipData_t& srMips, TextureStreamUpload_t& srUpload )
+{
+	glm::uvec2        size = VK_StreamGetMipSize( srMips.aBaseSize, srMips.aFirstMip );
+
+	VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+	imageInfo.format        = srMips.aFormat;
+	imageInfo.extent        = { size.x, size.y, 1 };
+	imageInfo.mipLevels     = srMips.aMipCount - srMips.aFirstMip;
+	imageInfo.arrayLayers   = 1;
+	imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage         = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// VK_CreateImage() fills in the image and memory of a texture, so use a temporary one
+	TextureVK image{};
+	image.name.data = spStream->aPath.data();
+	image.name.size = spStream->aPath.size();
+
+	VK_CreateImage( imageInfo, &image );
+
+	srUpload.apStream       = spStream;
+	srUpload.aFirstMip      = srMips.aFirstMip;
+	srUpload.aImage         = image.aImage;
+	srUpload.aMemory        = image.aMemory;
+	srUpload.aMemorySize    = image.aMemorySize;
+
+	srUpload.aStaging       = {};
+	srUpload.aStaging.aSize = srMips.aDataSize;
+
+	VK_CreateBuffer( "Texture Stream Staging", &srUpload.aStaging, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT );
+	VK_memcpy( srUpload.aStaging.aMemory, srMips.aDataSize, srMips.apData );
+}
+
+
+static void VK_StreamRecordUpload( VkCommandBuffer c, const TextureMipData_t& srMips, TextureStreamUpload_t& srUpload )
+{
+	u32                     mipLevels = srMips.aMipCount - srMips.aFirstMip;
+	VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+
+	VK_SetImageLayout( c, srUpload.aImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range );
+
+	VkBufferImageCopy regions[ CH_TEXTURE_MAX_MIPS ]{};
+
+	for ( u8 mip = srMips.aFirstMip; mip < srMips.aMipCount; mip++ )
+	{
+		glm::uvec2         mipSize = VK_StreamGetMipSize( srMips.aBaseSize, mip );
+		VkBufferImageCopy& region  = regions[ mip - srMips.aFirstMip ];
+
+		region.bufferOffset        = srMips.aOffsets[ mip ];
+		region.imageSubresource    = { VK_IMAGE_ASPECT_COLOR_BIT, (u32)( mip - srMips.aFirstMip ), 0, 1 };
+		region.imageExtent         = { mipSize.x, mipSize.y, 1 };
+	}
+
+	vkCmdCopyBufferToImage( c, srUpload.aStaging.aBuffer, srUpload.aImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, regions );
+
+	VK_SetImageLayout( c, srUpload.aImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, range );
+}
+
+
+static void VK_StreamFreeUpload( TextureStreamUpload_t& srUpload, bool sFreeImage )
+{
+	VK_DestroyBuffer( &srUpload.aStaging );
+
+	if ( srUpload.aCmd )
+		vkFreeCommandBuffers( VK_GetDevice(), gStreamCmdPool, 1, &srUpload.aCmd );
+
+	if ( srUpload.aFence )
+		vkDestroyFence( VK_GetDevice(), srUpload.aFence, nullptr );
+
+	if ( !sFreeImage )
+		return;
+
+	vkDestroyImage( VK_GetDevice(), srUpload.aImage, nullptr );
+	vkFreeMemory( VK_GetDevice(), srUpload.aMemory, nullptr );
+}
+
+
+// Replaces the image of the texture with a finished upload, the old image is kept around until nothing in flight can be using it
+static void VK_StreamSwapImage( TextureStream_t* spStream, TextureStreamUpload_t& srUpload )
+{
+	TextureVK* tex = spStream->apTexture;
+
+	if ( tex->aImage )
+	{
+		gStreamRetired.push_back( { tex->aImage, tex->aImageView, tex->aMemory, gStreamFrame } );
+		gStreamResidentBytes -= tex->aMemorySize;
+	}
+
+	tex->aImage      = srUpload.aImage;
+	tex->aMemory     = srUpload.aMemory;
+	tex->aMemorySize = srUpload.aMemorySize;
+	tex->aMipLevels  = spStream->aMipCount - srUpload.aFirstMip;
+
+	VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	viewInfo.image                           = tex->aImage;
+	viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format                          = tex->aFormat;
+	viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.baseMipLevel   = 0;
+	viewInfo.subresourceRange.levelCount     = tex->aMipLevels;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount     = 1;
+
+	VK_CheckResult( vkCreateImageView( VK_GetDevice(), &viewInfo, nullptr, &tex->aImageView ), "Failed to create Image View" );
+
+	VK_SetObjectName( VK_OBJECT_TYPE_IMAGE_VIEW, (u64)tex->aImageView, spStream->aPath.c_str() );
+
+	gStreamResidentBytes += tex->aMemorySize;
+	spStream->aResidentMip = srUpload.aFirstMip;
+
+	// frames in flight still sample the old view through the current slot, so the new view gets its own
+	VK_MoveTextureSlot( tex );
+}
+
+
+// Uploads mips and waits for it, only used when loading a texture or when it has to be fully resident right now
+static void VK_StreamUploadNow( TextureStream_t* spStream, const TextureMipData_t& srMips )
+{
+	TextureStreamUpload_t upload{};
+	VK_StreamCreateImage( spStream, srMips, upload );
+
+	VkCommandBuffer c = VK_BeginOneTimeCommand();
+	VK_StreamRecordUpload( c, srMips, upload );
+	VK_EndOneTimeCommand( c );
+
+	VK_StreamFreeUpload( upload, false );
+	VK_StreamSwapImage( spStream, upload );
+}
+
+
+// Uploads mips on the graphics queue with a fence, VK_StreamUpdate() swaps the image in once it's signaled
+static void VK_StreamSubmitUpload( TextureStream_t* spStream, const TextureMipData_t& srMips )
+{
+	TextureStreamUpload_t upload{};
+	VK_StreamCreateImage( spStream, srMips, upload );
+
+	VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	allocInfo.commandPool        = gStreamCmdPool;
+	allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	VK_CheckResult( vkAllocateCommandBuffers( VK_GetDevice(), &allocInfo, &upload.aCmd ), "Failed to allocate texture stream command buffer" );
+
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	VK_CheckResult( vkBeginCommandBuffer( upload.aCmd, &beginInfo ), "Failed to begin command buffer!" );
+	VK_StreamRecordUpload( upload.aCmd, srMips, upload );
+	VK_CheckResult( vkEndCommandBuffer( upload.aCmd ), "Failed to end command buffer!" );
+
+	VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	VK_CheckResult( vkCreateFence( VK_GetDevice(), &fenceInfo, nullptr, &upload.aFence ), "Failed to create texture stream fence" );
+
+	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers    = &upload.aCmd;
+
+	gGraphicsMutex.lock();
+	VK_CheckResult( vkQueueSubmit( VK_GetGraphicsQueue(), 1, &submitInfo, upload.aFence ), "Failed to submit texture stream upload" );
+	gGraphicsMutex.unlock();
+
+	spStream->aLoadingMip = srMips.aFirstMip;
+	gStreamUploads.push_back( upload );
+}
+
+
+// Drops a texture back down to the mips it was loaded with
+static void VK_StreamEvict( TextureStream_t* spStream )
+{
+	VK_StreamSubmitUpload( spStream, spStream->aLowMips );
+
+	gStreamEvictedFrame++;
+	gStreamEvictedTotal++;
+}
+
+
+// ----------------------------------------------------------------
+
+
+void VK_StreamInit()
+{
+	VK_CreateCommandPool( gStreamCmdPool, gGraphicsAPIData.aQueueFamilyGraphics );
+
+	gStreamRunning = true;
+
+	for ( int i = 0; i < r_texture_stream_threads; i++ )
+		gStreamThreads.emplace_back( VK_StreamWorker );
+}
+
+
+void VK_StreamShutdown()
+{
+	{
+		std::lock_guard< std::mutex > lock( gStreamMutex );
+		gStreamRunning = false;
+	}
+
+	gStreamWake.notify_all();
+
+	for ( std::thread& thread : gStreamThreads )
+		thread.join();
+
+	gStreamThreads.clear();
+
+	// streams freed while loading are only referenced by their load
+	auto freeJobs = []( std::vector< TextureStreamJob_t* >& srJobs )
+	{
+		for ( TextureStreamJob_t* job : srJobs )
+		{
+			if ( job->apStream->aDestroyed )
+				VK_StreamFree( job->apStream );
+
+			VK_StreamFreeJob( job );
+		}
+
+		srJobs.clear();
+	};
+
+	freeJobs( gStreamQueue );
+	freeJobs( gStreamDone );
+	freeJobs( gStreamLoaded );
+
+	for ( TextureStreamUpload_t& upload : gStreamUploads )
+	{
+		vkWaitForFences( VK_GetDevice(), 1, &upload.aFence, VK_TRUE, UINT64_MAX );
+
+		if ( upload.apStream->aDestroyed )
+			VK_StreamFree( upload.apStream );
+
+		VK_StreamFreeUpload( upload, true );
+	}
+
+	gStreamUploads.clear();
+
+	for ( RetiredStreamImage_t& retired : gStreamRetired )
+	{
+		vkDestroyImageView( VK_GetDevice(), retired.aImageView, nullptr );
+		vkDestroyImage( VK_GetDevice(), retired.aImage, nullptr );
+		vkFreeMemory( VK_GetDevice(), retired.aMemory, nullptr );
+	}
+
+	gStreamRetired.clear();
+
+	// the textures themselves are destroyed with the rest of them
+	for ( TextureStream_t* stream : gStreams )
+	{
+		stream->apTexture->apStream = nullptr;
+		VK_StreamFree( stream );
+	}
+
+	gStreams.clear();
+	gStreamPendingJobs   = 0;
+	gStreamResidentBytes = 0;
+
+	VK_DestroyCommandPool( gStreamCmdPool );
+}
+
+
+u8 VK_StreamGetLoadMip( glm::uvec2 sSize, u8 sMipCount, VkFormat sFormat )
+{
+	// uncompressed mips might have row padding in the file, which the upload doesn't handle
+	if ( !r_texture_stream || sFormat == VK_FORMAT_UNDEFINED || !VK_IsCompressedFormat( sFormat ) )
+		return 0;
+
+	u32 size = std::max( sSize.x, sSize.y );
+	u8  mip  = 0;
+
+	while ( mip + 1 < sMipCount && ( size >> mip ) > (u32)r_texture_stream_min_size )
+		mip++;
+
+	return mip;
+}
+
+
+bool VK_StreamCreateTexture( TextureVK* spTexture, const char* spPath, TextureMipData_t& srMips )
+{
+	if ( srMips.aFormat == VK_FORMAT_UNDEFINED || srMips.aFirstMip == 0 )
+		return false;
+
+	// the image is made here, anything left over from a texture reload was already destroyed
+	spTexture->aImage       = VK_NULL_HANDLE;
+	spTexture->aImageView   = VK_NULL_HANDLE;
+	spTexture->aMemory      = VK_NULL_HANDLE;
+	spTexture->aMemorySize  = 0;
+
+	TextureStream_t* stream = new TextureStream_t;
+	stream->apTexture       = spTexture;
+	stream->aPath           = spPath;
+	stream->aLowMips        = srMips;
+	stream->aMipCount       = srMips.aMipCount;
+	stream->aLowestMip      = srMips.aFirstMip;
+	stream->aResidentMip    = srMips.aFirstMip;
+	stream->aWantedMip      = srMips.aFirstMip;
+	stream->aLastUsedFrame  = gStreamFrame;
+
+	spTexture->aSize        = srMips.aBaseSize;
+	spTexture->aFormat      = srMips.aFormat;
+	spTexture->aViewType    = VK_IMAGE_VIEW_TYPE_2D;
+	spTexture->aFrames      = 1;
+	spTexture->aUsage       = VK_IMAGE_USAGE_SAMPLED_BIT;
+	spTexture->aDataSize    = VK_StreamGetBytes( stream, 0 );
+	spTexture->apStream     = stream;
+
+	VK_StreamUploadNow( stream, srMips );
+
+	gStreams.push_back( stream );
+	return true;
+}
+
+
+void VK_StreamRemoveTexture( TextureVK* spTexture )
+{
+	TextureStream_t* stream = spTexture->apStream;
+
+	if ( !stream )
+		return;
+
+	vec_remove_if( gStreams, stream );
+
+	// the caller destroys the image
+	gStreamResidentBytes -= spTexture->aMemorySize;
+	spTexture->apStream   = nullptr;
+	stream->apTexture     = nullptr;
+
+	if ( stream->aLoadingMip != CH_STREAM_NO_MIP )
+		stream->aDestroyed = true;
+	else
+		VK_StreamFree( stream );
+}
+
+
+void VK_StreamRequest( TextureVK* spTexture, u32 sScreenSize )
+{
+	TextureStream_t* stream = spTexture->apStream;
+
+	if ( !stream )
+		return;
+
+	stream->aLastUsedFrame = gStreamFrame;
+
+	if ( sScreenSize == 0 )
+		return;
+
+	// the mip that's at least as big as the texture is on screen
+	u32   baseSize = std::max( stream->aLowMips.aBaseSize.x, stream->aLowMips.aBaseSize.y );
+	float mip      = std::log2( (float)baseSize / (float)sScreenSize ) + r_texture_stream_bias;
+	u8    wanted   = (u8)std::clamp( (int)std::floor( mip ), 0, (int)stream->aLowestMip );
+
+	stream->aWantedMip = std::min( stream->aWantedMip, wanted );
+}
+
+
+// Used by textures given to ImGui, it keeps a copy of the image view we can't swap out
+void VK_StreamPinTexture( TextureVK* spTexture )
+{
+	TextureStream_t* stream = spTexture->apStream;
+
+	if ( !stream || stream->aPinned )
+		return;
+
+	stream->aPinned = true;
+
+	if ( stream->aResidentMip == 0 )
+		return;
+
+	TextureMipData_t mips;
+	if ( !KTX_LoadMips( stream->aPath.c_str(), 0, mips ) )
+	{
+		Log_ErrorF( gLC_Render, "Failed to load all mips of streamed texture: \"%s\"\n", stream->aPath.c_str() );
+		return;
+	}
+
+	VK_StreamUploadNow( stream, mips );
+	ch_free( mips.apData );
+}
+
+
+struct StreamWant_t
+{
+	TextureStream_t* apStream;
+	u8               aMip;
+};
+
+
+// Called once a frame before the texture slots are written
+void VK_StreamUpdate()
+{
+	PROF_SCOPE();
+
+	gStreamEvictedFrame = 0;
+
+	// destroy old images nothing in flight can be using anymore
+	size_t retired = 0;
+	for ( size_t i = 0; i < gStreamRetired.size(); i++ )
+	{
+		RetiredStreamImage_t& image = gStreamRetired[ i ];
+
+		if ( gStreamFrame - image.aFrame < CH_STREAM_RETIRE_FRAMES )
+		{
+			gStreamRetired[ retired++ ] = image;
+			continue;
+		}
+
+		vkDestroyImageView( VK_GetDevice(), image.aImageView, nullptr );
+		vkDestroyImage( VK_GetDevice(), image.aImage, nullptr );
+		vkFreeMemory( VK_GetDevice(), image.aMemory, nullptr );
+	}
+
+	gStreamRetired.resize( retired );
+
+	// swap in the uploads that finished
+	for ( size_t i = 0; i < gStreamUploads.size(); )
+	{
+		TextureStreamUpload_t& upload = gStreamUploads[ i ];
+
+		if ( vkGetFenceStatus( VK_GetDevice(), upload.aFence ) != VK_SUCCESS )
+		{
+			i++;
+			continue;
+		}
+
+		TextureStream_t* stream = upload.apStream;
+
+		// pinned textures were made fully resident while this was in flight
+		bool             swap   = !stream->aDestroyed && !stream->aPinned;
+
+		if ( swap )
+			VK_StreamSwapImage( stream, upload );
+
+		VK_StreamFreeUpload( upload, !swap );
+		gStreamUploads.erase( gStreamUploads.begin() + i );
+
+		if ( stream->aDestroyed )
+			VK_StreamFree( stream );
+		else
+			stream->aLoadingMip = CH_STREAM_NO_MIP;
+	}
+
+	// start uploading mips the workers finished loading
+	{
+		std::lock_guard< std::mutex > lock( gStreamMutex );
+		gStreamLoaded.insert( gStreamLoaded.end(), gStreamDone.begin(), gStreamDone.end() );
+		gStreamDone.clear();
+	}
+
+	size_t loaded = 0;
+	for ( ; loaded < gStreamLoaded.size() && loaded < (size_t)r_texture_stream_uploads; loaded++ )
+	{
+		TextureStreamJob_t* job    = gStreamLoaded[ loaded ];
+		TextureStream_t*    stream = job->apStream;
+
+		gStreamPendingJobs--;
+
+		if ( stream->aDestroyed )
+		{
+			VK_StreamFree( stream );
+		}
+		else if ( !job->aSuccess )
+		{
+			Log_ErrorF( gLC_Render, "Failed to stream mips of texture: \"%s\"\n", stream->aPath.c_str() );
+			stream->aFailed     = true;
+			stream->aLoadingMip = CH_STREAM_NO_MIP;
+		}
+		else if ( stream->aPinned )
+		{
+			stream->aLoadingMip = CH_STREAM_NO_MIP;
+		}
+		else
+		{
+			VK_StreamSubmitUpload( stream, job->aMips );
+		}
+
+		VK_StreamFreeJob( job );
+	}
+
+	gStreamLoaded.erase( gStreamLoaded.begin(), gStreamLoaded.begin() + loaded );
+
+	// find what wants more detail, and what can be evicted
+	u64                             budget    = (u64)r_texture_stream_budget * 1024 * 1024;
+	u64                             projected = 0;  // memory used once everything in flight is done
+	std::vector< StreamWant_t >     wants;
+	std::vector< TextureStream_t* > evictable;
+
+	for ( TextureStream_t* stream : gStreams )
+	{
+		u8 wanted          = stream->aWantedMip;
+		stream->aWantedMip = stream->aLowestMip;
+
+		projected += VK_StreamGetBytes( stream, stream->aLoadingMip != CH_STREAM_NO_MIP ? stream->aLoadingMip : stream->aResidentMip );
+
+		if ( stream->aPinned || stream->aFailed || stream->aLoadingMip != CH_STREAM_NO_MIP )
+			continue;
+
+		if ( stream->aLastUsedFrame == gStreamFrame )
+		{
+			if ( wanted < stream->aResidentMip )
+				wants.push_back( { stream, wanted } );
+		}
+		else if ( stream->aResidentMip < stream->aLowestMip && gStreamFrame - stream->aLastUsedFrame >= (u32)r_texture_stream_idle_frames )
+		{
+			evictable.push_back( stream );
+		}
+	}
+
+	// least recently used first
+	std::sort( evictable.begin(), evictable.end(), []( TextureStream_t* a, TextureStream_t* b )
+	           { return a->aLastUsedFrame < b->aLastUsedFrame; } );
+
+	size_t evictIndex = 0;
+
+	// evicts until sBytes more fits in the budget
+	auto   makeRoom   = [ & ]( u64 sBytes )
+	{
+		while ( projected + sBytes > budget && evictIndex < evictable.size() )
+		{
+			TextureStream_t* stream = evictable[ evictIndex++ ];
+			projected -= VK_StreamGetBytes( stream, stream->aResidentMip ) - VK_StreamGetBytes( stream, stream->aLowestMip );
+			VK_StreamEvict( stream );
+		}
+
+		return projected + sBytes <= budget;
+	};
+
+	// the budget might have been lowered
+	makeRoom( 0 );
+
+	// the textures missing the most detail go first
+	std::sort( wants.begin(), wants.end(), []( const StreamWant_t& a, const StreamWant_t& b )
+	           { return a.apStream->aResidentMip - a.aMip > b.apStream->aResidentMip - b.aMip; } );
+
+	std::vector< TextureStreamJob_t* > jobs;
+
+	for ( StreamWant_t& want : wants )
+	{
+		if ( gStreamPendingJobs + jobs.size() >= (u32)r_texture_stream_max_loads )
+			break;
+
+		TextureStream_t* stream   = want.apStream;
+		u64              resident = VK_StreamGetBytes( stream, stream->aResidentMip );
+		u8               mip      = want.aMip;
+
+		// settle for less detail if it doesn't fit
+		for ( ; mip < stream->aResidentMip; mip++ )
+		{
+			if ( makeRoom( VK_StreamGetBytes( stream, mip ) - resident ) )
+				break;
+		}
+
+		if ( mip >= stream->aResidentMip )
+			continue;
+
+		projected += VK_StreamGetBytes( stream, mip ) - resident;
+		stream->aLoadingMip = mip;
+
+		TextureStreamJob_t* job = new TextureStreamJob_t;
+		job->apStream           = stream;
+		job->aFirstMip          = mip;
+		jobs.push_back( job );
+	}
+
+	if ( jobs.size() )
+	{
+		gStreamPendingJobs += jobs.size();
+
+		{
+			std::lock_guard< std::mutex > lock( gStreamMutex );
+			gStreamQueue.insert( gStreamQueue.end(), jobs.begin(), jobs.end() );
+		}
+
+		gStreamWake.notify_all();
+	}
+
+	gStreamFrame++;
+}
+
+
+void VK_GetTextureStreamStats( TextureStreamStats_t& srStats )
+{
+	srStats                   = {};
+	srStats.aStreamedTextures = gStreams.size();
+	srStats.aPendingLoads     = gStreamPendingJobs + gStreamUploads.size();
+	srStats.aEvictedThisFrame = gStreamEvictedFrame;
+	srStats.aEvictedTotal     = gStreamEvictedTotal;
+	srStats.aResidentBytes    = gStreamResidentBytes;
+	srStats.aBudgetBytes      = (u64)r_texture_stream_budget * 1024 * 1024;
+
+	for ( TextureStream_t* stream : gStreams )
+	{
+		if ( stream->aResidentMip == 0 )
+			srStats.aFullyResident++;
+
+		srStats.aFullBytes += VK_StreamGetBytes( stream, 0 );
+	}
+}
+
+
+CONCMD_VA( r_texture_stream_dump, "Print the resident mips of every streamed texture" )
+{
+	for ( TextureStream_t* stream : gStreams )
+	{
+		glm::uvec2 size = VK_StreamGetMipSize( stream->aLowMips.aBaseSize, stream->aResidentMip );
+
+		Log_MsgF( gLC_Render, "%4u x %-4u  Mip %u/%u  Last Seen %u Frames Ago%s - %s\n",
+		          size.x, size.y, stream->aResidentMip, stream->aMipCount, gStreamFrame - stream->aLastUsedFrame,
+		          stream->aPinned ? "  (Pinned)" : "", stream->aPath.c_str() );
+	}
+
+	TextureStreamStats_t stats;
+	VK_GetTextureStreamStats( stats );
+
+	Log_MsgF( gLC_Render, "%u Streamed Textures, %u Fully Resident, %u Loading\n", stats.aStreamedTextures, stats.aFullyResident, stats.aPendingLoads );
+	Log_MsgF( gLC_Render, "Resident: %.2f MB / %.2f MB Budget (%.2f MB with every mip)\n",
+	          ch_bytes_to_mb( stats.aResidentBytes ), ch_bytes_to_mb( stats.aBudgetBytes ), ch_bytes_to_mb( stats.aFullBytes ) );
+}
@@ -69,6 +69,9 @@ class GraphicsData final : public IGraphicsData
 	ch_string     material_get_string( ch_material_h handle, const char* var_name, const char* fallback ) override;
 	float         material_get_float( ch_material_h handle, const char* var_name, float fallback ) override;
 
+	ch_string     material_get_string( ch_material_h handle, ch_str_id var_name, const char* fallback ) override;
+	float         material_get_float( ch_material_h handle, ch_str_id var_name, float fallback ) override;
+
 	// --------------------------------------------------------------------------------------------
 	// Models - TODO: Have models load async, or on a job
 	// --------------------------------------------------------------------------------------------
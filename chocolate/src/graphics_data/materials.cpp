@@ -7,9 +7,6 @@
 ChVector< ch_material_h >            g_materials_dirty;
 u32                                  g_material_count;
 
-// stored pointers to material var names
-std::unordered_map< u64, ch_string > g_material_var_names;
-
 
 #if 0
 // store list of material var strings, so we don't have 1000 duplicated strings
@@ -140,6 +137,7 @@ void GraphicsData::material_free( ch_material_h handle )
 	}
 
 	free( material->name );
+	free( material->name_id );
 	free( material->var );
 	free( material->type );
 
@@ -289,19 +287,21 @@ void GraphicsData::material_mark_dirty( ch_material_h handle )
 
 bool material_data_resize( material_t* material, size_t count )
 {
-	auto new_var = ch_realloc( material->var, count );
-	auto new_name = ch_realloc( material->name, count );
-	auto new_type = ch_realloc( material->type, count );
+	auto new_var     = ch_realloc( material->var, count );
+	auto new_name    = ch_realloc( material->name, count );
+	auto new_name_id = ch_realloc( material->name_id, count );
+	auto new_type    = ch_realloc( material->type, count );
 
-	if ( !new_var || !new_name || !new_type )
+	if ( !new_var || !new_name || !new_name_id || !new_type )
 	{
 		Log_Error( gLC_GraphicsData, "Failed to reallocate data for material\n" );
 		return false;
 	}
 
-	material->var  = new_var;
-	material->name = new_name;
-	material->type = new_type;
+	material->var     = new_var;
+	material->name    = new_name;
+	material->name_id = new_name_id;
+	material->type    = new_type;
 
 	return true;
 }
@@ -321,6 +321,12 @@ bool material_data_extend( material_t* material, size_t count )
 		return false;
 	}
 
+	if ( util_array_extend( material->name_id, material->count, count ) )
+	{
+		Log_Error( gLC_GraphicsData, "Failed to allocate more data for material\n" );
+		return false;
+	}
+
 	if ( util_array_extend( material->type, material->count, count ) )
 	{
 		Log_Error( gLC_GraphicsData, "Failed to allocate more data for material\n" );
@@ -358,40 +364,16 @@ u16 material_handle_var_name_index( const char* var_name )
 #endif
 
 
-static ch_string material_get_var_name_ptr( const char* var_name )
-{
-	size_t var_name_len = strlen( var_name );
-	u64    hash         = ch_str_hash( var_name, var_name_len );
-	auto   find         = g_material_var_names.find( hash );
-
-	if ( find == g_material_var_names.end() )
-	{
-		ch_string new_string = ch_str_copy( var_name, var_name_len );
-		g_material_var_names[ hash ] = new_string;
-		return new_string;
-	}
-
-	return find->second;
-}
-
-
-#if 0
-ch_string material_handle_var_name( const char* var_name )
+// var names are interned, so every material shares one copy of each name
+static ch_str_id material_intern_var_name( const char* var_name )
 {
-	size_t var_name_len = strlen( var_name );
-	u64    hash         = ch_str_hash( var_name, var_name_len );
-	auto   find         = g_material_var_names.find( hash );
+	ch_str_id id = ch_str_intern( var_name );
 
-	if ( find == g_material_var_names.end() )
-	{
-		ch_string new_string         = ch_str_copy( var_name, var_name_len );
-		g_material_var_names[ hash ] = new_string;
-		return new_string;
-	}
+	if ( id == CH_STR_ID_INVALID )
+		Log_ErrorF( gLC_GraphicsData, "Failed to intern material var name \"%s\"\n", var_name );
 
-	return *find;
+	return id;
 }
-#endif
 
 
 bool GraphicsData::material_set_string( ch_material_h handle, const char* var_name, const char* value )
@@ -404,7 +386,10 @@ bool GraphicsData::material_set_string( ch_material_h handle, const char* var_na
 		return false;
 	}
 
-	ch_string var_name_ptr = material_get_var_name_ptr( var_name );
+	ch_str_id var_name_id = material_intern_var_name( var_name );
+
+	if ( var_name_id == CH_STR_ID_INVALID )
+		return false;
 
 //	#error get existing material var index
 
@@ -414,7 +399,8 @@ bool GraphicsData::material_set_string( ch_material_h handle, const char* var_na
 		return false;
 	}
 
-	material->name[ material->count ]           = var_name_ptr;
+	material->name[ material->count ]           = ch_str_intern_get( var_name_id );
+	material->name_id[ material->count ]        = var_name_id;
 	material->var[ material->count ].val_string = ch_str_copy( value );
 	material->type[ material->count ]           = e_mat_var_string;
 
@@ -434,7 +420,10 @@ bool GraphicsData::material_set_float( ch_material_h handle, const char* var_nam
 		return false;
 	}
 
-	ch_string var_name_ptr = material_get_var_name_ptr( var_name );
+	ch_str_id var_name_id = material_intern_var_name( var_name );
+
+	if ( var_name_id == CH_STR_ID_INVALID )
+		return false;
 
 	if ( !material_data_extend( material, 1 ) )
 	{
@@ -442,7 +431,8 @@ bool GraphicsData::material_set_float( ch_material_h handle, const char* var_nam
 		return false;
 	}
 
-	material->name[ material->count ]          = var_name_ptr;
+	material->name[ material->count ]          = ch_str_intern_get( var_name_id );
+	material->name_id[ material->count ]       = var_name_id;
 	material->var[ material->count ].val_float = value;
 	material->type[ material->count ]          = e_mat_var_float;
 
@@ -456,19 +446,17 @@ bool GraphicsData::material_set_float( ch_material_h handle, const char* var_nam
 // Variable Getting
 
 
-size_t material_get_var_index( material_t* material, const char* var_name, e_mat_var type )
+size_t material_get_var_index( material_t* material, ch_str_id var_name, e_mat_var type )
 {
-	size_t var_name_len   = strlen( var_name );
-
 	// find the index in the var name array
 	for ( size_t i = 0; i < material->count; i++ )
 	{
-		if ( !ch_str_equals( material->name[ i ], var_name, var_name_len ) )
+		if ( material->name_id[ i ] != var_name )
 			continue;
 
 		if ( material->type[ i ] != type )
 		{
-			Log_ErrorF( gLC_GraphicsData, "Material variable \"%s\" is not the correct type\n", var_name );
+			Log_ErrorF( gLC_GraphicsData, "Material variable \"%s\" is not the correct type\n", material->name[ i ].data );
 			return SIZE_MAX;
 		}
 
@@ -479,6 +467,20 @@ size_t material_get_var_index( material_t* material, const char* var_name, e_mat
 }
 
 
+size_t material_get_var_index( material_t* material, const char* var_name, e_mat_var type )
+{
+	size_t    var_name_len = strlen( var_name );
+	ch_str_id var_name_id  = (ch_str_id)ch_hash_fnv1a_32( var_name, var_name_len );
+	size_t    index        = material_get_var_index( material, var_name_id, type );
+
+	// var names are interned, so the only way the name can be different is a hash collision with a name that isn't
+	if ( index != SIZE_MAX && !ch_str_equals( material->name[ index ], var_name, var_name_len ) )
+		return SIZE_MAX;
+
+	return index;
+}
+
+
 ch_string GraphicsData::material_get_string( ch_material_h handle, const char* var_name, const char* fallback )
 {
 	material_t* material = g_materials.get( handle );
@@ -491,7 +493,7 @@ ch_string GraphicsData::material_get_string( ch_material_h handle, const char* v
 
 	size_t var_index = material_get_var_index( material, var_name, e_mat_var_string );
 
-	if ( var_index == UINT16_MAX )
+	if ( var_index == SIZE_MAX )
 	{
 		Log_ErrorF( gLC_GraphicsData, "material_get_string: Failed to find variable \"%s\"\n", var_name );
 		return ch_string( (char*)fallback, strlen( fallback ) );
@@ -513,7 +515,7 @@ float GraphicsData::material_get_float( ch_material_h handle, const char* var_na
 
 	size_t var_index = material_get_var_index( material, var_name, e_mat_var_float );
 
-	if ( var_index == UINT16_MAX )
+	if ( var_index == SIZE_MAX )
 	{
 		Log_ErrorF( gLC_GraphicsData, "material_get_float: Failed to find variable \"%s\"\n", var_name );
 		return fallback;
@@ -523,4 +525,48 @@ float GraphicsData::material_get_float( ch_material_h handle, const char* var_na
 }
 
 
+ch_string GraphicsData::material_get_string( ch_material_h handle, ch_str_id var_name, const char* fallback )
+{
+	material_t* material = g_materials.get( handle );
+
+	if ( !material )
+	{
+		Log_Error( gLC_GraphicsData, "material_get_string: Failed to find material\n" );
+		return ch_string( (char*)fallback, strlen( fallback ) );
+	}
+
+	size_t var_index = material_get_var_index( material, var_name, e_mat_var_string );
+
+	if ( var_index == SIZE_MAX )
+	{
+		Log_ErrorF( gLC_GraphicsData, "material_get_string: Failed to find variable \"%s\"\n", ch_str_intern_get( var_name ).data );
+		return ch_string( (char*)fallback, strlen( fallback ) );
+	}
+
+	return material->var[ var_index ].val_string;
+}
+
+
+float GraphicsData::material_get_float( ch_material_h handle, ch_str_id var_name, float fallback )
+{
+	material_t* material = g_materials.get( handle );
+
+	if ( !material )
+	{
+		Log_Error( gLC_GraphicsData, "material_get_float: Failed to find material\n" );
+		return fallback;
+	}
+
+	size_t var_index = material_get_var_index( material, var_name, e_mat_var_float );
+
+	if ( var_index == SIZE_MAX )
+	{
+		Log_ErrorF( gLC_GraphicsData, "material_get_float: Failed to find variable \"%s\"\n", ch_str_intern_get( var_name ).data );
+		return fallback;
+	}
+
+	return material->var[ var_index ].val_float;
+}
+
+
 // material_get_var_array();
\ No newline at end of file
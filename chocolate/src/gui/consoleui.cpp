@@ -504,7 +504,7 @@ struct ConLogBuffer
 
 
 static std::vector< ConLogBuffer > gConHistory;
-static size_t gConHistoryIndex = 0;
+static u64 gConHistoryIndex = 0;
 
 // can and will be over this limit
 constexpr size_t CON_MAX_BUFFER_SIZE = 512;
@@ -546,46 +546,53 @@ void ReBuildConsoleOutput()
 	gConHistory.clear();
 	gConHistory.resize( 1 );
 
-	const std::vector< log_t >& logs = Log_GetLogHistory();
+	Log_LockHistory();
 
-	for ( const auto& log: logs )
+	u64 count = Log_GetHistoryCount();
+
+	for ( u64 i = Log_GetHistoryStart(); i < count; i++ )
 	{
+		const log_t* log = Log_GetHistoryLog( i );
+
 		// TODO: maybe make a separate array for logs that are visible, so we don't have to check this every time
-		if ( !Log_IsVisible( log ) )
+		if ( !Log_IsVisible( *log ) )
 			continue;
 
-		AddToConsoleOutput( &gConHistory.back(), log );
+		AddToConsoleOutput( &gConHistory.back(), *log );
 	}
 
-	gConHistoryIndex = logs.size();
+	Log_UnlockHistory();
+
+	gConHistoryIndex = count;
 }
 
 
 void UpdateConsoleOutput()
 {
-	const std::vector< log_t >& logs = Log_GetLogHistory();
-
-	if ( logs.empty() )
-		return;
-
 	if ( gConHistory.empty() )
 	{
 		ReBuildConsoleOutput();
 		return;
 	}
 
-	if ( gConHistoryIndex == logs.size() )
-		return;
+	Log_LockHistory();
+
+	u64 count = Log_GetHistoryCount();
 
-	for ( ; gConHistoryIndex < logs.size(); gConHistoryIndex++ )
+	// logs we haven't added yet were pushed out of the history
+	gConHistoryIndex = std::max( gConHistoryIndex, Log_GetHistoryStart() );
+
+	for ( ; gConHistoryIndex < count; gConHistoryIndex++ )
 	{
-		const log_t& log = logs[ gConHistoryIndex ];
+		const log_t* log = Log_GetHistoryLog( gConHistoryIndex );
 
-		if ( !Log_IsVisible( log ) )
+		if ( !Log_IsVisible( *log ) )
 			continue;
 
-		AddToConsoleOutput( &gConHistory.back(), log );
+		AddToConsoleOutput( &gConHistory.back(), *log );
 	}
+
+	Log_UnlockHistory();
 }
 
 
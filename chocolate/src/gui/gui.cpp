@@ -55,6 +55,8 @@ void GuiSystem::Update( float sDT )
 
 	wasConsoleOpen = aConsoleShown;
 
+	DrawProfiler();
+
 	if ( !ui_show_fps && !ui_show_messages )
 	{
 		prevtick = SDL_GetTicks();
@@ -24,6 +24,9 @@ class GuiSystem : public IGuiSystem
 	void                       DrawConVarList( bool wasOpen );
 	void                       InitConVarList();
 
+	/* Built in profiler timeline and stats */
+	void                       DrawProfiler();
+
 	/* Set to VGUI Style 😎 */
 	void    StyleImGui() override;
 
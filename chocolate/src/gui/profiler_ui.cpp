@@ -0,0 +1,222 @@
+#include "gui.h"
+#include "core/core.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+
+
+CONVAR_BOOL_NAME( ui_show_profiler, "ui.profiler.show", false, 0, "Show the built in profiler's timeline and stats" );
+
+
+constexpr float PROF_UI_ROW_HEIGHT = 18.f;
+
+
+static ImU32 Prof_UI_GetColor( const ch_prof_location_t* spLocation )
+{
+	// spread the colors out so scopes next to each other are easy to tell apart
+	u32   hash = (u32)( ( (uintptr_t)spLocation >> 4 ) * 2654435761u );
+	float hue  = ( hash % 360 ) / 360.f;
+
+	float r, g, b;
+	ImGui::ColorConvertHSVtoRGB( hue, 0.5f, 0.75f, r, g, b );
+	return ImGui::GetColorU32( ImVec4( r, g, b, 1.f ) );
+}
+
+
+static void Prof_UI_DrawTimeline( const ch_prof_frame_t& srFrame, float sZoom )
+{
+	u32 threadCount = Prof_GetThreadCount();
+
+	if ( threadCount == 0 || srFrame.aEnd <= srFrame.aStart )
+		return;
+
+	// how deep each thread goes, for the height of its lane
+	std::vector< u16 > threadDepth( threadCount, 0 );
+
+	for ( const ch_prof_event_t& event : srFrame.aEvents )
+	{
+		if ( event.aThread < threadCount )
+			threadDepth[ event.aThread ] = std::max< u16 >( threadDepth[ event.aThread ], event.aDepth + 1 );
+	}
+
+	float frameTime  = ( srFrame.aEnd - srFrame.aStart ) / 1000000.f;
+	float width      = std::max( ImGui::GetContentRegionAvail().x, 100.f ) * sZoom;
+	float nsToPixels = width / ( srFrame.aEnd - srFrame.aStart );
+
+	ImGui::Text( "Frame: %.3f ms, %zu scopes", frameTime, srFrame.aEvents.size() );
+
+	ImGui::BeginChild( "Profiler Timeline", ImVec2( 0, 300 ), true, ImGuiWindowFlags_HorizontalScrollbar );
+
+	ImDrawList* drawList  = ImGui::GetWindowDrawList();
+	ImVec2      origin    = ImGui::GetCursorScreenPos();
+	float       laneStart = 0.f;
+
+	std::vector< float > laneOffset( threadCount );
+
+	for ( u32 thread = 0; thread < threadCount; thread++ )
+	{
+		laneOffset[ thread ] = laneStart + PROF_UI_ROW_HEIGHT;
+
+		drawList->AddText( ImVec2( origin.x, origin.y + laneStart ), ImGui::GetColorU32( ImGuiCol_Text ), Prof_GetThreadName( thread ) );
+		laneStart += PROF_UI_ROW_HEIGHT * ( threadDepth[ thread ] + 1 ) + 4.f;
+	}
+
+	const ch_prof_event_t* hovered = nullptr;
+	ImVec2                 mouse   = ImGui::GetMousePos();
+	bool                   isHover = ImGui::IsWindowHovered();
+
+	for ( const ch_prof_event_t& event : srFrame.aEvents )
+	{
+		if ( event.aThread >= threadCount )
+			continue;
+
+		// scopes from before this frame started get cut off at the start
+		u64    start = std::max( event.aStart, srFrame.aStart );
+		float  x0    = origin.x + ( start - srFrame.aStart ) * nsToPixels;
+		float  x1    = origin.x + ( event.aEnd - srFrame.aStart ) * nsToPixels;
+		float  y0    = origin.y + laneOffset[ event.aThread ] + event.aDepth * PROF_UI_ROW_HEIGHT;
+
+		ImVec2 min( x0, y0 );
+		ImVec2 max( std::max( x1, x0 + 1.f ), y0 + PROF_UI_ROW_HEIGHT - 1.f );
+
+		drawList->AddRectFilled( min, max, Prof_UI_GetColor( event.apLocation ) );
+
+		const char* name      = Prof_GetLocationName( event.apLocation );
+		ImVec2      nameSize  = ImGui::CalcTextSize( name );
+
+		if ( nameSize.x + 4.f < max.x - min.x )
+		{
+			drawList->PushClipRect( min, max, true );
+			drawList->AddText( ImVec2( min.x + 2.f, min.y + 1.f ), IM_COL32_BLACK, name );
+			drawList->PopClipRect();
+		}
+
+		if ( isHover && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y )
+			hovered = &event;
+	}
+
+	ImGui::Dummy( ImVec2( width, laneStart ) );
+
+	if ( hovered )
+	{
+		ImGui::BeginTooltip();
+		ImGui::TextUnformatted( Prof_GetLocationName( hovered->apLocation ) );
+		ImGui::Text( "%.4f ms", ( hovered->aEnd - hovered->aStart ) / 1000000.f );
+		ImGui::TextDisabled( "%s:%u", hovered->apLocation->apFile, hovered->apLocation->aLine );
+		ImGui::EndTooltip();
+	}
+
+	ImGui::EndChild();
+}
+
+
+static void Prof_UI_DrawStats()
+{
+	static std::vector< ch_prof_stats_t > stats;
+	stats.clear();
+	Prof_GetStats( stats );
+
+	std::sort( stats.begin(), stats.end(), []( const ch_prof_stats_t& left, const ch_prof_stats_t& right ) {
+		return left.aAvg > right.aAvg;
+	} );
+
+	if ( !ImGui::BeginTable( "Profiler Stats", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY ) )
+		return;
+
+	ImGui::TableSetupScrollFreeze( 0, 1 );
+	ImGui::TableSetupColumn( "Scope" );
+	ImGui::TableSetupColumn( "Calls" );
+	ImGui::TableSetupColumn( "Last" );
+	ImGui::TableSetupColumn( "Min" );
+	ImGui::TableSetupColumn( "Avg" );
+	ImGui::TableSetupColumn( "Max" );
+	ImGui::TableSetupColumn( "P99" );
+	ImGui::TableHeadersRow();
+
+	for ( const ch_prof_stats_t& scope : stats )
+	{
+		ImGui::TableNextRow();
+
+		ImGui::TableSetColumnIndex( 0 );
+		ImGui::TextUnformatted( Prof_GetLocationName( scope.apLocation ) );
+
+		if ( ImGui::IsItemHovered() )
+			ImGui::SetTooltip( "%s:%u\n%u frames", scope.apLocation->apFile, scope.apLocation->aLine, scope.aFrames );
+
+		ImGui::TableSetColumnIndex( 1 );
+		ImGui::Text( "%u", scope.aCalls );
+		ImGui::TableSetColumnIndex( 2 );
+		ImGui::Text( "%.3f", scope.aLast );
+		ImGui::TableSetColumnIndex( 3 );
+		ImGui::Text( "%.3f", scope.aMin );
+		ImGui::TableSetColumnIndex( 4 );
+		ImGui::Text( "%.3f", scope.aAvg );
+		ImGui::TableSetColumnIndex( 5 );
+		ImGui::Text( "%.3f", scope.aMax );
+		ImGui::TableSetColumnIndex( 6 );
+		ImGui::Text( "%.3f", scope.aP99 );
+	}
+
+	ImGui::EndTable();
+}
+
+
+void GuiSystem::DrawProfiler()
+{
+	PROF_SCOPE();
+
+	if ( !ui_show_profiler )
+		return;
+
+	bool open = true;
+
+	if ( !ImGui::Begin( "Profiler", &open ) )
+	{
+		ImGui::End();
+		return;
+	}
+
+	if ( !open )
+		Con_SetConVarValue( "ui.profiler.show", false );
+
+	// a copy of the frame being looked at, so it doesn't change under you
+	static ch_prof_frame_t pausedFrame;
+	static bool            paused     = false;
+	static int             frameIndex = 0;
+	static float           zoom       = 1.f;
+
+	if ( ImGui::Button( Prof_IsRunning() ? "Stop" : "Start" ) )
+	{
+		if ( Prof_IsRunning() )
+			Prof_Stop();
+		else
+			Prof_Start();
+	}
+
+	ImGui::SameLine();
+	ImGui::Checkbox( "Pause", &paused );
+
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth( 200.f );
+	ImGui::SliderInt( "Frames Ago", &frameIndex, 0, std::max< int >( Prof_GetFrameCount(), 1 ) - 1 );
+
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth( 150.f );
+	ImGui::SliderFloat( "Zoom", &zoom, 1.f, 50.f, "%.1fx", ImGuiSliderFlags_Logarithmic );
+
+	if ( !paused )
+	{
+		if ( const ch_prof_frame_t* frame = Prof_GetFrame( frameIndex ) )
+			pausedFrame = *frame;
+	}
+
+	if ( Prof_GetFrameCount() == 0 )
+		ImGui::TextUnformatted( "Nothing recorded yet, press Start or run prof_start" );
+	else
+		Prof_UI_DrawTimeline( pausedFrame, zoom );
+
+	Prof_UI_DrawStats();
+
+	ImGui::End();
+}
@@ -333,6 +333,9 @@ void Graphics_FreeQueuedResources()
 			// Free Vertex Data
 			if ( model->apVertexData )
 			{
+				if ( model->apVertexData->apSkinData )
+					free( model->apVertexData->apSkinData );
+
 				delete model->apVertexData;
 			}
 
@@ -357,11 +360,11 @@ void Graphics_FreeQueuedResources()
 					render->DestroyBuffer( model->apBuffers->aBlendShape );
 				}
 
-				// if ( model->apBuffers->aBlendShapeHandle != UINT32_MAX )
-				// {
-				// 	Graphics_RemoveShaderBuffer();
-				// 	render->DestroyBuffer( model->apBuffers->aSkin );
-				// }
+				if ( model->apBuffers->aSkinHandle != UINT32_MAX )
+				{
+					Graphics_RemoveShaderBuffer( gGraphicsData.aSkinBuffers, model->apBuffers->aSkinHandle );
+					render->DestroyBuffer( model->apBuffers->aSkin );
+				}
 
 				delete model->apBuffers;
 			}
@@ -1006,6 +1009,7 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 	gGraphicsData.aIndexBuffers.aBuffers.reserve( CH_R_MAX_INDEX_BUFFERS );
 	gGraphicsData.aBlendShapeWeightBuffers.aBuffers.reserve( CH_R_MAX_BLEND_SHAPE_WEIGHT_BUFFERS );
 	gGraphicsData.aBlendShapeDataBuffers.aBuffers.reserve( CH_R_MAX_BLEND_SHAPE_DATA_BUFFERS );
+	gGraphicsData.aSkinBuffers.aBuffers.reserve( CH_R_MAX_SKIN_BUFFERS );
 	
 	// ------------------------------------------------------
 	// Create Core Data Buffer
@@ -1031,6 +1035,32 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 	if ( !Graphics_CreateStagingBuffer( gGraphicsData.aRenderableStaging, sizeof( Shader_Renderable_t ) * CH_R_MAX_RENDERABLES, "Renderable Staging", "Renderable" ) )
 		return false;
 
+	// ------------------------------------------------------
+	// Create Light Cluster Buffer, only written to on the gpu
+
+	gGraphicsData.aLightClusterBuffer = render->CreateBuffer( "Light Clusters", sizeof( Buffer_LightClusters_t ), EBufferFlags_Storage | EBufferFlags_TransferSrc, EBufferMemory_Device );
+
+	if ( gGraphicsData.aLightClusterBuffer == CH_INVALID_HANDLE )
+	{
+		Log_Error( gLC_ClientGraphics, "Failed to Create Light Cluster Buffer\n" );
+		return false;
+	}
+
+	// ------------------------------------------------------
+	// Create Skinning Buffers, rewritten every frame something is skinned
+
+	gGraphicsData.aBonePaletteBuffer = render->CreateBuffer( "Bone Palette", sizeof( ShaderBoneMatrix_t ) * CH_R_MAX_BONES, EBufferFlags_Storage, EBufferMemory_Host );
+	gGraphicsData.aSkinningJobBuffer = render->CreateBuffer( "Skinning Jobs", sizeof( ShaderSkinningJob_t ) * CH_R_MAX_RENDERABLES, EBufferFlags_Storage, EBufferMemory_Host );
+
+	if ( gGraphicsData.aBonePaletteBuffer == CH_INVALID_HANDLE || gGraphicsData.aSkinningJobBuffer == CH_INVALID_HANDLE )
+	{
+		Log_Error( gLC_ClientGraphics, "Failed to Create Skinning Buffers\n" );
+		return false;
+	}
+
+	// write the skinning descriptor sets on the first frame
+	gGraphicsData.aSkinBuffers.aDirty = true;
+
 	// ------------------------------------------------------
 	// Create Core Descriptor Set
 	{
@@ -1042,6 +1072,7 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 		texBinding.aCount                        = CH_R_MAX_TEXTURES;
 		texBinding.aStages                       = ShaderStage_All;
 		texBinding.aType                         = EDescriptorType_CombinedImageSampler;
+		texBinding.aUpdateAfterBind              = true;
 
 		CreateDescBinding_t& validation          = createLayout.aBindings.emplace_back();
 		validation.aBinding                      = CH_BINDING_CORE;
@@ -1079,6 +1110,12 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 		indexBuffers.aStages                     = ShaderStage_All;
 		indexBuffers.aType                       = EDescriptorType_StorageBuffer;
 
+		CreateDescBinding_t& lightClusters       = createLayout.aBindings.emplace_back();
+		lightClusters.aBinding                   = CH_BINDING_LIGHT_CLUSTERS;
+		lightClusters.aCount                     = 1;
+		lightClusters.aStages                    = ShaderStage_All;
+		lightClusters.aType                      = EDescriptorType_StorageBuffer;
+
 		// TODO: this is for 2 swap chain images, but the swap chain image count could be different
 		gShaderDescriptorData.aGlobalSets.aCount = 2;
 		gShaderDescriptorData.aGlobalSets.apSets = ch_calloc< ch_handle_t >( gShaderDescriptorData.aGlobalSets.aCount );
@@ -1092,7 +1129,7 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 		update.aDescSetCount = gShaderDescriptorData.aGlobalSets.aCount;
 		update.apDescSets    = gShaderDescriptorData.aGlobalSets.apSets;
 
-		update.aBindingCount = static_cast< u32 >( createLayout.aBindings.size() - 2 );  // don't write anything for vertex and index buffers
+		update.aBindingCount = CH_BINDING_VERTEX_BUFFERS;  // don't write anything for vertex and index buffers, light clusters are written below
 		update.apBindings    = ch_calloc< WriteDescSetBinding_t >( update.aBindingCount );
 
 		size_t i             = 0;
@@ -1121,6 +1158,22 @@ bool Graphics_CreateDescriptorSets( ShaderRequirmentsList_t& srRequire )
 		free( update.apBindings );
 	}
 
+	{
+		WriteDescSetBinding_t binding{};
+		binding.aBinding     = CH_BINDING_LIGHT_CLUSTERS;
+		binding.aType        = EDescriptorType_StorageBuffer;
+		binding.aCount       = 1;
+		binding.apData       = &gGraphicsData.aLightClusterBuffer;
+
+		WriteDescSet_t update{};
+		update.aDescSetCount = gShaderDescriptorData.aGlobalSets.aCount;
+		update.apDescSets    = gShaderDescriptorData.aGlobalSets.apSets;
+		update.aBindingCount = 1;
+		update.apBindings    = &binding;
+
+		render->UpdateDescSets( &update, 1 );
+	}
+
 	render->SetTextureDescSet( gShaderDescriptorData.aGlobalSets.apSets, gShaderDescriptorData.aGlobalSets.aCount, 0 );
 
 	// ------------------------------------------------------
@@ -1336,9 +1389,9 @@ u32 Graphics_GetShaderBufferIndex( const ShaderBufferList_t& srBufferList, u32 s
 }
 
 
-void Graphics_OnTextureIndexUpdate()
+void Graphics_OnTextureIndexUpdate( ch_handle_t sTexture )
 {
-	gGraphics.SetAllMaterialsDirty();
+	Graphics_SetTextureMaterialsDirty( sTexture );
 }
 
 
@@ -1477,6 +1530,7 @@ void Graphics::Shutdown()
 		free( gGraphicsData.aViewportData );
 
 	// Free Buffers
+	Graphics_FreeBufferList( gGraphicsData.aSkinBuffers );
 	Graphics_FreeBufferList( gGraphicsData.aBlendShapeDataBuffers );
 	Graphics_FreeBufferList( gGraphicsData.aBlendShapeWeightBuffers );
 	Graphics_FreeBufferList( gGraphicsData.aIndexBuffers );
@@ -1487,6 +1541,20 @@ void Graphics::Shutdown()
 	Graphics_FreeBufferStaging( gGraphicsData.aRenderableStaging );
 	Graphics_FreeBufferStaging( gGraphicsData.aViewportStaging );
 
+	if ( gGraphicsData.aLightClusterBuffer )
+		render->DestroyBuffer( gGraphicsData.aLightClusterBuffer );
+
+	gGraphicsData.aLightClusterBuffer = CH_INVALID_HANDLE;
+
+	if ( gGraphicsData.aBonePaletteBuffer )
+		render->DestroyBuffer( gGraphicsData.aBonePaletteBuffer );
+
+	if ( gGraphicsData.aSkinningJobBuffer )
+		render->DestroyBuffer( gGraphicsData.aSkinningJobBuffer );
+
+	gGraphicsData.aBonePaletteBuffer = CH_INVALID_HANDLE;
+	gGraphicsData.aSkinningJobBuffer = CH_INVALID_HANDLE;
+
 	// if ( gGraphicsData.aVertexBufferSlots.apFree )
 	// 	free( gGraphicsData.aVertexBufferSlots.apFree );
 	// 
@@ -1510,6 +1578,7 @@ void Graphics::Shutdown()
 
 RenderStats_t Graphics::GetStats()
 {
+	render->GetTextureStreamStats( gStats.aTextureStream );
 	return gStats;
 }
 
@@ -1608,11 +1677,6 @@ void FreeRenderableModel( Renderable_t* renderable )
 
 	if ( renderable->aBlendShapeWeightsBuffer )
 	{
-		if ( renderable->aVertexIndex != UINT32_MAX )
-		{
-			Graphics_RemoveShaderBuffer( gGraphicsData.aVertexBuffers, renderable->aVertexIndex );
-		}
-
 		if ( renderable->aBlendShapeWeightsIndex != UINT32_MAX )
 		{
 			Graphics_RemoveShaderBuffer( gGraphicsData.aBlendShapeWeightBuffers, renderable->aBlendShapeWeightsIndex );
@@ -1620,11 +1684,23 @@ void FreeRenderableModel( Renderable_t* renderable )
 
 		render->DestroyBuffer( renderable->aBlendShapeWeightsBuffer );
 		renderable->aBlendShapeWeightsBuffer = CH_INVALID_HANDLE;
+		renderable->aBlendShapeWeightsIndex  = UINT32_MAX;
+	}
+
+	// we have custom vertex buffers for this renderable if it has blend shapes or a skeleton
+	if ( renderable->aOwnsVertexBuffer )
+	{
+		if ( renderable->aVertexIndex != UINT32_MAX )
+		{
+			Graphics_RemoveShaderBuffer( gGraphicsData.aVertexBuffers, renderable->aVertexIndex );
+		}
 
-		// If we have a blend shape weights buffer, then we have custom vertex buffers for this renderable
 		render->DestroyBuffer( renderable->aVertexBuffer );
+		renderable->aOwnsVertexBuffer = false;
 	}
 
+	renderable->aBoneMatrices.clear();
+
 	renderable->aVertexBuffer = CH_INVALID_HANDLE;
 	renderable->aVertexIndex  = UINT32_MAX;
 	renderable->aIndexHandle  = UINT32_MAX;
@@ -1664,13 +1740,19 @@ void SetRenderableModel( ch_handle_t modelHandle, Model* model, Renderable_t* re
 
 	renderable->aBlendShapeWeights.resize( model->apVertexData->aBlendShapeCount );
 
-	if ( renderable->aBlendShapeWeights.size() )
+	// start skinned renderables in the bind pose
+	renderable->aBoneMatrices.resize( model->apVertexData->apSkinData ? model->apVertexData->aBoneCount : 0 );
+
+	for ( glm::mat4& bone : renderable->aBoneMatrices )
+		bone = glm::identity< glm::mat4 >();
+
+	if ( renderable->aBlendShapeWeights.size() || renderable->aBoneMatrices.size() )
 	{
-		// we need new vertex buffers for the modified vertices
+		// we need new vertex buffers for the modified vertices, used by every pass drawing this renderable
 		size_t bufferSize         = sizeof( Shader_VertexData_t ) * model->apVertexData->aCount;
 
 		renderable->aVertexBuffer = render->CreateBuffer(
-		  "output renderable vertices idfk",
+		  "Skinned Renderable Vertices",
 		  bufferSize,
 		  EBufferFlags_Storage | EBufferFlags_Vertex | EBufferFlags_TransferDst,
 		  EBufferMemory_Device );
@@ -1682,6 +1764,17 @@ void SetRenderableModel( ch_handle_t modelHandle, Model* model, Renderable_t* re
 
 		render->BufferCopyQueued( model->apBuffers->aVertex, renderable->aVertexBuffer, &copy, 1 );
 
+		renderable->aOwnsVertexBuffer = true;
+		renderable->aVertexIndex      = Graphics_AddShaderBuffer( gGraphicsData.aVertexBuffers, renderable->aVertexBuffer );
+	}
+	else
+	{
+		renderable->aVertexBuffer = model->apBuffers->aVertex;
+		renderable->aVertexIndex  = model->apBuffers->aVertexHandle;
+	}
+
+	if ( renderable->aBlendShapeWeights.size() )
+	{
 		// Now Create a Blend Shape Weights Storage Buffer
 		renderable->aBlendShapeWeightsBuffer = render->CreateBuffer(
 		  "BlendShape Weights",
@@ -1689,52 +1782,7 @@ void SetRenderableModel( ch_handle_t modelHandle, Model* model, Renderable_t* re
 		  EBufferFlags_Storage,
 		  EBufferMemory_Host );
 
-		// Allocate Indexes for these
-		renderable->aVertexIndex            = Graphics_AddShaderBuffer( gGraphicsData.aVertexBuffers, renderable->aVertexBuffer );
 		renderable->aBlendShapeWeightsIndex = Graphics_AddShaderBuffer( gGraphicsData.aBlendShapeWeightBuffers, renderable->aBlendShapeWeightsBuffer );
-
-		// update the descriptor sets for the skinning shader
-		WriteDescSet_t update{};
-
-		update.aDescSetCount            = gShaderDescriptorData.aPerShaderSets[ "__skinning" ].aCount;
-		update.apDescSets               = gShaderDescriptorData.aPerShaderSets[ "__skinning" ].apSets;
-
-		update.aBindingCount            = 2;
-		update.apBindings               = ch_calloc< WriteDescSetBinding_t >( update.aBindingCount );
-
-		update.apBindings[ 0 ].aBinding = 0;
-		update.apBindings[ 0 ].aType    = EDescriptorType_StorageBuffer;
-		update.apBindings[ 0 ].aCount   = gGraphicsData.aBlendShapeWeightBuffers.aBuffers.size();
-		update.apBindings[ 0 ].apData   = ch_calloc< ch_handle_t >( gGraphicsData.aBlendShapeWeightBuffers.aBuffers.size() );
-
-		update.apBindings[ 1 ].aBinding = 1;
-		update.apBindings[ 1 ].aType    = EDescriptorType_StorageBuffer;
-		update.apBindings[ 1 ].aCount   = gGraphicsData.aBlendShapeDataBuffers.aBuffers.size();
-		update.apBindings[ 1 ].apData   = ch_calloc< ch_handle_t >( gGraphicsData.aBlendShapeDataBuffers.aBuffers.size() );
-
-		int i                           = 0;
-		for ( const auto& [ index, buffer ] : gGraphicsData.aBlendShapeWeightBuffers.aBuffers )
-		{
-			update.apBindings[ 0 ].apData[ i++ ] = buffer;
-		}
-
-		i = 0;
-		for ( const auto& [ index, buffer ] : gGraphicsData.aBlendShapeDataBuffers.aBuffers )
-		{
-			update.apBindings[ 1 ].apData[ i++ ] = buffer;
-		}
-
-		// update.aImages = gViewportBuffers;
-		render->UpdateDescSets( &update, 1 );
-
-		free( update.apBindings[ 0 ].apData );
-		free( update.apBindings[ 1 ].apData );
-		free( update.apBindings );
-	}
-	else
-	{
-		renderable->aVertexBuffer = model->apBuffers->aVertex;
-		renderable->aVertexIndex  = model->apBuffers->aVertexHandle;
 	}
 
 	renderable->aIndexHandle                = model->apBuffers->aIndexHandle;
@@ -1844,6 +1892,7 @@ void Graphics::FreeRenderable( ch_handle_t sRenderable )
 
 	gGraphicsData.aRenderables.Remove( sRenderable );
 	gGraphicsData.aRenderAABBUpdate.erase( sRenderable );
+	gGraphicsData.aSkinningRenderList.erase( sRenderable );
 	gGraphicsData.aRenderableStaging.aDirty = true;
 
 	Log_Dev( gLC_ClientGraphics, 1, "Freed Renderable\n" );
@@ -1911,6 +1960,25 @@ void FreeRenderableDebugName( Renderable_t* renderable )
 }
 
 
+void Graphics::SetRenderableBones( ch_handle_t sRenderable, const glm::mat4* spBones, u32 sCount )
+{
+	Renderable_t* renderable = nullptr;
+	if ( !gGraphicsData.aRenderables.Get( sRenderable, &renderable ) )
+	{
+		Log_Warn( gLC_ClientGraphics, "Failed to find Renderable to set bones on!\n" );
+		return;
+	}
+
+	if ( renderable->aBoneMatrices.empty() || !spBones )
+		return;
+
+	sCount = std::min( sCount, (u32)renderable->aBoneMatrices.size() );
+	memcpy( renderable->aBoneMatrices.data(), spBones, sCount * sizeof( glm::mat4 ) );
+
+	renderable->aBonesDirty = true;
+}
+
+
 void Graphics::SetRenderableDebugName( ch_handle_t sRenderable, std::string_view sName )
 {
 	if ( Renderable_t* renderable = gGraphics.GetRenderableData( sRenderable ) )
@@ -2254,6 +2322,18 @@ void Graphics::CreateVertexBuffers( ModelBuffers_t* spBuffer, VertexData_t* spVe
 	// Allocate an Index for this
 	spBuffer->aVertexHandle = Graphics_AddShaderBuffer( gGraphicsData.aVertexBuffers, spBuffer->aVertex );
 
+	// Bone Indices and Weights
+	if ( spVertexData->apSkinData )
+	{
+		spBuffer->aSkin = CreateModelBuffer(
+		  spDebugName ? spDebugName : "Skin",
+		  spVertexData->apSkinData,
+		  sizeof( Shader_VertexSkin_t ) * spVertexData->aCount,
+		  EBufferFlags_Storage );
+
+		spBuffer->aSkinHandle = Graphics_AddShaderBuffer( gGraphicsData.aSkinBuffers, spBuffer->aSkin );
+	}
+
 	// ch_handle_t Blend Shapes
 	
 	// TODO: this expects each vertex attribute to have it's own vertex buffer
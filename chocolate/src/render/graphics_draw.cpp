@@ -61,6 +61,41 @@ bool Graphics_ViewFrustumTest( Renderable_t* spModelDraw, ViewportShader_t& srVi
 }
 
 
+// How big a renderable is on screen in pixels, going by the bounding sphere of its AABB
+static u32 Graphics_GetScreenSize( Renderable_t* spRenderable, ViewportShader_t& srViewport )
+{
+	u32       viewSize = std::max( srViewport.aSize.x, srViewport.aSize.y );
+	glm::vec3 center   = ( spRenderable->aAABB.aMin + spRenderable->aAABB.aMax ) * 0.5f;
+	float     radius   = glm::length( spRenderable->aAABB.aMax - spRenderable->aAABB.aMin ) * 0.5f;
+	float     dist     = glm::distance( srViewport.aViewPos, center );
+
+	// no bounds to go by, or the view is inside of it
+	if ( !spRenderable->aTestVis || radius == 0.f || dist <= radius )
+		return viewSize;
+
+	// aProjection[ 1 ][ 1 ] is 1 / tan( fov / 2 ), so this is the diameter of the sphere in pixels
+	float size = radius * srViewport.aProjection[ 1 ][ 1 ] / dist * srViewport.aSize.y;
+
+	return (u32)std::clamp( size, 1.f, (float)viewSize );
+}
+
+
+// Tells texture streaming how big the textures of a material are on screen
+static void Graphics_RequestMaterialTextures( ch_handle_t sShader, ch_handle_t sMat, u32 sScreenSize )
+{
+	ShaderMaterialData* data = Shader_GetMaterialData( sShader, sMat );
+
+	if ( !data )
+		return;
+
+	for ( u32 i = 0; i < data->vars.size(); i++ )
+	{
+		if ( data->vars[ i ].aType == EMatVar_Texture )
+			render->TextureStreamRequest( data->vars[ i ].aTexture, sScreenSize );
+	}
+}
+
+
 // TODO: experiment with instanced drawing
 void Graphics_CmdDrawSurface( ch_handle_t cmd, Model* spModel, size_t sSurface )
 {
@@ -554,11 +589,12 @@ void Graphics::SetViewportRenderList( u32 sViewport, ch_handle_t* srRenderables,
 		// 	continue;
 		// }
 
-		// Check if blend shapes are dirty
-		if ( renderable->aBlendShapesDirty )
+		// Check if blend shapes or bones are dirty
+		if ( renderable->aBlendShapesDirty || renderable->aBonesDirty )
 		{
 			gGraphicsData.aSkinningRenderList.emplace( srRenderables[ i ] );
 			renderable->aBlendShapesDirty = false;
+			renderable->aBonesDirty       = false;
 		}
 
 		Shader_Renderable_t& shaderRenderable         = gGraphicsData.aRenderableData[ renderIndex ];
@@ -578,6 +614,9 @@ void Graphics::SetViewportRenderList( u32 sViewport, ch_handle_t* srRenderables,
 			if ( !Graphics_ViewFrustumTest( renderable, viewport ) )
 				continue;
 
+			// shadow map views don't sample material textures
+			u32 screenSize = viewport.aShaderOverride ? 0 : Graphics_GetScreenSize( renderable, viewport );
+
 			// Add each surface to the shader draw list
 			for ( uint32_t surf = 0; surf < renderable->aMaterialCount; surf++ )
 			{
@@ -592,6 +631,9 @@ void Graphics::SetViewportRenderList( u32 sViewport, ch_handle_t* srRenderables,
 
 				ch_handle_t shader = gGraphics.Mat_GetShader( mat );
 
+				if ( screenSize )
+					Graphics_RequestMaterialTextures( shader, mat, screenSize );
+
 				if ( viewport.aShaderOverride )
 					shader = viewport.aShaderOverride;
 
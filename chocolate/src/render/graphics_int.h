@@ -19,6 +19,8 @@ constexpr u32 CH_R_MAX_VERTEX_BUFFERS             = CH_R_MAX_RENDERABLES * 2;
 constexpr u32 CH_R_MAX_INDEX_BUFFERS              = CH_R_MAX_RENDERABLES;
 constexpr u32 CH_R_MAX_BLEND_SHAPE_WEIGHT_BUFFERS = CH_R_MAX_RENDERABLES;
 constexpr u32 CH_R_MAX_BLEND_SHAPE_DATA_BUFFERS   = CH_R_MAX_RENDERABLES;
+constexpr u32 CH_R_MAX_SKIN_BUFFERS               = CH_R_MAX_RENDERABLES;
+constexpr u32 CH_R_MAX_BONES                      = 16384;  // size of the bone palette buffer, shared by every skinned renderable updated in a frame
 
 constexpr u32 CH_R_MAX_LIGHT_TYPE                 = 256;
 constexpr u32 CH_R_MAX_LIGHTS                     = CH_R_MAX_LIGHT_TYPE * ELightType_Count;
@@ -32,6 +34,16 @@ constexpr u32 CH_BINDING_RENDERABLES              = 3;
 constexpr u32 CH_BINDING_MODEL_MATRICES           = 4;
 constexpr u32 CH_BINDING_VERTEX_BUFFERS           = 5;
 constexpr u32 CH_BINDING_INDEX_BUFFERS            = 6;
+constexpr u32 CH_BINDING_LIGHT_CLUSTERS           = 7;
+
+constexpr u32 CH_R_CLUSTER_X                      = 16;
+constexpr u32 CH_R_CLUSTER_Y                      = 9;
+constexpr u32 CH_R_CLUSTER_Z                      = 24;
+constexpr u32 CH_R_CLUSTER_COUNT                  = CH_R_CLUSTER_X * CH_R_CLUSTER_Y * CH_R_CLUSTER_Z;
+constexpr u32 CH_R_CLUSTER_GRIDS                  = 4;
+constexpr u32 CH_R_CLUSTER_MAX_LIGHTS             = 64;
+
+constexpr u32 CH_R_MAX_SHADOW_CASCADES            = 4;
 
 
 // Contains a built list of renderable surfaces to draw this frame, grouped by shader
@@ -105,9 +117,10 @@ struct Shader_Viewport_t
 	glm::vec3 aViewPos{};
 	float     aNearZ = 0.f;
 	float     aFarZ  = 0.f;
+	u32       aLightClusters = UINT32_MAX;
 
 	// padding for shader????
-	glm::vec3 weirdPaddingIdk;
+	glm::vec2 weirdPaddingIdk;
 };
 
 
@@ -138,10 +151,15 @@ struct Shader_SurfaceDraw_t
 // Light Types
 struct UBO_LightDirectional_t
 {
-	alignas( 16 ) glm::vec4 color{};
-	alignas( 16 ) glm::vec3 aDir{};
-	alignas( 16 ) glm::mat4 aProjView{};
-	int aShadow = -1;
+	alignas( 16 ) glm::vec4  color{};
+	alignas( 16 ) glm::vec3  aDir{};
+	u32                      aCascadeCount = 0;
+	alignas( 16 ) glm::mat4  aProjView[ CH_R_MAX_SHADOW_CASCADES ]{};
+	alignas( 16 ) glm::vec4  aCascadeSplits{};             // view depth each cascade ends at
+	alignas( 16 ) glm::vec4  aCascadePlane{};              // view depth from the camera the cascades are fit to, dot( xyz, pos ) + w
+	alignas( 16 ) glm::ivec4 aShadow{ -1, -1, -1, -1 };  // shadow texture index per cascade
+	float                    aCascadeBlend = 0.f;         // fraction of each cascade blended into the next one
+	float                    aCascadeNearZ = 0.f;         // where the first cascade starts
 };
 
 
@@ -241,15 +259,49 @@ enum EShaderCoreArray : u32
 };
 
 
-// :skull:
-struct ShaderSkinning_Push
+// Match SkinningJob_t in skinning.comp
+// One per renderable skinned this frame, all jobs are run in a single dispatch
+struct ShaderSkinningJob_t
 {
-	u32 aRenderable            = 0;
-	u32 aSourceVertexBuffer    = 0;
+	u32 aGroupStart            = 0;  // first workgroup of this job in the dispatch
 	u32 aVertexCount           = 0;
+	u32 aSourceVertexBuffer    = UINT32_MAX;
+	u32 aDestVertexBuffer      = UINT32_MAX;
 	u32 aBlendShapeCount       = 0;
-	u32 aBlendShapeWeightIndex = 0;
-	u32 aBlendShapeDataIndex   = 0;
+	u32 aBlendShapeWeightIndex = UINT32_MAX;
+	u32 aBlendShapeDataIndex   = UINT32_MAX;
+	u32 aSkinIndex             = UINT32_MAX;
+	u32 aBoneOffset            = 0;
+};
+
+
+// Match BoneMatrix_t in skinning.comp, the transposed top 3 rows of the bone matrix
+struct ShaderBoneMatrix_t
+{
+	glm::vec4 aRows[ 3 ];
+};
+
+
+struct ShaderSkinning_Push
+{
+	u32 aJobCount = 0;
+};
+
+
+struct ShaderLightCluster_Push
+{
+	glm::mat4 aInvProjection{};
+	u32       aViewport = 0;
+	u32       aGrid     = 0;
+	float     aCutoff   = 0.f;
+};
+
+
+// Match Buffer_LightClusters in core.glsl
+struct Buffer_LightClusters_t
+{
+	u32 aCount[ CH_R_CLUSTER_GRIDS * CH_R_CLUSTER_COUNT ];
+	u32 aLights[ CH_R_CLUSTER_GRIDS * CH_R_CLUSTER_COUNT * CH_R_CLUSTER_MAX_LIGHTS ];
 };
 
 
@@ -282,6 +334,7 @@ constexpr u32         CH_SHADER_CORE_SLOT_INVALID  = UINT32_MAX;
 constexpr const char* CH_SHADER_NAME_SKINNING      = "__skinning";
 constexpr const char* CH_SHADER_NAME_SELECT        = "__select";
 constexpr const char* CH_SHADER_NAME_SELECT_RESULT = "__select_result";
+constexpr const char* CH_SHADER_NAME_LIGHT_CLUSTER = "__light_cluster";
 
 
 // I don't like this at all
@@ -300,6 +353,7 @@ struct GraphicsData_t
 
 	ch_handle_t                                    aRenderPassGraphics;
 	ch_handle_t                                    aRenderPassShadow;
+	ch_handle_t                                    aRenderPassShadowKeep;
 	ch_handle_t                                    aRenderPassSelect;
 
 	std::unordered_set< ch_handle_t >              aDirtyMaterials;
@@ -353,6 +407,15 @@ struct GraphicsData_t
 	ShaderBufferList_t                            aIndexBuffers;
 	ShaderBufferList_t                            aBlendShapeWeightBuffers;
 	ShaderBufferList_t                            aBlendShapeDataBuffers;
+	ShaderBufferList_t                            aSkinBuffers;
+
+	// Bone palettes and skinning jobs for the renderables in aSkinningRenderList, rebuilt every frame
+	ch_handle_t                                    aBonePaletteBuffer = CH_INVALID_HANDLE;
+	ch_handle_t                                    aSkinningJobBuffer = CH_INVALID_HANDLE;
+	ChVector< ShaderBoneMatrix_t >                aBonePalette;
+	ChVector< ShaderSkinningJob_t >               aSkinningJobs;
+	ChVector< ch_handle_t >                        aSkinningOutputs;  // vertex buffer written by each job
+	u32                                           aSkinningGroupCount = 0;
 	
 	glm::mat4*                                    aModelMatrixData;  // shares the same slot index as renderables, which is the handle index
 	Shader_Renderable_t*                          aRenderableData;
@@ -363,6 +426,9 @@ struct GraphicsData_t
 	Shader_Viewport_t*                            aViewportData;
 	ShaderArrayAllocator_t                        aViewportSlots;
 	DeviceBufferStaging_t                         aViewportStaging;
+
+	// only written on the gpu by the light cluster compute shader
+	ch_handle_t                                    aLightClusterBuffer = CH_INVALID_HANDLE;
 };
 
 
@@ -416,8 +482,12 @@ ShaderSets_t*         Shader_GetSets( std::string_view sShader );
 
 ch_handle_t                Shader_RegisterDescriptorData( EShaderSlot sSlot, FShader_DescriptorData* sCallback );
 
+// Mark only the materials that use this texture as dirty
+void                  Graphics_SetTextureMaterialsDirty( ch_handle_t sTexture );
+
 void                  Shader_RemoveMaterial( ch_handle_t sMat );
 void                  Shader_AddMaterial( ch_handle_t sMat );
+void                  Shader_UpdateMaterialSlots();
 void                  Shader_UpdateMaterialVars();
 ShaderMaterialData*   Shader_GetMaterialData( ch_handle_t sShader, ch_handle_t sMat );
 
@@ -682,6 +752,7 @@ class Graphics : public IGraphics
 	virtual ModelBBox_t            GetRenderableAABB( ch_handle_t sRenderable ) override;
 
 	virtual void                   SetRenderableDebugName( ch_handle_t sRenderable, std::string_view sName ) override;
+	virtual void                   SetRenderableBones( ch_handle_t sRenderable, const glm::mat4* spBones, u32 sCount ) override;
 
 	virtual u32                    GetRenderableCount() override;
 	virtual ch_handle_t             GetRenderableByIndex( u32 i ) override;
@@ -0,0 +1,287 @@
+#include "graphics_int.h"
+#include "lighting.h"
+
+
+// Clustered lighting
+// Each clustered viewport gets a froxel grid, CH_R_CLUSTER_X * CH_R_CLUSTER_Y tiles in screen space,
+// and CH_R_CLUSTER_Z exponential depth slices between the near and far plane
+// light_cluster.comp writes a list of the point lights touching each cluster, and AddLighting() only loops over that list
+// World and cone lights are still looped over for every fragment
+
+
+CONVAR_BOOL( r_light_cluster, 1, "Only light fragments with the point lights in their cluster" );
+CONVAR_FLOAT( r_light_cluster_cutoff, 1.f / 256.f, "Point lights are culled where they would add less than this to a color channel" );
+
+
+// KEEP IN SYNC WITH GetPointLightRange() in light_cluster.comp
+float Graphics_GetPointLightRange( const UBO_LightPoint_t& srLight, float sCutoff )
+{
+	float intensity = srLight.aRadius * srLight.color.a * glm::max( srLight.color.r, glm::max( srLight.color.g, srLight.color.b ) );
+	return sqrtf( glm::max( intensity / sCutoff - 1.f, 0.f ) );
+}
+
+
+static float Graphics_GetLightClusterCutoff()
+{
+	return glm::max( (float)r_light_cluster_cutoff, 0.0001f );
+}
+
+
+bool Graphics_CanClusterLights( const ViewportShader_t& srViewport )
+{
+	if ( !r_light_cluster || !srViewport.aActive || srViewport.aShaderOverride )
+		return false;
+
+	// the clusters are built from rays through the camera position, so this needs a perspective projection
+	if ( srViewport.aProjection[ 3 ][ 3 ] != 0.f )
+		return false;
+
+	return srViewport.aNearZ > 0.f && srViewport.aFarZ > srViewport.aNearZ;
+}
+
+
+static glm::vec3 Graphics_GetClusterViewPos( const glm::mat4& srInvProjection, glm::vec2 sNDC, float sDepth )
+{
+	glm::vec4 pos = srInvProjection * glm::vec4( sNDC, 1.f, 1.f );
+	glm::vec3 dir = glm::vec3( pos ) / pos.w;
+	return dir * ( sDepth / -dir.z );
+}
+
+
+// CPU version of light_cluster.comp, used to check the gpu result
+// spCounts is CH_R_CLUSTER_COUNT long, spLights is CH_R_CLUSTER_COUNT * CH_R_CLUSTER_MAX_LIGHTS long
+void Graphics_BinLightClusters( const Shader_Viewport_t& srView, const Buffer_Core_t& srCore, float sCutoff, u32* spCounts, u32* spLights )
+{
+	PROF_SCOPE();
+
+	glm::mat4 invProjection = glm::inverse( srView.aProjection );
+
+	// move the lights into view space once instead of for every cluster
+	u32       lightCount    = glm::min( srCore.aNumLights[ ELightType_Point ], CH_R_MAX_LIGHT_TYPE );
+	glm::vec3 centers[ CH_R_MAX_LIGHT_TYPE ];
+	float     ranges[ CH_R_MAX_LIGHT_TYPE ];
+
+	for ( u32 i = 0; i < lightCount; i++ )
+	{
+		centers[ i ] = srView.aView * glm::vec4( srCore.aLightPoint[ i ].aPos, 1.f );
+		ranges[ i ]  = Graphics_GetPointLightRange( srCore.aLightPoint[ i ], sCutoff );
+	}
+
+	for ( u32 cluster = 0; cluster < CH_R_CLUSTER_COUNT; cluster++ )
+	{
+		glm::uvec3 coord(
+		  cluster % CH_R_CLUSTER_X,
+		  ( cluster / CH_R_CLUSTER_X ) % CH_R_CLUSTER_Y,
+		  cluster / ( CH_R_CLUSTER_X * CH_R_CLUSTER_Y ) );
+
+		float     sliceNear = srView.aNearZ * powf( srView.aFarZ / srView.aNearZ, (float)coord.z / CH_R_CLUSTER_Z );
+		float     sliceFar  = srView.aNearZ * powf( srView.aFarZ / srView.aNearZ, (float)( coord.z + 1 ) / CH_R_CLUSTER_Z );
+
+		glm::vec2 ndcMin    = glm::vec2( coord.x, coord.y ) / glm::vec2( CH_R_CLUSTER_X, CH_R_CLUSTER_Y ) * 2.f - 1.f;
+		glm::vec2 ndcMax    = glm::vec2( coord.x + 1, coord.y + 1 ) / glm::vec2( CH_R_CLUSTER_X, CH_R_CLUSTER_Y ) * 2.f - 1.f;
+
+		glm::vec3 aabbMin( FLT_MAX );
+		glm::vec3 aabbMax( -FLT_MAX );
+
+		for ( int i = 0; i < 8; i++ )
+		{
+			glm::vec2 ndc( ( i & 1 ) == 0 ? ndcMin.x : ndcMax.x, ( i & 2 ) == 0 ? ndcMin.y : ndcMax.y );
+			glm::vec3 pos = Graphics_GetClusterViewPos( invProjection, ndc, ( i & 4 ) == 0 ? sliceNear : sliceFar );
+
+			aabbMin       = glm::min( aabbMin, pos );
+			aabbMax       = glm::max( aabbMax, pos );
+		}
+
+		u32 count = 0;
+
+		for ( u32 i = 0; i < lightCount; i++ )
+		{
+			if ( srCore.aLightPoint[ i ].color.w == 0.f )
+				continue;
+
+			glm::vec3 diff = centers[ i ] - glm::clamp( centers[ i ], aabbMin, aabbMax );
+
+			if ( glm::dot( diff, diff ) > ranges[ i ] * ranges[ i ] )
+				continue;
+
+			if ( count < CH_R_CLUSTER_MAX_LIGHTS )
+				spLights[ cluster * CH_R_CLUSTER_MAX_LIGHTS + count ] = i;
+
+			count++;
+		}
+
+		spCounts[ cluster ] = count;
+	}
+}
+
+
+void Graphics_DispatchLightClusters( ch_handle_t sCmd, u32 sCmdIndex, u32* spViewports, u32 sViewportCount )
+{
+	PROF_SCOPE();
+
+	static ch_handle_t shader = gGraphics.GetShader( CH_SHADER_NAME_LIGHT_CLUSTER );
+
+	if ( shader == CH_INVALID_HANDLE )
+		return;
+
+	ShaderData_t* shaderData = Shader_GetData( shader );
+	bool          bound      = false;
+
+	for ( u32 i = 0; i < sViewportCount; i++ )
+	{
+		u32 viewIndex = Graphics_GetShaderSlot( gGraphicsData.aViewportSlots, spViewports[ i ] );
+
+		if ( viewIndex == UINT32_MAX )
+			continue;
+
+		Shader_Viewport_t& view = gGraphicsData.aViewportData[ viewIndex ];
+
+		if ( view.aLightClusters == UINT32_MAX )
+			continue;
+
+		if ( !bound )
+		{
+			if ( !Shader_Bind( sCmd, sCmdIndex, shader ) )
+			{
+				Log_Error( gLC_ClientGraphics, "Failed to bind light cluster shader\n" );
+				return;
+			}
+
+			bound = true;
+		}
+
+		ShaderLightCluster_Push push{};
+		push.aInvProjection = glm::inverse( view.aProjection );
+		push.aViewport      = viewIndex;
+		push.aGrid          = view.aLightClusters;
+		push.aCutoff        = Graphics_GetLightClusterCutoff();
+
+		render->CmdPushConstants( sCmd, shaderData->aLayout, ShaderStage_Compute, 0, sizeof( push ), &push );
+		render->CmdDispatch( sCmd, CH_R_CLUSTER_COUNT / 64, 1, 1 );
+	}
+
+	if ( !bound )
+		return;
+
+	GraphicsBufferMemoryBarrier_t buffer{};
+	buffer.aSrcAccessMask                = EGraphicsAccess_ShaderWrite;
+	buffer.aDstAccessMask                = EGraphicsAccess_ShaderRead;
+	buffer.aBuffer                       = gGraphicsData.aLightClusterBuffer;
+
+	PipelineBarrier_t endBarrier{};
+	endBarrier.aSrcStageMask             = EPipelineStage_ComputeShader;
+	endBarrier.aDstStageMask             = EPipelineStage_FragmentShader;
+	endBarrier.aBufferMemoryBarrierCount = 1;
+	endBarrier.apBufferMemoryBarriers    = &buffer;
+
+	render->CmdPipelineBarrier( sCmd, endBarrier );
+}
+
+
+static_assert( CH_R_CLUSTER_COUNT % 64 == 0, "light_cluster.comp runs 64 clusters per work group" );
+
+
+// Compares the last frame's gpu clusters against the CPU version
+// lights right on the edge of a cluster can differ from float precision, those are counted separately
+CONCMD_VA( r_light_cluster_validate, "Compare the gpu light clusters from last frame against the CPU version" )
+{
+	if ( gGraphicsData.aLightClusterBuffer == CH_INVALID_HANDLE )
+		return;
+
+	ch_handle_t readBuffer = render->CreateBuffer( "Light Cluster Readback", sizeof( Buffer_LightClusters_t ), EBufferFlags_TransferDst, EBufferMemory_Host );
+
+	if ( readBuffer == CH_INVALID_HANDLE )
+	{
+		Log_Error( gLC_ClientGraphics, "Failed to create light cluster readback buffer\n" );
+		return;
+	}
+
+	render->WaitForQueues();
+
+	BufferRegionCopy_t copy;
+	copy.aSrcOffset = 0;
+	copy.aDstOffset = 0;
+	copy.aSize      = sizeof( Buffer_LightClusters_t );
+
+	Buffer_LightClusters_t* gpu       = ch_malloc< Buffer_LightClusters_t >( 1 );
+	u32*                    cpuCounts = ch_malloc< u32 >( CH_R_CLUSTER_COUNT );
+	u32*                    cpuLights = ch_malloc< u32 >( CH_R_CLUSTER_COUNT * CH_R_CLUSTER_MAX_LIGHTS );
+
+	render->BufferCopy( gGraphicsData.aLightClusterBuffer, readBuffer, &copy, 1 );
+	render->BufferRead( readBuffer, sizeof( Buffer_LightClusters_t ), gpu );
+	render->DestroyBuffer( readBuffer );
+
+	float cutoff   = Graphics_GetLightClusterCutoff();
+	u32   checked  = 0;
+	u32   failures = 0;
+
+	for ( auto& [ viewHandle, viewport ] : gGraphicsData.aViewports )
+	{
+		u32 viewIndex = Graphics_GetShaderSlot( gGraphicsData.aViewportSlots, viewHandle );
+
+		if ( viewIndex == UINT32_MAX )
+			continue;
+
+		const Shader_Viewport_t& view = gGraphicsData.aViewportData[ viewIndex ];
+
+		if ( view.aLightClusters == UINT32_MAX )
+			continue;
+
+		Graphics_BinLightClusters( view, gGraphicsData.aCoreData, cutoff, cpuCounts, cpuLights );
+
+		u32 mismatched = 0;
+		u32 edge       = 0;
+		u32 overflow   = 0;
+		u32 maxLights  = 0;
+		u32 total      = 0;
+
+		for ( u32 cluster = 0; cluster < CH_R_CLUSTER_COUNT; cluster++ )
+		{
+			u32  gpuIndex = view.aLightClusters * CH_R_CLUSTER_COUNT + cluster;
+			u32  gpuCount = gpu->aCount[ gpuIndex ];
+			u32  cpuCount = cpuCounts[ cluster ];
+
+			u32* gpuList  = &gpu->aLights[ gpuIndex * CH_R_CLUSTER_MAX_LIGHTS ];
+			u32* cpuList  = &cpuLights[ cluster * CH_R_CLUSTER_MAX_LIGHTS ];
+
+			maxLights     = glm::max( maxLights, cpuCount );
+			total        += cpuCount;
+
+			if ( cpuCount > CH_R_CLUSTER_MAX_LIGHTS )
+				overflow++;
+
+			// both lists are sorted by light index, so they should be identical
+			bool same = gpuCount == cpuCount;
+
+			for ( u32 i = 0; same && i < glm::min( cpuCount, CH_R_CLUSTER_MAX_LIGHTS ); i++ )
+				same = gpuList[ i ] == cpuList[ i ];
+
+			if ( same )
+				continue;
+
+			// different counts by one usually means a light is right on the edge of this cluster
+			if ( gpuCount + 1 == cpuCount || cpuCount + 1 == gpuCount )
+				edge++;
+			else
+				mismatched++;
+		}
+
+		Log_MsgF( gLC_ClientGraphics, "Viewport %u (grid %u): %u clusters, %.2f lights avg, %u max, %u overflowed, %u edge differences, %u mismatched\n",
+		          viewIndex, view.aLightClusters, CH_R_CLUSTER_COUNT, (float)total / CH_R_CLUSTER_COUNT, maxLights, overflow, edge, mismatched );
+
+		checked++;
+		failures += mismatched;
+	}
+
+	free( gpu );
+	free( cpuCounts );
+	free( cpuLights );
+
+	if ( checked == 0 )
+		Log_Msg( gLC_ClientGraphics, "No viewports have light clusters\n" );
+	else if ( failures )
+		Log_ErrorF( gLC_ClientGraphics, "Light clusters don't match the CPU version in %u clusters\n", failures );
+	else
+		Log_Msg( gLC_ClientGraphics, "Light clusters match the CPU version\n" );
+}
+
@@ -11,9 +11,10 @@ std::vector< Light_t* >                     gLights;
 static std::vector< Light_t* >              gDirtyLights;
 static std::vector< Light_t* >              gDestroyLights;
 
-static std::vector< Light_t* >              gShadowMapsToRender;
+static std::vector< ShadowMap_t* >          gShadowMapsToRender;
 
 extern void                                 Shader_ShadowMap_SetViewInfo( u32 sViewInfo );
+extern bool                                 Graphics_ViewFrustumTest( Renderable_t* spModelDraw, ViewportShader_t& srViewport );
 
 // --------------------------------------------------------------------------------------
 
@@ -23,15 +24,83 @@ CONVAR_FLOAT( r_shadowmap_fov_hack, 90.f );
 CONVAR_FLOAT( r_shadowmap_nearz, 0.01f );
 CONVAR_FLOAT( r_shadowmap_farz, 400.f );
 
-CONVAR_FLOAT( r_shadowmap_othro_left, -1000.f );
-CONVAR_FLOAT( r_shadowmap_othro_right, 1000.f );
-CONVAR_FLOAT( r_shadowmap_othro_bottom, -1000.f );
-CONVAR_FLOAT( r_shadowmap_othro_top, 1000.f );
+CONVAR_INT( r_shadowmap_cascades, 4, "Number of shadow cascades for world lights, from 1 to 4" );
+CONVAR_INT( r_shadowmap_cascade_size, 2048, "Size of each world light shadow cascade" );
+CONVAR_FLOAT( r_shadowmap_cascade_distance, 400.f, "How far from the camera world light shadows reach" );
+CONVAR_FLOAT( r_shadowmap_cascade_lambda, 0.8f, "Blend between uniform (0) and logarithmic (1) cascade splits" );
+CONVAR_FLOAT( r_shadowmap_cascade_blend, 0.1f, "Fraction at the end of each cascade that blends into the next one" );
+CONVAR_FLOAT( r_shadowmap_cascade_depth, 500.f, "How far towards the light from each cascade shadow casters are still drawn" );
 
 CONVAR_FLOAT( r_shadowmap_constant, 16.f );  // 1.25f
 CONVAR_FLOAT( r_shadowmap_clamp, 0.f );
 CONVAR_FLOAT( r_shadowmap_slope, 1.75f );
 
+CONVAR_BOOL_EXT( r_vis_lock );
+
+CONVAR_BOOL( r_shadowmap_cache, 1, "Draw static shadow casters once into a cached depth map, and only draw the shadow map again when something in it changed" );
+CONVAR_INT( r_shadowmap_static_frames, 30, "How many frames a shadow caster needs to be still for to be treated as static" );
+
+// --------------------------------------------------------------------------------------
+// Shadow Caching
+// Casters that haven't moved in r_shadowmap_static_frames are static, they are drawn into a cached depth map per light
+// When only static casters are in view of the light, the cache is copied into the shadow map when it changes, and then left alone
+// With dynamic casters, the cache is copied in and the dynamic ones are drawn on top of it every frame
+
+
+struct ShadowCasterState_t
+{
+	glm::mat4   aMatrix;
+	ch_handle_t aModel      = CH_INVALID_HANDLE;
+	u32         aStillFrames = 0;
+	u32         aFrame      = 0;
+};
+
+
+struct ShadowCache_t
+{
+	ch_handle_t      aStaticTexture     = CH_INVALID_HANDLE;
+	ch_handle_t      aStaticFramebuffer = CH_INVALID_HANDLE;
+
+	ViewRenderList_t aStaticList;
+	ViewRenderList_t aDynamicList;
+
+	// hash of the light view and casters the last time they were drawn, only valid while the matching bool is set
+	u64              aStaticHash        = 0;
+	u64              aShadowHash        = 0;
+	bool             aStaticCached      = false;
+	bool             aShadowCached      = false;
+
+	// hashes for this frame, saved if the shadow map is drawn
+	u64              aNewStaticHash     = 0;
+	u64              aNewShadowHash     = 0;
+
+	bool             aHasDynamic        = false;
+};
+
+
+static std::unordered_map< ch_handle_t, ShadowCasterState_t > gShadowCasters;
+static std::unordered_map< ShadowMap_t*, ShadowCache_t >     gShadowCache;
+static u32                                                   gShadowFrame = 0;
+
+// --------------------------------------------------------------------------------------
+// Cascaded Shadow Maps
+// World lights get a shadow map per cascade, each one fit to a slice of the camera view every frame
+// The cascades are bounding spheres of the slice snapped to shadow map texels, so they don't shimmer when the camera moves or turns
+
+
+struct ShadowCascades_t
+{
+	ShadowMap_t aCascades[ CH_R_MAX_SHADOW_CASCADES ];
+	u32         aCount        = 0;
+
+	// settings the cascades were last made with
+	u32         aRequestCount = 0;
+	int         aRequestSize  = 0;
+};
+
+
+static std::unordered_map< Light_t*, ShadowCascades_t >      gShadowCascades;
+
 // --------------------------------------------------------------------------------------
 
 
@@ -50,6 +119,9 @@ void Graphics_DestroyShadowRenderPass()
 {
 	if ( gGraphicsData.aRenderPassShadow != CH_INVALID_HANDLE )
 		render->DestroyRenderPass( gGraphicsData.aRenderPassShadow );
+
+	if ( gGraphicsData.aRenderPassShadowKeep != CH_INVALID_HANDLE )
+		render->DestroyRenderPass( gGraphicsData.aRenderPassShadowKeep );
 }
 
 
@@ -72,11 +144,15 @@ bool Graphics_CreateShadowRenderPass()
 
 	gGraphicsData.aRenderPassShadow   = render->CreateRenderPass( create );
 
-	return gGraphicsData.aRenderPassShadow;
+	// for drawing dynamic shadow casters on top of the static ones copied into the shadow map
+	create.aAttachments[ 0 ].aKeepContents = true;
+	gGraphicsData.aRenderPassShadowKeep    = render->CreateRenderPass( create );
+
+	return gGraphicsData.aRenderPassShadow && gGraphicsData.aRenderPassShadowKeep;
 }
 
 
-void Graphics_AddShadowMap( Light_t* spLight )
+static bool Graphics_CreateShadowMap( ShadowMap_t* spShadowMap, int sSize, const char* spName )
 {
 	ViewportShader_t* viewport      = nullptr;
 	u32               viewportIndex = gGraphics.CreateViewport( &viewport );
@@ -84,47 +160,89 @@ void Graphics_AddShadowMap( Light_t* spLight )
 	if ( viewport == nullptr )
 	{
 		Log_Error( gLC_ClientGraphics, "Failed to allocate viewport for shadow map\n" );
-		return;
+		return false;
 	}
 
-	ShadowMap_t* shadowMap    = new ShadowMap_t;
-	shadowMap->aSize          = { r_shadowmap_size, r_shadowmap_size };
-	shadowMap->aViewportHandle = viewportIndex;
+	spShadowMap->aSize           = { sSize, sSize };
+	spShadowMap->aViewportHandle = viewportIndex;
 
-	viewport->aShaderOverride = gGraphics.GetShader( "__shadow_map" );
-	viewport->aSize           = shadowMap->aSize;
-	viewport->aActive         = false;
+	viewport->aShaderOverride    = gGraphics.GetShader( "__shadow_map" );
+	viewport->aSize              = spShadowMap->aSize;
+	viewport->aActive            = false;
 
 	// Create Textures
 	TextureCreateInfo_t texCreate{};
-	texCreate.apName    = "Shadow Map";
-	texCreate.aSize     = shadowMap->aSize;
+	texCreate.apName    = spName;
+	texCreate.aSize     = spShadowMap->aSize;
 	texCreate.aFormat   = render->GetSwapFormatDepth();
 	texCreate.aViewType = EImageView_2D;
 
 	TextureCreateData_t createData{};
-	createData.aUsage          = EImageUsage_AttachDepthStencil | EImageUsage_Sampled;
+	createData.aUsage          = EImageUsage_AttachDepthStencil | EImageUsage_Sampled | EImageUsage_TransferDst;
 	createData.aFilter         = EImageFilter_Linear;
 	// createData.aSamplerAddress = ESamplerAddressMode_ClampToEdge;
 	createData.aSamplerAddress = ESamplerAddressMode_ClampToBorder;
 
 	createData.aDepthCompare   = true;
 
-	shadowMap->aTexture        = gGraphics.CreateTexture( texCreate, createData );
+	spShadowMap->aTexture      = gGraphics.CreateTexture( texCreate, createData );
 
 	// Create Framebuffer
 	CreateFramebuffer_t frameBufCreate{};
 	frameBufCreate.apName             = "Shadow Map Framebuffer";
 	frameBufCreate.aRenderPass        = gGraphicsData.aRenderPassShadow;  // ImGui will be drawn onto the graphics RenderPass
-	frameBufCreate.aSize              = shadowMap->aSize;
+	frameBufCreate.aSize              = spShadowMap->aSize;
 
 	// Create Color
-	frameBufCreate.aPass.aAttachDepth = shadowMap->aTexture;
-	shadowMap->aFramebuffer           = render->CreateFramebuffer( frameBufCreate );
+	frameBufCreate.aPass.aAttachDepth = spShadowMap->aTexture;
+	spShadowMap->aFramebuffer         = render->CreateFramebuffer( frameBufCreate );
 
-	if ( shadowMap->aFramebuffer == CH_INVALID_HANDLE )
+	if ( spShadowMap->aFramebuffer == CH_INVALID_HANDLE )
 	{
 		Log_Error( gLC_ClientGraphics, "Failed to create shadow map!\n" );
+		return false;
+	}
+
+	return true;
+}
+
+
+static void Graphics_FreeShadowMap( ShadowMap_t* spShadowMap )
+{
+	if ( spShadowMap->aFramebuffer )
+		render->DestroyFramebuffer( spShadowMap->aFramebuffer );
+
+	if ( spShadowMap->aTexture )
+		gGraphics.FreeTexture( spShadowMap->aTexture );
+
+	if ( spShadowMap->aViewportHandle != UINT32_MAX )
+	{
+		gGraphics.FreeViewport( spShadowMap->aViewportHandle );
+	}
+
+	auto it = gShadowCache.find( spShadowMap );
+	if ( it != gShadowCache.end() )
+	{
+		if ( it->second.aStaticFramebuffer )
+			render->DestroyFramebuffer( it->second.aStaticFramebuffer );
+
+		if ( it->second.aStaticTexture )
+			gGraphics.FreeTexture( it->second.aStaticTexture );
+
+		gShadowCache.erase( it );
+	}
+
+	*spShadowMap = {};
+}
+
+
+void Graphics_AddShadowMap( Light_t* spLight )
+{
+	ShadowMap_t* shadowMap = new ShadowMap_t;
+
+	if ( !Graphics_CreateShadowMap( shadowMap, r_shadowmap_size, "Shadow Map" ) )
+	{
+		Graphics_FreeShadowMap( shadowMap );
 		delete shadowMap;
 		return;
 	}
@@ -133,24 +251,31 @@ void Graphics_AddShadowMap( Light_t* spLight )
 }
 
 
+static void Graphics_FreeShadowCascades( ShadowCascades_t& srCascades )
+{
+	for ( u32 i = 0; i < srCascades.aCount; i++ )
+		Graphics_FreeShadowMap( &srCascades.aCascades[ i ] );
+
+	srCascades.aCount = 0;
+}
+
+
 void Graphics_DestroyShadowMap( Light_t* spLight )
 {
 	if ( !spLight )
 		return;
 
+	auto itCascades = gShadowCascades.find( spLight );
+	if ( itCascades != gShadowCascades.end() )
+	{
+		Graphics_FreeShadowCascades( itCascades->second );
+		gShadowCascades.erase( itCascades );
+	}
+
 	if ( !spLight->apShadowMap )
 		return;
 
-	if ( spLight->apShadowMap->aFramebuffer )
-		render->DestroyFramebuffer( spLight->apShadowMap->aFramebuffer );
-
-	if ( spLight->apShadowMap->aTexture )
-		gGraphics.FreeTexture( spLight->apShadowMap->aTexture );
-
-	if ( spLight->apShadowMap->aViewportHandle != UINT32_MAX )
-	{
-		gGraphics.FreeViewport( spLight->apShadowMap->aViewportHandle );
-	}
+	Graphics_FreeShadowMap( spLight->apShadowMap );
 
 	delete spLight->apShadowMap;
 	spLight->apShadowMap = nullptr;
@@ -241,7 +366,7 @@ void Graphics_FreeLightSlot( Light_t* spLight )
 		// 	break;
 	}
 
-	if ( spLight->aType == ELightType_Cone )
+	if ( spLight->aType == ELightType_Cone || spLight->aType == ELightType_Directional )
 	{
 		Graphics_DestroyShadowMap( spLight );
 	}
@@ -413,51 +538,7 @@ void Graphics_UpdateLightBuffer( Light_t* spLight )
 			// Util_GetDirectionVectors( spLight->aAng, nullptr, nullptr, &light.aDir );
 			// Util_GetDirectionVectors( spLight->aAng, &light.aDir );
 
-			// update shadow map view info
-#if 0
-			ShadowMap_t&     shadowMap = gLightShadows[ spLight ];
-
-			ViewportCamera_t view{};
-			view.aFarZ  = r_shadowmap_farz;
-			view.aNearZ = r_shadowmap_nearz;
-			// view.aFOV   = spLight->aOuterFov;
-			view.aFOV   = r_shadowmap_fov_hack;
-
-			Transform transform{};
-			transform.aPos                  = spLight->aPos;
-			// transform.aAng = spLight->aAng;
-
-			transform.aAng.x                = -spLight->aAng.z + 90.f;
-			transform.aAng.y                = -spLight->aAng.y;
-			transform.aAng.z                = spLight->aAng.x;
-
-			// shadowMap.aViewInfo.aProjection = glm::ortho< float >( -10, 10, -10, 10, -10, 20 );
-
-			shadowMap.aViewInfo.aProjection = glm::ortho< float >(
-			  r_shadowmap_othro_left,
-			  r_shadowmap_othro_right,
-			  r_shadowmap_othro_bottom,
-			  r_shadowmap_othro_top,
-			  view.aNearZ,
-			  view.aFarZ );
-
-			// shadowMap.aViewInfo.aView       = view.aViewMat;
-			shadowMap.aViewInfo.aView       = glm::lookAt( -light.aDir, glm::vec3( 0, 0, 0 ), glm::vec3( 0, -1, 0 ) );
-			shadowMap.aViewInfo.aProjView   = shadowMap.aViewInfo.aProjection * shadowMap.aViewInfo.aView;
-			shadowMap.aViewInfo.aNearZ      = view.aNearZ;
-			shadowMap.aViewInfo.aFarZ       = view.aFarZ;
-
-			ch_handle_t shadowBuffer             = gViewportBuffers[ shadowMap.aViewInfoIndex ];
-			render->MemWriteBuffer( shadowBuffer, sizeof( UBO_Viewport_t ), &shadowMap.aViewInfo );
-
-			// get shadow map view info
-			light.aProjView = view.aProjViewMat;
-			light.aShadow   = render->GetTextureIndex( shadowMap.aTexture );
-#else
-			// get shadow map view info
-			light.aProjView = glm::identity< glm::mat4 >();
-			light.aShadow   = -1;
-#endif
+			// the shadow cascades are fit to the camera every frame in Graphics_UpdateShadowCascades()
 
 			break;
 		}
@@ -660,57 +741,379 @@ Light_t* Graphics::GetLightByIndex( u32 index )
 }
 
 
-void Graphics_PrepareShadowRenderLists()
+constexpr u64 CH_SHADOW_HASH_BASIS = 0xcbf29ce484222325;
+
+
+static u64 Graphics_HashShadow( u64 sHash, const void* spData, size_t sSize )
 {
-	ChVector< ChVector< ch_handle_t > > shadowRenderables;
-	ChVector< u32 >                    shadowViewports;
-	shadowViewports.reserve( gLights.size() );
+	const u8* data = static_cast< const u8* >( spData );
 
-	u32 viewportCount = 0;
-	for ( Light_t* light : gLights )
+	for ( size_t i = 0; i < sSize; i++ )
+	{
+		sHash ^= data[ i ];
+		sHash *= 0x100000001b3;
+	}
+
+	return sHash;
+}
+
+
+// count how many frames each shadow caster has been still for
+static void Graphics_UpdateShadowCasters()
+{
+	PROF_SCOPE();
+
+	gShadowFrame++;
+
+	for ( size_t i = 0; i < gGraphicsData.aRenderables.size(); i++ )
 	{
-		if ( !light->apShadowMap )
+		ch_handle_t   handle     = gGraphicsData.aRenderables.aHandles[ i ];
+		Renderable_t* renderable = nullptr;
+
+		if ( !gGraphicsData.aRenderables.Get( handle, &renderable ) )
 			continue;
 
-		shadowViewports.push_back( light->apShadowMap->aViewportHandle );
-		viewportCount++;
+		if ( !renderable->aVisible || !renderable->aCastShadow )
+			continue;
+
+		ShadowCasterState_t& state    = gShadowCasters[ handle ];
+
+		// deforming renderables can't go in the static shadow cache either
+		bool                 deformed = renderable->aBlendShapesDirty || renderable->aBonesDirty || gGraphicsData.aSkinningRenderList.count( handle );
+
+		if ( deformed || state.aFrame == 0 || state.aModel != renderable->aModel || memcmp( &state.aMatrix, &renderable->aModelMatrix, sizeof( glm::mat4 ) ) != 0 )
+		{
+			state.aMatrix      = renderable->aModelMatrix;
+			state.aModel       = renderable->aModel;
+			state.aStillFrames = 0;
+		}
+		else if ( state.aStillFrames < UINT32_MAX )
+		{
+			state.aStillFrames++;
+		}
+
+		state.aFrame = gShadowFrame;
+	}
+
+	// remove renderables that were freed or stopped casting shadows
+	for ( auto it = gShadowCasters.begin(); it != gShadowCasters.end(); )
+	{
+		if ( it->second.aFrame != gShadowFrame )
+			it = gShadowCasters.erase( it );
+		else
+			it++;
+	}
+}
+
+
+static void Graphics_AddShadowCaster( ViewRenderList_t& srList, ch_handle_t sShader, ch_handle_t sRenderable, Renderable_t* spRenderable )
+{
+	u32 renderIndex = CH_GET_HANDLE_INDEX( sRenderable );
+
+	if ( renderIndex >= CH_R_MAX_RENDERABLES )
+		return;
+
+	// the main views might not have this renderable, so make sure the matrix is on the gpu
+	spRenderable->aIndex                          = renderIndex;
+	gGraphicsData.aModelMatrixData[ renderIndex ] = spRenderable->aModelMatrix;
+
+	if ( spRenderable->aBlendShapesDirty || spRenderable->aBonesDirty )
+	{
+		gGraphicsData.aSkinningRenderList.emplace( sRenderable );
+		spRenderable->aBlendShapesDirty = false;
+		spRenderable->aBonesDirty       = false;
 	}
 
-	for ( size_t v = 0; v < viewportCount; v++ )
+	for ( u32 surf = 0; surf < spRenderable->aMaterialCount; surf++ )
+	{
+		if ( spRenderable->apMaterials[ surf ] == CH_INVALID_HANDLE )
+			continue;
+
+		SurfaceDraw_t& surfDraw = srList.aRenderLists[ sShader ].emplace_back();
+		surfDraw.aRenderable    = sRenderable;
+		surfDraw.aSurface       = surf;
+	}
+}
+
+
+// the first active perspective view is the camera the cascades are fit to
+static ViewportShader_t* Graphics_GetCascadeCamera()
+{
+	ViewportShader_t* camera       = nullptr;
+	u32               cameraHandle = UINT32_MAX;
+
+	for ( auto& [ viewHandle, viewport ] : gGraphicsData.aViewports )
+	{
+		if ( !viewport.aActive || viewport.aShaderOverride || viewHandle >= cameraHandle )
+			continue;
+
+		if ( viewport.aProjection[ 3 ][ 3 ] != 0.f || viewport.aNearZ <= 0.f || viewport.aFarZ <= viewport.aNearZ )
+			continue;
+
+		camera       = &viewport;
+		cameraHandle = viewHandle;
+	}
+
+	return camera;
+}
+
+
+// Fits an orthographic projection around the bounding sphere of this slice of the camera view
+static void Graphics_FitShadowCascade( const ViewportShader_t& srCamera, const glm::mat4& srInvView, const glm::vec3& srLightDir, float sNearZ, float sFarZ, int sSize, glm::mat4& srView, glm::mat4& srProjection )
+{
+	float     tanX = 1.f / srCamera.aProjection[ 0 ][ 0 ];
+	float     tanY = 1.f / glm::abs( srCamera.aProjection[ 1 ][ 1 ] );
+
+	glm::vec3 corners[ 8 ];
+	glm::vec3 center( 0.f );
+
+	for ( int i = 0; i < 8; i++ )
+	{
+		float     depth = ( i & 4 ) ? sFarZ : sNearZ;
+		glm::vec3 pos( ( i & 1 ) ? tanX * depth : -tanX * depth, ( i & 2 ) ? tanY * depth : -tanY * depth, -depth );
+
+		corners[ i ] = glm::vec3( srInvView * glm::vec4( pos, 1.f ) );
+		center += corners[ i ];
+	}
+
+	center /= 8.f;
+
+	float radius = 0.f;
+	for ( int i = 0; i < 8; i++ )
+		radius = glm::max( radius, glm::length( corners[ i ] - center ) );
+
+	// a sphere doesn't change size when the camera turns, round it up so float error doesn't either
+	radius = glm::ceil( radius * 16.f ) / 16.f;
+
+	// aDir points towards the light, so the light looks down the opposite way
+	glm::vec3 up    = glm::abs( srLightDir.z ) > 0.99f ? glm::vec3( 1.f, 0.f, 0.f ) : glm::vec3( 0.f, 0.f, 1.f );
+	srView          = glm::lookAt( glm::vec3( 0.f ), -srLightDir, up );
+
+	// snap the center to whole texels, so the shadow map only moves in texel steps
+	glm::vec3 lightCenter = glm::vec3( srView * glm::vec4( center, 1.f ) );
+	float     texelSize   = ( radius * 2.f ) / sSize;
+
+	lightCenter.x         = glm::floor( lightCenter.x / texelSize ) * texelSize;
+	lightCenter.y         = glm::floor( lightCenter.y / texelSize ) * texelSize;
+
+	// the view looks down -z, pull the near plane towards the light to catch casters outside the slice
+	float nearZ           = -lightCenter.z - radius - r_shadowmap_cascade_depth;
+	float farZ            = -lightCenter.z + radius;
+
+	srProjection          = glm::orthoRH_ZO( lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius, nearZ, farZ );
+}
+
+
+static void Graphics_UpdateShadowCascades()
+{
+	PROF_SCOPE();
+
+	ViewportShader_t* camera       = Graphics_GetCascadeCamera();
+	u32               cascadeCount = glm::clamp( (int)r_shadowmap_cascades, 1, (int)CH_R_MAX_SHADOW_CASCADES );
+	int               cascadeSize  = glm::max( (int)r_shadowmap_cascade_size, 64 );
+	float             lambda       = glm::clamp( (float)r_shadowmap_cascade_lambda, 0.f, 1.f );
+	float             blend        = glm::clamp( (float)r_shadowmap_cascade_blend, 0.f, 0.5f );
+
+	for ( Light_t* light : gLights )
 	{
-		static ChVector< ch_handle_t > shadowRenderables;
-		shadowRenderables.clear();
-		shadowRenderables.reserve( gGraphicsData.aRenderables.size() );
+		if ( light->aType != ELightType_Directional || light->aShaderIndex == CH_SHADER_CORE_SLOT_INVALID )
+			continue;
+
+		u32                     index     = Graphics_GetCoreSlot( EShaderCoreArray_LightWorld, light->aShaderIndex );
+		UBO_LightDirectional_t& lightData = gGraphicsData.aCoreData.aLightWorld[ index ];
+		UBO_LightDirectional_t  prevData  = lightData;
+
+		ShadowCascades_t&       cascades  = gShadowCascades[ light ];
+
+		lightData.aCascadeCount           = 0;
+		lightData.aShadow                 = { -1, -1, -1, -1 };
 
-		for ( size_t i = 0; i < gGraphicsData.aRenderables.size(); i++ )
+		bool active                       = light->aShadow && light->aEnabled && camera;
+
+		// only recreate when the settings change, so a failed create isn't retried every frame
+		if ( active && ( cascades.aRequestCount != cascadeCount || cascades.aRequestSize != cascadeSize ) )
 		{
-			Renderable_t* renderable = nullptr;
-			if ( !gGraphicsData.aRenderables.Get( gGraphicsData.aRenderables.aHandles[ i ], &renderable ) )
+			Graphics_FreeShadowCascades( cascades );
+
+			cascades.aRequestCount = cascadeCount;
+			cascades.aRequestSize  = cascadeSize;
+
+			for ( u32 i = 0; i < cascadeCount; i++ )
 			{
-				Log_Warn( gLC_ClientGraphics, "Renderable handle is invalid!\n" );
-				gGraphicsData.aRenderables.Remove( gGraphicsData.aRenderables.aHandles[ i ] );
-				continue;
+				// count it first so a partially made cascade is freed too
+				cascades.aCount++;
+
+				if ( !Graphics_CreateShadowMap( &cascades.aCascades[ i ], cascadeSize, "Shadow Cascade" ) )
+				{
+					Graphics_FreeShadowCascades( cascades );
+					break;
+				}
 			}
+		}
 
-			if ( !renderable->aVisible )
-				continue;
+		float nearZ = camera ? camera->aNearZ : 0.f;
+		float farZ  = camera ? glm::min( camera->aFarZ, (float)r_shadowmap_cascade_distance ) : 0.f;
 
-			if ( !renderable->aCastShadow )
-				continue;
+		if ( farZ <= nearZ )
+			active = false;
+
+		if ( active )
+		{
+			glm::mat4 invView   = glm::inverse( camera->aView );
+			float     prevSplit = nearZ;
+			float     sliceNear = nearZ;
 
-			shadowRenderables.push_back( gGraphicsData.aRenderables.aHandles[ i ] );
+			for ( u32 i = 0; i < cascades.aCount; i++ )
+			{
+				// mix between uniform and logarithmic splits
+				float p     = float( i + 1 ) / float( cascades.aCount );
+				float split = glm::mix( nearZ + ( farZ - nearZ ) * p, nearZ * glm::pow( farZ / nearZ, p ), lambda );
+
+				ShadowMap_t&      shadowMap = cascades.aCascades[ i ];
+				ViewportShader_t& viewport  = gGraphicsData.aViewports[ shadowMap.aViewportHandle ];
+
+				Graphics_FitShadowCascade( *camera, invView, lightData.aDir, sliceNear, split, shadowMap.aSize.x, viewport.aView, viewport.aProjection );
+
+				viewport.aProjView            = viewport.aProjection * viewport.aView;
+				viewport.aViewPos             = glm::vec3( invView[ 3 ] );
+				viewport.aNearZ               = sliceNear;
+				viewport.aFarZ                = split;
+				viewport.aSize                = shadowMap.aSize;
+				viewport.aActive              = true;
+
+				lightData.aProjView[ i ]      = viewport.aProjView;
+				lightData.aCascadeSplits[ i ] = split;
+				lightData.aShadow[ i ]        = render->GetTextureIndex( shadowMap.aTexture );
+
+				// start the next cascade where this one starts blending into it
+				sliceNear                     = split - ( split - prevSplit ) * blend;
+				prevSplit                     = split;
+			}
+
+			// shaders pick the cascade by depth from this camera, whatever viewport they're drawing
+			glm::vec3 forward       = -glm::normalize( glm::vec3( invView[ 2 ] ) );
+			glm::vec3 cameraPos     = glm::vec3( invView[ 3 ] );
+
+			lightData.aCascadeCount = cascades.aCount;
+			lightData.aCascadeBlend = blend;
+			lightData.aCascadePlane = glm::vec4( forward, -glm::dot( forward, cameraPos ) );
+			lightData.aCascadeNearZ = nearZ;
 		}
+		else
+		{
+			for ( u32 i = 0; i < cascades.aCount; i++ )
+				gGraphicsData.aViewports[ cascades.aCascades[ i ].aViewportHandle ].aActive = false;
+		}
+
+		if ( memcmp( &prevData, &lightData, sizeof( UBO_LightDirectional_t ) ) != 0 )
+			gGraphicsData.aCoreDataStaging.aDirty = true;
+	}
+}
+
+
+static void Graphics_PrepareShadowRenderList( ShadowMap_t* spShadowMap, ch_handle_t sShader, u32 sStaticFrames )
+{
+	auto itView = gGraphicsData.aViewports.find( spShadowMap->aViewportHandle );
+
+	if ( itView == gGraphicsData.aViewports.end() )
+		return;
+
+	// this is only active if the light is enabled and has shadows turned on
+	ViewportShader_t& viewport = itView->second;
+
+	if ( !viewport.aActive )
+		return;
+
+	gGraphics.CreateFrustum( viewport.aFrustum, viewport.aProjView );
+
+	ShadowCache_t& cache = gShadowCache[ spShadowMap ];
+
+	for ( auto& [ shader, renderList ] : cache.aStaticList.aRenderLists )
+		renderList.clear();
+
+	for ( auto& [ shader, renderList ] : cache.aDynamicList.aRenderLists )
+		renderList.clear();
+
+	u64  staticHash = Graphics_HashShadow( CH_SHADOW_HASH_BASIS, &viewport.aProjView, sizeof( glm::mat4 ) );
+	bool hasDynamic = false;
+
+	for ( size_t i = 0; i < gGraphicsData.aRenderables.size(); i++ )
+	{
+		ch_handle_t   handle     = gGraphicsData.aRenderables.aHandles[ i ];
+		Renderable_t* renderable = nullptr;
+
+		if ( !gGraphicsData.aRenderables.Get( handle, &renderable ) )
+			continue;
+
+		if ( !renderable->aVisible || !renderable->aCastShadow )
+			continue;
+
+		// cull casters outside of the light's view
+		if ( !Graphics_ViewFrustumTest( renderable, viewport ) )
+			continue;
+
+		auto itState = gShadowCasters.find( handle );
 
-		gGraphics.SetViewportRenderList( shadowViewports[ v ], shadowRenderables.data(), shadowRenderables.size() );
+		if ( r_shadowmap_cache && itState != gShadowCasters.end() && itState->second.aStillFrames >= sStaticFrames )
+		{
+			Graphics_AddShadowCaster( cache.aStaticList, sShader, handle, renderable );
+
+			// the matrix can't have changed while it's still, so the handle and model are enough
+			staticHash = Graphics_HashShadow( staticHash, &handle, sizeof( handle ) );
+			staticHash = Graphics_HashShadow( staticHash, &renderable->aModel, sizeof( renderable->aModel ) );
+		}
+		else
+		{
+			Graphics_AddShadowCaster( cache.aDynamicList, sShader, handle, renderable );
+			hasDynamic = true;
+		}
 	}
 
+	cache.aNewStaticHash = staticHash;
+	cache.aNewShadowHash = staticHash;
+	cache.aHasDynamic    = hasDynamic;
+
+	// only static casters, and nothing changed in view of this light since the shadow map was last drawn, so leave it alone
+	// dynamic casters have to be drawn every frame
+	if ( r_shadowmap_cache && !hasDynamic && cache.aShadowCached && cache.aNewShadowHash == cache.aShadowHash )
+		return;
+
+	gShadowMapsToRender.push_back( spShadowMap );
+}
+
+
+void Graphics_PrepareShadowRenderLists()
+{
+	PROF_SCOPE();
+
+	static ch_handle_t shadowShader = gGraphics.GetShader( "__shadow_map" );
+
 	gShadowMapsToRender.clear();
 
-	// Add all lights that have shadow maps
+	// keep the last render lists, but still draw every shadow map
+	if ( r_vis_lock )
+	{
+		for ( auto& [ shadowMap, cache ] : gShadowCache )
+			gShadowMapsToRender.push_back( shadowMap );
+
+		return;
+	}
+
+	Graphics_UpdateShadowCascades();
+	Graphics_UpdateShadowCasters();
+
+	u32 staticFrames = r_shadowmap_static_frames > 1 ? r_shadowmap_static_frames : 1;
+
 	for ( Light_t* light : gLights )
 	{
 		if ( light->apShadowMap )
-			gShadowMapsToRender.push_back( light );
+			Graphics_PrepareShadowRenderList( light->apShadowMap, shadowShader, staticFrames );
+	}
+
+	for ( auto& [ light, cascades ] : gShadowCascades )
+	{
+		for ( u32 i = 0; i < cascades.aCount; i++ )
+			Graphics_PrepareShadowRenderList( &cascades.aCascades[ i ], shadowShader, staticFrames );
 	}
 }
 
@@ -743,6 +1146,7 @@ void Graphics_DestroyLights()
 
 	gDestroyLights.clear();
 	gLights.clear();
+	gShadowCasters.clear();
 }
 
 
@@ -752,17 +1156,18 @@ bool Graphics_IsUsingShadowMaps()
 
 	for ( Light_t* light : gLights )
 	{
-		if ( !light->aEnabled || !light->aShadow || !light->apShadowMap )
+		if ( !light->aEnabled || !light->aShadow )
 			continue;
 
-		return true;
+		if ( light->apShadowMap || gShadowCascades.count( light ) )
+			return true;
 	}
 
 	return false;
 }
 
 
-void Graphics_RenderShadowMap( ch_handle_t cmd, size_t sIndex, Light_t* spLight, ShadowMap_t* shadowMap )
+void Graphics_RenderShadowMap( ch_handle_t cmd, size_t sIndex, ShadowMap_t* shadowMap, ViewRenderList_t& srViewList )
 {
 	PROF_SCOPE();
 
@@ -789,21 +1194,109 @@ void Graphics_RenderShadowMap( ch_handle_t cmd, size_t sIndex, Light_t* spLight,
 	// HACK: need to setup a view push and pop system?
 	Shader_ShadowMap_SetViewInfo( shadowMap->aViewportHandle );
 
-	auto it = gGraphicsData.aViewRenderLists.find( shadowMap->aViewportHandle );
-	if ( it == gGraphicsData.aViewRenderLists.end() )
+	u32 viewIndex = Graphics_GetShaderSlot( gGraphicsData.aViewportSlots, shadowMap->aViewportHandle );
+
+	for ( auto& [ shader, renderList ] : srViewList.aRenderLists )
 	{
-		Log_Error( gLC_ClientGraphics, "Invalid Viewport Index for Shadow Map Rendering\n" );
+		Graphics_DrawShaderRenderables( cmd, sIndex, shader, viewIndex, renderList );
+	}
+}
+
+
+static void Graphics_DrawShadowPass( ch_handle_t sCmd, size_t sIndex, ch_handle_t sRenderPass, ch_handle_t sFramebuffer, ShadowMap_t* spShadowMap, ViewRenderList_t& srViewList )
+{
+	if ( sFramebuffer == CH_INVALID_HANDLE )
 		return;
+
+	RenderPassBegin_t renderPassBegin{};
+	renderPassBegin.aRenderPass  = sRenderPass;
+	renderPassBegin.aFrameBuffer = sFramebuffer;
+	renderPassBegin.aClear.resize( 1 );
+	renderPassBegin.aClear[ 0 ].color    = { 0.f, 0.f, 0.f, 1.f };
+	renderPassBegin.aClear[ 0 ].aIsDepth = true;
+
+	render->BeginRenderPass( sCmd, renderPassBegin );
+	Graphics_RenderShadowMap( sCmd, sIndex, spShadowMap, srViewList );
+	render->EndRenderPass( sCmd );
+}
+
+
+// the static depth map is only made once a light has static casters
+static bool Graphics_CreateShadowCache( ShadowMap_t* spShadowMap, ShadowCache_t& srCache )
+{
+	if ( srCache.aStaticFramebuffer != CH_INVALID_HANDLE )
+		return true;
+
+	TextureCreateInfo_t texCreate{};
+	texCreate.apName    = "Static Shadow Map";
+	texCreate.aSize     = spShadowMap->aSize;
+	texCreate.aFormat   = render->GetSwapFormatDepth();
+	texCreate.aViewType = EImageView_2D;
+
+	TextureCreateData_t createData{};
+	createData.aUsage    = EImageUsage_AttachDepthStencil | EImageUsage_TransferSrc;
+	createData.aFilter   = EImageFilter_Linear;
+
+	srCache.aStaticTexture = gGraphics.CreateTexture( texCreate, createData );
+
+	if ( srCache.aStaticTexture == CH_INVALID_HANDLE )
+	{
+		Log_Error( gLC_ClientGraphics, "Failed to create static shadow map texture\n" );
+		return false;
 	}
 
-	ViewRenderList_t& viewList = it->second;
+	CreateFramebuffer_t frameBufCreate{};
+	frameBufCreate.apName             = "Static Shadow Map Framebuffer";
+	frameBufCreate.aRenderPass        = gGraphicsData.aRenderPassShadow;
+	frameBufCreate.aSize              = spShadowMap->aSize;
+	frameBufCreate.aPass.aAttachDepth = srCache.aStaticTexture;
 
-	u32               viewIndex = Graphics_GetShaderSlot( gGraphicsData.aViewportSlots, shadowMap->aViewportHandle );
+	srCache.aStaticFramebuffer        = render->CreateFramebuffer( frameBufCreate );
 
-	for ( auto& [ shader, renderList ] : viewList.aRenderLists )
+	if ( srCache.aStaticFramebuffer == CH_INVALID_HANDLE )
 	{
-		Graphics_DrawShaderRenderables( cmd, sIndex, shader, viewIndex, renderList );
+		Log_Error( gLC_ClientGraphics, "Failed to create static shadow map framebuffer\n" );
+		gGraphics.FreeTexture( srCache.aStaticTexture );
+		srCache.aStaticTexture = CH_INVALID_HANDLE;
+		return false;
 	}
+
+	return true;
+}
+
+
+static void Graphics_DrawShadowMap( ch_handle_t sCmd, size_t sIndex, ShadowMap_t* shadowMap )
+{
+	PROF_SCOPE();
+
+	ShadowCache_t& cache = gShadowCache[ shadowMap ];
+
+	// no cache, draw everything straight into the shadow map
+	if ( !r_shadowmap_cache || !Graphics_CreateShadowCache( shadowMap, cache ) )
+	{
+		Graphics_DrawShadowPass( sCmd, sIndex, gGraphicsData.aRenderPassShadow, shadowMap->aFramebuffer, shadowMap, cache.aStaticList );
+		Graphics_DrawShadowPass( sCmd, sIndex, gGraphicsData.aRenderPassShadowKeep, shadowMap->aFramebuffer, shadowMap, cache.aDynamicList );
+
+		cache.aStaticCached = false;
+		cache.aShadowCached = false;
+		return;
+	}
+
+	if ( !cache.aStaticCached || cache.aNewStaticHash != cache.aStaticHash )
+	{
+		Graphics_DrawShadowPass( sCmd, sIndex, gGraphicsData.aRenderPassShadow, cache.aStaticFramebuffer, shadowMap, cache.aStaticList );
+		cache.aStaticHash   = cache.aNewStaticHash;
+		cache.aStaticCached = true;
+	}
+
+	render->CmdCopyTexture( sCmd, cache.aStaticTexture, shadowMap->aTexture );
+
+	if ( cache.aHasDynamic )
+		Graphics_DrawShadowPass( sCmd, sIndex, gGraphicsData.aRenderPassShadowKeep, shadowMap->aFramebuffer, shadowMap, cache.aDynamicList );
+
+	// with dynamic casters this frame, the shadow map has to be drawn again next frame
+	cache.aShadowHash   = cache.aNewShadowHash;
+	cache.aShadowCached = !cache.aHasDynamic;
 }
 
 
@@ -819,11 +1312,6 @@ void Graphics_DrawShadowMaps( ch_handle_t sCmd, size_t sIndex, u32* viewports, u
 	if ( viewportCount == 0 || gShadowMapsToRender.empty() )
 		return;
 
-	RenderPassBegin_t renderPassBegin{};
-	renderPassBegin.aClear.resize( 1 );
-	renderPassBegin.aClear[ 0 ].color   = { 0.f, 0.f, 0.f, 1.f };
-	renderPassBegin.aClear[ 0 ].aIsDepth = true;
-	
 	ViewportShader_t** viewportList = ch_malloc< ViewportShader_t* >( viewportCount );
 
 	// Get all viewports
@@ -842,23 +1330,25 @@ void Graphics_DrawShadowMaps( ch_handle_t sCmd, size_t sIndex, u32* viewports, u
 
 	for ( size_t i = 0; i < gShadowMapsToRender.size(); )
 	{
-		Light_t* light = gShadowMapsToRender[ i ]; 
-		if ( !light->aEnabled || !light->aShadow || !light->apShadowMap )
+		ShadowMap_t* shadowMap = gShadowMapsToRender[ i ];
+		auto         it        = gGraphicsData.aViewports.find( shadowMap->aViewportHandle );
+
+		if ( it == gGraphicsData.aViewports.end() )
 		{
+			Log_ErrorF( gLC_ClientGraphics, "Failed to Find Viewport Render List Data\n" );
 			vec_remove_index( gShadowMapsToRender, i );
 			continue;
 		}
 
-		auto it = gGraphicsData.aViewports.find( light->apShadowMap->aViewportHandle );
+		ViewportShader_t* shadowViewport = &it->second;
 
-		if ( it == gGraphicsData.aViewports.end() )
+		// the light was disabled or had shadows turned off
+		if ( !shadowViewport->aActive )
 		{
-			Log_ErrorF( gLC_ClientGraphics, "Failed to Find Viewport Render List Data\n" );
+			vec_remove_index( gShadowMapsToRender, i );
 			continue;
 		}
 
-		ViewportShader_t* shadowViewport = &it->second;
-
 		// Check if the shadowmap view frustum is in view of the current viewport view frustum
 		bool              found          = false;
 		for ( u32 v = 0; v < viewportCount; v++ )
@@ -882,15 +1372,7 @@ void Graphics_DrawShadowMaps( ch_handle_t sCmd, size_t sIndex, u32* viewports, u
 		// Time to render it
 		vec_remove_index( gShadowMapsToRender, i );
 
-		renderPassBegin.aRenderPass  = gGraphicsData.aRenderPassShadow;
-		renderPassBegin.aFrameBuffer = light->apShadowMap->aFramebuffer;
-
-		if ( renderPassBegin.aFrameBuffer == CH_INVALID_HANDLE )
-			continue;
-
-		render->BeginRenderPass( sCmd, renderPassBegin );
-		Graphics_RenderShadowMap( sCmd, sIndex, light, light->apShadowMap );
-		render->EndRenderPass( sCmd );
+		Graphics_DrawShadowMap( sCmd, sIndex, shadowMap );
 	}
 
 	free( viewportList );
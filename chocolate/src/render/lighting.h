@@ -23,3 +23,17 @@ bool   Graphics_IsUsingShadowMaps();
 void   Graphics_DrawShadowMaps( ch_handle_t sCmd, size_t sIndex, u32* viewports, u32 viewportCount );
 
 void   Graphics_ResetShadowMapsRenderList();
+
+// ------------------------------------------------------------------------
+// Light Clusters
+
+// Can this viewport get a light cluster grid this frame
+bool   Graphics_CanClusterLights( const ViewportShader_t& srViewport );
+
+float  Graphics_GetPointLightRange( const UBO_LightPoint_t& srLight, float sCutoff );
+
+// CPU version of light_cluster.comp for one viewport, used to check the gpu result
+void   Graphics_BinLightClusters( const Shader_Viewport_t& srView, const Buffer_Core_t& srCore, float sCutoff, u32* spCounts, u32* spLights );
+
+// Builds the light clusters for every viewport that has a grid, call this outside of a render pass
+void   Graphics_DispatchLightClusters( ch_handle_t sCmd, u32 sCmdIndex, u32* spViewports, u32 sViewportCount );
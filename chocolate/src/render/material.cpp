@@ -117,10 +117,57 @@ static std::unordered_map< ch_string, ch_handle_t > gMaterialPaths;
 static std::unordered_map< ch_string, ch_handle_t > gMaterialNames;  // TODO: use string hashing for this?
 static std::unordered_map< ch_handle_t, ch_handle_t >    gMaterialShaders;
 
+// [texture] = materials with a var using it, so only they're updated when the texture's index changes
+static std::unordered_map< ch_handle_t, std::unordered_set< ch_handle_t > > gTextureMaterials;
+
 static ch_handle_t                                  gInvalidMaterial;
 static std::string                             gStrEmpty;
 
 
+static void Mat_AddTextureRef( ch_handle_t sMat, ch_handle_t sTexture )
+{
+	if ( sTexture != CH_INVALID_HANDLE )
+		gTextureMaterials[ sTexture ].emplace( sMat );
+}
+
+
+static void Mat_EraseTextureRef( ch_handle_t sMat, ch_handle_t sTexture )
+{
+	auto it = gTextureMaterials.find( sTexture );
+	if ( it == gTextureMaterials.end() )
+		return;
+
+	it->second.erase( sMat );
+
+	if ( it->second.empty() )
+		gTextureMaterials.erase( it );
+}
+
+
+// Only removes it if no other var in the material uses this texture
+static void Mat_RemoveTextureRef( ch_handle_t sMat, MaterialData_t* spData, ch_handle_t sTexture )
+{
+	for ( MaterialVar& var : spData->aVars )
+	{
+		if ( var.aType == EMatVar_Texture && var.aDataTexture == sTexture )
+			return;
+	}
+
+	Mat_EraseTextureRef( sMat, sTexture );
+}
+
+
+void Graphics_SetTextureMaterialsDirty( ch_handle_t sTexture )
+{
+	auto it = gTextureMaterials.find( sTexture );
+	if ( it == gTextureMaterials.end() )
+		return;
+
+	for ( ch_handle_t mat : it->second )
+		gGraphicsData.aDirtyMaterials.emplace( mat );
+}
+
+
 const char* Graphics::Mat_GetName( ch_handle_t shMat )
 {
 	for ( auto& [name, mat] : gMaterialNames )
@@ -286,6 +333,7 @@ bool Graphics::Mat_RemoveRef( ch_handle_t sMat )
 		if ( var.aType != EMatVar_Texture )
 			continue;
 
+		Mat_EraseTextureRef( sMat, var.aDataTexture );
 		render->FreeTexture( var.aDataTexture );
 	}
 
@@ -336,7 +384,14 @@ void Mat_SetVarInternal( ch_handle_t mat, const std::string& name, const T& valu
 
 		if ( var.apName == name )
 		{
+			ch_handle_t oldTexture = var.GetTexture();
+
 			var.SetVar( value );
+
+			if ( oldTexture != CH_INVALID_HANDLE )
+				Mat_RemoveTextureRef( mat, data, oldTexture );
+
+			Mat_AddTextureRef( mat, var.GetTexture() );
 			return;
 		}
 	}
@@ -348,6 +403,7 @@ void Mat_SetVarInternal( ch_handle_t mat, const std::string& name, const T& valu
 	var.apName       = ch_str_copy( name.data(), name.size() ).data;
 
 	var.SetVar( value );
+	Mat_AddTextureRef( mat, var.GetTexture() );
 }
 
 
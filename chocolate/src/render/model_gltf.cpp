@@ -215,6 +215,33 @@ static void LoadBlendShapes( MeshBuildData_t& meshBuilder, MeshBuildMaterial_t&
 }
 
 
+// Reads JOINTS_0 and WEIGHTS_0, the accessors can be u8/u16 joints and float/normalized weights, so use the cgltf readers
+static void LoadSkin( MeshBuildMaterial_t& srMaterial, u32 sVertStart, cgltf_accessor* spJoints, cgltf_accessor* spWeights, const ChVector< int >& srIndexList )
+{
+	if ( !spJoints || !spWeights )
+		return;
+
+	MeshBuild_AllocateSkin( srMaterial );
+
+	for ( u32 j = 0; j < srIndexList.size(); j++ )
+	{
+		MeshBuildSkinElement_t& element = srMaterial.apSkin[ sVertStart + j ];
+
+		cgltf_uint              joints[ 4 ]{};
+		cgltf_float             weights[ 4 ]{};
+
+		if ( !cgltf_accessor_read_uint( spJoints, srIndexList[ j ], joints, 4 ) || !cgltf_accessor_read_float( spWeights, srIndexList[ j ], weights, 4 ) )
+			continue;
+
+		for ( u32 i = 0; i < 4; i++ )
+		{
+			element.aJoints[ i ]  = (u16)glm::min( joints[ i ], (cgltf_uint)UINT16_MAX );
+			element.aWeights[ i ] = weights[ i ];
+		}
+	}
+}
+
+
 // TODO: only loads animations, materials, meshes, and textures
 // gltf can load a lot more, but this is not at all handled in the engine, or have any support for it
 // so we'll have to do this one day
@@ -739,6 +766,12 @@ void Graphics_LoadGltfNew( const std::string& srBasePath, const std::string& srP
 	// Parse Model Data
 
 	// Parse gltf_skin* skins;, contains all bone data
+	// joint indices in the vertex data are into the skin's joint list, so this only handles one skin per model
+	for ( size_t si = 0; si < gltf->skins_count; si++ )
+		meshBuilder.aBoneCount = std::max( meshBuilder.aBoneCount, (u32)gltf->skins[ si ].joints_count );
+
+	if ( gltf->skins_count > 1 )
+		Log_WarnF( gLC_ClientGraphics, "Model has %zu skins, only one skeleton per model is supported: \"%s\"\n", gltf->skins_count, srPath.c_str() );
 
 	// NOTE: try only changing the count of every material group first
 	// then at the end, set all the offsets from the count of everything
@@ -916,6 +949,11 @@ void Graphics_LoadGltfNew( const std::string& srBasePath, const std::string& srP
 				// Blend Shapes
 
 				LoadBlendShapes( meshBuilder, meshBuildMaterial, prim, indexList );
+
+				// ---------------------------------------------------------------
+				// Bone Indices and Weights
+
+				LoadSkin( meshBuildMaterial, meshVertStart, jointsBuffer, weightsBuffer, indexList );
 			}
 
 
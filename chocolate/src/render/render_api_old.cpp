@@ -181,12 +181,176 @@ void Graphics_UpdateShaderBufferDescriptors( ShaderBufferList_t& srBufferList, u
 }
 
 
+// Writes every buffer the skinning shader reads, the array bindings are in the same order as Graphics_GetShaderBufferIndex()
+static void Graphics_UpdateSkinningDescSets()
+{
+	gGraphicsData.aBlendShapeWeightBuffers.aDirty = false;
+	gGraphicsData.aBlendShapeDataBuffers.aDirty   = false;
+	gGraphicsData.aSkinBuffers.aDirty             = false;
+
+	auto it = gShaderDescriptorData.aPerShaderSets.find( CH_SHADER_NAME_SKINNING );
+
+	if ( it == gShaderDescriptorData.aPerShaderSets.end() )
+		return;
+
+	ShaderBufferList_t*     bufferLists[] = {
+		&gGraphicsData.aBlendShapeWeightBuffers,
+		&gGraphicsData.aBlendShapeDataBuffers,
+		&gGraphicsData.aSkinBuffers,
+	};
+
+	ChVector< ch_handle_t > buffers[ CH_ARR_SIZE( bufferLists ) ];
+	WriteDescSetBinding_t   bindings[ CH_ARR_SIZE( bufferLists ) + 2 ]{};
+	u32                     bindingCount = 0;
+
+	for ( u32 i = 0; i < CH_ARR_SIZE( bufferLists ); i++ )
+	{
+		// a descriptor write can't be empty
+		if ( bufferLists[ i ]->aBuffers.empty() )
+			continue;
+
+		buffers[ i ].reserve( bufferLists[ i ]->aBuffers.size() );
+
+		for ( auto& [ handle, buffer ] : bufferLists[ i ]->aBuffers )
+			buffers[ i ].push_back( buffer );
+
+		WriteDescSetBinding_t& binding = bindings[ bindingCount++ ];
+		binding.aBinding               = i;
+		binding.aType                  = EDescriptorType_StorageBuffer;
+		binding.aCount                 = buffers[ i ].size();
+		binding.apData                 = buffers[ i ].data();
+	}
+
+	WriteDescSetBinding_t& jobs     = bindings[ bindingCount++ ];
+	jobs.aBinding                   = 3;
+	jobs.aType                      = EDescriptorType_StorageBuffer;
+	jobs.aCount                     = 1;
+	jobs.apData                     = &gGraphicsData.aSkinningJobBuffer;
+
+	WriteDescSetBinding_t& palette  = bindings[ bindingCount++ ];
+	palette.aBinding                = 4;
+	palette.aType                   = EDescriptorType_StorageBuffer;
+	palette.aCount                  = 1;
+	palette.apData                  = &gGraphicsData.aBonePaletteBuffer;
+
+	WriteDescSet_t update{};
+	update.aDescSetCount = it->second.aCount;
+	update.apDescSets    = it->second.apSets;
+	update.aBindingCount = bindingCount;
+	update.apBindings    = bindings;
+
+	render->UpdateDescSets( &update, 1 );
+}
+
+
+// Packs the bone palettes and builds one job per renderable in aSkinningRenderList
+// The results stay in the renderable's own vertex buffer, so only renderables that changed are skinned again
+static void Graphics_PrepareSkinningJobs()
+{
+	PROF_SCOPE();
+
+	gGraphicsData.aBonePalette.clear();
+	gGraphicsData.aSkinningJobs.clear();
+	gGraphicsData.aSkinningOutputs.clear();
+	gGraphicsData.aSkinningGroupCount = 0;
+
+	u32 deferred                      = 0;
+
+	for ( ch_handle_t renderHandle : gGraphicsData.aSkinningRenderList )
+	{
+		Renderable_t* renderable = nullptr;
+		if ( !gGraphicsData.aRenderables.Get( renderHandle, &renderable ) )
+		{
+			Log_Warn( gLC_ClientGraphics, "Renderable does not exist!\n" );
+			continue;
+		}
+
+		if ( !renderable->aOwnsVertexBuffer )
+			continue;
+
+		Model* model = gGraphics.GetModelData( renderable->aModel );
+		if ( !model || !model->apBuffers || !model->apVertexData )
+		{
+			Log_ErrorF( gLC_ClientGraphics, "%s : model is nullptr\n", CH_FUNC_NAME_CLASS );
+			continue;
+		}
+
+		ShaderSkinningJob_t job{};
+		job.aGroupStart         = gGraphicsData.aSkinningGroupCount;
+		job.aVertexCount        = model->apVertexData->aCount;
+		job.aSourceVertexBuffer = Graphics_GetShaderBufferIndex( gGraphicsData.aVertexBuffers, model->apBuffers->aVertexHandle );
+		job.aDestVertexBuffer   = Graphics_GetShaderBufferIndex( gGraphicsData.aVertexBuffers, renderable->aVertexIndex );
+
+		if ( job.aVertexCount == 0 || job.aSourceVertexBuffer == UINT32_MAX || job.aDestVertexBuffer == UINT32_MAX )
+			continue;
+
+		if ( renderable->aBlendShapeWeightsBuffer )
+		{
+			job.aBlendShapeWeightIndex = Graphics_GetShaderBufferIndex( gGraphicsData.aBlendShapeWeightBuffers, renderable->aBlendShapeWeightsIndex );
+			job.aBlendShapeDataIndex   = Graphics_GetShaderBufferIndex( gGraphicsData.aBlendShapeDataBuffers, model->apBuffers->aBlendShapeHandle );
+
+			if ( job.aBlendShapeWeightIndex != UINT32_MAX && job.aBlendShapeDataIndex != UINT32_MAX )
+			{
+				job.aBlendShapeCount = model->apVertexData->aBlendShapeCount;
+				render->BufferWrite( renderable->aBlendShapeWeightsBuffer, renderable->aBlendShapeWeights.size_bytes(), renderable->aBlendShapeWeights.data() );
+			}
+		}
+
+		if ( renderable->aBoneMatrices.size() )
+		{
+			job.aSkinIndex = Graphics_GetShaderBufferIndex( gGraphicsData.aSkinBuffers, model->apBuffers->aSkinHandle );
+
+			if ( job.aSkinIndex != UINT32_MAX )
+			{
+				// out of palette space, skin it next frame instead
+				if ( gGraphicsData.aBonePalette.size() + renderable->aBoneMatrices.size() > CH_R_MAX_BONES )
+				{
+					renderable->aBonesDirty = true;
+					deferred++;
+					continue;
+				}
+
+				job.aBoneOffset = gGraphicsData.aBonePalette.size();
+
+				for ( const glm::mat4& matrix : renderable->aBoneMatrices )
+				{
+					glm::mat4           transposed = glm::transpose( matrix );
+					ShaderBoneMatrix_t& bone       = gGraphicsData.aBonePalette.emplace_back();
+
+					bone.aRows[ 0 ]                = transposed[ 0 ];
+					bone.aRows[ 1 ]                = transposed[ 1 ];
+					bone.aRows[ 2 ]                = transposed[ 2 ];
+				}
+			}
+		}
+
+		gGraphicsData.aSkinningGroupCount += ( job.aVertexCount + 63 ) / 64;
+		gGraphicsData.aSkinningJobs.push_back( job );
+		gGraphicsData.aSkinningOutputs.push_back( renderable->aVertexBuffer );
+	}
+
+	gGraphicsData.aSkinningRenderList.clear();
+
+	if ( deferred )
+		Log_DevF( gLC_ClientGraphics, 1, "Bone palette is full, skinning %u renderables next frame\n", deferred );
+
+	if ( gGraphicsData.aSkinningJobs.empty() )
+		return;
+
+	render->BufferWrite( gGraphicsData.aSkinningJobBuffer, gGraphicsData.aSkinningJobs.size_bytes(), gGraphicsData.aSkinningJobs.data() );
+
+	if ( gGraphicsData.aBonePalette.size() )
+		render->BufferWrite( gGraphicsData.aBonePaletteBuffer, gGraphicsData.aBonePalette.size_bytes(), gGraphicsData.aBonePalette.data() );
+}
+
+
 void Graphics_PrepareDrawData()
 {
 	PROF_SCOPE();
 
 	render->PreRenderPass();
 
+	Shader_UpdateMaterialSlots();
 	Shader_UpdateMaterialVars();
 
 	// update renderable AABB's
@@ -233,19 +397,10 @@ void Graphics_PrepareDrawData()
 	// --------------------------------------------------------------------
 	// Prepare Skinning Compute Shader Buffers
 
-	u32 r = 0;
-	for ( ch_handle_t renderHandle : gGraphicsData.aSkinningRenderList )
-	{
-		Renderable_t* renderable = nullptr;
-		if ( !gGraphicsData.aRenderables.Get( renderHandle, &renderable ) )
-		{
-			Log_Warn( gLC_ClientGraphics, "Renderable does not exist!\n" );
-			continue;
-		}
+	if ( gGraphicsData.aSkinBuffers.aDirty || gGraphicsData.aBlendShapeWeightBuffers.aDirty || gGraphicsData.aBlendShapeDataBuffers.aDirty )
+		Graphics_UpdateSkinningDescSets();
 
-		r++;
-		render->BufferWrite( renderable->aBlendShapeWeightsBuffer, renderable->aBlendShapeWeights.size_bytes(), renderable->aBlendShapeWeights.data() );
-	}
+	Graphics_PrepareSkinningJobs();
 
 	// Update Core Data SSBO
 
@@ -264,6 +419,8 @@ void Graphics_PrepareDrawData()
 
 	// Update Viewport SSBO
 	{
+		u32 clusterGrid = 0;
+
 		for ( auto& [ viewHandle, viewport ] : gGraphicsData.aViewports )
 		{
 			u32                viewIndex      = Graphics_GetShaderSlot( gGraphicsData.aViewportSlots, viewHandle );
@@ -275,6 +432,12 @@ void Graphics_PrepareDrawData()
 			viewportBuffer.aViewPos           = viewport.aViewPos;
 			viewportBuffer.aNearZ             = viewport.aNearZ;
 			viewportBuffer.aFarZ              = viewport.aFarZ;
+
+			// viewports past CH_R_CLUSTER_GRIDS loop over every light
+			if ( clusterGrid < CH_R_CLUSTER_GRIDS && Graphics_CanClusterLights( viewport ) )
+				viewportBuffer.aLightClusters = clusterGrid++;
+			else
+				viewportBuffer.aLightClusters = UINT32_MAX;
 		}
 
 		BufferRegionCopy_t copy;
@@ -348,10 +511,15 @@ void Graphics_PrepareDrawData()
 }
 
 
+// Skins every renderable prepared in Graphics_PrepareSkinningJobs() with one dispatch
 void Graphics_DoSkinning( ch_handle_t sCmd, u32 sCmdIndex )
 {
-#if 1
-	static ch_handle_t shaderSkinning = gGraphics.GetShader( "__skinning" );
+	PROF_SCOPE();
+
+	if ( gGraphicsData.aSkinningJobs.empty() )
+		return;
+
+	static ch_handle_t shaderSkinning = gGraphics.GetShader( CH_SHADER_NAME_SKINNING );
 
 	if ( shaderSkinning == CH_INVALID_HANDLE )
 	{
@@ -365,79 +533,34 @@ void Graphics_DoSkinning( ch_handle_t sCmd, u32 sCmdIndex )
 		return;
 	}
 
-	ShaderData_t*                             shaderSkinningData = Shader_GetData( shaderSkinning );
+	ShaderData_t*       shaderSkinningData = Shader_GetData( shaderSkinning );
 
-	ChVector< GraphicsBufferMemoryBarrier_t > buffers;
+	ShaderSkinning_Push push{};
+	push.aJobCount = gGraphicsData.aSkinningJobs.size();
 
-	u32                                       i = 0;
-	for ( ch_handle_t renderHandle : gGraphicsData.aSkinningRenderList )
-	{
-		Renderable_t* renderable = nullptr;
-		if ( !gGraphicsData.aRenderables.Get( renderHandle, &renderable ) )
-		{
-			Log_Warn( gLC_ClientGraphics, "Renderable does not exist!\n" );
-			continue;
-		}
+	render->CmdPushConstants( sCmd, shaderSkinningData->aLayout, ShaderStage_Compute, 0, sizeof( push ), &push );
+	render->CmdDispatch( sCmd, gGraphicsData.aSkinningGroupCount, 1, 1 );
 
-		// get model data
-		Model* model = gGraphics.GetModelData( renderable->aModel );
-		if ( !model )
-		{
-			Log_ErrorF( gLC_ClientGraphics, "%s : model is nullptr\n", CH_FUNC_NAME_CLASS );
-			continue;
-		}
-
-		// make sure this model has valid vertex buffers
-		if ( model->apBuffers == nullptr || model->apBuffers->aVertex == CH_INVALID_HANDLE )
-		{
-			Log_Error( gLC_ClientGraphics, "No Vertex/Index Buffers for Model??\n" );
-			continue;
-		}
-
-		i++;
-
-		ShaderSkinning_Push push{};
-		push.aRenderable            = CH_GET_HANDLE_INDEX( renderHandle );
-		push.aSourceVertexBuffer    = Graphics_GetShaderBufferIndex( gGraphicsData.aVertexBuffers, model->apBuffers->aVertexHandle );
-		push.aVertexCount           = model->apVertexData->aIndices.empty() ? model->apVertexData->aCount : model->apVertexData->aIndices.size();
-		push.aBlendShapeCount       = model->apVertexData->aBlendShapeCount;
-		push.aBlendShapeWeightIndex = Graphics_GetShaderBufferIndex( gGraphicsData.aBlendShapeWeightBuffers, renderable->aBlendShapeWeightsIndex );
-		push.aBlendShapeDataIndex   = Graphics_GetShaderBufferIndex( gGraphicsData.aBlendShapeDataBuffers, model->apBuffers->aBlendShapeHandle );
-
-		if ( push.aSourceVertexBuffer == UINT32_MAX || push.aBlendShapeWeightIndex == UINT32_MAX || push.aBlendShapeDataIndex == UINT32_MAX )
-			continue;
-
-		render->CmdPushConstants( sCmd, shaderSkinningData->aLayout, ShaderStage_Compute, 0, sizeof( push ), &push );
-		render->CmdDispatch( sCmd, glm::max( 1U, push.aVertexCount / 64 ), 1, 1 );
-
-	#if 0
-		VkBufferMemoryBarrier barrier = vkinit::buffer_barrier(matrixBuffer, _graphicsQueueFamily);
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-
-		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
-	#endif
+	// the main and shadow passes read the skinned vertices in their vertex shaders
+	ChVector< GraphicsBufferMemoryBarrier_t > buffers;
+	buffers.resize( gGraphicsData.aSkinningOutputs.size() );
 
-		GraphicsBufferMemoryBarrier_t& buffer = buffers.emplace_back();
-		buffer.aSrcAccessMask                 = EGraphicsAccess_MemoryRead | EGraphicsAccess_MemoryWrite;
-		buffer.aDstAccessMask                 = EGraphicsAccess_MemoryRead | EGraphicsAccess_MemoryWrite;
-		buffer.aBuffer                        = Graphics_GetShaderBuffer( gGraphicsData.aVertexBuffers, renderable->aVertexIndex );
+	for ( u32 i = 0; i < gGraphicsData.aSkinningOutputs.size(); i++ )
+	{
+		buffers[ i ].aSrcAccessMask = EGraphicsAccess_ShaderWrite;
+		buffers[ i ].aDstAccessMask = EGraphicsAccess_ShaderRead;
+		buffers[ i ].aBuffer        = gGraphicsData.aSkinningOutputs[ i ];
 	}
 
 	PipelineBarrier_t endBarrier{};
-	// endBarrier.aSrcStageMask             = EPipelineStage_BottomOfPipe;  // EPipelineStage_ComputeShader;
-	// endBarrier.aDstStageMask             = EPipelineStage_TopOfPipe;  // EPipelineStage_VertexShader;
 	endBarrier.aSrcStageMask             = EPipelineStage_ComputeShader;
 	endBarrier.aDstStageMask             = EPipelineStage_VertexShader;
-
 	endBarrier.aBufferMemoryBarrierCount = buffers.size();
 	endBarrier.apBufferMemoryBarriers    = buffers.data();
 
 	render->CmdPipelineBarrier( sCmd, endBarrier );
 
-#endif
-
-	gGraphicsData.aSkinningRenderList.clear();
+	gGraphicsData.aSkinningJobs.clear();
 }
 
 
@@ -600,7 +723,7 @@ void RenderSystemOld::Present( ch_handle_t window, u32* viewports, u32 viewportC
 
 		// Animate Materials in a Compute Shader
 		// Run Skinning Compute Shader
-		//Graphics_DoSkinning( c, cmdIndex );
+		Graphics_DoSkinning( c, cmdIndex );
 
 		// Do Selection Rendering
 		if ( aSelectionEnabled && aSelectionThisFrame )
@@ -611,6 +734,9 @@ void RenderSystemOld::Present( ch_handle_t window, u32* viewports, u32 viewportC
 		// Draw Shadow Maps
 		Graphics_DrawShadowMaps( c, cmdIndex, viewports, viewportCount );
 
+		// Bin Point Lights into Clusters
+		Graphics_DispatchLightClusters( c, cmdIndex, viewports, viewportCount );
+
 		// ----------------------------------------------------------
 		// Main RenderPass
 
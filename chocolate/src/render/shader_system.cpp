@@ -2,6 +2,10 @@
 #include "render/irender.h"
 #include "graphics_int.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 
 static std::unordered_map< std::string_view, ch_handle_t >                  gShaderNames;
 static std::unordered_map< std::string_view, ShaderSets_t >            gShaderSets;  // [shader name] = descriptor sets for this shader
@@ -30,8 +34,35 @@ static ChVector< ch_handle_t >                                          gShaderC
 // Shader = [Materials = Shader Material Data]
 static std::unordered_map< ch_handle_t, std::unordered_map< ch_handle_t, ShaderMaterialData > > gShaderMaterials;
 
-// Material = Storage Buffer
-static std::unordered_map< ch_handle_t, DeviceBufferStaging_t >          gMaterialBuffers;
+// frames a freed material slot waits before it's reused, so no command buffer in flight reads the next material's data with it
+constexpr u32                                                           CH_MATERIAL_SLOT_RETIRE_FRAMES = 4;
+
+// material uploads are written into one part of the staging ring each frame, and copied to each shader's material buffer from there
+constexpr u32                                                           CH_MATERIAL_STAGING_SIZE       = 256 * 1024;
+constexpr u32                                                           CH_MATERIAL_STAGING_FRAMES     = 3;
+
+struct RetiredMaterialSlot_t
+{
+	u32 aSlot;
+	u32 aFrame;
+};
+
+// Every material of a shader lives in one buffer, at matIndex * aMaterialSize
+struct ShaderMaterialSlots_t
+{
+	ch_handle_t                          aBuffer = CH_INVALID_HANDLE;
+	std::vector< ch_handle_t >           aSlots;  // CH_INVALID_HANDLE if the slot is free
+	std::vector< u32 >                   aFree;
+	std::vector< RetiredMaterialSlot_t > aRetired;
+	std::vector< u32 >                   aDirty;  // slots to upload this frame
+};
+
+// Shader = Material Slots
+static std::unordered_map< ch_handle_t, ShaderMaterialSlots_t >          gShaderMaterialSlots;
+static u32                                                              gMaterialSlotFrame = 0;
+
+static ch_handle_t                                                      gMaterialStaging     = CH_INVALID_HANDLE;
+static char*                                                            gpMaterialStagingData = nullptr;
 
 
 // shader
@@ -39,6 +70,9 @@ static std::unordered_map< ch_handle_t, DeviceBufferStaging_t >          gMateri
 // data for each material setup for that shader
 
 
+CONVAR_INT( r_shader_threads, 0, CVARF_ARCHIVE, "Threads used to compile shaders on startup and shader_reload, 0 to use every core, 1 to compile them all on the main thread" );
+
+
 CONCMD( shader_reload )
 {
 	render->WaitForQueues();
@@ -237,75 +271,39 @@ bool Shader_CreatePipelineLayout( std::string_view sName, ch_handle_t& srLayout,
 }
 
 
-bool Shader_CreateGraphicsPipeline( ShaderCreate_t& srCreate, ch_handle_t& srPipeline, ch_handle_t& srLayout, ch_handle_t sRenderPass )
+// everything needed to build one shader, filled in on the main thread and compiled on any thread
+struct ShaderBuild_t
 {
-	if ( srCreate.apGraphicsCreate == nullptr )
-	{
-		Log_Error( gLC_ClientGraphics, "FShader_GetGraphicsPipelineCreate is nullptr!\n" );
-		return false;
-	}
-
-	GraphicsPipelineCreate_t pipelineCreate{};
-	srCreate.apGraphicsCreate( pipelineCreate );
+	ShaderCreate_t*          apCreate = nullptr;
+	ch_handle_t              aPipeline = CH_INVALID_HANDLE;
+	ShaderData_t             aShaderData{};
 
-	pipelineCreate.aRenderPass     = sRenderPass;
-	pipelineCreate.apName          = srCreate.apName;
-	pipelineCreate.aPipelineLayout = srLayout;
-
-	if ( !render->CreateGraphicsPipeline( srPipeline, pipelineCreate ) )
-	{
-		Log_ErrorF( "Failed to create Graphics Pipeline for Shader \"%s\"\n", srCreate.apName );
-		return false;
-	}
-
-	return true;
-}
-
-
-bool Shader_CreateComputePipeline( ShaderCreate_t& srCreate, ch_handle_t& srPipeline, ch_handle_t& srLayout, ch_handle_t sRenderPass )
-{
-	if ( srCreate.apComputeCreate == nullptr )
-	{
-		Log_Error( gLC_ClientGraphics, "FShader_GetComputePipelineCreate is nullptr!\n" );
-		return false;
-	}
-
-	ComputePipelineCreate_t pipelineCreate{};
-	srCreate.apComputeCreate( pipelineCreate );
-
-	pipelineCreate.apName          = srCreate.apName;
-	pipelineCreate.aPipelineLayout = srLayout;
-
-	if ( !render->CreateComputePipeline( srPipeline, pipelineCreate ) )
-	{
-		Log_ErrorF( "Failed to create Compute Pipeline for Shader \"%s\"\n", srCreate.apName );
-		return false;
-	}
+	GraphicsPipelineCreate_t aGraphicsCreate{};
+	ComputePipelineCreate_t  aComputeCreate{};
 
-	return true;
-}
+	bool                     aCompiled = false;
+};
 
 
-bool Graphics_CreateShader( bool sRecreate, ch_handle_t sRenderPass, ShaderCreate_t& srCreate )
+// find the existing shader if we are recreating it, make the pipeline layout, and fill in the pipeline create info
+static bool Shader_PrepareBuild( ch_handle_t sRenderPass, ShaderCreate_t& srCreate, ShaderBuild_t& srBuild )
 {
-	ch_handle_t pipeline = CH_INVALID_HANDLE;
+	srBuild.apCreate = &srCreate;
 
-	auto   nameFind = gShaderNames.find( srCreate.apName );
+	auto nameFind    = gShaderNames.find( srCreate.apName );
 	if ( nameFind != gShaderNames.end() )
-		pipeline = nameFind->second;
-
-	ShaderData_t shaderData{};
+		srBuild.aPipeline = nameFind->second;
 
-	if ( pipeline )
+	if ( srBuild.aPipeline )
 	{
-		auto it = gShaderData.find( pipeline );
+		auto it = gShaderData.find( srBuild.aPipeline );
 		if ( it != gShaderData.end() )
 		{
-			shaderData = it->second;
+			srBuild.aShaderData = it->second;
 		}
 	}
 
-	if ( !Shader_CreatePipelineLayout( srCreate.apName, shaderData.aLayout, srCreate.apLayoutCreate ) )
+	if ( !Shader_CreatePipelineLayout( srCreate.apName, srBuild.aShaderData.aLayout, srCreate.apLayoutCreate ) )
 	{
 		Log_Error( gLC_ClientGraphics, "Failed to create Pipeline Layout\n" );
 		return false;
@@ -313,52 +311,104 @@ bool Graphics_CreateShader( bool sRecreate, ch_handle_t sRenderPass, ShaderCreat
 
 	if ( srCreate.aBindPoint == EPipelineBindPoint_Graphics )
 	{
-		if ( !Shader_CreateGraphicsPipeline( srCreate, pipeline, shaderData.aLayout, sRenderPass ) )
+		if ( srCreate.apGraphicsCreate == nullptr )
 		{
-			Log_Error( gLC_ClientGraphics, "Failed to create Graphics Pipeline\n" );
+			Log_Error( gLC_ClientGraphics, "FShader_GetGraphicsPipelineCreate is nullptr!\n" );
 			return false;
 		}
 
-		if ( !sRecreate )
-			gShaderGraphics.push_back( pipeline );
+		srCreate.apGraphicsCreate( srBuild.aGraphicsCreate );
+
+		srBuild.aGraphicsCreate.aRenderPass     = sRenderPass;
+		srBuild.aGraphicsCreate.apName          = srCreate.apName;
+		srBuild.aGraphicsCreate.aPipelineLayout = srBuild.aShaderData.aLayout;
 	}
 	else
 	{
-		if ( !Shader_CreateComputePipeline( srCreate, pipeline, shaderData.aLayout, sRenderPass ) )
+		if ( srCreate.apComputeCreate == nullptr )
 		{
-			Log_Error( gLC_ClientGraphics, "Failed to create Compute Pipeline\n" );
+			Log_Error( gLC_ClientGraphics, "FShader_GetComputePipelineCreate is nullptr!\n" );
 			return false;
 		}
 
-		if ( !sRecreate )
+		srCreate.apComputeCreate( srBuild.aComputeCreate );
+
+		srBuild.aComputeCreate.apName          = srCreate.apName;
+		srBuild.aComputeCreate.aPipelineLayout = srBuild.aShaderData.aLayout;
+	}
+
+	return true;
+}
+
+
+// the slow part, this is safe to call from multiple threads at once, as long as each one has its own build
+static bool Shader_CompileBuild( ShaderBuild_t& srBuild )
+{
+	PROF_SCOPE();
+
+	if ( srBuild.apCreate->aBindPoint == EPipelineBindPoint_Graphics )
+	{
+		if ( !render->CreateGraphicsPipeline( srBuild.aPipeline, srBuild.aGraphicsCreate ) )
+		{
+			Log_ErrorF( gLC_ClientGraphics, "Failed to create Graphics Pipeline for Shader \"%s\"\n", srBuild.apCreate->apName );
+			return false;
+		}
+	}
+	else
+	{
+		if ( !render->CreateComputePipeline( srBuild.aPipeline, srBuild.aComputeCreate ) )
+		{
+			Log_ErrorF( gLC_ClientGraphics, "Failed to create Compute Pipeline for Shader \"%s\"\n", srBuild.apCreate->apName );
+			return false;
+		}
+	}
+
+	srBuild.aCompiled = true;
+	return true;
+}
+
+
+// store the compiled shader, run on the main thread in the same order shaders were registered in
+static bool Shader_FinishBuild( bool sRecreate, ShaderBuild_t& srBuild )
+{
+	ShaderCreate_t& create     = *srBuild.apCreate;
+	ch_handle_t     pipeline   = srBuild.aPipeline;
+	ShaderData_t&   shaderData = srBuild.aShaderData;
+
+	if ( !sRecreate )
+	{
+		if ( create.aBindPoint == EPipelineBindPoint_Graphics )
+			gShaderGraphics.push_back( pipeline );
+		else
 			gShaderCompute.push_back( pipeline );
 	}
 
-	gShaderNames[ srCreate.apName ] = pipeline;
-	gShaderBindPoint[ pipeline ]    = srCreate.aBindPoint;
-	gShaderVertFormat[ pipeline ]   = srCreate.aVertexFormat;
+	gShaderNames[ create.apName ] = pipeline;
+	gShaderBindPoint[ pipeline ]    = create.aBindPoint;
+	gShaderVertFormat[ pipeline ]   = create.aVertexFormat;
 
-	shaderData.aFlags               = srCreate.aFlags;
-	shaderData.aStages              = srCreate.aStages;
-	shaderData.aDynamicState        = srCreate.aDynamicState;
+	shaderData.aFlags               = create.aFlags;
+	shaderData.aStages              = create.aStages;
+	shaderData.aDynamicState        = create.aDynamicState;
 
-	shaderData.apBindings           = srCreate.apBindings;
-	shaderData.aBindingCount        = srCreate.aBindingCount;
+	shaderData.apBindings           = create.apBindings;
+	shaderData.aBindingCount        = create.aBindingCount;
 
-	// shaderData.aPushSize            = srCreate.aPushSize;
-	// shaderData.apPushSetup          = srCreate.apPushSetup;
+	// shaderData.aPushSize            = create.aPushSize;
+	// shaderData.apPushSetup          = create.apPushSetup;
 
-	shaderData.aMaterialBufferBinding = srCreate.aMaterialBufferBinding;
-	shaderData.aMaterialSize        = srCreate.aMaterialSize;
-	shaderData.aMaterialVarCount    = srCreate.aMaterialVarCount;
-	shaderData.apMaterialVars       = srCreate.apMaterialVars;
-	shaderData.aUseMaterialBuffer   = srCreate.aUseMaterialBuffer;
+	shaderData.aMaterialBufferBinding = create.aMaterialBufferBinding;
+	shaderData.aMaterialSize        = create.aMaterialSize;
+	shaderData.aMaterialVarCount    = create.aMaterialVarCount;
+	shaderData.apMaterialVars       = create.apMaterialVars;
+	shaderData.aUseMaterialBuffer   = create.aUseMaterialBuffer;
+	shaderData.aMaxMaterials        = create.aMaxMaterials;
 
-	if ( srCreate.apShaderPush )
-		shaderData.apPush = srCreate.apShaderPush;
+	if ( create.apShaderPush )
+		shaderData.apPush = create.apShaderPush;
 
-	if ( srCreate.apShaderPushComp )
-		shaderData.apPushComp = srCreate.apShaderPushComp;
+	if ( create.apShaderPushComp )
+		shaderData.apPushComp = create.apShaderPushComp;
 
 	gShaderData[ pipeline ] = shaderData;
 
@@ -384,17 +434,28 @@ bool Graphics_CreateShader( bool sRecreate, ch_handle_t sRenderPass, ShaderCreat
 
 	if ( !sRecreate )
 	{
-		if ( srCreate.apDestroy )
-			gShaderDestroy[ pipeline ] = srCreate.apDestroy;
+		if ( create.apDestroy )
+			gShaderDestroy[ pipeline ] = create.apDestroy;
 
-		if ( srCreate.apInit )
-			return srCreate.apInit();
+		if ( create.apInit )
+			return create.apInit();
 	}
 
 	return true;
 }
 
 
+bool Graphics_CreateShader( bool sRecreate, ch_handle_t sRenderPass, ShaderCreate_t& srCreate )
+{
+	ShaderBuild_t build{};
+
+	if ( !Shader_PrepareBuild( sRenderPass, srCreate, build ) || !Shader_CompileBuild( build ) )
+		return false;
+
+	return Shader_FinishBuild( sRecreate, build );
+}
+
+
 void Shader_Destroy( ch_handle_t sShader )
 {
 	auto it = gShaderData.find( sShader );
@@ -419,6 +480,15 @@ void Shader_Destroy( ch_handle_t sShader )
 
 	gShaderMaterials.erase( sShader );
 
+	auto slotIt = gShaderMaterialSlots.find( sShader );
+	if ( slotIt != gShaderMaterialSlots.end() )
+	{
+		if ( slotIt->second.aBuffer )
+			render->DestroyBuffer( slotIt->second.aBuffer );
+
+		gShaderMaterialSlots.erase( slotIt );
+	}
+
 	render->DestroyPipelineLayout( shaderData.aLayout );
 	render->DestroyPipeline( sShader );
 
@@ -437,11 +507,55 @@ void Shader_Destroy( ch_handle_t sShader )
 }
 
 
+static void Shader_CompileBuilds( std::vector< ShaderBuild_t >& srBuilds )
+{
+	PROF_SCOPE();
+
+	u32 threadCount = r_shader_threads > 0 ? r_shader_threads : std::thread::hardware_concurrency();
+	threadCount     = std::clamp< u32 >( threadCount, 1, srBuilds.size() );
+
+	if ( threadCount <= 1 )
+	{
+		for ( ShaderBuild_t& build : srBuilds )
+			Shader_CompileBuild( build );
+
+		return;
+	}
+
+	// each thread grabs the next shader that hasn't been started yet, so one slow shader doesn't hold up the rest
+	std::atomic< u32 >          next = 0;
+	std::vector< std::thread > threads;
+	threads.reserve( threadCount - 1 );
+
+	auto compileFunc = [ & ]()
+	{
+		for ( u32 i = next++; i < srBuilds.size(); i = next++ )
+			Shader_CompileBuild( srBuilds[ i ] );
+	};
+
+	for ( u32 i = 1; i < threadCount; i++ )
+		threads.emplace_back( compileFunc );
+
+	// the main thread helps out instead of just waiting
+	compileFunc();
+
+	for ( std::thread& thread : threads )
+		thread.join();
+}
+
+
 bool Graphics_ShaderInit( bool sRecreate )
 {
-	for ( ShaderCreate_t* shaderCreate : Shader_GetCreateList() )
+	PROF_SCOPE();
+
+	auto                         startTime = std::chrono::steady_clock::now();
+	std::vector< ShaderBuild_t > builds;
+	builds.resize( Shader_GetCreateList().size() );
+
+	for ( size_t i = 0; i < Shader_GetCreateList().size(); i++ )
 	{
-		ch_handle_t renderPass = gGraphicsData.aRenderPassGraphics;
+		ShaderCreate_t* shaderCreate = Shader_GetCreateList()[ i ];
+		ch_handle_t     renderPass   = gGraphicsData.aRenderPassGraphics;
 
 		if ( shaderCreate->aRenderPass == ERenderPass_Shadow )
 			renderPass = gGraphicsData.aRenderPassShadow;
@@ -449,13 +563,27 @@ bool Graphics_ShaderInit( bool sRecreate )
 		if ( shaderCreate->aRenderPass == ERenderPass_Select )
 			renderPass = gGraphicsData.aRenderPassSelect;
 
-		if ( !Graphics_CreateShader( sRecreate, renderPass, *shaderCreate ) )
+		if ( !Shader_PrepareBuild( renderPass, *shaderCreate, builds[ i ] ) )
 		{
 			Log_ErrorF( gLC_ClientGraphics, "Failed to create shader \"%s\"\n", shaderCreate->apName );
 			return false;
 		}
 	}
 
+	Shader_CompileBuilds( builds );
+
+	for ( ShaderBuild_t& build : builds )
+	{
+		if ( !build.aCompiled || !Shader_FinishBuild( sRecreate, build ) )
+		{
+			Log_ErrorF( gLC_ClientGraphics, "Failed to create shader \"%s\"\n", build.apCreate->apName );
+			return false;
+		}
+	}
+
+	float time = std::chrono::duration< float, std::milli >( std::chrono::steady_clock::now() - startTime ).count();
+	Log_DevF( gLC_ClientGraphics, 1, "Created %zu shaders in %.2f ms\n", builds.size(), time );
+
 	return true;
 }
 
@@ -463,6 +591,12 @@ bool Graphics_ShaderInit( bool sRecreate )
 void Graphics_ShaderDestroy()
 {
 	Log_Error( gLC_ClientGraphics, "TODO: Delete Shaders!!!!!\n" );
+
+	if ( gMaterialStaging )
+		render->DestroyBuffer( gMaterialStaging );
+
+	gMaterialStaging      = CH_INVALID_HANDLE;
+	gpMaterialStagingData = nullptr;
 }
 
 
@@ -617,82 +751,72 @@ VertexFormat Shader_GetVertexFormat( ch_handle_t sShader )
 //}
 
 
-void Shader_UpdateMaterialDescriptorSets( ch_handle_t shader, ShaderData_t* shaderData, std::unordered_map< ch_handle_t, ShaderMaterialData >& shaderMatDataList )
+// Creates the buffer holding every material of a shader, and points the shader's descriptor sets at it
+// The first time this is called, nothing can have drawn with the material binding yet, otherwise the queues have to be idle
+static bool Shader_CreateMaterialBuffer( ch_handle_t sShader, ShaderData_t* spShaderData, ShaderMaterialSlots_t& srSlots )
 {
-	// can't update without any material buffers
-	if ( shaderMatDataList.size() == 0 )
-		return;
+	CH_ASSERT_MSG( spShaderData->aBindingCount != 0, "Shader has no bindings, but we need one for materials!" );
 
-	CH_ASSERT_MSG( shaderData->aBindingCount != 0, "Shader has no bindings, but we need one for materials!" );
+	const char* shaderName = gGraphics.GetShaderName( sShader );
+	u32         size       = spShaderData->aMaxMaterials * spShaderData->aMaterialSize;
 
-	const char* shaderName = gGraphics.GetShaderName( shader );
+	srSlots.aBuffer        = render->CreateBuffer( shaderName, size, EBufferFlags_Storage | EBufferFlags_TransferDst, EBufferMemory_Device );
 
-	// update the descriptor sets
-	WriteDescSet_t update{};
+	if ( !srSlots.aBuffer )
+	{
+		Log_ErrorF( gLC_ClientGraphics, "Failed to create material buffer for shader \"%s\"\n", shaderName );
+		return false;
+	}
 
-	update.aDescSetCount = gShaderDescriptorData.aPerShaderSets[ shaderName ].aCount;
-	update.apDescSets    = gShaderDescriptorData.aPerShaderSets[ shaderName ].apSets;
+	const CreateDescBinding_t& matBinding = spShaderData->apBindings[ spShaderData->aMaterialBufferBinding ];
 
-	// update.aBindingCount = CH_ARR_SIZE( gBasic3D_Bindings );
-	update.aBindingCount = shaderData->aBindingCount;
-	update.apBindings    = ch_calloc< WriteDescSetBinding_t >( update.aBindingCount );
+	WriteDescSetBinding_t      binding{};
+	binding.aBinding     = matBinding.aBinding;
+	binding.aType        = matBinding.aType;
+	binding.aCount       = 1;
+	binding.apData       = &srSlots.aBuffer;
 
-	size_t i             = 0;
-	for ( size_t binding = 0; binding < update.aBindingCount; binding++ )
-	{
-		update.apBindings[ i ].aBinding = shaderData->apBindings[ binding ].aBinding;
-		update.apBindings[ i ].aType    = shaderData->apBindings[ binding ].aType;
-		update.apBindings[ i ].aCount   = shaderData->apBindings[ binding ].aCount;
-		i++;
-	}
+	ShaderDescriptor_t& sets = gShaderDescriptorData.aPerShaderSets[ shaderName ];
 
-	// GOD - update material indexes
-	u32 matIndex = 0;
-	for ( auto& [ material, shaderMat ] : shaderMatDataList )
-	{
-		shaderMat.matIndex = matIndex++;
-	}
+	WriteDescSet_t      update{};
+	update.aDescSetCount = sets.aCount;
+	update.apDescSets    = sets.apSets;
+	update.aBindingCount = 1;
+	update.apBindings    = &binding;
 
-	// update.apBindings[ shaderData->aMaterialBufferBinding ].apData = ch_calloc< ch_handle_t >( CH_BASIC3D_MAX_MATERIALS );
-	update.apBindings[ shaderData->aMaterialBufferBinding ].apData = ch_calloc< ch_handle_t >( shaderMatDataList.size() );
-	update.apBindings[ shaderData->aMaterialBufferBinding ].aCount = shaderMatDataList.size();
+	render->UpdateDescSets( &update, 1 );
+	return true;
+}
 
-	i                                                            = 0;
 
-	// for ( ch_handle_t buffer : bufferList )
-	// {
-	// 	update.apBindings[ shaderData->aMaterialBufferBinding ].apData[ i++ ] = buffer;
-	// }
+// Called once a frame, before the material vars are written
+void Shader_UpdateMaterialSlots()
+{
+	PROF_SCOPE();
+
+	gMaterialSlotFrame++;
 
-	for ( const auto& [ mat, matBuffer ] : gMaterialBuffers )
+	for ( auto& [ shader, slots ] : gShaderMaterialSlots )
 	{
-		if ( gGraphics.Mat_GetShader( mat ) != shader )
-			continue;
-
-		auto it = shaderMatDataList.find( mat );
-		if ( it == shaderMatDataList.end() )
+		// return slots nothing in flight can be using anymore
+		size_t retired = 0;
+		for ( size_t i = 0; i < slots.aRetired.size(); i++ )
 		{
-			Log_Error( "Failed to find material in use by shader\n" );
-			continue;
-		}
+			RetiredMaterialSlot_t& slot = slots.aRetired[ i ];
 
-		update.apBindings[ shaderData->aMaterialBufferBinding ].apData[ it->second.matIndex ] = matBuffer.aBuffer;
+			if ( gMaterialSlotFrame - slot.aFrame >= CH_MATERIAL_SLOT_RETIRE_FRAMES )
+				slots.aFree.push_back( slot.aSlot );
+			else
+				slots.aRetired[ retired++ ] = slot;
+		}
 
-		// update.apBindings[ shaderData->aMaterialBufferBinding ].apData[ i++ ] = matBuffer.aBuffer;
+		slots.aRetired.resize( retired );
 	}
-
-	// update.aImages = gViewportBuffers;
-	render->UpdateDescSets( &update, 1 );
-
-	free( update.apBindings[ shaderData->aMaterialBufferBinding ].apData );
-	free( update.apBindings );
 }
 
 
 void Shader_RemoveMaterial( ch_handle_t sMat )
 {
-	// TODO: queue this
-
 	ch_handle_t shader = gGraphics.Mat_GetShader( sMat );
 
 	if ( shader == CH_INVALID_HANDLE )
@@ -709,46 +833,35 @@ void Shader_RemoveMaterial( ch_handle_t sMat )
 		return;
 	}
 
-	ShaderData_t*                                         shaderData   = Shader_GetData( shader );
-	std::unordered_map< ch_handle_t, ShaderMaterialData >& matData      = shaderIt->second;
-	bool                                                  foundMatData = false;
+	ShaderData_t*                                         shaderData = Shader_GetData( shader );
+	std::unordered_map< ch_handle_t, ShaderMaterialData >& matData    = shaderIt->second;
 
 	auto matIt = matData.find( sMat );
 
-	if ( matIt != matData.end() )
+	if ( matIt == matData.end() )
 	{
-		matData.erase( matIt );
-		foundMatData = true;
+		Log_Error( gLC_ClientGraphics, "Failed to find material in use by shader\n" );
+		return;
 	}
 
-	// Update Descriptor Sets after removing the material data
-	if ( foundMatData && shaderData->aUseMaterialBuffer )
-	{
-		auto it = gMaterialBuffers.find( sMat );
+	u32 slot = matIt->second.matIndex;
+	matData.erase( matIt );
 
-		if ( it == gMaterialBuffers.end() )
-		{
-			const char* matName = gGraphics.Mat_GetName( sMat );
-			Log_ErrorF( "Failed to find buffer to free for material %s\n", matName );
-		}
-		else
-		{
-			Graphics_FreeStagingBuffer( it->second );
-			gMaterialBuffers.erase( it );
-		}
+	if ( !shaderData->aUseMaterialBuffer )
+		return;
 
-		Shader_UpdateMaterialDescriptorSets( shader, shaderData, matData );
-	}
+	ShaderMaterialSlots_t& slots = gShaderMaterialSlots[ shader ];
 
-	if ( !foundMatData )
-		Log_Error( gLC_ClientGraphics, "Failed to find material in use by shader\n" );
+	if ( slot < slots.aSlots.size() && slots.aSlots[ slot ] == sMat )
+	{
+		slots.aSlots[ slot ] = CH_INVALID_HANDLE;
+		slots.aRetired.push_back( { slot, gMaterialSlotFrame } );
+	}
 }
 
 
 void Shader_AddMaterial( ch_handle_t sMat )
 {
-	// TODO: queue this
-
 	ch_handle_t shader = gGraphics.Mat_GetShader( sMat );
 
 	if ( shader == CH_INVALID_HANDLE )
@@ -770,81 +883,86 @@ void Shader_AddMaterial( ch_handle_t sMat )
 	// TODO: find shader data, and write vars
 	ShaderData_t*      shaderData = Shader_GetData( shader );
 
-	// Shaders might use this material data in push constants, so add it even if the shader doesn't use material buffers
-	shaderIt->second[ sMat ] = data;
-
 	if ( shaderData->aUseMaterialBuffer )
 	{
-		const char*            matName    = gGraphics.Mat_GetName( sMat );
-		DeviceBufferStaging_t& buffer     = gMaterialBuffers[ sMat ];
+		ShaderMaterialSlots_t& slots   = gShaderMaterialSlots[ shader ];
+		const char*            matName = gGraphics.Mat_GetName( sMat );
 
-		if ( !Graphics_CreateStagingBuffer( buffer, shaderData->aMaterialSize, matName, matName ) )
+		if ( !slots.aBuffer && !Shader_CreateMaterialBuffer( shader, shaderData, slots ) )
+			return;
+
+		if ( slots.aFree.size() )
+		{
+			data.matIndex = slots.aFree.back();
+			slots.aFree.pop_back();
+		}
+		else if ( slots.aSlots.size() < shaderData->aMaxMaterials )
+		{
+			data.matIndex = slots.aSlots.size();
+			slots.aSlots.push_back( CH_INVALID_HANDLE );
+		}
+		else
 		{
-			Log_FatalF( "Failed to create buffer for material %s\n", matName );
+			Log_ErrorF( gLC_ClientGraphics, "Out of material slots for shader \"%s\" (Max of %u), can't add material %s\n",
+			            gGraphics.GetShaderName( shader ), shaderData->aMaxMaterials, matName );
+			return;
 		}
 
-		Shader_UpdateMaterialDescriptorSets( shader, shaderData, shaderIt->second );
+		// the data is uploaded once the material vars are written in Shader_UpdateMaterialVars()
+		slots.aSlots[ data.matIndex ] = sMat;
 	}
+
+	// Shaders might use this material data in push constants, so add it even if the shader doesn't use material buffers
+	shaderIt->second[ sMat ] = data;
 }
 
 
-void Shader_WriteMaterialBuffer( ch_handle_t mat, ch_handle_t shader, ShaderData_t* shaderData, ShaderMaterialData* materialData )
+// Packs the material vars into the layout the shader reads them in
+static void Shader_WriteMaterialBuffer( ShaderData_t* spShaderData, ShaderMaterialData* spMaterialData, char* spDst )
 {
-	auto bufIt = gMaterialBuffers.find( mat );
-
-	if ( bufIt == gMaterialBuffers.end() )
-		return;
-
-	// Prepare New Data
-	char* writeData = (char*)calloc( 1, shaderData->aMaterialSize );
-
-	if ( writeData == nullptr )
-	{
-		Log_Error( "Failed to allocate memory for material buffer write\n" );
-		return;
-	}
+	memset( spDst, 0, spShaderData->aMaterialSize );
 
-	for ( u32 varI = 0; varI < shaderData->aMaterialVarCount; varI++ )
+	for ( u32 varI = 0; varI < spShaderData->aMaterialVarCount; varI++ )
 	{
-		ShaderMaterialVarDesc& desc = shaderData->apMaterialVars[ varI ];
+		ShaderMaterialVarDesc& desc = spShaderData->apMaterialVars[ varI ];
 
 		switch ( desc.type )
 		{
 			case EMatVar_Texture:
 			{
-				int texIndex = render->GetTextureIndex( materialData->vars[ varI ].aTexture );
-				memcpy( writeData + desc.dataOffset, &texIndex, desc.dataSize );
+				int texIndex = render->GetTextureIndex( spMaterialData->vars[ varI ].aTexture );
+				memcpy( spDst + desc.dataOffset, &texIndex, desc.dataSize );
 				break;
 			}
 			case EMatVar_Float:
 			{
-				memcpy( writeData + desc.dataOffset, &materialData->vars[ varI ].aFloat, desc.dataSize );
+				memcpy( spDst + desc.dataOffset, &spMaterialData->vars[ varI ].aFloat, desc.dataSize );
 				break;
 			}
 			case EMatVar_Int:
 			{
-				memcpy( writeData + desc.dataOffset, &materialData->vars[ varI ].aInt, desc.dataSize );
+				memcpy( spDst + desc.dataOffset, &spMaterialData->vars[ varI ].aInt, desc.dataSize );
 				break;
 			}
 			//case EMatVar_Bool:
 			//{
-			//	bool* b = (bool*)( writeData + desc.dataOffset );
-			//	*b = materialData->vars[ varI ].aBool;
+			//	bool* b = (bool*)( spDst + desc.dataOffset );
+			//	*b = spMaterialData->vars[ varI ].aBool;
 			//	break;
 			//}
 			case EMatVar_Vec2:
 			{
-				memcpy( writeData + desc.dataOffset, &materialData->vars[ varI ].aVec2, desc.dataSize );
+				memcpy( spDst + desc.dataOffset, &spMaterialData->vars[ varI ].aVec2, desc.dataSize );
 				break;
 			}
 			case EMatVar_Vec3:
 			{
-				memcpy( writeData + desc.dataOffset, &materialData->vars[ varI ].aVec3, desc.dataSize );
+				memcpy( spDst + desc.dataOffset, &spMaterialData->vars[ varI ].aVec3, desc.dataSize );
 				break;
 			}
 			case EMatVar_Vec4:
 			{
-				memcpy( writeData + desc.dataOffset, &materialData->vars[ varI ].aVec4, desc.dataSize );
+				memcpy( spDst + desc.dataOffset, &spMaterialData->vars[ varI ].aVec4, desc.dataSize );
 				break;
 			}
 
@@ -853,23 +971,142 @@ void Shader_WriteMaterialBuffer( ch_handle_t mat, ch_handle_t shader, ShaderData
 				break;
 		}
 	}
+}
+
+
+// Writes every dirty material into this frame's part of the staging ring, sorted by slot,
+// so materials next to each other in the material buffer become one copy region
+static void Shader_UploadMaterialBuffers()
+{
+	PROF_SCOPE();
+
+	if ( !gMaterialStaging )
+	{
+		gMaterialStaging = render->CreateBuffer( "Material Staging Ring", CH_MATERIAL_STAGING_SIZE * CH_MATERIAL_STAGING_FRAMES, EBufferFlags_TransferSrc, EBufferMemory_Host );
+
+		if ( gMaterialStaging )
+			gpMaterialStagingData = (char*)render->BufferMap( gMaterialStaging );
+
+		if ( !gpMaterialStagingData )
+		{
+			Log_Fatal( gLC_ClientGraphics, "Failed to create material staging buffer\n" );
+			return;
+		}
+	}
+
+	u32                           ringStart    = ( gMaterialSlotFrame % CH_MATERIAL_STAGING_FRAMES ) * CH_MATERIAL_STAGING_SIZE;
+	u32                           ringOffset   = 0;
+	u32                           uploadCount  = 0;
+	bool                          full         = false;
+
+	ChVector< BufferRegionCopy_t > regions;
+
+	for ( auto& [ shader, slots ] : gShaderMaterialSlots )
+	{
+		if ( slots.aDirty.empty() || !slots.aBuffer )
+			continue;
+
+		ShaderData_t* shaderData = Shader_GetData( shader );
+		u32           stride     = shaderData->aMaterialSize;
+
+		std::sort( slots.aDirty.begin(), slots.aDirty.end() );
+		slots.aDirty.erase( std::unique( slots.aDirty.begin(), slots.aDirty.end() ), slots.aDirty.end() );
+
+		regions.clear();
+
+		size_t slotI = 0;
+		for ( ; slotI < slots.aDirty.size(); slotI++ )
+		{
+			u32 slot = slots.aDirty[ slotI ];
+
+			// freed since it was marked dirty
+			if ( slot >= slots.aSlots.size() || slots.aSlots[ slot ] == CH_INVALID_HANDLE )
+				continue;
+
+			// the rest are uploaded next frame
+			if ( ringOffset + stride > CH_MATERIAL_STAGING_SIZE )
+			{
+				full = true;
+				break;
+			}
+
+			ShaderMaterialData* data = Shader_GetMaterialData( shader, slots.aSlots[ slot ] );
+
+			if ( !data )
+				continue;
+
+			Shader_WriteMaterialBuffer( shaderData, data, gpMaterialStagingData + ringStart + ringOffset );
+
+			BufferRegionCopy_t* region = regions.size() ? regions.back() : nullptr;
+
+			if ( region && region->aDstOffset + region->aSize == slot * stride && region->aSrcOffset + region->aSize == ringStart + ringOffset )
+			{
+				region->aSize += stride;
+			}
+			else
+			{
+				region             = &regions.emplace_back();
+				region->aSrcOffset = ringStart + ringOffset;
+				region->aDstOffset = slot * stride;
+				region->aSize      = stride;
+			}
+
+			ringOffset += stride;
+			uploadCount++;
+		}
+
+		slots.aDirty.erase( slots.aDirty.begin(), slots.aDirty.begin() + slotI );
+
+		if ( regions.size() )
+			render->BufferCopyQueued( gMaterialStaging, slots.aBuffer, regions.apData, regions.size() );
+
+		if ( full )
+			break;
+	}
 
-	render->BufferWrite( bufIt->second.aStagingBuffer, shaderData->aMaterialSize, writeData );
+	if ( uploadCount )
+		Log_DevF( gLC_ClientGraphics, 2, "Uploaded %u Materials (%.3f KB)\n", uploadCount, ch_bytes_to_kb( ringOffset ) );
 
-	free( writeData );
+	if ( full )
+		Log_DevF( gLC_ClientGraphics, 1, "Material staging ring is full, uploading the rest of the materials next frame\n" );
+}
 
-	// write new material data to the buffer
-	BufferRegionCopy_t copy;
-	copy.aSrcOffset = 0;
-	copy.aDstOffset = 0;
-	copy.aSize      = shaderData->aMaterialSize;
 
-	render->BufferCopyQueued( bufIt->second.aStagingBuffer, bufIt->second.aBuffer, &copy, 1 );
+// Finds where each shader material var is in the material's var list, so the vars don't need to be looked up by name every update
+static void Shader_ResolveMaterialVars( ch_handle_t sMat, ShaderData_t* spShaderData, ShaderMaterialData* spData )
+{
+	u32 matVarCount = (u32)gGraphics.Mat_GetVarCount( sMat );
+
+	// material vars are only ever added, so the indices we have are still valid if the count didn't change
+	if ( spData->varIndices.size() == spShaderData->aMaterialVarCount && spData->varIndicesMatVarCount == matVarCount )
+		return;
+
+	spData->varIndices.resize( spShaderData->aMaterialVarCount );
+	spData->varIndicesMatVarCount = matVarCount;
+
+	for ( u32 varI = 0; varI < spShaderData->aMaterialVarCount; varI++ )
+	{
+		std::string_view name = spShaderData->apMaterialVars[ varI ].name;
+		spData->varIndices[ varI ] = UINT32_MAX;
+
+		for ( u32 matVarI = 0; matVarI < matVarCount; matVarI++ )
+		{
+			const char* matVarName = gGraphics.Mat_GetVarName( sMat, matVarI );
+
+			if ( matVarName && name == matVarName )
+			{
+				spData->varIndices[ varI ] = matVarI;
+				break;
+			}
+		}
+	}
 }
 
 
 void Shader_UpdateMaterialVars()
 {
+	PROF_SCOPE();
+
 	for ( const auto& mat : gGraphicsData.aDirtyMaterials )
 	{
 		ch_handle_t    shader     = gGraphics.Mat_GetShader( mat );
@@ -888,48 +1125,51 @@ void Shader_UpdateMaterialVars()
 			continue;
 		}
 
-		// update vars
+		Shader_ResolveMaterialVars( mat, shaderData, data );
+
+		// update vars, vars the material doesn't have use the shader default
 		data->vars.resize( shaderData->aMaterialVarCount );
 		for ( u32 varI = 0; varI < shaderData->aMaterialVarCount; varI++ )
 		{
-			ShaderMaterialVarDesc& desc = shaderData->apMaterialVars[ varI ];
-			data->vars[ varI ].aType    = desc.type;
+			ShaderMaterialVarDesc& desc     = shaderData->apMaterialVars[ varI ];
+			u32                    matVarI  = data->varIndices[ varI ];
+			data->vars[ varI ].aType        = desc.type;
 
 			switch ( desc.type )
 			{
 				case EMatVar_Texture:
 				{
-					data->vars[ varI ].aTexture = gGraphics.Mat_GetTexture( mat, desc.name, desc.defaultTextureHandle );
+					data->vars[ varI ].aTexture = matVarI == UINT32_MAX ? desc.defaultTextureHandle : gGraphics.Mat_GetTexture( mat, matVarI, desc.defaultTextureHandle );
 					break;
 				}
 				case EMatVar_Float:
 				{
-					data->vars[ varI ].aFloat = gGraphics.Mat_GetFloat( mat, desc.name, desc.defaultFloat );
+					data->vars[ varI ].aFloat = matVarI == UINT32_MAX ? desc.defaultFloat : gGraphics.Mat_GetFloat( mat, matVarI, desc.defaultFloat );
 					break;
 				}
 				case EMatVar_Int:
 				{
-					data->vars[ varI ].aInt = gGraphics.Mat_GetInt( mat, desc.name, desc.defaultInt );
+					data->vars[ varI ].aInt = matVarI == UINT32_MAX ? desc.defaultInt : gGraphics.Mat_GetInt( mat, matVarI, desc.defaultInt );
 					break;
 				}
 				//case EMatVar_Bool:
 				//{
-				//	data->vars[ varI ].aBool = gGraphics.Mat_GetBool( mat, desc.name, desc.defaultBool );
+				//	data->vars[ varI ].aBool = gGraphics.Mat_GetBool( mat, matVarI, desc.defaultBool );
 				//	break;
 				//}
 				case EMatVar_Vec2:
 				{
-					data->vars[ varI ].aVec2 = gGraphics.Mat_GetVec2( mat, desc.name, desc.defaultVec2 );
+					data->vars[ varI ].aVec2 = matVarI == UINT32_MAX ? desc.defaultVec2 : gGraphics.Mat_GetVec2( mat, matVarI, desc.defaultVec2 );
 					break;
 				}
 				case EMatVar_Vec3:
 				{
-					data->vars[ varI ].aVec3 = gGraphics.Mat_GetVec3( mat, desc.name, desc.defaultVec3 );
+					data->vars[ varI ].aVec3 = matVarI == UINT32_MAX ? desc.defaultVec3 : gGraphics.Mat_GetVec3( mat, matVarI, desc.defaultVec3 );
 					break;
 				}
 				case EMatVar_Vec4:
 				{
-					data->vars[ varI ].aVec4 = gGraphics.Mat_GetVec4( mat, desc.name, desc.defaultVec4 );
+					data->vars[ varI ].aVec4 = matVarI == UINT32_MAX ? desc.defaultVec4 : gGraphics.Mat_GetVec4( mat, matVarI, desc.defaultVec4 );
 					break;
 				}
 
@@ -939,14 +1179,14 @@ void Shader_UpdateMaterialVars()
 			}
 		}
 
-		// update buffer if needed
+		// queue the upload, all dirty materials are written to the staging ring together below
 		if ( shaderData->aUseMaterialBuffer )
-		{
-			Shader_WriteMaterialBuffer( mat, shader, shaderData, data );
-		}
+			gShaderMaterialSlots[ shader ].aDirty.push_back( data->matIndex );
 	}
 
 	gGraphicsData.aDirtyMaterials.clear();
+
+	Shader_UploadMaterialBuffers();
 }
 
 
@@ -988,15 +1228,26 @@ const std::unordered_map< ch_handle_t, ShaderMaterialData >* Shader_GetMaterialD
 
 CONCMD( r_update_material_descriptors )
 {
-	for ( auto& [ shader, matList ] : gShaderMaterials )
-	{
-		// TODO: find shader data, and write vars
-		ShaderData_t* shaderData = Shader_GetData( shader );
+	// frames in flight still read the old buffers, and the descriptors pointing at them are rewritten below
+	render->WaitForQueues();
 
-		if ( !shaderData->aUseMaterialBuffer )
+	for ( auto& [ shader, slots ] : gShaderMaterialSlots )
+	{
+		if ( !slots.aBuffer )
 			continue;
 
-		Shader_UpdateMaterialDescriptorSets( shader, shaderData, matList );
+		render->DestroyBuffer( slots.aBuffer );
+		slots.aBuffer = CH_INVALID_HANDLE;
+
+		// rewrite the descriptor sets and upload every material again
+		Shader_CreateMaterialBuffer( shader, Shader_GetData( shader ), slots );
+
+		slots.aDirty.clear();
+
+		for ( u32 slot = 0; slot < slots.aSlots.size(); slot++ )
+		{
+			if ( slots.aSlots[ slot ] != CH_INVALID_HANDLE )
+				slots.aDirty.push_back( slot );
+		}
 	}
 }
-
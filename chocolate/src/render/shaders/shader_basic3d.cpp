@@ -14,7 +14,7 @@ constexpr u32              CH_BASIC3D_MAX_MATERIALS = 2048;
 
 
 static CreateDescBinding_t gBasic3D_Bindings[]      = {
-		 { EDescriptorType_StorageBuffer, ShaderStage_Vertex | ShaderStage_Fragment, 0, CH_BASIC3D_MAX_MATERIALS },
+		 { EDescriptorType_StorageBuffer, ShaderStage_Vertex | ShaderStage_Fragment, 0, 1, true },
 };
 
 
@@ -127,6 +127,7 @@ ShaderCreate_t gShaderCreate_Basic3D = {
 	.aMaterialSize          = sizeof( Basic3D_Material ),
 	.aUseMaterialBuffer     = true,
 	.aMaterialBufferBinding = 0,
+	.aMaxMaterials          = CH_BASIC3D_MAX_MATERIALS,
 };
 
 
@@ -0,0 +1,32 @@
+#include "core/util.h"
+#include "render/irender.h"
+#include "graphics_int.h"
+
+
+static void Shader_LightCluster_GetPipelineLayoutCreate( PipelineLayoutCreate_t& srPipeline )
+{
+	srPipeline.aPushConstants.push_back( { ShaderStage_Compute, 0, sizeof( ShaderLightCluster_Push ) } );
+}
+
+
+static void Shader_LightCluster_GetComputePipelineCreate( ComputePipelineCreate_t& srCreate )
+{
+	srCreate.aShaderModule.aModulePath = "shaders/light_cluster.comp.spv";
+	srCreate.aShaderModule.apEntry     = "main";
+	srCreate.aShaderModule.aStage      = ShaderStage_Compute;
+}
+
+
+ShaderCreate_t gShaderCreate_LightCluster = {
+	.apName          = CH_SHADER_NAME_LIGHT_CLUSTER,
+	.aStages         = ShaderStage_Compute,
+	.aBindPoint      = EPipelineBindPoint_Compute,
+	.apInit          = nullptr,
+	.apDestroy       = nullptr,
+	.apLayoutCreate  = Shader_LightCluster_GetPipelineLayoutCreate,
+	.apComputeCreate = Shader_LightCluster_GetComputePipelineCreate,
+};
+
+
+CH_REGISTER_SHADER( gShaderCreate_LightCluster );
+
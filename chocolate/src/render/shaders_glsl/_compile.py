@@ -8,6 +8,7 @@ SHADER_LIST = [
     "unlit",
     # "unlitarray",
     "skinning",
+    "light_cluster",
     "debug",
     "debug_col.vert",
     # "vertex_normals.vert",
@@ -20,7 +20,7 @@ layout(push_constant) uniform Push
 } push;
 
 // Material Info
-layout(set = CH_DESC_SET_PER_SHADER, binding = 0) buffer readonly Buffer_Material
+struct Material_t
 {
     int albedo;
     int ao;
@@ -32,7 +32,13 @@ layout(set = CH_DESC_SET_PER_SHADER, binding = 0) buffer readonly Buffer_Materia
 
 	bool aAlphaTest; 
 	bool useNormalMap; 
-} materials[];
+};
+
+// every material of this shader, indexed by the material index
+layout(set = CH_DESC_SET_PER_SHADER, binding = 0) buffer readonly Buffer_Material
+{
+    Material_t aMaterials[];
+} materials;
 
 layout(location = 0) in vec2 fragTexCoord;
 layout(location = 1) in vec3 inPosition;
@@ -44,8 +50,8 @@ layout(location = 5) in vec3 inTangent;
 
 layout(location = 0) out vec4 outColor;
 
-#define mat materials[ push.aMaterial ]
-// #define mat materials[0]
+#define mat materials.aMaterials[ push.aMaterial ]
+// #define mat materials.aMaterials[0]
 
 #define texDiffuse  texSamplers[ mat.albedo ]
 #define texAO       texSamplers[ mat.ao ]
@@ -117,7 +123,7 @@ void main()
 	if ( push.aDebugDraw == 1 )
 		outColor.rgb  += albedo.rgb;
 	else
-		outColor += AddLighting( albedo, inPositionWorld, normalWorld );
+		outColor += AddLighting( albedo, inPositionWorld, normalWorld, push.aViewport );
 
 	// ----------------------------------------------------------------------------
 
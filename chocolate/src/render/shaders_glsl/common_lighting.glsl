@@ -35,7 +35,60 @@ float GetActualLuminance( vec3 color )
 }
 
 
-vec4 AddLighting( vec4 albedo, vec3 inPositionWorld, vec3 inNormalWorld )
+// Returns the cluster this position is in, or CH_INVALID_BUFFER if the viewport has no cluster grid
+uint GetLightCluster( uint viewport, vec3 inPositionWorld )
+{
+	uint grid = gViewports[ viewport ].aLightClusters;
+
+	if ( grid == CH_INVALID_BUFFER )
+		return CH_INVALID_BUFFER;
+
+	vec4 clip  = gViewports[ viewport ].aProjView * vec4( inPositionWorld, 1.0 );
+	vec2 ndc   = clip.xy / clip.w;
+
+	// w is the view space depth with a perspective projection
+	float near = gViewports[ viewport ].aNearZ;
+	float far  = gViewports[ viewport ].aFarZ;
+	float z    = log( max( clip.w, near ) / near ) / log( far / near ) * CH_R_CLUSTER_Z;
+
+	ivec3 coord = ivec3( ( ndc * 0.5 + 0.5 ) * vec2( CH_R_CLUSTER_X, CH_R_CLUSTER_Y ), z );
+	coord       = clamp( coord, ivec3( 0 ), ivec3( CH_R_CLUSTER_X - 1, CH_R_CLUSTER_Y - 1, CH_R_CLUSTER_Z - 1 ) );
+
+	return grid * CH_R_CLUSTER_COUNT + coord.x + coord.y * CH_R_CLUSTER_X + coord.z * CH_R_CLUSTER_X * CH_R_CLUSTER_Y;
+}
+
+
+vec3 AddPointLight( uint i, vec4 albedo, vec3 inPositionWorld, vec3 inNormalWorld )
+{
+	// Vector to light
+	vec3 lightDir = gCore.aLightPoint[ i ].aPos - inPositionWorld;
+
+	// Distance from light to fragment position
+	float dist = length( lightDir );
+
+	lightDir = normalize(lightDir);
+
+	// Attenuation
+	// KEEP IN SYNC WITH GetPointLightRange() in light_cluster.comp
+	float atten = gCore.aLightPoint[ i ].aRadius / (pow(dist, 2.0) + 1.0);
+
+	// Diffuse part
+	vec3 vertNormal = normalize( inNormalWorld );
+	float NdotL = max( 0.0, dot(vertNormal, lightDir) );
+	vec3 diff = gCore.aLightPoint[ i ].aColor.rgb * gCore.aLightPoint[ i ].aColor.a * albedo.rgb * NdotL * atten;
+	// vec3 diff = gCore.aLightPoint[ i ].aColor.rgb * gCore.aLightPoint[ i ].aColor.a * NdotL * atten;
+
+	// vec3 lightColor = gCore.aLightPoint[ i ].aColor.rgb;
+	// float albedoLuminance = GetLuminance( albedo.rgb );
+	// lightColor = mix( lightColor, albedo.rgb * lightColor, albedoLuminance );
+// 
+	// vec3 diff = lightColor * gCore.aLightPoint[ i ].aColor.a * NdotL * atten;
+
+	return diff;
+}
+
+
+vec4 AddLighting( vec4 albedo, vec3 inPositionWorld, vec3 inNormalWorld, uint viewport )
 {
 	vec4 outColor = vec4( 0.f, 0.f, 0.f, 0.f );
 
@@ -63,17 +116,7 @@ vec4 AddLighting( vec4 albedo, vec3 inPositionWorld, vec3 inNormalWorld )
 			diff = gCore.aLightWorld[ i ].aColor.rgb * gCore.aLightWorld[ i ].aColor.a * max( intensity, 0.15 ) * albedo.rgb;
 
 		// shadow
-		// if ( gLightsWorld[ i ].aShadow != -1 )
-		// {
-		// 	mat4 depthBiasMVP = gBiasMat * gLightsWorld[ i ].aProjView;
-		// 	// mat4 depthBiasMVP = gBiasMat * gViewport[ 0 ].aProjView;
-		// 	vec4 shadowCoord = depthBiasMVP * vec4( inPositionWorld, 1.0 );
-// 
-		// 	// float shadow = SampleShadowMapPCF( gLightsWorld[ i ].aShadow, shadowCoord.xyz / shadowCoord.w );
-		// 	float shadow = SampleShadowMapPCF( 0, shadowCoord.xyz / shadowCoord.w );
-		// 	diff *= shadow;
-		// 	// diff = shadow;
-		// }
+		diff *= SampleWorldShadow( uint( i ), inPositionWorld );
 
 		outColor.rgb += diff;
 	}
@@ -83,43 +126,32 @@ vec4 AddLighting( vec4 albedo, vec3 inPositionWorld, vec3 inNormalWorld )
 	// ----------------------------------------------------------------------------
 	// Add Point Lights
 
-	for ( int i = 0; i < gCore.aNumLights[ CH_LIGHT_TYPE_POINT ]; i++ )
-	{
-		if ( gCore.aLightPoint[ i ].aColor.w == 0.f )
-			continue;
-
-		// Vector to light
-		vec3 lightDir = gCore.aLightPoint[ i ].aPos - inPositionWorld;
+	// only the lights in this cluster, the list is only written up to CH_R_CLUSTER_MAX_LIGHTS
+	uint cluster = GetLightCluster( viewport, inPositionWorld );
 
-		// Distance from light to fragment position
-		float dist = length( lightDir );
-
-		//if(dist < ubo.lights[i].radius)
+	if ( cluster != CH_INVALID_BUFFER && gLightClusters.aCount[ cluster ] <= CH_R_CLUSTER_MAX_LIGHTS )
+	{
+		for ( uint j = 0; j < gLightClusters.aCount[ cluster ]; j++ )
 		{
-			lightDir = normalize(lightDir);
-
-			// Attenuation
-			float atten = gCore.aLightPoint[ i ].aRadius / (pow(dist, 2.0) + 1.0);
-
-			// Diffuse part
-			vec3 vertNormal = normalize( inNormalWorld );
-			float NdotL = max( 0.0, dot(vertNormal, lightDir) );
-			vec3 diff = gCore.aLightPoint[ i ].aColor.rgb * gCore.aLightPoint[ i ].aColor.a * albedo.rgb * NdotL * atten;
-			// vec3 diff = gCore.aLightPoint[ i ].aColor.rgb * gCore.aLightPoint[ i ].aColor.a * NdotL * atten;
-
-			// vec3 lightColor = gCore.aLightPoint[ i ].aColor.rgb;
-			// float albedoLuminance = GetLuminance( albedo.rgb );
-			// lightColor = mix( lightColor, albedo.rgb * lightColor, albedoLuminance );
-// 
-			// vec3 diff = lightColor * gCore.aLightPoint[ i ].aColor.a * NdotL * atten;
+			outColor.rgb += AddPointLight( gLightClusters.aLights[ cluster * CH_R_CLUSTER_MAX_LIGHTS + j ], albedo, inPositionWorld, inNormalWorld );
+		}
+	}
+	else
+	{
+		for ( int i = 0; i < gCore.aNumLights[ CH_LIGHT_TYPE_POINT ]; i++ )
+		{
+			if ( gCore.aLightPoint[ i ].aColor.w == 0.f )
+				continue;
 
-			outColor.rgb += diff;
+			outColor.rgb += AddPointLight( uint( i ), albedo, inPositionWorld, inNormalWorld );
 		}
 	}
 
 	// ----------------------------------------------------------------------------
 	// Add Cone Lights
 
+	// NOTE: cone lights aren't clustered, their attenuation never reaches zero, so they don't have a range to cull with
+
 	#define CONSTANT 1
 	#define LINEAR 1
 	#define QUADRATIC 1
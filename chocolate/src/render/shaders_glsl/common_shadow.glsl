@@ -41,4 +41,66 @@ float SampleShadowMapPCF( int shadowMapID, vec3 shadowCoord )
 	return shadow;
 }
 
+//! Samples one cascade of a world light.
+/*!
+    \param light index of the world light.
+    \param cascade cascade to sample.
+    \param inPositionWorld fragment position in world space.
+    \return shadow term, or 1 if the position is outside of the cascade.
+*/
+float SampleShadowCascade( uint light, uint cascade, vec3 inPositionWorld )
+{
+	// the cascades are orthographic, so w is always 1
+	vec3 shadowCoord = ( gCore.aLightWorld[ light ].aProjView[ cascade ] * vec4( inPositionWorld, 1.0 ) ).xyz;
+	shadowCoord.xy   = shadowCoord.xy * 0.5 + 0.5;
+
+	if ( any( lessThan( shadowCoord, vec3( 0.0 ) ) ) || any( greaterThan( shadowCoord, vec3( 1.0 ) ) ) )
+		return 1.0;
+
+	return SampleShadowMapPCF( gCore.aLightWorld[ light ].aShadow[ cascade ], shadowCoord );
+}
+
+//! Samples the shadow of a world light.
+/*!
+    Picks the cascade from the view depth of the camera the cascades were fit to, not the viewport being drawn,
+    so other views like reflections or a second player's view use the same cascades the same way.
+    Blends into the next cascade near the end of each one, the last cascade fades out instead.
+
+    \param light index of the world light.
+    \param inPositionWorld fragment position in world space.
+    \return shadow term.
+*/
+float SampleWorldShadow( uint light, vec3 inPositionWorld )
+{
+	uint count = gCore.aLightWorld[ light ].aCascadeCount;
+
+	if ( count == 0 )
+		return 1.0;
+
+	vec4  splits = gCore.aLightWorld[ light ].aCascadeSplits;
+	vec4  plane  = gCore.aLightWorld[ light ].aCascadePlane;
+	float depth  = dot( plane.xyz, inPositionWorld ) + plane.w;
+
+	if ( depth > splits[ count - 1 ] )
+		return 1.0;
+
+	uint cascade = 0;
+	while ( cascade < count - 1 && depth > splits[ cascade ] )
+		cascade++;
+
+	float shadow     = SampleShadowCascade( light, cascade, inPositionWorld );
+
+	float start      = cascade == 0 ? gCore.aLightWorld[ light ].aCascadeNearZ : splits[ cascade - 1 ];
+	float blendStart = splits[ cascade ] - ( splits[ cascade ] - start ) * gCore.aLightWorld[ light ].aCascadeBlend;
+
+	if ( depth > blendStart )
+	{
+		float next  = cascade + 1 < count ? SampleShadowCascade( light, cascade + 1, inPositionWorld ) : 1.0;
+		float blend = ( depth - blendStart ) / max( splits[ cascade ] - blendStart, 0.0001 );
+		shadow      = mix( shadow, next, blend );
+	}
+
+	return shadow;
+}
+
 #endif  // CH_COMMON_SHADOW_GLSL
@@ -36,6 +36,18 @@
 #define CH_BINDING_MODEL_MATRICES            4
 #define CH_BINDING_VERTEX_BUFFERS            5
 #define CH_BINDING_INDEX_BUFFERS             6
+#define CH_BINDING_LIGHT_CLUSTERS            7
+
+// Clustered lighting, each viewport gets a froxel grid with a list of the point lights touching each cluster
+// the depth slices are exponential between the near and far plane
+#define CH_R_CLUSTER_X                       16
+#define CH_R_CLUSTER_Y                       9
+#define CH_R_CLUSTER_Z                       24
+#define CH_R_CLUSTER_COUNT                   ( CH_R_CLUSTER_X * CH_R_CLUSTER_Y * CH_R_CLUSTER_Z )
+#define CH_R_CLUSTER_GRIDS                   4   // max viewports with a cluster grid each frame
+#define CH_R_CLUSTER_MAX_LIGHTS              64  // if more lights than this touch a cluster, it falls back to looping every light
+
+#define CH_R_MAX_SHADOW_CASCADES             4
 
 // UINT32_MAX
 #define CH_INVALID_BUFFER                    4294967295
@@ -52,6 +64,7 @@ struct Viewport_t
 	vec3  aViewPos;
 	float aNearZ;
 	float aFarZ;
+	uint  aLightClusters;  // cluster grid index, or CH_INVALID_BUFFER if this view isn't clustered
 };
 
 
@@ -92,10 +105,15 @@ struct SurfaceDraw_t
 // Lights - Need to improve this
 struct LightWorld_t
 {
-    vec4 aColor;
-    vec3 aDir;
-    mat4 aProjView;  // viewport for light/shadow
-	int  aShadow;    // shadow texture index
+	vec4  aColor;
+	vec3  aDir;
+	uint  aCascadeCount;
+	mat4  aProjView[ CH_R_MAX_SHADOW_CASCADES ];  // viewport for each shadow cascade
+	vec4  aCascadeSplits;                         // view depth each cascade ends at
+	vec4  aCascadePlane;                          // view depth from the camera the cascades are fit to, dot( xyz, pos ) + w
+	ivec4 aShadow;                                // shadow texture index per cascade
+	float aCascadeBlend;                          // fraction of each cascade blended into the next one
+	float aCascadeNearZ;                          // where the first cascade starts
 };
 
 
@@ -190,6 +208,18 @@ layout(set = 0, binding = CH_BINDING_INDEX_BUFFERS) buffer readonly Buffer_Index
 } gIndexBuffers[];
 
 
+// written by light_cluster.comp, readonly everywhere else
+#ifdef CH_LIGHT_CLUSTER_WRITE
+layout(set = 0, binding = CH_BINDING_LIGHT_CLUSTERS) buffer writeonly Buffer_LightClusters
+#else
+layout(set = 0, binding = CH_BINDING_LIGHT_CLUSTERS) buffer readonly Buffer_LightClusters
+#endif
+{
+	uint aCount[ CH_R_CLUSTER_GRIDS * CH_R_CLUSTER_COUNT ];  // can be over CH_R_CLUSTER_MAX_LIGHTS
+	uint aLights[ CH_R_CLUSTER_GRIDS * CH_R_CLUSTER_COUNT * CH_R_CLUSTER_MAX_LIGHTS ];
+} gLightClusters;
+
+
 // layout(set = 0, binding = CH_BINDING_SURFACE_DRAWS) buffer readonly Buffer_SurfaceDraws
 // {
 // 	SurfaceDraw_t gSurfaceDraws[ CH_R_MAX_SURFACE_DRAWS ];
@@ -41,7 +41,7 @@ void main()
     // outColor = vec4(push.aColor, 1.0);
     // outColor = vec4(1.0, 0.0, 0.5, 1.0);
 
-    outColor = AddLighting( vec4(push.aColor, 1.0), inPositionWorld, inNormalWorld );
+    outColor = AddLighting( vec4(push.aColor, 1.0), inPositionWorld, inNormalWorld, push.aViewport );
 }
 
 // look at this later for cubemaps:
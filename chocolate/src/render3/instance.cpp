@@ -96,10 +96,10 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback( VkDebugUtilsMessageSeverityFla
 	if ( !g_use_validation_layers || !r_vk_debug_messages )
 		return VK_FALSE;
 
-	const log_t* log = Log_GetLastLog();
+	log_channel_h lastChannel = Log_GetLastChannel();
 
 	// blech
-	if ( log && log->channel != gLC_Vulkan )
+	if ( lastChannel != INVALID_LOG_CHANNEL && lastChannel != gLC_Vulkan )
 		Log_Ex( gLC_Vulkan, ELogType_Raw, "\n" );
 
 	std::string formatted;
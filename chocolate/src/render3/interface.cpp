@@ -131,6 +131,7 @@ struct Render3 final : public IRender3
 				window_free( { i, g_windows.generation[ i ] } );
 		}
 
+		texture_prefetch_free_all();
 		ktx_shutdown();
 
 		vk_shaders_shutdown();
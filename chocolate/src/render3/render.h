@@ -597,6 +597,7 @@ extern IGraphicsData*                                        graphics_data;
 extern VkInstance                                            g_vk_instance;
 extern VkDevice                                              g_vk_device;
 extern VkPhysicalDevice                                      g_vk_physical_device;
+extern VkPipelineCache                                       g_vk_pipeline_cache;
 
 extern VmaAllocator                                          g_vma;
 
@@ -784,6 +785,9 @@ vk_material_t*                                               vk_material_get( vk
 
 bool                                                         vk_shaders_init();
 void                                                         vk_shaders_shutdown();
+
+bool                                                         vk_pipeline_cache_create();
+void                                                         vk_pipeline_cache_destroy();  // also saves it to disk
 bool                                                         vk_shaders_rebuild();
 void                                                         vk_shaders_material_update( ch_material_h base_handle, vk_material_h handle );
 
@@ -806,10 +810,14 @@ void                                                         vk_buffer_destroy(
 
 bool                                                         ktx_init();
 void                                                         ktx_shutdown();
-bool                                                         ktx_load( const char* path, vk_texture_t* texture, vk_texture_load_info_t& load_info );
+bool                                                         ktx_load( const char* path, const char* data, u64 size, vk_texture_t* texture, vk_texture_load_info_t& load_info );
 
 bool                                                         texture_load( r_texture_h& handle, const char* path, vk_texture_load_info_t& load_info );
 r_texture_h                                                  texture_load( const char* path, vk_texture_load_info_t& load_info );
+
+// Start reading a texture file in the background, so a texture_load of it later on doesn't wait on the disk
+void                                                         texture_prefetch( const char* path );
+void                                                         texture_prefetch_free_all();
 void                                                         texture_free( r_texture_h& handle );
 
 bool                                                         texture_create_missing();
@@ -102,10 +102,11 @@ static bool load_ktx2( ktxTexture2* spKTexture2 )
 }
 
 
-bool ktx_load( const char* path, vk_texture_t* texture, vk_texture_load_info_t& load_info )
+bool ktx_load( const char* path, const char* data, u64 size, vk_texture_t* texture, vk_texture_load_info_t& load_info )
 {
+	// the file is already read in by async io, data is only needed until this returns
 	ktxTexture*    kTexture = nullptr;
-	KTX_error_code result   = ktxTexture_CreateFromNamedFile( path, KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture );
+	KTX_error_code result   = ktxTexture_CreateFromMemory( (const ktx_uint8_t*)data, size, KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture );
 
 	if ( result != KTX_SUCCESS )
 	{
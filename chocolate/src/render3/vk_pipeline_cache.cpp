@@ -0,0 +1,84 @@
+#include "render.h"
+#include "core/pipeline_cache.h"
+
+#include <vector>
+
+
+// Pipeline cache saved between runs, the driver keys the entries by the SPIR-V and pipeline state,
+// so only shaders that changed get compiled again
+// Reading and writing the file is shared with graphics_api in core/pipeline_cache.cpp
+
+
+VkPipelineCache g_vk_pipeline_cache = VK_NULL_HANDLE;
+
+#define         VK_PIPELINE_CACHE_PATH "cache" PATH_SEP_STR "pipeline_cache_r3.bin"
+
+
+static ch_pipeline_cache_key vk_pipeline_cache_key()
+{
+	ch_pipeline_cache_key key{};
+	key.aVendorID      = g_vk_device_properties.vendorID;
+	key.aDeviceID      = g_vk_device_properties.deviceID;
+	key.aDriverVersion = g_vk_device_properties.driverVersion;
+	memcpy( key.aCacheUUID, g_vk_device_properties.pipelineCacheUUID, VK_UUID_SIZE );
+
+	return key;
+}
+
+
+bool vk_pipeline_cache_create()
+{
+	std::vector< char > data;
+	PipelineCache_Load( VK_PIPELINE_CACHE_PATH, vk_pipeline_cache_key(), data );
+
+	VkPipelineCacheCreateInfo create_info{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	create_info.initialDataSize = data.size();
+	create_info.pInitialData    = data.data();
+
+	VkResult result             = vkCreatePipelineCache( g_vk_device, &create_info, nullptr, &g_vk_pipeline_cache );
+
+	if ( result != VK_SUCCESS && data.size() )
+	{
+		Log_Warn( gLC_Render, "Driver rejected the pipeline cache, creating an empty one\n" );
+
+		create_info.initialDataSize = 0;
+		create_info.pInitialData    = nullptr;
+		result                      = vkCreatePipelineCache( g_vk_device, &create_info, nullptr, &g_vk_pipeline_cache );
+	}
+
+	if ( vk_check_e( result, "Failed to create pipeline cache" ) )
+	{
+		g_vk_pipeline_cache = VK_NULL_HANDLE;
+		return false;
+	}
+
+	vk_set_name( VK_OBJECT_TYPE_PIPELINE_CACHE, (u64)g_vk_pipeline_cache, "Pipeline Cache" );
+	return true;
+}
+
+
+static void vk_pipeline_cache_save()
+{
+	size_t data_size = 0;
+	if ( vkGetPipelineCacheData( g_vk_device, g_vk_pipeline_cache, &data_size, nullptr ) != VK_SUCCESS || data_size == 0 )
+		return;
+
+	std::vector< char > data( data_size );
+	if ( vk_check_e( vkGetPipelineCacheData( g_vk_device, g_vk_pipeline_cache, &data_size, data.data() ), "Failed to get pipeline cache data" ) )
+		return;
+
+	PipelineCache_Save( VK_PIPELINE_CACHE_PATH, vk_pipeline_cache_key(), data.data(), data_size );
+}
+
+
+void vk_pipeline_cache_destroy()
+{
+	if ( g_vk_pipeline_cache == VK_NULL_HANDLE )
+		return;
+
+	if ( PipelineCache_IsEnabled() )
+		vk_pipeline_cache_save();
+
+	vkDestroyPipelineCache( g_vk_device, g_vk_pipeline_cache, nullptr );
+	g_vk_pipeline_cache = VK_NULL_HANDLE;
+}
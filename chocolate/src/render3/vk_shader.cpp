@@ -282,7 +282,7 @@ bool vk_shaders_create_graphics_pipeline( VkPipelineLayout layout, vk_shader_cre
 
 	// TODO: look into trying to make multiple pipelines at once
 	vk_check_f(
-	  vkCreateGraphicsPipelines( g_vk_device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &g_shader_data_graphics_pipelines[ index ] ),
+	  vkCreateGraphicsPipelines( g_vk_device, g_vk_pipeline_cache, 1, &pipelineInfo, NULL, &g_shader_data_graphics_pipelines[ index ] ),
 	  "Failed to create graphics pipeline for shader: \"%s\"", graphics_create->name );
 
 	vk_set_name_ex( VK_OBJECT_TYPE_PIPELINE, (u64)g_shader_data_graphics_pipelines[ index ], graphics_create->name, "Graphics Pipeline" );
@@ -346,6 +346,9 @@ void vk_shader_destroy_test();
 // for now, just load one test compute shader
 bool vk_shaders_init()
 {
+	// not having a cache is fine, pipelines just take longer to make
+	vk_pipeline_cache_create();
+
 	if ( !vk_load_test_shader() )
 		return false;
 
@@ -393,6 +396,8 @@ void vk_shaders_shutdown()
 	free( g_shader_data_graphics_pipeline_layout );
 	free( g_shader_data_graphics_pipelines );
 	free( g_shader_data_graphics_names );
+
+	vk_pipeline_cache_destroy();
 }
 
 
@@ -577,6 +582,13 @@ void vk_shaders_material_update( ch_material_h base_handle, vk_material_h handle
 	// IDEA: if this is slow, scan for the indexes of the material vars we need first with name searching maybe?
 	// now we can update material vars
 	vk_shader_create_graphics_t& create_data = g_shader_create_graphics[ material->shader ];
+	// start reading every texture first, so the rest are read while the first ones are transcoded and uploaded
+	for ( u32 mat_i = 0; mat_i < base_material->count; mat_i++ )
+	{
+		if ( base_material->type[ mat_i ] == e_mat_var_string )
+			texture_prefetch( base_material->var[ mat_i ].val_string.data );
+	}
+
 	for ( u32 vk_mat_i = 0; vk_mat_i < material->var_count; vk_mat_i++ )
 	{
 		shader_mat_var_desc_t& desc = create_data.material_var[ vk_mat_i ];
@@ -49,7 +49,7 @@ bool vk_load_test_shader()
 	compute_pipeline.layout = g_pipeline_gradient_layout;
 	compute_pipeline.stage  = stage_create;
 
-	if ( vk_check_e( vkCreateComputePipelines( g_vk_device, VK_NULL_HANDLE, 1, &compute_pipeline, nullptr, &g_pipeline_gradient ), "Failed to create compute pipeline" ) )
+	if ( vk_check_e( vkCreateComputePipelines( g_vk_device, g_vk_pipeline_cache, 1, &compute_pipeline, nullptr, &g_pipeline_gradient ), "Failed to create compute pipeline" ) )
 		return false;
 
 	return true;
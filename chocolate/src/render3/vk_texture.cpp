@@ -1,5 +1,7 @@
 #include "render.h"
 
+#include "core/async_io.h"
+
 
 // TODO: upload textures with vma
 
@@ -7,6 +9,9 @@
 constexpr const char* MISSING_TEXTURE_PATH = "materials/base/missing.ktx";
 
 
+CONVAR_BOOL_NAME( r_texture_prefetch, "vk.texture.prefetch", true, CVARF_ARCHIVE, "Read texture files in the background ahead of loading them" );
+
+
 struct vk_sampler_settings_t
 {
 	VkFilter             filter;
@@ -51,6 +56,9 @@ ch_handle_ref_list_32< r_texture_h, vk_texture_t >     g_textures;
 std::unordered_map< ch_string, r_texture_h >           g_texture_map;
 u32                                                    g_texture_count;
 
+// texture files being read in the background, texture_load takes these instead of reading the file again
+std::unordered_map< ch_string, ch_async_io_request* >  g_texture_prefetch;
+
 // hash of the texture sampler options
 std::unordered_map< vk_sampler_settings_t, VkSampler > g_samplers;
 
@@ -116,6 +124,93 @@ static void texture_free_data( vk_texture_t* texture )
 }
 
 
+static ch_string texture_find_path( const char* path )
+{
+	if ( ch_str_ends_with( path, ".ktx", 4 ) )
+		return FileSys_FindFile( path );
+
+	char new_path[ 512 ]{};
+	strcat( new_path, path );
+	strcat( new_path, ".ktx" );
+	return FileSys_FindFile( new_path );
+}
+
+
+// Get the file data of a texture, either from a prefetch, or by reading it now
+static ch_async_io_request* texture_read( const ch_string& full_path )
+{
+	ch_async_io_request* request = nullptr;
+
+	auto it = g_texture_prefetch.find( full_path );
+	if ( it != g_texture_prefetch.end() )
+	{
+		request = it->second;
+		AsyncIO_Wait( request );
+
+		// the key was the path the request read from, so only free it after it's done
+		ch_string key = it->first;
+		g_texture_prefetch.erase( it );
+		ch_str_free( key );
+		return request;
+	}
+
+	request            = new ch_async_io_request;
+	request->apPath    = full_path.data;
+	request->aPriority = EAsyncIOPriority_High;
+
+	if ( AsyncIO_Submit( request ) )
+		AsyncIO_Wait( request );
+
+	return request;
+}
+
+
+void texture_prefetch( const char* path )
+{
+	if ( !path || !r_texture_prefetch )
+		return;
+
+	ch_string full_path = texture_find_path( path );
+
+	if ( !full_path.data )
+		return;
+
+	if ( g_texture_map.contains( full_path ) || g_texture_prefetch.contains( full_path ) )
+	{
+		ch_str_free( full_path );
+		return;
+	}
+
+	ch_async_io_request* request = new ch_async_io_request;
+	request->apPath              = full_path.data;
+	request->aPriority           = EAsyncIOPriority_Low;
+
+	if ( !AsyncIO_Submit( request ) )
+	{
+		delete request;
+		ch_str_free( full_path );
+		return;
+	}
+
+	g_texture_prefetch[ full_path ] = request;
+}
+
+
+void texture_prefetch_free_all()
+{
+	for ( auto& [ path, request ] : g_texture_prefetch )
+	{
+		AsyncIO_Wait( request );
+
+		ch_free( request->apBuffer );
+		delete request;
+		ch_str_free( path );
+	}
+
+	g_texture_prefetch.clear();
+}
+
+
 r_texture_h texture_load( const char* path, vk_texture_load_info_t& load_info )
 {
 	r_texture_h handle;
@@ -137,19 +232,7 @@ bool texture_load( r_texture_h& handle, const char* path, vk_texture_load_info_t
 		return false;
 	}
 
-	ch_string full_path;
-
-	if ( ch_str_ends_with( path, ".ktx", 4 ) )
-	{
-		full_path = FileSys_FindFile( path );
-	}
-	else
-	{
-		char new_path[ 512 ]{};
-		strcat( new_path, path );
-		strcat( new_path, ".ktx" );
-		full_path = FileSys_FindFile( new_path );
-	}
+	ch_string full_path = texture_find_path( path );
 
 	if ( !full_path.data )
 	{
@@ -187,7 +270,16 @@ bool texture_load( r_texture_h& handle, const char* path, vk_texture_load_info_t
 	}
 
 	// load the texture
-	if ( !ktx_load( full_path.data, texture, load_info ) )
+	ch_async_io_request* request = texture_read( full_path );
+	bool                 loaded  = false;
+
+	if ( request->aResult == EAsyncIOResult_Success )
+		loaded = ktx_load( full_path.data, request->apBuffer, request->aBytesRead, texture, load_info );
+
+	ch_free( request->apBuffer );
+	delete request;
+
+	if ( !loaded )
 	{
 		g_textures.ref_decrement( handle );
 		Log_ErrorF( gLC_Render, "texture_load: Failed to load texture: \"%s\"\n", full_path.data );